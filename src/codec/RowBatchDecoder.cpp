@@ -0,0 +1,420 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "codec/RowBatchDecoder.h"
+
+namespace nebula {
+
+namespace {
+
+template<typename T>
+void extractInts(const std::vector<folly::StringPiece>& rows,
+                 const std::vector<uint8_t>& fast,
+                 size_t offset,
+                 std::vector<int64_t>& out) {
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!fast[i]) {
+            continue;
+        }
+        T val;
+        memcpy(reinterpret_cast<void*>(&val), rows[i].data() + offset, sizeof(T));
+        out[i] = val;
+    }
+}
+
+
+template<typename T>
+void extractDoubles(const std::vector<folly::StringPiece>& rows,
+                    const std::vector<uint8_t>& fast,
+                    size_t offset,
+                    std::vector<double>& out) {
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (!fast[i]) {
+            continue;
+        }
+        T val;
+        memcpy(reinterpret_cast<void*>(&val), rows[i].data() + offset, sizeof(T));
+        out[i] = val;
+    }
+}
+
+
+Date readDate(const char* p) {
+    Date dt;
+    memcpy(reinterpret_cast<void*>(&dt.year), p, sizeof(int16_t));
+    memcpy(reinterpret_cast<void*>(&dt.month), p + sizeof(int16_t), sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.day),
+           p + sizeof(int16_t) + sizeof(int8_t),
+           sizeof(int8_t));
+    return dt;
+}
+
+
+DateTime readDateTime(const char* p) {
+    DateTime dt;
+    memcpy(reinterpret_cast<void*>(&dt.year), p, sizeof(int16_t));
+    memcpy(reinterpret_cast<void*>(&dt.month), p + sizeof(int16_t), sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.day),
+           p + sizeof(int16_t) + sizeof(int8_t),
+           sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.hour),
+           p + sizeof(int16_t) + 2 * sizeof(int8_t),
+           sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.minute),
+           p + sizeof(int16_t) + 3 * sizeof(int8_t),
+           sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.sec),
+           p + sizeof(int16_t) + 4 * sizeof(int8_t),
+           sizeof(int8_t));
+    memcpy(reinterpret_cast<void*>(&dt.microsec),
+           p + sizeof(int16_t) + 5 * sizeof(int8_t),
+           sizeof(int32_t));
+    memcpy(reinterpret_cast<void*>(&dt.timezone),
+           p + sizeof(int16_t) + 5 * sizeof(int8_t) + sizeof(int32_t),
+           sizeof(int32_t));
+    return dt;
+}
+
+}  // Anonymous namespace
+
+
+/*********************************************
+ *
+ * struct RowBatch::Column
+ *
+ ********************************************/
+Value RowBatch::Column::value(size_t row) const {
+    if (isNull(row)) {
+        return NullType::__NULL__;
+    }
+
+    switch (type) {
+        case meta::cpp2::PropertyType::BOOL:
+            return ints[row] != 0;
+        case meta::cpp2::PropertyType::INT8:
+        case meta::cpp2::PropertyType::INT16:
+        case meta::cpp2::PropertyType::INT32:
+        case meta::cpp2::PropertyType::INT64:
+        case meta::cpp2::PropertyType::TIMESTAMP:
+            return ints[row];
+        case meta::cpp2::PropertyType::FLOAT:
+        case meta::cpp2::PropertyType::DOUBLE:
+            return doubles[row];
+        case meta::cpp2::PropertyType::STRING:
+        case meta::cpp2::PropertyType::FIXED_STRING:
+        case meta::cpp2::PropertyType::VID:
+            return strs[row].str();
+        case meta::cpp2::PropertyType::DATE:
+        case meta::cpp2::PropertyType::DATETIME:
+            return values[row];
+        default:
+            LOG(FATAL) << "Should not reach here";
+    }
+}
+
+
+/*********************************************
+ *
+ * class RowBatchDecoder
+ *
+ ********************************************/
+RowBatchDecoder::RowBatchDecoder(const meta::SchemaProviderIf* schema,
+                                 const std::vector<std::string>& props)
+        : schema_(schema) {
+    CHECK(!!schema_);
+    init(props);
+}
+
+
+RowBatchDecoder::RowBatchDecoder(
+        const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>& schemas,
+        const std::vector<std::string>& props)
+        : schemas_(&schemas) {
+    CHECK(!schemas.empty());
+    schema_ = schemas.back().get();
+    init(props);
+}
+
+
+void RowBatchDecoder::init(const std::vector<std::string>& props) {
+    // Build the header and the schema version bytes the same way RowWriterV2 does
+    int64_t ver = schema_->getVersion();
+    size_t verBytes = 0;
+    if (ver > 0) {
+        verBytes = 1;
+        if (ver > 0x00FF) {
+            verBytes = 2;
+            int64_t limit = 0x00FFFF;
+            while (ver >= limit) {
+                ++verBytes;
+                limit = (limit << 8) | 0xFF;
+            }
+        }
+    }
+    CHECK_LE(verBytes, 7) << "Schema version too big";
+    header_.append(1, static_cast<char>(0x08 | verBytes));
+    header_.append(reinterpret_cast<const char*>(&ver), verBytes);
+
+    size_t numNullBytes = 0;
+    size_t numNullables = schema_->getNumNullableFields();
+    if (numNullables > 0) {
+        numNullBytes = ((numNullables - 1) >> 3) + 1;
+    }
+    minRowLen_ = header_.size() + numNullBytes + schema_->size();
+
+    for (auto& prop : props) {
+        int64_t index = schema_->getFieldIndex(prop);
+        if (index < 0) {
+            LOG(ERROR) << "Unknown property " << prop;
+            valid_ = false;
+            continue;
+        }
+        auto field = schema_->field(index);
+        columns_.emplace_back(ColumnDesc{
+            prop, field, header_.size() + numNullBytes + field->offset()});
+    }
+}
+
+
+bool RowBatchDecoder::decode(const std::vector<folly::StringPiece>& rows,
+                             RowBatch& batch) const {
+    if (!valid_) {
+        return false;
+    }
+
+    size_t numRows = rows.size();
+    batch.numRows = numRows;
+    batch.columns.clear();
+    batch.ownedStrs.clear();
+
+    std::vector<uint8_t> fast(numRows);
+    bool allFast = true;
+    for (size_t i = 0; i < numRows; i++) {
+        fast[i] = isFastRow(rows[i]) ? 1 : 0;
+        allFast = allFast && fast[i];
+    }
+
+    batch.columns.resize(columns_.size());
+    for (size_t c = 0; c < columns_.size(); c++) {
+        auto& col = batch.columns[c];
+        col.name = columns_[c].name;
+        col.type = columns_[c].field->type();
+        col.nulls.assign((numRows + 63) >> 6, 0);
+        decodeNulls(columns_[c], rows, fast, col);
+        decodeFixed(columns_[c], rows, fast, col);
+    }
+
+    if (allFast) {
+        return true;
+    }
+    return decodeSlow(rows, fast, batch);
+}
+
+
+void RowBatchDecoder::decodeNulls(const ColumnDesc& desc,
+                                  const std::vector<folly::StringPiece>& rows,
+                                  const std::vector<uint8_t>& fast,
+                                  RowBatch::Column& col) const {
+    if (!desc.field->nullable()) {
+        return;
+    }
+
+    size_t pos = desc.field->nullFlagPos();
+    size_t byte = header_.size() + (pos >> 3);
+    uint8_t mask = 0x80 >> (pos & 0x07);
+
+    // Pack the flags of 64 rows into one word, no branch on the flag itself
+    for (size_t base = 0; base < rows.size(); base += 64) {
+        size_t end = std::min(rows.size(), base + 64);
+        uint64_t word = 0;
+        for (size_t i = base; i < end; i++) {
+            uint8_t flag = fast[i] ? static_cast<uint8_t>(rows[i][byte]) : 0;
+            word |= static_cast<uint64_t>((flag & mask) != 0) << (i - base);
+        }
+        col.nulls[base >> 6] = word;
+    }
+}
+
+
+void RowBatchDecoder::decodeFixed(const ColumnDesc& desc,
+                                  const std::vector<folly::StringPiece>& rows,
+                                  const std::vector<uint8_t>& fast,
+                                  RowBatch::Column& col) const {
+    size_t numRows = rows.size();
+    size_t offset = desc.offset;
+
+    switch (col.type) {
+        case meta::cpp2::PropertyType::BOOL: {
+            col.ints.resize(numRows, 0);
+            for (size_t i = 0; i < numRows; i++) {
+                if (fast[i]) {
+                    col.ints[i] = rows[i][offset] != 0;
+                }
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::INT8: {
+            col.ints.resize(numRows, 0);
+            extractInts<int8_t>(rows, fast, offset, col.ints);
+            break;
+        }
+        case meta::cpp2::PropertyType::INT16: {
+            col.ints.resize(numRows, 0);
+            extractInts<int16_t>(rows, fast, offset, col.ints);
+            break;
+        }
+        case meta::cpp2::PropertyType::INT32: {
+            col.ints.resize(numRows, 0);
+            extractInts<int32_t>(rows, fast, offset, col.ints);
+            break;
+        }
+        case meta::cpp2::PropertyType::INT64:
+        case meta::cpp2::PropertyType::TIMESTAMP: {
+            col.ints.resize(numRows, 0);
+            extractInts<int64_t>(rows, fast, offset, col.ints);
+            break;
+        }
+        case meta::cpp2::PropertyType::FLOAT: {
+            col.doubles.resize(numRows, 0.0);
+            extractDoubles<float>(rows, fast, offset, col.doubles);
+            break;
+        }
+        case meta::cpp2::PropertyType::DOUBLE: {
+            col.doubles.resize(numRows, 0.0);
+            extractDoubles<double>(rows, fast, offset, col.doubles);
+            break;
+        }
+        case meta::cpp2::PropertyType::STRING: {
+            col.strs.resize(numRows);
+            for (size_t i = 0; i < numRows; i++) {
+                if (!fast[i] || col.isNull(i)) {
+                    continue;
+                }
+                int32_t strOffset;
+                int32_t strLen;
+                memcpy(reinterpret_cast<void*>(&strOffset),
+                       rows[i].data() + offset,
+                       sizeof(int32_t));
+                memcpy(reinterpret_cast<void*>(&strLen),
+                       rows[i].data() + offset + sizeof(int32_t),
+                       sizeof(int32_t));
+                CHECK_LE(static_cast<size_t>(strOffset) + strLen, rows[i].size());
+                col.strs[i] = folly::StringPiece(rows[i].data() + strOffset, strLen);
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::FIXED_STRING: {
+            col.strs.resize(numRows);
+            size_t len = desc.field->size();
+            for (size_t i = 0; i < numRows; i++) {
+                if (fast[i]) {
+                    col.strs[i] = folly::StringPiece(rows[i].data() + offset, len);
+                }
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::VID: {
+            // This is to be compatible with V1, so we treat it as
+            // 8-byte long string
+            col.strs.resize(numRows);
+            for (size_t i = 0; i < numRows; i++) {
+                if (fast[i]) {
+                    col.strs[i] = folly::StringPiece(rows[i].data() + offset, sizeof(int64_t));
+                }
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::DATE: {
+            col.values.resize(numRows);
+            for (size_t i = 0; i < numRows; i++) {
+                if (fast[i] && !col.isNull(i)) {
+                    col.values[i] = readDate(rows[i].data() + offset);
+                }
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::DATETIME: {
+            col.values.resize(numRows);
+            for (size_t i = 0; i < numRows; i++) {
+                if (fast[i] && !col.isNull(i)) {
+                    col.values[i] = readDateTime(rows[i].data() + offset);
+                }
+            }
+            break;
+        }
+        default:
+            LOG(FATAL) << "Should not reach here";
+    }
+}
+
+
+bool RowBatchDecoder::decodeSlow(const std::vector<folly::StringPiece>& rows,
+                                 const std::vector<uint8_t>& fast,
+                                 RowBatch& batch) const {
+    RowReaderWrapper wrapper;
+    // The reset() overloads are hidden by RowReaderWrapper, so call them from the base
+    RowReader& reader = wrapper;
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (fast[i]) {
+            continue;
+        }
+
+        bool ok = schemas_ != nullptr ? reader.reset(*schemas_, rows[i])
+                                      : reader.reset(schema_, rows[i]);
+        if (!ok) {
+            LOG(ERROR) << "Failed to decode the row [" << toHexStr(rows[i]) << "]";
+            return false;
+        }
+
+        for (auto& col : batch.columns) {
+            auto v = reader.getValueByName(col.name);
+            switch (v.type()) {
+                case Value::Type::BOOL:
+                    if (!col.ints.empty()) {
+                        col.ints[i] = v.getBool();
+                        continue;
+                    }
+                    break;
+                case Value::Type::INT:
+                    if (!col.ints.empty()) {
+                        col.ints[i] = v.getInt();
+                        continue;
+                    } else if (!col.doubles.empty()) {
+                        col.doubles[i] = v.getInt();
+                        continue;
+                    }
+                    break;
+                case Value::Type::FLOAT:
+                    if (!col.doubles.empty()) {
+                        col.doubles[i] = v.getFloat();
+                        continue;
+                    }
+                    break;
+                case Value::Type::STRING:
+                    if (!col.strs.empty()) {
+                        batch.ownedStrs.emplace_back(v.moveStr());
+                        col.strs[i] = batch.ownedStrs.back();
+                        continue;
+                    }
+                    break;
+                case Value::Type::DATE:
+                case Value::Type::DATETIME:
+                    if (!col.values.empty()) {
+                        col.values[i] = std::move(v);
+                        continue;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            // NULL, unknown property in the old schema, or an incompatible type
+            col.nulls[i >> 6] |= static_cast<uint64_t>(1) << (i & 0x3F);
+        }
+    }
+    return true;
+}
+
+}  // namespace nebula
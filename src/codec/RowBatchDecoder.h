@@ -0,0 +1,130 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef CODEC_ROWBATCHDECODER_H_
+#define CODEC_ROWBATCHDECODER_H_
+
+#include "common/base/Base.h"
+#include "common/datatypes/Value.h"
+#include "common/meta/SchemaProviderIf.h"
+#include "common/meta/NebulaSchemaProvider.h"
+#include "codec/RowReaderWrapper.h"
+
+namespace nebula {
+
+/**
+ * The columnar result of decoding a batch of rows. Every projected property
+ * becomes one column, and the i-th entry of a column belongs to the i-th row
+ * passed to RowBatchDecoder::decode().
+ *
+ * Depending on the property type, exactly one of the typed vectors is filled:
+ *      ints        BOOL, INT8, INT16, INT32, INT64, TIMESTAMP
+ *      doubles     FLOAT, DOUBLE
+ *      strs        STRING, FIXED_STRING, VID
+ *      values      DATE, DATETIME
+ *
+ * The string views point into the source rows (or into the batch itself for
+ * the rows which had to be decoded by the per-value reader), so the rows
+ * must outlive the batch.
+ */
+struct RowBatch {
+    struct Column {
+        std::string name;
+        meta::cpp2::PropertyType type;
+        // One bit per row, the bit is set when the value is NULL or when the
+        // property does not exist in the schema version the row was written by
+        std::vector<uint64_t> nulls;
+        std::vector<int64_t> ints;
+        std::vector<double> doubles;
+        std::vector<folly::StringPiece> strs;
+        std::vector<Value> values;
+
+        bool isNull(size_t row) const {
+            return (nulls[row >> 6] >> (row & 0x3F)) & 0x01;
+        }
+
+        // Materialize one value, mostly for the callers which still need a Value
+        Value value(size_t row) const;
+    };
+
+    size_t numRows{0};
+    std::vector<Column> columns;
+
+    // Strings decoded by the per-value reader, the views in Column::strs
+    // refer to them. We use a deque so that the strings never move
+    std::deque<std::string> ownedStrs;
+};
+
+
+/**
+ * This class decodes the properties of many rows at once into a RowBatch.
+ *
+ * All rows which are encoded by the version 2 encoder with the newest schema
+ * version go through the fast path: the offset of each projected property is
+ * resolved once per batch, and then every column is extracted with a tight
+ * loop over the rows, without virtual calls and without any heap allocation
+ * per value. The null flags are packed 64 rows at a time.
+ *
+ * Rows encoded by the version 1 encoder or by an older schema version are
+ * decoded by the regular RowReader, value by value.
+ */
+class RowBatchDecoder final {
+public:
+    RowBatchDecoder(const meta::SchemaProviderIf* schema,
+                    const std::vector<std::string>& props);
+
+    // notice: the schemas are from oldest to newest,
+    // usually from getAllVerTagSchema or getAllVerEdgeSchema in SchemaMan
+    RowBatchDecoder(
+        const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>& schemas,
+        const std::vector<std::string>& props);
+
+    // Decode the given rows. Return false if any property does not exist
+    // in the newest schema, or any row can't be decoded
+    bool decode(const std::vector<folly::StringPiece>& rows, RowBatch& batch) const;
+
+private:
+    struct ColumnDesc {
+        std::string name;
+        const meta::SchemaProviderIf::Field* field;
+        // The offset of the property in a row of the newest schema version
+        size_t offset;
+    };
+
+    const meta::SchemaProviderIf* schema_;
+    const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>* schemas_{nullptr};
+    std::vector<ColumnDesc> columns_;
+    bool valid_{true};
+
+    // The header and the schema version bytes of a row encoded by the newest schema
+    std::string header_;
+    // The minimum length of a row encoded by the newest schema
+    size_t minRowLen_;
+
+    void init(const std::vector<std::string>& props);
+
+    bool isFastRow(folly::StringPiece row) const {
+        return row.size() >= minRowLen_ &&
+               memcmp(row.data(), header_.data(), header_.size()) == 0;
+    }
+
+    void decodeFixed(const ColumnDesc& desc,
+                     const std::vector<folly::StringPiece>& rows,
+                     const std::vector<uint8_t>& fast,
+                     RowBatch::Column& col) const;
+
+    void decodeNulls(const ColumnDesc& desc,
+                     const std::vector<folly::StringPiece>& rows,
+                     const std::vector<uint8_t>& fast,
+                     RowBatch::Column& col) const;
+
+    bool decodeSlow(const std::vector<folly::StringPiece>& rows,
+                    const std::vector<uint8_t>& fast,
+                    RowBatch& batch) const;
+};
+
+}  // namespace nebula
+#endif  // CODEC_ROWBATCHDECODER_H_
@@ -656,8 +656,24 @@ WriteResult RowWriterV2::write(ssize_t index, folly::StringPiece v) noexcept {
     switch (field->type()) {
         case meta::cpp2::PropertyType::STRING: {
             if (isSet_[index]) {
-                // The string value has already been set, we need to turn it
-                // into out-of-space strings then
+                // The string value has already been set. If the new string
+                // has the same length, and the old one is stored in the buffer,
+                // we just overwrite it in place
+                int32_t oldOffset;
+                int32_t oldLen;
+                memcpy(reinterpret_cast<void*>(&oldOffset), &buf_[offset], sizeof(int32_t));
+                memcpy(reinterpret_cast<void*>(&oldLen),
+                       &buf_[offset + sizeof(int32_t)],
+                       sizeof(int32_t));
+                if (oldOffset > 0 &&
+                    static_cast<size_t>(oldLen) == v.size() &&
+                    static_cast<size_t>(oldOffset) + oldLen <= buf_.size()) {
+                    if (oldLen > 0) {
+                        memcpy(&buf_[oldOffset], v.data(), oldLen);
+                    }
+                    break;
+                }
+                // Otherwise, we need to turn it into out-of-space strings
                 outOfSpaceStr_ = true;
             }
 
@@ -83,6 +83,12 @@ enum class WriteResult {
        |             |             |              |
      1 byte     0 - 7 bytes     0+ bytes       N bytes
 
+  When the writer is constructed from an existing V2 encoded string (which
+  must be encoded by the same schema version), it patches the row in place:
+  fixed-length properties and the NULL flags are overwritten directly, and a
+  STRING property is only relocated when the length of the new value differs
+  from the old one. In that case all strings are compacted in finish()
+
 ********************************************************************************/
 class RowWriterV2 {
 public:
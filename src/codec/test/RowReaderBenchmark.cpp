@@ -11,11 +11,14 @@
 #include "codec/test/RowWriterV1.h"
 #include "codec/RowWriterV2.h"
 #include "codec/RowReader.h"
+#include "codec/RowBatchDecoder.h"
 
 using nebula::SchemaWriter;
 using nebula::RowWriterV1;
 using nebula::RowWriterV2;
 using nebula::RowReader;
+using nebula::RowBatch;
+using nebula::RowBatchDecoder;
 using nebula::meta::cpp2::PropertyType;
 
 SchemaWriter schemaShort;
@@ -29,6 +32,16 @@ std::string dataLongV2;     // NOLINT
 std::vector<size_t> shortRandom;
 std::vector<size_t> longRandom;
 
+// Rows used by the batch decoding, every benchmark iteration decodes all of them
+const size_t kBatchSize = 1000;
+std::vector<std::string> batchRowsV2;               // NOLINT
+std::vector<folly::StringPiece> batchViewsV2;       // NOLINT
+std::vector<std::string> batchRowsMixed;            // NOLINT
+std::vector<folly::StringPiece> batchViewsMixed;    // NOLINT
+// INT64, DOUBLE and STRING columns of the long schema
+const std::vector<std::string> batchProps = {"col02", "col05", "col06",     // NOLINT
+                                             "col38", "col41", "col42"};
+
 const double e = 2.71828182845904523536028747135266249775724709369995;
 const float pi = 3.14159265358979;
 const std::string str = "Hello world!"; // NOLINT
@@ -165,6 +178,65 @@ void randomTest(SchemaWriter* schema,
 }
 
 
+void prepareBatchData() {
+    for (size_t i = 0; i < kBatchSize; i++) {
+        batchRowsV2.emplace_back(prepareV2Data(&schemaLong, 24));
+        // Every other row is encoded by V1, which goes through the per-value reader
+        batchRowsMixed.emplace_back(i % 2 == 0 ? prepareV2Data(&schemaLong, 24)
+                                               : prepareV1Data(&schemaLong, 24));
+    }
+    for (size_t i = 0; i < kBatchSize; i++) {
+        batchViewsV2.emplace_back(batchRowsV2[i]);
+        batchViewsMixed.emplace_back(batchRowsMixed[i]);
+    }
+}
+
+
+void perValueBatchRead(const std::vector<folly::StringPiece>& rows, size_t iters) {
+    std::vector<size_t> indices;
+    for (auto& prop : batchProps) {
+        indices.emplace_back(schemaLong.getFieldIndex(prop));
+    }
+
+    for (size_t i = 0; i < iters; i++) {
+        for (auto& row : rows) {
+            auto reader = RowReader::getRowReader(&schemaLong, row);
+            for (auto idx : indices) {
+                auto v = reader->getValueByIndex(idx);
+                folly::doNotOptimizeAway(v);
+            }
+        }
+    }
+}
+
+
+void columnarBatchRead(const std::vector<folly::StringPiece>& rows, size_t iters) {
+    RowBatchDecoder decoder(&schemaLong, batchProps);
+    RowBatch batch;
+    for (size_t i = 0; i < iters; i++) {
+        auto ok = decoder.decode(rows, batch);
+        folly::doNotOptimizeAway(ok);
+        folly::doNotOptimizeAway(batch);
+    }
+}
+
+
+void batchTest(const std::vector<folly::StringPiece>& rows) {
+    RowBatchDecoder decoder(&schemaLong, batchProps);
+    RowBatch batch;
+    ASSERT_TRUE(decoder.decode(rows, batch));
+    ASSERT_EQ(rows.size(), batch.numRows);
+    ASSERT_EQ(batchProps.size(), batch.columns.size());
+
+    for (size_t i = 0; i < rows.size(); i++) {
+        auto reader = RowReader::getRowReader(&schemaLong, rows[i]);
+        for (size_t c = 0; c < batchProps.size(); c++) {
+            EXPECT_EQ(reader->getValueByName(batchProps[c]), batch.columns[c].value(i));
+        }
+    }
+}
+
+
 /*************************
  * Begining of Tests
  ************************/
@@ -183,6 +255,20 @@ TEST(RowReader, RandomShort) {
 TEST(RowReader, RandomLong) {
     randomTest(&schemaLong, dataLongV1, dataLongV2, longRandom);
 }
+
+TEST(RowReader, BatchV2) {
+    batchTest(batchViewsV2);
+}
+
+TEST(RowReader, BatchMixed) {
+    batchTest(batchViewsMixed);
+}
+
+TEST(RowReader, BatchUnknownProp) {
+    RowBatchDecoder decoder(&schemaLong, {"col02", "not_exist"});
+    RowBatch batch;
+    EXPECT_FALSE(decoder.decode(batchViewsV2, batch));
+}
 /*************************
  * End of Tests
  ************************/
@@ -224,6 +310,25 @@ BENCHMARK(random_read_long_v1, iters) {
 BENCHMARK_RELATIVE(random_read_long_v2, iters) {
     randomRead(&schemaLong, dataLongV2, longRandom, iters);
 }
+
+BENCHMARK_DRAW_LINE();
+
+// Each iteration decodes kBatchSize rows, so rows/sec = iters/s * kBatchSize
+BENCHMARK(batch_read_per_value_v2, iters) {
+    perValueBatchRead(batchViewsV2, iters);
+}
+BENCHMARK_RELATIVE(batch_read_columnar_v2, iters) {
+    columnarBatchRead(batchViewsV2, iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(batch_read_per_value_mixed, iters) {
+    perValueBatchRead(batchViewsMixed, iters);
+}
+BENCHMARK_RELATIVE(batch_read_columnar_mixed, iters) {
+    columnarBatchRead(batchViewsMixed, iters);
+}
 /*************************
  * End of benchmarks
  ************************/
@@ -245,6 +350,8 @@ int main(int argc, char** argv) {
     shortRandom = generateRandom(&schemaShort);
     longRandom = generateRandom(&schemaLong);
 
+    prepareBatchData();
+
     if (FLAGS_benchmark) {
         folly::runBenchmarks();
         return 0;
@@ -363,6 +363,54 @@ TEST(RowWriterV2, Update) {
     EXPECT_EQ(v1, v2);
 }
 
+TEST(RowWriterV2, InPlaceUpdate) {
+    SchemaWriter schema(4 /*Schema version*/);
+    schema.appendCol("Col01", PropertyType::INT64);
+    schema.appendCol("Col02", PropertyType::STRING);
+    schema.appendCol("Col03", PropertyType::STRING, 0, true);
+
+    RowWriterV2 writer(&schema);
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer.set("Col01", 1234567));
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer.set("Col02", str));
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer.set("Col03", str));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.finish());
+    std::string encoded = writer.moveEncodedStr();
+
+    // Same length, the string is overwritten in place
+    RowWriterV2 updater1(&schema, encoded);
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater1.set("Col01", 7654321));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater1.set("Col02", fixed));
+    ASSERT_EQ(WriteResult::SUCCEEDED, updater1.finish());
+    std::string encoded1 = updater1.moveEncodedStr();
+    ASSERT_EQ(encoded.size(), encoded1.size());
+    // Only the int and the string content are changed
+    size_t diff = 0;
+    for (size_t i = 0; i < encoded.size(); i++) {
+        if (encoded[i] != encoded1[i]) {
+            diff++;
+        }
+    }
+    EXPECT_GE(sizeof(int64_t) + fixed.size(), diff);
+
+    auto reader1 = RowReader::getRowReader(&schema, encoded1);
+    EXPECT_EQ(7654321, reader1->getValueByName("Col01").getInt());
+    EXPECT_EQ(fixed, reader1->getValueByName("Col02").getStr());
+    EXPECT_EQ(str, reader1->getValueByName("Col03").getStr());
+
+    // Different length, the strings are relocated
+    RowWriterV2 updater2(&schema, encoded);
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater2.set("Col02", std::string("Nebula")));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater2.setNull("Col03"));
+    ASSERT_EQ(WriteResult::SUCCEEDED, updater2.finish());
+    std::string encoded2 = updater2.moveEncodedStr();
+    EXPECT_GT(encoded.size(), encoded2.size());
+
+    auto reader2 = RowReader::getRowReader(&schema, encoded2);
+    EXPECT_EQ(1234567, reader2->getValueByName("Col01").getInt());
+    EXPECT_EQ("Nebula", reader2->getValueByName("Col02").getStr());
+    EXPECT_EQ(Value::Type::NULLVALUE, reader2->getValueByName("Col03").type());
+}
+
 TEST(RowWriterV2, Timestamp) {
     SchemaWriter schema(20 /*Schema version*/);
     schema.appendCol("Col01", PropertyType::TIMESTAMP);
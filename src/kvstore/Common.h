@@ -59,6 +59,12 @@ public:
 using KV = std::pair<std::string, std::string>;
 using KVCallback = folly::Function<void(ResultCode code)>;
 using NewLeaderCallback = folly::Function<void(HostAddr nLeader)>;
+// Called when the local part is elected as the leader, or loses the leadership
+using LeaderChangedCallback = folly::Function<void(bool isLeader)>;
+// Called when a local part of the space is elected as the leader, or loses the leadership
+using LeaderListener = std::function<void(GraphSpaceID spaceId,
+                                          PartitionID partId,
+                                          bool isLeader)>;
 
 inline rocksdb::Slice toSlice(const folly::StringPiece& str) {
     return rocksdb::Slice(str.begin(), str.size());
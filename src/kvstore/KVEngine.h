@@ -63,6 +63,28 @@ public:
     virtual ResultCode prefix(const std::string& prefix,
                               std::unique_ptr<KVIterator>* iter) = 0;
 
+    // Get a consistent view of the engine, the reads with it are not affected
+    // by the later writes. It must be released by releaseSnapshot()
+    virtual const void* getSnapshot() = 0;
+
+    virtual void releaseSnapshot(const void* snapshot) = 0;
+
+    // Read a single key in the snapshot
+    virtual ResultCode get(const std::string& key,
+                           std::string* value,
+                           const void* snapshot) = 0;
+
+    // Get all results in range [start, end) in the snapshot
+    virtual ResultCode range(const std::string& start,
+                             const std::string& end,
+                             std::unique_ptr<KVIterator>* iter,
+                             const void* snapshot) = 0;
+
+    // Get all results with 'prefix' str as prefix in the snapshot
+    virtual ResultCode prefix(const std::string& prefix,
+                              std::unique_ptr<KVIterator>* iter,
+                              const void* snapshot) = 0;
+
     // Get all results with 'prefix' str as prefix starting form 'start'
     virtual ResultCode rangeWithPrefix(const std::string& start,
                                        const std::string& prefix,
@@ -97,9 +119,16 @@ public:
     // Return total parts num
     virtual int32_t totalPartsNum() = 0;
 
+    // Return the approximate bytes on disk of the keys in range [start, end)
+    virtual int64_t approximateSize(const std::string& start, const std::string& end) = 0;
+
     // Ingest sst files
     virtual ResultCode ingest(const std::vector<std::string>& files) = 0;
 
+    // Write the key values into an sst file which could be ingested later,
+    // the keys must be sorted and unique
+    virtual ResultCode writeSstFile(const std::string& path, const std::vector<KV>& kvs) = 0;
+
     // Set Config Option
     virtual ResultCode setOption(const std::string& configKey,
                                  const std::string& configValue) = 0;
@@ -110,6 +139,9 @@ public:
 
     virtual ResultCode compact() = 0;
 
+    // Compact the keys in range [start, end) only
+    virtual ResultCode compactRange(const std::string& start, const std::string& end) = 0;
+
     virtual ResultCode flush() = 0;
 
     virtual ResultCode createCheckpoint(const std::string& name) = 0;
@@ -22,6 +22,15 @@ public:
 
     virtual void prev() = 0;
 
+    // Move to the first key which is not less than the target. The iterator is still
+    // bounded by its range or prefix: a target before the lower bound moves to the
+    // first key, and the iterator becomes invalid if there is no key in the bounds.
+    virtual void seek(folly::StringPiece target) = 0;
+
+    // Move to the last key which is not greater than the target, in the bounds of
+    // the iterator as well
+    virtual void seekForPrev(folly::StringPiece target) = 0;
+
     virtual folly::StringPiece key() const = 0;
 
     virtual folly::StringPiece val() const = 0;
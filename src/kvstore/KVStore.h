@@ -43,6 +43,10 @@ struct KVOptions {
      * Custom CompactionFilter used in compaction.
      * */
     std::unique_ptr<CompactionFilterFactoryBuilder> cffBuilder_{nullptr};
+
+    // Get the vid length of a space, which is used by the engines which index the vertices
+    // and edges in memory. If it is not set, the keys would not be indexed.
+    std::function<StatusOr<int32_t>(GraphSpaceID)> vIdLenGetter_{nullptr};
 };
 
 
@@ -166,6 +170,10 @@ public:
     virtual ErrorOr<ResultCode, std::shared_ptr<Part>> part(GraphSpaceID spaceId,
                                                             PartitionID partId) = 0;
 
+    // Whether the part could be read on this host, i.e. this host is its leader,
+    // it is used when the data is served from somewhere other than the kvstore
+    virtual ResultCode checkLeader(GraphSpaceID spaceId, PartitionID partId) = 0;
+
     virtual ResultCode compact(GraphSpaceID spaceId) = 0;
 
     virtual ResultCode flush(GraphSpaceID spaceId) = 0;
@@ -176,6 +184,19 @@ public:
 
     virtual ResultCode setWriteBlocking(GraphSpaceID spaceId, bool sign) = 0;
 
+    // Move the part to another local data path
+    virtual ResultCode movePart(GraphSpaceID spaceId, PartitionID partId, int32_t pathIndex) = 0;
+
+    // Balance the disk usage and load between the local data paths
+    virtual ResultCode balanceDataPaths() = 0;
+
+    // Listen to the leadership changes of the local parts, e.g. to drop what is cached of
+    // them, returns the id to remove the listener
+    virtual int64_t addLeaderListener(LeaderListener listener) = 0;
+
+    // The listener is not being called once it returns
+    virtual void removeLeaderListener(int64_t id) = 0;
+
 protected:
     KVStore() = default;
 };
@@ -0,0 +1,663 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "kvstore/MemEngine.h"
+#include "utils/NebulaKeyUtils.h"
+
+DEFINE_int32(mem_engine_max_delta_keys, 4096,
+             "The max number of keys written into the in-memory engine before it is "
+             "rebuilt from disk");
+
+namespace nebula {
+namespace kvstore {
+
+namespace {
+
+// The smallest key which is larger than all keys with the prefix, none if there is no such key
+folly::Optional<std::string> prefixEnd(folly::StringPiece prefix) {
+    std::string end = prefix.str();
+    while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    if (end.empty()) {
+        return folly::none;
+    }
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    return end;
+}
+
+/***************************************
+ *
+ * Implementation of WriteBatch
+ *
+ **************************************/
+class MemWriteBatch : public WriteBatch {
+public:
+    explicit MemWriteBatch(std::unique_ptr<WriteBatch> batch)
+        : batch_(std::move(batch)) {}
+
+    ResultCode put(folly::StringPiece key, folly::StringPiece value) override {
+        auto code = batch_->put(key, value);
+        if (code == ResultCode::SUCCEEDED) {
+            writes_.emplace_back(MemWrite{key.str(), value.str(), folly::none});
+        }
+        return code;
+    }
+
+    ResultCode remove(folly::StringPiece key) override {
+        auto code = batch_->remove(key);
+        if (code == ResultCode::SUCCEEDED) {
+            writes_.emplace_back(MemWrite{key.str(), folly::none, folly::none});
+        }
+        return code;
+    }
+
+    ResultCode removeRange(folly::StringPiece start, folly::StringPiece end) override {
+        auto code = batch_->removeRange(start, end);
+        if (code == ResultCode::SUCCEEDED) {
+            writes_.emplace_back(MemWrite{start.str(), folly::none, end.str()});
+        }
+        return code;
+    }
+
+    std::unique_ptr<WriteBatch> release() {
+        return std::move(batch_);
+    }
+
+    std::vector<MemWrite> writes() {
+        return std::move(writes_);
+    }
+
+private:
+    std::unique_ptr<WriteBatch> batch_;
+    std::vector<MemWrite>       writes_;
+};
+
+}  // Anonymous namespace
+
+
+/***************************************
+ *
+ * Implementation of MemTable
+ *
+ **************************************/
+void MemTable::append(folly::StringPiece key, folly::StringPiece val) {
+    DCHECK(entries_.empty() || this->key(entries_.size() - 1) < key);
+    entries_.emplace_back(Entry{arena_.size(),
+                                static_cast<uint32_t>(key.size()),
+                                static_cast<uint32_t>(val.size())});
+    arena_.append(key.data(), key.size());
+    arena_.append(val.data(), val.size());
+}
+
+
+bool MemTable::indexable(folly::StringPiece key) const {
+    return key.size() == kVertexLen + vIdLen_ || key.size() == kEdgeLen + (vIdLen_ << 1);
+}
+
+
+void MemTable::finish() {
+    arena_.shrink_to_fit();
+    entries_.shrink_to_fit();
+    if (vIdLen_ == 0 || entries_.size() >= std::numeric_limits<uint32_t>::max()) {
+        return;
+    }
+
+    // The vertex and edge keys of a (part, vid) are adjacent, and they are grouped
+    // by the tag id or edge type following the vid. The separated edges of a vid are
+    // grouped on their own, as their key type differs.
+    const size_t vertexLen = sizeof(PartitionID) + vIdLen_;
+    folly::StringPiece lastVertex;
+    uint32_t dataEnd = 0;
+    for (size_t i = 0; i < entries_.size(); i++) {
+        auto k = key(i);
+        if (k.size() < sizeof(PartitionID) || !NebulaKeyUtils::isDataKey(k)) {
+            continue;
+        }
+        if (!indexable(k)) {
+            LOG(WARNING) << "Unknown data key of size " << k.size()
+                         << ", the keys are not indexed";
+            vertices_.clear();
+            vertexSlots_.clear();
+            slotIds_.clear();
+            slotRows_.clear();
+            return;
+        }
+        auto vertex = k.subpiece(0, vertexLen);
+        uint32_t id;
+        memcpy(&id, k.data() + vertexLen, sizeof(uint32_t));
+        if (vertexSlots_.empty() || vertex != lastVertex) {
+            vertices_.emplace(vertex, vertexSlots_.size());
+            vertexSlots_.emplace_back(slotIds_.size());
+            slotIds_.emplace_back(id);
+            slotRows_.emplace_back(i);
+            lastVertex = vertex;
+        } else if (id != slotIds_.back()) {
+            slotIds_.emplace_back(id);
+            slotRows_.emplace_back(i);
+        }
+        dataEnd = i + 1;
+    }
+    vertexSlots_.emplace_back(slotIds_.size());
+    slotRows_.emplace_back(dataEnd);
+    indexed_ = true;
+}
+
+
+size_t MemTable::lowerBound(folly::StringPiece key, size_t lo, size_t hi) const {
+    while (lo < hi) {
+        auto mid = lo + ((hi - lo) >> 1);
+        if (this->key(mid) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+
+std::pair<size_t, size_t> MemTable::range(folly::StringPiece start,
+                                          folly::StringPiece end) const {
+    auto lo = lowerBound(start, 0, entries_.size());
+    return {lo, lowerBound(end, lo, entries_.size())};
+}
+
+
+std::pair<size_t, size_t> MemTable::prefix(folly::StringPiece prefix,
+                                           size_t lo,
+                                           size_t hi) const {
+    lo = lowerBound(prefix, lo, hi);
+    auto end = prefixEnd(prefix);
+    if (end.hasValue()) {
+        hi = lowerBound(end.value(), lo, hi);
+    }
+    return {lo, hi};
+}
+
+
+std::pair<size_t, size_t> MemTable::prefix(folly::StringPiece prefix) const {
+    const size_t vertexLen = sizeof(PartitionID) + vIdLen_;
+    if (!indexed_ || prefix.size() < vertexLen || !NebulaKeyUtils::isDataKey(prefix)) {
+        return this->prefix(prefix, 0, entries_.size());
+    }
+
+    auto it = vertices_.find(prefix.subpiece(0, vertexLen));
+    if (it == vertices_.end()) {
+        return {0, 0};
+    }
+    auto slotBegin = vertexSlots_[it->second];
+    auto slotEnd = vertexSlots_[it->second + 1];
+    if (prefix.size() < vertexLen + sizeof(uint32_t)) {
+        return this->prefix(prefix, slotRows_[slotBegin], slotRows_[slotEnd]);
+    }
+
+    uint32_t id;
+    memcpy(&id, prefix.data() + vertexLen, sizeof(uint32_t));
+    for (auto slot = slotBegin; slot < slotEnd; slot++) {
+        if (slotIds_[slot] != id) {
+            continue;
+        }
+        if (prefix.size() == vertexLen + sizeof(uint32_t)) {
+            return {slotRows_[slot], slotRows_[slot + 1]};
+        }
+        return this->prefix(prefix, slotRows_[slot], slotRows_[slot + 1]);
+    }
+    return {0, 0};
+}
+
+
+bool MemTable::get(folly::StringPiece key, folly::StringPiece* val) const {
+    auto range = prefix(key);
+    auto idx = lowerBound(key, range.first, range.second);
+    if (idx == range.second || this->key(idx) != key) {
+        return false;
+    }
+    *val = this->val(idx);
+    return true;
+}
+
+
+/***************************************
+ *
+ * Implementation of MemIter
+ *
+ **************************************/
+MemIter::MemIter(std::shared_ptr<const MemTable> table,
+                 size_t lo,
+                 size_t hi,
+                 std::shared_ptr<const MemDelta> delta,
+                 MemDelta::const_iterator dLo,
+                 MemDelta::const_iterator dHi)
+    : table_(std::move(table))
+    , lo_(lo)
+    , hi_(hi)
+    , idx_(lo)
+    , delta_(std::move(delta))
+    , dLo_(dLo)
+    , dHi_(dHi)
+    , dIt_(dLo) {
+    skipRemoved();
+}
+
+
+void MemIter::next() {
+    if (!valid()) {
+        return;
+    }
+    if (fromDelta()) {
+        // the key in table is overridden by the delta
+        if (idx_ < hi_ && table_->key(idx_) == folly::StringPiece(dIt_->first)) {
+            ++idx_;
+        }
+        ++dIt_;
+    } else {
+        ++idx_;
+    }
+    skipRemoved();
+}
+
+
+void MemIter::skipRemoved() {
+    while (fromDelta() && !dIt_->second.hasValue()) {
+        if (idx_ < hi_ && table_->key(idx_) == folly::StringPiece(dIt_->first)) {
+            ++idx_;
+        }
+        ++dIt_;
+    }
+}
+
+
+void MemIter::prev() {
+    if (!valid()) {
+        return;
+    }
+    stepBack();
+}
+
+
+void MemIter::stepBack() {
+    while (true) {
+        bool hasTable = idx_ > lo_;
+        bool hasDelta = dIt_ != dLo_;
+        if (!hasTable && !hasDelta) {
+            invalidate();
+            return;
+        }
+        folly::StringPiece tableKey = hasTable ? table_->key(idx_ - 1) : folly::StringPiece();
+        folly::StringPiece deltaKey = hasDelta ? folly::StringPiece(std::prev(dIt_)->first)
+                                               : folly::StringPiece();
+        if (hasTable && (!hasDelta || tableKey >= deltaKey)) {
+            --idx_;
+        }
+        if (hasDelta && (!hasTable || deltaKey >= tableKey)) {
+            --dIt_;
+        }
+        if (!fromDelta() || dIt_->second.hasValue()) {
+            return;
+        }
+    }
+}
+
+
+void MemIter::seek(folly::StringPiece target) {
+    idx_ = table_->lowerBound(target, lo_, hi_);
+    dIt_ = std::lower_bound(dLo_, dHi_, target,
+                            [] (const MemDelta::value_type& kv, folly::StringPiece t) {
+                                return folly::StringPiece(kv.first) < t;
+                            });
+    skipRemoved();
+}
+
+
+void MemIter::seekForPrev(folly::StringPiece target) {
+    seek(target);
+    if (valid() && key() == target) {
+        return;
+    }
+    stepBack();
+}
+
+
+/***************************************
+ *
+ * Implementation of MemEngine
+ *
+ **************************************/
+MemEngine::MemEngine(GraphSpaceID spaceId,
+                     const std::string& dataPath,
+                     size_t vIdLen,
+                     std::shared_ptr<rocksdb::MergeOperator> mergeOp,
+                     std::shared_ptr<rocksdb::CompactionFilterFactory> cfFactory)
+        : KVEngine(spaceId)
+        , persist_(std::make_unique<RocksEngine>(spaceId, dataPath, mergeOp, cfFactory))
+        , vIdLen_(vIdLen) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    rebuild();
+}
+
+
+MemEngine::Snapshot MemEngine::current() {
+    folly::RWSpinLock::ReadHolder rh(&lock_);
+    return Snapshot{table_, delta_};
+}
+
+
+void MemEngine::rebuild() {
+    auto table = std::make_shared<MemTable>(vIdLen_);
+    // The iterator keeps a reference to the prefix
+    const std::string all;
+    std::unique_ptr<KVIterator> iter;
+    CHECK_EQ(ResultCode::SUCCEEDED, persist_->prefix(all, &iter));
+    while (iter->valid()) {
+        table->append(iter->key(), iter->val());
+        iter->next();
+    }
+    table->finish();
+    LOG(INFO) << "Load " << table->size() << " keys of space " << spaceId_
+              << " into memory, " << table->memoryUsage() << " bytes";
+
+    folly::RWSpinLock::WriteHolder wh(&lock_);
+    table_ = std::move(table);
+    delta_ = std::make_shared<const MemDelta>();
+}
+
+
+void MemEngine::applyDelta(std::vector<MemWrite> writes) {
+    auto snapshot = current();
+    auto delta = std::make_shared<MemDelta>(*snapshot.delta);
+    for (auto& write : writes) {
+        if (!write.end.hasValue()) {
+            (*delta)[write.key] = std::move(write.val);
+            continue;
+        }
+        const auto& end = write.end.value();
+        auto range = snapshot.table->range(write.key, end);
+        if (range.second - range.first + delta->size()
+                > static_cast<size_t>(FLAGS_mem_engine_max_delta_keys)) {
+            rebuild();
+            return;
+        }
+        for (auto i = range.first; i < range.second; i++) {
+            (*delta)[snapshot.table->key(i).str()] = folly::none;
+        }
+        for (auto it = delta->lower_bound(write.key); it != delta->end() && it->first < end;
+             ++it) {
+            it->second = folly::none;
+        }
+    }
+    if (delta->size() > static_cast<size_t>(FLAGS_mem_engine_max_delta_keys)) {
+        rebuild();
+        return;
+    }
+
+    folly::RWSpinLock::WriteHolder wh(&lock_);
+    delta_ = std::move(delta);
+}
+
+
+void MemEngine::reload(const std::string& key) {
+    std::string value;
+    auto code = persist_->get(key, &value);
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta({MemWrite{key, std::move(value), folly::none}});
+    } else if (code == ResultCode::ERR_KEY_NOT_FOUND) {
+        applyDelta({MemWrite{key, folly::none, folly::none}});
+    } else {
+        LOG(ERROR) << "Reload key failed, rebuild the whole table";
+        rebuild();
+    }
+}
+
+
+std::unique_ptr<WriteBatch> MemEngine::startBatchWrite() {
+    return std::make_unique<MemWriteBatch>(persist_->startBatchWrite());
+}
+
+
+ResultCode MemEngine::commitBatchWrite(std::unique_ptr<WriteBatch> batch, bool disableWAL) {
+    auto* b = static_cast<MemWriteBatch*>(batch.get());
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->commitBatchWrite(b->release(), disableWAL);
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta(b->writes());
+    }
+    return code;
+}
+
+
+ResultCode MemEngine::get(const std::string& key, std::string* value) {
+    return get(current(), key, value);
+}
+
+
+ResultCode MemEngine::get(const std::string& key,
+                          std::string* value,
+                          const void* snapshot) {
+    if (snapshot == nullptr) {
+        return get(current(), key, value);
+    }
+    return get(*reinterpret_cast<const Snapshot*>(snapshot), key, value);
+}
+
+
+ResultCode MemEngine::get(const Snapshot& snapshot,
+                          const std::string& key,
+                          std::string* value) {
+    auto it = snapshot.delta->find(key);
+    if (it != snapshot.delta->end()) {
+        if (!it->second.hasValue()) {
+            VLOG(3) << "Get: " << key << " Not Found";
+            return ResultCode::ERR_KEY_NOT_FOUND;
+        }
+        *value = it->second.value();
+        return ResultCode::SUCCEEDED;
+    }
+    folly::StringPiece val;
+    if (!snapshot.table->get(key, &val)) {
+        VLOG(3) << "Get: " << key << " Not Found";
+        return ResultCode::ERR_KEY_NOT_FOUND;
+    }
+    value->assign(val.data(), val.size());
+    return ResultCode::SUCCEEDED;
+}
+
+
+std::vector<Status> MemEngine::multiGet(const std::vector<std::string>& keys,
+                                        std::vector<std::string>* values) {
+    auto snapshot = current();
+    values->resize(keys.size());
+    std::vector<Status> ret;
+    ret.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+        if (get(snapshot, keys[i], &(*values)[i]) == ResultCode::SUCCEEDED) {
+            ret.emplace_back(Status::OK());
+        } else {
+            ret.emplace_back(Status::KeyNotFound());
+        }
+    }
+    return ret;
+}
+
+
+std::unique_ptr<KVIterator> MemEngine::range(const Snapshot& snapshot,
+                                             folly::StringPiece start,
+                                             folly::StringPiece end) {
+    auto range = snapshot.table->range(start, end);
+    const auto& delta = snapshot.delta;
+    auto dLo = delta->lower_bound(start.str());
+    auto dHi = start < end ? delta->lower_bound(end.str()) : dLo;
+    return std::make_unique<MemIter>(snapshot.table, range.first, range.second,
+                                     snapshot.delta, dLo, dHi);
+}
+
+
+std::unique_ptr<KVIterator> MemEngine::prefix(const Snapshot& snapshot,
+                                              folly::StringPiece start,
+                                              folly::StringPiece prefix) {
+    auto range = snapshot.table->prefix(prefix);
+    if (start > prefix) {
+        range.first = snapshot.table->lowerBound(start, range.first, range.second);
+    } else {
+        start = prefix;
+    }
+    const auto& delta = snapshot.delta;
+    auto dLo = delta->lower_bound(start.str());
+    auto end = prefixEnd(prefix);
+    auto dHi = end.hasValue() ? delta->lower_bound(end.value()) : delta->end();
+    if (end.hasValue() && start >= folly::StringPiece(end.value())) {
+        dHi = dLo;
+    }
+    return std::make_unique<MemIter>(snapshot.table, range.first, range.second,
+                                     snapshot.delta, dLo, dHi);
+}
+
+
+ResultCode MemEngine::range(const std::string& start,
+                            const std::string& end,
+                            std::unique_ptr<KVIterator>* iter) {
+    *iter = range(current(), start, end);
+    return ResultCode::SUCCEEDED;
+}
+
+
+ResultCode MemEngine::range(const std::string& start,
+                            const std::string& end,
+                            std::unique_ptr<KVIterator>* iter,
+                            const void* snapshot) {
+    if (snapshot == nullptr) {
+        *iter = range(current(), start, end);
+    } else {
+        *iter = range(*reinterpret_cast<const Snapshot*>(snapshot), start, end);
+    }
+    return ResultCode::SUCCEEDED;
+}
+
+
+ResultCode MemEngine::prefix(const std::string& prefix,
+                             std::unique_ptr<KVIterator>* iter) {
+    *iter = this->prefix(current(), prefix, prefix);
+    return ResultCode::SUCCEEDED;
+}
+
+
+ResultCode MemEngine::prefix(const std::string& prefix,
+                             std::unique_ptr<KVIterator>* iter,
+                             const void* snapshot) {
+    if (snapshot == nullptr) {
+        *iter = this->prefix(current(), prefix, prefix);
+    } else {
+        *iter = this->prefix(*reinterpret_cast<const Snapshot*>(snapshot), prefix, prefix);
+    }
+    return ResultCode::SUCCEEDED;
+}
+
+
+ResultCode MemEngine::rangeWithPrefix(const std::string& start,
+                                      const std::string& prefix,
+                                      std::unique_ptr<KVIterator>* iter) {
+    *iter = this->prefix(current(), start, prefix);
+    return ResultCode::SUCCEEDED;
+}
+
+
+const void* MemEngine::getSnapshot() {
+    return new Snapshot(current());
+}
+
+
+void MemEngine::releaseSnapshot(const void* snapshot) {
+    delete reinterpret_cast<const Snapshot*>(snapshot);
+}
+
+
+ResultCode MemEngine::put(std::string key, std::string value) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->put(key, value);
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta({MemWrite{std::move(key), std::move(value), folly::none}});
+    }
+    return code;
+}
+
+
+ResultCode MemEngine::multiPut(std::vector<KV> keyValues) {
+    std::vector<MemWrite> writes;
+    writes.reserve(keyValues.size());
+    for (const auto& kv : keyValues) {
+        writes.emplace_back(MemWrite{kv.first, kv.second, folly::none});
+    }
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->multiPut(std::move(keyValues));
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta(std::move(writes));
+    }
+    return code;
+}
+
+
+ResultCode MemEngine::remove(const std::string& key) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->remove(key);
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta({MemWrite{key, folly::none, folly::none}});
+    }
+    return code;
+}
+
+
+ResultCode MemEngine::multiRemove(std::vector<std::string> keys) {
+    std::vector<MemWrite> writes;
+    writes.reserve(keys.size());
+    for (const auto& key : keys) {
+        writes.emplace_back(MemWrite{key, folly::none, folly::none});
+    }
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->multiRemove(std::move(keys));
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta(std::move(writes));
+    }
+    return code;
+}
+
+
+ResultCode MemEngine::removeRange(const std::string& start,
+                                  const std::string& end) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->removeRange(start, end);
+    if (code == ResultCode::SUCCEEDED) {
+        applyDelta({MemWrite{start, folly::none, end}});
+    }
+    return code;
+}
+
+
+void MemEngine::addPart(PartitionID partId) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    persist_->addPart(partId);
+    reload(NebulaKeyUtils::systemPartKey(partId));
+}
+
+
+void MemEngine::removePart(PartitionID partId) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    persist_->removePart(partId);
+    reload(NebulaKeyUtils::systemPartKey(partId));
+}
+
+
+ResultCode MemEngine::ingest(const std::vector<std::string>& files) {
+    std::lock_guard<std::mutex> g(writeLock_);
+    auto code = persist_->ingest(files);
+    if (code == ResultCode::SUCCEEDED) {
+        rebuild();
+    }
+    return code;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,353 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_MEMENGINE_H_
+#define KVSTORE_MEMENGINE_H_
+
+#include "common/base/Base.h"
+#include <gtest/gtest_prod.h>
+#include <folly/RWSpinLock.h>
+#include "kvstore/KVIterator.h"
+#include "kvstore/KVEngine.h"
+#include "kvstore/RocksEngine.h"
+
+namespace nebula {
+namespace kvstore {
+
+/**
+ * An immutable sorted key-value table, all keys and values are kept in one contiguous arena.
+ *
+ * When the vid length of the space is known, the vertex and edge keys are indexed in a CSR
+ * layout: each (part, vid) is a row of the directory, its slots are the distinct tag ids and
+ * edge types, and each slot points to the contiguous entries of it. So the prefix of a vertex
+ * or of the edges of a type is located by one hash lookup and a search in a few slots, instead
+ * of a binary search on the whole table.
+ * */
+class MemTable final {
+public:
+    explicit MemTable(size_t vIdLen) : vIdLen_(vIdLen) {}
+
+    // The keys must be appended in order and unique
+    void append(folly::StringPiece key, folly::StringPiece val);
+
+    // Build the directory after all keys are appended
+    void finish();
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    folly::StringPiece key(size_t idx) const {
+        const auto& entry = entries_[idx];
+        return folly::StringPiece(arena_.data() + entry.offset, entry.keyLen);
+    }
+
+    folly::StringPiece val(size_t idx) const {
+        const auto& entry = entries_[idx];
+        return folly::StringPiece(arena_.data() + entry.offset + entry.keyLen, entry.valLen);
+    }
+
+    // The first entry in [lo, hi) whose key is not less than the given one
+    size_t lowerBound(folly::StringPiece key, size_t lo, size_t hi) const;
+
+    // Entries in [start, end)
+    std::pair<size_t, size_t> range(folly::StringPiece start, folly::StringPiece end) const;
+
+    // Entries with the prefix
+    std::pair<size_t, size_t> prefix(folly::StringPiece prefix) const;
+
+    bool get(folly::StringPiece key, folly::StringPiece* val) const;
+
+    size_t memoryUsage() const {
+        return arena_.capacity() + entries_.capacity() * sizeof(Entry)
+             + vertexSlots_.capacity() * sizeof(uint32_t)
+             + slotIds_.capacity() * sizeof(uint32_t)
+             + slotRows_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct Entry {
+        size_t      offset;
+        uint32_t    keyLen;
+        uint32_t    valLen;
+    };
+
+    // The entries with the prefix in [lo, hi) by binary search
+    std::pair<size_t, size_t> prefix(folly::StringPiece prefix, size_t lo, size_t hi) const;
+
+    // Whether the key is a vertex key or an edge key, which could be put into the directory
+    bool indexable(folly::StringPiece key) const;
+
+private:
+    size_t                                          vIdLen_;
+    std::string                                     arena_;
+    std::vector<Entry>                              entries_;
+
+    // The directory is only used when all data keys are indexable
+    bool                                            indexed_{false};
+    // (part, vid) => index of vertexSlots_, the key points into arena_
+    std::unordered_map<folly::StringPiece, uint32_t> vertices_;
+    // slots of vertex v are [vertexSlots_[v], vertexSlots_[v + 1])
+    std::vector<uint32_t>                           vertexSlots_;
+    // the raw tag id or edge type of each slot
+    std::vector<uint32_t>                           slotIds_;
+    // entries of slot s are [slotRows_[s], slotRows_[s + 1])
+    std::vector<uint32_t>                           slotRows_;
+};
+
+// Keys written after the MemTable is built, none means the key has been removed
+using MemDelta = std::map<std::string, folly::Optional<std::string>>;
+
+// A write to be applied on the delta: put the key if val is set, otherwise remove it.
+// If end is set, the range [key, end) is removed.
+struct MemWrite {
+    std::string                     key;
+    folly::Optional<std::string>    val;
+    folly::Optional<std::string>    end;
+};
+
+/**
+ * Iterate over the entries [lo, hi) of a MemTable and the entries [dLo, dHi) of a delta,
+ * the delta overrides the table.
+ * */
+class MemIter : public KVIterator {
+public:
+    MemIter(std::shared_ptr<const MemTable> table,
+            size_t lo,
+            size_t hi,
+            std::shared_ptr<const MemDelta> delta,
+            MemDelta::const_iterator dLo,
+            MemDelta::const_iterator dHi);
+
+    bool valid() const override {
+        return idx_ < hi_ || dIt_ != dHi_;
+    }
+
+    void next() override;
+
+    void prev() override;
+
+    void seek(folly::StringPiece target) override;
+
+    void seekForPrev(folly::StringPiece target) override;
+
+    folly::StringPiece key() const override {
+        return fromDelta() ? folly::StringPiece(dIt_->first) : table_->key(idx_);
+    }
+
+    folly::StringPiece val() const override {
+        return fromDelta() ? folly::StringPiece(dIt_->second.value()) : table_->val(idx_);
+    }
+
+private:
+    // Whether the current entry is from the delta
+    bool fromDelta() const {
+        return dIt_ != dHi_
+            && (idx_ == hi_ || table_->key(idx_) >= folly::StringPiece(dIt_->first));
+    }
+
+    void skipRemoved();
+
+    // Move to the largest key which is less than the current one, it is also used to move
+    // back from the end
+    void stepBack();
+
+    void invalidate() {
+        idx_ = hi_;
+        dIt_ = dHi_;
+    }
+
+private:
+    std::shared_ptr<const MemTable>     table_;
+    size_t                              lo_;
+    size_t                              hi_;
+    // the first entry of table which is not less than the current key
+    size_t                              idx_;
+    std::shared_ptr<const MemDelta>     delta_;
+    MemDelta::const_iterator            dLo_;
+    MemDelta::const_iterator            dHi_;
+    // the first entry of delta which is not less than the current key
+    MemDelta::const_iterator            dIt_;
+};
+
+/**************************************************************************
+ *
+ * An in-memory engine for the read-mostly spaces.
+ *
+ * The data is persisted by a RocksEngine under the same path, and loaded into a MemTable
+ * when the engine is opened, e.g. on a data path restored from a checkpoint, and after
+ * ingesting sst files. All reads are served by the MemTable without any seek in LSM.
+ *
+ * The writes are applied on the RocksEngine first, then kept in a small delta which
+ * overrides the MemTable. Once the delta is too large, or a range of keys is removed,
+ * the MemTable is rebuilt from the RocksEngine. So it is only suitable for the spaces
+ * which are rarely written, except the system keys of raft.
+ *
+ *************************************************************************/
+class MemEngine : public KVEngine {
+    FRIEND_TEST(MemEngineTest, RebuildTest);
+
+public:
+    MemEngine(GraphSpaceID spaceId,
+              const std::string& dataPath,
+              size_t vIdLen,
+              std::shared_ptr<rocksdb::MergeOperator> mergeOp = nullptr,
+              std::shared_ptr<rocksdb::CompactionFilterFactory> cfFactory = nullptr);
+
+    ~MemEngine() = default;
+
+    const char* getDataRoot() const override {
+        return persist_->getDataRoot();
+    }
+
+    std::unique_ptr<WriteBatch> startBatchWrite() override;
+
+    ResultCode commitBatchWrite(std::unique_ptr<WriteBatch> batch,
+                                bool disableWAL) override;
+
+    /*********************
+     * Data retrieval
+     ********************/
+    ResultCode get(const std::string& key, std::string* value) override;
+
+    std::vector<Status> multiGet(const std::vector<std::string>& keys,
+                                 std::vector<std::string>* values) override;
+
+    ResultCode range(const std::string& start,
+                     const std::string& end,
+                     std::unique_ptr<KVIterator>* iter) override;
+
+    ResultCode prefix(const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter) override;
+
+    ResultCode rangeWithPrefix(const std::string& start,
+                               const std::string& prefix,
+                               std::unique_ptr<KVIterator>* iter) override;
+
+    const void* getSnapshot() override;
+
+    void releaseSnapshot(const void* snapshot) override;
+
+    ResultCode get(const std::string& key,
+                   std::string* value,
+                   const void* snapshot) override;
+
+    ResultCode range(const std::string& start,
+                     const std::string& end,
+                     std::unique_ptr<KVIterator>* iter,
+                     const void* snapshot) override;
+
+    ResultCode prefix(const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter,
+                      const void* snapshot) override;
+
+    /*********************
+     * Data modification
+     ********************/
+    ResultCode put(std::string key, std::string value) override;
+
+    ResultCode multiPut(std::vector<KV> keyValues) override;
+
+    ResultCode remove(const std::string& key) override;
+
+    ResultCode multiRemove(std::vector<std::string> keys) override;
+
+    ResultCode removeRange(const std::string& start,
+                           const std::string& end) override;
+
+    /*********************
+     * Non-data operation
+     ********************/
+    void addPart(PartitionID partId) override;
+
+    void removePart(PartitionID partId) override;
+
+    std::vector<PartitionID> allParts() override {
+        return persist_->allParts();
+    }
+
+    int32_t totalPartsNum() override {
+        return persist_->totalPartsNum();
+    }
+
+    int64_t approximateSize(const std::string& start, const std::string& end) override {
+        return persist_->approximateSize(start, end);
+    }
+
+    ResultCode ingest(const std::vector<std::string>& files) override;
+
+    ResultCode writeSstFile(const std::string& path, const std::vector<KV>& kvs) override {
+        return persist_->writeSstFile(path, kvs);
+    }
+
+    ResultCode setOption(const std::string& configKey,
+                         const std::string& configValue) override {
+        return persist_->setOption(configKey, configValue);
+    }
+
+    ResultCode setDBOption(const std::string& configKey,
+                           const std::string& configValue) override {
+        return persist_->setDBOption(configKey, configValue);
+    }
+
+    ResultCode compact() override {
+        return persist_->compact();
+    }
+
+    ResultCode compactRange(const std::string& start, const std::string& end) override {
+        return persist_->compactRange(start, end);
+    }
+
+    ResultCode flush() override {
+        return persist_->flush();
+    }
+
+    ResultCode createCheckpoint(const std::string& name) override {
+        return persist_->createCheckpoint(name);
+    }
+
+private:
+    struct Snapshot {
+        std::shared_ptr<const MemTable> table;
+        std::shared_ptr<const MemDelta> delta;
+    };
+
+    Snapshot current();
+
+    ResultCode get(const Snapshot& snapshot, const std::string& key, std::string* value);
+
+    std::unique_ptr<KVIterator> range(const Snapshot& snapshot,
+                                      folly::StringPiece start,
+                                      folly::StringPiece end);
+
+    std::unique_ptr<KVIterator> prefix(const Snapshot& snapshot,
+                                       folly::StringPiece start,
+                                       folly::StringPiece prefix);
+
+    // Load all data from the RocksEngine into a new MemTable, must be called with writeLock_
+    void rebuild();
+
+    // Apply the writes which have been persisted onto the delta, must be called with writeLock_
+    void applyDelta(std::vector<MemWrite> writes);
+
+    // Reload a key from the RocksEngine into the delta, must be called with writeLock_
+    void reload(const std::string& key);
+
+private:
+    std::unique_ptr<RocksEngine>        persist_;
+    size_t                              vIdLen_;
+
+    // Serialize the writes, so the MemTable and delta always match the RocksEngine
+    std::mutex                          writeLock_;
+    // Protect the pointers of the MemTable and delta, both of them are immutable
+    folly::RWSpinLock                   lock_;
+    std::shared_ptr<const MemTable>     table_;
+    std::shared_ptr<const MemDelta>     delta_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_MEMENGINE_H_
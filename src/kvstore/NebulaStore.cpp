@@ -7,22 +7,129 @@
 #include "common/base/Base.h"
 #include "common/fs/FileUtils.h"
 #include "common/network/NetworkUtils.h"
+#include "common/time/WallClock.h"
 #include "kvstore/NebulaStore.h"
 #include <folly/Likely.h>
+#include <folly/ScopeGuard.h>
+#include <rocksdb/statistics.h>
 #include <algorithm>
 #include <cstdint>
+#include <fstream>
+#include "kvstore/MemEngine.h"
+#include "kvstore/PendingWrites.h"
 #include "kvstore/RocksEngine.h"
+#include "kvstore/RocksEngineConfig.h"
 #include "kvstore/SnapshotManagerImpl.h"
 
 DEFINE_string(engine_type, "rocksdb", "rocksdb, memory...");
+DEFINE_string(memory_engine_spaces, "",
+              "Comma separated ids of the read-mostly spaces, which are loaded into memory "
+              "no matter what the engine_type is");
 DEFINE_int32(custom_filter_interval_secs, 24 * 3600, "interval to trigger custom compaction");
 DEFINE_int32(num_workers, 4, "Number of worker threads");
 DEFINE_bool(check_leader, true, "Check leader or not");
+DEFINE_int32(num_load_part_threads, 0,
+             "Number of threads to open the engines and load the parts when starting, "
+             "0 means the number of cpu cores");
+DEFINE_int32(data_path_balance_interval_secs, 0,
+             "Interval to check the disk usage and the load of the data paths, and move "
+             "a part between them if unbalanced, 0 means disabled");
+DEFINE_double(data_path_balance_threshold, 0.2,
+              "The data paths are unbalanced if the difference of their disk usage or load "
+              "is larger than the ratio of average");
+DEFINE_int32(move_part_sst_size_mb, 64,
+             "Size of each sst file when moving a part between data paths");
 
 namespace nebula {
 namespace kvstore {
 
+namespace {
+
+// The smallest key which is larger than all keys with the prefix
+std::string prefixEnd(const std::string& prefix) {
+    std::string end = prefix;
+    while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    CHECK(!end.empty());
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    return end;
+}
+
+// The prefixes of the data, index, uuid and separated edge keys of the part, in order.
+// Besides them a part only has the system keys of its committed log id and itself.
+std::vector<std::string> partPrefixes(PartitionID partId) {
+    return {NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kData),
+            NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kIndex),
+            NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kUUID),
+            NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kEdge)};
+}
+
+ErrorOr<ResultCode, LogID> committedLogId(KVEngine* engine,
+                                          PartitionID partId,
+                                          const void* snapshot = nullptr) {
+    std::string val;
+    auto code = snapshot == nullptr
+              ? engine->get(NebulaKeyUtils::systemCommitKey(partId), &val)
+              : engine->get(NebulaKeyUtils::systemCommitKey(partId), &val, snapshot);
+    if (code == ResultCode::ERR_KEY_NOT_FOUND) {
+        return 0;
+    } else if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+    CHECK_EQ(val.size(), sizeof(LogID) + sizeof(TermID));
+    LogID logId;
+    memcpy(reinterpret_cast<void*>(&logId), val.data(), sizeof(LogID));
+    return logId;
+}
+
+// Remove all keys of the part except the key of the part itself
+ResultCode removePartData(KVEngine* engine, PartitionID partId) {
+    for (auto& prefix : partPrefixes(partId)) {
+        auto code = engine->removeRange(prefix, prefixEnd(prefix));
+        if (code != ResultCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    auto code = engine->remove(NebulaKeyUtils::systemCommitKey(partId));
+    return code == ResultCode::ERR_KEY_NOT_FOUND ? ResultCode::SUCCEEDED : code;
+}
+
+bool copyDir(const std::string& src, const std::string& dst) {
+    if (fs::FileUtils::exist(dst) && !fs::FileUtils::remove(dst.c_str(), true)) {
+        return false;
+    }
+    if (!fs::FileUtils::makeDir(dst)) {
+        return false;
+    }
+    for (auto& file : fs::FileUtils::listAllFilesInDir(src.c_str())) {
+        std::ifstream srcF(fs::FileUtils::joinPath(src, file), std::ios::binary);
+        std::ofstream dstF(fs::FileUtils::joinPath(dst, file), std::ios::binary);
+        dstF << srcF.rdbuf();
+        dstF.flush();
+        if (!srcF || !dstF) {
+            LOG(ERROR) << "Copy " << file << " from " << src << " to " << dst << " failed";
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 NebulaStore::~NebulaStore() {
+    {
+        // The parts losing the leadership while stopping notify nobody
+        std::lock_guard<std::mutex> g(listenersLock_);
+        leaderListeners_.clear();
+    }
+    if (metricsCollector_ >= 0) {
+        metrics::Metrics::instance()->removeCollector(metricsCollector_);
+    }
+    if (balancer_ != nullptr) {
+        balancer_->stop();
+        balancer_->wait();
+    }
     LOG(INFO) << "Cut off the relationship with meta client";
     options_.partMan_.reset();
     LOG(INFO) << "Stop the raft service...";
@@ -49,126 +156,8 @@ bool NebulaStore::init() {
     }
 
     CHECK(!!options_.partMan_);
-    LOG(INFO) << "Scan the local path, and init the spaces_";
-    {
-        for (auto& path : options_.dataPaths_) {
-            auto rootPath = folly::stringPrintf("%s/nebula", path.c_str());
-            auto dirs = fs::FileUtils::listAllDirsInDir(rootPath.c_str());
-            for (auto& dir : dirs) {
-                LOG(INFO) << "Scan path \"" << path << "/" << dir << "\"";
-                try {
-                    GraphSpaceID spaceId;
-                    try {
-                        spaceId = folly::to<GraphSpaceID>(dir);
-                    } catch (const std::exception& ex) {
-                        LOG(ERROR) << "Data path invalid: " << ex.what();
-                        return false;
-                    }
-
-                    if (!options_.partMan_->spaceExist(storeSvcAddr_, spaceId).ok()) {
-                        // TODO We might want to have a second thought here.
-                        // Removing the data directly feels a little strong
-                        LOG(INFO) << "Space " << spaceId
-                                  << " does not exist any more, remove the data!";
-                        auto dataPath = folly::stringPrintf("%s/%s",
-                                                            rootPath.c_str(),
-                                                            dir.c_str());
-                        CHECK(fs::FileUtils::remove(dataPath.c_str(), true));
-                        continue;
-                    }
-
-                    KVEngine* enginePtr = nullptr;
-                    {
-                        folly::RWSpinLock::WriteHolder wh(&lock_);
-                        auto engine = newEngine(spaceId, path);
-                        auto spaceIt = this->spaces_.find(spaceId);
-                        if (spaceIt == this->spaces_.end()) {
-                            LOG(INFO) << "Load space " << spaceId << " from disk";
-                            spaceIt = this->spaces_.emplace(
-                                spaceId,
-                                std::make_unique<SpacePartInfo>()).first;
-                        }
-                        spaceIt->second->engines_.emplace_back(std::move(engine));
-                        enginePtr = spaceIt->second->engines_.back().get();
-                    }
-
-                    // partIds is the partition in this host waiting to open
-                    std::vector<PartitionID> partIds;
-                    for (auto& partId : enginePtr->allParts()) {
-                        if (!options_.partMan_->partExist(storeSvcAddr_, spaceId, partId).ok()) {
-                            LOG(INFO) << "Part " << partId
-                                      << " does not exist any more, remove it!";
-                            enginePtr->removePart(partId);
-                            continue;
-                        } else {
-                             auto it = std::find(partIds.begin(), partIds.end(), partId);
-                             if (it != partIds.end()) {
-                                LOG(INFO) << "Part " << partId
-                                          << " has been loaded, skip current one, remove it!";
-                                enginePtr->removePart(partId);
-                             } else {
-                                partIds.emplace_back(partId);
-                             }
-                        }
-                    }
-                    if (partIds.empty()) {
-                        continue;
-                    }
-
-                    std::atomic<size_t> counter(partIds.size());
-                    folly::Baton<true, std::atomic> baton;
-                    LOG(INFO) << "Need to open " << partIds.size() << " parts of space " << spaceId;
-                    for (auto& partId : partIds) {
-                        bgWorkers_->addTask([
-                                spaceId, partId, enginePtr, &counter, &baton, this] () mutable {
-                            auto part = std::make_shared<Part>(spaceId,
-                                                               partId,
-                                                               raftAddr_,
-                                                               folly::stringPrintf("%s/wal/%d",
-                                                                       enginePtr->getDataRoot(),
-                                                                       partId),
-                                                               enginePtr,
-                                                               ioPool_,
-                                                               bgWorkers_,
-                                                               workers_,
-                                                               snapshot_,
-                                                               clientMan_);
-                            auto status = options_.partMan_->partMeta(spaceId, partId);
-                            if (!status.ok()) {
-                                LOG(WARNING) << status.status().toString();
-                                return;
-                            }
-                            auto partMeta = status.value();
-                            std::vector<HostAddr> peers;
-                            for (auto& h : partMeta.hosts_) {
-                                if (h != storeSvcAddr_) {
-                                    peers.emplace_back(getRaftAddr(h));
-                                    VLOG(1) << "Add peer " << peers.back();
-                                }
-                            }
-                            raftService_->addPartition(part);
-                            part->start(std::move(peers), false);
-                            LOG(INFO) << "Load part " << spaceId << ", " << partId << " from disk";
-
-                            {
-                                folly::RWSpinLock::WriteHolder holder(&lock_);
-                                auto iter = spaces_.find(spaceId);
-                                CHECK(iter != spaces_.end());
-                                iter->second->parts_.emplace(partId, part);
-                            }
-                            counter.fetch_sub(1);
-                            if (counter.load() == 0) {
-                                baton.post();
-                            }
-                        });
-                    }
-                    baton.wait();
-                    LOG(INFO) << "Load space " << spaceId << " complete";
-                } catch (std::exception& e) {
-                    LOG(FATAL) << "Invalid data directory \"" << dir << "\"";
-                }
-            }
-        }
+    if (!loadPartsFromDisk()) {
+        return false;
     }
 
     LOG(INFO) << "Init data from partManager for " << storeSvcAddr_;
@@ -188,18 +177,220 @@ bool NebulaStore::init() {
 
     LOG(INFO) << "Register handler...";
     options_.partMan_->registerHandler(this);
+
+    if (FLAGS_data_path_balance_interval_secs > 0 && options_.dataPaths_.size() > 1) {
+        balancer_ = std::make_unique<thread::GenericWorker>();
+        CHECK(balancer_->start("nebula-balancer"));
+        balancer_->addRepeatTask(FLAGS_data_path_balance_interval_secs * 1000, [this] {
+            auto code = balanceDataPaths();
+            if (code != ResultCode::SUCCEEDED) {
+                LOG(ERROR) << "Balance data paths failed, error "
+                           << static_cast<int32_t>(code);
+            }
+        });
+    }
+    metricsCollector_ = metrics::Metrics::instance()->addCollector([this] {
+        return collectMetrics();
+    });
+    return true;
+}
+
+
+bool NebulaStore::loadPartsFromDisk() {
+    LOG(INFO) << "Scan the local path, and init the spaces_";
+    // The engines of all spaces on all data paths
+    std::vector<std::pair<GraphSpaceID, std::string>> enginesToOpen;
+    for (auto& path : options_.dataPaths_) {
+        auto rootPath = folly::stringPrintf("%s/nebula", path.c_str());
+        auto dirs = fs::FileUtils::listAllDirsInDir(rootPath.c_str());
+        for (auto& dir : dirs) {
+            LOG(INFO) << "Scan path \"" << path << "/" << dir << "\"";
+            GraphSpaceID spaceId;
+            try {
+                spaceId = folly::to<GraphSpaceID>(dir);
+            } catch (const std::exception& ex) {
+                LOG(ERROR) << "Data path invalid: " << ex.what();
+                return false;
+            }
+
+            if (!options_.partMan_->spaceExist(storeSvcAddr_, spaceId).ok()) {
+                // TODO We might want to have a second thought here.
+                // Removing the data directly feels a little strong
+                LOG(INFO) << "Space " << spaceId
+                          << " does not exist any more, remove the data!";
+                auto dataPath = folly::stringPrintf("%s/%s",
+                                                    rootPath.c_str(),
+                                                    dir.c_str());
+                CHECK(fs::FileUtils::remove(dataPath.c_str(), true));
+                continue;
+            }
+            enginesToOpen.emplace_back(spaceId, path);
+        }
+    }
+    if (enginesToOpen.empty()) {
+        return true;
+    }
+
+    // Opening the engines and loading the parts (mostly scanning the wal) are
+    // independent of each other, so all of them are done in parallel instead
+    // of one space after another
+    auto threads = FLAGS_num_load_part_threads > 0
+                 ? FLAGS_num_load_part_threads
+                 : std::max(1U, std::thread::hardware_concurrency());
+    thread::GenericThreadPool loaders;
+    loaders.start(threads, "nebula-loaders");
+    auto runAll = [&loaders] (size_t count, std::function<void(size_t)> task) {
+        std::atomic<size_t> counter(count);
+        folly::Baton<true, std::atomic> baton;
+        for (size_t i = 0; i < count; i++) {
+            loaders.addTask([i, &task, &counter, &baton] () {
+                task(i);
+                if (counter.fetch_sub(1) == 1) {
+                    baton.post();
+                }
+            });
+        }
+        baton.wait();
+    };
+
+    auto startTime = time::WallClock::fastNowInMilliSec();
+    std::vector<std::unique_ptr<KVEngine>> engines(enginesToOpen.size());
+    runAll(enginesToOpen.size(), [&] (size_t i) {
+        engines[i] = newEngine(enginesToOpen[i].first, enginesToOpen[i].second);
+    });
+
+    // (spaceId, partId, engine) of the parts waiting to open
+    std::vector<std::tuple<GraphSpaceID, PartitionID, KVEngine*>> partsToLoad;
+    // spaceId => partId => index in partsToLoad, a part is loaded from one engine only
+    std::unordered_map<GraphSpaceID, std::unordered_map<PartitionID, size_t>> loadedParts;
+    for (size_t i = 0; i < engines.size(); i++) {
+        auto spaceId = enginesToOpen[i].first;
+        KVEngine* enginePtr = nullptr;
+        {
+            // The engines are kept in the order of the data paths
+            folly::RWSpinLock::WriteHolder wh(&lock_);
+            auto spaceIt = this->spaces_.find(spaceId);
+            if (spaceIt == this->spaces_.end()) {
+                LOG(INFO) << "Load space " << spaceId << " from disk";
+                spaceIt = this->spaces_.emplace(
+                    spaceId,
+                    std::make_unique<SpacePartInfo>()).first;
+            }
+            spaceIt->second->engines_.emplace_back(std::move(engines[i]));
+            enginePtr = spaceIt->second->engines_.back().get();
+        }
+
+        auto& partIds = loadedParts[spaceId];
+        for (auto& partId : enginePtr->allParts()) {
+            if (!options_.partMan_->partExist(storeSvcAddr_, spaceId, partId).ok()) {
+                LOG(INFO) << "Part " << partId
+                          << " does not exist any more, remove it!";
+                enginePtr->removePart(partId);
+                continue;
+            }
+            auto it = partIds.find(partId);
+            if (it == partIds.end()) {
+                partIds.emplace(partId, partsToLoad.size());
+                partsToLoad.emplace_back(spaceId, partId, enginePtr);
+                continue;
+            }
+            // The part is on more than one engine of the space, e.g. the process crashed
+            // when the part was being moved between data paths, keep the one which has
+            // committed more logs
+            auto& loaded = std::get<2>(partsToLoad[it->second]);
+            auto loadedLogId = committedLogId(loaded, partId);
+            auto currLogId = committedLogId(enginePtr, partId);
+            auto* dropped = enginePtr;
+            if (ok(loadedLogId) && ok(currLogId) && value(currLogId) > value(loadedLogId)) {
+                dropped = loaded;
+                loaded = enginePtr;
+            }
+            LOG(INFO) << "Part " << partId << " of space " << spaceId << " is on both "
+                      << loaded->getDataRoot() << " and " << dropped->getDataRoot()
+                      << ", remove it from the latter";
+            dropped->removePart(partId);
+            removePartData(dropped, partId);
+            auto wal = folly::stringPrintf("%s/wal/%d", dropped->getDataRoot(), partId);
+            fs::FileUtils::remove(wal.c_str(), true);
+        }
+    }
+
+    LOG(INFO) << "Need to open " << partsToLoad.size() << " parts of "
+              << enginesToOpen.size() << " engines with " << threads << " threads";
+    runAll(partsToLoad.size(), [&] (size_t i) {
+        GraphSpaceID spaceId;
+        PartitionID partId;
+        KVEngine* enginePtr;
+        std::tie(spaceId, partId, enginePtr) = partsToLoad[i];
+        auto status = options_.partMan_->partMeta(spaceId, partId);
+        if (!status.ok()) {
+            LOG(WARNING) << status.status().toString();
+            return;
+        }
+        auto part = std::make_shared<Part>(spaceId,
+                                           partId,
+                                           raftAddr_,
+                                           folly::stringPrintf("%s/wal/%d",
+                                                   enginePtr->getDataRoot(),
+                                                   partId),
+                                           enginePtr,
+                                           ioPool_,
+                                           bgWorkers_,
+                                           workers_,
+                                           snapshot_,
+                                           clientMan_);
+        auto partMeta = status.value();
+        std::vector<HostAddr> peers;
+        for (auto& h : partMeta.hosts_) {
+            if (h != storeSvcAddr_) {
+                peers.emplace_back(getRaftAddr(h));
+                VLOG(1) << "Add peer " << peers.back();
+            }
+        }
+        raftService_->addPartition(part);
+        watchLeader(part.get());
+        part->start(std::move(peers), false);
+        LOG(INFO) << "Load part " << spaceId << ", " << partId << " from disk";
+
+        {
+            folly::RWSpinLock::WriteHolder holder(&lock_);
+            auto iter = spaces_.find(spaceId);
+            CHECK(iter != spaces_.end());
+            iter->second->parts_.emplace(partId, part);
+        }
+    });
+    loaders.stop();
+    loaders.wait();
+    LOG(INFO) << "Load " << partsToLoad.size() << " parts from disk in "
+              << time::WallClock::fastNowInMilliSec() - startTime << "ms";
     return true;
 }
 
 
 std::unique_ptr<KVEngine> NebulaStore::newEngine(GraphSpaceID spaceId,
                                                  const std::string& path) {
-    if (FLAGS_engine_type == "rocksdb") {
-        std::shared_ptr<KVCompactionFilterFactory> cfFactory = nullptr;
-        if (options_.cffBuilder_ != nullptr) {
-            cfFactory = options_.cffBuilder_->buildCfFactory(spaceId,
-                                                             FLAGS_custom_filter_interval_secs);
+    std::shared_ptr<KVCompactionFilterFactory> cfFactory = nullptr;
+    if (options_.cffBuilder_ != nullptr) {
+        cfFactory = options_.cffBuilder_->buildCfFactory(spaceId,
+                                                         FLAGS_custom_filter_interval_secs);
+    }
+    if (FLAGS_engine_type == "memory" || isMemorySpace(spaceId)) {
+        size_t vIdLen = 0;
+        if (options_.vIdLenGetter_ != nullptr) {
+            auto ret = options_.vIdLenGetter_(spaceId);
+            if (ret.ok()) {
+                vIdLen = ret.value();
+            } else {
+                LOG(WARNING) << "Get vid length of space " << spaceId << " failed, "
+                             << ret.status() << ", the keys would not be indexed";
+            }
         }
+        return std::make_unique<MemEngine>(spaceId,
+                                           path,
+                                           vIdLen,
+                                           options_.mergeOp_,
+                                           cfFactory);
+    } else if (FLAGS_engine_type == "rocksdb") {
         return std::make_unique<RocksEngine>(spaceId,
                                              path,
                                              options_.mergeOp_,
@@ -210,6 +401,21 @@ std::unique_ptr<KVEngine> NebulaStore::newEngine(GraphSpaceID spaceId,
     }
 }
 
+bool NebulaStore::isMemorySpace(GraphSpaceID spaceId) {
+    if (FLAGS_memory_engine_spaces.empty()) {
+        return false;
+    }
+    std::vector<folly::StringPiece> spaces;
+    folly::split(",", FLAGS_memory_engine_spaces, spaces, true);
+    for (auto space : spaces) {
+        auto id = folly::tryTo<GraphSpaceID>(folly::trimWhitespace(space));
+        if (id.hasValue() && id.value() == spaceId) {
+            return true;
+        }
+    }
+    return false;
+}
+
 ErrorOr<ResultCode, HostAddr> NebulaStore::partLeader(GraphSpaceID spaceId, PartitionID partId) {
     folly::RWSpinLock::ReadHolder rh(&lock_);
     auto it = spaces_.find(spaceId);
@@ -300,6 +506,7 @@ std::shared_ptr<Part> NebulaStore::newPart(GraphSpaceID spaceId,
         }
     }
     raftService_->addPartition(part);
+    watchLeader(part.get());
     part->start(std::move(peers), asLearner);
     return part;
 }
@@ -316,6 +523,7 @@ void NebulaStore::removeSpace(GraphSpaceID spaceId) {
         CHECK_EQ(0, engine->totalPartsNum());
     }
     this->spaces_.erase(spaceIt);
+    NebulaKeyUtils::removeEdgeKeyLayout(spaceId);
     // TODO(dangleptr): Should we delete the data?
     LOG(INFO) << "Space " << spaceId << " has been removed!";
 }
@@ -333,6 +541,7 @@ void NebulaStore::removePart(GraphSpaceID spaceId, PartitionID partId) {
             partIt->second->reset();
             spaceIt->second->parts_.erase(partId);
             e->removePart(partId);
+            NebulaKeyUtils::removeEdgeKeyLayout(spaceId, partId);
         }
     }
     LOG(INFO) << "Space " << spaceId << ", part " << partId << " has been removed!";
@@ -364,7 +573,14 @@ ResultCode NebulaStore::get(GraphSpaceID spaceId,
     if (!checkLeader(part)) {
         return ResultCode::ERR_LEADER_CHANGED;
     }
-    return part->engine()->get(key, value);
+    ResultCode code;
+    if (auto* pending = PendingWrites::current(spaceId, partId)) {
+        code = pending->get(part->engine(), key, value);
+    } else {
+        code = part->engine()->get(key, value);
+    }
+    part->addReads(1, code == ResultCode::SUCCEEDED ? value->size() : 0);
+    return code;
 }
 
 
@@ -382,7 +598,23 @@ std::pair<ResultCode, std::vector<Status>> NebulaStore::multiGet(
     if (!checkLeader(part)) {
         return {ResultCode::ERR_LEADER_CHANGED, status};
     }
-    status = part->engine()->multiGet(keys, values);
+    if (auto* pending = PendingWrites::current(spaceId, partId)) {
+        values->resize(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            auto code = pending->get(part->engine(), keys[i], &(*values)[i]);
+            status.emplace_back(code == ResultCode::SUCCEEDED ? Status::OK()
+                                                              : Status::KeyNotFound());
+        }
+    } else {
+        status = part->engine()->multiGet(keys, values);
+    }
+    int64_t bytes = 0;
+    for (size_t i = 0; i < status.size() && i < values->size(); i++) {
+        if (status[i].ok()) {
+            bytes += (*values)[i].size();
+        }
+    }
+    part->addReads(keys.size(), bytes);
     auto allExist = std::all_of(status.begin(), status.end(),
                                 [] (const auto& s) {
                                     return s.ok();
@@ -408,6 +640,10 @@ ResultCode NebulaStore::range(GraphSpaceID spaceId,
     if (!checkLeader(part)) {
         return ResultCode::ERR_LEADER_CHANGED;
     }
+    part->addReads(1);
+    if (auto* pending = PendingWrites::current(spaceId, partId)) {
+        return pending->range(part->engine(), start, end, iter);
+    }
     return part->engine()->range(start, end, iter);
 }
 
@@ -424,6 +660,10 @@ ResultCode NebulaStore::prefix(GraphSpaceID spaceId,
     if (!checkLeader(part)) {
         return ResultCode::ERR_LEADER_CHANGED;
     }
+    part->addReads(1);
+    if (auto* pending = PendingWrites::current(spaceId, partId)) {
+        return pending->rangeWithPrefix(part->engine(), prefix, prefix, iter);
+    }
     return part->engine()->prefix(prefix, iter);
 }
 
@@ -441,6 +681,10 @@ ResultCode NebulaStore::rangeWithPrefix(GraphSpaceID spaceId,
     if (!checkLeader(part)) {
         return ResultCode::ERR_LEADER_CHANGED;
     }
+    part->addReads(1);
+    if (auto* pending = PendingWrites::current(spaceId, partId)) {
+        return pending->rangeWithPrefix(part->engine(), start, prefix, iter);
+    }
     return part->engine()->rangeWithPrefix(start, prefix, iter);
 }
 
@@ -757,6 +1001,304 @@ ResultCode NebulaStore::setWriteBlocking(GraphSpaceID spaceId, bool sign) {
     return ResultCode::SUCCEEDED;
 }
 
+ResultCode NebulaStore::exportPart(PartitionID partId,
+                                   KVEngine* src,
+                                   const void* snapshot,
+                                   KVEngine* dst) {
+    auto dir = folly::stringPrintf("%s/move_part", dst->getDataRoot());
+    if (!fs::FileUtils::exist(dir) && !fs::FileUtils::makeDir(dir)) {
+        LOG(ERROR) << "Create directory " << dir << " failed";
+        return ResultCode::ERR_IO_ERROR;
+    }
+    int32_t seq = 0;
+    std::vector<KV> data;
+    size_t bytes = 0;
+    auto ingest = [&] () {
+        if (data.empty()) {
+            return ResultCode::SUCCEEDED;
+        }
+        auto file = folly::stringPrintf("%s/%d_%d.sst", dir.c_str(), partId, seq++);
+        SCOPE_EXIT {
+            fs::FileUtils::remove(file.c_str());
+        };
+        auto code = dst->writeSstFile(file, data);
+        if (code == ResultCode::SUCCEEDED) {
+            code = dst->ingest({file});
+        }
+        data.clear();
+        bytes = 0;
+        return code;
+    };
+
+    size_t maxBytes = static_cast<size_t>(FLAGS_move_part_sst_size_mb) * 1024 * 1024;
+    for (auto& prefix : partPrefixes(partId)) {
+        std::unique_ptr<KVIterator> iter;
+        auto code = src->prefix(prefix, &iter, snapshot);
+        if (code != ResultCode::SUCCEEDED) {
+            return code;
+        }
+        for (; iter->valid(); iter->next()) {
+            data.emplace_back(iter->key().str(), iter->val().str());
+            bytes += iter->key().size() + iter->val().size();
+            if (bytes >= maxBytes) {
+                code = ingest();
+                if (code != ResultCode::SUCCEEDED) {
+                    return code;
+                }
+            }
+        }
+    }
+    // The committed log id and the edge key layout in the snapshot, the system keys are
+    // after all the prefixes, in this order
+    for (auto& key : {NebulaKeyUtils::systemCommitKey(partId),
+                      NebulaKeyUtils::systemEdgeKeyLayoutKey(partId)}) {
+        std::string val;
+        auto code = src->get(key, &val, snapshot);
+        if (code == ResultCode::SUCCEEDED) {
+            data.emplace_back(key, std::move(val));
+        } else if (code != ResultCode::ERR_KEY_NOT_FOUND) {
+            return code;
+        }
+    }
+    return ingest();
+}
+
+ResultCode NebulaStore::movePart(GraphSpaceID spaceId, PartitionID partId, int32_t pathIndex) {
+    // Only one part is moved at a time
+    std::lock_guard<std::mutex> guard(moveLock_);
+    std::shared_ptr<SpacePartInfo> spacePart;
+    std::shared_ptr<Part> part;
+    KVEngine* dst = nullptr;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        auto spaceIt = spaces_.find(spaceId);
+        if (spaceIt == spaces_.end()) {
+            return ResultCode::ERR_SPACE_NOT_FOUND;
+        }
+        spacePart = spaceIt->second;
+        auto partIt = spacePart->parts_.find(partId);
+        if (partIt == spacePart->parts_.end()) {
+            return ResultCode::ERR_PART_NOT_FOUND;
+        }
+        part = partIt->second;
+        for (auto& engine : spacePart->engines_) {
+            if (dataPathIndex(spaceId, engine.get()) == pathIndex) {
+                dst = engine.get();
+            }
+        }
+    }
+    if (dst == nullptr) {
+        LOG(ERROR) << "No engine of space " << spaceId << " on data path " << pathIndex;
+        return ResultCode::ERR_INVALID_ARGUMENT;
+    }
+    auto* src = part->engine();
+    if (src == dst) {
+        return ResultCode::SUCCEEDED;
+    }
+    LOG(INFO) << "Move space " << spaceId << ", part " << partId << " from "
+              << src->getDataRoot() << " to " << dst->getDataRoot();
+    auto startTime = time::WallClock::fastNowInMilliSec();
+    auto srcWal = folly::stringPrintf("%s/wal/%d", src->getDataRoot(), partId);
+    auto dstWal = folly::stringPrintf("%s/wal/%d", dst->getDataRoot(), partId);
+    // Remove the leftover of a failed move
+    auto code = removePartData(dst, partId);
+    if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+
+    // Phase 1: copy the data in a snapshot while the part is still serving
+    auto* snapshot = src->getSnapshot();
+    code = exportPart(partId, src, snapshot, dst);
+    src->releaseSnapshot(snapshot);
+    auto snapshotLogId = committedLogId(dst, partId);
+    if (code != ResultCode::SUCCEEDED || !ok(snapshotLogId)) {
+        LOG(ERROR) << "Copy the data of space " << spaceId << ", part " << partId << " failed";
+        removePartData(dst, partId);
+        return code != ResultCode::SUCCEEDED ? code : error(snapshotLogId);
+    }
+    VLOG(1) << "Copied the data of space " << spaceId << ", part " << partId
+            << " up to log " << value(snapshotLogId);
+
+    // Phase 2: stop the part, catch up the logs committed meanwhile, and move the wal.
+    // The requests to the part fail until it is started on the new engine.
+    bool asLearner = part->isLearner();
+    raftService_->removePartition(part);
+    auto lastLogId = committedLogId(src, partId);
+    code = ok(lastLogId) ? part->replayLogs(dst, value(snapshotLogId), value(lastLogId))
+                         : error(lastLogId);
+    if (code == ResultCode::SUCCEEDED && !copyDir(srcWal, dstWal)) {
+        code = ResultCode::ERR_IO_ERROR;
+    }
+    if (code != ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Catch up space " << spaceId << ", part " << partId << " failed, "
+                   << "restart it on " << src->getDataRoot();
+        removePartData(dst, partId);
+        fs::FileUtils::remove(dstWal.c_str(), true);
+        part = newPart(spaceId, partId, src, asLearner);
+        folly::RWSpinLock::WriteHolder wh(&lock_);
+        if (part != nullptr) {
+            spacePart->parts_[partId] = part;
+        }
+        return code;
+    }
+
+    // Phase 3: start the part on the new engine, then clean up the old one. If we crash
+    // in between, both engines have the part and all its data, loadPartsFromDisk keeps
+    // it on only one of them and removes it from the other.
+    dst->addPart(partId);
+    auto moved = newPart(spaceId, partId, dst, asLearner);
+    bool removed = false;
+    {
+        folly::RWSpinLock::WriteHolder wh(&lock_);
+        auto partIt = spacePart->parts_.find(partId);
+        if (moved == nullptr || partIt == spacePart->parts_.end() || partIt->second != part) {
+            removed = true;
+        } else {
+            partIt->second = moved;
+        }
+    }
+    if (removed) {
+        // The part has been removed by meta meanwhile
+        LOG(INFO) << "Space " << spaceId << ", part " << partId << " has been removed";
+        if (moved != nullptr) {
+            raftService_->removePartition(moved);
+            moved->reset();
+        }
+        dst->removePart(partId);
+        removePartData(dst, partId);
+        return ResultCode::ERR_PART_NOT_FOUND;
+    }
+    src->removePart(partId);
+    part->reset();
+    code = removePartData(src, partId);
+    if (code != ResultCode::SUCCEEDED) {
+        LOG(WARNING) << "Remove the data of space " << spaceId << ", part " << partId
+                     << " from " << src->getDataRoot() << " failed, they would be left";
+    }
+    LOG(INFO) << "Space " << spaceId << ", part " << partId << " has been moved to "
+              << dst->getDataRoot() << " in " << time::WallClock::fastNowInMilliSec() - startTime
+              << "ms, the catching up is from log " << value(snapshotLogId)
+              << " to " << value(lastLogId);
+    return ResultCode::SUCCEEDED;
+}
+
+ResultCode NebulaStore::balanceDataPaths() {
+    auto pathNum = options_.dataPaths_.size();
+    if (pathNum < 2) {
+        return ResultCode::SUCCEEDED;
+    }
+    struct PartLoad {
+        GraphSpaceID            spaceId;
+        PartitionID             partId;
+        std::shared_ptr<Part>   part;
+        int32_t                 pathIndex;
+        int64_t                 bytes;
+        int64_t                 ops;
+    };
+    std::vector<PartLoad> parts;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (auto& spaceEntry : spaces_) {
+            for (auto& partEntry : spaceEntry.second->parts_) {
+                auto index = dataPathIndex(spaceEntry.first, partEntry.second->engine());
+                if (index >= 0) {
+                    parts.emplace_back(PartLoad{spaceEntry.first, partEntry.first,
+                                                partEntry.second, index, 0, 0});
+                }
+            }
+        }
+    }
+
+    // The disk usage of the parts, and their reads and writes since last round
+    std::vector<int64_t> pathBytes(pathNum, 0);
+    std::vector<int64_t> pathOps(pathNum, 0);
+    int64_t totalBytes = 0;
+    int64_t totalOps = 0;
+    for (auto& load : parts) {
+        auto* engine = load.part->engine();
+        for (auto& prefix : partPrefixes(load.partId)) {
+            load.bytes += engine->approximateSize(prefix, prefixEnd(prefix));
+        }
+        load.ops = load.part->takeOps();
+        pathBytes[load.pathIndex] += load.bytes;
+        pathOps[load.pathIndex] += load.ops;
+        totalBytes += load.bytes;
+        totalOps += load.ops;
+    }
+    if (totalBytes == 0 && totalOps == 0) {
+        return ResultCode::SUCCEEDED;
+    }
+
+    // The load is the larger one of disk usage and I/O, relative to the average of paths
+    double avgBytes = static_cast<double>(totalBytes) / pathNum;
+    double avgOps = static_cast<double>(totalOps) / pathNum;
+    auto score = [&] (int64_t bytes, int64_t ops) {
+        double ret = 0;
+        if (avgBytes > 0) {
+            ret = std::max(ret, bytes / avgBytes);
+        }
+        if (avgOps > 0) {
+            ret = std::max(ret, ops / avgOps);
+        }
+        return ret;
+    };
+    int32_t from = 0;
+    int32_t to = 0;
+    std::vector<double> scores(pathNum);
+    for (size_t i = 0; i < pathNum; i++) {
+        scores[i] = score(pathBytes[i], pathOps[i]);
+        if (scores[i] > scores[from]) {
+            from = i;
+        }
+        if (scores[i] < scores[to]) {
+            to = i;
+        }
+    }
+    auto gap = scores[from] - scores[to];
+    if (gap <= FLAGS_data_path_balance_threshold) {
+        VLOG(1) << "The data paths are balanced, the gap of load is " << gap;
+        return ResultCode::SUCCEEDED;
+    }
+
+    // Moving a part whose load is in (0, gap) narrows the gap, pick the closest one to half
+    const PartLoad* target = nullptr;
+    double best = gap;
+    for (auto& load : parts) {
+        if (load.pathIndex != from) {
+            continue;
+        }
+        auto partScore = score(load.bytes, load.ops);
+        if (partScore <= 0 || partScore >= gap) {
+            continue;
+        }
+        auto diff = std::abs(gap - 2 * partScore);
+        if (diff < best) {
+            best = diff;
+            target = &load;
+        }
+    }
+    if (target == nullptr) {
+        LOG(INFO) << "No part could be moved from data path " << options_.dataPaths_[from]
+                  << " to " << options_.dataPaths_[to] << ", the gap of load is " << gap;
+        return ResultCode::SUCCEEDED;
+    }
+    LOG(INFO) << "The load of data path " << options_.dataPaths_[from] << " is " << scores[from]
+              << ", and " << options_.dataPaths_[to] << " is " << scores[to]
+              << ", move space " << target->spaceId << ", part " << target->partId
+              << " of " << target->bytes << " bytes and " << target->ops << " operations";
+    return movePart(target->spaceId, target->partId, to);
+}
+
+int32_t NebulaStore::dataPathIndex(GraphSpaceID spaceId, const KVEngine* engine) const {
+    for (size_t i = 0; i < options_.dataPaths_.size(); i++) {
+        auto root = folly::stringPrintf("%s/nebula/%d", options_.dataPaths_[i].c_str(), spaceId);
+        if (root == engine->getDataRoot()) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 bool NebulaStore::isLeader(GraphSpaceID spaceId, PartitionID partId) {
     folly::RWSpinLock::ReadHolder rh(&lock_);
     auto spaceIt = spaces_.find(spaceId);
@@ -811,11 +1353,89 @@ int32_t NebulaStore::allLeader(std::unordered_map<GraphSpaceID,
     return count;
 }
 
+ResultCode NebulaStore::checkLeader(GraphSpaceID spaceId, PartitionID partId) {
+    auto ret = part(spaceId, partId);
+    if (!ok(ret)) {
+        return error(ret);
+    }
+    if (!checkLeader(nebula::value(ret))) {
+        return ResultCode::ERR_LEADER_CHANGED;
+    }
+    return ResultCode::SUCCEEDED;
+}
+
 bool NebulaStore::checkLeader(std::shared_ptr<Part> part) const {
     return !FLAGS_check_leader || (part->isLeader() && part->leaseValid());
 }
 
+int64_t NebulaStore::addLeaderListener(LeaderListener listener) {
+    std::lock_guard<std::mutex> g(listenersLock_);
+    auto id = nextListenerId_++;
+    leaderListeners_.emplace(id, std::move(listener));
+    return id;
+}
+
+void NebulaStore::removeLeaderListener(int64_t id) {
+    std::lock_guard<std::mutex> g(listenersLock_);
+    leaderListeners_.erase(id);
+}
+
+void NebulaStore::watchLeader(Part* part) {
+    auto spaceId = part->spaceId();
+    auto partId = part->partitionId();
+    part->registerLeaderChangedCb([this, spaceId, partId] (bool isLeader) {
+        std::lock_guard<std::mutex> g(listenersLock_);
+        for (auto& listener : leaderListeners_) {
+            listener.second(spaceId, partId, isLeader);
+        }
+    });
+}
+
+
+std::vector<metrics::GaugeValue> NebulaStore::collectMetrics() {
+    std::vector<metrics::GaugeValue> gauges;
+    std::vector<std::shared_ptr<Part>> parts;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (const auto& space : spaces_) {
+            for (const auto& part : space.second->parts_) {
+                parts.emplace_back(part.second);
+            }
+        }
+    }
+    for (const auto& part : parts) {
+        metrics::MetricLabels labels = {{"space", folly::to<std::string>(part->spaceId())},
+                                        {"part", folly::to<std::string>(part->partitionId())}};
+        gauges.emplace_back(metrics::GaugeValue{"wal_buffer_bytes",
+                                                labels,
+                                                static_cast<double>(part->wal()->bufferSize())});
+        for (const auto& lag : part->replicationLags()) {
+            auto followerLabels = labels;
+            followerLabels.emplace_back(
+                "follower", folly::stringPrintf("%s:%d", lag.first.host.c_str(), lag.first.port));
+            gauges.emplace_back(metrics::GaugeValue{"raft_replication_lag",
+                                                    std::move(followerLabels),
+                                                    static_cast<double>(lag.second)});
+        }
+    }
+
+    if (FLAGS_enable_rocksdb_statistics && FLAGS_engine_type == "rocksdb") {
+        // Counted since the process started
+        auto statistics = getRocksdbStatistics();
+        auto hits = statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT);
+        auto misses = statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS);
+        // The ratio is left to the query of the counters, e.g. by their rates in a window
+        gauges.emplace_back(metrics::GaugeValue{"rocksdb_block_cache_hits",
+                                                {},
+                                                static_cast<double>(hits),
+                                                true});
+        gauges.emplace_back(metrics::GaugeValue{"rocksdb_block_cache_misses",
+                                                {},
+                                                static_cast<double>(misses),
+                                                true});
+    }
+    return gauges;
+}
 
 }  // namespace kvstore
 }  // namespace nebula
-
@@ -11,12 +11,14 @@
 #include "common/interface/gen-cpp2/RaftexServiceAsyncClient.h"
 #include <gtest/gtest_prod.h>
 #include <folly/RWSpinLock.h>
+#include "common/thread/GenericWorker.h"
 #include "kvstore/raftex/RaftexService.h"
 #include "kvstore/KVStore.h"
 #include "kvstore/PartManager.h"
 #include "kvstore/Part.h"
 #include "kvstore/KVEngine.h"
 #include "kvstore/raftex/SnapshotManager.h"
+#include "utils/Metrics.h"
 
 namespace nebula {
 namespace kvstore {
@@ -39,6 +41,8 @@ class NebulaStore : public KVStore, public Handler {
     FRIEND_TEST(NebulaStoreTest, TransLeaderTest);
     FRIEND_TEST(NebulaStoreTest, CheckpointTest);
     FRIEND_TEST(NebulaStoreTest, ThreeCopiesCheckpointTest);
+    FRIEND_TEST(NebulaStoreTest, MovePartTest);
+    FRIEND_TEST(NebulaStoreTest, BalanceDataPathsTest);
 
 public:
     NebulaStore(KVOptions options,
@@ -182,6 +186,8 @@ public:
     ErrorOr<ResultCode, std::shared_ptr<Part>> part(GraphSpaceID spaceId,
                                                     PartitionID partId) override;
 
+    ResultCode checkLeader(GraphSpaceID spaceId, PartitionID partId) override;
+
     ResultCode ingest(GraphSpaceID spaceId) override;
 
     ResultCode setOption(GraphSpaceID spaceId,
@@ -202,6 +208,22 @@ public:
 
     ResultCode setWriteBlocking(GraphSpaceID spaceId, bool sign) override;
 
+    /**
+     * Move the part to the engine on the data path of the given index, without changing
+     * the raft membership. The data is exported from a snapshot of the current engine
+     * into sst files and ingested, then the part is stopped shortly to replay the logs
+     * committed meanwhile onto the new engine and to move its wal.
+     * */
+    ResultCode movePart(GraphSpaceID spaceId, PartitionID partId, int32_t pathIndex) override;
+
+    // Move a part from the most loaded data path to the least loaded one if they are
+    // unbalanced, the load is measured by the disk usage and the operations of the parts
+    ResultCode balanceDataPaths() override;
+
+    int64_t addLeaderListener(LeaderListener listener) override;
+
+    void removeLeaderListener(int64_t id) override;
+
     bool isLeader(GraphSpaceID spaceId, PartitionID partId);
 
     ErrorOr<ResultCode, std::shared_ptr<SpacePartInfo>> space(GraphSpaceID spaceId);
@@ -225,8 +247,14 @@ private:
                            const std::unordered_map<std::string, std::string>& options,
                            bool isDbOption) override;
 
+    // Open the engines and the parts found in the data paths
+    bool loadPartsFromDisk();
+
     std::unique_ptr<KVEngine> newEngine(GraphSpaceID spaceId, const std::string& path);
 
+    // Whether the space is served by the in-memory engine
+    static bool isMemorySpace(GraphSpaceID spaceId);
+
     std::shared_ptr<Part> newPart(GraphSpaceID spaceId,
                                   PartitionID partId,
                                   KVEngine* engine,
@@ -234,8 +262,24 @@ private:
 
     ErrorOr<ResultCode, KVEngine*> engine(GraphSpaceID spaceId, PartitionID partId);
 
+    // The index of the data path where the engine is, -1 if not found
+    int32_t dataPathIndex(GraphSpaceID spaceId, const KVEngine* engine) const;
+
+    // Write all keys of the part in the snapshot of src into sst files, and ingest them into dst
+    ResultCode exportPart(PartitionID partId,
+                          KVEngine* src,
+                          const void* snapshot,
+                          KVEngine* dst);
+
     bool checkLeader(std::shared_ptr<Part> part) const;
 
+    // Notify the leader listeners of the part, registered before the part is started
+    void watchLeader(Part* part);
+
+    // The lag of the raft followers, the bytes in the log buffer of the wal, and the
+    // hits of the block cache, sampled when the metrics are exported
+    std::vector<metrics::GaugeValue> collectMetrics();
+
 private:
     // The lock used to protect spaces_
     folly::RWSpinLock lock_;
@@ -251,6 +295,16 @@ private:
     std::shared_ptr<raftex::RaftexService> raftService_;
     std::shared_ptr<raftex::SnapshotManager> snapshot_;
     std::shared_ptr<thrift::ThriftClientManager<raftex::cpp2::RaftexServiceAsyncClient>> clientMan_;
+
+    // Serialize the moving of parts between data paths
+    std::mutex moveLock_;
+    std::unique_ptr<thread::GenericWorker> balancer_;
+    int64_t metricsCollector_{-1};
+
+    // Held while the listeners are being called
+    std::mutex listenersLock_;
+    int64_t nextListenerId_{0};
+    std::map<int64_t, LeaderListener> leaderListeners_;
 };
 
 }  // namespace kvstore
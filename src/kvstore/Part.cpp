@@ -6,6 +6,7 @@
 
 #include "kvstore/Part.h"
 #include "kvstore/LogEncoder.h"
+#include "kvstore/PendingWrites.h"
 #include "kvstore/RocksEngineConfig.h"
 #include "utils/NebulaKeyUtils.h"
 
@@ -40,6 +41,27 @@ Part::Part(GraphSpaceID spaceId,
         , partId_(partId)
         , walPath_(walPath)
         , engine_(engine) {
+    metrics::MetricLabels labels = {{"space", folly::to<std::string>(spaceId)},
+                                    {"part", folly::to<std::string>(partId)}};
+    auto* registry = metrics::Metrics::instance();
+    readOps_ = registry->counter("part_read_ops", labels);
+    readBytes_ = registry->counter("part_read_bytes", labels);
+    writeOps_ = registry->counter("part_write_ops", labels);
+    writeBytes_ = registry->counter("part_write_bytes", labels);
+    loadEdgeKeyLayout();
+}
+
+void Part::loadEdgeKeyLayout() {
+    std::string val;
+    auto res = engine_->get(NebulaKeyUtils::systemEdgeKeyLayoutKey(partId_), &val);
+    if (res == ResultCode::SUCCEEDED) {
+        auto layout = NebulaKeyUtils::decodeEdgeKeyLayout(val);
+        LOG(INFO) << idStr_ << "The edge key type is " << static_cast<uint32_t>(layout.type)
+                  << ", converted " << layout.converted;
+        NebulaKeyUtils::setEdgeKeyLayout(spaceId_, partId_, layout);
+    } else {
+        NebulaKeyUtils::removeEdgeKeyLayout(spaceId_, partId_);
+    }
 }
 
 
@@ -63,6 +85,7 @@ std::pair<LogID, TermID> Part::lastCommittedLogId() {
 
 void Part::asyncPut(folly::StringPiece key, folly::StringPiece value, KVCallback cb) {
     std::string log = encodeMultiValues(OP_PUT, key, value);
+    addWrites(1, log.size());
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -73,6 +96,7 @@ void Part::asyncPut(folly::StringPiece key, folly::StringPiece value, KVCallback
 
 void Part::asyncMultiPut(const std::vector<KV>& keyValues, KVCallback cb) {
     std::string log = encodeMultiValues(OP_MULTI_PUT, keyValues);
+    addWrites(1, log.size());
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -83,6 +107,7 @@ void Part::asyncMultiPut(const std::vector<KV>& keyValues, KVCallback cb) {
 
 void Part::asyncRemove(folly::StringPiece key, KVCallback cb) {
     std::string log = encodeSingleValue(OP_REMOVE, key);
+    addWrites(1, log.size());
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -93,6 +118,7 @@ void Part::asyncRemove(folly::StringPiece key, KVCallback cb) {
 
 void Part::asyncMultiRemove(const std::vector<std::string>& keys, KVCallback cb) {
     std::string log = encodeMultiValues(OP_MULTI_REMOVE, keys);
+    addWrites(1, log.size());
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -105,6 +131,7 @@ void Part::asyncRemoveRange(folly::StringPiece start,
                             folly::StringPiece end,
                             KVCallback cb) {
     std::string log = encodeMultiValues(OP_REMOVE_RANGE, start, end);
+    addWrites(1, log.size());
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -120,12 +147,66 @@ void Part::sync(KVCallback cb) {
 }
 
 void Part::asyncAtomicOp(raftex::AtomicOp op, KVCallback cb) {
+    // The bytes are counted when the log is built
+    addWrites(1, 0);
     atomicOpAsync(std::move(op)).thenValue(
             [this, callback = std::move(cb)] (AppendLogResult res) mutable {
         callback(this->toResultCode(res));
     });
 }
 
+folly::Optional<std::string> Part::processAtomicOps(const std::vector<raftex::AtomicOp*>& ops,
+                                                    std::vector<bool>* results) {
+    PendingWrites pending(spaceId_, partId_);
+    std::vector<std::tuple<BatchLogType, std::string, std::string>> merged;
+    bool succeeded = false;
+    for (auto* op : ops) {
+        auto ret = (*op)();
+        if (!ret.hasValue()) {
+            results->emplace_back(false);
+            continue;
+        }
+        auto& log = ret.value();
+        if (log.size() <= sizeof(int64_t) || log[sizeof(int64_t)] != OP_BATCH_WRITE) {
+            if (!succeeded) {
+                // It could not be merged, so ship it alone, the rest ops are left to the next log
+                results->emplace_back(true);
+                addWrites(0, log.size());
+                return ret;
+            }
+            // It could not be merged either, so it is left to the next log along with the
+            // rest ops, and evaluated again once the ops merged are committed
+            VLOG(3) << idStr_ << "The atomic op doesn't return a batch, leave it to the next log";
+            break;
+        }
+        for (auto& data : decodeBatchValue(log)) {
+            auto key = data.second.first;
+            auto val = data.second.second;
+            switch (data.first) {
+                case BatchLogType::OP_BATCH_PUT:
+                    pending.put(key, val);
+                    break;
+                case BatchLogType::OP_BATCH_REMOVE:
+                    pending.remove(key);
+                    break;
+                case BatchLogType::OP_BATCH_REMOVE_RANGE:
+                    pending.removeRange(key, val);
+                    break;
+            }
+            merged.emplace_back(data.first, key.str(), val.str());
+        }
+        results->emplace_back(true);
+        succeeded = true;
+    }
+    if (!succeeded) {
+        return folly::none;
+    }
+    VLOG(3) << idStr_ << results->size() << " atomic ops are merged into one log";
+    auto log = encodeBatchValue(merged);
+    addWrites(0, log.size());
+    return log;
+}
+
 void Part::asyncAddLearner(const HostAddr& learner, KVCallback cb) {
     std::string log = encodeHost(OP_ADD_LEARNER, learner);
     sendCommandAsync(std::move(log))
@@ -173,11 +254,17 @@ void Part::setBlocking(bool sign) {
 
 void Part::onLostLeadership(TermID term) {
     VLOG(1) << "Lost the leadership for the term " << term;
+    if (leaderChangedCb_) {
+        leaderChangedCb_(false);
+    }
 }
 
 
 void Part::onElected(TermID term) {
     VLOG(1) << "Being elected as the leader for the term " << term;
+    if (leaderChangedCb_) {
+        leaderChangedCb_(true);
+    }
 }
 
 void Part::onDiscoverNewLeader(HostAddr nLeader) {
@@ -203,69 +290,15 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
         DCHECK_GE(log.size(), sizeof(int64_t) + 1 + sizeof(uint32_t));
         // Skip the timestamp (type of int64_t)
         switch (log[sizeof(int64_t)]) {
-        case OP_PUT: {
-            auto pieces = decodeMultiValues(log);
-            DCHECK_EQ(2, pieces.size());
-            if (batch->put(pieces[0], pieces[1]) != ResultCode::SUCCEEDED) {
-                LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
-                return false;
-            }
-            break;
-        }
-        case OP_MULTI_PUT: {
-            auto kvs = decodeMultiValues(log);
-            // Make the number of values are an even number
-            DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
-            for (size_t i = 0; i < kvs.size(); i += 2) {
-                if (batch->put(kvs[i], kvs[i + 1]) != ResultCode::SUCCEEDED) {
-                    LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
-                    return false;
-                }
-            }
-            break;
-        }
-        case OP_REMOVE: {
-            auto key = decodeSingleValue(log);
-            if (batch->remove(key) != ResultCode::SUCCEEDED) {
-                LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
-                return false;
-            }
-            break;
-        }
-        case OP_MULTI_REMOVE: {
-            auto keys = decodeMultiValues(log);
-            for (auto k : keys) {
-                if (batch->remove(k) != ResultCode::SUCCEEDED) {
-                    LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
-                    return false;
-                }
-            }
-            break;
-        }
-        case OP_REMOVE_RANGE: {
-            auto range = decodeMultiValues(log);
-            DCHECK_EQ(2, range.size());
-            if (batch->removeRange(range[0], range[1]) != ResultCode::SUCCEEDED) {
-                LOG(ERROR) << idStr_ << "Failed to call WriteBatch::removeRange()";
-                return false;
-            }
-            break;
-        }
+        case OP_PUT:
+        case OP_MULTI_PUT:
+        case OP_REMOVE:
+        case OP_MULTI_REMOVE:
+        case OP_REMOVE_RANGE:
         case OP_BATCH_WRITE: {
-            auto data = decodeBatchValue(log);
-            for (auto& op : data) {
-                ResultCode code = ResultCode::SUCCEEDED;
-                if (op.first == BatchLogType::OP_BATCH_PUT) {
-                    code = batch->put(op.second.first, op.second.second);
-                } else if (op.first == BatchLogType::OP_BATCH_REMOVE) {
-                    code = batch->remove(op.second.first);
-                } else if (op.first == BatchLogType::OP_BATCH_REMOVE_RANGE) {
-                    code = batch->removeRange(op.second.first, op.second.second);
-                }
-                if (code != ResultCode::SUCCEEDED) {
-                    LOG(ERROR) << idStr_ << "Failed to call WriteBatch";
-                    return false;
-                }
+            addOps(1);
+            if (!applyLog(batch.get(), log)) {
+                return false;
             }
             break;
         }
@@ -307,8 +340,145 @@ bool Part::commitLogs(std::unique_ptr<LogIterator> iter) {
             return false;
         }
     }
-    return engine_->commitBatchWrite(std::move(batch), FLAGS_rocksdb_disable_wal)
-                    == ResultCode::SUCCEEDED;
+    if (engine_->commitBatchWrite(std::move(batch), FLAGS_rocksdb_disable_wal)
+            != ResultCode::SUCCEEDED) {
+        return false;
+    }
+    if (edgeKeyLayoutChanged_) {
+        edgeKeyLayoutChanged_ = false;
+        loadEdgeKeyLayout();
+    }
+    return true;
+}
+
+bool Part::applyLog(WriteBatch* batch, folly::StringPiece log) {
+    switch (log[sizeof(int64_t)]) {
+    case OP_PUT: {
+        auto pieces = decodeMultiValues(log);
+        DCHECK_EQ(2, pieces.size());
+        if (batch->put(pieces[0], pieces[1]) != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
+            return false;
+        }
+        edgeKeyLayoutChanged_ |= NebulaKeyUtils::isSystemEdgeKeyLayout(pieces[0]);
+        break;
+    }
+    case OP_MULTI_PUT: {
+        auto kvs = decodeMultiValues(log);
+        // Make the number of values are an even number
+        DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
+        for (size_t i = 0; i < kvs.size(); i += 2) {
+            if (batch->put(kvs[i], kvs[i + 1]) != ResultCode::SUCCEEDED) {
+                LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
+                return false;
+            }
+            edgeKeyLayoutChanged_ |= NebulaKeyUtils::isSystemEdgeKeyLayout(kvs[i]);
+        }
+        break;
+    }
+    case OP_REMOVE: {
+        auto key = decodeSingleValue(log);
+        if (batch->remove(key) != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
+            return false;
+        }
+        break;
+    }
+    case OP_MULTI_REMOVE: {
+        auto keys = decodeMultiValues(log);
+        for (auto k : keys) {
+            if (batch->remove(k) != ResultCode::SUCCEEDED) {
+                LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
+                return false;
+            }
+        }
+        break;
+    }
+    case OP_REMOVE_RANGE: {
+        auto range = decodeMultiValues(log);
+        DCHECK_EQ(2, range.size());
+        if (batch->removeRange(range[0], range[1]) != ResultCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Failed to call WriteBatch::removeRange()";
+            return false;
+        }
+        break;
+    }
+    case OP_BATCH_WRITE: {
+        auto data = decodeBatchValue(log);
+        for (auto& op : data) {
+            ResultCode code = ResultCode::SUCCEEDED;
+            if (op.first == BatchLogType::OP_BATCH_PUT) {
+                code = batch->put(op.second.first, op.second.second);
+                edgeKeyLayoutChanged_ |= NebulaKeyUtils::isSystemEdgeKeyLayout(op.second.first);
+            } else if (op.first == BatchLogType::OP_BATCH_REMOVE) {
+                code = batch->remove(op.second.first);
+            } else if (op.first == BatchLogType::OP_BATCH_REMOVE_RANGE) {
+                code = batch->removeRange(op.second.first, op.second.second);
+            }
+            if (code != ResultCode::SUCCEEDED) {
+                LOG(ERROR) << idStr_ << "Failed to call WriteBatch";
+                return false;
+            }
+        }
+        break;
+    }
+    default: {
+        LOG(WARNING) << idStr_ << "Not a data operation: "
+                     << static_cast<int32_t>(log[sizeof(int64_t)]);
+        break;
+    }
+    }
+    return true;
+}
+
+ResultCode Part::replayLogs(KVEngine* engine, LogID from, LogID to) {
+    if (to <= from) {
+        return ResultCode::SUCCEEDED;
+    }
+    if (wal()->firstLogId() > from + 1 || wal()->lastLogId() < to) {
+        LOG(ERROR) << idStr_ << "The logs [" << from + 1 << ", " << to << "] are not all in wal, "
+                   << "wal has [" << wal()->firstLogId() << ", " << wal()->lastLogId() << "]";
+        return ResultCode::ERR_INVALID_DATA;
+    }
+    auto iter = wal()->iterator(from + 1, to);
+    auto batch = engine->startBatchWrite();
+    LogID lastId = from;
+    TermID lastTerm = -1;
+    for (; iter->valid(); ++(*iter)) {
+        lastId = iter->logId();
+        lastTerm = iter->logTerm();
+        auto log = iter->logMsg();
+        if (log.empty()) {
+            continue;
+        }
+        switch (log[sizeof(int64_t)]) {
+        case OP_PUT:
+        case OP_MULTI_PUT:
+        case OP_REMOVE:
+        case OP_MULTI_REMOVE:
+        case OP_REMOVE_RANGE:
+        case OP_BATCH_WRITE: {
+            if (!applyLog(batch.get(), log)) {
+                return ResultCode::ERR_INVALID_DATA;
+            }
+            break;
+        }
+        default: {
+            // The membership changes have been applied by raft
+            break;
+        }
+        }
+    }
+    if (lastId != to) {
+        LOG(ERROR) << idStr_ << "Replay logs stopped at " << lastId << ", expect " << to;
+        return ResultCode::ERR_INVALID_DATA;
+    }
+    auto code = putCommitMsg(batch.get(), lastId, lastTerm);
+    if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+    // Keep the rocksdb's wal, the logs may be removed from our wal soon
+    return engine->commitBatchWrite(std::move(batch), false);
 }
 
 std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>& rows,
@@ -318,6 +488,7 @@ std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>&
     auto batch = engine_->startBatchWrite();
     int64_t count = 0;
     int64_t size = 0;
+    bool layoutChanged = false;
     for (auto& row : rows) {
         count++;
         size += row.size();
@@ -326,6 +497,7 @@ std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>&
             LOG(ERROR) << idStr_ << "Put failed in commit";
             return std::make_pair(0, 0);
         }
+        layoutChanged |= NebulaKeyUtils::isSystemEdgeKeyLayout(kv.first);
     }
     if (finished) {
         if (ResultCode::SUCCEEDED != putCommitMsg(batch.get(), committedLogId, committedLogTerm)) {
@@ -338,6 +510,9 @@ std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>&
         LOG(ERROR) << idStr_ << "Put failed in commit";
         return std::make_pair(0, 0);
     }
+    if (layoutChanged) {
+        loadEdgeKeyLayout();
+    }
     return std::make_pair(count, size);
 }
 
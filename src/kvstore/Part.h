@@ -14,6 +14,7 @@
 #include "kvstore/KVEngine.h"
 #include "kvstore/raftex/SnapshotManager.h"
 #include "kvstore/wal/FileBasedWal.h"
+#include "utils/Metrics.h"
 
 namespace nebula {
 namespace kvstore {
@@ -74,6 +75,43 @@ public:
         newLeaderCb_ = nullptr;
     }
 
+    // Must be registered before the part is started
+    void registerLeaderChangedCb(LeaderChangedCallback cb) {
+        leaderChangedCb_ = std::move(cb);
+    }
+
+    // Replay the data changes of the logs in (from, to] in wal onto the engine, and
+    // update the committed log id in it. The engine should have the data of the part
+    // up to log `from`, it is used when the part is moved to another data path.
+    ResultCode replayLogs(KVEngine* engine, LogID from, LogID to);
+
+    // Count the reads and writes served by the part
+    void addOps(int64_t count) {
+        ops_.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Count the reads served by the part, the bytes are of the values got
+    void addReads(int64_t count, int64_t bytes = 0) {
+        addOps(count);
+        readOps_->add(count);
+        if (bytes > 0) {
+            readBytes_->add(bytes);
+        }
+    }
+
+    // Count the writes proposed to the part, the bytes are of the logs
+    void addWrites(int64_t count, int64_t bytes) {
+        writeOps_->add(count);
+        if (bytes > 0) {
+            writeBytes_->add(bytes);
+        }
+    }
+
+    // Return the number of operations since last call
+    int64_t takeOps() {
+        return ops_.exchange(0, std::memory_order_relaxed);
+    }
+
     // clean up all data about this part.
     void reset() {
         LOG(INFO) << idStr_ << "Clean up all wals";
@@ -83,6 +121,11 @@ public:
             LOG(WARNING) << idStr_ << "Remove the committedLogId failed, error "
                          << static_cast<int32_t>(res);
         }
+        res = engine_->remove(NebulaKeyUtils::systemEdgeKeyLayoutKey(partId_));
+        if (res != ResultCode::SUCCEEDED) {
+            LOG(WARNING) << idStr_ << "Remove the edge key layout failed, error "
+                         << static_cast<int32_t>(res);
+        }
     }
 
 private:
@@ -104,6 +147,11 @@ private:
                        ClusterID clusterId,
                        const std::string& log) override;
 
+    // The consecutive atomic ops are evaluated against the writes of the former ones,
+    // and their batches are merged into one log
+    folly::Optional<std::string> processAtomicOps(const std::vector<raftex::AtomicOp*>& ops,
+                                                  std::vector<bool>* results) override;
+
     std::pair<int64_t, int64_t> commitSnapshot(const std::vector<std::string>& data,
                                                LogID committedLogId,
                                                TermID committedLogTerm,
@@ -111,17 +159,31 @@ private:
 
     ResultCode putCommitMsg(WriteBatch* batch, LogID committedLogId, TermID committedLogTerm);
 
+    // Apply a log of data operation onto the batch
+    bool applyLog(WriteBatch* batch, folly::StringPiece log);
+
+    // Load the edge key layout of the part from the engine into NebulaKeyUtils
+    void loadEdgeKeyLayout();
+
     void cleanup() override {
-        LOG(INFO) << idStr_ << "Clean up all data, just reset the committedLogId!";
+        LOG(INFO) << idStr_ << "Clean up all data, just reset the committedLogId "
+                  << "and the edge key layout!";
         auto batch = engine_->startBatchWrite();
         if (ResultCode::SUCCEEDED != putCommitMsg(batch.get(), 0, 0)) {
             LOG(ERROR) << idStr_ << "Put failed in commit";
             return;
         }
+        // The layout of the leader comes with the snapshot
+        if (ResultCode::SUCCEEDED !=
+                batch->remove(NebulaKeyUtils::systemEdgeKeyLayoutKey(partId_))) {
+            LOG(ERROR) << idStr_ << "Remove failed in commit";
+            return;
+        }
         if (ResultCode::SUCCEEDED != engine_->commitBatchWrite(std::move(batch))) {
             LOG(ERROR) << idStr_ << "Put failed in commit";
             return;
         }
+        NebulaKeyUtils::removeEdgeKeyLayout(spaceId_, partId_);
         return;
     }
 
@@ -134,6 +196,15 @@ protected:
     std::string walPath_;
     KVEngine* engine_ = nullptr;
     NewLeaderCallback newLeaderCb_ = nullptr;
+    LeaderChangedCallback leaderChangedCb_ = nullptr;
+    std::atomic<int64_t> ops_{0};
+    // Set when a log applied puts the edge key layout, it is loaded after the commit
+    bool edgeKeyLayoutChanged_{false};
+    // The counters exported as the metrics of the part
+    metrics::Counter* readOps_{nullptr};
+    metrics::Counter* readBytes_{nullptr};
+    metrics::Counter* writeOps_{nullptr};
+    metrics::Counter* writeBytes_{nullptr};
 };
 
 }  // namespace kvstore
@@ -0,0 +1,323 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/PendingWrites.h"
+
+namespace nebula {
+namespace kvstore {
+
+namespace {
+
+thread_local PendingWrites* currentWrites = nullptr;
+
+using RemovedRanges = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * Iterate over the keys of an engine iterator and the entries [dLo, dHi) of the delta,
+ * the delta overrides the engine, and the keys of the engine in the removed ranges are
+ * skipped. The keys of the engine are read as the iterator moves, so an op which only
+ * reads a few keys of a large range doesn't load the whole range.
+ *
+ * Moving forward, both the engine iterator and dIt_ are on the first entries which are
+ * not less than the current key. Moving backward, the engine iterator is on the last key
+ * which is not greater than the current key, and dIt_ is next to the last such entry of
+ * the delta. The direction is switched by seeking to the current key again.
+ * */
+class PendingIter final : public KVIterator {
+public:
+    PendingIter(std::unique_ptr<KVIterator> iter,
+                RemovedRanges removedRanges,
+                std::shared_ptr<const MemDelta> delta,
+                MemDelta::const_iterator dLo,
+                MemDelta::const_iterator dHi)
+        : iter_(std::move(iter))
+        , removedRanges_(std::move(removedRanges))
+        , delta_(std::move(delta))
+        , dLo_(dLo)
+        , dHi_(dHi)
+        , dIt_(dLo) {
+        skipForward();
+    }
+
+    bool valid() const override {
+        return iter_->valid() || (forward_ ? dIt_ != dHi_ : dIt_ != dLo_);
+    }
+
+    void next() override {
+        if (!valid()) {
+            return;
+        }
+        if (!forward_) {
+            seek(key().str());
+        }
+        stepForward();
+        skipForward();
+    }
+
+    void prev() override {
+        if (!valid()) {
+            return;
+        }
+        if (forward_) {
+            seekForPrev(key().str());
+        }
+        stepBackward();
+        skipBackward();
+    }
+
+    void seek(folly::StringPiece target) override {
+        forward_ = true;
+        iter_->seek(target);
+        dIt_ = std::lower_bound(dLo_, dHi_, target,
+                                [] (const MemDelta::value_type& kv, folly::StringPiece t) {
+                                    return folly::StringPiece(kv.first) < t;
+                                });
+        skipForward();
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        forward_ = false;
+        iter_->seekForPrev(target);
+        dIt_ = std::upper_bound(dLo_, dHi_, target,
+                                [] (folly::StringPiece t, const MemDelta::value_type& kv) {
+                                    return t < folly::StringPiece(kv.first);
+                                });
+        skipBackward();
+    }
+
+    folly::StringPiece key() const override {
+        if (fromDelta()) {
+            return deltaEntry()->first;
+        }
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        if (fromDelta()) {
+            return deltaEntry()->second.value();
+        }
+        return iter_->val();
+    }
+
+private:
+    // The entry of the delta next to the current position in the direction
+    MemDelta::const_iterator deltaEntry() const {
+        return forward_ ? dIt_ : std::prev(dIt_);
+    }
+
+    bool hasDelta() const {
+        return forward_ ? dIt_ != dHi_ : dIt_ != dLo_;
+    }
+
+    // Whether the current entry is from the delta
+    bool fromDelta() const {
+        if (!hasDelta()) {
+            return false;
+        }
+        if (!iter_->valid()) {
+            return true;
+        }
+        folly::StringPiece deltaKey(deltaEntry()->first);
+        return forward_ ? iter_->key() >= deltaKey : iter_->key() <= deltaKey;
+    }
+
+    // Whether the current entry of the delta overrides the current key of the engine
+    bool overridden() const {
+        return iter_->valid() && iter_->key() == folly::StringPiece(deltaEntry()->first);
+    }
+
+    bool removedByRange(folly::StringPiece key) const {
+        for (auto& range : removedRanges_) {
+            if (key >= folly::StringPiece(range.first) &&
+                key < folly::StringPiece(range.second)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void stepForward() {
+        if (fromDelta()) {
+            if (overridden()) {
+                iter_->next();
+            }
+            ++dIt_;
+        } else {
+            iter_->next();
+        }
+    }
+
+    void stepBackward() {
+        if (fromDelta()) {
+            if (overridden()) {
+                iter_->prev();
+            }
+            --dIt_;
+        } else {
+            iter_->prev();
+        }
+    }
+
+    // Skip the keys removed by range in the engine, and the keys removed in the delta
+    void skipForward() {
+        while (true) {
+            while (iter_->valid() && removedByRange(iter_->key())) {
+                iter_->next();
+            }
+            if (!fromDelta() || deltaEntry()->second.hasValue()) {
+                return;
+            }
+            stepForward();
+        }
+    }
+
+    void skipBackward() {
+        while (true) {
+            while (iter_->valid() && removedByRange(iter_->key())) {
+                iter_->prev();
+            }
+            if (!fromDelta() || deltaEntry()->second.hasValue()) {
+                return;
+            }
+            stepBackward();
+        }
+    }
+
+private:
+    std::unique_ptr<KVIterator>         iter_;
+    RemovedRanges                       removedRanges_;
+    std::shared_ptr<const MemDelta>     delta_;
+    MemDelta::const_iterator            dLo_;
+    MemDelta::const_iterator            dHi_;
+    MemDelta::const_iterator            dIt_;
+    bool                                forward_{true};
+};
+
+}  // Anonymous namespace
+
+
+PendingWrites::PendingWrites(GraphSpaceID spaceId, PartitionID partId)
+        : spaceId_(spaceId)
+        , partId_(partId)
+        , delta_(std::make_shared<MemDelta>()) {
+    CHECK(currentWrites == nullptr);
+    currentWrites = this;
+}
+
+
+PendingWrites::~PendingWrites() {
+    CHECK_EQ(currentWrites, this);
+    currentWrites = nullptr;
+}
+
+
+const PendingWrites* PendingWrites::current(GraphSpaceID spaceId, PartitionID partId) {
+    auto* writes = currentWrites;
+    if (writes == nullptr || writes->empty()
+            || writes->spaceId_ != spaceId || writes->partId_ != partId) {
+        return nullptr;
+    }
+    return writes;
+}
+
+
+MemDelta& PendingWrites::mutableDelta() {
+    if (delta_.use_count() > 1) {
+        delta_ = std::make_shared<MemDelta>(*delta_);
+    }
+    return *delta_;
+}
+
+
+void PendingWrites::put(folly::StringPiece key, folly::StringPiece val) {
+    mutableDelta()[key.str()] = val.str();
+}
+
+
+void PendingWrites::remove(folly::StringPiece key) {
+    mutableDelta()[key.str()] = folly::none;
+}
+
+
+void PendingWrites::removeRange(folly::StringPiece start, folly::StringPiece end) {
+    auto& delta = mutableDelta();
+    delta.erase(delta.lower_bound(start.str()), delta.lower_bound(end.str()));
+    removedRanges_.emplace_back(start.str(), end.str());
+}
+
+
+bool PendingWrites::removedByRange(folly::StringPiece key) const {
+    for (auto& range : removedRanges_) {
+        if (key >= folly::StringPiece(range.first) && key < folly::StringPiece(range.second)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+ResultCode PendingWrites::get(KVEngine* engine,
+                              const std::string& key,
+                              std::string* value) const {
+    auto it = delta_->find(key);
+    if (it != delta_->end()) {
+        if (!it->second.hasValue()) {
+            return ResultCode::ERR_KEY_NOT_FOUND;
+        }
+        *value = it->second.value();
+        return ResultCode::SUCCEEDED;
+    }
+    if (removedByRange(key)) {
+        return ResultCode::ERR_KEY_NOT_FOUND;
+    }
+    return engine->get(key, value);
+}
+
+
+ResultCode PendingWrites::range(KVEngine* engine,
+                                const std::string& start,
+                                const std::string& end,
+                                std::unique_ptr<KVIterator>* iter) const {
+    std::unique_ptr<KVIterator> engineIter;
+    auto code = engine->range(start, end, &engineIter);
+    if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+    auto dLo = delta_->lower_bound(start);
+    auto dHi = start < end ? delta_->lower_bound(end) : dLo;
+    *iter = merge(std::move(engineIter), dLo, dHi);
+    return ResultCode::SUCCEEDED;
+}
+
+
+ResultCode PendingWrites::rangeWithPrefix(KVEngine* engine,
+                                          const std::string& start,
+                                          const std::string& prefix,
+                                          std::unique_ptr<KVIterator>* iter) const {
+    std::unique_ptr<KVIterator> engineIter;
+    auto code = start == prefix ? engine->prefix(prefix, &engineIter)
+                                : engine->rangeWithPrefix(start, prefix, &engineIter);
+    if (code != ResultCode::SUCCEEDED) {
+        return code;
+    }
+    auto dLo = delta_->lower_bound(std::max(start, prefix));
+    auto dHi = dLo;
+    while (dHi != delta_->end() && folly::StringPiece(dHi->first).startsWith(prefix)) {
+        ++dHi;
+    }
+    *iter = merge(std::move(engineIter), dLo, dHi);
+    return ResultCode::SUCCEEDED;
+}
+
+
+std::unique_ptr<KVIterator> PendingWrites::merge(std::unique_ptr<KVIterator> iter,
+                                                 MemDelta::const_iterator dLo,
+                                                 MemDelta::const_iterator dHi) const {
+    return std::make_unique<PendingIter>(std::move(iter), removedRanges_, delta_, dLo, dHi);
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,81 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_PENDINGWRITES_H_
+#define KVSTORE_PENDINGWRITES_H_
+
+#include "common/base/Base.h"
+#include "kvstore/Common.h"
+#include "kvstore/KVEngine.h"
+#include "kvstore/MemEngine.h"
+
+namespace nebula {
+namespace kvstore {
+
+/**
+ * The writes of the atomic ops which have been evaluated but not committed yet.
+ *
+ * The consecutive atomic ops of a part are evaluated one after another and shipped in
+ * one log, so the later ops must read through the writes of the former ones. The reads
+ * of the part go through the pending writes while they are installed, which only happens
+ * on the thread evaluating the ops, so nobody else could see the uncommitted data.
+ * */
+class PendingWrites final {
+public:
+    // Install the pending writes of the part for the current thread
+    PendingWrites(GraphSpaceID spaceId, PartitionID partId);
+
+    ~PendingWrites();
+
+    // The pending writes of the part installed on the current thread, nullptr if none
+    static const PendingWrites* current(GraphSpaceID spaceId, PartitionID partId);
+
+    bool empty() const {
+        return delta_->empty() && removedRanges_.empty();
+    }
+
+    void put(folly::StringPiece key, folly::StringPiece val);
+
+    void remove(folly::StringPiece key);
+
+    void removeRange(folly::StringPiece start, folly::StringPiece end);
+
+    /*********************
+     * Read the engine through the pending writes
+     ********************/
+    ResultCode get(KVEngine* engine, const std::string& key, std::string* value) const;
+
+    ResultCode range(KVEngine* engine,
+                     const std::string& start,
+                     const std::string& end,
+                     std::unique_ptr<KVIterator>* iter) const;
+
+    ResultCode rangeWithPrefix(KVEngine* engine,
+                               const std::string& start,
+                               const std::string& prefix,
+                               std::unique_ptr<KVIterator>* iter) const;
+
+private:
+    // Make the delta writable, the iterators returned still hold the old one
+    MemDelta& mutableDelta();
+
+    bool removedByRange(folly::StringPiece key) const;
+
+    // Merge the keys of the engine in the iterator with the delta in [dLo, dHi)
+    std::unique_ptr<KVIterator> merge(std::unique_ptr<KVIterator> iter,
+                                      MemDelta::const_iterator dLo,
+                                      MemDelta::const_iterator dHi) const;
+
+private:
+    GraphSpaceID                                        spaceId_;
+    PartitionID                                         partId_;
+    std::shared_ptr<MemDelta>                           delta_;
+    std::vector<std::pair<std::string, std::string>>    removedRanges_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_PENDINGWRITES_H_
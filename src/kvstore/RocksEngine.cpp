@@ -7,6 +7,7 @@
 #include "common/base/Base.h"
 #include "common/fs/FileUtils.h"
 #include <folly/String.h>
+#include <rocksdb/sst_file_writer.h>
 #include "kvstore/RocksEngine.h"
 #include "kvstore/KVStore.h"
 #include "kvstore/RocksEngineConfig.h"
@@ -126,7 +127,15 @@ ResultCode RocksEngine::commitBatchWrite(std::unique_ptr<WriteBatch> batch, bool
 
 
 ResultCode RocksEngine::get(const std::string& key, std::string* value) {
+    return get(key, value, nullptr);
+}
+
+
+ResultCode RocksEngine::get(const std::string& key,
+                            std::string* value,
+                            const void* snapshot) {
     rocksdb::ReadOptions options;
+    options.snapshot = reinterpret_cast<const rocksdb::Snapshot*>(snapshot);
     rocksdb::Status status = db_->Get(options, rocksdb::Slice(key), value);
     if (status.ok()) {
         return ResultCode::SUCCEEDED;
@@ -143,23 +152,47 @@ ResultCode RocksEngine::get(const std::string& key, std::string* value) {
 std::vector<Status> RocksEngine::multiGet(const std::vector<std::string>& keys,
                                           std::vector<std::string>* values) {
     rocksdb::ReadOptions options;
+    auto num = keys.size();
+    // The batched MultiGet looks up the keys in order, so the blocks are read once
+    std::vector<size_t> order(num);
+    for (size_t i = 0; i < num; i++) {
+        order[i] = i;
+    }
+    bool sorted = std::is_sorted(keys.begin(), keys.end());
+    if (!sorted) {
+        std::sort(order.begin(), order.end(), [&keys] (size_t a, size_t b) {
+            return keys[a] < keys[b];
+        });
+    }
     std::vector<rocksdb::Slice> slices;
-    for (size_t index = 0; index < keys.size(); index++) {
-        slices.emplace_back(keys[index]);
-    }
-
-    auto status = db_->MultiGet(options, slices, values);
-    std::vector<Status> ret;
-    std::transform(status.begin(), status.end(), std::back_inserter(ret),
-                   [] (const auto& s) {
-                       if (s.ok()) {
-                           return Status::OK();
-                       } else if (s.IsNotFound()) {
-                           return Status::KeyNotFound();
-                       } else {
-                           return Status::Error();
-                       }
-                   });
+    slices.reserve(num);
+    for (auto idx : order) {
+        slices.emplace_back(keys[idx]);
+    }
+    std::vector<rocksdb::PinnableSlice> pinned(num);
+    std::vector<rocksdb::Status> status(num);
+    db_->MultiGet(options,
+                  db_->DefaultColumnFamily(),
+                  num,
+                  slices.data(),
+                  pinned.data(),
+                  status.data(),
+                  true);
+
+    values->resize(num);
+    std::vector<Status> ret(num);
+    for (size_t i = 0; i < num; i++) {
+        auto idx = order[i];
+        const auto& s = status[i];
+        if (s.ok()) {
+            (*values)[idx].assign(pinned[i].data(), pinned[i].size());
+            ret[idx] = Status::OK();
+        } else if (s.IsNotFound()) {
+            ret[idx] = Status::KeyNotFound();
+        } else {
+            ret[idx] = Status::Error();
+        }
+    }
     return ret;
 }
 
@@ -167,7 +200,16 @@ std::vector<Status> RocksEngine::multiGet(const std::vector<std::string>& keys,
 ResultCode RocksEngine::range(const std::string& start,
                               const std::string& end,
                               std::unique_ptr<KVIterator>* storageIter) {
+    return range(start, end, storageIter, nullptr);
+}
+
+
+ResultCode RocksEngine::range(const std::string& start,
+                              const std::string& end,
+                              std::unique_ptr<KVIterator>* storageIter,
+                              const void* snapshot) {
     rocksdb::ReadOptions options;
+    options.snapshot = reinterpret_cast<const rocksdb::Snapshot*>(snapshot);
     rocksdb::Iterator* iter = db_->NewIterator(options);
     if (iter) {
         iter->Seek(rocksdb::Slice(start));
@@ -179,7 +221,15 @@ ResultCode RocksEngine::range(const std::string& start,
 
 ResultCode RocksEngine::prefix(const std::string& prefix,
                                std::unique_ptr<KVIterator>* storageIter) {
+    return this->prefix(prefix, storageIter, nullptr);
+}
+
+
+ResultCode RocksEngine::prefix(const std::string& prefix,
+                               std::unique_ptr<KVIterator>* storageIter,
+                               const void* snapshot) {
     rocksdb::ReadOptions options;
+    options.snapshot = reinterpret_cast<const rocksdb::Snapshot*>(snapshot);
     rocksdb::Iterator* iter = db_->NewIterator(options);
     if (iter) {
         iter->Seek(rocksdb::Slice(prefix));
@@ -202,6 +252,16 @@ ResultCode RocksEngine::rangeWithPrefix(const std::string& start,
 }
 
 
+const void* RocksEngine::getSnapshot() {
+    return db_->GetSnapshot();
+}
+
+
+void RocksEngine::releaseSnapshot(const void* snapshot) {
+    db_->ReleaseSnapshot(reinterpret_cast<const rocksdb::Snapshot*>(snapshot));
+}
+
+
 ResultCode RocksEngine::put(std::string key, std::string value) {
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
@@ -328,6 +388,16 @@ int32_t RocksEngine::totalPartsNum() {
 }
 
 
+int64_t RocksEngine::approximateSize(const std::string& start, const std::string& end) {
+    rocksdb::Range range(start, end);
+    uint64_t size = 0;
+    uint8_t flags = rocksdb::DB::SizeApproximationFlags::INCLUDE_FILES
+                  | rocksdb::DB::SizeApproximationFlags::INCLUDE_MEMTABLES;
+    db_->GetApproximateSizes(&range, 1, &size, flags);
+    return static_cast<int64_t>(size);
+}
+
+
 ResultCode RocksEngine::ingest(const std::vector<std::string>& files) {
     rocksdb::IngestExternalFileOptions options;
     rocksdb::Status status = db_->IngestExternalFile(files, options);
@@ -340,6 +410,26 @@ ResultCode RocksEngine::ingest(const std::vector<std::string>& files) {
 }
 
 
+ResultCode RocksEngine::writeSstFile(const std::string& path, const std::vector<KV>& kvs) {
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), db_->GetOptions());
+    auto status = writer.Open(path);
+    for (auto& kv : kvs) {
+        if (!status.ok()) {
+            break;
+        }
+        status = writer.Put(kv.first, kv.second);
+    }
+    if (status.ok()) {
+        status = writer.Finish();
+    }
+    if (!status.ok()) {
+        LOG(ERROR) << "Write sst file " << path << " failed: " << status.ToString();
+        return ResultCode::ERR_UNKNOWN;
+    }
+    return ResultCode::SUCCEEDED;
+}
+
+
 ResultCode RocksEngine::setOption(const std::string& configKey,
                                   const std::string& configValue) {
     std::unordered_map<std::string, std::string> configOptions = {
@@ -385,6 +475,21 @@ ResultCode RocksEngine::compact() {
     }
 }
 
+ResultCode RocksEngine::compactRange(const std::string& start, const std::string& end) {
+    rocksdb::CompactRangeOptions options;
+    // Let the automatic compactions of the other ranges go on
+    options.exclusive_manual_compaction = false;
+    rocksdb::Slice begin(start);
+    rocksdb::Slice last(end);
+    rocksdb::Status status = db_->CompactRange(options, &begin, &last);
+    if (status.ok()) {
+        return ResultCode::SUCCEEDED;
+    } else {
+        LOG(ERROR) << "CompactRange Failed: " << status.ToString();
+        return ResultCode::ERR_UNKNOWN;
+    }
+}
+
 ResultCode RocksEngine::flush() {
     rocksdb::FlushOptions options;
     rocksdb::Status status = db_->Flush(options);
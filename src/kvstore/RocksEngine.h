@@ -27,7 +27,9 @@ public:
     ~RocksRangeIter()  = default;
 
     bool valid() const override {
-        return !!iter_ && iter_->Valid() && (iter_->key().compare(end_) < 0);
+        return !!iter_ && iter_->Valid()
+            && iter_->key().compare(start_) >= 0
+            && iter_->key().compare(end_) < 0;
     }
 
     void next() override {
@@ -38,6 +40,26 @@ public:
         iter_->Prev();
     }
 
+    void seek(folly::StringPiece target) override {
+        rocksdb::Slice slice(target.data(), target.size());
+        iter_->Seek(slice.compare(start_) < 0 ? start_ : slice);
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        rocksdb::Slice slice(target.data(), target.size());
+        if (slice.compare(end_) < 0) {
+            iter_->SeekForPrev(slice);
+            return;
+        }
+        // move to the last key before end
+        iter_->Seek(end_);
+        if (iter_->Valid()) {
+            iter_->Prev();
+        } else {
+            iter_->SeekToLast();
+        }
+    }
+
     folly::StringPiece key() const override {
         return folly::StringPiece(iter_->key().data(), iter_->key().size());
     }
@@ -72,6 +94,35 @@ public:
         iter_->Prev();
     }
 
+    void seek(folly::StringPiece target) override {
+        rocksdb::Slice slice(target.data(), target.size());
+        iter_->Seek(slice.compare(prefix_) < 0 ? prefix_ : slice);
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        rocksdb::Slice slice(target.data(), target.size());
+        if (slice.starts_with(prefix_) || slice.compare(prefix_) < 0) {
+            iter_->SeekForPrev(slice);
+            return;
+        }
+        // The target is after all keys with the prefix, move to the last one of them
+        std::string end = prefix_.ToString();
+        while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xFF) {
+            end.pop_back();
+        }
+        if (end.empty()) {
+            iter_->SeekForPrev(slice);
+            return;
+        }
+        end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+        iter_->Seek(end);
+        if (iter_->Valid()) {
+            iter_->Prev();
+        } else {
+            iter_->SeekToLast();
+        }
+    }
+
     folly::StringPiece key() const override {
         return folly::StringPiece(iter_->key().data(), iter_->key().size());
     }
@@ -131,6 +182,23 @@ public:
                                const std::string& prefix,
                                std::unique_ptr<KVIterator>* iter) override;
 
+    const void* getSnapshot() override;
+
+    void releaseSnapshot(const void* snapshot) override;
+
+    ResultCode get(const std::string& key,
+                   std::string* value,
+                   const void* snapshot) override;
+
+    ResultCode range(const std::string& start,
+                     const std::string& end,
+                     std::unique_ptr<KVIterator>* iter,
+                     const void* snapshot) override;
+
+    ResultCode prefix(const std::string& prefix,
+                      std::unique_ptr<KVIterator>* iter,
+                      const void* snapshot) override;
+
     /*********************
      * Data modification
      ********************/
@@ -156,8 +224,12 @@ public:
 
     int32_t totalPartsNum() override;
 
+    int64_t approximateSize(const std::string& start, const std::string& end) override;
+
     ResultCode ingest(const std::vector<std::string>& files) override;
 
+    ResultCode writeSstFile(const std::string& path, const std::vector<KV>& kvs) override;
+
     ResultCode setOption(const std::string& configKey,
                          const std::string& configValue) override;
 
@@ -166,6 +238,8 @@ public:
 
     ResultCode compact() override;
 
+    ResultCode compactRange(const std::string& start, const std::string& end) override;
+
     ResultCode flush() override;
 
     /*********************
@@ -31,6 +31,8 @@ DECLARE_bool(rocksdb_disable_wal);
 // BlockBasedTable block_cache
 DECLARE_int64(rocksdb_block_cache);
 
+DECLARE_bool(enable_rocksdb_statistics);
+
 DECLARE_int32(rocksdb_batch_size);
 
 DECLARE_string(part_man_type);
@@ -41,6 +43,9 @@ namespace kvstore {
 
 rocksdb::Status initRocksdbOptions(rocksdb::Options &baseOpts);
 
+// The statistics of all rocksdb instances, used if FLAGS_enable_rocksdb_statistics is set
+std::shared_ptr<rocksdb::Statistics> getRocksdbStatistics();
+
 bool loadOptionsMap(std::unordered_map<std::string, std::string> &map, const std::string& gflags);
 
 }  // namespace kvstore
@@ -16,38 +16,62 @@ void SnapshotManagerImpl::accessAllRowsInSnapshot(GraphSpaceID spaceId,
                                                   PartitionID partId,
                                                   raftex::SnapshotCallback cb) {
     CHECK_NOTNULL(store_);
-    std::unique_ptr<KVIterator> iter;
-    auto prefix = NebulaKeyUtils::partPrefix(partId);
     std::vector<std::string> data;
     int64_t totalSize = 0;
     int64_t totalCount = 0;
-    auto ret = store_->prefix(spaceId, partId, prefix, &iter);
-    if (ret != ResultCode::SUCCEEDED) {
-        LOG(INFO) << "[spaceId:" << spaceId << ", partId:" << partId << "] access prefix failed"
-                  << ", error code:" << static_cast<int32_t>(ret);
-        cb(data, totalCount, totalSize, raftex::SnapshotStatus::FAILED);
-        return;
-    }
     data.reserve(kReserveNum);
     int32_t batchSize = 0;
-    while (iter && iter->valid()) {
-        if (batchSize >= FLAGS_snapshot_batch_size) {
-            if (cb(data, totalCount, totalSize, raftex::SnapshotStatus::IN_PROGRESS)) {
-                data.clear();
-                batchSize = 0;
-            } else {
-                LOG(INFO) << "[spaceId:" << spaceId << ", partId:" << partId
-                          << "] callback invoked failed";
-                return;
+    // The edges may be kept apart from the vertices, or some of them are not converted yet.
+    // The type the edges are moved to is scanned last, so an edge moved in between is sent
+    // twice rather than lost, and the layout is sent after all of them.
+    std::vector<NebulaKeyType> types = {NebulaKeyType::kEdge, NebulaKeyType::kData};
+    if (NebulaKeyUtils::edgeKeyType(spaceId, partId) == NebulaKeyType::kEdge) {
+        std::swap(types[0], types[1]);
+    }
+    for (auto type : types) {
+        std::unique_ptr<KVIterator> iter;
+        auto prefix = NebulaKeyUtils::partPrefix(partId, type);
+        auto ret = store_->prefix(spaceId, partId, prefix, &iter);
+        if (ret != ResultCode::SUCCEEDED) {
+            LOG(INFO) << "[spaceId:" << spaceId << ", partId:" << partId
+                      << "] access prefix failed"
+                      << ", error code:" << static_cast<int32_t>(ret);
+            cb(data, totalCount, totalSize, raftex::SnapshotStatus::FAILED);
+            return;
+        }
+        while (iter && iter->valid()) {
+            if (batchSize >= FLAGS_snapshot_batch_size) {
+                if (cb(data, totalCount, totalSize, raftex::SnapshotStatus::IN_PROGRESS)) {
+                    data.clear();
+                    batchSize = 0;
+                } else {
+                    LOG(INFO) << "[spaceId:" << spaceId << ", partId:" << partId
+                              << "] callback invoked failed";
+                    return;
+                }
             }
+            auto key = iter->key();
+            auto val = iter->val();
+            data.emplace_back(encodeKV(key, val));
+            batchSize += data.back().size();
+            totalSize += data.back().size();
+            totalCount++;
+            iter->next();
         }
-        auto key = iter->key();
-        auto val = iter->val();
-        data.emplace_back(encodeKV(key, val));
-        batchSize += data.back().size();
+    }
+    std::string layout;
+    auto layoutKey = NebulaKeyUtils::systemEdgeKeyLayoutKey(partId);
+    auto ret = store_->get(spaceId, partId, layoutKey, &layout);
+    if (ret == ResultCode::SUCCEEDED) {
+        data.emplace_back(encodeKV(layoutKey, layout));
         totalSize += data.back().size();
         totalCount++;
-        iter->next();
+    } else if (ret != ResultCode::ERR_KEY_NOT_FOUND) {
+        LOG(INFO) << "[spaceId:" << spaceId << ", partId:" << partId
+                  << "] get the edge key layout failed"
+                  << ", error code:" << static_cast<int32_t>(ret);
+        cb(data, totalCount, totalSize, raftex::SnapshotStatus::FAILED);
+        return;
     }
     cb(data, totalCount, totalSize, raftex::SnapshotStatus::DONE);
 }
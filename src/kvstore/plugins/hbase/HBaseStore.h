@@ -41,6 +41,21 @@ public:
         current_--;
     }
 
+    void seek(folly::StringPiece target) override {
+        current_ = std::lower_bound(begin_, end_, target,
+                                    [] (const KV& kv, folly::StringPiece t) {
+                                        return folly::StringPiece(kv.first) < t;
+                                    });
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        auto it = std::upper_bound(begin_, end_, target,
+                                   [] (folly::StringPiece t, const KV& kv) {
+                                       return t < folly::StringPiece(kv.first);
+                                   });
+        current_ = it == begin_ ? end_ : std::prev(it);
+    }
+
     folly::StringPiece key() const override {
         return folly::StringPiece(current_->first);
     }
@@ -175,6 +190,10 @@ public:
         return ResultCode::ERR_UNSUPPORTED;
     }
 
+    ResultCode checkLeader(GraphSpaceID, PartitionID) override {
+        return ResultCode::SUCCEEDED;
+    }
+
     ResultCode compact(GraphSpaceID) override {
         return ResultCode::ERR_UNSUPPORTED;
     }
@@ -195,6 +214,21 @@ public:
         return ResultCode::ERR_UNSUPPORTED;
     }
 
+    ResultCode movePart(GraphSpaceID, PartitionID, int32_t) override {
+        return ResultCode::ERR_UNSUPPORTED;
+    }
+
+    ResultCode balanceDataPaths() override {
+        return ResultCode::ERR_UNSUPPORTED;
+    }
+
+    // There is no leader in HBaseStore
+    int64_t addLeaderListener(LeaderListener) override {
+        return -1;
+    }
+
+    void removeLeaderListener(int64_t) override {}
+
 private:
     std::string getRowKey(const std::string& key) {
         return key.substr(sizeof(PartitionID), key.size() - sizeof(PartitionID));
@@ -15,6 +15,9 @@ DEFINE_uint32(max_appendlog_batch_size, 128,
               "The max number of logs in each appendLog request batch");
 DEFINE_uint32(max_outstanding_requests, 1024,
               "The max number of outstanding appendLog requests");
+DEFINE_uint32(max_inflight_appendlog_requests, 4,
+              "The max number of appendLog requests sent to each follower"
+              " which have not been responded");
 DEFINE_int32(raft_rpc_timeout_ms, 500, "rpc timeout for raft client");
 
 DECLARE_bool(trace_raft);
@@ -32,8 +35,7 @@ Host::Host(const HostAddr& addr, std::shared_ptr<RaftPart> part, bool isLearner)
             "%s[Host: %s:%d] ",
             part_->idStr_.c_str(),
             addr_.host.c_str(),
-            addr_.port))
-        , cachingPromise_(folly::SharedPromise<cpp2::AppendLogResponse>()) {
+            addr_.port)) {
 }
 
 
@@ -42,7 +44,7 @@ void Host::waitForStop() {
 
     CHECK(stopped_);
     noMoreRequestCV_.wait(g, [this] {
-        return !requestOnGoing_;
+        return requestsInFlight_ == 0;
     });
     LOG(INFO) << idStr_ << "The host has been stopped!";
 }
@@ -103,300 +105,290 @@ folly::Future<cpp2::AppendLogResponse> Host::appendLogs(
                   << "]";
     }
     auto ret = folly::Future<cpp2::AppendLogResponse>::makeEmpty();
-    std::shared_ptr<cpp2::AppendLogRequest> req;
+    uint64_t gen = 0;
+    Requests reqs;
     {
         std::lock_guard<std::mutex> g(lock_);
 
         auto res = checkStatus();
-        if (logId <= lastLogIdSent_) {
-            LOG(INFO) << idStr_ << "The log " << logId << " has been sended"
-                      << ", lastLogIdSent " << lastLogIdSent_;
+        if (res != cpp2::ErrorCode::SUCCEEDED) {
+            VLOG(2) << idStr_
+                    << "The host is not in a proper status, just return";
             cpp2::AppendLogResponse r;
-            r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+            r.set_error_code(res);
             return r;
         }
 
-        if (requestOnGoing_ && res == cpp2::ErrorCode::SUCCEEDED) {
-            if (cachingPromise_.size() <= FLAGS_max_outstanding_requests) {
-                pendingReq_ = std::make_tuple(term,
-                                              logId,
-                                              committedLogId);
-                return cachingPromise_.getFuture();
-            } else {
-                PLOG_EVERY_N(INFO, 200) << idStr_
-                          << "Too many requests are waiting, return error";
-                cpp2::AppendLogResponse r;
-                r.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
-                return r;
-            }
+        if (term < logTermToSend_) {
+            VLOG(2) << idStr_ << "The term " << term << " is out of date, the current term is "
+                    << logTermToSend_;
+            cpp2::AppendLogResponse r;
+            r.set_error_code(cpp2::ErrorCode::E_TERM_OUT_OF_DATE);
+            return r;
         }
 
-        if (res != cpp2::ErrorCode::SUCCEEDED) {
-            VLOG(2) << idStr_
-                    << "The host is not in a proper status, just return";
+        if (term > logTermToSend_) {
+            // The first logs of a new term, nothing is known about the follower's logs.
+            // The requests of the old term are dropped, and we start from the previous log
+            // of the batch.
+            LOG(INFO) << idStr_ << "Start to send the logs of term " << term
+                      << " from id " << prevLogId + 1 << ", the previous log term "
+                      << prevLogTerm;
             cpp2::AppendLogResponse r;
-            r.set_error_code(res);
+            r.set_error_code(cpp2::ErrorCode::E_TERM_OUT_OF_DATE);
+            setResponse(r);
+            logTermToSend_ = term;
+            logIdToSend_ = prevLogId;
+            lastLogIdAccepted_ = 0;
+            lastLogTermAccepted_ = 0;
+            resync(prevLogId, prevLogTerm);
+            termGen_ = gen_;
+        }
+
+        if (logId <= lastLogIdAccepted_) {
+            VLOG(2) << idStr_ << "The log " << logId << " has been accepted"
+                    << ", lastLogIdAccepted " << lastLogIdAccepted_;
+            cpp2::AppendLogResponse r;
+            r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
             return r;
         }
 
-        VLOG(2) << idStr_ << "About to send the AppendLog request";
+        if (promises_.size() >= FLAGS_max_outstanding_requests) {
+            PLOG_EVERY_N(INFO, 200) << idStr_
+                                    << "Too many requests are waiting, return error";
+            cpp2::AppendLogResponse r;
+            r.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
+            return r;
+        }
 
-        // No request is ongoing, let's send a new request
-        if (UNLIKELY(lastLogIdSent_ == 0 && lastLogTermSent_ == 0)) {
-            LOG(INFO) << idStr_ << "This is the first time to send the logs to this host";
-            lastLogIdSent_ = prevLogId;
-            lastLogTermSent_ = prevLogTerm;
+        if (logId > logIdToSend_) {
+            logIdToSend_ = logId;
         }
-        if (prevLogTerm < lastLogTermSent_ || prevLogId < lastLogIdSent_) {
-            LOG(INFO) << idStr_ << "We have sended this log, so go on from id " << lastLogIdSent_
-                      << ", term " << lastLogTermSent_ << "; current prev log id " << prevLogId
-                      << ", current prev log term " << prevLogTerm;
+        if (committedLogId > committedLogId_) {
+            committedLogId_ = committedLogId;
         }
-        logTermToSend_ = term;
-        logIdToSend_ = logId;
-        committedLogId_ = committedLogId;
-        pendingReq_ = std::make_tuple(0, 0, 0);
-        promise_ = std::move(cachingPromise_);
-        cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
-        ret = promise_.getFuture();
-
-        requestOnGoing_ = true;
+        ret = promises_[logId].getFuture();
 
-        req = prepareAppendLogRequest();
+        gen = gen_;
+        reqs = prepareAppendLogRequests();
     }
 
-    // Get a new promise
-    appendLogsInternal(eb, std::move(req));
-
+    appendLogsInternal(eb, gen, std::move(reqs));
     return ret;
 }
 
+void Host::setAccepted(const cpp2::AppendLogResponse& r) {
+    CHECK(!lock_.try_lock());
+    auto it = promises_.begin();
+    while (it != promises_.end() && it->first <= lastLogIdAccepted_) {
+        it->second.setValue(r);
+        it = promises_.erase(it);
+    }
+}
+
 void Host::setResponse(const cpp2::AppendLogResponse& r) {
     CHECK(!lock_.try_lock());
-    promise_.setValue(r);
-    cachingPromise_.setValue(r);
-    cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
-    pendingReq_ = std::make_tuple(0, 0, 0);
-    requestOnGoing_ = false;
+    for (auto& p : promises_) {
+        p.second.setValue(r);
+    }
+    promises_.clear();
 }
 
-void Host::appendLogsInternal(folly::EventBase* eb,
-                              std::shared_ptr<cpp2::AppendLogRequest> req) {
-    sendAppendLogRequest(eb, std::move(req)).via(eb).then(
-            [eb, self = shared_from_this()] (folly::Try<cpp2::AppendLogResponse>&& t) {
-        VLOG(3) << self->idStr_ << "appendLogs() call got response";
-        if (t.hasException()) {
-            VLOG(2) << self->idStr_ << t.exception().what();
-            cpp2::AppendLogResponse r;
-            r.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
-            {
-                std::lock_guard<std::mutex> g(self->lock_);
-                self->setResponse(r);
-                self->lastLogIdSent_ = self->logIdToSend_ - 1;
-            }
-            self->noMoreRequestCV_.notify_all();
-            return;
+void Host::resync(LogID logId, TermID logTerm) {
+    CHECK(!lock_.try_lock());
+    VLOG(2) << idStr_ << "Drop " << requestsInFlight_ << " requests in flight"
+            << ", and send the logs from id " << logId + 1 << " later";
+    ++gen_;
+    resyncing_ = true;
+    resyncLogId_ = logId;
+    resyncLogTerm_ = logTerm;
+}
+
+Host::Requests Host::prepareAppendLogRequests() {
+    CHECK(!lock_.try_lock());
+    Requests reqs;
+    if (checkStatus() != cpp2::ErrorCode::SUCCEEDED) {
+        return reqs;
+    }
+    if (resyncing_) {
+        if (requestsInFlight_ > 0) {
+            // Responses of the dropped requests may change the follower's logs, so wait
+            // for all of them to be back
+            return reqs;
+        }
+        lastLogIdSent_ = resyncLogId_;
+        lastLogTermSent_ = resyncLogTerm_;
+        resyncing_ = false;
+    }
+    // Only the logs of the same term as the last log accepted by the follower are pipelined.
+    // So when the follower receives the requests out of order, it finds a gap but never rolls
+    // back its logs because of a different term. And the request without logs, i.e. when
+    // sending the snapshot, is never pipelined.
+    while (!promises_.empty()
+            && lastLogIdSent_ < logIdToSend_
+            && requestsInFlight_ < FLAGS_max_inflight_appendlog_requests) {
+        if (requestsInFlight_ > 0 && lastLogTermSent_ != lastLogTermAccepted_) {
+            break;
+        }
+        auto req = prepareAppendLogRequest();
+        auto numLogs = req->get_log_str_list().size();
+        if (requestsInFlight_ > 0
+                && (numLogs == 0 || req->get_log_term() != lastLogTermAccepted_)) {
+            break;
+        }
+        ++requestsInFlight_;
+        maxRequestsInFlight_ = std::max(maxRequestsInFlight_, requestsInFlight_);
+        reqs.emplace_back(std::move(req));
+        if (numLogs == 0) {
+            break;
         }
+        // The next request follows the logs of this one
+        lastLogTermSent_ = reqs.back()->get_log_term();
+        lastLogIdSent_ += numLogs;
+    }
+    return reqs;
+}
+
+void Host::appendLogsInternal(folly::EventBase* eb, uint64_t gen, Requests reqs) {
+    for (auto& req : reqs) {
+        LogRange range;
+        range.prevLogId = req->get_last_log_id_sent();
+        range.prevLogTerm = req->get_last_log_term_sent();
+        // The last log is the previous one if the request has no logs
+        range.lastLogId = range.prevLogId + req->get_log_str_list().size();
+        range.lastLogTerm = req->get_log_str_list().empty() ? range.prevLogTerm
+                                                            : req->get_log_term();
+        sendAppendLogRequest(eb, std::move(req)).via(eb).then(
+                [eb, gen, range, self = shared_from_this()]
+                (folly::Try<cpp2::AppendLogResponse>&& t) {
+            self->onResponse(eb, gen, range, std::move(t));
+        });
+    }
+}
+
+void Host::onResponse(folly::EventBase* eb,
+                      uint64_t gen,
+                      const LogRange& range,
+                      folly::Try<cpp2::AppendLogResponse>&& t) {
+    VLOG(3) << idStr_ << "appendLogs() call got response";
+    cpp2::AppendLogResponse resp;
+    if (t.hasException()) {
+        VLOG(2) << idStr_ << t.exception().what();
+        resp.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
+    } else {
+        resp = std::move(t).value();
+    }
 
-        cpp2::AppendLogResponse resp = std::move(t).value();
+    uint64_t newGen = 0;
+    Requests reqs;
+    {
+        std::lock_guard<std::mutex> g(lock_);
         if (FLAGS_trace_raft) {
             LOG(INFO)
-                << self->idStr_ << "AppendLogResponse "
+                << idStr_ << "AppendLogResponse "
                 << "code " << static_cast<int32_t>(resp.get_error_code())
                 << ", currTerm " << resp.get_current_term()
                 << ", lastLogId " << resp.get_last_log_id()
                 << ", lastLogTerm " << resp.get_last_log_term()
                 << ", commitLogId " << resp.get_committed_log_id()
-                << ", lastLogIdSent_ " << self->lastLogIdSent_
-                << ", lastLogTermSent_ " << self->lastLogTermSent_;
+                << ", lastLogIdInReq " << range.lastLogId
+                << ", lastLogIdSent_ " << lastLogIdSent_
+                << ", lastLogTermSent_ " << lastLogTermSent_;
         }
-        switch (resp.get_error_code()) {
-            case cpp2::ErrorCode::SUCCEEDED: {
-                VLOG(2) << self->idStr_
-                        << "AppendLog request sent successfully";
-
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " just return";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->lastLogIdSent_ >= resp.get_last_log_id()) {
-                        VLOG(1) << self->idStr_
-                                << "We send nothing in the last request"
-                                << ", so we don't send the same logs again";
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        if (self->lastLogIdSent_ < self->logIdToSend_) {
-                            // More to send
-                            VLOG(2) << self->idStr_
-                                    << "There are more logs to send";
-                            newReq = self->prepareAppendLogRequest();
-                        } else {
-                            VLOG(2) << self->idStr_
-                                    << "Fulfill the promise, size = " << self->promise_.size();
-                            // Fulfill the promise
-                            self->promise_.setValue(resp);
-
-                            if (self->noRequest()) {
-                                VLOG(2) << self->idStr_ << "No request any more!";
-                                self->requestOnGoing_ = false;
-                            } else {
-                                auto& tup = self->pendingReq_;
-                                self->logTermToSend_ = std::get<0>(tup);
-                                self->logIdToSend_ = std::get<1>(tup);
-                                self->committedLogId_ = std::get<2>(tup);
-                                VLOG(2) << self->idStr_
-                                        << "Sending the pending request in the queue"
-                                        << ", from " << self->lastLogIdSent_ + 1
-                                        << " to " << self->logIdToSend_;
-                                newReq = self->prepareAppendLogRequest();
-                                self->promise_ = std::move(self->cachingPromise_);
-                                self->cachingPromise_
-                                    = folly::SharedPromise<cpp2::AppendLogResponse>();
-                                self->pendingReq_ = std::make_tuple(0, 0, 0);
-                            }  // self->noRequest()
-                        }  // self->lastLogIdSent_ < self->logIdToSend_
-                    }  // else
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
-            }
-            case cpp2::ErrorCode::E_LOG_GAP: {
-                VLOG(2) << self->idStr_
-                        << "The host's log is behind, need to catch up";
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip catching up the gap";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->lastLogIdSent_ == resp.get_last_log_id()) {
-                        VLOG(1) << self->idStr_
-                                << "We send nothing in the last request"
-                                << ", so we don't send the same logs again";
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
-            }
-            case cpp2::ErrorCode::E_WAITING_SNAPSHOT: {
-                VLOG(2) << self->idStr_
-                        << "The host is waiting for the snapshot, so we need to send log from "
-                        << " current committedLogId " << self->committedLogId_;
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip waiting the snapshot";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = self->committedLogId_;
-                        self->lastLogTermSent_ = self->logTermToSend_;
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
-            }
-            case cpp2::ErrorCode::E_LOG_STALE: {
-                VLOG(2) << self->idStr_ << "Log stale, reset lastLogIdSent " << self->lastLogIdSent_
-                        << " to the followers lastLodId " << resp.get_last_log_id();
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip waiting the snapshot";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->logIdToSend_ <= resp.get_last_log_id()) {
-                        VLOG(1) << self->idStr_
-                                << "It means the request has been received by follower";
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
-            }
-            default: {
-                PLOG_EVERY_N(ERROR, 100)
-                           << self->idStr_
-                           << "Failed to append logs to the host (Err: "
-                           << static_cast<int32_t>(resp.get_error_code())
-                           << ")";
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    self->setResponse(resp);
-                    self->lastLogIdSent_ = self->logIdToSend_ - 1;
-                }
-                self->noMoreRequestCV_.notify_all();
-                return;
+        --requestsInFlight_;
+        handleResponse(gen, range, resp);
+        newGen = gen_;
+        reqs = prepareAppendLogRequests();
+    }
+    if (reqs.empty()) {
+        noMoreRequestCV_.notify_all();
+    } else {
+        appendLogsInternal(eb, newGen, std::move(reqs));
+    }
+}
+
+void Host::handleResponse(uint64_t gen,
+                          const LogRange& range,
+                          const cpp2::AppendLogResponse& resp) {
+    CHECK(!lock_.try_lock());
+    auto res = checkStatus();
+    if (res != cpp2::ErrorCode::SUCCEEDED) {
+        VLOG(2) << idStr_ << "The host is not in a proper status, just return";
+        cpp2::AppendLogResponse r;
+        r.set_error_code(res);
+        setResponse(r);
+        return;
+    }
+
+    if (gen < termGen_) {
+        VLOG(2) << idStr_ << "Ignore the response of the request in the previous term";
+        return;
+    }
+
+    // The follower appends the logs only after the previous one, so a succeeded request
+    // means all logs before it have been accepted, no matter it is dropped or not
+    if (resp.get_error_code() == cpp2::ErrorCode::SUCCEEDED) {
+        VLOG(2) << idStr_ << "AppendLog request sent successfully";
+        followerCommittedLogId_ = std::max(followerCommittedLogId_,
+                                           resp.get_committed_log_id());
+        if (range.lastLogId > lastLogIdAccepted_) {
+            lastLogIdAccepted_ = range.lastLogId;
+            lastLogTermAccepted_ = range.lastLogTerm;
+        }
+        setAccepted(resp);
+        return;
+    }
+
+    if (gen != gen_) {
+        VLOG(2) << idStr_ << "Ignore the response of a dropped request, code "
+                << static_cast<int32_t>(resp.get_error_code());
+        return;
+    }
+
+    followerCommittedLogId_ = std::max(followerCommittedLogId_, resp.get_committed_log_id());
+    switch (resp.get_error_code()) {
+        case cpp2::ErrorCode::E_LOG_GAP: {
+            VLOG(2) << idStr_ << "The host's log is behind, need to catch up from "
+                    << resp.get_last_log_id();
+            resync(resp.get_last_log_id(), resp.get_last_log_term());
+            return;
+        }
+        case cpp2::ErrorCode::E_WAITING_SNAPSHOT: {
+            VLOG(2) << idStr_
+                    << "The host is waiting for the snapshot, so we need to send log from "
+                    << " current committedLogId " << committedLogId_;
+            resync(committedLogId_, logTermToSend_);
+            return;
+        }
+        case cpp2::ErrorCode::E_LOG_STALE: {
+            VLOG(2) << idStr_ << "Log stale, reset lastLogIdSent " << lastLogIdSent_
+                    << " to the followers lastLodId " << resp.get_last_log_id();
+            if (logIdToSend_ <= resp.get_last_log_id()) {
+                VLOG(1) << idStr_
+                        << "It means the request has been received by follower";
+                lastLogIdAccepted_ = logIdToSend_;
+                lastLogTermAccepted_ = resp.get_last_log_id() == logIdToSend_
+                                     ? resp.get_last_log_term() : 0;
+                cpp2::AppendLogResponse r;
+                r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+                setAccepted(r);
             }
+            resync(resp.get_last_log_id(), resp.get_last_log_term());
+            return;
         }
-    });
+        default: {
+            PLOG_EVERY_N(ERROR, 100)
+                       << idStr_
+                       << "Failed to append logs to the host (Err: "
+                       << static_cast<int32_t>(resp.get_error_code())
+                       << ")";
+            // Nobody waits for the logs now, they will be sent from the failed request
+            // on the next call
+            setResponse(resp);
+            resync(range.prevLogId, range.prevLogTerm);
+            return;
+        }
+    }
 }
 
 
@@ -497,12 +489,6 @@ folly::Future<cpp2::AppendLogResponse> Host::sendAppendLogRequest(
     return client->future_appendLog(*req);
 }
 
-bool Host::noRequest() const {
-    CHECK(!lock_.try_lock());
-    static auto emptyTup = std::make_tuple(0, 0, 0);
-    return pendingReq_ == emptyTup;
-}
-
 }  // namespace raftex
 }  // namespace nebula
 
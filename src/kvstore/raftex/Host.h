@@ -12,6 +12,7 @@
 #include "common/interface/gen-cpp2/RaftexServiceAsyncClient.h"
 #include "common/thrift/ThriftClientManager.h"
 #include <folly/futures/Future.h>
+#include <folly/futures/SharedPromise.h>
 
 namespace folly {
 class EventBase;
@@ -67,7 +68,10 @@ public:
         const cpp2::AskForVoteRequest& req,
         folly::EventBase* eb);
 
-    // When logId == lastLogIdSent, it is a heartbeat
+    // The returned future is fulfilled once the follower has accepted the logs up to logId.
+    // The logs are sent in several requests at the same time, at most
+    // FLAGS_max_inflight_appendlog_requests ones, so the follower could receive the next
+    // batch before the previous one is acknowledged.
     folly::Future<cpp2::AppendLogResponse> appendLogs(
         folly::EventBase* eb,
         TermID term,                // Current term
@@ -80,27 +84,57 @@ public:
         return addr_;
     }
 
+    // The most appendLog requests which have been in flight at the same time
+    size_t maxRequestsInFlight() const {
+        std::lock_guard<std::mutex> g(lock_);
+        return maxRequestsInFlight_;
+    }
+
 private:
+    using Requests = std::vector<std::shared_ptr<cpp2::AppendLogRequest>>;
+
+    // The previous log and the last log of a request
+    struct LogRange {
+        LogID prevLogId{0};
+        TermID prevLogTerm{0};
+        LogID lastLogId{0};
+        TermID lastLogTerm{0};
+    };
+
     cpp2::ErrorCode checkStatus() const;
 
     folly::Future<cpp2::AppendLogResponse> sendAppendLogRequest(
         folly::EventBase* eb,
         std::shared_ptr<cpp2::AppendLogRequest> req);
 
-    void appendLogsInternal(
-        folly::EventBase* eb,
-        std::shared_ptr<cpp2::AppendLogRequest> req);
+    // Send the requests prepared in the generation
+    void appendLogsInternal(folly::EventBase* eb, uint64_t gen, Requests reqs);
+
+    void onResponse(folly::EventBase* eb,
+                    uint64_t gen,
+                    const LogRange& range,
+                    folly::Try<cpp2::AppendLogResponse>&& t);
+
+    void handleResponse(uint64_t gen,
+                        const LogRange& range,
+                        const cpp2::AppendLogResponse& resp);
+
+    // Prepare the requests of the logs not sent yet, as many as the window allows
+    Requests prepareAppendLogRequests();
 
     std::shared_ptr<cpp2::AppendLogRequest> prepareAppendLogRequest();
 
-    bool noRequest() const;
+    // Fulfill the promises of the logs which have been accepted by the follower
+    void setAccepted(const cpp2::AppendLogResponse& r);
 
+    // Fulfill all the promises
     void setResponse(const cpp2::AppendLogResponse& r);
 
-private:
-    // <term, logId, committedLogId>
-    using Request = std::tuple<TermID, LogID, LogID>;
+    // Drop the requests in flight, and send the logs after the given one once
+    // all of them are back
+    void resync(LogID logId, TermID logTerm);
 
+private:
     std::shared_ptr<RaftPart> part_;
     const HostAddr addr_;
     bool isLearner_ = false;
@@ -111,21 +145,34 @@ private:
     bool paused_{false};
     bool stopped_{false};
 
-    bool requestOnGoing_{false};
+    // Number of the appendLog requests waiting for the response
+    size_t requestsInFlight_{0};
+    size_t maxRequestsInFlight_{0};
     std::condition_variable noMoreRequestCV_;
-    folly::SharedPromise<cpp2::AppendLogResponse> promise_;
-    folly::SharedPromise<cpp2::AppendLogResponse> cachingPromise_;
-
-    Request pendingReq_{0, 0, 0};
+    // The generation is bumped when the requests in flight are dropped, the failures
+    // of the requests from an old generation are ignored
+    uint64_t gen_{0};
+    // The generation when the current term begins
+    uint64_t termGen_{0};
+    // Whether waiting for the requests in flight before sending from the resync point
+    bool resyncing_{false};
+    LogID resyncLogId_{0};
+    TermID resyncLogTerm_{0};
+    // logId => the promise to be fulfilled when the follower has accepted the logs up to logId
+    std::map<LogID, folly::SharedPromise<cpp2::AppendLogResponse>> promises_;
 
     // These logId and term pointing to the latest log we need to send
     LogID logIdToSend_{0};
     TermID logTermToSend_{0};
 
-    // The previous log before this batch
+    // The last log of the requests sent, it may not be accepted yet
     LogID lastLogIdSent_{0};
     TermID lastLogTermSent_{0};
 
+    // The last log accepted by the follower in the current term
+    LogID lastLogIdAccepted_{0};
+    TermID lastLogTermAccepted_{0};
+
     LogID committedLogId_{0};
     std::atomic_bool sendingSnapshot_{false};
 
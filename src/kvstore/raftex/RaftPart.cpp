@@ -19,6 +19,7 @@
 #include "kvstore/raftex/LogStrListIterator.h"
 #include "kvstore/raftex/Host.h"
 #include "kvstore/raftex/RaftPart.h"
+#include "kvstore/raftex/WriteAdmission.h"
 
 DEFINE_uint32(raft_heartbeat_interval_secs, 5,
              "Seconds between each heartbeat");
@@ -26,11 +27,22 @@ DEFINE_uint32(raft_heartbeat_interval_secs, 5,
 DEFINE_uint64(raft_snapshot_timeout, 60 * 5, "Max seconds between two snapshot requests");
 
 DEFINE_uint32(max_batch_size, 256, "The max number of logs in a batch");
+DEFINE_uint32(max_inflight_batches, 4,
+              "The max number of batches being replicated at the same time in each part");
+DEFINE_uint64(raft_part_buffer_bytes, 16 * 1024 * 1024,
+              "The max bytes of the logs in the buffer of each part");
+DEFINE_uint64(raft_part_queue_bytes, 64 * 1024 * 1024,
+              "The max bytes of the logs waiting to be put into the buffer of each part");
+DEFINE_uint32(raft_admission_timeout_ms, 2000,
+              "The max milliseconds a log waits to be put into the buffer, "
+              "0 means failing at once when the buffer is full");
 
 DEFINE_int32(wal_ttl, 14400, "Default wal ttl");
 DEFINE_int64(wal_file_size, 16 * 1024 * 1024, "Default wal file size");
 DEFINE_int32(wal_buffer_size, 8 * 1024 * 1024, "Default wal buffer size");
 DEFINE_int32(wal_buffer_num, 2, "Default wal buffer number");
+DEFINE_int32(wal_read_buffer_size, 4 * 1024 * 1024,
+             "Max size of the read-ahead buffer when reading logs from the wal files");
 DEFINE_bool(trace_raft, false, "Enable trace one raft request");
 
 namespace nebula {
@@ -41,7 +53,8 @@ using nebula::thrift::ThriftClientManager;
 using nebula::wal::FileBasedWal;
 using nebula::wal::FileBasedWalPolicy;
 
-using OpProcessor = folly::Function<folly::Optional<std::string>(AtomicOp op)>;
+using OpProcessor = folly::Function<folly::Optional<std::string>(const std::vector<AtomicOp*>&,
+                                                                 std::vector<bool>*)>;
 
 class AppendLogsIterator final : public LogIterator {
 public:
@@ -80,8 +93,14 @@ public:
         return firstLogId_;
     }
 
+    // Results of the atomic ops processed at the head of the current logs
+    const std::vector<bool>& atomicOpResults() const {
+        return opResults_;
+    }
+
     // Return true if the current log is a AtomicOp, otherwise return false
     bool processAtomicOp() {
+        opResults_.clear();
         while (idx_ < logs_.size()) {
             auto& tup = logs_.at(idx_);
             auto logType = std::get<1>(tup);
@@ -90,15 +109,24 @@ public:
                 return false;
             }
 
-            // Process AtomicOp log
+            // Process the consecutive AtomicOp logs
+            std::vector<AtomicOp*> ops;
+            for (auto i = idx_; i < logs_.size() && std::get<1>(logs_[i]) == LogType::ATOMIC_OP;
+                    i++) {
+                ops.emplace_back(&std::get<3>(logs_[i]));
+            }
             CHECK(!!opCB_);
-            opResult_ = opCB_(std::move(std::get<3>(tup)));
+            std::vector<bool> results;
+            opResult_ = opCB_(ops, &results);
+            CHECK(!results.empty() && results.size() <= ops.size());
+            opResults_.insert(opResults_.end(), results.begin(), results.end());
             if (opResult_.hasValue()) {
-                // AtomicOp Succeeded
+                // AtomicOps Succeeded, they are merged into one log which is the current one
+                idx_ += results.size() - 1;
                 return true;
             } else {
-                // AtomicOp failed, move to the next log, but do not increment the logId_
-                ++idx_;
+                // AtomicOps failed, move to the next log, but do not increment the logId_
+                idx_ += results.size();
             }
         }
 
@@ -161,6 +189,7 @@ public:
     // Resume the iterator so that we can continue to process the remaining logs
     void resume() {
         CHECK(!valid_);
+        opResults_.clear();
         if (!empty()) {
             leadByAtomicOp_ = processAtomicOp();
             valid_ = idx_ < logs_.size();
@@ -183,6 +212,7 @@ private:
     LogType lastLogType_{LogType::NORMAL};
     LogType currLogType_{LogType::NORMAL};
     folly::Optional<std::string> opResult_;
+    std::vector<bool> opResults_;
     LogID firstLogId_;
     TermID termId_;
     LogID logId_;
@@ -191,6 +221,47 @@ private:
 };
 
 
+// The logs taken from the buffer at once, they are written into the WAL and replicated
+// together, or in several segments if there are atomic ops or commands.
+struct RaftPart::Batch {
+    PromiseSet<AppendLogResult> promise;
+    std::unique_ptr<AppendLogsIterator> iter;
+    TermID term{0};
+    // The last log of the batch written into the WAL
+    LogID lastId{0};
+    // Whether there is any atomic op or command in the batch
+    bool barrier{false};
+    // Whether the batch is committed or failed, the promise has been (or will be) fulfilled
+    // by whoever set it, protected by the raftLock_
+    bool done{false};
+    // The bytes taken from WriteAdmission, given back when the batch is finished
+    size_t bytes{0};
+
+    // All the atomic ops at the head of the current logs have failed, nothing is going
+    // to be committed for them
+    void setAtomicOpsFailed() {
+        if (!iter->leadByAtomicOp()) {
+            for (size_t i = 0; i < iter->atomicOpResults().size(); i++) {
+                promise.setOneSingleValue(AppendLogResult::E_ATOMIC_OP_FAILURE);
+            }
+        }
+    }
+
+    // The current logs have been committed
+    void setSucceeded() {
+        if (iter->hasNonAtomicOpLogs()) {
+            promise.setOneSharedValue(AppendLogResult::SUCCEEDED);
+        }
+        if (iter->leadByAtomicOp()) {
+            for (auto succeeded : iter->atomicOpResults()) {
+                promise.setOneSingleValue(succeeded ? AppendLogResult::SUCCEEDED
+                                                    : AppendLogResult::E_ATOMIC_OP_FAILURE);
+            }
+        }
+    }
+};
+
+
 /********************************************************
  *
  *  Implementation of RaftPart
@@ -227,6 +298,7 @@ RaftPart::RaftPart(
     policy.fileSize = FLAGS_wal_file_size;
     policy.bufferSize = FLAGS_wal_buffer_size;
     policy.numBuffers = FLAGS_wal_buffer_num;
+    policy.readBufferSize = FLAGS_wal_read_buffer_size;
     wal_ = FileBasedWal::getWal(walRoot,
                                 idStr_,
                                 policy,
@@ -335,6 +407,8 @@ void RaftPart::stop() {
         hosts = std::move(hosts_);
     }
 
+    failWaitingLogs(AppendLogResult::E_STOPPED);
+
     for (auto& h : hosts) {
         h->stop();
     }
@@ -558,117 +632,303 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
         return AppendLogResult::E_WRITE_BLOCKING;
     }
 
-    LogCache swappedOutLogs;
+    auto bytes = logBytes(log);
     auto retFuture = folly::Future<AppendLogResult>::makeEmpty();
-
-    if (bufferOverFlow_) {
-        PLOG_EVERY_N(WARNING, 30) << idStr_
-                     << "The appendLog buffer is full."
-                        " Please slow down the log appending rate."
-                     << "replicatingLogs_ :" << replicatingLogs_;
-        return AppendLogResult::E_BUFFER_OVERFLOW;
-    }
     {
         std::lock_guard<std::mutex> lck(logsLock_);
 
-        VLOG(2) << idStr_ << "Checking whether buffer overflow";
-
-        if (logs_.size() >= FLAGS_max_batch_size) {
-            // Buffer is full
-            LOG(WARNING) << idStr_
-                         << "The appendLog buffer is full."
-                            " Please slow down the log appending rate."
-                         << "replicatingLogs_ :" << replicatingLogs_;
-            bufferOverFlow_ = true;
-            return AppendLogResult::E_BUFFER_OVERFLOW;
+        // The logs wait in order, so nobody could jump the queue
+        bool admitted = false;
+        if (waitingLogs_.empty() && !admissionQueued_ && bufferHasRoom(bytes)) {
+            admitted = WriteAdmission::instance().tryAcquire(bytes, false, shared_from_this());
+            admissionQueued_ = !admitted;
         }
 
-        VLOG(2) << idStr_ << "Appending logs to the buffer";
+        if (!admitted) {
+            if (FLAGS_raft_admission_timeout_ms == 0
+                    || (!waitingLogs_.empty()
+                        && waitingBytes_ + bytes > FLAGS_raft_part_queue_bytes)) {
+                PLOG_EVERY_N(WARNING, 100) << idStr_
+                             << "The appendLog buffer is full."
+                                " Please slow down the log appending rate."
+                             << "replicatingLogs_ :" << replicatingLogs_;
+                return AppendLogResult::E_BUFFER_OVERFLOW;
+            }
 
-        // Append new logs to the buffer
-        DCHECK_GE(source, 0);
-        logs_.emplace_back(source, logType, std::move(log), std::move(op));
-        switch (logType) {
-            case LogType::ATOMIC_OP:
-                retFuture = cachingPromise_.getSingleFuture();
-                break;
-            case LogType::COMMAND:
-                retFuture = cachingPromise_.getAndRollSharedFuture();
-                break;
-            case LogType::NORMAL:
-                retFuture = cachingPromise_.getSharedFuture();
-                break;
+            VLOG(2) << idStr_ << "The buffer is full, the log waits to be appended";
+            folly::Promise<AppendLogResult> promise;
+            retFuture = promise.getFuture();
+            waitingLogs_.emplace_back(WaitingLog{source,
+                                                 logType,
+                                                 std::move(log),
+                                                 std::move(op),
+                                                 bytes,
+                                                 std::move(promise),
+                                                 time::Duration()});
+            waitingBytes_ += bytes;
+            WriteAdmission::instance().addWaitingBytes(bytes);
+            scheduleExpiration();
+            return retFuture;
         }
 
-        bool expected = false;
-        if (replicatingLogs_.compare_exchange_strong(expected, true)) {
-            // We need to send logs to all followers
-            VLOG(2) << idStr_ << "Preparing to send AppendLog request";
-            sendingPromise_ = std::move(cachingPromise_);
-            cachingPromise_.reset();
-            std::swap(swappedOutLogs, logs_);
-            bufferOverFlow_ = false;
-        } else {
+        VLOG(2) << idStr_ << "Appending logs to the buffer";
+        retFuture = bufferLog(source, logType, std::move(log), std::move(op), bytes);
+
+        if (replicatingLogs_ || !canReplicate()) {
             VLOG(2) << idStr_
                     << "Another AppendLogs request is ongoing,"
                        " just return";
             return retFuture;
         }
+        replicatingLogs_ = true;
+    }
+
+    // Replicate buffered logs to all followers
+    // Replication will happen on a separate thread and will block
+    // until majority accept the logs, the leadership changes, or
+    // the partition stops
+    replicateBatches();
+    return retFuture;
+}
+
+size_t RaftPart::logBytes(const std::string& log) {
+    return log.size() + sizeof(LogCache::value_type);
+}
+
+bool RaftPart::bufferHasRoom(size_t bytes) const {
+    CHECK(!logsLock_.try_lock());
+    if (logs_.empty()) {
+        return true;
+    }
+    return logs_.size() < FLAGS_max_batch_size
+        && logsBytes_ + bytes <= FLAGS_raft_part_buffer_bytes;
+}
+
+folly::Future<AppendLogResult> RaftPart::bufferLog(ClusterID source,
+                                                   LogType logType,
+                                                   std::string log,
+                                                   AtomicOp op,
+                                                   size_t bytes) {
+    CHECK(!logsLock_.try_lock());
+    // Append new logs to the buffer
+    DCHECK_GE(source, 0);
+    logs_.emplace_back(source, logType, std::move(log), std::move(op));
+    logsBytes_ += bytes;
+    switch (logType) {
+        case LogType::ATOMIC_OP:
+            logsBarrier_ = true;
+            return cachingPromise_.getSingleFuture();
+        case LogType::COMMAND:
+            logsBarrier_ = true;
+            return cachingPromise_.getAndRollSharedFuture();
+        case LogType::NORMAL:
+            break;
+    }
+    return cachingPromise_.getSharedFuture();
+}
+
+void RaftPart::admitLogs(bool woken) {
+    CHECK(!logsLock_.try_lock());
+    auto& admission = WriteAdmission::instance();
+    while (!waitingLogs_.empty() && !admissionQueued_) {
+        auto& waiting = waitingLogs_.front();
+        if (!bufferHasRoom(waiting.bytes)) {
+            // Wait for the buffer to be taken
+            return;
+        }
+        if (!admission.tryAcquire(waiting.bytes, woken, shared_from_this())) {
+            admissionQueued_ = true;
+            return;
+        }
+        admission.addWaitTime(true, waiting.duration.elapsedInUSec());
+        admission.addWaitingBytes(-static_cast<int64_t>(waiting.bytes));
+        waitingBytes_ -= waiting.bytes;
+        bufferLog(waiting.source,
+                  waiting.logType,
+                  std::move(waiting.log),
+                  std::move(waiting.op),
+                  waiting.bytes)
+            .thenValue([promise = std::move(waiting.promise)] (AppendLogResult res) mutable {
+                promise.setValue(res);
+            });
+        waitingLogs_.pop_front();
     }
+}
 
-    LogID firstId = 0;
-    TermID termId = 0;
-    AppendLogResult res;
+void RaftPart::admitWaitingLogs() {
     {
-        std::lock_guard<std::mutex> g(raftLock_);
-        res = canAppendLogs();
-        if (res == AppendLogResult::SUCCEEDED) {
-            firstId = lastLogId_ + 1;
-            termId = term_;
+        std::lock_guard<std::mutex> lck(logsLock_);
+        admissionQueued_ = false;
+        admitLogs(true);
+        if (replicatingLogs_ || !canReplicate()) {
+            return;
         }
+        replicatingLogs_ = true;
     }
+    replicateBatches();
+}
 
-    if (!checkAppendLogResult(res)) {
-        // Mosy likely failed because the parttion is not leader
-        PLOG_EVERY_N(ERROR, 100) << idStr_ << "Cannot append logs, clean the buffer";
-        return res;
+void RaftPart::scheduleExpiration() {
+    CHECK(!logsLock_.try_lock());
+    if (expirationScheduled_ || waitingLogs_.empty()) {
+        return;
     }
-    // Replicate buffered logs to all followers
-    // Replication will happen on a separate thread and will block
-    // until majority accept the logs, the leadership changes, or
-    // the partition stops
-    VLOG(2) << idStr_ << "Calling appendLogsInternal()";
-    AppendLogsIterator it(
-        firstId,
-        termId,
-        std::move(swappedOutLogs),
-        [this] (AtomicOp opCB) -> folly::Optional<std::string> {
-            CHECK(opCB != nullptr);
-            auto opRet = opCB();
-            if (!opRet.hasValue()) {
-                // Failed
-                sendingPromise_.setOneSingleValue(AppendLogResult::E_ATOMIC_OP_FAILURE);
+    // The first one is the oldest
+    auto waited = waitingLogs_.front().duration.elapsedInMSec();
+    auto delayMS = waited < FLAGS_raft_admission_timeout_ms
+                 ? FLAGS_raft_admission_timeout_ms - waited
+                 : 0;
+    expirationScheduled_ = true;
+    bgWorkers_->addDelayTask(delayMS + 1, [self = shared_from_this()] {
+        self->expireWaitingLogs();
+    });
+}
+
+void RaftPart::expireWaitingLogs() {
+    auto& admission = WriteAdmission::instance();
+    std::vector<folly::Promise<AppendLogResult>> expired;
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        expirationScheduled_ = false;
+        while (!waitingLogs_.empty()) {
+            auto& waiting = waitingLogs_.front();
+            auto waited = waiting.duration.elapsedInUSec();
+            if (waited < FLAGS_raft_admission_timeout_ms * 1000UL) {
+                break;
             }
-            return opRet;
-        });
-    appendLogsInternal(std::move(it), termId);
+            admission.addWaitTime(false, waited);
+            admission.addWaitingBytes(-static_cast<int64_t>(waiting.bytes));
+            waitingBytes_ -= waiting.bytes;
+            expired.emplace_back(std::move(waiting.promise));
+            waitingLogs_.pop_front();
+        }
+        scheduleExpiration();
+    }
+    if (!expired.empty()) {
+        LOG(WARNING) << idStr_ << expired.size() << " logs have waited for "
+                     << FLAGS_raft_admission_timeout_ms << " ms, the buffer is still full";
+    }
+    for (auto& p : expired) {
+        p.setValue(AppendLogResult::E_BUFFER_OVERFLOW);
+    }
+}
 
-    return retFuture;
+void RaftPart::failWaitingLogs(AppendLogResult res) {
+    std::deque<WaitingLog> waitingLogs;
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        if (waitingLogs_.empty()) {
+            return;
+        }
+        std::swap(waitingLogs, waitingLogs_);
+        WriteAdmission::instance().addWaitingBytes(-static_cast<int64_t>(waitingBytes_));
+        waitingBytes_ = 0;
+    }
+    for (auto& waiting : waitingLogs) {
+        waiting.promise.setValue(res);
+    }
 }
 
-void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
+bool RaftPart::canReplicate() const {
+    CHECK(!logsLock_.try_lock());
+    if (logs_.empty() || inflightNum_ >= FLAGS_max_inflight_batches || inflightBarrier_) {
+        return false;
+    }
+    // The atomic ops must be evaluated after all logs before them are committed,
+    // so the logs with any atomic op or command wait for all batches in flight
+    return inflightNum_ == 0 || !logsBarrier_;
+}
+
+void RaftPart::replicateBatches() {
+    std::shared_ptr<Batch> batch;
+    while ((batch = takeBatch()) != nullptr) {
+        VLOG(2) << idStr_ << "Calling appendLogsInternal()";
+        appendLogsInternal(std::move(batch));
+    }
+}
+
+void RaftPart::replicateNextBatches() {
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        if (replicatingLogs_ || !canReplicate()) {
+            return;
+        }
+        replicatingLogs_ = true;
+    }
+    replicateBatches();
+}
+
+std::shared_ptr<RaftPart::Batch> RaftPart::takeBatch() {
+    while (true) {
+        auto batch = std::make_shared<Batch>();
+        LogCache logs;
+        {
+            std::lock_guard<std::mutex> lck(logsLock_);
+            CHECK(replicatingLogs_);
+            if (!canReplicate()) {
+                replicatingLogs_ = false;
+                VLOG(2) << idStr_ << "No more log to be replicated, "
+                        << inflightNum_ << " batches are in flight";
+                return nullptr;
+            }
+            // We need to send logs to all followers
+            VLOG(2) << idStr_ << "Preparing to send AppendLog request";
+            batch->promise = std::move(cachingPromise_);
+            cachingPromise_.reset();
+            std::swap(logs, logs_);
+            batch->barrier = logsBarrier_;
+            batch->bytes = logsBytes_;
+            logsBarrier_ = false;
+            logsBytes_ = 0;
+            inflightBarrier_ = batch->barrier;
+            ++inflightNum_;
+            // The buffer is empty now, let the waiting logs in
+            admitLogs(false);
+        }
+
+        LogID firstId = 0;
+        AppendLogResult res;
+        {
+            std::lock_guard<std::mutex> g(raftLock_);
+            res = canAppendLogs();
+            if (res == AppendLogResult::SUCCEEDED) {
+                firstId = lastLogIdInWal().first + 1;
+                batch->term = term_;
+            }
+        }
+
+        if (!checkAppendLogResult(res, batch)) {
+            // Mosy likely failed because the parttion is not leader
+            PLOG_EVERY_N(ERROR, 100) << idStr_ << "Cannot append logs, clean the buffer";
+            continue;
+        }
+
+        batch->iter = std::make_unique<AppendLogsIterator>(
+            firstId,
+            batch->term,
+            std::move(logs),
+            [this] (const std::vector<AtomicOp*>& ops, std::vector<bool>* results) {
+                return processAtomicOps(ops, results);
+            });
+        batch->setAtomicOpsFailed();
+        return batch;
+    }
+}
+
+void RaftPart::appendLogsInternal(std::shared_ptr<Batch> batch) {
     TermID currTerm = 0;
     LogID prevLogId = 0;
     TermID prevLogTerm = 0;
     LogID committed = 0;
     LogID lastId = 0;
+    auto& iter = *batch->iter;
     if (iter.valid()) {
         VLOG(2) << idStr_ << "Ready to append logs from id "
                 << iter.logId() << " (Current term is "
-                << currTerm << ")";
+                << batch->term << ")";
     } else {
         LOG(ERROR) << idStr_ << "Only happend when Atomic op failed";
-        replicatingLogs_ = false;
+        finishBatches({batch});
         return;
     }
     AppendLogResult res = AppendLogResult::SUCCEEDED;
@@ -687,15 +947,14 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
             res = AppendLogResult::E_NOT_A_LEADER;
             break;
         }
-        if (term_ != termId) {
+        if (term_ != batch->term) {
             VLOG(2) << idStr_ << "Term has been updated, origin "
-                    << termId << ", new " << term_;
+                    << batch->term << ", new " << term_;
             res = AppendLogResult::E_TERM_OUT_OF_DATE;
             break;
         }
         currTerm = term_;
-        prevLogId = lastLogId_;
-        prevLogTerm = lastLogTerm_;
+        std::tie(prevLogId, prevLogTerm) = lastLogIdInWal();
         committed = committedLogId_;
         // Step 1: Write WAL
         SlowOpTracker tracker;
@@ -710,17 +969,19 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
                                                        lastId - prevLogId + 1));
         }
         VLOG(2) << idStr_ << "Succeeded writing logs ["
-                << iter.firstLogId() << ", " << lastId << "] to WAL";
+                << prevLogId + 1 << ", " << lastId << "] to WAL";
+        batch->lastId = lastId;
+        inflightBatches_.emplace_back(batch);
     } while (false);
 
-    if (!checkAppendLogResult(res)) {
+    if (!checkAppendLogResult(res, batch)) {
         LOG(ERROR) << idStr_ << "Failed append logs";
         return;
     }
     // Step 2: Replicate to followers
     auto* eb = ioThreadPool_->getEventBase();
     replicateLogs(eb,
-                  std::move(iter),
+                  std::move(batch),
                   currTerm,
                   lastId,
                   committed,
@@ -731,7 +992,7 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
 
 
 void RaftPart::replicateLogs(folly::EventBase* eb,
-                             AppendLogsIterator iter,
+                             std::shared_ptr<Batch> batch,
                              TermID currTerm,
                              LogID lastLogId,
                              LogID committedId,
@@ -744,6 +1005,12 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
     do {
         std::lock_guard<std::mutex> g(raftLock_);
 
+        if (batch->done) {
+            // The logs have been committed along with a later batch
+            VLOG(2) << idStr_ << "The logs to " << lastLogId << " have been committed";
+            return;
+        }
+
         if (status_ != Status::RUNNING) {
             // The partition is not running
             VLOG(2) << idStr_ << "The partition is stopped";
@@ -761,7 +1028,7 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
         hosts = hosts_;
     } while (false);
 
-    if (!checkAppendLogResult(res)) {
+    if (!checkAppendLogResult(res, batch)) {
         LOG(ERROR) << idStr_ << "Replicate logs failed";
         return;
     }
@@ -802,7 +1069,7 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
         .via(executor_.get())
             .then([self = shared_from_this(),
                    eb,
-                   it = std::move(iter),
+                   batch = std::move(batch),
                    currTerm,
                    lastLogId,
                    committedId,
@@ -818,7 +1085,7 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
             }
             self->processAppendLogResponses(*result,
                                             eb,
-                                            std::move(it),
+                                            std::move(batch),
                                             currTerm,
                                             lastLogId,
                                             committedId,
@@ -834,7 +1101,7 @@ void RaftPart::replicateLogs(folly::EventBase* eb,
 void RaftPart::processAppendLogResponses(
         const AppendLogResponses& resps,
         folly::EventBase* eb,
-        AppendLogsIterator iter,
+        std::shared_ptr<Batch> batch,
         TermID currTerm,
         LogID lastLogId,
         LogID committedId,
@@ -855,10 +1122,18 @@ void RaftPart::processAppendLogResponses(
         VLOG(2) << idStr_ << numSucceeded
                 << " hosts have accepted the logs";
 
-        LogID firstLogId = 0;
+        // The batches committed by this response, including the earlier ones still in flight
+        std::vector<std::shared_ptr<Batch>> committed;
+        // The batches left by the previous terms
+        std::vector<std::shared_ptr<Batch>> stale;
         AppendLogResult res = AppendLogResult::SUCCEEDED;
         do {
             std::lock_guard<std::mutex> g(raftLock_);
+            if (batch->done) {
+                VLOG(2) << idStr_ << "The logs to " << lastLogId
+                        << " have been committed along with a later batch";
+                return;
+            }
             if (status_ != Status::RUNNING) {
                 LOG(INFO) << idStr_ << "The partition is stopped";
                 res = AppendLogResult::E_STOPPED;
@@ -874,88 +1149,89 @@ void RaftPart::processAppendLogResponses(
                 res = AppendLogResult::E_TERM_OUT_OF_DATE;
                 break;
             }
-            lastLogId_ = lastLogId;
-            lastLogTerm_ = currTerm;
-
-            auto walIt = wal_->iterator(committedId + 1, lastLogId);
-            SlowOpTracker tracker;
-            // Step 3: Commit the batch
-            if (commitLogs(std::move(walIt))) {
-                committedLogId_ = lastLogId;
-                firstLogId = lastLogId_ + 1;
-            } else {
-                LOG(FATAL) << idStr_ << "Failed to commit logs";
+            if (committedLogId_ < lastLogId) {
+                // The followers accept the logs in order, so the batches before this one
+                // are committed together
+                auto firstCommitId = committedLogId_ + 1;
+                lastLogId_ = lastLogId;
+                lastLogTerm_ = currTerm;
+
+                auto walIt = wal_->iterator(firstCommitId, lastLogId);
+                SlowOpTracker tracker;
+                // Step 3: Commit the batch
+                if (commitLogs(std::move(walIt))) {
+                    committedLogId_ = lastLogId;
+                } else {
+                    LOG(FATAL) << idStr_ << "Failed to commit logs";
+                }
+                if (tracker.slow()) {
+                    tracker.output(idStr_, folly::stringPrintf("Total commit: %ld",
+                                                               lastLogId - firstCommitId + 1));
+                }
+                VLOG(2) << idStr_ << "Leader succeeded in committing the logs "
+                                  << firstCommitId << " to " << lastLogId;
             }
-            if (tracker.slow()) {
-                tracker.output(idStr_, folly::stringPrintf("Total commit: %ld",
-                                                           committedLogId_ - committedId));
+            while (!inflightBatches_.empty()) {
+                auto& front = inflightBatches_.front();
+                if (front->term != currTerm) {
+                    // The logs have been rolled back when it lost the leadership
+                    front->done = true;
+                    stale.emplace_back(std::move(front));
+                } else if (front->lastId <= committedLogId_) {
+                    // The batch with atomic ops may have more logs to append, so only this
+                    // response keeps it, it is the only batch in flight
+                    if (front != batch || !batch->barrier) {
+                        front->done = true;
+                    }
+                    committed.emplace_back(std::move(front));
+                } else {
+                    break;
+                }
+                inflightBatches_.pop_front();
             }
-            VLOG(2) << idStr_ << "Leader succeeded in committing the logs "
-                              << committedId + 1 << " to " << lastLogId;
 
             lastMsgAcceptedCostMs_ = lastMsgSentDur_.elapsedInMSec();
             lastMsgAcceptedTime_ = time::WallClock::fastNowInMilliSec();
         } while (false);
 
-        if (!checkAppendLogResult(res)) {
+        if (!checkAppendLogResult(res, batch)) {
             LOG(ERROR) << idStr_ << "processAppendLogResponses failed!";
             return;
         }
-        // Step 4: Fulfill the promise
-        if (iter.hasNonAtomicOpLogs()) {
-            sendingPromise_.setOneSharedValue(AppendLogResult::SUCCEEDED);
-        }
-        if (iter.leadByAtomicOp()) {
-            sendingPromise_.setOneSingleValue(AppendLogResult::SUCCEEDED);
+        for (auto& b : stale) {
+            b->promise.setValue(AppendLogResult::E_TERM_OUT_OF_DATE);
         }
-        // Step 5: Check whether need to continue
-        // the log replication
-        {
-            std::lock_guard<std::mutex> lck(logsLock_);
-            CHECK(replicatingLogs_);
-            // Continue to process the original AppendLogsIterator if necessary
+        finishBatches(stale);
+        std::vector<std::shared_ptr<Batch>> finished;
+        for (auto& b : committed) {
+            // Step 4: Fulfill the promise
+            b->setSucceeded();
+            // Step 5: Check whether need to continue the log replication of the batch
+            if (b->done) {
+                finished.emplace_back(std::move(b));
+                continue;
+            }
+            auto& iter = *b->iter;
             iter.resume();
-            // If no more valid logs to be replicated in iter, create a new one if we have new log
+            b->setAtomicOpsFailed();
             if (iter.empty()) {
-                VLOG(2) << idStr_ << "logs size " << logs_.size();
-                if (logs_.size() > 0) {
-                    // continue to replicate the logs
-                    sendingPromise_ = std::move(cachingPromise_);
-                    cachingPromise_.reset();
-                    iter = AppendLogsIterator(
-                        firstLogId,
-                        currTerm,
-                        std::move(logs_),
-                        [this] (AtomicOp op) -> folly::Optional<std::string> {
-                            auto opRet = op();
-                            if (!opRet.hasValue()) {
-                                // Failed
-                                sendingPromise_.setOneSingleValue(
-                                    AppendLogResult::E_ATOMIC_OP_FAILURE);
-                            }
-                            return opRet;
-                        });
-                    logs_.clear();
-                    bufferOverFlow_ = false;
-                }
-                // Reset replicatingLogs_ one of the following is true:
-                // 1. old iter is empty && logs_.size() == 0
-                // 2. old iter is empty && logs_.size() > 0, but all logs in new iter is atomic op,
-                //    and all of them failed, which would make iter is empty again
-                if (iter.empty()) {
-                    replicatingLogs_ = false;
-                    VLOG(2) << idStr_ << "No more log to be replicated";
-                    return;
+                {
+                    std::lock_guard<std::mutex> g(raftLock_);
+                    b->done = true;
                 }
+                finished.emplace_back(std::move(b));
+            } else {
+                // Continue to process the original AppendLogsIterator
+                appendLogsInternal(std::move(b));
             }
         }
-        this->appendLogsInternal(std::move(iter), currTerm);
+        finishBatches(finished);
     } else {
         // Not enough hosts accepted the log, re-try
         LOG(WARNING) << idStr_ << "Only " << numSucceeded
                      << " hosts succeeded, Need to try again";
         replicateLogs(eb,
-                      std::move(iter),
+                      std::move(batch),
                       currTerm,
                       lastLogId,
                       committedId,
@@ -964,6 +1240,50 @@ void RaftPart::processAppendLogResponses(
     }
 }
 
+std::pair<LogID, TermID> RaftPart::lastLogIdInWal() const {
+    CHECK(!raftLock_.try_lock());
+    // The batches of the previous terms have been rolled back
+    if (!inflightBatches_.empty() && inflightBatches_.back()->term == term_) {
+        return std::make_pair(inflightBatches_.back()->lastId, term_);
+    }
+    return std::make_pair(lastLogId_, lastLogTerm_);
+}
+
+void RaftPart::finishBatches(const std::vector<std::shared_ptr<Batch>>& batches) {
+    if (batches.empty()) {
+        return;
+    }
+    size_t bytes = 0;
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        for (auto& b : batches) {
+            CHECK_GT(inflightNum_, 0);
+            --inflightNum_;
+            if (b->barrier) {
+                inflightBarrier_ = false;
+            }
+            bytes += b->bytes;
+        }
+    }
+    WriteAdmission::instance().release(bytes);
+    // The window is open now, continue to replicate the logs in the buffer
+    replicateNextBatches();
+}
+
+
+folly::Optional<std::string> RaftPart::processAtomicOps(const std::vector<AtomicOp*>& ops,
+                                                        std::vector<bool>* results) {
+    for (auto* op : ops) {
+        CHECK(*op != nullptr);
+        auto opRet = (*op)();
+        results->emplace_back(opRet.hasValue());
+        if (opRet.hasValue()) {
+            return opRet;
+        }
+    }
+    return folly::none;
+}
+
 
 bool RaftPart::needToSendHeartbeat() {
     std::lock_guard<std::mutex> g(raftLock_);
@@ -1802,18 +2122,42 @@ std::vector<std::shared_ptr<Host>> RaftPart::followers() const {
     return hosts;
 }
 
-bool RaftPart::checkAppendLogResult(AppendLogResult res) {
+bool RaftPart::checkAppendLogResult(AppendLogResult res, std::shared_ptr<Batch> batch) {
     if (res != AppendLogResult::SUCCEEDED) {
+        // All batches after the failed one could not be committed in its term either,
+        // the batches of a later term are kept
+        std::vector<std::shared_ptr<Batch>> failed;
+        {
+            std::lock_guard<std::mutex> g(raftLock_);
+            while (!inflightBatches_.empty()
+                    && inflightBatches_.front()->term <= batch->term) {
+                auto& front = inflightBatches_.front();
+                front->done = true;
+                failed.emplace_back(std::move(front));
+                inflightBatches_.pop_front();
+            }
+            if (!batch->done) {
+                batch->done = true;
+                failed.emplace_back(std::move(batch));
+            }
+        }
+        size_t bytes = 0;
         {
             std::lock_guard<std::mutex> lck(logsLock_);
             logs_.clear();
             cachingPromise_.setValue(res);
             cachingPromise_.reset();
-            bufferOverFlow_ = false;
+            logsBarrier_ = false;
+            bytes = logsBytes_;
+            logsBytes_ = 0;
+        }
+        WriteAdmission::instance().release(bytes);
+        failWaitingLogs(res);
+        for (auto& b : failed) {
+            b->promise.setValue(res);
         }
-        sendingPromise_.setValue(res);
-        replicatingLogs_ = false;
-        return false;;
+        finishBatches(failed);
+        return false;
     }
     return true;
 }
@@ -1854,6 +2198,43 @@ AppendLogResult RaftPart::isCatchedUp(const HostAddr& peer) {
     return AppendLogResult::E_INVALID_PEER;
 }
 
+std::vector<std::pair<HostAddr, int64_t>> RaftPart::replicationLags() const {
+    std::vector<std::pair<HostAddr, int64_t>> lags;
+    std::vector<std::shared_ptr<Host>> hosts;
+    LogID lastLogId;
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        if (role_ != Role::LEADER) {
+            return lags;
+        }
+        hosts = hosts_;
+        lastLogId = lastLogId_;
+    }
+    // The host is not locked with the raftLock_ held, as it is done when replicating
+    for (const auto& host : hosts) {
+        std::lock_guard<std::mutex> g(host->lock_);
+        auto accepted = std::max(host->lastLogIdAccepted_, host->followerCommittedLogId_);
+        lags.emplace_back(host->address(), std::max<int64_t>(lastLogId - accepted, 0));
+    }
+    return lags;
+}
+
+size_t RaftPart::maxAppendLogRequestsInFlight() const {
+    std::vector<std::shared_ptr<Host>> hosts;
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        if (role_ != Role::LEADER) {
+            return 0;
+        }
+        hosts = hosts_;
+    }
+    size_t maxInFlight = 0;
+    for (const auto& host : hosts) {
+        maxInFlight = std::max(maxInFlight, host->maxRequestsInFlight());
+    }
+    return maxInFlight;
+}
+
 bool RaftPart::linkCurrentWAL(const char* newPath) {
     CHECK_NOTNULL(newPath);
     std::lock_guard<std::mutex> g(raftLock_);
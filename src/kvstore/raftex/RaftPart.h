@@ -75,6 +75,7 @@ class RaftPart : public std::enable_shared_from_this<RaftPart> {
     friend class AppendLogsIterator;
     friend class Host;
     friend class SnapshotManager;
+    friend class WriteAdmission;
     FRIEND_TEST(MemberChangeTest, AddRemovePeerTest);
     FRIEND_TEST(MemberChangeTest, RemoveLeaderTest);
 
@@ -183,6 +184,16 @@ public:
      * */
     AppendLogResult isCatchedUp(const HostAddr& peer);
 
+    /**
+     * The number of logs each follower and learner falls behind, empty if not the leader
+     * */
+    std::vector<std::pair<HostAddr, int64_t>> replicationLags() const;
+
+    /**
+     * The most appendLog requests in flight at the same time to any peer, 0 if not the leader
+     * */
+    size_t maxAppendLogRequestsInFlight() const;
+
     bool linkCurrentWAL(const char* newPath);
 
     /**
@@ -265,6 +276,16 @@ protected:
     // Clean up all data about current part in storage.
     virtual void cleanup() = 0;
 
+    // Evaluate the consecutive atomic ops at the head of ops, and return the log to be
+    // appended for them, or none if all of them failed. The result of each op evaluated
+    // is pushed into results, and the ops not evaluated are left to the next log.
+    //
+    // By default the ops are evaluated one by one until one succeeds, so each log holds
+    // one atomic op. The inherited classes could evaluate several ops against the writes
+    // of the former ones and merge them into one log.
+    virtual folly::Optional<std::string> processAtomicOps(const std::vector<AtomicOp*>& ops,
+                                                          std::vector<bool>* results);
+
     // Reset the part, clean up all data and WALs.
     void reset();
 
@@ -361,11 +382,61 @@ private:
                                                   std::string log,
                                                   AtomicOp cb = nullptr);
 
-    void appendLogsInternal(AppendLogsIterator iter, TermID termId);
+    struct Batch;
+
+    // The bytes a log takes in the buffer
+    static size_t logBytes(const std::string& log);
+
+    // Whether the log could be put into the buffer without exceeding the limits of it.
+    // Pre-condition: The caller needs to hold the logsLock_
+    bool bufferHasRoom(size_t bytes) const;
+
+    // Put the log into the buffer, the bytes have been taken from WriteAdmission.
+    // Pre-condition: The caller needs to hold the logsLock_
+    folly::Future<AppendLogResult> bufferLog(ClusterID source,
+                                             LogType logType,
+                                             std::string log,
+                                             AtomicOp op,
+                                             size_t bytes);
+
+    // Move the waiting logs into the buffer in order, as long as there is room in the buffer
+    // and the budget of the host allows. woken is true when the part is woken up by
+    // WriteAdmission.
+    // Pre-condition: The caller needs to hold the logsLock_
+    void admitLogs(bool woken);
+
+    // Called by WriteAdmission when the budget is given back, and it is the turn of the part
+    void admitWaitingLogs();
+
+    // Schedule a task to fail the waiting logs exceeding the deadline
+    // Pre-condition: The caller needs to hold the logsLock_
+    void scheduleExpiration();
+
+    void expireWaitingLogs();
+
+    // Fail all waiting logs with the given result
+    void failWaitingLogs(AppendLogResult res);
+
+    // Whether the logs in the buffer could be taken as a new batch.
+    // Pre-condition: The caller needs to hold the logsLock_
+    bool canReplicate() const;
+
+    // Take the logs in the buffer and replicate them batch by batch, until the buffer is
+    // empty or there are too many batches in flight.
+    // Pre-condition: The caller has set replicatingLogs_
+    void replicateBatches();
+
+    // Call replicateBatches() if nobody is taking the logs and the window is open
+    void replicateNextBatches();
+
+    // Return nullptr and reset replicatingLogs_ if no more batch could be taken
+    std::shared_ptr<Batch> takeBatch();
+
+    void appendLogsInternal(std::shared_ptr<Batch> batch);
 
     void replicateLogs(
         folly::EventBase* eb,
-        AppendLogsIterator iter,
+        std::shared_ptr<Batch> batch,
         TermID currTerm,
         LogID lastLogId,
         LogID committedId,
@@ -375,7 +446,7 @@ private:
     void processAppendLogResponses(
         const AppendLogResponses& resps,
         folly::EventBase* eb,
-        AppendLogsIterator iter,
+        std::shared_ptr<Batch> batch,
         TermID currTerm,
         LogID lastLogId,
         LogID committedId,
@@ -385,7 +456,16 @@ private:
 
     std::vector<std::shared_ptr<Host>> followers() const;
 
-    bool checkAppendLogResult(AppendLogResult res);
+    // The last log written into the WAL in the current term, it is the last one
+    // of the batches in flight if any.
+    // Pre-condition: The caller needs to hold the raftLock_
+    std::pair<LogID, TermID> lastLogIdInWal() const;
+
+    // Remove the finished batches from the window
+    void finishBatches(const std::vector<std::shared_ptr<Batch>>& batches);
+
+    // Fail the batch, the batches in flight and the logs in the buffer if res is not SUCCEEDED
+    bool checkAppendLogResult(AppendLogResult res, std::shared_ptr<Batch> batch);
 
     void updateQuorum();
 
@@ -476,17 +556,45 @@ protected:
     std::vector<std::shared_ptr<Host>> hosts_;
     size_t quorum_{0};
 
-    // The lock is used to protect logs_ and cachingPromise_
+    // The lock is used to protect logs_, cachingPromise_, the waiting logs and the window
+    // of batches
     mutable std::mutex logsLock_;
+    // Whether someone is taking the logs in the buffer and writing them into the WAL
     std::atomic_bool replicatingLogs_{false};
-    std::atomic_bool bufferOverFlow_{false};
     PromiseSet<AppendLogResult> cachingPromise_;
     LogCache logs_;
+    // The bytes of the logs in logs_, they have been taken from WriteAdmission
+    size_t logsBytes_{0};
+    // Whether there is any atomic op or command in logs_
+    bool logsBarrier_{false};
+    // Number of the batches taken but not finished, at most FLAGS_max_inflight_batches
+    size_t inflightNum_{0};
+    // Whether the batch in flight has atomic ops or commands, it is the only one then
+    bool inflightBarrier_{false};
+
+    // A log waiting for the room in the buffer or the budget of the host
+    struct WaitingLog {
+        ClusterID                           source;
+        LogType                             logType;
+        std::string                         log;
+        AtomicOp                            op;
+        size_t                              bytes;
+        folly::Promise<AppendLogResult>     promise;
+        time::Duration                      duration;
+    };
+    // The logs are put into the buffer in the order they are appended, the ones
+    // waiting longer than FLAGS_raft_admission_timeout_ms fail with E_BUFFER_OVERFLOW
+    std::deque<WaitingLog> waitingLogs_;
+    size_t waitingBytes_{0};
+    // Whether the part is queued in WriteAdmission, waiting for the budget
+    bool admissionQueued_{false};
+    bool expirationScheduled_{false};
 
     // Partition level lock to synchronize the access of the partition
     mutable std::mutex raftLock_;
 
-    PromiseSet<AppendLogResult> sendingPromise_;
+    // The batches written into the WAL but not committed, in the order of log id
+    std::deque<std::shared_ptr<Batch>> inflightBatches_;
 
     Status status_;
     Role role_;
@@ -0,0 +1,96 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/raftex/WriteAdmission.h"
+#include "kvstore/raftex/RaftPart.h"
+
+DEFINE_uint64(raft_host_pending_bytes, 512 * 1024 * 1024,
+              "The max bytes of the logs appended but not committed of all parts on the host");
+
+namespace nebula {
+namespace raftex {
+
+WriteAdmission& WriteAdmission::instance() {
+    static WriteAdmission admission;
+    return admission;
+}
+
+WriteAdmission::WriteAdmission()
+        : waitStats_("storage", "raft_admission_wait")
+        , depthStats_("storage", "raft_admission_queue_bytes") {}
+
+bool WriteAdmission::tryAcquire(size_t bytes, bool woken, std::weak_ptr<RaftPart> part) {
+    std::lock_guard<std::mutex> g(lock_);
+    auto used = used_.load(std::memory_order_relaxed);
+    bool queued = !woken && (!parts_.empty() || waking_);
+    if (!queued && (used == 0 || used + bytes <= FLAGS_raft_host_pending_bytes)) {
+        used_.fetch_add(bytes, std::memory_order_relaxed);
+        return true;
+    }
+    parts_.emplace_back(std::move(part));
+    return false;
+}
+
+void WriteAdmission::release(size_t bytes) {
+    if (bytes == 0) {
+        return;
+    }
+    auto used = used_.fetch_sub(bytes, std::memory_order_relaxed);
+    CHECK_GE(used, bytes);
+    wakeUp();
+}
+
+void WriteAdmission::addWaitingBytes(int64_t delta) {
+    auto waiting = waiting_.fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (delta > 0) {
+        stats::Stats::addStatsValue(&depthStats_, true, waiting);
+    }
+}
+
+void WriteAdmission::wakeUp() {
+    size_t num = 0;
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        if (waking_) {
+            // The one waking up the parts will start another turn
+            released_ = true;
+            return;
+        }
+        if (parts_.empty()) {
+            return;
+        }
+        waking_ = true;
+        num = parts_.size();
+    }
+    while (true) {
+        // Only the parts waiting at the beginning of the turn are woken up, the ones still
+        // waiting after that have been queued again at the tail
+        for (; num > 0; num--) {
+            std::shared_ptr<RaftPart> part;
+            {
+                std::lock_guard<std::mutex> g(lock_);
+                if (parts_.empty()) {
+                    break;
+                }
+                part = parts_.front().lock();
+                parts_.pop_front();
+            }
+            if (part != nullptr) {
+                part->admitWaitingLogs();
+            }
+        }
+        std::lock_guard<std::mutex> g(lock_);
+        if (!released_ || parts_.empty()) {
+            waking_ = false;
+            return;
+        }
+        released_ = false;
+        num = parts_.size();
+    }
+}
+
+}  // namespace raftex
+}  // namespace nebula
@@ -0,0 +1,81 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef RAFTEX_WRITEADMISSION_H_
+#define RAFTEX_WRITEADMISSION_H_
+
+#include "common/base/Base.h"
+#include "common/stats/Stats.h"
+
+namespace nebula {
+namespace raftex {
+
+class RaftPart;
+
+/**
+ * The budget of the bytes of the logs which are appended but not finished on this host,
+ * shared by all parts.
+ *
+ * A part takes the bytes of a log before putting it into its buffer, and gives them back
+ * once the batch of the log is committed or failed. When the budget is used up, the logs
+ * wait in the queue of their part, and the waiting parts are woken up round-robin as the
+ * bytes are given back. Each part fills its buffer at most once in a turn, so a part
+ * flooded by a bulk load won't starve the others.
+ * */
+class WriteAdmission final {
+public:
+    static WriteAdmission& instance();
+
+    // Take the bytes for a log of the part. It fails if the budget is used up, or any other
+    // part is waiting for it unless the caller is the part woken up, then the part is queued
+    // and will be woken up in turn. A log is always allowed if nothing is taken, so a log
+    // larger than the whole budget could still go through.
+    bool tryAcquire(size_t bytes, bool woken, std::weak_ptr<RaftPart> part);
+
+    // Give back the bytes and wake up the waiting parts
+    void release(size_t bytes);
+
+    // The bytes of the logs waiting in the queues of all parts
+    void addWaitingBytes(int64_t delta);
+
+    // The logs waited for the given time, and are admitted or timed out
+    void addWaitTime(bool admitted, uint64_t waitInUs) {
+        stats::Stats::addStatsValue(&waitStats_, admitted, waitInUs);
+    }
+
+    size_t usedBytes() const {
+        return used_.load(std::memory_order_relaxed);
+    }
+
+    size_t waitingBytes() const {
+        return waiting_.load(std::memory_order_relaxed);
+    }
+
+private:
+    WriteAdmission();
+
+    // Wake up the parts waiting at the moment one by one
+    void wakeUp();
+
+private:
+    std::mutex                              lock_;
+    std::atomic<size_t>                     used_{0};
+    std::atomic<int64_t>                    waiting_{0};
+    std::deque<std::weak_ptr<RaftPart>>     parts_;
+    // Whether someone is waking up the parts, and whether more bytes are given back since
+    // then, both are protected by lock_
+    bool                                    waking_{false};
+    bool                                    released_{false};
+
+    // The latency is the time a log waits in the queue
+    stats::Stats                            waitStats_;
+    // The latency is the bytes waiting in all queues when a log is queued
+    stats::Stats                            depthStats_;
+};
+
+}  // namespace raftex
+}  // namespace nebula
+#endif  // RAFTEX_WRITEADMISSION_H_
@@ -9,7 +9,9 @@
 #include "common/fs/FileUtils.h"
 #include "common/thread/GenericThreadPool.h"
 #include "common/network/NetworkUtils.h"
+#include "common/time/Duration.h"
 #include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/WriteAdmission.h"
 #include "kvstore/raftex/test/RaftexTestBase.h"
 #include "kvstore/raftex/test/TestShard.h"
 #include <gtest/gtest.h>
@@ -17,6 +19,11 @@
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
 DECLARE_uint32(max_batch_size);
+DECLARE_uint32(max_inflight_batches);
+DECLARE_uint32(max_inflight_appendlog_requests);
+DECLARE_uint64(raft_part_buffer_bytes);
+DECLARE_uint64(raft_host_pending_bytes);
+DECLARE_uint32(raft_admission_timeout_ms);
 
 namespace nebula {
 namespace raftex {
@@ -135,6 +142,150 @@ TEST(LogAppend, MultiThreadAppend) {
     finishRaft(services, copies, workers, leader);
 }
 
+
+TEST(LogAppend, PipelinedAppend) {
+    fs::TempDir walRoot("/tmp/pipelined_append.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // Small batches, so there are many batches in flight
+    gflags::FlagSaver flagSaver;
+    const int numThreads = 8;
+    const int numLogs = 500;
+    FLAGS_max_batch_size = 16;
+    int total = 0;
+    for (uint32_t window : {1, 4}) {
+        FLAGS_max_inflight_batches = window;
+        FLAGS_max_inflight_appendlog_requests = window;
+        LOG(INFO) << "=====> Start appending logs with " << window << " batches in flight";
+        time::Duration duration;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back(std::thread([i, window, leader] {
+                std::vector<folly::Future<AppendLogResult>> futures;
+                for (int j = 1; j <= numLogs; ++j) {
+                    while (true) {
+                        auto fut = leader->appendAsync(
+                            0, folly::stringPrintf("Log %03d for t%d in w%u", j, i, window));
+                        if (fut.isReady() &&
+                            fut.value() == AppendLogResult::E_BUFFER_OVERFLOW) {
+                            std::this_thread::sleep_for(std::chrono::microseconds(100));
+                            continue;
+                        }
+                        futures.emplace_back(std::move(fut));
+                        break;
+                    }
+                }
+                for (auto& fut : futures) {
+                    ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(fut).get());
+                }
+            }));
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        auto elapsed = duration.elapsedInMSec();
+        LOG(INFO) << "<===== Appended " << numThreads * numLogs << " logs with " << window
+                  << " batches in flight in " << elapsed << " ms, "
+                  << numThreads * numLogs * 1000 / std::max<uint64_t>(elapsed, 1) << " logs/s";
+        total += numThreads * numLogs;
+    }
+    // The requests to the followers were pipelined with the larger window
+    EXPECT_LT(1, leader->maxAppendLogRequestsInFlight());
+
+    // Sleep a while to make sure the last log has been committed on followers
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+
+    for (auto& c : copies) {
+        ASSERT_EQ(total, c->getNumLogs());
+    }
+    for (int i = 0; i < total; ++i) {
+        folly::StringPiece msg;
+        ASSERT_TRUE(leader->getLogMsg(i, msg));
+        for (auto& c : copies) {
+            if (c != leader) {
+                folly::StringPiece log;
+                ASSERT_TRUE(c->getLogMsg(i, log));
+                ASSERT_EQ(msg, log);
+            }
+        }
+    }
+
+    finishRaft(services, copies, workers, leader);
+}
+
+
+TEST(LogAppend, AdmissionQueue) {
+    fs::TempDir walRoot("/tmp/admission_queue.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // Tiny buffer and budget, almost every log has to wait, but none of them is rejected
+    gflags::FlagSaver flagSaver;
+    const int numThreads = 8;
+    const int numLogs = 200;
+    FLAGS_max_batch_size = 4;
+    FLAGS_max_inflight_batches = 2;
+    FLAGS_raft_part_buffer_bytes = 1024;
+    FLAGS_raft_host_pending_bytes = 4096;
+    FLAGS_raft_admission_timeout_ms = 60 * 1000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(std::thread([i, leader] {
+            std::vector<folly::Future<AppendLogResult>> futures;
+            for (int j = 1; j <= numLogs; ++j) {
+                futures.emplace_back(
+                    leader->appendAsync(0, folly::stringPrintf("Log %03d for t%d", j, i)));
+            }
+            for (auto& fut : futures) {
+                ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(fut).get());
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(0, WriteAdmission::instance().waitingBytes());
+
+    // The logs of each thread are appended in order
+    std::vector<int> lastLog(numThreads, 0);
+    for (int i = 0; i < numThreads * numLogs; ++i) {
+        folly::StringPiece msg;
+        ASSERT_TRUE(leader->getLogMsg(i, msg));
+        int j = 0, t = 0;
+        ASSERT_EQ(2, sscanf(msg.str().c_str(), "Log %d for t%d", &j, &t));
+        ASSERT_EQ(lastLog[t] + 1, j);
+        lastLog[t] = j;
+    }
+
+    // Sleep a while to make sure the last log has been committed on followers
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+    for (auto& c : copies) {
+        ASSERT_EQ(numThreads * numLogs, c->getNumLogs());
+    }
+    EXPECT_EQ(0, WriteAdmission::instance().usedBytes());
+
+    finishRaft(services, copies, workers, leader);
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
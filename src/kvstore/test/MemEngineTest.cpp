@@ -0,0 +1,312 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <rocksdb/db.h>
+#include "kvstore/MemEngine.h"
+#include "kvstore/RocksEngine.h"
+#include "utils/NebulaKeyUtils.h"
+
+DECLARE_int32(mem_engine_max_delta_keys);
+
+namespace nebula {
+namespace kvstore {
+
+constexpr size_t kVIdLen = 8;
+
+using KVMap = std::map<std::string, std::string>;
+
+std::vector<KV> collect(std::unique_ptr<KVIterator> iter) {
+    std::vector<KV> result;
+    while (iter->valid()) {
+        result.emplace_back(iter->key().str(), iter->val().str());
+        iter->next();
+    }
+    return result;
+}
+
+std::vector<KV> expectPrefix(const KVMap& data, const std::string& prefix) {
+    std::vector<KV> result;
+    for (auto it = data.lower_bound(prefix);
+         it != data.end() && folly::StringPiece(it->first).startsWith(prefix);
+         ++it) {
+        result.emplace_back(it->first, it->second);
+    }
+    return result;
+}
+
+std::vector<KV> expectRange(const KVMap& data, const std::string& start, const std::string& end) {
+    std::vector<KV> result;
+    for (auto it = data.lower_bound(start); it != data.end() && it->first < end; ++it) {
+        result.emplace_back(it->first, it->second);
+    }
+    return result;
+}
+
+// Write some vertices and edges with RocksEngine, which are loaded by MemEngine later
+KVMap genGraph(const char* path) {
+    KVMap data;
+    for (PartitionID partId = 1; partId <= 3; partId++) {
+        for (int32_t i = 0; i < 10; i++) {
+            auto vId = folly::stringPrintf("v_%d", i);
+            for (TagID tagId = 1; tagId <= 2; tagId++) {
+                auto key = NebulaKeyUtils::vertexKey(kVIdLen, partId, vId, tagId, 0);
+                data.emplace(key, folly::stringPrintf("tag_%d_%d", i, tagId));
+            }
+            for (EdgeType type : {1, -1, 2}) {
+                for (int32_t j = 0; j < 5; j++) {
+                    auto dstId = folly::stringPrintf("v_%d", (i + j) % 10);
+                    auto key = NebulaKeyUtils::edgeKey(kVIdLen, partId, vId, type, j, dstId, 0);
+                    data.emplace(key, folly::stringPrintf("edge_%d_%d_%d", i, type, j));
+                }
+            }
+        }
+        data.emplace(NebulaKeyUtils::systemCommitKey(partId), "commit");
+        data.emplace(NebulaKeyUtils::systemPartKey(partId), "");
+    }
+    auto engine = std::make_unique<RocksEngine>(0, path);
+    std::vector<KV> kvs(data.begin(), data.end());
+    CHECK_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(kvs)));
+    return data;
+}
+
+
+TEST(MemEngineTest, SimpleTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_SimpleTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path(), 0);
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key", "val"));
+    std::string val;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->get("key", &val));
+    EXPECT_EQ("val", val);
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->remove("key"));
+    EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND, engine->get("key", &val));
+}
+
+
+TEST(MemEngineTest, LoadTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_LoadTest.XXXXXX");
+    auto data = genGraph(rootPath.path());
+    // Indexed by vid or not, the results should be the same
+    for (size_t vIdLen : {kVIdLen, 0UL}) {
+        auto engine = std::make_unique<MemEngine>(0, rootPath.path(), vIdLen);
+        EXPECT_EQ(3, engine->allParts().size());
+
+        auto checkPrefix = [&] (const std::string& prefix) {
+            std::unique_ptr<KVIterator> iter;
+            EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+            EXPECT_EQ(expectPrefix(data, prefix), collect(std::move(iter)));
+        };
+        for (PartitionID partId = 1; partId <= 3; partId++) {
+            checkPrefix(NebulaKeyUtils::partPrefix(partId));
+            for (int32_t i = 0; i < 11; i++) {
+                auto vId = folly::stringPrintf("v_%d", i);
+                checkPrefix(NebulaKeyUtils::vertexPrefix(kVIdLen, partId, vId));
+                checkPrefix(NebulaKeyUtils::vertexPrefix(kVIdLen, partId, vId, 1));
+                checkPrefix(NebulaKeyUtils::vertexPrefix(kVIdLen, partId, vId, 3));
+                checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, partId, vId));
+                checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, partId, vId, 1));
+                checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, partId, vId, -1));
+                checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, partId, vId, 3));
+                checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, partId, vId, 2, 3,
+                                                       folly::stringPrintf("v_%d", (i + 3) % 10)));
+            }
+        }
+        checkPrefix(NebulaKeyUtils::systemPrefix());
+        checkPrefix("");
+
+        for (const auto& kv : data) {
+            std::string val;
+            EXPECT_EQ(ResultCode::SUCCEEDED, engine->get(kv.first, &val));
+            EXPECT_EQ(kv.second, val);
+        }
+        std::string val;
+        EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND,
+                  engine->get(NebulaKeyUtils::vertexKey(kVIdLen, 1, "v_10", 1, 0), &val));
+
+        auto start = NebulaKeyUtils::vertexPrefix(kVIdLen, 1, "v_3");
+        auto end = NebulaKeyUtils::edgePrefix(kVIdLen, 2, "v_5", 2);
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED, engine->range(start, end, &iter));
+        EXPECT_EQ(expectRange(data, start, end), collect(std::move(iter)));
+    }
+}
+
+
+TEST(MemEngineTest, DeltaTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_DeltaTest.XXXXXX");
+    auto data = genGraph(rootPath.path());
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path(), kVIdLen);
+
+    // Override, add and remove some keys
+    std::vector<KV> kvs;
+    for (int32_t i = 0; i < 10; i += 2) {
+        auto vId = folly::stringPrintf("v_%d", i);
+        kvs.emplace_back(NebulaKeyUtils::vertexKey(kVIdLen, 1, vId, 1, 0), "new_tag");
+        kvs.emplace_back(NebulaKeyUtils::edgeKey(kVIdLen, 1, vId, 1, 10, vId, 0), "new_edge");
+    }
+    for (const auto& kv : kvs) {
+        data[kv.first] = kv.second;
+    }
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(kvs)));
+
+    auto removed = NebulaKeyUtils::edgeKey(kVIdLen, 1, "v_1", 1, 2, "v_3", 0);
+    data.erase(removed);
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->remove(removed));
+
+    auto start = NebulaKeyUtils::vertexPrefix(kVIdLen, 1, "v_5");
+    auto end = NebulaKeyUtils::vertexPrefix(kVIdLen, 1, "v_7");
+    data.erase(data.lower_bound(start), data.lower_bound(end));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->removeRange(start, end));
+
+    auto checkPrefix = [&] (const std::string& prefix) {
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        EXPECT_EQ(expectPrefix(data, prefix), collect(std::move(iter)));
+    };
+    checkPrefix(NebulaKeyUtils::partPrefix(1));
+    for (int32_t i = 0; i < 10; i++) {
+        auto vId = folly::stringPrintf("v_%d", i);
+        checkPrefix(NebulaKeyUtils::vertexPrefix(kVIdLen, 1, vId, 1));
+        checkPrefix(NebulaKeyUtils::edgePrefix(kVIdLen, 1, vId, 1));
+    }
+    std::string val;
+    EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND, engine->get(removed, &val));
+
+    // Iterate backward over the table and the delta
+    auto prefix = NebulaKeyUtils::partPrefix(1);
+    auto expected = expectPrefix(data, prefix);
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+    for (size_t i = 0; i + 1 < expected.size(); i++) {
+        iter->next();
+    }
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it) {
+        ASSERT_TRUE(iter->valid());
+        EXPECT_EQ(it->first, iter->key());
+        EXPECT_EQ(it->second, iter->val());
+        iter->prev();
+    }
+    EXPECT_FALSE(iter->valid());
+}
+
+
+TEST(MemEngineTest, SeekTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_SeekTest.XXXXXX");
+    auto data = genGraph(rootPath.path());
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path(), kVIdLen);
+    // Seek over the table and the delta
+    auto removed = NebulaKeyUtils::edgeKey(kVIdLen, 1, "v_1", 1, 2, "v_3", 0);
+    data.erase(removed);
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->remove(removed));
+    auto added = NebulaKeyUtils::edgeKey(kVIdLen, 1, "v_1", 1, 2, "v_4", 0);
+    data[added] = "added";
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put(added, "added"));
+
+    auto prefix = NebulaKeyUtils::edgePrefix(kVIdLen, 1, "v_1", 1);
+    auto expected = expectPrefix(data, prefix);
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+    for (const auto& target : {NebulaKeyUtils::edgePrefix(kVIdLen, 1, "v_1", 1, 2, "v_3"),
+                               NebulaKeyUtils::edgePrefix(kVIdLen, 1, "v_1", 1, 2, "v_4"),
+                               NebulaKeyUtils::edgePrefix(kVIdLen, 1, "v_1", 1, 3, ""),
+                               NebulaKeyUtils::vertexPrefix(kVIdLen, 1, "v_1"),
+                               NebulaKeyUtils::edgePrefix(kVIdLen, 1, "v_2", 1),
+                               removed,
+                               added}) {
+        auto it = std::lower_bound(expected.begin(), expected.end(), target,
+                                   [] (const KV& kv, const std::string& t) {
+                                       return kv.first < t;
+                                   });
+        iter->seek(target);
+        if (it == expected.end()) {
+            EXPECT_FALSE(iter->valid());
+        } else {
+            ASSERT_TRUE(iter->valid());
+            EXPECT_EQ(it->first, iter->key());
+        }
+
+        it = std::upper_bound(expected.begin(), expected.end(), target,
+                              [] (const std::string& t, const KV& kv) {
+                                  return t < kv.first;
+                              });
+        iter->seekForPrev(target);
+        if (it == expected.begin()) {
+            EXPECT_FALSE(iter->valid());
+        } else {
+            ASSERT_TRUE(iter->valid());
+            EXPECT_EQ(std::prev(it)->first, iter->key());
+        }
+    }
+}
+
+
+TEST(MemEngineTest, SnapshotTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_SnapshotTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path(), 0);
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key_1", "val_1"));
+    auto* snapshot = engine->getSnapshot();
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key_1", "val_2"));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key_2", "val_2"));
+
+    std::string val;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->get("key_1", &val, snapshot));
+    EXPECT_EQ("val_1", val);
+    EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND, engine->get("key_2", &val, snapshot));
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix("key", &iter, snapshot));
+    EXPECT_EQ((std::vector<KV>{{"key_1", "val_1"}}), collect(std::move(iter)));
+    engine->releaseSnapshot(snapshot);
+
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix("key", &iter));
+    EXPECT_EQ((std::vector<KV>{{"key_1", "val_2"}, {"key_2", "val_2"}}),
+              collect(std::move(iter)));
+}
+
+
+TEST(MemEngineTest, RebuildTest) {
+    FLAGS_mem_engine_max_delta_keys = 10;
+    fs::TempDir rootPath("/tmp/mem_engine_RebuildTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path(), 0);
+    for (int32_t i = 0; i < 10; i++) {
+        EXPECT_EQ(ResultCode::SUCCEEDED,
+                  engine->put(folly::stringPrintf("key_%d", i), folly::stringPrintf("val_%d", i)));
+    }
+    EXPECT_EQ(0, engine->table_->size());
+    EXPECT_EQ(10, engine->delta_->size());
+
+    // The delta is full, so the table is rebuilt
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key_10", "val_10"));
+    EXPECT_EQ(11, engine->table_->size());
+    EXPECT_EQ(0, engine->delta_->size());
+
+    // Ingest sst files also rebuild the table
+    auto file = folly::stringPrintf("%s/%s", rootPath.path(), "data.sst");
+    EXPECT_EQ(ResultCode::SUCCEEDED,
+              engine->writeSstFile(file, {{"ingest_1", "val_1"}, {"ingest_2", "val_2"}}));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->put("key_11", "val_11"));
+    EXPECT_EQ(1, engine->delta_->size());
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->ingest({file}));
+    EXPECT_EQ(14, engine->table_->size());
+    EXPECT_EQ(0, engine->delta_->size());
+    std::string val;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->get("ingest_2", &val));
+    EXPECT_EQ("val_2", val);
+    FLAGS_mem_engine_max_delta_keys = 4096;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
@@ -158,12 +158,17 @@ TEST(NebulaStoreTest, PartsTest) {
             db->addPart(5 * i + partId);
         }
         db->addPart(5 * i + 10);
+        if (i == 1) {
+            // As if the process crashed when part 2 was being moved from disk1 to disk2
+            db->addPart(2);
+        }
         auto parts = db->allParts();
         dump(parts);
     }
     // Currently, the disks hold parts as below:
     // disk1: 0, 1, 2, 10
-    // disk2: 5, 6, 7, 15
+    // disk2: 2, 5, 6, 7, 15
+    // Part 2 is loaded from disk1 only, and removed from disk2
 
     KVOptions options;
     options.dataPaths_ = std::move(paths);
@@ -433,6 +438,18 @@ TEST(NebulaStoreTest, TransLeaderTest) {
         stores.emplace_back(initNebulaStore(peers, i, rootPath.path()));
         stores.back()->init();
     }
+    // The parts which the first copy has lost the leadership of
+    std::mutex lostLock;
+    std::set<PartitionID> lostParts;
+    auto listenerId = stores[0]->addLeaderListener(
+        [&] (GraphSpaceID, PartitionID partId, bool isLeader) {
+            std::lock_guard<std::mutex> g(lostLock);
+            if (isLeader) {
+                lostParts.erase(partId);
+            } else {
+                lostParts.emplace(partId);
+            }
+        });
     sleep(FLAGS_raft_heartbeat_interval_secs);
     LOG(INFO) << "Waiting for all leaders elected!";
     int from = 0;
@@ -523,6 +540,11 @@ TEST(NebulaStoreTest, TransLeaderTest) {
         std::unordered_map<GraphSpaceID, std::vector<PartitionID>> leaderIds;
         ASSERT_EQ(1UL, stores[i]->allLeader(leaderIds));
     }
+    {
+        std::lock_guard<std::mutex> g(lostLock);
+        EXPECT_EQ((std::set<PartitionID>{1, 2}), lostParts);
+    }
+    stores[0]->removeLeaderListener(listenerId);
 }
 
 TEST(NebulaStoreTest, CheckpointTest) {
@@ -924,7 +946,263 @@ TEST(NebulaStoreTest, AtomicOpBatchTest) {
         std::sort(expected.begin(), expected.end());
         EXPECT_EQ(expected, result);
     }
+    // read-modify-write, the ops merged into one log read the writes of the former ones
+    {
+        const int32_t total = 100;
+        auto atomic = [&store] (int32_t i) -> folly::Optional<std::string> {
+            std::string val;
+            int32_t counter = 0;
+            auto code = store->get(1, 0, "counter", &val);
+            if (code == ResultCode::SUCCEEDED) {
+                counter = folly::to<int32_t>(val);
+            } else if (code != ResultCode::ERR_KEY_NOT_FOUND) {
+                return folly::none;
+            }
+            std::unique_ptr<KVIterator> iter;
+            if (store->prefix(1, 0, "item_", &iter) != ResultCode::SUCCEEDED) {
+                return folly::none;
+            }
+            int32_t items = 0;
+            for (; iter->valid(); iter->next()) {
+                items++;
+            }
+            EXPECT_EQ(counter, items);
+            // backward as well, the pending writes are merged with the engine lazily
+            items = 0;
+            for (iter->seekForPrev("item_999"); iter->valid(); iter->prev()) {
+                items++;
+            }
+            EXPECT_EQ(counter, items);
+            kvstore::BatchHolder batchHolder;
+            batchHolder.put(folly::stringPrintf("item_%03d", i), "");
+            batchHolder.put("counter", folly::to<std::string>(counter + 1));
+            return encodeBatchValue(batchHolder.getBatch());
+        };
+
+        std::atomic<int32_t> succeeded{0}, finished{0};
+        folly::Baton<true, std::atomic> baton;
+        for (int32_t i = 0; i < total; i++) {
+            store->asyncAtomicOp(1, 0, [atomic, i] { return atomic(i); },
+                                 [&] (ResultCode code) {
+                if (code == ResultCode::SUCCEEDED) {
+                    succeeded++;
+                }
+                if (++finished == total) {
+                    baton.post();
+                }
+            });
+        }
+        baton.wait();
+        EXPECT_EQ(total, succeeded.load());
+
+        std::string val;
+        EXPECT_EQ(ResultCode::SUCCEEDED, store->get(1, 0, "counter", &val));
+        EXPECT_EQ(folly::to<std::string>(total), val);
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED, store->prefix(1, 0, "item_", &iter));
+        int32_t items = 0;
+        for (; iter->valid(); iter->next()) {
+            items++;
+        }
+        EXPECT_EQ(total, items);
+    }
+    // the ops which don't return a batch can't be merged, they are left to the next log
+    {
+        const int32_t total = 90;
+        auto atomic = [&store] (int32_t i) -> folly::Optional<std::string> {
+            std::string val;
+            int32_t counter = 0;
+            auto code = store->get(1, 0, "batches", &val);
+            if (code == ResultCode::SUCCEEDED) {
+                counter = folly::to<int32_t>(val);
+            } else if (code != ResultCode::ERR_KEY_NOT_FOUND) {
+                return folly::none;
+            }
+            if (i % 3 == 0) {
+                return encodeMultiValues(OP_PUT,
+                                         folly::stringPrintf("single_%03d", i),
+                                         folly::to<std::string>(counter));
+            }
+            kvstore::BatchHolder batchHolder;
+            batchHolder.put("batches", folly::to<std::string>(counter + 1));
+            return encodeBatchValue(batchHolder.getBatch());
+        };
+
+        std::atomic<int32_t> succeeded{0}, finished{0};
+        folly::Baton<true, std::atomic> baton;
+        for (int32_t i = 0; i < total; i++) {
+            store->asyncAtomicOp(1, 0, [atomic, i] { return atomic(i); },
+                                 [&] (ResultCode code) {
+                EXPECT_EQ(ResultCode::SUCCEEDED, code);
+                if (code == ResultCode::SUCCEEDED) {
+                    succeeded++;
+                }
+                if (++finished == total) {
+                    baton.post();
+                }
+            });
+        }
+        baton.wait();
+        EXPECT_EQ(total, succeeded.load());
+
+        std::string val;
+        EXPECT_EQ(ResultCode::SUCCEEDED, store->get(1, 0, "batches", &val));
+        EXPECT_EQ(folly::to<std::string>(total / 3 * 2), val);
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(ResultCode::SUCCEEDED, store->prefix(1, 0, "single_", &iter));
+        int32_t singles = 0;
+        for (; iter->valid(); iter->next()) {
+            singles++;
+        }
+        EXPECT_EQ(total / 3, singles);
+    }
 }
+
+TEST(NebulaStoreTest, MovePartTest) {
+    auto ioThreadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    fs::TempDir rootPath("/tmp/nebula_store_test.XXXXXX");
+    auto initStore = [&] () {
+        auto partMan = std::make_unique<MemPartManager>();
+        // space 1 => {1, 2, 3, 4}
+        for (auto partId = 1; partId <= 4; partId++) {
+            partMan->partsMap_[1][partId] = PartHosts();
+        }
+        std::vector<std::string> paths;
+        paths.emplace_back(folly::stringPrintf("%s/disk1", rootPath.path()));
+        paths.emplace_back(folly::stringPrintf("%s/disk2", rootPath.path()));
+        KVOptions options;
+        options.dataPaths_ = std::move(paths);
+        options.partMan_ = std::move(partMan);
+        HostAddr local = {"", 0};
+        auto store = std::make_unique<NebulaStore>(std::move(options),
+                                                   ioThreadPool,
+                                                   local,
+                                                   getHandlers());
+        store->init();
+        sleep(FLAGS_raft_heartbeat_interval_secs);
+        return store;
+    };
+    auto put = [] (NebulaStore* store, int32_t start, int32_t end) {
+        std::vector<KV> data;
+        for (auto i = start; i < end; i++) {
+            data.emplace_back(NebulaKeyUtils::kvKey(1, folly::stringPrintf("key_%03d", i)),
+                              folly::stringPrintf("val_%d", i));
+        }
+        folly::Baton<true, std::atomic> baton;
+        store->asyncMultiPut(1, 1, std::move(data), [&] (ResultCode code) {
+            EXPECT_EQ(ResultCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    };
+    auto check = [] (NebulaStore* store, int32_t expected) {
+        std::unique_ptr<KVIterator> iter;
+        auto prefix = NebulaKeyUtils::kvKey(1, "key_");
+        ASSERT_EQ(ResultCode::SUCCEEDED, store->prefix(1, 1, prefix, &iter));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            EXPECT_EQ(NebulaKeyUtils::kvKey(1, folly::stringPrintf("key_%03d", num)),
+                      iter->key());
+            EXPECT_EQ(folly::stringPrintf("val_%d", num), iter->val());
+            num++;
+        }
+        EXPECT_EQ(expected, num);
+    };
+
+    auto store = initStore();
+    put(store.get(), 0, 100);
+    auto* src = store->spaces_[1]->parts_[1]->engine();
+    auto from = store->dataPathIndex(1, src);
+    ASSERT_GE(from, 0);
+    int32_t to = 1 - from;
+    auto* dst = store->spaces_[1]->engines_[to].get();
+    auto srcParts = src->totalPartsNum();
+    auto dstParts = dst->totalPartsNum();
+
+    EXPECT_EQ(ResultCode::ERR_INVALID_ARGUMENT, store->movePart(1, 1, 2));
+    EXPECT_EQ(ResultCode::ERR_PART_NOT_FOUND, store->movePart(1, 5, to));
+    EXPECT_EQ(ResultCode::ERR_SPACE_NOT_FOUND, store->movePart(2, 1, to));
+    // Moving to the current data path is a no-op
+    EXPECT_EQ(ResultCode::SUCCEEDED, store->movePart(1, 1, from));
+
+    LOG(INFO) << "Move part 1 from data path " << from << " to " << to;
+    ASSERT_EQ(ResultCode::SUCCEEDED, store->movePart(1, 1, to));
+    EXPECT_EQ(dst, store->spaces_[1]->parts_[1]->engine());
+    EXPECT_EQ(srcParts - 1, src->totalPartsNum());
+    EXPECT_EQ(dstParts + 1, dst->totalPartsNum());
+    {
+        // Nothing is left on the old engine
+        std::unique_ptr<KVIterator> iter;
+        ASSERT_EQ(ResultCode::SUCCEEDED, src->prefix(NebulaKeyUtils::partPrefix(1), &iter));
+        EXPECT_FALSE(iter->valid());
+        std::string val;
+        EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND,
+                  src->get(NebulaKeyUtils::systemCommitKey(1), &val));
+    }
+
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+    check(store.get(), 100);
+    put(store.get(), 100, 200);
+    check(store.get(), 200);
+
+    LOG(INFO) << "Restart the store, the part should be loaded from the new data path";
+    store.reset();
+    store = initStore();
+    EXPECT_EQ(to, store->dataPathIndex(1, store->spaces_[1]->parts_[1]->engine()));
+    check(store.get(), 200);
+}
+
+TEST(NebulaStoreTest, BalanceDataPathsTest) {
+    auto partMan = std::make_unique<MemPartManager>();
+    auto ioThreadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    // space 1 => {1, 2, 3, 4}
+    for (auto partId = 1; partId <= 4; partId++) {
+        partMan->partsMap_[1][partId] = PartHosts();
+    }
+    fs::TempDir rootPath("/tmp/nebula_store_test.XXXXXX");
+    std::vector<std::string> paths;
+    paths.emplace_back(folly::stringPrintf("%s/disk1", rootPath.path()));
+    paths.emplace_back(folly::stringPrintf("%s/disk2", rootPath.path()));
+    KVOptions options;
+    options.dataPaths_ = std::move(paths);
+    options.partMan_ = std::move(partMan);
+    HostAddr local = {"", 0};
+    auto store = std::make_unique<NebulaStore>(std::move(options),
+                                               ioThreadPool,
+                                               local,
+                                               getHandlers());
+    store->init();
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+
+    auto& engines = store->spaces_[1]->engines_;
+    ASSERT_EQ(2, engines[0]->totalPartsNum());
+    ASSERT_EQ(2, engines[1]->totalPartsNum());
+    // Only write the parts on the first data path
+    for (auto partId : engines[0]->allParts()) {
+        std::vector<KV> data;
+        for (auto i = 0; i < 1000; i++) {
+            data.emplace_back(NebulaKeyUtils::kvKey(partId, folly::stringPrintf("key_%d", i)),
+                              std::string(1024, 'v'));
+        }
+        folly::Baton<true, std::atomic> baton;
+        store->asyncMultiPut(1, partId, std::move(data), [&] (ResultCode code) {
+            EXPECT_EQ(ResultCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    ASSERT_EQ(ResultCode::SUCCEEDED, store->flush(1));
+
+    ASSERT_EQ(ResultCode::SUCCEEDED, store->balanceDataPaths());
+    EXPECT_EQ(1, engines[0]->totalPartsNum());
+    EXPECT_EQ(3, engines[1]->totalPartsNum());
+
+    // Balanced now, nothing to move
+    ASSERT_EQ(ResultCode::SUCCEEDED, store->balanceDataPaths());
+    EXPECT_EQ(1, engines[0]->totalPartsNum());
+    EXPECT_EQ(3, engines[1]->totalPartsNum());
+}
+
 }  // namespace kvstore
 }  // namespace nebula
 
@@ -113,6 +113,57 @@ TEST(RocksEngineTest, PrefixTest) {
 }
 
 
+TEST(RocksEngineTest, SeekTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_SeekTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10;  i++) {
+        data.emplace_back(folly::stringPrintf("a_%d", i), folly::stringPrintf("val_%d", i));
+        data.emplace_back(folly::stringPrintf("b_%d", i), folly::stringPrintf("val_%d", i));
+        data.emplace_back(folly::stringPrintf("c_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(data)));
+
+    auto checkSeek = [] (KVIterator* iter,
+                         const std::string& target,
+                         bool forPrev,
+                         const std::string& expected) {
+        if (forPrev) {
+            iter->seekForPrev(target);
+        } else {
+            iter->seek(target);
+        }
+        if (expected.empty()) {
+            EXPECT_FALSE(iter->valid());
+        } else {
+            ASSERT_TRUE(iter->valid());
+            EXPECT_EQ(expected, iter->key());
+        }
+    };
+
+    std::string prefix = "b";
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->prefix(prefix, &iter));
+    checkSeek(iter.get(), "b_5", false, "b_5");
+    checkSeek(iter.get(), "b_55", false, "b_6");
+    checkSeek(iter.get(), "a_5", false, "b_0");
+    checkSeek(iter.get(), "b_99", false, "");
+    checkSeek(iter.get(), "b_5", true, "b_5");
+    checkSeek(iter.get(), "b_55", true, "b_5");
+    checkSeek(iter.get(), "c_5", true, "b_9");
+    checkSeek(iter.get(), "a_5", true, "");
+
+    std::string start = "a_5", end = "b_5";
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->range(start, end, &iter));
+    checkSeek(iter.get(), "a_7", false, "a_7");
+    checkSeek(iter.get(), "a_0", false, "a_5");
+    checkSeek(iter.get(), "b_5", false, "");
+    checkSeek(iter.get(), "b_1", true, "b_1");
+    checkSeek(iter.get(), "c_0", true, "b_4");
+    checkSeek(iter.get(), "a_0", true, "");
+}
+
+
 TEST(RocksEngineTest, RemoveTest) {
     fs::TempDir rootPath("/tmp/rocksdb_engine_RemoveTest.XXXXXX");
     auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
@@ -198,6 +249,28 @@ TEST(RocksEngineTest, CompactTest) {
     EXPECT_EQ(ResultCode::SUCCEEDED, engine->compact());
 }
 
+TEST(RocksEngineTest, CompactRangeTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_CompactRangeTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10000; i++) {
+        data.emplace_back(folly::stringPrintf("part1_key_%05d", i), std::string(100, 'v'));
+        data.emplace_back(folly::stringPrintf("part2_key_%05d", i), std::string(100, 'v'));
+    }
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->flush());
+    EXPECT_LT(0, engine->approximateSize("part1_", "part1`"));
+
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->removeRange("part1_", "part1`"));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->compactRange("part1_", "part1`"));
+    // The deleted keys of part1 are dropped, and part2 is kept
+    EXPECT_EQ(0, engine->approximateSize("part1_", "part1`"));
+    EXPECT_LT(0, engine->approximateSize("part2_", "part2`"));
+    std::string val;
+    EXPECT_EQ(ResultCode::ERR_KEY_NOT_FOUND, engine->get("part1_key_00001", &val));
+    EXPECT_EQ(ResultCode::SUCCEEDED, engine->get("part2_key_00001", &val));
+}
+
 TEST(RocksEngineTest, IngestTest) {
     rocksdb::Options options;
     rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
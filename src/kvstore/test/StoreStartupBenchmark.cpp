@@ -0,0 +1,135 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/fs/FileUtils.h"
+#include "common/meta/Common.h"
+#include <folly/Benchmark.h>
+#include <thrift/lib/cpp/concurrency/ThreadManager.h>
+#include "kvstore/NebulaStore.h"
+#include "kvstore/PartManager.h"
+#include "kvstore/RocksEngine.h"
+#include "kvstore/LogEncoder.h"
+#include "kvstore/wal/FileBasedWal.h"
+
+DEFINE_int32(logs_per_part, 20000, "Number of logs in the wal of each part");
+DEFINE_int32(log_size, 256, "Size of the value of each log");
+
+DECLARE_int64(wal_file_size);
+DECLARE_int32(num_load_part_threads);
+
+using nebula::meta::PartHosts;
+
+namespace nebula {
+namespace kvstore {
+
+std::shared_ptr<apache::thrift::concurrency::PriorityThreadManager>
+getHandlers() {
+    auto handlersPool
+        = apache::thrift::concurrency::PriorityThreadManager::newPriorityThreadManager(
+                                 1, true /*stats*/);
+    handlersPool->setNamePrefix("executor");
+    handlersPool->start();
+    return handlersPool;
+}
+
+// Prepare the parts of space 1 on one data path, each part has a wal of
+// logs_per_part logs, which spans several wal files
+void prepareParts(const std::string& path, int32_t numParts, bool withIndex) {
+    auto dataRoot = folly::stringPrintf("%s/nebula/1", path.c_str());
+    auto engine = std::make_unique<RocksEngine>(1, path);
+    std::string val(FLAGS_log_size, 'v');
+    wal::FileBasedWalPolicy policy;
+    policy.fileSize = FLAGS_wal_file_size;
+    for (PartitionID partId = 1; partId <= numParts; partId++) {
+        engine->addPart(partId);
+        auto walPath = folly::stringPrintf("%s/wal/%d", dataRoot.c_str(), partId);
+        auto wal = wal::FileBasedWal::getWal(walPath,
+                                             folly::stringPrintf("part %d", partId),
+                                             policy,
+                                             [] (LogID, TermID, ClusterID, const std::string&) {
+                                                 return true;
+                                             });
+        for (int32_t i = 1; i <= FLAGS_logs_per_part; i++) {
+            std::vector<KV> kvs;
+            kvs.emplace_back(folly::stringPrintf("key_%d_%d", partId, i), val);
+            auto log = encodeMultiValues(OP_MULTI_PUT, kvs);
+            CHECK(wal->appendLog(i, 1, 0, std::move(log)));
+        }
+    }
+    if (!withIndex) {
+        for (PartitionID partId = 1; partId <= numParts; partId++) {
+            auto walPath = folly::stringPrintf("%s/wal/%d", dataRoot.c_str(), partId);
+            auto files = fs::FileUtils::listAllFilesInDir(walPath.c_str(), true, "*.idx");
+            for (auto& file : files) {
+                CHECK(fs::FileUtils::remove(file.c_str()));
+            }
+        }
+    }
+}
+
+void loadStore(uint32_t iters, int32_t numParts, bool withIndex, int32_t threads) {
+    for (uint32_t n = 0; n < iters; n++) {
+        std::unique_ptr<fs::TempDir> rootPath;
+        std::unique_ptr<NebulaStore> store;
+        BENCHMARK_SUSPEND {
+            rootPath = std::make_unique<fs::TempDir>("/tmp/store_startup_bm.XXXXXX");
+            auto path = folly::stringPrintf("%s/disk1", rootPath->path());
+            prepareParts(path, numParts, withIndex);
+
+            auto partMan = std::make_unique<MemPartManager>();
+            for (PartitionID partId = 1; partId <= numParts; partId++) {
+                partMan->partsMap_[1][partId] = PartHosts();
+            }
+            KVOptions options;
+            options.dataPaths_ = {path};
+            options.partMan_ = std::move(partMan);
+            HostAddr local = {"", 0};
+            store = std::make_unique<NebulaStore>(
+                std::move(options),
+                std::make_shared<folly::IOThreadPoolExecutor>(4),
+                local,
+                getHandlers());
+            FLAGS_num_load_part_threads = threads;
+        }
+
+        CHECK(store->init());
+
+        BENCHMARK_SUSPEND {
+            store.reset();
+            rootPath.reset();
+        }
+    }
+}
+
+BENCHMARK_NAMED_PARAM(loadStore, 10_parts_no_index_serial, 10, false, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 10_parts_no_index, 10, false, 0)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 10_parts, 10, true, 0)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(loadStore, 100_parts_no_index_serial, 100, false, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 100_parts_no_index, 100, false, 0)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 100_parts, 100, true, 0)
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(loadStore, 600_parts_no_index_serial, 600, false, 1)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 600_parts_no_index, 600, false, 0)
+BENCHMARK_RELATIVE_NAMED_PARAM(loadStore, 600_parts, 600, true, 0)
+
+}  // namespace kvstore
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    // Small wal files, so that the wal of each part spans several files
+    FLAGS_wal_file_size = 1024 * 1024;
+    folly::runBenchmarks();
+    return 0;
+}
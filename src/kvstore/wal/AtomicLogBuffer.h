@@ -207,6 +207,15 @@ public:
         return std::shared_ptr<AtomicLogBuffer>(new AtomicLogBuffer(capacity));
     }
 
+    // The bytes of the records in the buffer
+    int32_t size() const {
+        return size_.load(std::memory_order_relaxed);
+    }
+
+    int32_t capacity() const {
+        return capacity_;
+    }
+
     /**
      * Users should ensure there are no readers when releasing it.
      * */
@@ -6,9 +6,13 @@
 
 #include "common/base/Base.h"
 #include "common/fs/FileUtils.h"
+#include "common/time/Duration.h"
 #include "common/time/WallClock.h"
 #include "kvstore/wal/FileBasedWal.h"
 #include "kvstore/wal/WalFileIterator.h"
+#include "kvstore/wal/WalFileReader.h"
+#include "utils/Metrics.h"
+#include <folly/hash/Checksum.h>
 #include <utime.h>
 
 namespace nebula {
@@ -16,6 +20,27 @@ namespace wal {
 
 using nebula::fs::FileUtils;
 
+namespace {
+
+constexpr int32_t kIndexMagic = 0x5857494e;  // "NIWX"
+constexpr int32_t kIndexVersion = 1;
+constexpr size_t kScanBufferSize = 4 * 1024 * 1024;
+constexpr size_t kLogHeadSize = WalFileReader::kLogHeadSize;
+
+// The latency of writing a log into the file, it is not synced
+metrics::Histogram* appendLatency() {
+    static auto* histo = metrics::Metrics::instance()->histogram("wal_append_latency_us");
+    return histo;
+}
+
+// The latency of syncing a file, when it is rolled over
+metrics::Histogram* fsyncLatency() {
+    static auto* histo = metrics::Metrics::instance()->histogram("wal_fsync_latency_us");
+    return histo;
+}
+
+}  // namespace
+
 /**********************************************
  *
  * Implementation of FileBasedWal
@@ -62,6 +87,8 @@ FileBasedWal::FileBasedWal(const folly::StringPiece dir,
         currFd_ = open(info->path(), O_WRONLY | O_APPEND);
         currInfo_ = info;
         CHECK_GE(currFd_, 0);
+        // The last file will be appended again, it is not sealed any more
+        unlink(indexPath(info->path()).c_str());
     }
 }
 
@@ -118,6 +145,12 @@ void FileBasedWal::scanAllWalFiles() {
             continue;
         }
 
+        if (loadIndex(info)) {
+            // A sealed file, nothing need to be read from it
+            VLOG(2) << "Loaded the index of the wal file \"" << fn << "\"";
+            continue;
+        }
+
         // Open the file
         int32_t fd = open(info->path(), O_RDONLY);
         if (fd < 0) {
@@ -243,8 +276,13 @@ void FileBasedWal::scanAllWalFiles() {
         // Try to scan last wal, if it is invalid or empty, scan the privous one
         scanLastWal(it->second, it->second->firstId());
         if (it->second->lastId() <= 0) {
-            unlink(it->second->path());
+            removeFile(it->second);
             walFiles_.erase(it->first);
+            if (!walFiles_.empty()) {
+                // The previous one will be appended, so scan it as well
+                auto prev = walFiles_.rbegin()->second;
+                scanLastWal(prev, prev->firstId());
+            }
         }
     }
 
@@ -269,7 +307,7 @@ void FileBasedWal::scanAllWalFiles() {
             while (it->second->firstId() < logIdAfterLastGap) {
                 LOG(INFO) << "Removing the wal file \""
                           << it->second->path() << "\"";
-                unlink(it->second->path());
+                removeFile(it->second);
                 it = walFiles_.erase(it);
             }
         }
@@ -284,7 +322,9 @@ void FileBasedWal::closeCurrFile() {
         return;
     }
 
+    time::Duration duration;
     CHECK_EQ(fsync(currFd_), 0) << strerror(errno);
+    fsyncLatency()->addValue(duration.elapsedInUSec());
     // Close the file
     CHECK_EQ(close(currFd_), 0) << strerror(errno);
     currFd_ = -1;
@@ -337,7 +377,8 @@ void FileBasedWal::rollbackInFile(WalFileInfoPtr info, LogID logId) {
                    << strerror(errno);
     }
 
-    size_t pos = 0;
+    // Start from the closest indexed log
+    size_t pos = info->seek(logId).second;
     LogID id = 0;
     TermID term = 0;
     while (true) {
@@ -396,6 +437,10 @@ void FileBasedWal::rollbackInFile(WalFileInfoPtr info, LogID logId) {
     info->setLastId(id);
     info->setLastTerm(term);
     close(fd);
+
+    // The next log will be written into a new file, so the file is sealed now
+    info->truncateIndex(id);
+    writeIndex(info);
 }
 
 
@@ -408,6 +453,9 @@ void FileBasedWal::scanLastWal(WalFileInfoPtr info, LogID firstId) {
                    << strerror(errno);
     }
 
+    WalFileReader::sequential(fd);
+    WalFileReader reader(fd, kScanBufferSize);
+    std::vector<int64_t> offsets;
     LogID curLogId = firstId;
     size_t pos = 0;
     LogID id = 0;
@@ -415,33 +463,30 @@ void FileBasedWal::scanLastWal(WalFileInfoPtr info, LogID firstId) {
     int32_t head = 0;
     int32_t foot = 0;
     while (true) {
-        // Read the log Id
-        if (pread(fd, &id, sizeof(LogID), pos) != sizeof(LogID)) {
+        const char* data = reader.read(pos, kLogHeadSize);
+        if (data == nullptr) {
             break;
         }
-
+        // Read the log Id
+        memcpy(&id, data, sizeof(LogID));
         if (id != curLogId) {
             LOG(ERROR) << "LogId is not consistent" << id << " " << curLogId;
             break;
         }
 
-        // Read the term Id
-        if (pread(fd, &term, sizeof(TermID), pos + sizeof(LogID)) != sizeof(TermID)) {
+        // Read the term Id and the message length
+        memcpy(&term, data + sizeof(LogID), sizeof(TermID));
+        memcpy(&head, data + sizeof(LogID) + sizeof(TermID), sizeof(int32_t));
+        if (head < 0) {
+            LOG(ERROR) << "Invalid message size " << head;
             break;
         }
 
-        // Read the message length
-        if (pread(fd, &head, sizeof(int32_t), pos + sizeof(LogID) + sizeof(TermID))
-                != sizeof(int32_t)) {
+        data = reader.read(pos + kLogHeadSize + head, sizeof(int32_t));
+        if (data == nullptr) {
             break;
         }
-
-        if (pread(fd, &foot, sizeof(int32_t),
-                  pos + sizeof(LogID) + sizeof(TermID) + sizeof(int32_t) + sizeof(ClusterID) + head)
-                != sizeof(int32_t)) {
-            break;
-        }
-
+        memcpy(&foot, data, sizeof(int32_t));
         if (head != foot) {
             LOG(ERROR) << "Message size doen't match: " << head << " != " << foot;
             break;
@@ -449,17 +494,18 @@ void FileBasedWal::scanLastWal(WalFileInfoPtr info, LogID firstId) {
 
         info->setLastTerm(term);
         info->setLastId(id);
+        if ((id - firstId) % WalFileInfo::kIndexInterval == 0) {
+            offsets.emplace_back(pos);
+        }
 
         // Move to the next log
-        pos += sizeof(LogID)
-               + sizeof(TermID)
-               + sizeof(ClusterID)
-               + sizeof(int32_t)
+        pos += kLogHeadSize
                + head
                + sizeof(int32_t);
 
         ++curLogId;
     }
+    info->setOffsets(std::move(offsets));
 
     if (0 < pos && pos < FileUtils::fileSize(path)) {
         LOG(WARNING) << "Invalid wal " << path << ", truncate from offset " << pos;
@@ -474,6 +520,129 @@ void FileBasedWal::scanLastWal(WalFileInfoPtr info, LogID firstId) {
     close(fd);
 }
 
+
+// static
+std::string FileBasedWal::indexPath(const char* walPath) {
+    folly::StringPiece path(walPath);
+    CHECK(path.endsWith(".wal")) << path;
+    return folly::to<std::string>(path.subpiece(0, path.size() - 4), ".idx");
+}
+
+
+void FileBasedWal::writeIndex(WalFileInfoPtr info) {
+    auto offsets = info->offsets();
+    int64_t size = info->size();
+    LogID firstId = info->firstId();
+    LogID lastId = info->lastId();
+    TermID lastTerm = info->lastTerm();
+    int32_t count = offsets.size();
+
+    std::string buf;
+    buf.reserve(sizeof(int32_t) * 4 + sizeof(LogID) * 2 + sizeof(TermID) + sizeof(int64_t)
+                + sizeof(int64_t) * count + sizeof(uint32_t));
+    buf.append(reinterpret_cast<const char*>(&kIndexMagic), sizeof(int32_t));
+    buf.append(reinterpret_cast<const char*>(&kIndexVersion), sizeof(int32_t));
+    buf.append(reinterpret_cast<char*>(&firstId), sizeof(LogID));
+    buf.append(reinterpret_cast<char*>(&lastId), sizeof(LogID));
+    buf.append(reinterpret_cast<char*>(&lastTerm), sizeof(TermID));
+    buf.append(reinterpret_cast<char*>(&size), sizeof(int64_t));
+    buf.append(reinterpret_cast<char*>(&count), sizeof(int32_t));
+    buf.append(reinterpret_cast<char*>(offsets.data()), sizeof(int64_t) * count);
+    uint32_t crc = folly::crc32c(reinterpret_cast<const uint8_t*>(buf.data()), buf.size());
+    buf.append(reinterpret_cast<char*>(&crc), sizeof(uint32_t));
+
+    // Write to a temp file and rename it, so a half written index is never seen. The
+    // index is only a hint, it will be rebuilt from the wal file if it is lost.
+    auto path = indexPath(info->path());
+    auto tmpPath = path + ".tmp";
+    int32_t fd = open(tmpPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG(WARNING) << idStr_ << "Failed to create the wal index \"" << tmpPath
+                     << "\" (errno: " << errno << "): " << strerror(errno);
+        return;
+    }
+    bool ok = write(fd, buf.data(), buf.size()) == static_cast<ssize_t>(buf.size());
+    close(fd);
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG(WARNING) << idStr_ << "Failed to write the wal index \"" << path
+                     << "\" (errno: " << errno << "): " << strerror(errno);
+        unlink(tmpPath.c_str());
+        return;
+    }
+    VLOG(1) << idStr_ << "Sealed the wal file " << info->path() << ", last log id "
+            << lastId << ", " << count << " offsets indexed";
+}
+
+
+bool FileBasedWal::loadIndex(WalFileInfoPtr info) {
+    auto path = indexPath(info->path());
+    int32_t fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    std::string buf;
+    buf.resize(FileUtils::fileSize(path.c_str()));
+    auto n = pread(fd, &buf[0], buf.size(), 0);
+    close(fd);
+
+    size_t fixedSize = sizeof(int32_t) * 2 + sizeof(LogID) * 2 + sizeof(TermID)
+                       + sizeof(int64_t) + sizeof(int32_t);
+    if (n != static_cast<ssize_t>(buf.size()) || buf.size() < fixedSize + sizeof(uint32_t)) {
+        LOG(WARNING) << "Invalid wal index \"" << path << "\"";
+        return false;
+    }
+    uint32_t crc;
+    memcpy(&crc, buf.data() + buf.size() - sizeof(uint32_t), sizeof(uint32_t));
+    if (crc != folly::crc32c(reinterpret_cast<const uint8_t*>(buf.data()),
+                             buf.size() - sizeof(uint32_t))) {
+        LOG(WARNING) << "The checksum of wal index \"" << path << "\" does not match";
+        return false;
+    }
+
+    const char* data = buf.data();
+    int32_t magic, version, count;
+    LogID firstId, lastId;
+    TermID lastTerm;
+    int64_t size;
+    memcpy(&magic, data, sizeof(int32_t));
+    data += sizeof(int32_t);
+    memcpy(&version, data, sizeof(int32_t));
+    data += sizeof(int32_t);
+    memcpy(&firstId, data, sizeof(LogID));
+    data += sizeof(LogID);
+    memcpy(&lastId, data, sizeof(LogID));
+    data += sizeof(LogID);
+    memcpy(&lastTerm, data, sizeof(TermID));
+    data += sizeof(TermID);
+    memcpy(&size, data, sizeof(int64_t));
+    data += sizeof(int64_t);
+    memcpy(&count, data, sizeof(int32_t));
+    data += sizeof(int32_t);
+    if (magic != kIndexMagic || version != kIndexVersion || count < 0 ||
+        buf.size() != fixedSize + sizeof(int64_t) * count + sizeof(uint32_t)) {
+        LOG(WARNING) << "Invalid wal index \"" << path << "\"";
+        return false;
+    }
+    if (firstId != info->firstId() || size != static_cast<int64_t>(info->size())) {
+        // The wal file has been changed after it was sealed
+        LOG(WARNING) << "The wal index \"" << path << "\" does not match the wal file";
+        return false;
+    }
+
+    std::vector<int64_t> offsets(count);
+    memcpy(offsets.data(), data, sizeof(int64_t) * count);
+    info->setLastId(lastId);
+    info->setLastTerm(lastTerm);
+    info->setOffsets(std::move(offsets));
+    return true;
+}
+
+
+void FileBasedWal::removeFile(WalFileInfoPtr info) {
+    unlink(info->path());
+    unlink(indexPath(info->path()).c_str());
+}
+
 bool FileBasedWal::appendLogInternal(LogID id,
                                      TermID term,
                                      ClusterID cluster,
@@ -515,13 +684,18 @@ bool FileBasedWal::appendLogInternal(LogID id,
         prepareNewFile(id);
     } else if (currInfo_->size() + strBuf.size() > maxFileSize_) {
         // Need to roll over
+        auto sealed = currInfo_;
         closeCurrFile();
+        writeIndex(sealed);
 
         std::lock_guard<std::mutex> g(walFilesMutex_);
         prepareNewFile(id);
     }
+    currInfo_->addOffset(id, currInfo_->size());
 
+    time::Duration duration;
     ssize_t bytesWritten = write(currFd_, strBuf.data(), strBuf.size());
+    appendLatency()->addValue(duration.elapsedInUSec());
     if (bytesWritten != (ssize_t)strBuf.size()) {
         LOG(FATAL) << idStr_ << "bytesWritten:" << bytesWritten << ", expected:" << strBuf.size()
                    << ", error:" << strerror(errno);
@@ -580,7 +754,12 @@ std::unique_ptr<LogIterator> FileBasedWal::iterator(LogID firstLogId,
 }
 
 bool FileBasedWal::linkCurrentWAL(const char* newPath) {
+    // The next log will be written into a new file
+    auto sealed = currInfo_;
     closeCurrFile();
+    if (sealed != nullptr) {
+        writeIndex(sealed);
+    }
     std::lock_guard<std::mutex> g(walFilesMutex_);
     if (walFiles_.empty()) {
         LOG(INFO) << idStr_ << "No wal files found, skip link";
@@ -634,7 +813,7 @@ bool FileBasedWal::rollbackToLog(LogID id) {
             while (it != walFiles_.end()) {
                 // Need to remove the file
                 VLOG(1) << "Removing file " << it->second->path();
-                unlink(it->second->path());
+                removeFile(it->second);
                 it = walFiles_.erase(it);
             }
         }
@@ -669,12 +848,13 @@ bool FileBasedWal::reset() {
         std::lock_guard<std::mutex> g(walFilesMutex_);
         walFiles_.clear();
     }
-    std::vector<std::string> files =
-        FileUtils::listAllFilesInDir(dir_.c_str(), false, "*.wal");
-    for (auto& fn : files) {
-        auto absFn = FileUtils::joinPath(dir_, fn);
-        LOG(INFO) << "Removing " << absFn;
-        unlink(absFn.c_str());
+    for (auto* pattern : {"*.wal", "*.idx"}) {
+        auto files = FileUtils::listAllFilesInDir(dir_.c_str(), false, pattern);
+        for (auto& fn : files) {
+            auto absFn = FileUtils::joinPath(dir_, fn);
+            LOG(INFO) << "Removing " << absFn;
+            unlink(absFn.c_str());
+        }
     }
     lastLogId_ = firstLogId_ = 0;
     return true;
@@ -696,7 +876,7 @@ void FileBasedWal::cleanWAL(int32_t ttl) {
         if (index++ < size - 1 &&  (now - it->second->mtime() > walTTL)) {
             VLOG(1) << "Clean wals, Remove " << it->second->path() << ", now: " << now
                     << ", mtime: " << it->second->mtime();
-            unlink(it->second->path());
+            removeFile(it->second);
             it = walFiles_.erase(it);
             count++;
         } else {
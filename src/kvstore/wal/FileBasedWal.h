@@ -33,6 +33,10 @@ struct FileBasedWalPolicy {
     // Number of buffers allowed. When the number of buffers reach this
     // number, appendLogs() will be blocked until some buffers are flushed
     size_t numBuffers = 2;
+
+    // Max size of the read-ahead buffer used when reading the logs from the
+    // wal files, e.g. a follower is catching up (in byte)
+    size_t readBufferSize = 4 * 1024L * 1024L;
 };
 
 
@@ -44,6 +48,7 @@ class FileBasedWal final : public Wal
     FRIEND_TEST(FileBasedWal, TTLTest);
     FRIEND_TEST(FileBasedWal, CheckLastWalTest);
     FRIEND_TEST(FileBasedWal, LinkTest);
+    FRIEND_TEST(FileBasedWal, SealedIndexTest);
     FRIEND_TEST(WalFileIter, MultiFilesReadTest);
     friend class FileBasedWalIterator;
     friend class WalFileIterator;
@@ -80,6 +85,11 @@ public:
         return lastLogTerm_;
     }
 
+    // Return the bytes of the latest logs kept in memory
+    int32_t bufferSize() const {
+        return logBuffer_->size();
+    }
+
     // Append one log messages to the WAL
     // This method **IS NOT** thread-safe
     // we **DO NOT** expect multiple threads will append logs simultaneously
@@ -140,6 +150,18 @@ private:
 
     void scanLastWal(WalFileInfoPtr info, LogID firstId);
 
+    // When a wal file is sealed, a sidecar index "<first id in the file>.idx" is
+    // written next to it, which records the last log id and term, the file size
+    // and the offset of every WalFileInfo::kIndexInterval logs. So the sealed
+    // files need not be read when the wal is loaded.
+    static std::string indexPath(const char* walPath);
+    void writeIndex(WalFileInfoPtr info);
+    // Return false if the index does not exist or does not match the wal file
+    bool loadIndex(WalFileInfoPtr info);
+
+    // Remove the wal file as well as its index
+    void removeFile(WalFileInfoPtr info);
+
     // Close down the current wal file
     void closeCurrFile();
     // Prepare a new wal file starting from the given log id
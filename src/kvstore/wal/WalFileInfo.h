@@ -17,6 +17,9 @@ namespace wal {
 
 class WalFileInfo final {
 public:
+    // One offset is indexed every kIndexInterval logs
+    static constexpr int64_t kIndexInterval = 64;
+
     WalFileInfo(std::string path, LogID firstId)
         : fullpath_(std::move(path))
         , firstLogId_(firstId)
@@ -61,6 +64,46 @@ public:
         size_ = size;
     }
 
+    // Record the offset of the log, must be called in the order of log id
+    void addOffset(LogID id, int64_t pos) {
+        if ((id - firstLogId_) % kIndexInterval == 0) {
+            std::lock_guard<std::mutex> g(indexLock_);
+            // Only append to a complete index, a partial one is still valid
+            if (offsets_.size() == static_cast<size_t>((id - firstLogId_) / kIndexInterval)) {
+                offsets_.emplace_back(pos);
+            }
+        }
+    }
+
+    // Return the id and offset of the closest indexed log before or at the given id
+    std::pair<LogID, int64_t> seek(LogID id) const {
+        std::lock_guard<std::mutex> g(indexLock_);
+        if (id < firstLogId_ || offsets_.empty()) {
+            return std::make_pair(firstLogId_, 0);
+        }
+        size_t idx = std::min<size_t>((id - firstLogId_) / kIndexInterval, offsets_.size() - 1);
+        return std::make_pair(firstLogId_ + idx * kIndexInterval, offsets_[idx]);
+    }
+
+    // Drop the offsets of logs after the given log id
+    void truncateIndex(LogID lastId) {
+        std::lock_guard<std::mutex> g(indexLock_);
+        size_t count = lastId < firstLogId_ ? 0 : (lastId - firstLogId_) / kIndexInterval + 1;
+        if (count < offsets_.size()) {
+            offsets_.resize(count);
+        }
+    }
+
+    std::vector<int64_t> offsets() const {
+        std::lock_guard<std::mutex> g(indexLock_);
+        return offsets_;
+    }
+
+    void setOffsets(std::vector<int64_t> offsets) {
+        std::lock_guard<std::mutex> g(indexLock_);
+        offsets_ = std::move(offsets);
+    }
+
 private:
     const std::string fullpath_;
     const LogID firstLogId_;
@@ -68,6 +111,10 @@ private:
     TermID lastLogTerm_;
     time_t mtime_;
     size_t size_;
+
+    // The offset of log firstLogId_ + i * kIndexInterval
+    std::vector<int64_t> offsets_;
+    mutable std::mutex indexLock_;
 };
 
 
@@ -38,7 +38,8 @@ WalFileIterator::WalFileIterator(
     }
 
     // We need to read from the WAL files
-    wal_->accessAllWalInfo([this] (WalFileInfoPtr info) {
+    int64_t startPos = 0;
+    wal_->accessAllWalInfo([this, &startPos] (WalFileInfoPtr info) {
         int fd = open(info->path(), O_RDONLY);
         if (fd < 0) {
             LOG(ERROR) << "Failed to open wal file \""
@@ -52,6 +53,8 @@ WalFileIterator::WalFileIterator(
         idRanges_.push_front(std::make_pair(info->firstId(), info->lastId()));
 
         if (info->firstId() <= currId_) {
+            // Start from the closest indexed log
+            startPos = info->seek(currId_).second;
             // Go no further
             return false;
         } else {
@@ -77,38 +80,24 @@ WalFileIterator::WalFileIterator(
     }
 
     if (!idRanges_.empty()) {
+        openFrontFile();
         // Find the correct position in the first WAL file
-        currPos_ = 0;
+        currPos_ = startPos;
         while (true) {
+            const char* data = reader_->read(currPos_, WalFileReader::kLogHeadSize);
+            CHECK(data != nullptr) << wal_->idStr_ << "Failed to find log " << currId_
+                                   << ", currPos = " << currPos_;
             LogID logId;
-            // Read the logID
-            int fd = fds_.front();
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&logId),
-                           sizeof(LogID),
-                           currPos_),
-                     static_cast<ssize_t>(sizeof(LogID)));
-            // Read the termID
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&currTerm_),
-                           sizeof(TermID),
-                           currPos_ + sizeof(LogID)),
-                     static_cast<ssize_t>(sizeof(TermID)));
-            // Read the log length
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&currMsgLen_),
-                           sizeof(int32_t),
-                           currPos_ + sizeof(LogID) + sizeof(TermID)),
-                     static_cast<ssize_t>(sizeof(int32_t)));
+            memcpy(&logId, data, sizeof(LogID));
             if (logId == currId_) {
                 break;
             }
-            currPos_ += sizeof(LogID)
-                        + sizeof(TermID)
-                        + sizeof(int32_t) * 2
+            memcpy(&currMsgLen_, data + sizeof(LogID) + sizeof(TermID), sizeof(int32_t));
+            currPos_ += WalFileReader::kLogHeadSize
                         + currMsgLen_
-                        + sizeof(ClusterID);
+                        + sizeof(int32_t);
         }
+        readCurrLog();
     }
 }
 
@@ -142,42 +131,21 @@ LogIterator& WalFileIterator::operator++() {
 
         nextFirstId_ = getFirstIdInNextFile();
         CHECK_EQ(currId_, idRanges_.front().first);
+        openFrontFile();
         currPos_ = 0;
     } else {
         // Move to the next log
-        currPos_ += sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(int32_t) * 2
+        currPos_ += WalFileReader::kLogHeadSize
                     + currMsgLen_
-                    + sizeof(ClusterID);
+                    + sizeof(int32_t);
     }
 
     if (idRanges_.front().second <= 0) {
         // empty file
         currId_ = lastId_ + 1;
         return *this;
-    } else {
-        LogID logId;
-        int fd = fds_.front();
-        // Read the logID
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&logId),
-                       sizeof(LogID),
-                       currPos_),
-                 static_cast<ssize_t>(sizeof(LogID))) << "currPos = " << currPos_;
-        CHECK_EQ(currId_, logId);
-        // Read the termID
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&currTerm_),
-                       sizeof(TermID),
-                       currPos_ + sizeof(LogID)),
-                 static_cast<ssize_t>(sizeof(TermID)));
-        // Read the log length
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&currMsgLen_),
-                       sizeof(int32_t),
-                       currPos_ + sizeof(TermID) + sizeof(LogID)),
-                 static_cast<ssize_t>(sizeof(int32_t)));
+    } else if (currId_ <= lastId_) {
+        readCurrLog();
     }
 
     return *this;
@@ -200,46 +168,48 @@ TermID WalFileIterator::logTerm() const {
 
 
 ClusterID WalFileIterator::logSource() const {
-            // Retrieve from the file
-    DCHECK(!fds_.empty());
-    ClusterID cluster = 0;
-    CHECK_EQ(pread(fds_.front(),
-                   &(cluster),
-                   sizeof(ClusterID),
-                   currPos_
-                    + sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(int32_t)),
-             static_cast<ssize_t>(sizeof(ClusterID)))
-        << "Failed to read. Curr position is " << currPos_
-        << ", expected read length is " << sizeof(ClusterID)
-        << " (errno: " << errno << "): " << strerror(errno);
-
-    return cluster;
+    return currCluster_;
 }
 
 
 folly::StringPiece WalFileIterator::logMsg() const {
-    // Retrieve from the file
+    return currMsg_;
+}
+
+
+void WalFileIterator::openFrontFile() {
     DCHECK(!fds_.empty());
+    reader_ = std::make_unique<WalFileReader>(fds_.front(), wal_->policy_.readBufferSize);
+    WalFileReader::sequential(fds_.front());
+    auto it = fds_.begin();
+    if (++it != fds_.end()) {
+        WalFileReader::prefetch(*it);
+    }
+}
 
-    currLog_.resize(currMsgLen_);
-    CHECK_EQ(pread(fds_.front(),
-                   &(currLog_[0]),
-                   currMsgLen_,
-                   currPos_
-                    + sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(int32_t)
-                    + sizeof(ClusterID)),
-             static_cast<ssize_t>(currMsgLen_))
-        << "Failed to read. Curr position is " << currPos_
-        << ", expected read length is " << currMsgLen_
-        << " (errno: " << errno << "): " << strerror(errno);
-
-    return currLog_;
+
+void WalFileIterator::readCurrLog() {
+    const char* data = reader_->read(currPos_, WalFileReader::kLogHeadSize);
+    CHECK(data != nullptr) << "Failed to read the log " << currId_
+                           << ", currPos = " << currPos_;
+    LogID logId;
+    memcpy(&logId, data, sizeof(LogID));
+    CHECK_EQ(currId_, logId);
+    memcpy(&currTerm_, data + sizeof(LogID), sizeof(TermID));
+    memcpy(&currMsgLen_, data + sizeof(LogID) + sizeof(TermID), sizeof(int32_t));
+    memcpy(&currCluster_,
+           data + sizeof(LogID) + sizeof(TermID) + sizeof(int32_t),
+           sizeof(ClusterID));
+
+    // Read the whole message, it might refill the buffer
+    data = reader_->read(currPos_, WalFileReader::kLogHeadSize + currMsgLen_);
+    CHECK(data != nullptr) << "Failed to read the log " << currId_
+                           << ", currPos = " << currPos_
+                           << ", msg length = " << currMsgLen_;
+    currMsg_.reset(data + WalFileReader::kLogHeadSize, currMsgLen_);
 }
 
+
 LogID WalFileIterator::getFirstIdInNextFile() const {
     auto it = idRanges_.begin();
     ++it;
@@ -9,12 +9,19 @@
 
 #include "common/base/Base.h"
 #include "utils/LogIterator.h"
+#include "kvstore/wal/WalFileReader.h"
 
 namespace nebula {
 namespace wal {
 
 class FileBasedWal;
 
+/**
+ * Iterate the logs in the wal files. The files are read through a read-ahead
+ * buffer, and logMsg() points into the buffer without copying, so it is only
+ * valid until the iterator moves. When the iterator steps into a file, the
+ * next file is prefetched into the page cache in the background.
+ * */
 class WalFileIterator final : public LogIterator {
 public:
     // The range is [startId, lastId]
@@ -40,6 +47,12 @@ public:
 private:
     LogID getFirstIdInNextFile() const;
 
+    // Start reading the front file, and prefetch the one after it
+    void openFrontFile();
+
+    // Read the log at currPos_, which must be currId_
+    void readCurrLog();
+
 private:
     // Holds the Wal object, so that it will not be destroyed before the iterator
     std::shared_ptr<FileBasedWal> wal_;
@@ -53,9 +66,11 @@ private:
     // [firstId, lastId]
     std::list<std::pair<LogID, LogID>> idRanges_;
     std::list<int> fds_;
+    std::unique_ptr<WalFileReader> reader_;
     int64_t currPos_{0};
     int32_t currMsgLen_{0};
-    mutable std::string currLog_;
+    ClusterID currCluster_{0};
+    folly::StringPiece currMsg_;
 };
 
 }  // namespace wal
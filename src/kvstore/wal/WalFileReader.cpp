@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "kvstore/wal/WalFileReader.h"
+#include <fcntl.h>
+
+namespace nebula {
+namespace wal {
+
+WalFileReader::WalFileReader(int32_t fd, size_t maxBufferSize)
+        : fd_(fd)
+        , maxBufferSize_(std::max(maxBufferSize, kAlignment))
+        , nextSize_(std::min(kMinBufferSize, maxBufferSize_)) {}
+
+
+const char* WalFileReader::read(size_t pos, size_t len) {
+    if (pos >= start_ && pos + len <= start_ + buf_.size()) {
+        return buf_.data() + pos - start_;
+    }
+
+    start_ = pos & ~(kAlignment - 1);
+    auto need = pos - start_ + len;
+    buf_.resize(std::max(need, nextSize_));
+    nextSize_ = std::min(nextSize_ * 2, maxBufferSize_);
+
+    size_t total = 0;
+    while (total < buf_.size()) {
+        auto n = pread(fd_, &buf_[total], buf_.size() - total, start_ + total);
+        ++reads_;
+        if (n < 0) {
+            LOG(ERROR) << "Failed to read the wal file at " << start_ + total
+                       << " (errno: " << errno << "): " << strerror(errno);
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += n;
+    }
+    buf_.resize(total);
+    if (total < need) {
+        return nullptr;
+    }
+    return buf_.data() + pos - start_;
+}
+
+
+// static
+void WalFileReader::sequential(int32_t fd) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+}
+
+
+// static
+void WalFileReader::prefetch(int32_t fd) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+}
+
+}  // namespace wal
+}  // namespace nebula
@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef WAL_WALFILEREADER_H_
+#define WAL_WALFILEREADER_H_
+
+#include "common/base/Base.h"
+#include "common/thrift/ThriftTypes.h"
+
+namespace nebula {
+namespace wal {
+
+/**
+ * WalFileReader reads a wal file sequentially through a read-ahead buffer, so
+ * that reading the logs costs one pread for many logs instead of several preads
+ * for every log. The memory returned by read() points into the buffer, it is
+ * valid until the next read().
+ *
+ * The buffer starts small and doubles on every refill until it reaches the max
+ * size, so a short read (e.g. a few logs for a follower nearly catching up)
+ * does not pay for a large read. The refills are aligned to the page size.
+ *
+ * The reader does not own the fd.
+ * */
+class WalFileReader final {
+public:
+    // Size of the fields before the message: id, term, message length and cluster id
+    static constexpr size_t kLogHeadSize = sizeof(LogID) + sizeof(TermID) + sizeof(int32_t)
+                                           + sizeof(ClusterID);
+
+    WalFileReader(int32_t fd, size_t maxBufferSize);
+
+    // Return the pointer to [pos, pos + len) of the file, or nullptr if the
+    // file is shorter than that
+    const char* read(size_t pos, size_t len);
+
+    // Tell the kernel the file will be read sequentially
+    static void sequential(int32_t fd);
+
+    // Ask the kernel to read the whole file into the page cache in the background
+    static void prefetch(int32_t fd);
+
+    // Number of preads issued
+    size_t reads() const {
+        return reads_;
+    }
+
+private:
+    static constexpr size_t kAlignment = 4096;
+    static constexpr size_t kMinBufferSize = 64 * 1024;
+
+    int32_t fd_;
+    size_t maxBufferSize_;
+    size_t nextSize_;
+    size_t start_{0};
+    std::string buf_;
+    size_t reads_{0};
+};
+
+}  // namespace wal
+}  // namespace nebula
+
+#endif  // WAL_WALFILEREADER_H_
@@ -8,6 +8,7 @@
 #include "common/fs/TempDir.h"
 #include <gtest/gtest.h>
 #include "kvstore/wal/FileBasedWal.h"
+#include "kvstore/wal/WalFileIterator.h"
 
 namespace nebula {
 namespace wal {
@@ -549,6 +550,100 @@ TEST(FileBasedWal, CheckLastWalTest) {
     }
 }
 
+TEST(FileBasedWal, SealedIndexTest) {
+    FileBasedWalPolicy policy;
+    policy.fileSize = 1024L * 1024L;
+    TempDir walDir("/tmp/testWal.XXXXXX");
+    auto getWal = [&] () {
+        return FileBasedWal::getWal(walDir.path(),
+                                    "",
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    };
+    auto checkLogs = [&] (std::shared_ptr<FileBasedWal> w, LogID from, LogID to) {
+        auto iter = std::make_unique<WalFileIterator>(w, from, to);
+        LogID id = from;
+        for (; iter->valid(); ++(*iter), ++id) {
+            ASSERT_EQ(id, iter->logId());
+            ASSERT_EQ(folly::stringPrintf(kLongMsg, id), iter->logMsg().toString());
+        }
+        EXPECT_EQ(to + 1, id);
+    };
+
+    auto wal = getWal();
+    for (int i = 1; i <= 1000; i++) {
+        EXPECT_TRUE(wal->appendLog(i /*id*/, i / 100 /*term*/, 0 /*cluster*/,
+                                   folly::stringPrintf(kLongMsg, i)));
+    }
+    auto walFiles = FileUtils::listAllFilesInDir(walDir.path(), true, "*.wal");
+    auto indexFiles = FileUtils::listAllFilesInDir(walDir.path(), true, "*.idx");
+    ASSERT_LT(1, walFiles.size());
+    // All files are sealed except the last one
+    EXPECT_EQ(walFiles.size() - 1, indexFiles.size());
+    wal.reset();
+
+    {
+        LOG(INFO) << "Reopen the wal, the sealed files are loaded from the index";
+        wal = getWal();
+        EXPECT_EQ(1000, wal->lastLogId());
+        EXPECT_EQ(10, wal->lastLogTerm());
+        LogID expectedFirstId = 1;
+        for (auto& entry : wal->walFiles_) {
+            auto& info = entry.second;
+            EXPECT_EQ(expectedFirstId, info->firstId());
+            EXPECT_EQ(info->lastId() / 100, info->lastTerm());
+            auto count = info->lastId() - info->firstId() + 1;
+            EXPECT_EQ((count + WalFileInfo::kIndexInterval - 1) / WalFileInfo::kIndexInterval,
+                      info->offsets().size());
+            expectedFirstId = info->lastId() + 1;
+        }
+        // The last file is going to be appended, so it is not sealed any more
+        EXPECT_EQ(indexFiles.size() - 1,
+                  FileUtils::listAllFilesInDir(walDir.path(), true, "*.idx").size());
+        // Seek by the index
+        checkLogs(wal, 1, 1000);
+        checkLogs(wal, 130, 500);
+        checkLogs(wal, 999, 1000);
+        wal.reset();
+    }
+    {
+        LOG(INFO) << "Corrupt an index, it should fall back to read the wal file";
+        auto fd = open(indexFiles.front().c_str(), O_WRONLY);
+        ASSERT_GE(fd, 0);
+        LogID fakeId = 12345;
+        ASSERT_EQ(static_cast<ssize_t>(sizeof(LogID)),
+                  pwrite(fd, &fakeId, sizeof(LogID), 2 * sizeof(int32_t)));
+        close(fd);
+
+        wal = getWal();
+        EXPECT_EQ(1000, wal->lastLogId());
+        auto& info = wal->walFiles_.begin()->second;
+        EXPECT_LT(1, info->lastId());
+        EXPECT_EQ(0, info->offsets().size());
+        checkLogs(wal, 1, 1000);
+    }
+    {
+        LOG(INFO) << "Rollback in a sealed file";
+        auto& info = wal->walFiles_.begin()->second;
+        auto rollbackId = info->lastId() - 1;
+        ASSERT_TRUE(wal->rollbackToLog(rollbackId));
+        EXPECT_EQ(rollbackId, wal->lastLogId());
+        EXPECT_EQ(1, wal->walFiles_.size());
+        checkLogs(wal, 1, rollbackId);
+        wal.reset();
+
+        wal = getWal();
+        EXPECT_EQ(rollbackId, wal->lastLogId());
+        for (int i = rollbackId + 1; i <= 1000; i++) {
+            EXPECT_TRUE(wal->appendLog(i /*id*/, i / 100 /*term*/, 0 /*cluster*/,
+                                       folly::stringPrintf(kLongMsg, i)));
+        }
+        checkLogs(wal, 1, 1000);
+    }
+}
+
 TEST(FileBasedWal, LinkTest) {
     TempDir walDir("/tmp/testWal.XXXXXX");
     FileBasedWalPolicy policy;
@@ -8,17 +8,29 @@
 #include <folly/Benchmark.h>
 #include "kvstore/wal/AtomicLogBuffer.h"
 #include "kvstore/wal/InMemoryLogBufferList.h"
+#include "kvstore/wal/FileBasedWal.h"
+#include "kvstore/wal/WalFileIterator.h"
+#include "common/fs/TempDir.h"
+#include "common/fs/FileUtils.h"
 
 DEFINE_bool(only_seek, false, "Only seek in read test");
+DEFINE_int32(catch_up_logs, 100000, "Number of logs in the wal files for the catch up test");
+DEFINE_int32(catch_up_batch, 128, "Number of logs read by each iterator in the catch up test");
 
-#define TEST_WRTIE       1
-#define TEST_READ        1
-#define TEST_RW_MIXED    1
+#define TEST_WRTIE          1
+#define TEST_READ           1
+#define TEST_RW_MIXED       1
+#define TEST_WAL_CATCH_UP   1
 
 using nebula::wal::AtomicLogBuffer;
 using nebula::wal::Record;
 using nebula::wal::InMemoryBufferList;
+using nebula::wal::FileBasedWal;
+using nebula::wal::FileBasedWalPolicy;
+using nebula::wal::WalFileIterator;
 using nebula::LogID;
+using nebula::TermID;
+using nebula::ClusterID;
 
 void prepareData(std::shared_ptr<InMemoryBufferList> inMemoryLogBuffer,
                  int32_t len,
@@ -417,6 +429,111 @@ BENCHMARK_RELATIVE(AtomicLogBufferRWMixedWriteTest) {
 
 #endif
 
+
+#if TEST_WAL_CATCH_UP
+/**
+ *  Catch up test, read the logs which are no longer in the log buffer from
+ *  the wal files, like a lagging follower does. The files are in the page
+ *  cache after the first round, so it measures the cost of the syscalls and
+ *  the copies rather than the disk.
+ *
+ * */
+const char* catchUpDir() {
+    static nebula::fs::TempDir walDir("/tmp/wal_catch_up_bm.XXXXXX");
+    return walDir.path();
+}
+
+std::shared_ptr<FileBasedWal> catchUpWal() {
+    static std::shared_ptr<FileBasedWal> wal;
+    if (wal == nullptr) {
+        FileBasedWalPolicy policy;
+        wal = FileBasedWal::getWal(catchUpDir(),
+                                   "",
+                                   policy,
+                                   [](LogID, TermID, ClusterID, const std::string&) {
+                                       return true;
+                                   });
+        for (LogID id = 1; id <= FLAGS_catch_up_logs; id++) {
+            CHECK(wal->appendLog(id, 1, 0, std::string(1024, 'A')));
+        }
+    }
+    return wal;
+}
+
+// The way the logs used to be read, several preads for every log
+void preadAllLogs(const std::string& dir) {
+    auto files = nebula::fs::FileUtils::listAllFilesInDir(dir.c_str(), true, "*.wal");
+    std::sort(files.begin(), files.end());
+    std::string msg;
+    for (auto& file : files) {
+        int fd = open(file.c_str(), O_RDONLY);
+        CHECK_GE(fd, 0);
+        int64_t pos = 0;
+        while (true) {
+            LogID logId;
+            TermID term;
+            int32_t len;
+            ClusterID cluster;
+            if (pread(fd, &logId, sizeof(LogID), pos) != sizeof(LogID)) {
+                break;
+            }
+            CHECK_EQ(pread(fd, &term, sizeof(TermID), pos + sizeof(LogID)),
+                     static_cast<ssize_t>(sizeof(TermID)));
+            CHECK_EQ(pread(fd, &len, sizeof(int32_t), pos + sizeof(LogID) + sizeof(TermID)),
+                     static_cast<ssize_t>(sizeof(int32_t)));
+            pos += sizeof(LogID) + sizeof(TermID) + sizeof(int32_t);
+            CHECK_EQ(pread(fd, &cluster, sizeof(ClusterID), pos),
+                     static_cast<ssize_t>(sizeof(ClusterID)));
+            pos += sizeof(ClusterID);
+            msg.resize(len);
+            CHECK_EQ(pread(fd, &msg[0], len, pos), static_cast<ssize_t>(len));
+            folly::doNotOptimizeAway(msg);
+            pos += len + sizeof(int32_t);
+        }
+        close(fd);
+    }
+}
+
+BENCHMARK(PreadWalCatchUp) {
+    std::string dir;
+    BENCHMARK_SUSPEND {
+        catchUpWal();
+        dir = catchUpDir();
+    }
+    preadAllLogs(dir);
+}
+
+BENCHMARK_RELATIVE(WalFileIteratorCatchUp) {
+    std::shared_ptr<FileBasedWal> wal;
+    BENCHMARK_SUSPEND {
+        wal = catchUpWal();
+    }
+    WalFileIterator iter(wal, 1, wal->lastLogId());
+    for (; iter.valid(); ++iter) {
+        auto log = iter.logMsg();
+        folly::doNotOptimizeAway(log);
+    }
+}
+
+BENCHMARK_RELATIVE(WalFileIteratorCatchUpInBatches) {
+    std::shared_ptr<FileBasedWal> wal;
+    BENCHMARK_SUSPEND {
+        wal = catchUpWal();
+    }
+    auto lastId = wal->lastLogId();
+    for (LogID start = 1; start <= lastId; start += FLAGS_catch_up_batch) {
+        WalFileIterator iter(wal, start, std::min(lastId, start + FLAGS_catch_up_batch - 1));
+        for (; iter.valid(); ++iter) {
+            auto log = iter.logMsg();
+            folly::doNotOptimizeAway(log);
+        }
+    }
+}
+
+BENCHMARK_DRAW_LINE();
+
+#endif
+
 /*************************
  * End of benchmarks
  ************************/
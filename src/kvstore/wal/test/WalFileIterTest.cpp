@@ -108,6 +108,54 @@ TEST(WalFileIter, MultiFilesReadTest) {
     }
 }
 
+TEST(WalFileIter, LargeLogReadTest) {
+    FileBasedWalPolicy policy;
+    policy.fileSize = 64 * 1024;
+    // Some logs are larger than the read buffer
+    policy.readBufferSize = 4096;
+    TempDir walDir("/tmp/testWal.XXXXXX");
+
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    "",
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    auto genLog = [] (LogID id) {
+        return std::string((id * 997) % 10000 + 1, static_cast<char>('a' + id % 26));
+    };
+    for (int i = 1; i <= 1000; i++) {
+        EXPECT_TRUE(wal->appendLog(i /*id*/, i / 100 /*term*/, i % 3 /*cluster*/, genLog(i)));
+    }
+    EXPECT_EQ(1000, wal->lastLogId());
+    EXPECT_LT(10, wal->walFiles_.size());
+
+    for (auto start : {1, 10, 500, 999}) {
+        auto it = std::make_unique<WalFileIterator>(wal, start, 1000);
+        LogID id = start;
+        while (it->valid()) {
+            EXPECT_EQ(id, it->logId());
+            EXPECT_EQ(id / 100, it->logTerm());
+            EXPECT_EQ(id % 3, it->logSource());
+            EXPECT_EQ(genLog(id), it->logMsg());
+            ++(*it);
+            ++id;
+        }
+        EXPECT_EQ(1001, id);
+    }
+    {
+        // Stop in the middle of a file
+        auto it = std::make_unique<WalFileIterator>(wal, 300, 700);
+        LogID id = 300;
+        while (it->valid()) {
+            EXPECT_EQ(genLog(id), it->logMsg());
+            ++(*it);
+            ++id;
+        }
+        EXPECT_EQ(701, id);
+    }
+}
+
 
 }  // namespace wal
 }  // namespace nebula
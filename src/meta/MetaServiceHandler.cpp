@@ -160,7 +160,7 @@ MetaServiceHandler::future_alterTag(const cpp2::AlterTagReq& req) {
 
 folly::Future<cpp2::ExecResp>
 MetaServiceHandler::future_dropTag(const cpp2::DropTagReq& req) {
-    auto* processor = DropTagProcessor::instance(kvstore_);
+    auto* processor = DropTagProcessor::instance(kvstore_, adminClient_.get());
     RETURN_FUTURE(processor);
 }
 
@@ -190,7 +190,7 @@ MetaServiceHandler::future_alterEdge(const cpp2::AlterEdgeReq& req) {
 
 folly::Future<cpp2::ExecResp>
 MetaServiceHandler::future_dropEdge(const cpp2::DropEdgeReq& req) {
-    auto* processor = DropEdgeProcessor::instance(kvstore_);
+    auto* processor = DropEdgeProcessor::instance(kvstore_, adminClient_.get());
     RETURN_FUTURE(processor);
 }
 
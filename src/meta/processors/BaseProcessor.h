@@ -217,7 +217,11 @@ protected:
 
     void doSyncPutAndUpdate(std::vector<kvstore::KV> data);
 
-    void doSyncMultiRemoveAndUpdate(std::vector<std::string> keys);
+    kvstore::ResultCode doSyncMultiRemove(std::vector<std::string> keys);
+
+    // onRemoved is called once the keys have been removed, its error is returned to the client
+    void doSyncMultiRemoveAndUpdate(std::vector<std::string> keys,
+                                    std::function<cpp2::ErrorCode()> onRemoved = nullptr);
 
     /**
      * Check the edge or tag contains indexes when alter it.
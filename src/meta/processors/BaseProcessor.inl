@@ -353,7 +353,7 @@ void BaseProcessor<RESP>::doSyncPutAndUpdate(std::vector<kvstore::KV> data) {
 }
 
 template<typename RESP>
-void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> keys) {
+kvstore::ResultCode BaseProcessor<RESP>::doSyncMultiRemove(std::vector<std::string> keys) {
     folly::Baton<true, std::atomic> baton;
     auto ret = kvstore::ResultCode::SUCCEEDED;
     kvstore_->asyncMultiRemove(kDefaultSpaceId,
@@ -367,13 +367,28 @@ void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> ke
         baton.post();
     });
     baton.wait();
+    return ret;
+}
+
+template<typename RESP>
+void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> keys,
+                                                     std::function<cpp2::ErrorCode()> onRemoved) {
+    auto ret = doSyncMultiRemove(std::move(keys));
     if (ret != kvstore::ResultCode::SUCCEEDED) {
         this->handleErrorCode(MetaCommon::to(ret));
         this->onFinished();
         return;
     }
+    auto code = cpp2::ErrorCode::SUCCEEDED;
+    if (onRemoved) {
+        code = onRemoved();
+    }
+    // The keys are gone anyway, so the update time is bumped even if onRemoved failed
     ret = LastUpdateTimeMan::update(kvstore_, time::WallClock::fastNowInMilliSec());
-    this->handleErrorCode(MetaCommon::to(ret));
+    if (code == cpp2::ErrorCode::SUCCEEDED) {
+        code = MetaCommon::to(ret);
+    }
+    this->handleErrorCode(code);
     this->onFinished();
 }
 
@@ -23,15 +23,14 @@ MetaJobExecutorFactory::createMetaJobExecutor(const JobDescription& jd,
     switch (cmd) {
     case cpp2::AdminCmd::COMPACT:
     case cpp2::AdminCmd::FLUSH:
+    case cpp2::AdminCmd::REBUILD_TAG_INDEX:
+    case cpp2::AdminCmd::REBUILD_EDGE_INDEX:
         ret.reset(new SimpleConcurrentJobExecutor(jd.getJobId(),
                                                   cmd,
                                                   jd.getParas(),
                                                   store,
                                                   client));
         break;
-    case cpp2::AdminCmd::REBUILD_TAG_INDEX:
-    case cpp2::AdminCmd::REBUILD_EDGE_INDEX:
-        break;
     default:
         break;
     }
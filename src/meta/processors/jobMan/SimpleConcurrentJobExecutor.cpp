@@ -44,7 +44,21 @@ SimpleConcurrentJobExecutor::execute() {
     }
     std::vector<HostAddr>& hosts = nebula::value(errOrTargetHost);
     int32_t concurrency = INT_MAX;
-    if (paras_.size() > 1) {
+    std::vector<std::string> taskParas;
+    if (cmd_ == cpp2::AdminCmd::REBUILD_TAG_INDEX ||
+        cmd_ == cpp2::AdminCmd::REBUILD_EDGE_INDEX) {
+        // The index names to rebuild followed by the space name, rebuild all
+        // indexes of the space if no index is given
+        taskParas.assign(paras_.begin(), paras_.end() - 1);
+    } else if (cmd_ == cpp2::AdminCmd::COMPACT && paras_.size() > 1 &&
+               (folly::StringPiece(paras_[0]).startsWith("tag:") ||
+                folly::StringPiece(paras_[0]).startsWith("edge:"))) {
+        // The dropped tags and edges whose rows to remove, followed by the space name
+        taskParas.assign(paras_.begin(), paras_.end() - 1);
+    } else if (cmd_ == cpp2::AdminCmd::COMPACT && paras_.size() > 1 && paras_[0] == "edge_key") {
+        // Move the edges to the key type of the layout on the storage hosts
+        taskParas.assign(paras_.begin(), paras_.end() - 1);
+    } else if (paras_.size() > 1) {
         concurrency = std::atoi(paras_[0].c_str());
     }
 
@@ -53,7 +67,7 @@ SimpleConcurrentJobExecutor::execute() {
     std::vector<PartitionID> parts;
     for (auto& host : hosts) {
         auto future = adminClient_->addTask(cmd_, jobId_, taskId++, spaceId,
-                                            {host}, {}, parts, concurrency);
+                                            {host}, taskParas, parts, concurrency);
         futures.push_back(std::move(future));
     }
 
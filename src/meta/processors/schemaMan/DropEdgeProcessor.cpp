@@ -5,10 +5,14 @@
  */
 
 #include "meta/processors/schemaMan/DropEdgeProcessor.h"
+#include "meta/processors/jobMan/JobManager.h"
 
 namespace nebula {
 namespace meta {
 
+static constexpr int32_t kAddJobRetryTimes = 3;
+static constexpr int32_t kAddJobRetryIntervalMs = 100;
+
 void DropEdgeProcessor::process(const cpp2::DropEdgeReq& req) {
     CHECK_SPACE_ID_AND_RETURN(req.get_space_id());
     GraphSpaceID spaceId = req.get_space_id();
@@ -49,7 +53,9 @@ void DropEdgeProcessor::process(const cpp2::DropEdgeReq& req) {
     auto keys = std::move(ret).value();
     keys.emplace_back(std::move(indexKey));
     LOG(INFO) << "Drop Edge " << req.get_edge_name();
-    doSyncMultiRemoveAndUpdate(std::move(keys));
+    doSyncMultiRemoveAndUpdate(std::move(keys), [this, spaceId, edgeType] () {
+        return addDropDataJob(spaceId, edgeType);
+    });
 }
 
 StatusOr<std::vector<std::string>> DropEdgeProcessor::getEdgeKeys(GraphSpaceID id,
@@ -69,6 +75,41 @@ StatusOr<std::vector<std::string>> DropEdgeProcessor::getEdgeKeys(GraphSpaceID i
     return keys;
 }
 
+cpp2::ErrorCode DropEdgeProcessor::addDropDataJob(GraphSpaceID spaceId, EdgeType edgeType) {
+    if (adminClient_ == nullptr) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto spaceRet = doGet(MetaServiceUtils::spaceKey(spaceId));
+    if (!spaceRet.ok()) {
+        LOG(ERROR) << "Space " << spaceId << " not found";
+        return cpp2::ErrorCode::E_NOT_FOUND;
+    }
+    auto spaceName = MetaServiceUtils::parseSpace(spaceRet.value()).get_space_name();
+    auto jobId = autoIncrementId();
+    if (!nebula::ok(jobId)) {
+        LOG(ERROR) << "Get job id failed";
+        return nebula::error(jobId);
+    }
+    // The rows are removed by a compaction job of the space, or by the compaction later
+    std::vector<std::string> paras{folly::stringPrintf("edge:%d", edgeType), spaceName};
+    JobDescription jobDesc(nebula::value(jobId), cpp2::AdminCmd::COMPACT, std::move(paras));
+    auto rc = kvstore::ResultCode::SUCCEEDED;
+    for (int32_t retry = 0; retry < kAddJobRetryTimes; retry++) {
+        rc = JobManager::getInstance()->addJob(jobDesc, adminClient_);
+        if (rc == kvstore::ResultCode::SUCCEEDED) {
+            return cpp2::ErrorCode::SUCCEEDED;
+        }
+        LOG(WARNING) << "Add job to drop the data of edge " << edgeType << " failed, retry "
+                     << retry;
+        if (retry + 1 < kAddJobRetryTimes) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kAddJobRetryIntervalMs));
+        }
+    }
+    // The edge is dropped already, the client has to submit a compaction job for the data
+    LOG(ERROR) << "Add job to drop the data of edge " << edgeType << " failed";
+    return MetaCommon::to(rc);
+}
+
 }  // namespace meta
 }  // namespace nebula
 
@@ -8,23 +8,32 @@
 #define META_DROPEDGEPROCESSOR_H_
 
 #include "meta/processors/BaseProcessor.h"
+#include "meta/processors/admin/AdminClient.h"
 
 namespace nebula {
 namespace meta {
 
 class DropEdgeProcessor : public BaseProcessor<cpp2::ExecResp> {
 public:
-    static DropEdgeProcessor* instance(kvstore::KVStore* kvstore) {
-        return new DropEdgeProcessor(kvstore);
+    static DropEdgeProcessor* instance(kvstore::KVStore* kvstore,
+                                       AdminClient* adminClient = nullptr) {
+        return new DropEdgeProcessor(kvstore, adminClient);
     }
 
     void process(const cpp2::DropEdgeReq& req);
 
 private:
-    explicit DropEdgeProcessor(kvstore::KVStore* kvstore)
-            : BaseProcessor<cpp2::ExecResp>(kvstore) {}
+    DropEdgeProcessor(kvstore::KVStore* kvstore, AdminClient* adminClient)
+            : BaseProcessor<cpp2::ExecResp>(kvstore)
+            , adminClient_(adminClient) {}
 
     StatusOr<std::vector<std::string>> getEdgeKeys(GraphSpaceID id, EdgeType edgeType);
+
+    // Add a job to remove the rows of the dropped edge in storage, retried a few times
+    cpp2::ErrorCode addDropDataJob(GraphSpaceID spaceId, EdgeType edgeType);
+
+private:
+    AdminClient* adminClient_{nullptr};
 };
 
 }  // namespace meta
@@ -5,10 +5,14 @@
  */
 
 #include "meta/processors/schemaMan/DropTagProcessor.h"
+#include "meta/processors/jobMan/JobManager.h"
 
 namespace nebula {
 namespace meta {
 
+static constexpr int32_t kAddJobRetryTimes = 3;
+static constexpr int32_t kAddJobRetryIntervalMs = 100;
+
 void DropTagProcessor::process(const cpp2::DropTagReq& req) {
     CHECK_SPACE_ID_AND_RETURN(req.get_space_id());
     GraphSpaceID spaceId = req.get_space_id();
@@ -50,7 +54,9 @@ void DropTagProcessor::process(const cpp2::DropTagReq& req) {
     keys.emplace_back(indexKey);
     handleErrorCode(cpp2::ErrorCode::SUCCEEDED);
     LOG(INFO) << "Drop Tag " << req.get_tag_name();
-    doSyncMultiRemoveAndUpdate(std::move(keys));
+    doSyncMultiRemoveAndUpdate(std::move(keys), [this, spaceId, tagId] () {
+        return addDropDataJob(spaceId, tagId);
+    });
 }
 
 StatusOr<std::vector<std::string>> DropTagProcessor::getTagKeys(GraphSpaceID id, TagID tagId) {
@@ -69,6 +75,41 @@ StatusOr<std::vector<std::string>> DropTagProcessor::getTagKeys(GraphSpaceID id,
     return keys;
 }
 
+cpp2::ErrorCode DropTagProcessor::addDropDataJob(GraphSpaceID spaceId, TagID tagId) {
+    if (adminClient_ == nullptr) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto spaceRet = doGet(MetaServiceUtils::spaceKey(spaceId));
+    if (!spaceRet.ok()) {
+        LOG(ERROR) << "Space " << spaceId << " not found";
+        return cpp2::ErrorCode::E_NOT_FOUND;
+    }
+    auto spaceName = MetaServiceUtils::parseSpace(spaceRet.value()).get_space_name();
+    auto jobId = autoIncrementId();
+    if (!nebula::ok(jobId)) {
+        LOG(ERROR) << "Get job id failed";
+        return nebula::error(jobId);
+    }
+    // The rows are removed by a compaction job of the space, or by the compaction later
+    std::vector<std::string> paras{folly::stringPrintf("tag:%d", tagId), spaceName};
+    JobDescription jobDesc(nebula::value(jobId), cpp2::AdminCmd::COMPACT, std::move(paras));
+    auto rc = kvstore::ResultCode::SUCCEEDED;
+    for (int32_t retry = 0; retry < kAddJobRetryTimes; retry++) {
+        rc = JobManager::getInstance()->addJob(jobDesc, adminClient_);
+        if (rc == kvstore::ResultCode::SUCCEEDED) {
+            return cpp2::ErrorCode::SUCCEEDED;
+        }
+        LOG(WARNING) << "Add job to drop the data of tag " << tagId << " failed, retry "
+                     << retry;
+        if (retry + 1 < kAddJobRetryTimes) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kAddJobRetryIntervalMs));
+        }
+    }
+    // The tag is dropped already, the client has to submit a compaction job for the data
+    LOG(ERROR) << "Add job to drop the data of tag " << tagId << " failed";
+    return MetaCommon::to(rc);
+}
+
 }  // namespace meta
 }  // namespace nebula
 
@@ -8,23 +8,32 @@
 #define META_DROPTAGPROCESSOR_H
 
 #include "meta/processors/BaseProcessor.h"
+#include "meta/processors/admin/AdminClient.h"
 
 namespace nebula {
 namespace meta {
 
 class DropTagProcessor : public BaseProcessor<cpp2::ExecResp> {
 public:
-    static DropTagProcessor* instance(kvstore::KVStore* kvstore) {
-        return new DropTagProcessor(kvstore);
+    static DropTagProcessor* instance(kvstore::KVStore* kvstore,
+                                       AdminClient* adminClient = nullptr) {
+        return new DropTagProcessor(kvstore, adminClient);
     }
 
     void process(const cpp2::DropTagReq& req);
 
 private:
-    explicit DropTagProcessor(kvstore::KVStore* kvstore)
-            : BaseProcessor<cpp2::ExecResp>(kvstore) {}
+    DropTagProcessor(kvstore::KVStore* kvstore, AdminClient* adminClient)
+            : BaseProcessor<cpp2::ExecResp>(kvstore)
+            , adminClient_(adminClient) {}
 
     StatusOr<std::vector<std::string>> getTagKeys(GraphSpaceID id, TagID tagId);
+
+    // Add a job to remove the rows of the dropped tag in storage, retried a few times
+    cpp2::ErrorCode addDropDataJob(GraphSpaceID spaceId, TagID tagId);
+
+private:
+    AdminClient* adminClient_{nullptr};
 };
 
 }  // namespace meta
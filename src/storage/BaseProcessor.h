@@ -38,6 +38,15 @@ public:
         return promise_.getFuture();
     }
 
+    // Fail all the parts of a request without processing it, e.g. when the server is
+    // overloaded. The processor is deleted afterwards.
+    void reject(const std::vector<PartitionID>& parts, cpp2::ErrorCode code) {
+        for (auto partId : parts) {
+            pushResultCode(code, partId);
+        }
+        onFinished();
+    }
+
 protected:
     void onFinished() {
         stats::Stats::addStatsValue(stats_,
@@ -6,10 +6,176 @@
 
 #include "storage/CommonUtils.h"
 #include "common/time/WallClock.h"
+#include "utils/NebulaKeyUtils.h"
 
 namespace nebula {
 namespace storage {
 
+namespace {
+
+// The key with the key type replaced, which is the lowest byte of the first int32
+std::string withKeyType(folly::StringPiece key, NebulaKeyType type) {
+    std::string ret = key.str();
+    if (!ret.empty()) {
+        ret[0] = static_cast<char>(static_cast<uint32_t>(type));
+    }
+    return ret;
+}
+
+// Compare the keys without the key type first, and then the key type
+int compareEdgeKeys(folly::StringPiece lhs, folly::StringPiece rhs) {
+    auto ret = lhs.subpiece(1).compare(rhs.subpiece(1));
+    if (ret != 0) {
+        return ret;
+    }
+    return static_cast<int>(static_cast<uint8_t>(lhs[0])) -
+           static_cast<int>(static_cast<uint8_t>(rhs[0]));
+}
+
+/**
+ * Merge the iterators of the same prefix of the edge key types in the order of
+ * compareEdgeKeys. The iterator owns the prefixes of its children.
+ * */
+class MergedEdgeIterator final : public kvstore::KVIterator {
+public:
+    MergedEdgeIterator(const std::string& prefix, const std::vector<NebulaKeyType>& types)
+        : types_(types) {
+        prefixes_.reserve(types_.size());
+        for (auto type : types_) {
+            prefixes_.emplace_back(withKeyType(prefix, type));
+        }
+    }
+
+    template <typename OpenFunc>
+    kvstore::ResultCode open(OpenFunc&& openFunc) {
+        for (auto& prefix : prefixes_) {
+            std::unique_ptr<kvstore::KVIterator> child;
+            auto ret = openFunc(prefix, &child);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                return ret;
+            }
+            children_.emplace_back(std::move(child));
+        }
+        pick();
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    bool valid() const override {
+        return current_ != nullptr;
+    }
+
+    void next() override {
+        if (!forward_) {
+            // Move the others to the first key after the current one
+            auto target = current_->key().str();
+            for (size_t i = 0; i < children_.size(); i++) {
+                auto* child = children_[i].get();
+                if (child == current_) {
+                    continue;
+                }
+                child->seek(withKeyType(target, types_[i]));
+                if (child->valid() && compareEdgeKeys(child->key(), target) <= 0) {
+                    child->next();
+                }
+            }
+            forward_ = true;
+        }
+        current_->next();
+        pick();
+    }
+
+    void prev() override {
+        if (forward_) {
+            // Move the others to the last key before the current one
+            auto target = current_->key().str();
+            for (size_t i = 0; i < children_.size(); i++) {
+                auto* child = children_[i].get();
+                if (child == current_) {
+                    continue;
+                }
+                child->seekForPrev(withKeyType(target, types_[i]));
+                if (child->valid() && compareEdgeKeys(child->key(), target) >= 0) {
+                    child->prev();
+                }
+            }
+            forward_ = false;
+        }
+        current_->prev();
+        pick();
+    }
+
+    // The key type of the target is ignored, so a key of either type could be sought
+    void seek(folly::StringPiece target) override {
+        for (size_t i = 0; i < children_.size(); i++) {
+            children_[i]->seek(withKeyType(target, types_[i]));
+        }
+        forward_ = true;
+        pick();
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        for (size_t i = 0; i < children_.size(); i++) {
+            children_[i]->seekForPrev(withKeyType(target, types_[i]));
+        }
+        forward_ = false;
+        pick();
+    }
+
+    folly::StringPiece key() const override {
+        return current_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return current_->val();
+    }
+
+private:
+    // The smallest key of the children moving forward, or the largest one moving backward
+    void pick() {
+        current_ = nullptr;
+        for (auto& child : children_) {
+            if (!child->valid()) {
+                continue;
+            }
+            if (current_ == nullptr) {
+                current_ = child.get();
+                continue;
+            }
+            auto ret = compareEdgeKeys(child->key(), current_->key());
+            if (forward_ ? ret < 0 : ret > 0) {
+                current_ = child.get();
+            }
+        }
+    }
+
+private:
+    std::vector<NebulaKeyType>                          types_;
+    std::vector<std::string>                            prefixes_;
+    std::vector<std::unique_ptr<kvstore::KVIterator>>   children_;
+    kvstore::KVIterator*                                current_{nullptr};
+    bool                                                forward_{true};
+};
+
+template <typename OpenFunc>
+kvstore::ResultCode openEdgePrefix(GraphSpaceID spaceId,
+                                   PartitionID partId,
+                                   const std::string& prefix,
+                                   std::unique_ptr<kvstore::KVIterator>* iter,
+                                   OpenFunc&& openFunc) {
+    auto types = NebulaKeyUtils::edgeKeyTypes(spaceId, partId);
+    if (types.size() == 1) {
+        return openFunc(prefix, iter);
+    }
+    auto merged = std::make_unique<MergedEdgeIterator>(prefix, types);
+    auto ret = merged->open(std::forward<OpenFunc>(openFunc));
+    if (ret == kvstore::ResultCode::SUCCEEDED) {
+        *iter = std::move(merged);
+    }
+    return ret;
+}
+
+}  // namespace
+
 bool CommonUtils::checkDataExpiredForTTL(const meta::SchemaProviderIf* schema,
                                          RowReader* reader,
                                          const std::string& ttlCol,
@@ -29,5 +195,30 @@ bool CommonUtils::checkDataExpiredForTTL(const meta::SchemaProviderIf* schema,
     return false;
 }
 
+// static
+kvstore::ResultCode CommonUtils::edgePrefix(kvstore::KVStore* kvstore,
+                                            GraphSpaceID spaceId,
+                                            PartitionID partId,
+                                            const std::string& prefix,
+                                            std::unique_ptr<kvstore::KVIterator>* iter) {
+    return openEdgePrefix(spaceId, partId, prefix, iter,
+                          [&] (const std::string& p, std::unique_ptr<kvstore::KVIterator>* it) {
+                              return kvstore->prefix(spaceId, partId, p, it);
+                          });
+}
+
+// static
+kvstore::ResultCode CommonUtils::edgePrefix(kvstore::KVEngine* engine,
+                                            const void* snapshot,
+                                            GraphSpaceID spaceId,
+                                            PartitionID partId,
+                                            const std::string& prefix,
+                                            std::unique_ptr<kvstore::KVIterator>* iter) {
+    return openEdgePrefix(spaceId, partId, prefix, iter,
+                          [&] (const std::string& p, std::unique_ptr<kvstore::KVIterator>* it) {
+                              return engine->prefix(p, it, snapshot);
+                          });
+}
+
 }  // namespace storage
 }  // namespace nebula
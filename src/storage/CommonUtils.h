@@ -10,16 +10,16 @@
 #include "common/base/Base.h"
 #include "common/meta/SchemaManager.h"
 #include "common/meta/IndexManager.h"
-#include "common/base/ConcurrentLRUCache.h"
 #include "common/interface/gen-cpp2/storage_types.h"
+#include <folly/RWSpinLock.h>
 #include "codec/RowReader.h"
+#include "kvstore/KVEngine.h"
 #include "kvstore/KVStore.h"
+#include "storage/cache/VertexCache.h"
 
 namespace nebula {
 namespace storage {
 
-using VertexCache = ConcurrentLRUCache<std::pair<VertexID, TagID>, std::string>;
-
 // unify TagID, EdgeType
 using SchemaID = TagID;
 static_assert(sizeof(SchemaID) == sizeof(EdgeType), "sizeof(TagID) != sizeof(EdgeType)");
@@ -31,6 +31,86 @@ public:
     meta::IndexManager*                             indexMan_{nullptr};
 };
 
+/**
+ * The tags and edge types whose rows are being removed by the drop task. The rows stay on
+ * disk until the task finishes, so the reads and the compaction filter check here to skip
+ * them, without decoding the rows or asking the schema manager. The task removes its
+ * schemas once all rows are gone, only the task adds or removes them.
+ * */
+class DroppedSchemas final {
+public:
+    static DroppedSchemas* instance() {
+        static DroppedSchemas sDroppedSchemas;
+        return &sDroppedSchemas;
+    }
+
+    void addTag(GraphSpaceID spaceId, TagID tagId) {
+        add(makeKey(spaceId, tagId, false));
+    }
+
+    // Both directions of the edge type are dropped
+    void addEdge(GraphSpaceID spaceId, EdgeType edgeType) {
+        add(makeKey(spaceId, std::abs(edgeType), true));
+    }
+
+    void removeTag(GraphSpaceID spaceId, TagID tagId) {
+        remove(makeKey(spaceId, tagId, false));
+    }
+
+    void removeEdge(GraphSpaceID spaceId, EdgeType edgeType) {
+        remove(makeKey(spaceId, std::abs(edgeType), true));
+    }
+
+    bool isTagDropped(GraphSpaceID spaceId, TagID tagId) const {
+        return contains(makeKey(spaceId, tagId, false));
+    }
+
+    bool isEdgeDropped(GraphSpaceID spaceId, EdgeType edgeType) const {
+        return contains(makeKey(spaceId, std::abs(edgeType), true));
+    }
+
+    void clear() {
+        folly::RWSpinLock::WriteHolder wh(&lock_);
+        dropped_.clear();
+        empty_ = true;
+    }
+
+private:
+    DroppedSchemas() = default;
+
+    static uint64_t makeKey(GraphSpaceID spaceId, SchemaID schemaId, bool isEdge) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(spaceId)) << 33)
+             | (static_cast<uint64_t>(isEdge) << 32)
+             | static_cast<uint32_t>(schemaId);
+    }
+
+    void add(uint64_t key) {
+        folly::RWSpinLock::WriteHolder wh(&lock_);
+        dropped_.emplace(key);
+        empty_ = false;
+    }
+
+    void remove(uint64_t key) {
+        folly::RWSpinLock::WriteHolder wh(&lock_);
+        dropped_.erase(key);
+        empty_ = dropped_.empty();
+    }
+
+    bool contains(uint64_t key) const {
+        // Nothing has been dropped in most time, don't take the lock then
+        if (empty_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        return dropped_.count(key) > 0;
+    }
+
+private:
+    std::atomic<bool>               empty_{true};
+    mutable folly::RWSpinLock       lock_;
+    std::unordered_set<uint64_t>    dropped_;
+};
+
 enum class ResultStatus {
     NORMAL = 0,
     ILLEGAL_DATA = -1,
@@ -38,6 +118,7 @@ enum class ResultStatus {
 };
 
 struct PropContext;
+class QueryProfile;
 
 // PlanContext stores some information during the process
 class PlanContext {
@@ -67,6 +148,9 @@ public:
     bool                                insert_ = false;
 
     ResultStatus                        resultStat_{ResultStatus::NORMAL};
+
+    // not null when the request is profiled
+    QueryProfile                       *profile_{nullptr};
 };
 
 class CommonUtils final {
@@ -76,6 +160,26 @@ public:
                                        const std::string& ttlCol,
                                        int64_t ttlDuration);
 
+    /**
+     * Iterate over the edges with the prefix, which is built for the edge key type of the
+     * part by NebulaKeyUtils. Until the part is converted, the edges of both types are
+     * merged in the order of the keys without the type, so the versions of an edge stay
+     * adjacent whichever type they have. The prefix must outlive the iterator.
+     * */
+    static kvstore::ResultCode edgePrefix(kvstore::KVStore* kvstore,
+                                          GraphSpaceID spaceId,
+                                          PartitionID partId,
+                                          const std::string& prefix,
+                                          std::unique_ptr<kvstore::KVIterator>* iter);
+
+    // The same as above, in the snapshot of the engine of the part
+    static kvstore::ResultCode edgePrefix(kvstore::KVEngine* engine,
+                                          const void* snapshot,
+                                          GraphSpaceID spaceId,
+                                          PartitionID partId,
+                                          const std::string& prefix,
+                                          std::unique_ptr<kvstore::KVIterator>* iter);
+
     // Calculate the admin service address based on the storage service address
     static HostAddr getAdminAddrFromStoreAddr(HostAddr storeAddr) {
         if (storeAddr == HostAddr("", 0)) {
@@ -14,6 +14,7 @@
 #include "codec/RowReader.h"
 #include "kvstore/CompactionFilter.h"
 #include "storage/CommonUtils.h"
+#include "storage/kv/KVValueUtils.h"
 
 DEFINE_bool(storage_kv_mode, false, "True for kv mode");
 
@@ -35,8 +36,11 @@ public:
                 const folly::StringPiece& key,
                 const folly::StringPiece& val) const override {
         if (FLAGS_storage_kv_mode) {
-            // in kv mode, we don't delete any data
-            return false;
+            // In kv mode, only the kv keys expired are deleted, they are told by the header
+            // of their values, and the others are kept as they are
+            return NebulaKeyUtils::isDataKey(key) &&
+                   KVValueUtils::hasHeader(val) &&
+                   KVValueUtils::isExpired(val);
         }
 
         if (NebulaKeyUtils::isDataKey(key)) {
@@ -68,6 +72,9 @@ public:
     bool schemaValid(GraphSpaceID spaceId, const folly::StringPiece& key) const {
         if (NebulaKeyUtils::isVertex(vIdLen_, key)) {
             auto tagId = NebulaKeyUtils::getTagId(vIdLen_, key);
+            if (DroppedSchemas::instance()->isTagDropped(spaceId, tagId)) {
+                return false;
+            }
             auto ret = schemaMan_->getLatestTagSchemaVersion(spaceId, tagId);
             if (ret.ok() && ret.value() == -1) {
                 VLOG(3) << "Space " << spaceId << ", Tag " << tagId << " invalid";
@@ -78,6 +85,9 @@ public:
             if (edgeType < 0) {
                 edgeType = -edgeType;
             }
+            if (DroppedSchemas::instance()->isEdgeDropped(spaceId, edgeType)) {
+                return false;
+            }
             auto ret = schemaMan_->getLatestEdgeSchemaVersion(spaceId, edgeType);
             if (ret.ok() && ret.value() == -1) {
                 VLOG(3) << "Space " << spaceId << ", EdgeType " << edgeType << " invalid";
@@ -25,7 +25,7 @@ GeneralStorageServiceHandler::future_put(const cpp2::KVPutRequest& req) {
 
 folly::Future<cpp2::KVGetResponse>
 GeneralStorageServiceHandler::future_get(const cpp2::KVGetRequest& req) {
-    auto* processor = GetProcessor::instance(env_, &getQpsStat_);
+    auto* processor = GetProcessor::instance(env_, &getQpsStat_, readerPool_.get());
     RETURN_FUTURE(processor);
 }
 
@@ -10,6 +10,8 @@
 #include "common/base/Base.h"
 #include "common/stats/Stats.h"
 #include "common/interface/gen-cpp2/GeneralStorageService.h"
+#include "storage/StorageFlags.h"
+#include <folly/executors/IOThreadPoolExecutor.h>
 
 namespace nebula {
 namespace storage {
@@ -19,7 +21,8 @@ class StorageEnv;
 class GeneralStorageServiceHandler final : public cpp2::GeneralStorageServiceSvIf {
 public:
     explicit GeneralStorageServiceHandler(StorageEnv* env)
-        : env_(env) {
+        : env_(env)
+        , readerPool_(std::make_unique<folly::IOThreadPoolExecutor>(FLAGS_reader_handlers)) {
         getQpsStat_    = stats::Stats("storage", "get_kv");
         putQpsStat_    = stats::Stats("storage", "put_kv");
         removeQpsStat_ = stats::Stats("storage", "remove_kv");
@@ -35,10 +38,12 @@ public:
     future_remove(const cpp2::KVRemoveRequest& req) override;
 
 private:
-    StorageEnv*             env_{nullptr};
-    stats::Stats            getQpsStat_;
-    stats::Stats            putQpsStat_;
-    stats::Stats            removeQpsStat_;
+    StorageEnv*                                     env_{nullptr};
+    // The parts of a large get are read in parallel in the pool
+    std::unique_ptr<folly::IOThreadPoolExecutor>    readerPool_;
+    stats::Stats                                    getQpsStat_;
+    stats::Stats                                    putQpsStat_;
+    stats::Stats                                    removeQpsStat_;
 };
 
 }  // namespace storage
@@ -5,6 +5,7 @@
  */
 
 #include "storage/GraphStorageServiceHandler.h"
+#include "common/time/Duration.h"
 #include "storage/mutate/AddVerticesProcessor.h"
 #include "storage/mutate/AddEdgesProcessor.h"
 #include "storage/mutate/DeleteVerticesProcessor.h"
@@ -13,65 +14,160 @@
 #include "storage/mutate/UpdateEdgeProcessor.h"
 #include "storage/query/GetNeighborsProcessor.h"
 #include "storage/query/GetPropProcessor.h"
+#include "storage/index/LookupProcessor.h"
 
-#define RETURN_FUTURE(processor) \
-    auto f = processor->getFuture(); \
-    processor->process(req); \
+// Run the processor in the executor if any. The request is copied into the task, because
+// it is released once the handler returns. All parts fail with a retryable error if the
+// request is rejected. The latency is recorded in the histogram of the method and space.
+#define RUN_PROCESSOR(kind, method, processor, parts) \
+    auto f = withLatency(processor->getFuture(), latencyHisto(method, req.get_space_id())); \
+    if (executor_ == nullptr) { \
+        processor->process(req); \
+        return f; \
+    } \
+    if (!executor_->add(kind, [processor, req] { processor->process(req); })) { \
+        processor->reject(parts, cpp2::ErrorCode::E_RETRY_EXHAUSTED); \
+    } \
     return f;
 
 namespace nebula {
 namespace storage {
 
+namespace {
+
+template <typename REQ>
+std::vector<PartitionID> partsOf(const REQ& req) {
+    std::vector<PartitionID> parts;
+    parts.reserve(req.get_parts().size());
+    for (const auto& entry : req.get_parts()) {
+        parts.emplace_back(entry.first);
+    }
+    return parts;
+}
+
+// The time waiting in the executor is included
+template <typename RESP>
+folly::Future<RESP> withLatency(folly::Future<RESP> f, metrics::Histogram* histo) {
+    return std::move(f).thenValue([histo, duration = time::Duration()] (RESP&& resp) {
+        histo->addValue(duration.elapsedInUSec());
+        return std::move(resp);
+    });
+}
+
+}  // namespace
+
+GraphStorageServiceHandler::~GraphStorageServiceHandler() {
+    if (cachesGuard_ != nullptr) {
+        std::lock_guard<std::mutex> g(cachesGuard_->lock);
+        cachesGuard_->vertexCache = nullptr;
+        cachesGuard_->adjacencyCache = nullptr;
+    }
+}
+
+void GraphStorageServiceHandler::watchLeader() {
+    if (env_ == nullptr || env_->kvstore_ == nullptr) {
+        return;
+    }
+    cachesGuard_ = std::make_shared<CachesGuard>();
+    cachesGuard_->vertexCache = &vertexCache_;
+    cachesGuard_->adjacencyCache = &adjacencyCache_;
+    // A part which loses the leadership misses the writes from then on, and it may be
+    // elected again while what was cached before is still there
+    env_->kvstore_->addLeaderListener(
+        [guard = cachesGuard_] (GraphSpaceID spaceId, PartitionID partId, bool isLeader) {
+            std::lock_guard<std::mutex> g(guard->lock);
+            if (guard->adjacencyCache == nullptr) {
+                return;
+            }
+            VLOG(1) << "The leadership of part " << spaceId << ", " << partId
+                    << " changed, is leader " << isLeader << ", drop its caches";
+            guard->vertexCache->evictPart(spaceId, partId);
+            guard->adjacencyCache->evictPart(spaceId, partId);
+        });
+}
+
+metrics::Histogram* GraphStorageServiceHandler::latencyHisto(folly::StringPiece method,
+                                                             GraphSpaceID spaceId) {
+    auto key = std::make_pair(method, spaceId);
+    {
+        folly::RWSpinLock::ReadHolder rh(&latencyLock_);
+        auto it = latencyHistos_.find(key);
+        if (it != latencyHistos_.end()) {
+            return it->second;
+        }
+    }
+    auto* histo = metrics::Metrics::instance()->histogram(
+        "storage_latency_us",
+        {{"method", method.str()}, {"space", folly::to<std::string>(spaceId)}});
+    folly::RWSpinLock::WriteHolder wh(&latencyLock_);
+    latencyHistos_.emplace(key, histo);
+    return histo;
+}
+
 // Vertice section
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_addVertices(const cpp2::AddVerticesRequest& req) {
     auto* processor = AddVerticesProcessor::instance(env_, &addVerticesQpsStat_, &vertexCache_);
-    RETURN_FUTURE(processor);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "add_vertices", processor, partsOf(req));
 }
 
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_deleteVertices(const cpp2::DeleteVerticesRequest& req) {
-    auto* processor = DeleteVerticesProcessor::instance(env_, &delVerticesQpsStat_, &vertexCache_);
-    RETURN_FUTURE(processor);
+    auto* processor = DeleteVerticesProcessor::instance(env_,
+                                                        &delVerticesQpsStat_,
+                                                        &vertexCache_,
+                                                        &adjacencyCache_);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "del_vertices", processor, partsOf(req));
 }
 
 folly::Future<cpp2::UpdateResponse>
 GraphStorageServiceHandler::future_updateVertex(const cpp2::UpdateVertexRequest& req) {
     auto* processor = UpdateVertexProcessor::instance(env_, &updateVertexQpsStat_, &vertexCache_);
-    RETURN_FUTURE(processor);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "update_vertex", processor, {req.get_part_id()});
 }
 
 // Edge section
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_addEdges(const cpp2::AddEdgesRequest& req) {
-    auto* processor = AddEdgesProcessor::instance(env_, &addEdgesQpsStat_);
-    RETURN_FUTURE(processor);
+    auto* processor = AddEdgesProcessor::instance(env_, &addEdgesQpsStat_, &adjacencyCache_);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "add_edges", processor, partsOf(req));
 }
 
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_deleteEdges(const cpp2::DeleteEdgesRequest& req) {
-    auto* processor = DeleteEdgesProcessor::instance(env_, &delEdgesQpsStat_);
-    RETURN_FUTURE(processor);
+    auto* processor = DeleteEdgesProcessor::instance(env_, &delEdgesQpsStat_, &adjacencyCache_);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "del_edges", processor, partsOf(req));
 }
 
 folly::Future<cpp2::UpdateResponse>
 GraphStorageServiceHandler::future_updateEdge(const cpp2::UpdateEdgeRequest& req) {
-    auto* processor = UpdateEdgeProcessor::instance(env_, &updateEdgeQpsStat_);
-    RETURN_FUTURE(processor);
+    auto* processor = UpdateEdgeProcessor::instance(env_, &updateEdgeQpsStat_, &adjacencyCache_);
+    RUN_PROCESSOR(RequestExecutor::Kind::WRITE, "update_edge", processor, {req.get_part_id()});
 }
 
 folly::Future<cpp2::GetNeighborsResponse>
 GraphStorageServiceHandler::future_getNeighbors(const cpp2::GetNeighborsRequest& req) {
     auto* processor = GetNeighborsProcessor::instance(env_,
                                                       &getNeighborsQpsStat_,
-                                                      &vertexCache_);
-    RETURN_FUTURE(processor);
+                                                      &vertexCache_,
+                                                      &adjacencyCache_);
+    RUN_PROCESSOR(RequestExecutor::Kind::READ, "get_neighbors", processor, partsOf(req));
 }
 
 folly::Future<cpp2::GetPropResponse>
 GraphStorageServiceHandler::future_getProps(const cpp2::GetPropRequest& req) {
     auto* processor = GetPropProcessor::instance(env_, &getPropQpsStat_, &vertexCache_);
-    RETURN_FUTURE(processor);
+    RUN_PROCESSOR(RequestExecutor::Kind::READ, "get_prop", processor, partsOf(req));
+}
+
+// Index section
+folly::Future<cpp2::LookupIndexResp>
+GraphStorageServiceHandler::future_lookupIndex(const cpp2::LookupIndexRequest& req) {
+    auto* processor = LookupProcessor::instance(env_,
+                                                &lookupIndexQpsStat_,
+                                                &vertexCache_,
+                                                readerPool_.get());
+    RUN_PROCESSOR(RequestExecutor::Kind::READ, "lookup_index", processor, req.get_parts());
 }
 
 }  // namespace storage
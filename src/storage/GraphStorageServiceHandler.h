@@ -12,8 +12,12 @@
 #include "common/stats/StatsManager.h"
 #include "common/interface/gen-cpp2/GraphStorageService.h"
 #include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/RWSpinLock.h>
 #include "storage/CommonUtils.h"
+#include "storage/cache/AdjacencyCache.h"
 #include "storage/StorageFlags.h"
+#include "storage/RequestExecutor.h"
+#include "utils/Metrics.h"
 
 namespace nebula {
 namespace storage {
@@ -22,9 +26,17 @@ class StorageEnv;
 
 class GraphStorageServiceHandler final : public cpp2::GraphStorageServiceSvIf {
 public:
-    explicit GraphStorageServiceHandler(StorageEnv* env)
+    // The processors are run in the thrift threads if there is no executor
+    explicit GraphStorageServiceHandler(StorageEnv* env, RequestExecutor* executor = nullptr)
         : env_(env)
-        , vertexCache_(FLAGS_vertex_cache_num, FLAGS_vertex_cache_bucket_exp)
+        , executor_(executor)
+        , vertexCache_(static_cast<size_t>(FLAGS_vertex_cache_capacity_mb) << 20,
+                       FLAGS_vertex_cache_bucket_exp,
+                       &vertexCacheStat_)
+        , adjacencyCache_(static_cast<size_t>(FLAGS_adjacency_cache_capacity_mb) << 20,
+                          FLAGS_adjacency_cache_bucket_exp,
+                          &adjacencyCacheStat_,
+                          &adjacencyCacheMissStat_)
         , readerPool_(std::make_unique<folly::IOThreadPoolExecutor>(FLAGS_reader_handlers)) {
         addVerticesQpsStat_ = stats::Stats("storage", "add_vertices");
         addEdgesQpsStat_ = stats::Stats("storage", "add_edges");
@@ -34,8 +46,15 @@ public:
         updateEdgeQpsStat_ = stats::Stats("storage", "update_edge");
         getNeighborsQpsStat_ = stats::Stats("storage", "get_neighbors");
         getPropQpsStat_ = stats::Stats("storage", "get_prop");
+        lookupIndexQpsStat_ = stats::Stats("storage", "lookup_index");
+        vertexCacheStat_ = stats::Stats("storage", "vertex_cache");
+        adjacencyCacheStat_ = stats::Stats("storage", "adjacency_cache");
+        adjacencyCacheMissStat_ = stats::Stats("storage", "adjacency_cache_miss");
+        watchLeader();
     }
 
+    ~GraphStorageServiceHandler();
+
     // Vertice section
     folly::Future<cpp2::ExecResponse>
     future_addVertices(const cpp2::AddVerticesRequest& req) override;
@@ -62,9 +81,30 @@ public:
     folly::Future<cpp2::GetPropResponse>
     future_getProps(const cpp2::GetPropRequest& req) override;
 
+    // Index section
+    folly::Future<cpp2::LookupIndexResp>
+    future_lookupIndex(const cpp2::LookupIndexRequest& req) override;
+
 private:
+    // The histogram of the latency of the method in the space, the method is a literal
+    metrics::Histogram* latencyHisto(folly::StringPiece method, GraphSpaceID spaceId);
+
+    // Drop what is cached of a part when its leadership changes
+    void watchLeader();
+
+    // Shared with the leader listener, which is left in the kvstore if the handler is
+    // destroyed after the kvstore. The caches are reset when the handler is destroyed.
+    struct CachesGuard {
+        std::mutex          lock;
+        VertexCache*        vertexCache{nullptr};
+        AdjacencyCache*     adjacencyCache{nullptr};
+    };
+
     StorageEnv*                                     env_{nullptr};
+    RequestExecutor*                                executor_{nullptr};
     VertexCache                                     vertexCache_;
+    AdjacencyCache                                  adjacencyCache_;
+    std::shared_ptr<CachesGuard>                    cachesGuard_;
     std::unique_ptr<folly::IOThreadPoolExecutor>    readerPool_;
 
     stats::Stats                                    addVerticesQpsStat_;
@@ -75,6 +115,14 @@ private:
     stats::Stats                                    updateEdgeQpsStat_;
     stats::Stats                                    getNeighborsQpsStat_;
     stats::Stats                                    getPropQpsStat_;
+    stats::Stats                                    lookupIndexQpsStat_;
+    stats::Stats                                    vertexCacheStat_;
+    stats::Stats                                    adjacencyCacheStat_;
+    stats::Stats                                    adjacencyCacheMissStat_;
+
+    folly::RWSpinLock                               latencyLock_;
+    std::map<std::pair<folly::StringPiece, GraphSpaceID>, metrics::Histogram*>
+                                                    latencyHistos_;
 };
 
 }  // namespace storage
@@ -0,0 +1,75 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/RequestExecutor.h"
+#include "common/time/Duration.h"
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+
+namespace nebula {
+namespace storage {
+
+RequestExecutor::RequestExecutor(size_t readers, size_t writers, size_t maxQueued)
+        : maxQueued_(maxQueued) {
+    CHECK_GT(readers, 0);
+    CHECK_GT(writers, 0);
+    readPool_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        readers, std::make_shared<folly::NamedThreadFactory>("reader"));
+    writePool_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+        writers, std::make_shared<folly::NamedThreadFactory>("writer"));
+
+    const char* names[kKinds] = {"read", "write"};
+    for (size_t i = 0; i < kKinds; i++) {
+        queued_[i] = 0;
+        queueStats_[i] = stats::Stats("storage", folly::stringPrintf("%s_queue", names[i]));
+        rejectStats_[i] = stats::Stats("storage", folly::stringPrintf("%s_rejected", names[i]));
+    }
+}
+
+RequestExecutor::~RequestExecutor() {
+    stop();
+}
+
+void RequestExecutor::stop() {
+    {
+        folly::RWSpinLock::WriteHolder wh(&stopLock_);
+        stopped_ = true;
+    }
+    readPool_->join();
+    writePool_->join();
+}
+
+bool RequestExecutor::add(Kind kind, folly::Func task) {
+    auto idx = static_cast<size_t>(kind);
+    folly::RWSpinLock::ReadHolder rh(&stopLock_);
+    if (stopped_) {
+        VLOG(2) << "Reject the request, the executor has been stopped";
+        return false;
+    }
+    auto& queued = queued_[idx];
+    if (queued.fetch_add(1, std::memory_order_relaxed) >= maxQueued_ && maxQueued_ > 0) {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        stats::Stats::addStatsValue(&rejectStats_[idx], false);
+        VLOG(2) << "Reject the request, " << maxQueued_ << " requests are queued";
+        return false;
+    }
+
+    auto* queueStat = &queueStats_[idx];
+    time::Duration duration;
+    auto func = [&queued, queueStat, duration, task = std::move(task)] () mutable {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        stats::Stats::addStatsValue(queueStat, true, duration.elapsedInUSec());
+        task();
+    };
+    if (kind == Kind::READ) {
+        readPool_->add(std::move(func));
+    } else {
+        writePool_->add(std::move(func));
+    }
+    return true;
+}
+
+}  // namespace storage
+}  // namespace nebula
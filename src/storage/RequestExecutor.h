@@ -0,0 +1,73 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_REQUESTEXECUTOR_H_
+#define STORAGE_REQUESTEXECUTOR_H_
+
+#include "common/base/Base.h"
+#include "common/stats/Stats.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/RWSpinLock.h>
+
+namespace nebula {
+namespace storage {
+
+/**
+ * RequestExecutor runs the processors of the graph storage service, so the thrift threads
+ * only decode the requests and never block on the kvstore.
+ *
+ * The reads run in a pool of FLAGS_reader_handlers threads, so at most so many reads are
+ * served at the same time, and the writes run in another pool, so a burst of heavy reads
+ * won't hold the writes back, and vice versa. The admin requests are not run here, they are
+ * served by their own thrift server and some of them wait for a long time.
+ *
+ * The number of the queued reads and writes are both limited, a request beyond the limit is
+ * rejected at once instead of waiting in the queue, so the client could retry it later.
+ * */
+class RequestExecutor final {
+public:
+    enum class Kind : uint8_t {
+        READ = 0,
+        WRITE = 1,
+    };
+
+    // maxQueued is the limit of the queued requests of each kind, 0 means no limit
+    RequestExecutor(size_t readers, size_t writers, size_t maxQueued);
+
+    ~RequestExecutor();
+
+    // Run the task in the pool of the kind, return false if it is rejected because
+    // too many requests of the kind are queued, or the executor has been stopped.
+    bool add(Kind kind, folly::Func task);
+
+    // Reject the new requests, and wait until the running and queued ones are finished.
+    // The requests still being added are rejected, so it must be called before the
+    // kvstore which the processors run against is destroyed.
+    void stop();
+
+    // Number of the requests of the kind which are waiting in the queue
+    size_t queued(Kind kind) const {
+        return queued_[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t kKinds = 2;
+
+    std::unique_ptr<folly::CPUThreadPoolExecutor>  readPool_;
+    std::unique_ptr<folly::CPUThreadPoolExecutor>  writePool_;
+    size_t                                         maxQueued_;
+    // Held by add() while adding a task, so no task is added once stopped
+    folly::RWSpinLock                              stopLock_;
+    bool                                           stopped_{false};
+    std::array<std::atomic<size_t>, kKinds>        queued_;
+    // The latency is the time a request waits in the queue
+    std::array<stats::Stats, kKinds>               queueStats_;
+    std::array<stats::Stats, kKinds>               rejectStats_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_REQUESTEXECUTOR_H_
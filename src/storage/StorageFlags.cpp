@@ -18,14 +18,93 @@ DEFINE_int32(waiting_new_leader_interval_in_secs, 5,
 DEFINE_int32(rebuild_index_batch_num, 1024,
              "The batch size when rebuild index");
 
-DEFINE_int32(vertex_cache_num, 16 * 1000 * 1000, "Total keys inside the cache");
+DEFINE_int32(rebuild_index_sst_size_mb, 64,
+             "The size of index entries sorted in memory before they are written "
+             "into an sst file and ingested when rebuild index");
+
+DEFINE_int32(rebuild_index_replay_rounds, 16,
+             "Max rounds to replay the writes arrived during rebuilding index");
+
+DEFINE_int32(compact_range_concurrency, 2,
+             "Max ranges compacted at the same time by a compaction task of parts");
+
+DEFINE_int32(compact_range_rate_limit_mb, 0,
+             "The rate in MB/s of the data compacted by a compaction task of parts, "
+             "0 means no limit");
+
+DEFINE_int32(drop_data_batch_ranges, 1024,
+             "Max key ranges removed in one raft log when dropping the data of a tag or edge");
+
+DEFINE_bool(separate_edge_key, false,
+            "The edge key layout the edge_key compaction job converts the parts to, the edges "
+            "are kept apart from the vertices with their own key type if it is true");
+
+DEFINE_int32(convert_edge_key_batch_size, 1024,
+             "Max edges moved in one raft log when converting the edge keys");
+
+DEFINE_int32(vertex_cache_capacity_mb, 1024, "Total memory of the vertex cache");
 
 DEFINE_int32(vertex_cache_bucket_exp, 4, "Total buckets number is 1 << cache_bucket_exp");
 
 DEFINE_bool(enable_vertex_cache, true, "Enable vertex cache");
 
+DEFINE_bool(enable_adjacency_cache, false, "Enable the cache of edges of hot vertices");
+
+DEFINE_int32(adjacency_cache_capacity_mb, 1024, "Total memory of the adjacency cache");
+
+DEFINE_int32(adjacency_cache_bucket_exp, 4,
+             "Total buckets number of adjacency cache is 1 << adjacency_cache_bucket_exp");
+
+DEFINE_int32(adjacency_cache_min_degree, 1000,
+             "Only the edge lists with at least so many edges are cached");
+
+DEFINE_int32(adjacency_cache_hot_threshold, 4,
+             "Only the edge lists accessed at least so many times recently are cached, "
+             "should be no more than 15");
+
+DEFINE_int32(adjacency_cache_sketch_size, 1 << 20,
+             "Number of the counters which estimate the access frequency of edge lists");
+
+DEFINE_int32(adjacency_cache_expire_secs, 300,
+             "The cached edge list expires after so many seconds, 0 means never. "
+             "The lists of a part are dropped anyway when its leadership changes");
+
 DEFINE_int32(reader_handlers, 32, "Total reader handlers");
 
+DEFINE_int32(writer_handlers, 16, "Total handlers of the write and admin requests");
+
+DEFINE_int32(max_queued_requests, 10000,
+             "Reject the reads or writes when so many of them are waiting to be handled, "
+             "0 means no limit");
+
 DEFINE_int32(max_edge_returned_per_vertex, INT_MAX, "Max edge number returnred searching vertex");
 
 DEFINE_bool(enable_reservoir_sampling, false, "Will do reservoir sampling if set true.");
+
+DEFINE_int64(random_sample_seed, 0,
+             "The seed of sampling edges in GetNeighbors, the same request returns the same "
+             "edges if it is set, 0 means a random seed for each request");
+
+DEFINE_string(random_sample_weight_prop, "",
+              "Sample the edges in GetNeighbors weighted by the value of the prop if it is set, "
+              "edges without a numeric value of it weigh 1");
+
+DEFINE_int32(edge_versions_to_seek, 8,
+             "When scanning edges, seek to the next edge once so many old versions of "
+             "an edge have been skipped one by one, 0 means always step");
+
+DEFINE_int32(max_scan_block_size, 4 * 1024 * 1024,
+             "The max bytes read of all parts in a page of a vertex or edge scan");
+
+DEFINE_int32(scan_snapshot_expire_secs, 600,
+             "The snapshot pinned by a scan is released if its next page doesn't come "
+             "in so many seconds");
+
+DEFINE_int32(query_profile_sample_rate, 0,
+             "Profile one of every so many GetNeighbors and GetProp requests, "
+             "0 means only the requests asking for it are profiled");
+
+DEFINE_int32(query_profile_keep_num, 100, "The number of the latest query profiles kept");
+
+DEFINE_uint32(kv_get_keys_per_task, 64,
+              "The min number of keys got in one task when a kv get request runs in parallel");
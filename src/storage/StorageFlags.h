@@ -21,16 +21,64 @@ DECLARE_int32(waiting_new_leader_interval_in_secs);
 
 DECLARE_int32(rebuild_index_batch_num);
 
-DECLARE_int32(vertex_cache_num);
+DECLARE_int32(rebuild_index_sst_size_mb);
+
+DECLARE_int32(rebuild_index_replay_rounds);
+
+DECLARE_int32(compact_range_concurrency);
+
+DECLARE_int32(compact_range_rate_limit_mb);
+
+DECLARE_int32(drop_data_batch_ranges);
+
+DECLARE_bool(separate_edge_key);
+
+DECLARE_int32(convert_edge_key_batch_size);
+
+DECLARE_int32(vertex_cache_capacity_mb);
 
 DECLARE_int32(vertex_cache_bucket_exp);
 
 DECLARE_bool(enable_vertex_cache);
 
+DECLARE_bool(enable_adjacency_cache);
+
+DECLARE_int32(adjacency_cache_capacity_mb);
+
+DECLARE_int32(adjacency_cache_bucket_exp);
+
+DECLARE_int32(adjacency_cache_min_degree);
+
+DECLARE_int32(adjacency_cache_hot_threshold);
+
+DECLARE_int32(adjacency_cache_sketch_size);
+
+DECLARE_int32(adjacency_cache_expire_secs);
+
 DECLARE_int32(reader_handlers);
 
+DECLARE_int32(writer_handlers);
+
+DECLARE_int32(max_queued_requests);
+
 DECLARE_int32(max_edge_returned_per_vertex);
 
 DECLARE_bool(enable_reservoir_sampling);
 
+DECLARE_int64(random_sample_seed);
+
+DECLARE_string(random_sample_weight_prop);
+
+DECLARE_int32(edge_versions_to_seek);
+
+DECLARE_int32(max_scan_block_size);
+
+DECLARE_int32(scan_snapshot_expire_secs);
+
+DECLARE_int32(query_profile_sample_rate);
+
+DECLARE_int32(query_profile_keep_num);
+
+DECLARE_uint32(kv_get_keys_per_task);
+
 #endif  // STORAGE_STORAGEFLAGS_H_
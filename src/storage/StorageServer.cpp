@@ -19,6 +19,7 @@
 #include "storage/http/StorageHttpDownloadHandler.h"
 #include "storage/http/StorageHttpIngestHandler.h"
 #include "storage/http/StorageHttpAdminHandler.h"
+#include "storage/query/ScanSnapshots.h"
 #include "kvstore/PartManager.h"
 #include <thrift/lib/cpp/concurrency/ThreadManager.h>
 
@@ -49,6 +50,9 @@ std::unique_ptr<kvstore::KVStore> StorageServer::getStoreInstance() {
                                                 metaClient_.get());
     options.cffBuilder_ = std::make_unique<StorageCompactionFilterFactoryBuilder>(schemaMan_.get(),
                                                                                   indexMan_.get());
+    options.vIdLenGetter_ = [this] (GraphSpaceID spaceId) {
+        return schemaMan_->getSpaceVidLen(spaceId);
+    };
     if (FLAGS_store_type == "nebula") {
         auto nbStore = std::make_unique<kvstore::NebulaStore>(std::move(options),
                                                               ioThreadPool_,
@@ -143,14 +147,24 @@ bool StorageServer::start() {
         return false;
     }
 
+    if (!ScanSnapshots::instance()->init()) {
+        LOG(ERROR) << "Init scan snapshots failed!";
+        return false;
+    }
+
     env_ = std::make_unique<storage::StorageEnv>();
     env_->kvstore_ = kvstore_.get();
     env_->indexMan_ = indexMan_.get();
     env_->schemaMan_ = schemaMan_.get();
 
+    requestExecutor_ = std::make_unique<RequestExecutor>(FLAGS_reader_handlers,
+                                                         FLAGS_writer_handlers,
+                                                         FLAGS_max_queued_requests);
+
     storageThread_.reset(new std::thread([this] {
         try {
-            auto handler = std::make_shared<GraphStorageServiceHandler>(env_.get());
+            auto handler = std::make_shared<GraphStorageServiceHandler>(env_.get(),
+                                                                         requestExecutor_.get());
             storageServer_ = std::make_unique<apache::thrift::ThriftServer>();
             storageServer_->setPort(FLAGS_port);
             storageServer_->setReusePort(FLAGS_reuse_port);
@@ -222,18 +236,26 @@ void StorageServer::stop() {
         taskMgr_->shutdown();
     }
 
+    // The snapshots are dropped before the store
+    ScanSnapshots::instance()->stop();
+
     if (metaClient_) {
         metaClient_->stop();
     }
-    if (kvstore_) {
-        kvstore_.reset();
-    }
+    // No request comes in once the servers stop, and the processors running or queued
+    // in the executor are finished before the kvstore is gone
     if (adminServer_) {
         adminServer_->stop();
     }
     if (storageServer_) {
         storageServer_->stop();
     }
+    if (requestExecutor_) {
+        requestExecutor_->stop();
+    }
+    if (kvstore_) {
+        kvstore_.reset();
+    }
 }
 
 }   // namespace storage
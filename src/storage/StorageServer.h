@@ -15,6 +15,7 @@
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 #include "kvstore/NebulaStore.h"
 #include "storage/CommonUtils.h"
+#include "storage/RequestExecutor.h"
 #include "storage/admin/AdminTaskManager.h"
 
 namespace nebula {
@@ -69,6 +70,8 @@ private:
     std::unique_ptr<meta::SchemaManager> schemaMan_;
     std::unique_ptr<meta::IndexManager> indexMan_;
     std::unique_ptr<storage::StorageEnv> env_;
+    // Destroyed before env_, the running processors are waited for
+    std::unique_ptr<RequestExecutor> requestExecutor_;
 
     std::atomic_bool stopped_{false};
     HostAddr localHost_;
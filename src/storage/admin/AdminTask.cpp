@@ -6,7 +6,11 @@
 
 #include "storage/admin/AdminTask.h"
 #include "storage/admin/CompactTask.h"
+#include "storage/admin/ConvertEdgeKeyTask.h"
+#include "storage/admin/DropSchemaDataTask.h"
 #include "storage/admin/FlushTask.h"
+#include "storage/admin/RebuildTagIndexTask.h"
+#include "storage/admin/RebuildEdgeIndexTask.h"
 
 namespace nebula {
 namespace storage {
@@ -14,18 +18,29 @@ namespace storage {
 using AdminCmd = nebula::meta::cpp2::AdminCmd;
 
 std::shared_ptr<AdminTask>
-AdminTaskFactory::createAdminTask(TaskContext&& ctx) {
+AdminTaskFactory::createAdminTask(StorageEnv* env, TaskContext&& ctx) {
     FLOG_INFO("%s (%d, %d)", __func__, ctx.jobId_, ctx.taskId_);
     std::shared_ptr<AdminTask> ret;
     switch (ctx.cmd_) {
     case AdminCmd::COMPACT:
-        ret = std::make_shared<CompactTask>(std::move(ctx));
+        // The data of dropped schemas is removed by a compaction job as well, and so are
+        // the edge keys converted
+        if (DropSchemaDataTask::isDropSchemaData(ctx.parameters_)) {
+            ret = std::make_shared<DropSchemaDataTask>(env, std::move(ctx));
+        } else if (ConvertEdgeKeyTask::isConvertEdgeKey(ctx.parameters_)) {
+            ret = std::make_shared<ConvertEdgeKeyTask>(env, std::move(ctx));
+        } else {
+            ret = std::make_shared<CompactTask>(std::move(ctx));
+        }
         break;
     case AdminCmd::FLUSH:
         ret = std::make_shared<FlushTask>(std::move(ctx));
         break;
     case AdminCmd::REBUILD_TAG_INDEX:
+        ret = std::make_shared<RebuildTagIndexTask>(env, std::move(ctx));
+        break;
     case AdminCmd::REBUILD_EDGE_INDEX:
+        ret = std::make_shared<RebuildEdgeIndexTask>(env, std::move(ctx));
         break;
     default:
         break;
@@ -13,6 +13,7 @@
 #include "common/thrift/ThriftTypes.h"
 #include "kvstore/Common.h"
 #include "kvstore/NebulaStore.h"
+#include "storage/CommonUtils.h"
 
 namespace nebula {
 namespace storage {
@@ -52,12 +53,14 @@ struct TaskContext {
             , jobId_(req.get_job_id())
             , taskId_(req.get_task_id())
             , spaceId_(req.get_para().get_space_id())
+            , parameters_(req.get_para())
             , store_(store)
             , onFinish_(cb) {}
     nebula::meta::cpp2::AdminCmd    cmd_;
     int32_t                         jobId_{-1};
     int32_t                         taskId_{-1};
     int32_t                         spaceId_{-1};
+    cpp2::TaskPara                  parameters_;
     TaskPriority                    pri_{TaskPriority::MID};
     kvstore::KVStore*               store_{nullptr};
     CallBack                        onFinish_;
@@ -71,6 +74,7 @@ class AdminTask {
 public:
     AdminTask() = default;
     explicit AdminTask(TaskContext&& ctx) : ctx_(ctx) {}
+    AdminTask(StorageEnv* env, TaskContext&& ctx) : env_(env), ctx_(ctx) {}
     virtual ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() = 0;
     virtual ~AdminTask() {}
 
@@ -127,16 +131,18 @@ public:
 
 public:
     std::atomic<size_t>         unFinishedSubTask_;
+    std::atomic<size_t>         totalSubTask_{0};
     SubTaskQueue                subtasks_;
 
 protected:
+    StorageEnv*                     env_{nullptr};
     TaskContext                     ctx_;
     std::atomic<cpp2::ErrorCode>    rc_{cpp2::ErrorCode::SUCCEEDED};
 };
 
 class AdminTaskFactory {
 public:
-    static std::shared_ptr<AdminTask> createAdminTask(TaskContext&& ctx);
+    static std::shared_ptr<AdminTask> createAdminTask(StorageEnv* env, TaskContext&& ctx);
 };
 
 }  // namespace storage
@@ -71,6 +71,17 @@ cpp2::ErrorCode AdminTaskManager::cancelTask(int jobId, int taskId) {
     return ret;
 }
 
+ErrorOr<cpp2::ErrorCode, std::pair<size_t, size_t>>
+AdminTaskManager::taskProgress(int jobId, int taskId) {
+    TaskHandle handle = std::make_pair(jobId, taskId);
+    auto it = tasks_.find(handle);
+    if (it == tasks_.cend()) {
+        return cpp2::ErrorCode::E_KEY_NOT_FOUND;
+    }
+    auto total = it->second->totalSubTask_.load();
+    return std::make_pair(total - it->second->unFinishedSubTask_.load(), total);
+}
+
 void AdminTaskManager::shutdown() {
     LOG(INFO) << "enter AdminTaskManager::shutdown()";
     shutdown_ = true;
@@ -129,6 +140,7 @@ void AdminTaskManager::schedule() {
         auto subTaskConcurrency = std::min(task->getConcurrentReq(),
                                            static_cast<size_t>(FLAGS_max_concurrent_subtasks));
         subTaskConcurrency = std::min(subTaskConcurrency, subTasks.size());
+        task->totalSubTask_ = subTasks.size();
         task->unFinishedSubTask_ = subTasks.size();
 
         FLOG_INFO("run task(%d, %d), %zu subtasks in %zu thread",
@@ -156,12 +168,16 @@ void AdminTaskManager::runSubTask(TaskHandle handle) {
             task->subTaskFinish(rc);
         }
 
-        if (0 == --task->unFinishedSubTask_) {
+        auto unFinished = --task->unFinishedSubTask_;
+        if (0 == unFinished) {
             FLOG_INFO("task(%d, %d) finished", task->getJobId(),
                                                 task->getTaskId());
             task->finish();
             tasks_.erase(handle);
         } else {
+            FLOG_INFO("task(%d, %d) %zu/%zu sub tasks finished",
+                      task->getJobId(), task->getTaskId(),
+                      task->totalSubTask_ - unFinished, task->totalSubTask_.load());
             pool_->add(std::bind(&AdminTaskManager::runSubTask, this, handle));
         }
     } else {
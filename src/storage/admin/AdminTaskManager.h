@@ -44,6 +44,9 @@ public:
     cpp2::ErrorCode cancelJob(int jobId);
     cpp2::ErrorCode cancelTask(int jobId, int taskId = -1);
 
+    // The number of finished sub tasks and all sub tasks of a running task
+    ErrorOr<cpp2::ErrorCode, std::pair<size_t, size_t>> taskProgress(int jobId, int taskId);
+
     bool init();
 
     void shutdown();
@@ -27,7 +27,7 @@ void AdminTaskProcessor::process(const cpp2::AddAdminTaskRequest& req) {
     };
 
     TaskContext ctx(req, store, cb);
-    auto task = AdminTaskFactory::createAdminTask(std::move(ctx));
+    auto task = AdminTaskFactory::createAdminTask(env_, std::move(ctx));
     if (task) {
         runDirectly = false;
         taskManager->addAsyncTask(task);
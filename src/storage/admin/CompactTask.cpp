@@ -7,6 +7,10 @@
 #include "storage/admin/CompactTask.h"
 #include "storage/admin/TaskUtils.h"
 #include "common/base/Logging.h"
+#include "common/time/WallClock.h"
+#include "storage/StorageFlags.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
 
 namespace nebula {
 namespace storage {
@@ -28,16 +32,113 @@ CompactTask::genSubTasks() {
     auto space = nebula::value(errOrSpace);
 
     using FuncObj = std::function<kvstore::ResultCode()>;
-    for (auto& engine : space->engines_) {
-        FuncObj obj = std::bind(&CompactTask::subTask, this, engine.get());
-        ret.emplace_back(obj);
+    auto* parts = ctx_.parameters_.get_parts();
+    if (parts == nullptr || parts->empty()) {
+        for (auto& engine : space->engines_) {
+            FuncObj obj = std::bind(&CompactTask::subTask, this, engine.get());
+            ret.emplace_back(obj);
+        }
+        return ret;
+    }
+
+    for (auto part : *parts) {
+        auto errOrPart = store->part(ctx_.spaceId_, part);
+        if (!ok(errOrPart)) {
+            LOG(ERROR) << "Space " << ctx_.spaceId_ << " part " << part << " not found";
+            return toStorageErr(error(errOrPart));
+        }
+        auto* engine = nebula::value(errOrPart)->engine();
+        auto prefixes = rangePrefixes(part);
+        if (!ok(prefixes)) {
+            return error(prefixes);
+        }
+        for (auto& prefix : nebula::value(prefixes)) {
+            FuncObj obj = std::bind(&CompactTask::rangeSubTask, this, engine, part, prefix);
+            ret.emplace_back(obj);
+        }
     }
+    setConcurrentReq(FLAGS_compact_range_concurrency);
+    startMs_ = time::WallClock::fastNowInMilliSec();
     return ret;
 }
 
+ErrorOr<cpp2::ErrorCode, std::vector<std::string>>
+CompactTask::rangePrefixes(PartitionID part) {
+    std::vector<std::string> prefixes;
+    auto* paras = ctx_.parameters_.get_task_specfic_paras();
+    if (paras == nullptr || paras->empty()) {
+        prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kData));
+        prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kEdge));
+        prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kIndex));
+        prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kUUID));
+        return prefixes;
+    }
+    for (auto& para : *paras) {
+        if (para == "data") {
+            prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kData));
+            prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kEdge));
+        } else if (para == "index") {
+            prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kIndex));
+        } else if (folly::StringPiece(para).startsWith("index:")) {
+            auto indexId = folly::tryTo<IndexID>(para.substr(strlen("index:")));
+            if (!indexId.hasValue()) {
+                LOG(ERROR) << "Invalid index to compact: " << para;
+                return cpp2::ErrorCode::E_INVALID_TASK_PARA;
+            }
+            prefixes.emplace_back(IndexKeyUtils::indexPrefix(part, indexId.value()));
+        } else {
+            LOG(ERROR) << "Invalid range to compact: " << para;
+            return cpp2::ErrorCode::E_INVALID_TASK_PARA;
+        }
+    }
+    return prefixes;
+}
+
 kvstore::ResultCode CompactTask::subTask(kvstore::KVEngine* engine) {
     return engine->compact();
 }
 
+kvstore::ResultCode CompactTask::rangeSubTask(kvstore::KVEngine* engine,
+                                              PartitionID part,
+                                              const std::string& prefix) {
+    // The prefix is never all 0xFF, it starts with the key type
+    std::string end = prefix;
+    while (static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+
+    auto bytes = engine->approximateSize(prefix, end);
+    auto startTime = time::WallClock::fastNowInMilliSec();
+    auto code = engine->compactRange(prefix, end);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Compact space " << ctx_.spaceId_ << " part " << part << " failed";
+        return code;
+    }
+    FLOG_INFO("task(%d, %d) compacted %ld bytes of space %d part %d in %ldms",
+              ctx_.jobId_, ctx_.taskId_, bytes, ctx_.spaceId_, part,
+              time::WallClock::fastNowInMilliSec() - startTime);
+    throttle(bytes);
+    return kvstore::ResultCode::SUCCEEDED;
+}
+
+void CompactTask::throttle(int64_t bytes) {
+    if (FLAGS_compact_range_rate_limit_mb <= 0) {
+        return;
+    }
+    auto total = compactedBytes_.fetch_add(bytes) + bytes;
+    auto rate = static_cast<int64_t>(FLAGS_compact_range_rate_limit_mb) * 1024 * 1024;
+    auto expectedMs = total * 1000 / rate;
+    // Wake up from time to time, in case the task is cancelled
+    while (status() == cpp2::ErrorCode::SUCCEEDED) {
+        auto elapsedMs = time::WallClock::fastNowInMilliSec() - startMs_;
+        if (elapsedMs >= expectedMs) {
+            break;
+        }
+        std::this_thread::sleep_for(
+            std::chrono::milliseconds(std::min<int64_t>(expectedMs - elapsedMs, 100)));
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
@@ -8,6 +8,7 @@
 #define STORAGE_ADMIN_COMPACTTASK_H_
 
 #include "common/thrift/ThriftTypes.h"
+#include <gtest/gtest_prod.h>
 #include "kvstore/KVEngine.h"
 #include "kvstore/NebulaStore.h"
 #include "storage/admin/AdminTask.h"
@@ -15,7 +16,17 @@
 namespace nebula {
 namespace storage {
 
+/**
+ * Compact the whole engines of a space, or only the key ranges of the given parts.
+ *
+ * For the parts, the task specific parameters choose the ranges in each part:
+ * "data", "index", or "index:<index id>" for the keys of one index. All keys of the
+ * part are compacted if none is given. The ranges are compacted concurrently up to
+ * FLAGS_compact_range_concurrency, at the rate of FLAGS_compact_range_rate_limit_mb.
+ * */
 class CompactTask : public AdminTask {
+    FRIEND_TEST(CompactTaskTest, RangePrefixesTest);
+    FRIEND_TEST(CompactTaskTest, ThrottleTest);
     using ResultCode = nebula::kvstore::ResultCode;
 
 public:
@@ -23,6 +34,22 @@ public:
 
     ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
     ResultCode subTask(nebula::kvstore::KVEngine* engine);
+
+    // Compact the keys with the prefix in the engine
+    ResultCode rangeSubTask(nebula::kvstore::KVEngine* engine,
+                            PartitionID part,
+                            const std::string& prefix);
+
+private:
+    // The prefixes of the ranges to compact in a part
+    ErrorOr<cpp2::ErrorCode, std::vector<std::string>> rangePrefixes(PartitionID part);
+
+    // Sleep if the data compacted is more than the rate limit allows
+    void throttle(int64_t bytes);
+
+private:
+    int64_t                 startMs_{0};
+    std::atomic<int64_t>    compactedBytes_{0};
 };
 
 }  // namespace storage
@@ -0,0 +1,249 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/admin/ConvertEdgeKeyTask.h"
+#include <folly/synchronization/Baton.h>
+#include "storage/StorageFlags.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+// The first key after all keys with the prefix, the prefix starts with the key type,
+// so it is never all 0xFF
+std::string prefixEnd(const std::string& prefix) {
+    std::string end = prefix;
+    while (static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    return end;
+}
+
+// The edges could only be changing by a few in-place updates, so there are not many passes
+constexpr int32_t kMaxPasses = 10;
+
+}  // namespace
+
+bool ConvertEdgeKeyTask::isConvertEdgeKey(const cpp2::TaskPara& para) {
+    auto* paras = para.get_task_specfic_paras();
+    return paras != nullptr && paras->size() == 1 && paras->front() == "edge_key";
+}
+
+ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>>
+ConvertEdgeKeyTask::genSubTasks() {
+    std::vector<AdminSubTask> ret;
+    if (!ctx_.store_) {
+        return ret;
+    }
+
+    space_ = ctx_.spaceId_;
+    to_ = FLAGS_separate_edge_key ? NebulaKeyType::kEdge : NebulaKeyType::kData;
+    from_ = to_ == NebulaKeyType::kEdge ? NebulaKeyType::kData : NebulaKeyType::kEdge;
+    CHECK_NOTNULL(env_->schemaMan_);
+    auto vIdLenRet = env_->schemaMan_->getSpaceVidLen(space_);
+    if (!vIdLenRet.ok()) {
+        LOG(ERROR) << vIdLenRet.status();
+        return cpp2::ErrorCode::E_INVALID_SPACEVIDLEN;
+    }
+    vIdLen_ = vIdLenRet.value();
+
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(ctx_.store_);
+    CHECK_NOTNULL(store);
+    auto errOrSpace = store->space(space_);
+    if (!ok(errOrSpace)) {
+        return toStorageErr(error(errOrSpace));
+    }
+    auto space = nebula::value(errOrSpace);
+    for (auto& part : space->parts_) {
+        std::function<cpp2::ErrorCode()> task =
+            std::bind(&ConvertEdgeKeyTask::invoke, this, part.first, part.second);
+        ret.emplace_back(task);
+    }
+    return ret;
+}
+
+cpp2::ErrorCode ConvertEdgeKeyTask::invoke(PartitionID part,
+                                           std::shared_ptr<kvstore::Part> partPtr) {
+    // The keys are moved by raft, so only the leader scans the edges
+    if (partPtr->isLeader()) {
+        auto code = convert(part);
+        if (code != cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Convert edge keys of space " << space_ << " part " << part
+                       << " failed";
+            return code;
+        }
+    }
+    // Drop the old keys on every replica to reclaim the space
+    auto start = NebulaKeyUtils::partPrefix(part, from_);
+    auto code = partPtr->engine()->compactRange(start, prefixEnd(start));
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Compact space " << space_ << " part " << part << " failed";
+        return toStorageErr(code);
+    }
+    LOG(INFO) << "Finish converting edge keys of space " << space_ << " part " << part;
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode ConvertEdgeKeyTask::convert(PartitionID part) {
+    // The new edges are written with the target type from now on, and the edges of both
+    // types are read until the part is converted
+    EdgeKeyLayout layout;
+    layout.type = to_;
+    layout.converted = false;
+    auto code = putLayout(part, layout);
+    if (code != cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+
+    // An edge skipped because it has been changed since the scan is left to the next pass
+    size_t moved = 0;
+    for (int32_t pass = 0; pass < kMaxPasses; pass++) {
+        size_t found = 0;
+        code = moveEdges(part, &found, &moved);
+        if (code != cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+        if (found == 0) {
+            LOG(INFO) << "Moved " << moved << " edges of space " << space_ << " part " << part
+                      << " in " << pass << " passes";
+            layout.converted = true;
+            return putLayout(part, layout);
+        }
+    }
+    LOG(ERROR) << "The edges of space " << space_ << " part " << part
+               << " are still changing after " << kMaxPasses << " passes";
+    return cpp2::ErrorCode::E_RETRY_EXHAUSTED;
+}
+
+cpp2::ErrorCode ConvertEdgeKeyTask::moveEdges(PartitionID part, size_t* found, size_t* moved) {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto prefix = NebulaKeyUtils::partPrefix(part, from_);
+    auto code = ctx_.store_->prefix(space_, part, prefix, &iter);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        return toStorageErr(code);
+    }
+
+    std::vector<kvstore::KV> edges;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        if (!NebulaKeyUtils::isEdge(vIdLen_, key)) {
+            continue;
+        }
+        edges.emplace_back(key.str(), iter->val().str());
+        if (edges.size() >= static_cast<size_t>(FLAGS_convert_edge_key_batch_size)) {
+            if (status() != cpp2::ErrorCode::SUCCEEDED) {
+                return status();
+            }
+            *found += edges.size();
+            auto ret = moveBatch(part, &edges, moved);
+            if (ret != cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+        }
+    }
+    *found += edges.size();
+    return moveBatch(part, &edges, moved);
+}
+
+cpp2::ErrorCode ConvertEdgeKeyTask::moveBatch(PartitionID part,
+                                              std::vector<kvstore::KV>* edges,
+                                              size_t* moved) {
+    if (edges->empty()) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    // The batch is built in the atomic op, so the edges are checked against all writes
+    // committed before it, and nobody could write them in between
+    size_t batchMoved = 0;
+    auto readRet = kvstore::ResultCode::SUCCEEDED;
+    auto op = [&, this] () -> folly::Optional<std::string> {
+        kvstore::BatchHolder batchHolder;
+        for (auto& edge : *edges) {
+            std::string val;
+            auto ret = ctx_.store_->get(space_, part, edge.first, &val);
+            if (ret == kvstore::ResultCode::ERR_KEY_NOT_FOUND ||
+                (ret == kvstore::ResultCode::SUCCEEDED && val != edge.second)) {
+                // Removed or changed since the scan
+                continue;
+            } else if (ret != kvstore::ResultCode::SUCCEEDED) {
+                readRet = ret;
+                return folly::none;
+            }
+            // The latest version of the edge in the target type, which is written after
+            // the layout is changed, unless it has been moved already
+            auto target = NebulaKeyUtils::toEdgeKeyType(edge.first, to_);
+            auto versions = NebulaKeyUtils::keyWithNoVersion(target).str();
+            std::unique_ptr<kvstore::KVIterator> iter;
+            ret = ctx_.store_->prefix(space_, part, versions, &iter);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                readRet = ret;
+                return folly::none;
+            }
+            // The newer versions are less, and the same version is the target itself
+            auto targetKey = folly::StringPiece(target).subpiece(1);
+            if (!iter->valid() || iter->key().subpiece(1) > targetKey) {
+                batchHolder.put(std::move(target), std::move(val));
+                batchMoved++;
+            }
+            // Otherwise the edge is stale, there is the same or a newer version in the target
+            // type, so it is not moved but removed
+            batchHolder.remove(std::string(edge.first));
+        }
+        if (batchHolder.getBatch().empty()) {
+            return folly::none;
+        }
+        return kvstore::encodeBatchValue(batchHolder.getBatch());
+    };
+
+    folly::Baton<true, std::atomic> baton;
+    auto ret = kvstore::ResultCode::SUCCEEDED;
+    ctx_.store_->asyncAtomicOp(space_, part, op,
+                               [&ret, &baton] (kvstore::ResultCode code) {
+                                   ret = code;
+                                   baton.post();
+                               });
+    baton.wait();
+    edges->clear();
+    if (ret == kvstore::ResultCode::ERR_ATOMIC_OP_FAILED) {
+        // Nothing to write, or the read failed in the op
+        ret = readRet;
+    }
+    if (ret == kvstore::ResultCode::SUCCEEDED) {
+        *moved += batchMoved;
+    }
+    return toStorageErr(ret);
+}
+
+cpp2::ErrorCode ConvertEdgeKeyTask::putLayout(PartitionID part, const EdgeKeyLayout& layout) {
+    // The layout is replicated in the order of the logs, the parts apply it on commit
+    kvstore::BatchHolder batchHolder;
+    batchHolder.put(NebulaKeyUtils::systemEdgeKeyLayoutKey(part),
+                    NebulaKeyUtils::encodeEdgeKeyLayout(layout));
+    auto log = kvstore::encodeBatchValue(batchHolder.getBatch());
+
+    folly::Baton<true, std::atomic> baton;
+    auto ret = kvstore::ResultCode::SUCCEEDED;
+    ctx_.store_->asyncAtomicOp(space_, part,
+                               [log = std::move(log)] () mutable
+                               -> folly::Optional<std::string> {
+                                   return std::move(log);
+                               },
+                               [&ret, &baton] (kvstore::ResultCode code) {
+                                   ret = code;
+                                   baton.post();
+                               });
+    baton.wait();
+    if (ret != kvstore::ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Put the edge key layout of space " << space_ << " part " << part
+                   << " failed";
+    }
+    return toStorageErr(ret);
+}
+
+}  // namespace storage
+}  // namespace nebula
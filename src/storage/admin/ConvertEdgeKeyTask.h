@@ -0,0 +1,65 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_ADMIN_CONVERTEDGEKEYTASK_H_
+#define STORAGE_ADMIN_CONVERTEDGEKEYTASK_H_
+
+#include "common/base/Base.h"
+#include "kvstore/LogEncoder.h"
+#include "kvstore/Part.h"
+#include "storage/admin/AdminTask.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Move the edges of a space to the key type of the current layout, each local part is a
+ * sub task.
+ *
+ * It is started by meta as a compaction job with the task specific parameter "edge_key",
+ * the target type is FLAGS_separate_edge_key of the host. The leader of each part first
+ * replicates the layout of the part as not converted, so the new edges are written with
+ * the target type and the edges of both types are read. Then it moves the edges of the
+ * other type in batches, each batch is built in an atomic op, an edge changed since the
+ * scan is left to the next pass, and an edge with the same or a newer version in the
+ * target type is only removed. At last the layout is marked as converted, and the range
+ * of the old keys is compacted on every replica.
+ * */
+class ConvertEdgeKeyTask : public AdminTask {
+public:
+    ConvertEdgeKeyTask(StorageEnv* env, TaskContext&& ctx)
+        : AdminTask(env, std::move(ctx)) {}
+
+    // Whether the task of compaction is for converting the edge keys
+    static bool isConvertEdgeKey(const cpp2::TaskPara& para);
+
+    ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
+
+private:
+    cpp2::ErrorCode invoke(PartitionID part, std::shared_ptr<kvstore::Part> partPtr);
+
+    // Convert the edges of the part, only on the leader
+    cpp2::ErrorCode convert(PartitionID part);
+
+    // One pass over the edges of the other type, the edges found are returned by found
+    cpp2::ErrorCode moveEdges(PartitionID part, size_t* found, size_t* moved);
+
+    cpp2::ErrorCode moveBatch(PartitionID part, std::vector<kvstore::KV>* edges, size_t* moved);
+
+    cpp2::ErrorCode putLayout(PartitionID part, const EdgeKeyLayout& layout);
+
+private:
+    GraphSpaceID            space_;
+    size_t                  vIdLen_;
+    // The key type of the edges to move, and the one to move them to
+    NebulaKeyType           from_;
+    NebulaKeyType           to_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_ADMIN_CONVERTEDGEKEYTASK_H_
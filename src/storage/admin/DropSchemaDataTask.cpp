@@ -0,0 +1,290 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/admin/DropSchemaDataTask.h"
+#include <folly/synchronization/Baton.h>
+#include "kvstore/LogEncoder.h"
+#include "storage/StorageFlags.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+// The first key after all keys with the prefix, the prefix starts with the key type,
+// so it is never all 0xFF
+std::string prefixEnd(const std::string& prefix) {
+    std::string end = prefix;
+    while (static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    return end;
+}
+
+// Whether the part may have the edges of the key type
+bool hasEdgesOfType(GraphSpaceID space, PartitionID part, NebulaKeyType type) {
+    auto types = NebulaKeyUtils::edgeKeyTypes(space, part);
+    return std::find(types.begin(), types.end(), type) != types.end();
+}
+
+}  // namespace
+
+bool DropSchemaDataTask::isDropSchemaData(const cpp2::TaskPara& para) {
+    auto* paras = para.get_task_specfic_paras();
+    if (paras == nullptr || paras->empty()) {
+        return false;
+    }
+    folly::StringPiece first(paras->front());
+    return first.startsWith("tag:") || first.startsWith("edge:");
+}
+
+cpp2::ErrorCode DropSchemaDataTask::parseParas() {
+    for (auto& para : *ctx_.parameters_.get_task_specfic_paras()) {
+        folly::StringPiece piece(para);
+        if (piece.removePrefix("tag:")) {
+            auto tagId = folly::tryTo<TagID>(piece);
+            if (!tagId.hasValue()) {
+                LOG(ERROR) << "Invalid tag to drop: " << para;
+                return cpp2::ErrorCode::E_INVALID_TASK_PARA;
+            }
+            tags_.emplace_back(tagId.value());
+        } else if (piece.removePrefix("edge:")) {
+            auto edgeType = folly::tryTo<EdgeType>(piece);
+            if (!edgeType.hasValue()) {
+                LOG(ERROR) << "Invalid edge to drop: " << para;
+                return cpp2::ErrorCode::E_INVALID_TASK_PARA;
+            }
+            edges_.emplace_back(std::abs(edgeType.value()));
+        } else {
+            LOG(ERROR) << "Invalid schema to drop: " << para;
+            return cpp2::ErrorCode::E_INVALID_TASK_PARA;
+        }
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>>
+DropSchemaDataTask::genSubTasks() {
+    std::vector<AdminSubTask> ret;
+    if (!ctx_.store_) {
+        return ret;
+    }
+
+    space_ = ctx_.spaceId_;
+    auto code = parseParas();
+    if (code != cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    CHECK_NOTNULL(env_->schemaMan_);
+    auto vIdLenRet = env_->schemaMan_->getSpaceVidLen(space_);
+    if (!vIdLenRet.ok()) {
+        LOG(ERROR) << vIdLenRet.status();
+        return cpp2::ErrorCode::E_INVALID_SPACEVIDLEN;
+    }
+    vIdLen_ = vIdLenRet.value();
+
+    // The reads skip the rows from now on, before they are removed
+    for (auto tagId : tags_) {
+        DroppedSchemas::instance()->addTag(space_, tagId);
+    }
+    for (auto edgeType : edges_) {
+        DroppedSchemas::instance()->addEdge(space_, edgeType);
+    }
+
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(ctx_.store_);
+    CHECK_NOTNULL(store);
+    auto errOrSpace = store->space(space_);
+    if (!ok(errOrSpace)) {
+        return toStorageErr(error(errOrSpace));
+    }
+    auto space = nebula::value(errOrSpace);
+    for (auto& part : space->parts_) {
+        std::function<cpp2::ErrorCode()> task =
+            std::bind(&DropSchemaDataTask::invoke, this, part.first, part.second);
+        ret.emplace_back(task);
+    }
+    return ret;
+}
+
+void DropSchemaDataTask::finish(cpp2::ErrorCode rc) {
+    // Whether the task succeeded or not, the schemas are gone in meta, the rows left are
+    // dropped by the compaction filter, so the set does not grow with every dropped schema
+    for (auto tagId : tags_) {
+        DroppedSchemas::instance()->removeTag(space_, tagId);
+    }
+    for (auto edgeType : edges_) {
+        DroppedSchemas::instance()->removeEdge(space_, edgeType);
+    }
+    AdminTask::finish(rc);
+}
+
+cpp2::ErrorCode DropSchemaDataTask::invoke(PartitionID part,
+                                           std::shared_ptr<kvstore::Part> partPtr) {
+    // The removal is replicated by raft, so only the leader scans the rows
+    if (partPtr->isLeader()) {
+        auto code = removeRows(part);
+        if (code != cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Remove dropped rows of space " << space_ << " part " << part
+                       << " failed";
+            return code;
+        }
+    }
+    // The compaction filter drops the rows not removed yet on the followers as well
+    std::vector<std::string> prefixes{NebulaKeyUtils::partPrefix(part, NebulaKeyType::kData)};
+    if (hasEdgesOfType(space_, part, NebulaKeyType::kEdge)) {
+        prefixes.emplace_back(NebulaKeyUtils::partPrefix(part, NebulaKeyType::kEdge));
+    }
+    for (auto& start : prefixes) {
+        auto code = partPtr->engine()->compactRange(start, prefixEnd(start));
+        if (code != kvstore::ResultCode::SUCCEEDED) {
+            LOG(ERROR) << "Compact space " << space_ << " part " << part << " failed";
+            return toStorageErr(code);
+        }
+    }
+    LOG(INFO) << "Finish dropping data of space " << space_ << " part " << part;
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode DropSchemaDataTask::removeRows(PartitionID part) {
+    std::vector<std::pair<std::string, std::string>> ranges;
+    size_t removed = 0;
+    // Until the edge keys of the part are converted, the edges may be of both key types
+    auto code = removeRows(part,
+                           NebulaKeyUtils::partPrefix(part, NebulaKeyType::kData),
+                           true,
+                           hasEdgesOfType(space_, part, NebulaKeyType::kData),
+                           &ranges,
+                           &removed);
+    if (code == cpp2::ErrorCode::SUCCEEDED && hasEdgesOfType(space_, part, NebulaKeyType::kEdge)) {
+        // The separated edges are after all vertices of the part
+        code = removeRows(part,
+                          NebulaKeyUtils::partPrefix(part, NebulaKeyType::kEdge),
+                          false,
+                          true,
+                          &ranges,
+                          &removed);
+    }
+    if (code != cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    removed += ranges.size();
+    auto ret = removeRanges(part, &ranges);
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        return ret;
+    }
+    LOG(INFO) << "Removed " << removed << " ranges of dropped rows in space " << space_
+              << " part " << part;
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode DropSchemaDataTask::removeRows(
+        PartitionID part,
+        const std::string& prefix,
+        bool tags,
+        bool edges,
+        std::vector<std::pair<std::string, std::string>>* ranges,
+        size_t* removed) {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = ctx_.store_->prefix(space_, part, prefix, &iter);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        return toStorageErr(code);
+    }
+
+    while (iter->valid()) {
+        if (status() != cpp2::ErrorCode::SUCCEEDED) {
+            return status();
+        }
+        auto key = iter->key();
+        VertexID vId;
+        if (NebulaKeyUtils::isVertex(vIdLen_, key)) {
+            vId = NebulaKeyUtils::getVertexId(vIdLen_, key).str();
+        } else if (NebulaKeyUtils::isEdge(vIdLen_, key)) {
+            vId = NebulaKeyUtils::getSrcId(vIdLen_, key).str();
+        } else {
+            iter->next();
+            continue;
+        }
+        collectRanges(iter.get(), part, vId, tags, edges, ranges);
+        if (ranges->size() >= static_cast<size_t>(FLAGS_drop_data_batch_ranges)) {
+            *removed += ranges->size();
+            auto ret = removeRanges(part, ranges);
+            if (ret != cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+        }
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+void DropSchemaDataTask::collectRanges(kvstore::KVIterator* iter,
+                                       PartitionID part,
+                                       const VertexID& vId,
+                                       bool tags,
+                                       bool edges,
+                                       std::vector<std::pair<std::string, std::string>>* ranges) {
+    // The prefixes of the edges are of the key type of the rows iterated
+    auto keyType = NebulaKeyUtils::getKeyType(iter->key());
+    auto collect = [&] (std::string rangePrefix) {
+        iter->seek(rangePrefix);
+        if (iter->valid() && iter->key().startsWith(rangePrefix)) {
+            auto end = prefixEnd(rangePrefix);
+            ranges->emplace_back(std::move(rangePrefix), std::move(end));
+        }
+    };
+    if (tags) {
+        for (auto tagId : tags_) {
+            collect(NebulaKeyUtils::vertexPrefix(vIdLen_, part, vId, tagId));
+        }
+    }
+    if (edges) {
+        for (auto edgeType : edges_) {
+            collect(NebulaKeyUtils::toEdgeKeyType(
+                NebulaKeyUtils::edgePrefix(vIdLen_, part, vId, edgeType), keyType));
+            collect(NebulaKeyUtils::toEdgeKeyType(
+                NebulaKeyUtils::edgePrefix(vIdLen_, part, vId, -edgeType), keyType));
+        }
+    }
+    // Jump over the other rows of the vertex
+    if (tags) {
+        iter->seek(prefixEnd(NebulaKeyUtils::vertexPrefix(vIdLen_, part, vId)));
+    } else {
+        iter->seek(prefixEnd(NebulaKeyUtils::toEdgeKeyType(
+            NebulaKeyUtils::edgePrefix(vIdLen_, part, vId), keyType)));
+    }
+}
+
+cpp2::ErrorCode DropSchemaDataTask::removeRanges(
+        PartitionID part,
+        std::vector<std::pair<std::string, std::string>>* ranges) {
+    if (ranges->empty()) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    kvstore::BatchHolder batchHolder;
+    for (auto& range : *ranges) {
+        batchHolder.rangeRemove(std::move(range.first), std::move(range.second));
+    }
+    ranges->clear();
+    auto log = kvstore::encodeBatchValue(batchHolder.getBatch());
+
+    folly::Baton<true, std::atomic> baton;
+    auto ret = kvstore::ResultCode::SUCCEEDED;
+    ctx_.store_->asyncAtomicOp(space_, part,
+                               [log = std::move(log)] () mutable
+                               -> folly::Optional<std::string> {
+                                   return std::move(log);
+                               },
+                               [&ret, &baton] (kvstore::ResultCode code) {
+                                   ret = code;
+                                   baton.post();
+                               });
+    baton.wait();
+    return toStorageErr(ret);
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,77 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_ADMIN_DROPSCHEMADATATASK_H_
+#define STORAGE_ADMIN_DROPSCHEMADATATASK_H_
+
+#include "common/base/Base.h"
+#include "kvstore/Part.h"
+#include "storage/admin/AdminTask.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Remove the rows of the tags and edge types dropped in meta, each local part is a sub task.
+ *
+ * It is started by meta as a compaction job, whose task specific parameters are the dropped
+ * schemas, as "tag:<tag id>" or "edge:<edge type>". The schemas are marked as dropped first,
+ * so the reads skip their rows at once. Then the leader of each part removes the rows by
+ * range: all versions of a tag of a vertex, and all edges of a type of a source vertex are
+ * contiguous, so they are found by seeking vertex by vertex and removed with DeleteRange.
+ * When the edges are separated, the vertices and the edges are walked in two passes.
+ * At last the data range of the part is compacted on every replica to reclaim the space,
+ * and the schemas are unmarked when the task finishes.
+ * */
+class DropSchemaDataTask : public AdminTask {
+public:
+    DropSchemaDataTask(StorageEnv* env, TaskContext&& ctx)
+        : AdminTask(env, std::move(ctx)) {}
+
+    // Whether the task of compaction is for the data of dropped schemas
+    static bool isDropSchemaData(const cpp2::TaskPara& para);
+
+    ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
+
+    void finish(cpp2::ErrorCode rc) override;
+
+private:
+    cpp2::ErrorCode parseParas();
+
+    cpp2::ErrorCode invoke(PartitionID part, std::shared_ptr<kvstore::Part> partPtr);
+
+    // Remove the rows of the dropped schemas in the part, only on the leader
+    cpp2::ErrorCode removeRows(PartitionID part);
+
+    // Remove the rows with the prefix, the tags and the edges are chosen by the layout
+    cpp2::ErrorCode removeRows(PartitionID part,
+                               const std::string& prefix,
+                               bool tags,
+                               bool edges,
+                               std::vector<std::pair<std::string, std::string>>* ranges,
+                               size_t* removed);
+
+    // The ranges of the rows of the dropped schemas of a vertex, the iterator is moved
+    void collectRanges(kvstore::KVIterator* iter,
+                       PartitionID part,
+                       const VertexID& vId,
+                       bool tags,
+                       bool edges,
+                       std::vector<std::pair<std::string, std::string>>* ranges);
+
+    cpp2::ErrorCode removeRanges(PartitionID part,
+                                 std::vector<std::pair<std::string, std::string>>* ranges);
+
+private:
+    GraphSpaceID            space_;
+    size_t                  vIdLen_;
+    std::vector<TagID>      tags_;
+    std::vector<EdgeType>   edges_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_ADMIN_DROPSCHEMADATATASK_H_
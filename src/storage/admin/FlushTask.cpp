@@ -5,6 +5,7 @@
  */
 
 #include "storage/admin/FlushTask.h"
+#include "storage/admin/TaskUtils.h"
 #include "common/base/Logging.h"
 
 namespace nebula {
@@ -26,8 +27,29 @@ FlushTask::genSubTasks() {
 
     auto space = nebula::value(errOrSpace);
 
-    ret.emplace_back([space = space](){
+    // RocksDB could only flush the whole memtable, so flush the engines hosting the parts
+    std::vector<kvstore::KVEngine*> engines;
+    auto* parts = ctx_.parameters_.get_parts();
+    if (parts == nullptr || parts->empty()) {
         for (auto& engine : space->engines_) {
+            engines.emplace_back(engine.get());
+        }
+    } else {
+        for (auto part : *parts) {
+            auto errOrPart = store->part(ctx_.spaceId_, part);
+            if (!ok(errOrPart)) {
+                LOG(ERROR) << "Space " << ctx_.spaceId_ << " part " << part << " not found";
+                return toStorageErr(error(errOrPart));
+            }
+            auto* engine = nebula::value(errOrPart)->engine();
+            if (std::find(engines.begin(), engines.end(), engine) == engines.end()) {
+                engines.emplace_back(engine);
+            }
+        }
+    }
+
+    ret.emplace_back([space = space, engines = std::move(engines)](){
+        for (auto* engine : engines) {
             auto code = engine->flush();
             if (code != kvstore::ResultCode::SUCCEEDED) {
                 return code;
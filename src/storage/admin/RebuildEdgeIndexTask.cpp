@@ -0,0 +1,76 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/admin/RebuildEdgeIndexTask.h"
+#include "codec/RowReader.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+StatusOr<IndexItems> RebuildEdgeIndexTask::getIndexes(GraphSpaceID space) {
+    return env_->indexMan_->getEdgeIndexes(space);
+}
+
+int32_t RebuildEdgeIndexTask::getSchemaId(const meta::cpp2::IndexItem& item) {
+    return item.get_schema_id().get_edge_type();
+}
+
+std::string RebuildEdgeIndexTask::rowPrefix(PartitionID part) {
+    return NebulaKeyUtils::edgePartPrefix(space_, part);
+}
+
+kvstore::ResultCode RebuildEdgeIndexTask::rowIterator(PartitionID part,
+                                                      kvstore::KVEngine* engine,
+                                                      const std::string& prefix,
+                                                      const void* snapshot,
+                                                      std::unique_ptr<kvstore::KVIterator>* iter) {
+    // The edges of both key types are read until the edge keys of the part are converted
+    return CommonUtils::edgePrefix(engine, snapshot, space_, part, prefix, iter);
+}
+
+bool RebuildEdgeIndexTask::isIndexedRow(folly::StringPiece key) {
+    // Only the out edges are indexed, the in edges have negative types
+    return NebulaKeyUtils::isEdge(vIdLen_, key) &&
+           schemaIds_.count(NebulaKeyUtils::getEdgeType(vIdLen_, key));
+}
+
+void RebuildEdgeIndexTask::buildIndexKeys(PartitionID part,
+                                          folly::StringPiece key,
+                                          folly::StringPiece val,
+                                          std::vector<std::string>* indexKeys) {
+    auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+    std::unique_ptr<RowReader> reader;
+    for (auto& item : items_) {
+        if (item->get_schema_id().get_edge_type() != edgeType) {
+            continue;
+        }
+        if (reader == nullptr) {
+            reader = RowReader::getEdgePropReader(env_->schemaMan_, space_, edgeType, val);
+            if (reader == nullptr) {
+                LOG(ERROR) << "Bad format row";
+                return;
+            }
+        }
+        std::vector<Value::Type> colsType;
+        auto values = IndexKeyUtils::collectIndexValues(reader.get(),
+                                                        item->get_fields(),
+                                                        colsType);
+        if (!values.ok()) {
+            continue;
+        }
+        indexKeys->emplace_back(IndexKeyUtils::edgeIndexKey(
+            vIdLen_, part, item->get_index_id(),
+            NebulaKeyUtils::getSrcId(vIdLen_, key).str(),
+            NebulaKeyUtils::getRank(vIdLen_, key),
+            NebulaKeyUtils::getDstId(vIdLen_, key).str(),
+            values.value(), colsType));
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,43 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_ADMIN_REBUILDEDGEINDEXTASK_H_
+#define STORAGE_ADMIN_REBUILDEDGEINDEXTASK_H_
+
+#include "storage/admin/RebuildIndexTask.h"
+
+namespace nebula {
+namespace storage {
+
+class RebuildEdgeIndexTask : public RebuildIndexTask {
+public:
+    RebuildEdgeIndexTask(StorageEnv* env, TaskContext&& ctx)
+        : RebuildIndexTask(env, std::move(ctx)) {}
+
+private:
+    StatusOr<IndexItems> getIndexes(GraphSpaceID space) override;
+
+    int32_t getSchemaId(const meta::cpp2::IndexItem& item) override;
+
+    std::string rowPrefix(PartitionID part) override;
+
+    kvstore::ResultCode rowIterator(PartitionID part,
+                                    kvstore::KVEngine* engine,
+                                    const std::string& prefix,
+                                    const void* snapshot,
+                                    std::unique_ptr<kvstore::KVIterator>* iter) override;
+
+    bool isIndexedRow(folly::StringPiece key) override;
+
+    void buildIndexKeys(PartitionID part,
+                        folly::StringPiece key,
+                        folly::StringPiece val,
+                        std::vector<std::string>* indexKeys) override;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_ADMIN_REBUILDEDGEINDEXTASK_H_
@@ -0,0 +1,415 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/admin/RebuildIndexTask.h"
+#include "common/fs/FileUtils.h"
+#include <folly/ScopeGuard.h>
+#include "kvstore/LogEncoder.h"
+#include "storage/StorageFlags.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>>
+RebuildIndexTask::genSubTasks() {
+    std::vector<AdminSubTask> ret;
+    if (!ctx_.store_) {
+        return ret;
+    }
+
+    space_ = ctx_.spaceId_;
+    CHECK_NOTNULL(env_->schemaMan_);
+    auto vIdLenRet = env_->schemaMan_->getSpaceVidLen(space_);
+    if (!vIdLenRet.ok()) {
+        LOG(ERROR) << vIdLenRet.status();
+        return cpp2::ErrorCode::E_INVALID_SPACEVIDLEN;
+    }
+    vIdLen_ = vIdLenRet.value();
+
+    auto itemsRet = getIndexes(space_);
+    if (!itemsRet.ok()) {
+        LOG(ERROR) << itemsRet.status();
+        return cpp2::ErrorCode::E_INDEX_NOT_FOUND;
+    }
+
+    // Rebuild the indexes given by name, or all of them
+    std::unordered_set<std::string> names;
+    if (ctx_.parameters_.get_task_specfic_paras() != nullptr) {
+        for (auto& name : *ctx_.parameters_.get_task_specfic_paras()) {
+            names.emplace(name);
+        }
+    }
+    for (auto& item : itemsRet.value()) {
+        if (names.empty() || names.count(item->get_index_name())) {
+            names.erase(item->get_index_name());
+            schemaIds_.emplace(getSchemaId(*item));
+            items_.emplace_back(item);
+        }
+    }
+    if (!names.empty()) {
+        LOG(ERROR) << "Index " << *names.begin() << " not found in space " << space_;
+        return cpp2::ErrorCode::E_INDEX_NOT_FOUND;
+    }
+    if (items_.empty()) {
+        LOG(INFO) << "No index to rebuild in space " << space_;
+        return ret;
+    }
+
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(ctx_.store_);
+    CHECK_NOTNULL(store);
+    auto errOrSpace = store->space(space_);
+    if (!ok(errOrSpace)) {
+        return toStorageErr(error(errOrSpace));
+    }
+    auto space = nebula::value(errOrSpace);
+
+    std::vector<PartitionID> parts;
+    if (ctx_.parameters_.get_parts() != nullptr && !ctx_.parameters_.get_parts()->empty()) {
+        parts = *ctx_.parameters_.get_parts();
+    } else {
+        for (auto& part : space->parts_) {
+            parts.emplace_back(part.first);
+        }
+    }
+
+    for (auto part : parts) {
+        auto it = space->parts_.find(part);
+        if (it == space->parts_.end()) {
+            VLOG(1) << "Part " << part << " of space " << space_ << " is not on this host";
+            continue;
+        }
+        std::function<cpp2::ErrorCode()> task =
+            std::bind(&RebuildIndexTask::invoke, this, part, it->second);
+        ret.emplace_back(task);
+    }
+    return ret;
+}
+
+cpp2::ErrorCode RebuildIndexTask::invoke(PartitionID part,
+                                         std::shared_ptr<kvstore::Part> partPtr) {
+    LOG(INFO) << "Start rebuilding index of space " << space_ << " part " << part;
+    auto* engine = partPtr->engine();
+    auto* snapshot = engine->getSnapshot();
+    SCOPE_EXIT {
+        engine->releaseSnapshot(snapshot);
+    };
+
+    auto snapshotLogId = committedLogId(part, engine, snapshot);
+    if (!ok(snapshotLogId)) {
+        return error(snapshotLogId);
+    }
+
+    auto ret = buildIndexFromSnapshot(part, engine, snapshot);
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Build index of space " << space_ << " part " << part << " failed";
+        return ret;
+    }
+    ret = replayLogs(part, partPtr, snapshot, nebula::value(snapshotLogId));
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Replay logs of space " << space_ << " part " << part << " failed";
+        return ret;
+    }
+    LOG(INFO) << "Finish rebuilding index of space " << space_ << " part " << part;
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+ErrorOr<cpp2::ErrorCode, LogID>
+RebuildIndexTask::committedLogId(PartitionID part,
+                                 kvstore::KVEngine* engine,
+                                 const void* snapshot) {
+    // The commit key is written in the same batch with the data of the logs
+    std::string val;
+    auto code = engine->get(NebulaKeyUtils::systemCommitKey(part), &val, snapshot);
+    if (code == kvstore::ResultCode::ERR_KEY_NOT_FOUND) {
+        return 0;
+    } else if (code != kvstore::ResultCode::SUCCEEDED) {
+        return toStorageErr(code);
+    }
+    CHECK_EQ(val.size(), sizeof(LogID) + sizeof(TermID));
+    LogID logId;
+    memcpy(reinterpret_cast<void*>(&logId), val.data(), sizeof(LogID));
+    return logId;
+}
+
+cpp2::ErrorCode RebuildIndexTask::buildIndexFromSnapshot(PartitionID part,
+                                                         kvstore::KVEngine* engine,
+                                                         const void* snapshot) {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto prefix = rowPrefix(part);
+    auto code = rowIterator(part, engine, prefix, snapshot, &iter);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        return toStorageErr(code);
+    }
+
+    size_t maxBytes = static_cast<size_t>(FLAGS_rebuild_index_sst_size_mb) * 1024 * 1024;
+    size_t bytes = 0;
+    int32_t seq = 0;
+    std::vector<kvstore::KV> data;
+    std::vector<std::string> indexKeys;
+    std::string lastRow;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        if (!isIndexedRow(key)) {
+            continue;
+        }
+        // The latest version of a row comes first, the older ones are skipped. The versions
+        // of an edge may be of both key types during the conversion of the edge keys.
+        auto row = NebulaKeyUtils::keyWithNoVersion(key).subpiece(1);
+        if (row == lastRow) {
+            continue;
+        }
+        lastRow = row.str();
+
+        indexKeys.clear();
+        buildIndexKeys(part, key, iter->val(), &indexKeys);
+        for (auto& indexKey : indexKeys) {
+            bytes += indexKey.size();
+            data.emplace_back(std::move(indexKey), "");
+        }
+        if (bytes >= maxBytes) {
+            if (cancelled()) {
+                return cpp2::ErrorCode::E_USER_CANCEL;
+            }
+            auto ret = ingestIndexKeys(part, engine, data, seq++);
+            if (ret != cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+            data.clear();
+            bytes = 0;
+        }
+    }
+    if (cancelled()) {
+        return cpp2::ErrorCode::E_USER_CANCEL;
+    }
+    return ingestIndexKeys(part, engine, data, seq);
+}
+
+cpp2::ErrorCode RebuildIndexTask::ingestIndexKeys(PartitionID part,
+                                                  kvstore::KVEngine* engine,
+                                                  std::vector<kvstore::KV>& data,
+                                                  int32_t seq) {
+    if (data.empty()) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    std::sort(data.begin(), data.end());
+    data.erase(std::unique(data.begin(), data.end()), data.end());
+
+    auto dir = folly::stringPrintf("%s/rebuild_index", engine->getDataRoot());
+    if (!fs::FileUtils::exist(dir) && !fs::FileUtils::makeDir(dir)) {
+        LOG(ERROR) << "Create directory " << dir << " failed";
+        return cpp2::ErrorCode::E_UNKNOWN;
+    }
+    auto file = folly::stringPrintf("%s/%d_%d_%d_%d.sst", dir.c_str(),
+                                    ctx_.jobId_, ctx_.taskId_, part, seq);
+    SCOPE_EXIT {
+        fs::FileUtils::remove(file.c_str());
+    };
+    auto code = engine->writeSstFile(file, data);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Write sst file " << file << " failed";
+        return toStorageErr(code);
+    }
+    code = engine->ingest({file});
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        LOG(ERROR) << "Ingest sst file " << file << " failed";
+        return toStorageErr(code);
+    }
+    VLOG(1) << "Ingested " << data.size() << " index entries of part " << part;
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode RebuildIndexTask::replayLogs(PartitionID part,
+                                             std::shared_ptr<kvstore::Part> partPtr,
+                                             const void* snapshot,
+                                             LogID snapshotLogId) {
+    auto* engine = partPtr->engine();
+    // The index keys written by previous rounds, they are stale if the row is
+    // written again
+    std::unordered_map<std::string, std::vector<std::string>> replayed;
+    LogID from = snapshotLogId;
+    for (int32_t round = 0; round < FLAGS_rebuild_index_replay_rounds; round++) {
+        if (cancelled()) {
+            return cpp2::ErrorCode::E_USER_CANCEL;
+        }
+        auto lastLogId = committedLogId(part, engine, nullptr);
+        if (!ok(lastLogId)) {
+            return error(lastLogId);
+        }
+        auto to = nebula::value(lastLogId);
+        if (to <= from) {
+            return cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        std::unordered_set<std::string> rows;
+        auto ret = collectTouchedRows(part, partPtr, snapshot, from, to, &rows);
+        if (ret != cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
+        VLOG(1) << "Replay logs [" << from + 1 << ", " << to << "] of part " << part
+                << ", " << rows.size() << " rows touched";
+        from = to;
+        if (rows.empty()) {
+            return cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        auto batch = engine->startBatchWrite();
+        int32_t batchNum = 0;
+        for (auto& row : rows) {
+            std::vector<std::string> stale;
+            ret = latestIndexKeys(part, engine, row, snapshot, &stale);
+            if (ret != cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+            auto it = replayed.find(row);
+            if (it != replayed.end()) {
+                stale.insert(stale.end(), it->second.begin(), it->second.end());
+            }
+            std::vector<std::string> current;
+            ret = latestIndexKeys(part, engine, row, nullptr, &current);
+            if (ret != cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+
+            for (auto& key : stale) {
+                if (std::find(current.begin(), current.end(), key) == current.end()) {
+                    batch->remove(key);
+                    batchNum++;
+                }
+            }
+            for (auto& key : current) {
+                batch->put(key, "");
+                batchNum++;
+            }
+            replayed[row] = std::move(current);
+
+            if (batchNum >= FLAGS_rebuild_index_batch_num) {
+                auto code = engine->commitBatchWrite(std::move(batch), false);
+                if (code != kvstore::ResultCode::SUCCEEDED) {
+                    return toStorageErr(code);
+                }
+                batch = engine->startBatchWrite();
+                batchNum = 0;
+            }
+        }
+        if (batchNum > 0) {
+            auto code = engine->commitBatchWrite(std::move(batch), false);
+            if (code != kvstore::ResultCode::SUCCEEDED) {
+                return toStorageErr(code);
+            }
+        }
+    }
+    LOG(ERROR) << "Replay logs of part " << part << " can't catch up with the writes in "
+               << FLAGS_rebuild_index_replay_rounds << " rounds";
+    return cpp2::ErrorCode::E_RETRY_EXHAUSTED;
+}
+
+cpp2::ErrorCode RebuildIndexTask::collectTouchedRows(PartitionID part,
+                                                     std::shared_ptr<kvstore::Part> partPtr,
+                                                     const void* snapshot,
+                                                     LogID from,
+                                                     LogID to,
+                                                     std::unordered_set<std::string>* rows) {
+    auto wal = partPtr->wal();
+    if (wal->firstLogId() > from + 1) {
+        LOG(ERROR) << "The logs after " << from << " of part " << part
+                   << " have been cleaned, first log in wal is " << wal->firstLogId();
+        return cpp2::ErrorCode::E_UNKNOWN;
+    }
+
+    auto addRow = [&] (folly::StringPiece key) {
+        if (isIndexedRow(key)) {
+            rows->emplace(NebulaKeyUtils::keyWithNoVersion(key).str());
+        }
+    };
+    // The rows in the snapshot removed by a range
+    auto addRange = [&] (folly::StringPiece start, folly::StringPiece end) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto code = partPtr->engine()->range(start.str(), end.str(), &iter, snapshot);
+        if (code != kvstore::ResultCode::SUCCEEDED) {
+            return code;
+        }
+        for (; iter->valid(); iter->next()) {
+            addRow(iter->key());
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    };
+
+    auto iter = wal->iterator(from + 1, to);
+    for (; iter->valid(); ++(*iter)) {
+        auto log = iter->logMsg();
+        if (log.empty()) {
+            // heartbeat
+            continue;
+        }
+        DCHECK_GE(log.size(), sizeof(int64_t) + 1 + sizeof(uint32_t));
+        switch (log[sizeof(int64_t)]) {
+        case kvstore::OP_PUT:
+        case kvstore::OP_MULTI_PUT: {
+            auto kvs = kvstore::decodeMultiValues(log);
+            for (size_t i = 0; i < kvs.size(); i += 2) {
+                addRow(kvs[i]);
+            }
+            break;
+        }
+        case kvstore::OP_REMOVE: {
+            addRow(kvstore::decodeSingleValue(log));
+            break;
+        }
+        case kvstore::OP_MULTI_REMOVE: {
+            for (auto key : kvstore::decodeMultiValues(log)) {
+                addRow(key);
+            }
+            break;
+        }
+        case kvstore::OP_REMOVE_RANGE: {
+            auto range = kvstore::decodeMultiValues(log);
+            DCHECK_EQ(2, range.size());
+            auto code = addRange(range[0], range[1]);
+            if (code != kvstore::ResultCode::SUCCEEDED) {
+                return toStorageErr(code);
+            }
+            break;
+        }
+        case kvstore::OP_BATCH_WRITE: {
+            for (auto& op : kvstore::decodeBatchValue(log)) {
+                if (op.first == kvstore::BatchLogType::OP_BATCH_REMOVE_RANGE) {
+                    auto code = addRange(op.second.first, op.second.second);
+                    if (code != kvstore::ResultCode::SUCCEEDED) {
+                        return toStorageErr(code);
+                    }
+                } else {
+                    addRow(op.second.first);
+                }
+            }
+            break;
+        }
+        default:
+            // Membership changes, nothing to do with the data
+            break;
+        }
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode RebuildIndexTask::latestIndexKeys(PartitionID part,
+                                                  kvstore::KVEngine* engine,
+                                                  const std::string& row,
+                                                  const void* snapshot,
+                                                  std::vector<std::string>* indexKeys) {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = rowIterator(part, engine, row, snapshot, &iter);
+    if (code != kvstore::ResultCode::SUCCEEDED) {
+        return toStorageErr(code);
+    }
+    if (iter->valid() && isIndexedRow(iter->key())) {
+        buildIndexKeys(part, iter->key(), iter->val(), indexKeys);
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,122 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_ADMIN_REBUILDINDEXTASK_H_
+#define STORAGE_ADMIN_REBUILDINDEXTASK_H_
+
+#include "common/base/Base.h"
+#include <gtest/gtest_prod.h>
+#include "common/interface/gen-cpp2/meta_types.h"
+#include "kvstore/Part.h"
+#include "storage/admin/AdminTask.h"
+
+namespace nebula {
+namespace storage {
+
+using IndexItems = std::vector<std::shared_ptr<meta::cpp2::IndexItem>>;
+
+/**
+ * Rebuild indexes of a space online, each local part is a sub task.
+ *
+ * A part is rebuilt in two phases:
+ * 1. Take a snapshot of the engine, scan the rows of the part in the snapshot,
+ *    sort the index entries in memory and write them into sst files, which are
+ *    ingested into the engine directly instead of going through the memtable.
+ * 2. Replay the logs committed after the snapshot from the wal, and fix the
+ *    index entries of the rows touched by them. The replay is repeated until it
+ *    catches up with the writes, because the writes are not blocked.
+ *
+ * Every replica rebuilds its own copy, so the index entries are written into
+ * the local engine and not replicated by raft.
+ * */
+class RebuildIndexTask : public AdminTask {
+    FRIEND_TEST(RebuildIndexTest, ReplayLogsTest);
+
+public:
+    RebuildIndexTask(StorageEnv* env, TaskContext&& ctx)
+        : AdminTask(env, std::move(ctx)) {}
+
+    ErrorOr<cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
+
+protected:
+    // All indexes of the kind, the ones to rebuild are filtered by the task
+    virtual StatusOr<IndexItems> getIndexes(GraphSpaceID space) = 0;
+
+    virtual int32_t getSchemaId(const meta::cpp2::IndexItem& item) = 0;
+
+    // The prefix of the rows of the kind in the part
+    virtual std::string rowPrefix(PartitionID part) = 0;
+
+    // Iterate over the rows with the prefix in the snapshot, the prefix must outlive the iter
+    virtual kvstore::ResultCode rowIterator(PartitionID part,
+                                            kvstore::KVEngine* engine,
+                                            const std::string& prefix,
+                                            const void* snapshot,
+                                            std::unique_ptr<kvstore::KVIterator>* iter) {
+        UNUSED(part);
+        return engine->prefix(prefix, iter, snapshot);
+    }
+
+    // Whether the key is a row of the schemas being indexed
+    virtual bool isIndexedRow(folly::StringPiece key) = 0;
+
+    // Build the index keys of the indexes being rebuilt for a row
+    virtual void buildIndexKeys(PartitionID part,
+                                folly::StringPiece key,
+                                folly::StringPiece val,
+                                std::vector<std::string>* indexKeys) = 0;
+
+    cpp2::ErrorCode invoke(PartitionID part, std::shared_ptr<kvstore::Part> partPtr);
+
+    // The last log applied in the engine, or in the snapshot if it is given
+    ErrorOr<cpp2::ErrorCode, LogID> committedLogId(PartitionID part,
+                                                   kvstore::KVEngine* engine,
+                                                   const void* snapshot);
+
+    // Build the index of the part from the rows in the snapshot
+    cpp2::ErrorCode buildIndexFromSnapshot(PartitionID part,
+                                           kvstore::KVEngine* engine,
+                                           const void* snapshot);
+
+    // Fix the index entries of rows written by the logs after snapshotLogId
+    cpp2::ErrorCode replayLogs(PartitionID part,
+                               std::shared_ptr<kvstore::Part> partPtr,
+                               const void* snapshot,
+                               LogID snapshotLogId);
+
+    // Collect the rows touched by the logs in [from, to]
+    cpp2::ErrorCode collectTouchedRows(PartitionID part,
+                                       std::shared_ptr<kvstore::Part> partPtr,
+                                       const void* snapshot,
+                                       LogID from,
+                                       LogID to,
+                                       std::unordered_set<std::string>* rows);
+
+    cpp2::ErrorCode ingestIndexKeys(PartitionID part,
+                                    kvstore::KVEngine* engine,
+                                    std::vector<kvstore::KV>& data,
+                                    int32_t seq);
+
+    cpp2::ErrorCode latestIndexKeys(PartitionID part,
+                                    kvstore::KVEngine* engine,
+                                    const std::string& row,
+                                    const void* snapshot,
+                                    std::vector<std::string>* indexKeys);
+
+    bool cancelled() const {
+        return rc_ != cpp2::ErrorCode::SUCCEEDED;
+    }
+
+protected:
+    GraphSpaceID                space_;
+    size_t                      vIdLen_{0};
+    IndexItems                  items_;
+    std::unordered_set<int32_t> schemaIds_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_ADMIN_REBUILDINDEXTASK_H_
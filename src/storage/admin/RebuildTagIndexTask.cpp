@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/admin/RebuildTagIndexTask.h"
+#include "codec/RowReader.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+StatusOr<IndexItems> RebuildTagIndexTask::getIndexes(GraphSpaceID space) {
+    return env_->indexMan_->getTagIndexes(space);
+}
+
+int32_t RebuildTagIndexTask::getSchemaId(const meta::cpp2::IndexItem& item) {
+    return item.get_schema_id().get_tag_id();
+}
+
+std::string RebuildTagIndexTask::rowPrefix(PartitionID part) {
+    // The edges are skipped if they are separated
+    return NebulaKeyUtils::partPrefix(part, NebulaKeyType::kData);
+}
+
+bool RebuildTagIndexTask::isIndexedRow(folly::StringPiece key) {
+    return NebulaKeyUtils::isVertex(vIdLen_, key) &&
+           schemaIds_.count(NebulaKeyUtils::getTagId(vIdLen_, key));
+}
+
+void RebuildTagIndexTask::buildIndexKeys(PartitionID part,
+                                         folly::StringPiece key,
+                                         folly::StringPiece val,
+                                         std::vector<std::string>* indexKeys) {
+    auto tagId = NebulaKeyUtils::getTagId(vIdLen_, key);
+    auto vId = NebulaKeyUtils::getVertexId(vIdLen_, key).str();
+    std::unique_ptr<RowReader> reader;
+    for (auto& item : items_) {
+        if (item->get_schema_id().get_tag_id() != tagId) {
+            continue;
+        }
+        if (reader == nullptr) {
+            reader = RowReader::getTagPropReader(env_->schemaMan_, space_, tagId, val);
+            if (reader == nullptr) {
+                LOG(ERROR) << "Bad format row";
+                return;
+            }
+        }
+        std::vector<Value::Type> colsType;
+        auto values = IndexKeyUtils::collectIndexValues(reader.get(),
+                                                        item->get_fields(),
+                                                        colsType);
+        if (!values.ok()) {
+            continue;
+        }
+        indexKeys->emplace_back(IndexKeyUtils::vertexIndexKey(vIdLen_, part,
+                                                              item->get_index_id(),
+                                                              vId, values.value(),
+                                                              colsType));
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,192 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/cache/AdjacencyCache.h"
+#include <folly/Bits.h>
+#include <folly/hash/SpookyHashV2.h>
+#include "common/time/WallClock.h"
+#include "utils/NebulaKeyUtils.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+void AdjacencyList::add(folly::StringPiece key, folly::StringPiece val) {
+    if (!entries_.empty()) {
+        auto last = this->key(entries_.size() - 1);
+        // older version of the same edge, it may be of the other key type during the
+        // conversion of the edge keys
+        if (NebulaKeyUtils::keyWithNoVersion(last).subpiece(1) ==
+                NebulaKeyUtils::keyWithNoVersion(key).subpiece(1)) {
+            return;
+        }
+    }
+    Entry e;
+    e.offset = arena_.size();
+    e.keyLen = key.size();
+    e.valLen = val.size();
+    arena_.append(key.data(), key.size());
+    arena_.append(val.data(), val.size());
+    entries_.emplace_back(std::move(e));
+}
+
+
+AdjacencyCache::AdjacencyCache(size_t capacityInBytes,
+                               uint32_t bucketsExp,
+                               stats::Stats* stats,
+                               stats::Stats* missStats)
+        : buckets_(1UL << bucketsExp)
+        , bucketsMask_((1UL << bucketsExp) - 1)
+        , capacityPerBucket_(capacityInBytes >> bucketsExp)
+        , stats_(stats)
+        , missStats_(missStats)
+        , freq_(std::max<size_t>(1024, folly::nextPowTwo(FLAGS_adjacency_cache_sketch_size))) {
+    CHECK_GT(capacityPerBucket_, 0);
+}
+
+// static
+std::string AdjacencyCache::cacheKey(GraphSpaceID spaceId,
+                                     size_t vIdLen,
+                                     PartitionID partId,
+                                     const VertexID& vId,
+                                     EdgeType edgeType) {
+    std::string key;
+    key.reserve(sizeof(GraphSpaceID) + sizeof(PartitionID) + vIdLen + sizeof(EdgeType));
+    key.append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID))
+       .append(NebulaKeyUtils::edgePrefix(vIdLen, partId, vId, edgeType));
+    return key;
+}
+
+std::shared_ptr<const AdjacencyList> AdjacencyCache::get(const std::string& key) {
+    total_.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<const AdjacencyList> list;
+    {
+        auto& b = bucket(std::hash<std::string>()(key));
+        std::lock_guard<std::mutex> guard(b.lock);
+        auto it = b.map.find(key);
+        if (it != b.map.end()) {
+            if (FLAGS_adjacency_cache_expire_secs > 0 &&
+                time::WallClock::fastNowInSec() - it->second.insertTime
+                    > FLAGS_adjacency_cache_expire_secs) {
+                // The writes on other replicas don't evict the local cache, so an entry is
+                // not trusted forever in case of the leadership has moved back and forth
+                erase(b, it);
+            } else {
+                b.lru.splice(b.lru.begin(), b.lru, it->second.pos);
+                list = it->second.list;
+            }
+        }
+    }
+    if (list != nullptr) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        stats::Stats::addStatsValue(missStats_, true, 0);
+    }
+    stats::Stats::addStatsValue(stats_, true, 0);
+    return list;
+}
+
+bool AdjacencyCache::touch(const std::string& key) {
+    auto hash = folly::hash::SpookyHashV2::Hash64(key.data(), key.size(), 0);
+    auto& f = freq_[hash & (freq_.size() - 1)];
+    auto cur = f.load(std::memory_order_relaxed);
+    // If another thread has changed the counter, cur is reloaded and counted as it is
+    if (cur < 15 && f.compare_exchange_strong(cur, cur + 1, std::memory_order_relaxed)) {
+        ++cur;
+    }
+    if (accesses_.fetch_add(1, std::memory_order_relaxed) + 1
+            == kSampleFactor * freq_.size()) {
+        // Not exact at all when other threads are touching, but good enough to
+        // age the counters
+        for (auto& c : freq_) {
+            c.store(c.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+        }
+        accesses_.store(0, std::memory_order_relaxed);
+    }
+    return static_cast<int32_t>(cur) >= FLAGS_adjacency_cache_hot_threshold;
+}
+
+uint64_t AdjacencyCache::epoch(const std::string& key) {
+    auto& b = bucket(std::hash<std::string>()(key));
+    std::lock_guard<std::mutex> guard(b.lock);
+    return b.epoch;
+}
+
+bool AdjacencyCache::insert(const std::string& key,
+                            std::shared_ptr<const AdjacencyList> list,
+                            uint64_t epoch) {
+    auto size = list->bytes() + key.size();
+    if (size > capacityPerBucket_) {
+        return false;
+    }
+    auto& b = bucket(std::hash<std::string>()(key));
+    std::lock_guard<std::mutex> guard(b.lock);
+    if (b.epoch != epoch) {
+        VLOG(3) << "Bucket has been modified during scan, reject the adjacency list";
+        return false;
+    }
+    auto it = b.map.find(key);
+    if (it != b.map.end()) {
+        erase(b, it);
+    }
+    while (b.bytes + size > capacityPerBucket_ && !b.lru.empty()) {
+        auto victim = b.map.find(b.lru.back());
+        CHECK(victim != b.map.end());
+        erase(b, victim);
+        evicts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    b.lru.emplace_front(key);
+    b.map.emplace(key, Value{std::move(list), b.lru.begin(), time::WallClock::fastNowInSec()});
+    b.bytes += size;
+    return true;
+}
+
+void AdjacencyCache::evict(const std::string& key) {
+    auto& b = bucket(std::hash<std::string>()(key));
+    std::lock_guard<std::mutex> guard(b.lock);
+    // Bump the epoch even if the key is not cached, so that a concurrent
+    // reader won't insert what it read before the write
+    ++b.epoch;
+    auto it = b.map.find(key);
+    if (it != b.map.end()) {
+        erase(b, it);
+    }
+}
+
+void AdjacencyCache::evictPart(GraphSpaceID spaceId, PartitionID partId) {
+    for (auto& b : buckets_) {
+        std::lock_guard<std::mutex> guard(b.lock);
+        ++b.epoch;
+        auto it = b.map.begin();
+        while (it != b.map.end()) {
+            auto cur = it++;
+            // The key is the space id followed by the edge prefix of the part
+            folly::StringPiece key(cur->first);
+            if (readInt<GraphSpaceID>(key.data(), sizeof(GraphSpaceID)) == spaceId &&
+                NebulaKeyUtils::getPart(key.subpiece(sizeof(GraphSpaceID))) == partId) {
+                erase(b, cur);
+            }
+        }
+    }
+}
+
+size_t AdjacencyCache::bytes() {
+    size_t total = 0;
+    for (auto& b : buckets_) {
+        std::lock_guard<std::mutex> guard(b.lock);
+        total += b.bytes;
+    }
+    return total;
+}
+
+void AdjacencyCache::erase(Bucket& b, std::unordered_map<std::string, Value>::iterator it) {
+    b.bytes -= it->second.list->bytes() + it->first.size();
+    b.lru.erase(it->second.pos);
+    b.map.erase(it);
+}
+
+}  // namespace storage
+}  // namespace nebula
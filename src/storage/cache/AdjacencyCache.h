@@ -0,0 +1,232 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_CACHE_ADJACENCYCACHE_H_
+#define STORAGE_CACHE_ADJACENCYCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/stats/Stats.h"
+#include "kvstore/KVIterator.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * A compact copy of all edges of one (part, vertex, edgeType). Only the latest
+ * version of each (rank, dst) is kept, and all keys and values live in a
+ * single arena in the same order as they are in the kvstore.
+ * */
+class AdjacencyList final {
+public:
+    // The keys must be added in the kvstore order. Older versions of the last
+    // added edge are dropped
+    void add(folly::StringPiece key, folly::StringPiece val);
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    folly::StringPiece key(size_t idx) const {
+        const auto& e = entries_[idx];
+        return folly::StringPiece(arena_.data() + e.offset, e.keyLen);
+    }
+
+    folly::StringPiece val(size_t idx) const {
+        const auto& e = entries_[idx];
+        return folly::StringPiece(arena_.data() + e.offset + e.keyLen, e.valLen);
+    }
+
+    // The first entry whose key is not less than the given one
+    size_t lowerBound(folly::StringPiece key) const {
+        size_t lo = 0, hi = entries_.size();
+        while (lo < hi) {
+            auto mid = lo + ((hi - lo) >> 1);
+            if (this->key(mid) < key) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    // The memory used by the list, which is charged to the cache capacity
+    size_t bytes() const {
+        return sizeof(AdjacencyList) + arena_.capacity() + entries_.capacity() * sizeof(Entry);
+    }
+
+    void shrink() {
+        arena_.shrink_to_fit();
+        entries_.shrink_to_fit();
+    }
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t keyLen;
+        uint32_t valLen;
+    };
+
+    std::string         arena_;
+    std::vector<Entry>  entries_;
+};
+
+
+// KVIterator over a cached AdjacencyList, it holds a reference of the list,
+// so the list is still valid after it has been evicted from the cache
+class AdjacencyIterator final : public kvstore::KVIterator {
+public:
+    explicit AdjacencyIterator(std::shared_ptr<const AdjacencyList> list)
+        : list_(std::move(list)) {}
+
+    bool valid() const override {
+        return idx_ >= 0 && static_cast<size_t>(idx_) < list_->size();
+    }
+
+    void next() override {
+        ++idx_;
+    }
+
+    void prev() override {
+        --idx_;
+    }
+
+    void seek(folly::StringPiece target) override {
+        idx_ = list_->lowerBound(target);
+    }
+
+    void seekForPrev(folly::StringPiece target) override {
+        auto idx = list_->lowerBound(target);
+        if (static_cast<size_t>(idx) < list_->size() && list_->key(idx) == target) {
+            idx_ = idx;
+        } else {
+            idx_ = static_cast<int64_t>(idx) - 1;
+        }
+    }
+
+    folly::StringPiece key() const override {
+        return list_->key(idx_);
+    }
+
+    folly::StringPiece val() const override {
+        return list_->val(idx_);
+    }
+
+private:
+    std::shared_ptr<const AdjacencyList>    list_;
+    int64_t                                 idx_{0};
+};
+
+
+/**
+ * AdjacencyCache holds the edge lists of the vertices which are traversed
+ * frequently and have a lot of edges, such as the supernodes.
+ *
+ * The key is the space id followed by NebulaKeyUtils::edgePrefix(part, vId,
+ * edgeType), and the capacity is measured in bytes. Every access is counted
+ * by a small frequency sketch, and a list is only cached when the key is hot
+ * enough and the vertex has enough edges.
+ *
+ * Every mutation of the edges must call evict() after the write has been
+ * committed. A reader which misses takes the epoch() before scanning the
+ * kvstore and passes it to insert(), which will reject the list if the bucket
+ * has been evicted in between, so a stale list is never cached.
+ *
+ * The writes are only seen by the leader, so all lists of a part are dropped
+ * by evictPart() whenever the leadership of the part changes, otherwise a host
+ * which is elected again would serve the lists cached before it lost the
+ * leadership.
+ *
+ * Every lookup is reported to the given stats, and every miss to the miss
+ * stats, so the hit ratio is 1 - miss_qps / qps.
+ * */
+class AdjacencyCache final {
+public:
+    AdjacencyCache(size_t capacityInBytes,
+                   uint32_t bucketsExp,
+                   stats::Stats* stats = nullptr,
+                   stats::Stats* missStats = nullptr);
+
+    static std::string cacheKey(GraphSpaceID spaceId,
+                                size_t vIdLen,
+                                PartitionID partId,
+                                const VertexID& vId,
+                                EdgeType edgeType);
+
+    std::shared_ptr<const AdjacencyList> get(const std::string& key);
+
+    // Count one access of the key, return true if the key is hot
+    bool touch(const std::string& key);
+
+    uint64_t epoch(const std::string& key);
+
+    // Return false if the list is rejected
+    bool insert(const std::string& key,
+                std::shared_ptr<const AdjacencyList> list,
+                uint64_t epoch);
+
+    void evict(const std::string& key);
+
+    // Drop all lists of the part, e.g. when the leadership of the part changes
+    void evictPart(GraphSpaceID spaceId, PartitionID partId);
+
+    uint64_t hits() const {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t evicts() const {
+        return evicts_.load(std::memory_order_relaxed);
+    }
+
+    size_t bytes();
+
+private:
+    struct Value {
+        std::shared_ptr<const AdjacencyList>    list;
+        std::list<std::string>::iterator        pos;
+        int64_t                                 insertTime;
+    };
+
+    struct Bucket {
+        std::mutex                                  lock;
+        std::list<std::string>                      lru;
+        std::unordered_map<std::string, Value>      map;
+        size_t                                      bytes{0};
+        uint64_t                                    epoch{0};
+    };
+
+    Bucket& bucket(size_t hash) {
+        return buckets_[hash & bucketsMask_];
+    }
+
+    // Must hold the bucket lock
+    void erase(Bucket& b, std::unordered_map<std::string, Value>::iterator it);
+
+    std::vector<Bucket>                     buckets_;
+    size_t                                  bucketsMask_;
+    size_t                                  capacityPerBucket_;
+    stats::Stats*                           stats_{nullptr};
+    stats::Stats*                           missStats_{nullptr};
+
+    // Access frequency of keys, saturated at 15 and halved every
+    // kSampleFactor * freq_.size() accesses, so the keys which were hot a
+    // long time ago are aged out
+    static constexpr size_t                 kSampleFactor = 8;
+    std::vector<std::atomic<uint8_t>>       freq_;
+    std::atomic<uint64_t>                   accesses_{0};
+
+    std::atomic<uint64_t>                   hits_{0};
+    std::atomic<uint64_t>                   total_{0};
+    std::atomic<uint64_t>                   evicts_{0};
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_CACHE_ADJACENCYCACHE_H_
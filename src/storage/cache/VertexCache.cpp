@@ -0,0 +1,218 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/cache/VertexCache.h"
+#include <folly/Bits.h>
+#include <folly/hash/SpookyHashV2.h>
+
+namespace nebula {
+namespace storage {
+
+uint64_t VertexCache::Key::hash() const {
+    // spaceId, partId, tagId, vIdLen are continuous in the struct
+    static_assert(offsetof(Key, vIdBuf) == sizeof(GraphSpaceID) + sizeof(PartitionID)
+                                           + sizeof(TagID) + sizeof(uint32_t),
+                  "Unexpected padding in VertexCache::Key");
+    return folly::hash::SpookyHashV2::Hash64(this, offsetof(Key, vIdBuf) + vIdLen, 0);
+}
+
+
+VertexCache::FrequencySketch::FrequencySketch(size_t width)
+        : width_(folly::nextPowTwo(std::max<size_t>(width, 1024)))
+        , counters_(width_ * kDepth)
+        , sampleSize_(width_ * 10) {}
+
+void VertexCache::FrequencySketch::increment(uint64_t hash) {
+    for (size_t row = 0; row < kDepth; row++) {
+        auto& c = counters_[index(hash, row)];
+        auto cur = c.load(std::memory_order_relaxed);
+        if (cur < kMaxCount) {
+            // losing an increment under contention is fine for an estimation
+            c.compare_exchange_weak(cur, cur + 1, std::memory_order_relaxed);
+        }
+    }
+    if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 == sampleSize_) {
+        // Aging, halve all counters so that the old history fades out
+        for (auto& c : counters_) {
+            c.store(c.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+        }
+        additions_.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint8_t VertexCache::FrequencySketch::frequency(uint64_t hash) const {
+    uint8_t freq = kMaxCount;
+    for (size_t row = 0; row < kDepth; row++) {
+        freq = std::min(freq, counters_[index(hash, row)].load(std::memory_order_relaxed));
+    }
+    return freq;
+}
+
+
+VertexCache::VertexCache(size_t capacityInBytes, uint32_t bucketsExp, stats::Stats* stats)
+        : buckets_(1UL << bucketsExp)
+        , bucketsMask_((1UL << bucketsExp) - 1)
+        , capacityPerBucket_(capacityInBytes >> bucketsExp)
+        , stats_(stats)
+        // About one counter per row the cache could hold, assuming small rows
+        , sketch_(capacityInBytes / charge(64)) {
+    CHECK_GT(capacityPerBucket_, 0);
+}
+
+bool VertexCache::get(const Key& key, std::string* val) {
+    if (!key.cachable()) {
+        return false;
+    }
+    total_.fetch_add(1, std::memory_order_relaxed);
+    auto hash = key.hash();
+    sketch_.increment(hash);
+    bool hit = false;
+    {
+        auto& b = bucket(hash);
+        std::lock_guard<std::mutex> guard(b.lock);
+        auto it = b.map.find(key);
+        if (it != b.map.end()) {
+            b.lru.splice(b.lru.begin(), b.lru, it->second.pos);
+            *val = it->second.val;
+            hit = true;
+        }
+    }
+    if (hit) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    }
+    stats::Stats::addStatsValue(stats_, hit, 0);
+    return hit;
+}
+
+uint64_t VertexCache::epoch(const Key& key) {
+    auto& b = bucket(key.hash());
+    std::lock_guard<std::mutex> guard(b.lock);
+    return b.epoch;
+}
+
+bool VertexCache::insert(const Key& key, std::string val, uint64_t epoch) {
+    if (!key.cachable()) {
+        return false;
+    }
+    auto hash = key.hash();
+    auto& b = bucket(hash);
+    std::lock_guard<std::mutex> guard(b.lock);
+    if (b.epoch != epoch) {
+        VLOG(3) << "The vertex has been written during the read, skip the cache";
+        return false;
+    }
+    if (b.map.find(key) != b.map.end()) {
+        // Another reader has filled it
+        return true;
+    }
+    if (!admit(b, hash, charge(val.size()))) {
+        return false;
+    }
+    add(b, key, std::move(val));
+    return true;
+}
+
+bool VertexCache::put(const Key& key, std::string val) {
+    if (!key.cachable()) {
+        return false;
+    }
+    auto hash = key.hash();
+    auto& b = bucket(hash);
+    std::lock_guard<std::mutex> guard(b.lock);
+    ++b.epoch;
+    auto it = b.map.find(key);
+    if (it != b.map.end()) {
+        // Replace in place, the hotness of the vertex does not change
+        erase(b, it);
+        if (charge(val.size()) > capacityPerBucket_) {
+            return false;
+        }
+        while (b.bytes + charge(val.size()) > capacityPerBucket_) {
+            erase(b, b.map.find(b.lru.back()));
+            evicts_.fetch_add(1, std::memory_order_relaxed);
+        }
+        add(b, key, std::move(val));
+        return true;
+    }
+    // A vertex which is written but never read is not admitted once the cache is full
+    if (!admit(b, hash, charge(val.size()))) {
+        return false;
+    }
+    add(b, key, std::move(val));
+    return true;
+}
+
+void VertexCache::evict(const Key& key) {
+    if (!key.cachable()) {
+        return;
+    }
+    auto& b = bucket(key.hash());
+    std::lock_guard<std::mutex> guard(b.lock);
+    ++b.epoch;
+    auto it = b.map.find(key);
+    if (it != b.map.end()) {
+        erase(b, it);
+    }
+}
+
+void VertexCache::evictPart(GraphSpaceID spaceId, PartitionID partId) {
+    for (auto& b : buckets_) {
+        std::lock_guard<std::mutex> guard(b.lock);
+        ++b.epoch;
+        auto it = b.map.begin();
+        while (it != b.map.end()) {
+            auto cur = it++;
+            if (cur->first.spaceId == spaceId && cur->first.partId == partId) {
+                erase(b, cur);
+            }
+        }
+    }
+}
+
+size_t VertexCache::bytes() {
+    size_t total = 0;
+    for (auto& b : buckets_) {
+        std::lock_guard<std::mutex> guard(b.lock);
+        total += b.bytes;
+    }
+    return total;
+}
+
+bool VertexCache::admit(Bucket& b, uint64_t hash, size_t size) {
+    if (size > capacityPerBucket_) {
+        return false;
+    }
+    if (b.bytes + size <= capacityPerBucket_) {
+        return true;
+    }
+    auto freq = sketch_.frequency(hash);
+    while (b.bytes + size > capacityPerBucket_) {
+        auto victim = b.map.find(b.lru.back());
+        CHECK(victim != b.map.end());
+        if (sketch_.frequency(victim->first.hash()) >= freq) {
+            rejects_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        erase(b, victim);
+        evicts_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void VertexCache::add(Bucket& b, const Key& key, std::string val) {
+    b.bytes += charge(val.size());
+    b.lru.emplace_front(key);
+    b.map.emplace(key, Value{std::move(val), b.lru.begin()});
+}
+
+void VertexCache::erase(Bucket& b, Map::iterator it) {
+    b.bytes -= charge(it->second.val.size());
+    b.lru.erase(it->second.pos);
+    b.map.erase(it);
+}
+
+}  // namespace storage
+}  // namespace nebula
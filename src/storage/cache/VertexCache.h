@@ -0,0 +1,201 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_CACHE_VERTEXCACHE_H_
+#define STORAGE_CACHE_VERTEXCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/stats/Stats.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * VertexCache caches the latest encoded row of (space, part, vertex, tag).
+ *
+ * The key has a fixed size and keeps the vid bytes inline, so building a key
+ * or probing the cache never allocates. Vertices whose vid is longer than
+ * kMaxVidLen are simply not cached.
+ *
+ * The capacity is measured in bytes. Besides the LRU order of each bucket,
+ * a new row is only admitted when it is accessed more frequently than the row
+ * it would replace (TinyLFU). The access frequency is estimated by a
+ * count-min sketch of 4 bits counters, which is halved periodically so that
+ * the old history fades out. So a scan over many cold vertices won't flush the
+ * hot ones out.
+ *
+ * The cache is filled in two ways:
+ *  1. insert(), after a reader misses and reads the row from the kvstore. The
+ *     reader takes the epoch() of the bucket before reading, and the row is
+ *     dropped if any write has touched the bucket since then.
+ *  2. put(), after a write has been committed (write-through). A row already
+ *     cached is replaced in place, so the vertices updated frequently don't
+ *     churn the cache. The callbacks of the same part are invoked by raft in
+ *     the commit order, so the latest put() wins.
+ *
+ * The rows are only valid as long as this host is the leader of the part, so
+ * the part is dropped by evictPart() whenever its leadership changes.
+ * */
+class VertexCache final {
+public:
+    static constexpr size_t kMaxVidLen = 32;
+
+    struct Key {
+        Key(GraphSpaceID space, PartitionID part, folly::StringPiece vId, TagID tag)
+            : spaceId(space)
+            , partId(part)
+            , tagId(tag)
+            , vIdLen(vId.size()) {
+            if (vIdLen <= kMaxVidLen) {
+                memcpy(vIdBuf, vId.data(), vIdLen);
+                memset(vIdBuf + vIdLen, 0, kMaxVidLen - vIdLen);
+            } else {
+                memset(vIdBuf, 0, kMaxVidLen);
+            }
+        }
+
+        bool cachable() const {
+            return vIdLen <= kMaxVidLen;
+        }
+
+        bool operator==(const Key& rhs) const {
+            return spaceId == rhs.spaceId &&
+                   partId == rhs.partId &&
+                   tagId == rhs.tagId &&
+                   vIdLen == rhs.vIdLen &&
+                   memcmp(vIdBuf, rhs.vIdBuf, kMaxVidLen) == 0;
+        }
+
+        uint64_t hash() const;
+
+        GraphSpaceID    spaceId;
+        PartitionID     partId;
+        TagID           tagId;
+        uint32_t        vIdLen;
+        char            vIdBuf[kMaxVidLen];
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return key.hash();
+        }
+    };
+
+    VertexCache(size_t capacityInBytes, uint32_t bucketsExp, stats::Stats* stats = nullptr);
+
+    // Return true and copy the row into val if hit. Every call is counted as
+    // an access of the key
+    bool get(const Key& key, std::string* val);
+
+    uint64_t epoch(const Key& key);
+
+    // Fill the row read from kvstore, return false if it is not admitted
+    bool insert(const Key& key, std::string val, uint64_t epoch);
+
+    // Write through the row which has been committed
+    bool put(const Key& key, std::string val);
+
+    void evict(const Key& key);
+
+    // Drop all rows of the part, e.g. when the leadership of the part changes. The
+    // epoch of every bucket is bumped, so the rows being read are not filled either
+    void evictPart(GraphSpaceID spaceId, PartitionID partId);
+
+    // The bytes charged for a row of the given size
+    static size_t charge(size_t valSize) {
+        return sizeof(Key) + valSize + kEntryOverhead;
+    }
+
+    uint64_t hits() const {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t evicts() const {
+        return evicts_.load(std::memory_order_relaxed);
+    }
+
+    // Number of rows not admitted because they were colder than the victim
+    uint64_t rejects() const {
+        return rejects_.load(std::memory_order_relaxed);
+    }
+
+    size_t bytes();
+
+private:
+    // The list node, the hash node and the std::string itself
+    static constexpr size_t kEntryOverhead = 96;
+
+    struct Value {
+        std::string                 val;
+        std::list<Key>::iterator    pos;
+    };
+
+    using Map = std::unordered_map<Key, Value, KeyHash>;
+
+    struct Bucket {
+        std::mutex      lock;
+        std::list<Key>  lru;
+        Map             map;
+        size_t          bytes{0};
+        uint64_t        epoch{0};
+    };
+
+    class FrequencySketch final {
+    public:
+        explicit FrequencySketch(size_t width);
+
+        void increment(uint64_t hash);
+
+        uint8_t frequency(uint64_t hash) const;
+
+    private:
+        static constexpr size_t kDepth = 4;
+        static constexpr uint8_t kMaxCount = 15;
+
+        size_t index(uint64_t hash, size_t row) const {
+            uint64_t h2 = (hash >> 32) | 0x01;
+            return row * width_ + ((hash + row * h2) & (width_ - 1));
+        }
+
+        size_t                              width_;
+        std::vector<std::atomic<uint8_t>>   counters_;
+        std::atomic<uint64_t>               additions_{0};
+        uint64_t                            sampleSize_;
+    };
+
+    Bucket& bucket(uint64_t hash) {
+        return buckets_[hash & bucketsMask_];
+    }
+
+    // Must hold the bucket lock. Make room for a new row of the given charge,
+    // return false if the new row is colder than a victim
+    bool admit(Bucket& b, uint64_t hash, size_t charge);
+
+    // Must hold the bucket lock
+    void add(Bucket& b, const Key& key, std::string val);
+
+    // Must hold the bucket lock
+    void erase(Bucket& b, Map::iterator it);
+
+    std::vector<Bucket>         buckets_;
+    size_t                      bucketsMask_;
+    size_t                      capacityPerBucket_;
+    stats::Stats*               stats_{nullptr};
+    FrequencySketch             sketch_;
+
+    std::atomic<uint64_t>       hits_{0};
+    std::atomic<uint64_t>       total_{0};
+    std::atomic<uint64_t>       evicts_{0};
+    std::atomic<uint64_t>       rejects_{0};
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_CACHE_VERTEXCACHE_H_
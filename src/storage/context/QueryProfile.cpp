@@ -0,0 +1,172 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/context/QueryProfile.h"
+#include "common/stats/StatsManager.h"
+#include <folly/json.h>
+#include <folly/Random.h>
+#include <rocksdb/perf_context.h>
+#include <rocksdb/iostats_context.h>
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+std::mutex gLock;
+// name of the histogram => index in StatsManager
+std::unordered_map<std::string, int32_t> gHistos;
+std::deque<folly::dynamic> gLatest;
+
+// The range of a histogram is decided by the unit in its name
+int32_t histoIndex(const std::string& name) {
+    std::lock_guard<std::mutex> g(gLock);
+    auto it = gHistos.find(name);
+    if (it != gHistos.end()) {
+        return it->second;
+    }
+    int32_t index;
+    if (folly::StringPiece(name).endsWith("_us")) {
+        index = stats::StatsManager::registerHisto(name, 1000, 0, 1000000);
+    } else if (folly::StringPiece(name).endsWith("_bytes")) {
+        index = stats::StatsManager::registerHisto(name, 64 * 1024, 0, 64 * 1024 * 1024);
+    } else {
+        index = stats::StatsManager::registerHisto(name, 100, 0, 100000);
+    }
+    gHistos.emplace(name, index);
+    return index;
+}
+
+}  // namespace
+
+QueryProfile::~QueryProfile() {
+    if (started_) {
+        rocksdb::SetPerfLevel(perfLevel_);
+    }
+}
+
+// static
+bool QueryProfile::sampled() {
+    return FLAGS_query_profile_sample_rate > 0 &&
+           folly::Random::oneIn(FLAGS_query_profile_sample_rate);
+}
+
+// static
+std::string QueryProfile::latest() {
+    folly::dynamic profiles = folly::dynamic::array();
+    {
+        std::lock_guard<std::mutex> g(gLock);
+        for (auto it = gLatest.rbegin(); it != gLatest.rend(); ++it) {
+            profiles.push_back(*it);
+        }
+    }
+    return folly::toPrettyJson(profiles);
+}
+
+void QueryProfile::start() {
+    perfLevel_ = rocksdb::GetPerfLevel();
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableTimeExceptForMutex);
+    rocksdb::get_perf_context()->Reset();
+    rocksdb::get_iostats_context()->Reset();
+    started_ = true;
+    duration_.reset();
+}
+
+void QueryProfile::stop() {
+    if (!started_) {
+        return;
+    }
+    latencyInUs_ = duration_.elapsedInUSec();
+    const auto* perf = rocksdb::get_perf_context();
+    const auto* io = rocksdb::get_iostats_context();
+    counters_ = {
+        {"block_cache_hits", perf->block_cache_hit_count},
+        {"block_reads", perf->block_read_count},
+        {"block_read_bytes", perf->block_read_byte},
+        {"block_read_us", perf->block_read_time / 1000},
+        {"iter_read_bytes", perf->iter_read_bytes},
+        {"get_read_bytes", perf->get_read_bytes},
+        {"memtable_gets", perf->get_from_memtable_count},
+        {"memtable_seeks", perf->seek_on_memtable_count},
+        {"child_seeks", perf->seek_child_seek_count},
+        {"internal_keys_skipped", perf->internal_key_skipped_count},
+        {"internal_deletes_skipped", perf->internal_delete_skipped_count},
+        {"io_read_bytes", io->bytes_read},
+        {"io_read_us", io->read_nanos / 1000},
+    };
+    rocksdb::SetPerfLevel(perfLevel_);
+    started_ = false;
+}
+
+void QueryProfile::addNode(const std::string& name,
+                           int64_t calls,
+                           int64_t latencyInUs,
+                           int64_t rows) {
+    auto it = std::find_if(nodes_.begin(), nodes_.end(),
+                           [&name] (const auto& node) { return node.name == name; });
+    if (it == nodes_.end()) {
+        nodes_.emplace_back();
+        it = nodes_.end() - 1;
+        it->name = name;
+    }
+    it->calls += calls;
+    it->latencyInUs += latencyInUs;
+    it->rows += rows;
+}
+
+int64_t QueryProfile::counter(const std::string& name) const {
+    for (const auto& counter : counters_) {
+        if (counter.first == name) {
+            return counter.second;
+        }
+    }
+    return 0;
+}
+
+folly::dynamic QueryProfile::toDynamic() const {
+    folly::dynamic nodes = folly::dynamic::array();
+    for (const auto& node : nodes_) {
+        nodes.push_back(folly::dynamic::object("name", node.name)
+                                              ("calls", node.calls)
+                                              ("latency_us", node.latencyInUs)
+                                              ("rows", node.rows));
+    }
+    folly::dynamic counters = folly::dynamic::object();
+    for (const auto& counter : counters_) {
+        counters[counter.first] = counter.second;
+    }
+    return folly::dynamic::object("method", method_)
+                                 ("latency_us", latencyInUs_)
+                                 ("versions_skipped", versionsSkipped_)
+                                 ("nodes", std::move(nodes))
+                                 ("rocksdb", std::move(counters));
+}
+
+void QueryProfile::report() const {
+    auto prefix = method_ + "_profile_";
+    stats::StatsManager::addValue(histoIndex(prefix + "latency_us"), latencyInUs_);
+    stats::StatsManager::addValue(histoIndex(prefix + "versions_skipped"), versionsSkipped_);
+    for (const auto& node : nodes_) {
+        stats::StatsManager::addValue(histoIndex(prefix + node.name + "_latency_us"),
+                                      node.latencyInUs);
+        stats::StatsManager::addValue(histoIndex(prefix + node.name + "_rows"), node.rows);
+    }
+    for (const auto& counter : counters_) {
+        stats::StatsManager::addValue(histoIndex(prefix + counter.first), counter.second);
+    }
+
+    auto profile = toDynamic();
+    VLOG(1) << "Profile of " << method_ << ": " << folly::toJson(profile);
+    std::lock_guard<std::mutex> g(gLock);
+    gLatest.emplace_back(std::move(profile));
+    while (gLatest.size() > static_cast<size_t>(std::max(FLAGS_query_profile_keep_num, 0))) {
+        gLatest.pop_front();
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
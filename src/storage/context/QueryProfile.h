@@ -0,0 +1,85 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_CONTEXT_QUERYPROFILE_H_
+#define STORAGE_CONTEXT_QUERYPROFILE_H_
+
+#include "common/base/Base.h"
+#include "common/time/Duration.h"
+#include <folly/dynamic.h>
+#include <rocksdb/perf_level.h>
+
+namespace nebula {
+namespace storage {
+
+/**
+ * The execution profile of a query request. It has the time and rows of each node in the
+ * plan, the versions of edges skipped, and the perf and io counters of rocksdb read by the
+ * thread running the plan between start and stop.
+ *
+ * A profile is reported into the histograms of its method, which are served by the stats of
+ * the http service, and the latest ones are kept to be shown by the admin http handler.
+ * */
+class QueryProfile final {
+public:
+    explicit QueryProfile(std::string method)
+        : method_(std::move(method)) {}
+
+    ~QueryProfile();
+
+    // Whether to profile a request, one of every query_profile_sample_rate
+    static bool sampled();
+
+    // The json array of the latest profiles, the latest one first
+    static std::string latest();
+
+    // Start counting the rocksdb perf and io stats of the current thread
+    void start();
+
+    // Stop counting and take the counters, must be called in the thread calling start
+    void stop();
+
+    // The nodes of the same name are added together
+    void addNode(const std::string& name, int64_t calls, int64_t latencyInUs, int64_t rows);
+
+    void addVersionsSkipped(int64_t num = 1) {
+        versionsSkipped_ += num;
+    }
+
+    int64_t versionsSkipped() const {
+        return versionsSkipped_;
+    }
+
+    int64_t counter(const std::string& name) const;
+
+    folly::dynamic toDynamic() const;
+
+    // Add the profile into the histograms, and keep it as one of the latest profiles
+    void report() const;
+
+private:
+    struct NodeStat {
+        std::string name;
+        int64_t     calls{0};
+        int64_t     latencyInUs{0};
+        int64_t     rows{0};
+    };
+
+    std::string                                     method_;
+    time::Duration                                  duration_;
+    int64_t                                         latencyInUs_{0};
+    bool                                            started_{false};
+    rocksdb::PerfLevel                              perfLevel_;
+    // in the order of being added
+    std::vector<NodeStat>                           nodes_;
+    int64_t                                         versionsSkipped_{0};
+    std::vector<std::pair<std::string, int64_t>>    counters_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_CONTEXT_QUERYPROFILE_H_
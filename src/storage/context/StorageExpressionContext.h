@@ -129,7 +129,7 @@ public:
 private:
     size_t                             vIdLen_;
 
-    RowReader                         *reader_;
+    RowReader                         *reader_{nullptr};
     folly::StringPiece                 key_;
     // tag or edge name
     std::string                        name_;
@@ -29,8 +29,9 @@ struct PropStat {
 
 // AggregateNode will only be used in GetNeighbors for now, it need to calculate some stat of all
 // valid edges of a vertex. It could be used in ScanVertex or ScanEdge later.
-// The stat is collected during we iterate over edges via `next`, so if you want to get the
-// final result, be sure to call `calculateStat` and then retrieve the reuslt
+// The stat of an edge is collected when the iterator arrives at it, so the edges after the
+// limit are never read. If you want to get the final result, be sure to call `calculateStat`
+// and then retrieve the reuslt
 template<typename T>
 class AggregateNode : public IterateNode<T> {
 public:
@@ -51,16 +52,13 @@ public:
             initStatValue(edgeContext_);
         }
         this->result_ = NullType::__NULL__;
+        collect();
         return kvstore::ResultCode::SUCCEEDED;
     }
 
     void next() override {
-        if (!stats_.empty()) {
-            // we need to collect the stat during `next`
-            collectEdgeStats(srcId(), edgeType(), edgeRank(), dstId(),
-                             this->reader(), planContext_->props_);
-        }
         IterateNode<T>::next();
+        collect();
     }
 
     void calculateStat() {
@@ -86,6 +84,18 @@ public:
     }
 
 private:
+    // collect the stat of the edge which the iterator points to
+    void collect() {
+        if (!this->valid()) {
+            return;
+        }
+        this->rows_++;
+        if (!stats_.empty()) {
+            collectEdgeStats(srcId(), edgeType(), edgeRank(), dstId(),
+                             this->reader(), planContext_->props_);
+        }
+    }
+
     VertexIDSlice srcId() const {
         return NebulaKeyUtils::getSrcId(planContext_->vIdLen_, this->key());
     }
@@ -130,12 +140,18 @@ private:
             if (prop.hasStat_) {
                 for (const auto statIndex : prop.statIndex_) {
                     VLOG(2) << "Collect stat prop " << prop.name_ << ", type " << edgeType;
+                    auto& stat = stats_[statIndex];
+                    if (stat.statType_ == cpp2::StatType::COUNT) {
+                        // COUNT does not care about the value, so it is not decoded
+                        stat.count_ = stat.count_ + 1;
+                        continue;
+                    }
                     auto value = QueryUtils::readEdgeProp(srcId, edgeType, edgeRank, dstId,
                                                           reader, prop);
                     if (!value.ok()) {
                         return kvstore::ResultCode::ERR_EDGE_PROP_NOT_FOUND;
                     }
-                    addStatValue(std::move(value).value(), stats_[statIndex]);
+                    addStatValue(std::move(value).value(), stat);
                 }
             }
         }
@@ -10,6 +10,8 @@
 #include "common/base/Base.h"
 #include "storage/exec/RelNode.h"
 #include "storage/exec/StorageIterator.h"
+#include "storage/cache/AdjacencyCache.h"
+#include "storage/StorageFlags.h"
 
 namespace nebula {
 namespace storage {
@@ -23,6 +25,11 @@ public:
         return iter_.get();
     }
 
+    // Return the iterator of the edges, open it first if it is opened lazily
+    virtual SingleEdgeIterator* open() {
+        return iter_.get();
+    }
+
     kvstore::ResultCode collectEdgePropsIfValid(NullHandler nullHandler,
                                                 EdgePropHandler valueHandler) {
         if (!iter_ || !iter_->valid()) {
@@ -120,21 +127,25 @@ public:
 
         VLOG(1) << "partId " << partId << ", edgeType " << edgeType_
                 << ", prop size " << props_->size();
-        if (edgeType_ !=  edgeKey.edge_type) {
+        if (edgeType_ !=  edgeKey.edge_type ||
+            DroppedSchemas::instance()->isEdgeDropped(planContext_->spaceId_, edgeType_)) {
             iter_.reset();
             return kvstore::ResultCode::SUCCEEDED;
         }
-        prefix_ = NebulaKeyUtils::edgePrefix(planContext_->vIdLen_,
+        prefix_ = NebulaKeyUtils::edgePrefix(planContext_->spaceId_,
+                                             planContext_->vIdLen_,
                                              partId,
                                              edgeKey.src,
                                              edgeKey.edge_type,
                                              edgeKey.ranking,
                                              edgeKey.dst);
         std::unique_ptr<kvstore::KVIterator> iter;
-        ret = planContext_->env_->kvstore_->prefix(planContext_->spaceId_, partId, prefix_, &iter);
+        ret = CommonUtils::edgePrefix(planContext_->env_->kvstore_, planContext_->spaceId_,
+                                      partId, prefix_, &iter);
         if (ret == kvstore::ResultCode::SUCCEEDED && iter && iter->valid()) {
             iter_.reset(new SingleEdgeIterator(
                 planContext_, std::move(iter), edgeType_, schemas_, &ttl_, false));
+            rows_ += iter_->valid();
         } else {
             iter_.reset();
         }
@@ -142,7 +153,11 @@ public:
     }
 };
 
-// SingleEdgeNode is used to scan all edges of a specified edgeType of the same srcId
+// SingleEdgeNode is used to scan all edges of a specified edgeType of the same srcId.
+// The edges are read when the node is opened, rather than executed, so that the types
+// not reached by the HashJoinNode are not read at all.
+// If keyOnly is true, the values of the edges are not decoded, it is used when no returned
+// prop, filter or stat needs the values. It is ignored if the edge type has ttl.
 class SingleEdgeNode final : public EdgeNode<VertexID> {
 public:
     SingleEdgeNode(PlanContext* planCtx,
@@ -150,8 +165,10 @@ public:
                    EdgeType edgeType,
                    const std::vector<PropContext>* props,
                    ExpressionContext* expCtx = nullptr,
-                   Expression* exp = nullptr)
-        : EdgeNode(planCtx, ctx, edgeType, props, expCtx, exp) {}
+                   Expression* exp = nullptr,
+                   bool keyOnly = false)
+        : EdgeNode(planCtx, ctx, edgeType, props, expCtx, exp)
+        , keyOnly_(keyOnly && !ttl_.hasValue()) {}
 
     kvstore::ResultCode execute(PartitionID partId, const VertexID& vId) override {
         auto ret = RelNode::execute(partId, vId);
@@ -159,19 +176,91 @@ public:
             return ret;
         }
 
-        VLOG(1) << "partId " << partId << ", vId " << vId << ", edgeType " << edgeType_
+        // The vertex outlives the execution of the plan for it
+        partId_ = partId;
+        vId_ = &vId;
+        opened_ = false;
+        iter_.reset();
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    SingleEdgeIterator* open() override {
+        if (opened_ || vId_ == nullptr) {
+            return iter_.get();
+        }
+        opened_ = true;
+        const auto& vId = *vId_;
+        VLOG(1) << "partId " << partId_ << ", vId " << vId << ", edgeType " << edgeType_
                 << ", prop size " << props_->size();
+        if (DroppedSchemas::instance()->isEdgeDropped(planContext_->spaceId_, edgeType_)) {
+            return nullptr;
+        }
         std::unique_ptr<kvstore::KVIterator> iter;
-        prefix_ = NebulaKeyUtils::edgePrefix(planContext_->vIdLen_, partId, vId, edgeType_);
-        ret = planContext_->env_->kvstore_->prefix(planContext_->spaceId_, partId, prefix_, &iter);
+        kvstore::ResultCode ret;
+        prefix_ = NebulaKeyUtils::edgePrefix(planContext_->spaceId_, planContext_->vIdLen_,
+                                             partId_, vId, edgeType_);
+        if (FLAGS_enable_adjacency_cache && edgeContext_->adjacencyCache_ != nullptr) {
+            ret = cachedPrefix(partId_, vId, &iter);
+        } else {
+            ret = CommonUtils::edgePrefix(planContext_->env_->kvstore_, planContext_->spaceId_,
+                                          partId_, prefix_, &iter);
+        }
         if (ret == kvstore::ResultCode::SUCCEEDED && iter && iter->valid()) {
             iter_.reset(new SingleEdgeIterator(
-                planContext_, std::move(iter), edgeType_, schemas_, &ttl_));
-        } else {
-            iter_.reset();
+                planContext_, std::move(iter), edgeType_, schemas_, &ttl_, true, keyOnly_));
+            rows_ += iter_->valid();
         }
+        return iter_.get();
+    }
+
+private:
+    // Serve the edges from the adjacency cache. When the cache misses and the
+    // vertex is hot, the whole edge list is read and cached if it is big enough.
+    // The cache is only served by the leader, a former leader misses the writes.
+    kvstore::ResultCode cachedPrefix(PartitionID partId,
+                                     const VertexID& vId,
+                                     std::unique_ptr<kvstore::KVIterator>* iter) {
+        auto* cache = edgeContext_->adjacencyCache_;
+        auto* kvstore = planContext_->env_->kvstore_;
+        auto key = AdjacencyCache::cacheKey(planContext_->spaceId_, planContext_->vIdLen_,
+                                            partId, vId, edgeType_);
+        auto hot = cache->touch(key);
+        auto list = cache->get(key);
+        if (list != nullptr) {
+            auto ret = kvstore->checkLeader(planContext_->spaceId_, partId);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                return ret;
+            }
+            iter->reset(new AdjacencyIterator(std::move(list)));
+            return kvstore::ResultCode::SUCCEEDED;
+        }
+
+        if (!hot) {
+            return CommonUtils::edgePrefix(kvstore, planContext_->spaceId_, partId, prefix_, iter);
+        }
+        auto epoch = cache->epoch(key);
+        std::unique_ptr<kvstore::KVIterator> kvIter;
+        auto ret = CommonUtils::edgePrefix(kvstore, planContext_->spaceId_, partId,
+                                           prefix_, &kvIter);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        auto edges = std::make_shared<AdjacencyList>();
+        for (; kvIter->valid(); kvIter->next()) {
+            edges->add(kvIter->key(), kvIter->val());
+        }
+        if (edges->size() >= static_cast<size_t>(FLAGS_adjacency_cache_min_degree)) {
+            edges->shrink();
+            cache->insert(key, edges, epoch);
+        }
+        iter->reset(new AdjacencyIterator(std::move(edges)));
         return kvstore::ResultCode::SUCCEEDED;
     }
+
+    bool                keyOnly_{false};
+    PartitionID         partId_{0};
+    const VertexID*     vId_{nullptr};
+    bool                opened_{false};
 };
 
 }  // namespace storage
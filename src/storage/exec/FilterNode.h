@@ -67,10 +67,12 @@ private:
             // NULL is always false
             auto ret = result.toBool();
             if (ret.ok() && ret.value()) {
+                this->rows_++;
                 return true;
             }
             return false;
         }
+        this->rows_++;
         return true;
     }
 
@@ -8,9 +8,10 @@
 #define STORAGE_EXEC_GETNEIGHBORSNODE_H_
 
 #include "common/base/Base.h"
-#include "common/algorithm/ReservoirSampling.h"
+#include <folly/hash/Hash.h>
 #include "storage/exec/AggregateNode.h"
 #include "storage/exec/HashJoinNode.h"
+#include "storage/exec/StreamingSampler.h"
 
 namespace nebula {
 namespace storage {
@@ -64,6 +65,10 @@ public:
         if (ret != kvstore::ResultCode::SUCCEEDED) {
             return ret;
         }
+        // the edges are read during iterating, so the illegal data may be found here
+        if (planContext_->resultStat_ == ResultStatus::ILLEGAL_DATA) {
+            return kvstore::ResultCode::ERR_INVALID_DATA;
+        }
 
         aggregateNode_->calculateStat();
         if (aggregateNode_->result().type() == Value::Type::LIST) {
@@ -81,10 +86,7 @@ protected:
     virtual kvstore::ResultCode iterateEdges(std::vector<Value>& row) {
         int64_t edgeRowCount = 0;
         nebula::List list;
-        for (; aggregateNode_->valid(); aggregateNode_->next(), ++edgeRowCount) {
-            if (limit_ > 0 && edgeRowCount >= limit_) {
-                return kvstore::ResultCode::SUCCEEDED;
-            }
+        for (; aggregateNode_->valid(); aggregateNode_->next()) {
             auto key = aggregateNode_->key();
             auto reader = aggregateNode_->reader();
             auto edgeType = planContext_->edgeType_;
@@ -108,6 +110,11 @@ protected:
             }
             auto& cell = row[columnIdx].mutableList();
             cell.values.emplace_back(std::move(list));
+            rows_++;
+            // stop right after the last edge, so the edges after it are not read at all
+            if (limit_ > 0 && ++edgeRowCount >= limit_) {
+                break;
+            }
         }
         return kvstore::ResultCode::SUCCEEDED;
     }
@@ -120,6 +127,10 @@ protected:
     int64_t limit_;
 };
 
+// GetNeighborsSampleNode samples at most limit_ edges of each vertex. Whether an edge is
+// accepted is decided before copying it, so the edges rejected by the reservoir cost nothing
+// more than iterating. If weightProp is not empty, the chance of an edge to be sampled is
+// proportional to the value of the prop, edges without a numeric value of it weigh 1.
 class GetNeighborsSampleNode : public GetNeighborsNode {
 public:
     GetNeighborsSampleNode(PlanContext* planCtx,
@@ -127,72 +138,104 @@ public:
                            AggregateNode<VertexID>* aggregateNode,
                            EdgeContext* edgeContext,
                            nebula::DataSet* resultDataSet,
-                           int64_t limit)
+                           int64_t limit,
+                           uint64_t seed = 0,
+                           std::string weightProp = "")
         : GetNeighborsNode(planCtx, hashJoinNode, aggregateNode, edgeContext, resultDataSet, limit)
-        , sampler_(std::make_unique<nebula::algorithm::ReservoirSampling<Sample>>(limit_)) {}
+        , seed_(seed)
+        , weightProp_(std::move(weightProp))
+        , sampler_(std::max<int64_t>(limit_, 0)) {}
 
 private:
-    using Sample = std::tuple<EdgeType,
-                              std::string,
-                              std::string,
-                              const std::vector<PropContext>*,
-                              size_t>;
+    struct Sample {
+        EdgeType                            edgeType;
+        std::string                         key;
+        std::string                         val;
+        const std::vector<PropContext>*     props;
+        size_t                              columnIdx;
+    };
 
     kvstore::ResultCode iterateEdges(std::vector<Value>& row) override {
-        int64_t edgeRowCount = 0;
-        nebula::List list;
-        for (; aggregateNode_->valid(); aggregateNode_->next(), ++edgeRowCount) {
-            auto val = aggregateNode_->val();
+        // The samples of a vertex only depend on the seed and the vertex, no matter in which
+        // order the vertices are processed
+        auto vIdHash = std::hash<std::string>()(row[0].getStr());
+        sampler_.reset(folly::hash::twang_mix64(seed_ ^ vIdHash));
+        for (; aggregateNode_->valid(); aggregateNode_->next()) {
+            auto idx = weightProp_.empty() ? sampler_.offer() : sampler_.offer(weight());
+            if (idx < 0) {
+                continue;
+            }
             auto key = aggregateNode_->key();
-            auto edgeType = planContext_->edgeType_;
-            auto props = planContext_->props_;
-            auto columnIdx = planContext_->columnIdx_;
-            sampler_->sampling(std::make_tuple(edgeType, val.str(), key.str(), props, columnIdx));
+            auto val = aggregateNode_->val();
+            auto& sample = sampler_.slot(idx);
+            sample.edgeType = planContext_->edgeType_;
+            // reuse the buffer of the slot
+            sample.key.assign(key.data(), key.size());
+            sample.val.assign(val.data(), val.size());
+            sample.props = planContext_->props_;
+            sample.columnIdx = planContext_->columnIdx_;
         }
 
         std::unique_ptr<RowReader> reader;
-        auto samples = std::move(*sampler_).samples();
-        for (auto& sample : samples) {
-            auto columnIdx = std::get<4>(sample);
+        nebula::List list;
+        for (size_t i = 0; i < sampler_.size(); i++) {
+            const auto& sample = sampler_.slot(i);
+            auto columnIdx = sample.columnIdx;
             // add edge prop value to the target column
             if (row[columnIdx].type() == Value::Type::NULLVALUE) {
                 row[columnIdx].setList(nebula::List());
             }
 
-            auto edgeType = std::get<0>(sample);
-            auto val = std::get<1>(sample);
+            auto edgeType = sample.edgeType;
             if (!reader) {
                 reader = RowReader::getEdgePropReader(planContext_->env_->schemaMan_,
                                                       planContext_->spaceId_,
                                                       std::abs(edgeType),
-                                                      val);
+                                                      sample.val);
                 if (!reader) {
                     continue;
                 }
             } else if (!reader->resetEdgePropReader(planContext_->env_->schemaMan_,
                                                     planContext_->spaceId_,
                                                     std::abs(edgeType),
-                                                    val)) {
+                                                    sample.val)) {
                 continue;
             }
 
             auto ret = collectEdgeProps(edgeType,
                                         reader.get(),
-                                        std::get<2>(sample),
+                                        sample.key,
                                         planContext_->vIdLen_,
-                                        std::get<3>(sample),
+                                        sample.props,
                                         list);
             if (ret != kvstore::ResultCode::SUCCEEDED) {
                 continue;
             }
             auto& cell = row[columnIdx].mutableList();
             cell.values.emplace_back(std::move(list));
+            rows_++;
         }
 
         return kvstore::ResultCode::SUCCEEDED;
     }
 
-    std::unique_ptr<nebula::algorithm::ReservoirSampling<Sample>> sampler_;
+    double weight() const {
+        auto* reader = aggregateNode_->reader();
+        if (reader == nullptr) {
+            return 1.0;
+        }
+        auto value = reader->getValueByName(weightProp_);
+        if (value.isInt()) {
+            return static_cast<double>(value.getInt());
+        } else if (value.isFloat()) {
+            return value.getFloat();
+        }
+        return 1.0;
+    }
+
+    uint64_t                    seed_;
+    std::string                 weightProp_;
+    StreamingSampler<Sample>    sampler_;
 };
 
 }  // namespace storage
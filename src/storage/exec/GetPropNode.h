@@ -64,6 +64,7 @@ public:
             }
         }
         resultDataSet_->rows.emplace_back(std::move(row));
+        rows_++;
         return kvstore::ResultCode::SUCCEEDED;
     }
 
@@ -123,6 +124,7 @@ public:
             }
         }
         resultDataSet_->rows.emplace_back(std::move(row));
+        rows_++;
         return kvstore::ResultCode::SUCCEEDED;
     }
 
@@ -21,6 +21,7 @@ namespace storage {
 // The output would be the result of tag, it is a List, each cell save a list of property values,
 // if tag not found, it will be a NullType::__NULL__.
 // Also it will return a iterator of edges which can pass ttl check and ready to be read.
+// The edges of a type are read only when the iterator reaches the type.
 class HashJoinNode : public IterateNode<VertexID> {
 public:
     HashJoinNode(PlanContext* planCtx,
@@ -83,13 +84,15 @@ public:
             }
         }
 
-        std::vector<SingleEdgeIterator*> iters;
+        std::vector<MultiEdgeIterator::Opener> openers;
+        openers.reserve(edgeNodes_.size());
         for (auto* edgeNode : edgeNodes_) {
-            iters.emplace_back(edgeNode->iter());
+            openers.emplace_back([edgeNode] { return edgeNode->open(); });
         }
-        iter_.reset(new MultiEdgeIterator(std::move(iters)));
+        iter_.reset(new MultiEdgeIterator(std::move(openers)));
         if (iter_->valid()) {
             setCurrentEdgeInfo();
+            rows_++;
         }
         return kvstore::ResultCode::SUCCEEDED;
     }
@@ -102,6 +105,7 @@ public:
         iter_->next();
         if (iter_->valid()) {
             setCurrentEdgeInfo();
+            rows_++;
         }
     }
 
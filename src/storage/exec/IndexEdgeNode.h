@@ -0,0 +1,103 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INDEXEDGENODE_H_
+#define STORAGE_EXEC_INDEXEDGENODE_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/IndexScanNode.h"
+
+namespace nebula {
+namespace storage {
+
+// IndexEdgeNode reads the latest version of the edge which the index key points to. It is
+// only in the plan when some of the props are not in the index, the index keys whose edge
+// is missing or expired are skipped.
+template<typename T>
+class IndexEdgeNode final : public IterateNode<T> {
+public:
+    IndexEdgeNode(PlanContext* planCtx,
+                  EdgeContext* ctx,
+                  EdgeType edgeType,
+                  IndexScanNode<T>* indexScanNode)
+        : IterateNode<T>(indexScanNode)
+        , planContext_(planCtx)
+        , edgeContext_(ctx)
+        , edgeType_(edgeType)
+        , indexScanNode_(indexScanNode) {
+        auto schemaIter = edgeContext_->schemas_.find(std::abs(edgeType_));
+        CHECK(schemaIter != edgeContext_->schemas_.end());
+        CHECK(!schemaIter->second.empty());
+        schemas_ = &(schemaIter->second);
+        ttl_ = QueryUtils::getEdgeTTLInfo(edgeContext_, edgeType_);
+    }
+
+    kvstore::ResultCode execute(PartitionID partId, const T& input) override {
+        auto ret = RelNode<T>::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        partId_ = partId;
+        if (this->valid() && !check()) {
+            this->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+    RowReader* reader() const override {
+        if (iter_) {
+            return iter_->reader();
+        }
+        return nullptr;
+    }
+
+private:
+    // return true when the edge is found
+    bool check() override {
+        prefix_ = NebulaKeyUtils::edgePrefix(planContext_->spaceId_,
+                                             planContext_->vIdLen_,
+                                             partId_,
+                                             indexScanNode_->srcId().str(),
+                                             edgeType_,
+                                             indexScanNode_->rank(),
+                                             indexScanNode_->dstId().str());
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto ret = CommonUtils::edgePrefix(planContext_->env_->kvstore_,
+                                           planContext_->spaceId_,
+                                           partId_,
+                                           prefix_,
+                                           &iter);
+        if (ret != kvstore::ResultCode::SUCCEEDED || !iter || !iter->valid()) {
+            VLOG(1) << "Edge of index key is missing, edgeType " << edgeType_;
+            iter_.reset();
+            return false;
+        }
+        iter_.reset(new SingleEdgeIterator(
+            planContext_, std::move(iter), edgeType_, schemas_, &ttl_, false));
+        return iter_->valid();
+    }
+
+private:
+    PlanContext                                                          *planContext_;
+    EdgeContext                                                          *edgeContext_;
+    EdgeType                                                              edgeType_;
+    IndexScanNode<T>                                                     *indexScanNode_;
+    const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> *schemas_ = nullptr;
+    folly::Optional<std::pair<std::string, int64_t>>                      ttl_;
+
+    PartitionID                                                           partId_;
+    std::unique_ptr<StorageIterator>                                      iter_;
+    std::string                                                           prefix_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INDEXEDGENODE_H_
@@ -0,0 +1,91 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INDEXFILTERNODE_H_
+#define STORAGE_EXEC_INDEXFILTERNODE_H_
+
+#include "common/base/Base.h"
+#include "common/expression/Expression.h"
+#include "storage/exec/IndexScanNode.h"
+#include "storage/context/StorageExpressionContext.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+IndexFilterNode checks the filter of LookUp on each row from upstream. The upstream is
+either the IndexScanNode, when all props in the filter are in the index, or the node
+reading the data row. The props in the filter are read by the IndexScanNode, which decodes
+the index key if it could, and set into the expression context by name, so the filter
+is evaluated in the same way no matter where the values come from.
+*/
+template<typename T>
+class IndexFilterNode final : public IterateNode<T> {
+public:
+    IndexFilterNode(IterateNode<T>* upstream,
+                    IndexScanNode<T>* indexScanNode,
+                    StorageExpressionContext* expCtx,
+                    Expression* exp,
+                    const std::vector<PropContext>* props,
+                    const std::string& name,
+                    bool isEdge)
+        : IterateNode<T>(upstream)
+        , indexScanNode_(indexScanNode)
+        , expCtx_(expCtx)
+        , filterExp_(exp)
+        , props_(props)
+        , name_(name)
+        , isEdge_(isEdge) {}
+
+    kvstore::ResultCode execute(PartitionID partId, const T& input) override {
+        auto ret = RelNode<T>::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        if (this->valid() && !check()) {
+            this->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+private:
+    // return true when the row passes the filter
+    bool check() override {
+        expCtx_->clear();
+        for (const auto& prop : *props_) {
+            if (!prop.filtered_) {
+                continue;
+            }
+            auto value = indexScanNode_->readValue(prop, this->reader());
+            if (!value.ok()) {
+                VLOG(1) << "Fail to read filter prop " << prop.name_;
+                return false;
+            }
+            if (isEdge_) {
+                expCtx_->setEdgeProp(name_, prop.name_, std::move(value).value());
+            } else {
+                expCtx_->setTagProp(name_, prop.name_, std::move(value).value());
+            }
+        }
+        auto result = filterExp_->eval(*expCtx_);
+        // NULL is always false
+        auto ret = result.toBool();
+        return ret.ok() && ret.value();
+    }
+
+private:
+    IndexScanNode<T>                 *indexScanNode_;
+    StorageExpressionContext         *expCtx_;
+    Expression                       *filterExp_;
+    const std::vector<PropContext>   *props_;
+    std::string                       name_;
+    bool                              isEdge_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INDEXFILTERNODE_H_
@@ -0,0 +1,89 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INDEXOUTPUTNODE_H_
+#define STORAGE_EXEC_INDEXOUTPUTNODE_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/IndexScanNode.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+IndexOutputNode pulls the rows from upstream and puts them into the result DataSet. The
+first columns are the vertex id of a tag index, or _src, _rank and _dst of an edge index,
+followed by the returned props.
+
+It stops pulling once the limit is reached, so the index keys after it are never read.
+*/
+template<typename T>
+class IndexOutputNode final : public RelNode<T> {
+public:
+    IndexOutputNode(IterateNode<T>* upstream,
+                    IndexScanNode<T>* indexScanNode,
+                    const std::vector<PropContext>* props,
+                    bool isEdge,
+                    int64_t limit,
+                    nebula::DataSet* result)
+        : upstream_(upstream)
+        , indexScanNode_(indexScanNode)
+        , props_(props)
+        , isEdge_(isEdge)
+        , limit_(limit)
+        , result_(result) {}
+
+    kvstore::ResultCode execute(PartitionID partId, const T& input) override {
+        auto ret = RelNode<T>::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+
+        int64_t count = 0;
+        while (upstream_->valid() && (limit_ < 0 || count < limit_)) {
+            std::vector<Value> row;
+            if (isEdge_) {
+                row.emplace_back(indexScanNode_->srcId().str());
+                row.emplace_back(indexScanNode_->rank());
+                row.emplace_back(indexScanNode_->dstId().str());
+            } else {
+                row.emplace_back(indexScanNode_->vertexId().str());
+            }
+            for (const auto& prop : *props_) {
+                if (!prop.returned_) {
+                    continue;
+                }
+                auto value = indexScanNode_->readValue(prop, upstream_->reader());
+                if (!value.ok()) {
+                    return isEdge_ ? kvstore::ResultCode::ERR_EDGE_PROP_NOT_FOUND
+                                   : kvstore::ResultCode::ERR_TAG_PROP_NOT_FOUND;
+                }
+                row.emplace_back(std::move(value).value());
+            }
+            result_->rows.emplace_back(std::move(row));
+            // don't move forward once the limit is reached
+            if (limit_ >= 0 && ++count >= limit_) {
+                break;
+            }
+            upstream_->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+private:
+    IterateNode<T>                   *upstream_;
+    IndexScanNode<T>                 *indexScanNode_;
+    const std::vector<PropContext>   *props_;
+    bool                              isEdge_;
+    // negative means no limit
+    int64_t                           limit_;
+    nebula::DataSet                  *result_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INDEXOUTPUTNODE_H_
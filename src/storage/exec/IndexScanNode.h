@@ -0,0 +1,249 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INDEXSCANNODE_H_
+#define STORAGE_EXEC_INDEXSCANNODE_H_
+
+#include "common/base/Base.h"
+#include "utils/IndexKeyUtils.h"
+#include "storage/exec/RelNode.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+IndexScanNode iterates over the index keys of a part which match the column hints.
+
+The hints are on the leading columns of the index, all of them are PREFIX except the
+last one, which could be a RANGE of [begin_value, end_value), an empty value means no
+bound on that side. The bounds of the scan are built by IndexKeyUtils::encodeValue, which
+is order preserving for int, float and bool. For the other types (string, date, ...), or
+when the column is nullable, the bounds are only a superset, so each key is decoded and
+checked against the hints.
+
+It is a volcano node, the nodes on top of it move it forward by calling `next`, so when
+a limit is reached upstream, no more keys are read.
+*/
+template<typename T>
+class IndexScanNode final : public IterateNode<T> {
+public:
+    IndexScanNode(PlanContext* planCtx,
+                  std::shared_ptr<meta::cpp2::IndexItem> index,
+                  std::vector<cpp2::IndexColumnHint> columnHints,
+                  bool isEdge)
+        : planContext_(planCtx)
+        , index_(std::move(index))
+        , columnHints_(std::move(columnHints))
+        , isEdge_(isEdge) {
+        for (const auto& col : index_->get_fields()) {
+            auto type = IndexKeyUtils::toValueType(col.get_type());
+            if (type == Value::Type::STRING) {
+                vColNum_++;
+            }
+            if (col.__isset.nullable && *col.get_nullable()) {
+                hasNullableCol_ = true;
+            }
+            cols_.emplace_back(col.get_name(), type);
+        }
+        for (size_t i = 0; i < columnHints_.size(); i++) {
+            if (!isOrdered(cols_[i].second) || hasNullableCol_) {
+                needCheck_ = true;
+            }
+        }
+    }
+
+    kvstore::ResultCode execute(PartitionID partId, const T& input) override {
+        auto ret = RelNode<T>::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        iter_.reset();
+        ret = scan(partId);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        if (valid() && !check()) {
+            next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    bool valid() const override {
+        return iter_ && iter_->valid();
+    }
+
+    void next() override {
+        do {
+            iter_->next();
+        } while (iter_->valid() && !check());
+    }
+
+    folly::StringPiece key() const override {
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+    // the index key has no row
+    RowReader* reader() const override {
+        return nullptr;
+    }
+
+    // Whether the prop could be read from the index key without the data row
+    bool covers(const std::string& prop) const {
+        if (isEdge_ && (prop == kSrc || prop == kType || prop == kRank || prop == kDst)) {
+            return true;
+        }
+        return std::any_of(cols_.begin(), cols_.end(),
+                           [&prop] (const auto& col) { return col.first == prop; });
+    }
+
+    // Read the prop of current row, from the index key if the index covers it,
+    // otherwise from the given data row
+    StatusOr<Value> readValue(const PropContext& prop, RowReader* reader) const {
+        if (covers(prop.name_)) {
+            return decodeValue(prop.name_);
+        }
+        if (reader == nullptr) {
+            return Status::Error(folly::stringPrintf("Prop %s is not in index",
+                                                     prop.name_.c_str()));
+        }
+        return QueryUtils::readValue(reader, prop.name_, prop.field_);
+    }
+
+    VertexIDSlice vertexId() const {
+        auto vId = IndexKeyUtils::getIndexVertexID(planContext_->vIdLen_, key());
+        return vId.subpiece(0, vId.find_first_of('\0'));
+    }
+
+    VertexIDSlice srcId() const {
+        auto srcId = IndexKeyUtils::getIndexSrcId(planContext_->vIdLen_, key());
+        return srcId.subpiece(0, srcId.find_first_of('\0'));
+    }
+
+    VertexIDSlice dstId() const {
+        auto dstId = IndexKeyUtils::getIndexDstId(planContext_->vIdLen_, key());
+        return dstId.subpiece(0, dstId.find_first_of('\0'));
+    }
+
+    EdgeRanking rank() const {
+        return IndexKeyUtils::getIndexRank(planContext_->vIdLen_, key());
+    }
+
+private:
+    static bool isOrdered(Value::Type type) {
+        return type == Value::Type::INT ||
+               type == Value::Type::FLOAT ||
+               type == Value::Type::BOOL;
+    }
+
+    kvstore::ResultCode scan(PartitionID partId) {
+        auto* kvstore = planContext_->env_->kvstore_;
+        auto spaceId = planContext_->spaceId_;
+        prefix_ = IndexKeyUtils::indexPrefix(partId, index_->get_index_id());
+        const cpp2::IndexColumnHint* range = nullptr;
+        for (const auto& hint : columnHints_) {
+            if (hint.get_scan_type() == cpp2::ScanType::PREFIX) {
+                prefix_.append(IndexKeyUtils::encodeValue(hint.get_begin_value()));
+            } else {
+                // only the last hint could be a range, which is checked by the processor
+                range = &hint;
+            }
+        }
+        if (range == nullptr) {
+            return kvstore->prefix(spaceId, partId, prefix_, &iter_);
+        }
+
+        const auto& begin = range->get_begin_value();
+        const auto& end = range->get_end_value();
+        auto type = cols_[columnHints_.size() - 1].second;
+        start_ = prefix_;
+        if (!begin.empty() && (isOrdered(type) || type == Value::Type::STRING)) {
+            start_.append(IndexKeyUtils::encodeValue(begin));
+        }
+        // A key of a shorter string may be greater than the encoded end, so the end
+        // bound is only applied to the fixed length types
+        if (!end.empty() && isOrdered(type)) {
+            end_ = prefix_;
+            end_.append(IndexKeyUtils::encodeValue(end));
+            return kvstore->range(spaceId, partId, start_, end_, &iter_);
+        }
+        return kvstore->rangeWithPrefix(spaceId, partId, start_, prefix_, &iter_);
+    }
+
+    Value decodeValue(const std::string& prop) const {
+        if (isEdge_) {
+            if (prop == kSrc) {
+                return srcId().str();
+            } else if (prop == kDst) {
+                return dstId().str();
+            } else if (prop == kRank) {
+                return rank();
+            } else if (prop == kType) {
+                return index_->get_schema_id().get_edge_type();
+            }
+        }
+        return IndexKeyUtils::getValueFromIndexKey(planContext_->vIdLen_,
+                                                   vColNum_,
+                                                   key(),
+                                                   prop,
+                                                   cols_,
+                                                   isEdge_,
+                                                   hasNullableCol_);
+    }
+
+    // return true when the key matches all column hints
+    bool check() override {
+        if (!needCheck_) {
+            return true;
+        }
+        for (size_t i = 0; i < columnHints_.size(); i++) {
+            const auto& hint = columnHints_[i];
+            auto value = decodeValue(cols_[i].first);
+            if (value.isNull()) {
+                return false;
+            }
+            if (hint.get_scan_type() == cpp2::ScanType::PREFIX) {
+                if (value != hint.get_begin_value()) {
+                    return false;
+                }
+                continue;
+            }
+            const auto& begin = hint.get_begin_value();
+            const auto& end = hint.get_end_value();
+            if ((!begin.empty() && value < begin) || (!end.empty() && !(value < end))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    PlanContext                                         *planContext_;
+    std::shared_ptr<meta::cpp2::IndexItem>               index_;
+    std::vector<cpp2::IndexColumnHint>                   columnHints_;
+    bool                                                 isEdge_;
+
+    // index column name -> value type, in the order of the index
+    std::vector<std::pair<std::string, Value::Type>>     cols_;
+    // count of string columns
+    int32_t                                              vColNum_ = 0;
+    bool                                                 hasNullableCol_ = false;
+    bool                                                 needCheck_ = false;
+
+    // the kv iterator holds the reference of bounds
+    std::string                                          prefix_;
+    std::string                                          start_;
+    std::string                                          end_;
+    std::unique_ptr<kvstore::KVIterator>                 iter_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INDEXSCANNODE_H_
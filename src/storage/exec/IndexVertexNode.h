@@ -0,0 +1,111 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INDEXVERTEXNODE_H_
+#define STORAGE_EXEC_INDEXVERTEXNODE_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/IndexScanNode.h"
+
+namespace nebula {
+namespace storage {
+
+// IndexVertexNode reads the tag row of the vertex which the index key points to. It is only
+// in the plan when some of the props are not in the index, the index keys whose row is
+// missing or expired are skipped.
+template<typename T>
+class IndexVertexNode final : public IterateNode<T> {
+public:
+    IndexVertexNode(PlanContext* planCtx,
+                    TagContext* ctx,
+                    TagID tagId,
+                    IndexScanNode<T>* indexScanNode)
+        : IterateNode<T>(indexScanNode)
+        , planContext_(planCtx)
+        , tagContext_(ctx)
+        , tagId_(tagId)
+        , indexScanNode_(indexScanNode) {
+        auto schemaIter = tagContext_->schemas_.find(tagId_);
+        CHECK(schemaIter != tagContext_->schemas_.end());
+        CHECK(!schemaIter->second.empty());
+        schemas_ = &(schemaIter->second);
+        ttl_ = QueryUtils::getTagTTLInfo(tagContext_, tagId_);
+    }
+
+    kvstore::ResultCode execute(PartitionID partId, const T& input) override {
+        auto ret = RelNode<T>::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+        partId_ = partId;
+        if (this->valid() && !check()) {
+            this->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+    RowReader* reader() const override {
+        if (iter_) {
+            return iter_->reader();
+        }
+        return nullptr;
+    }
+
+private:
+    // return true when the row of the vertex is found
+    bool check() override {
+        auto vId = indexScanNode_->vertexId();
+        auto* cache = FLAGS_enable_vertex_cache ? tagContext_->vertexCache_ : nullptr;
+        VertexCache::Key cacheKey(planContext_->spaceId_, partId_, vId, tagId_);
+        uint64_t epoch = 0;
+        if (cache != nullptr) {
+            if (cache->get(cacheKey, &cacheResult_)) {
+                iter_.reset(new SingleTagIterator(planContext_, cacheResult_, schemas_, &ttl_));
+                return iter_->valid();
+            }
+            epoch = cache->epoch(cacheKey);
+        }
+
+        std::unique_ptr<kvstore::KVIterator> iter;
+        prefix_ = NebulaKeyUtils::vertexPrefix(planContext_->vIdLen_, partId_, vId.str(), tagId_);
+        auto ret = planContext_->env_->kvstore_->prefix(planContext_->spaceId_,
+                                                        partId_,
+                                                        prefix_,
+                                                        &iter);
+        if (ret != kvstore::ResultCode::SUCCEEDED || !iter || !iter->valid()) {
+            VLOG(1) << "Vertex " << vId << " of index key is missing, tagId " << tagId_;
+            iter_.reset();
+            return false;
+        }
+        if (cache != nullptr) {
+            cache->insert(cacheKey, iter->val().str(), epoch);
+        }
+        iter_.reset(new SingleTagIterator(planContext_, std::move(iter), tagId_, schemas_, &ttl_));
+        return iter_->valid();
+    }
+
+private:
+    PlanContext                                                          *planContext_;
+    TagContext                                                           *tagContext_;
+    TagID                                                                 tagId_;
+    IndexScanNode<T>                                                     *indexScanNode_;
+    const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> *schemas_ = nullptr;
+    folly::Optional<std::pair<std::string, int64_t>>                      ttl_;
+
+    PartitionID                                                           partId_;
+    std::unique_ptr<StorageIterator>                                      iter_;
+    std::string                                                           prefix_;
+    std::string                                                           cacheResult_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INDEXVERTEXNODE_H_
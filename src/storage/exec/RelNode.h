@@ -9,6 +9,7 @@
 
 #include "common/base/Base.h"
 #include "common/context/ExpressionContext.h"
+#include "common/time/Duration.h"
 #include "utils/NebulaKeyUtils.h"
 #include "storage/CommonUtils.h"
 #include "storage/context/StorageExpressionContext.h"
@@ -40,7 +41,8 @@ class RelNode {
 public:
     virtual kvstore::ResultCode execute(PartitionID partId, const T& input) {
         for (auto* dependency : dependencies_) {
-            auto ret = dependency->execute(partId, input);
+            auto ret = dependency->profiled_ ? dependency->profiledExecute(partId, input)
+                                             : dependency->execute(partId, input);
             if (ret != kvstore::ResultCode::SUCCEEDED) {
                 return ret;
             }
@@ -62,6 +64,22 @@ public:
     std::string name_;
     std::vector<RelNode<T>*> dependencies_;
     bool hasDependents_ = false;
+
+    // The rows the node has produced. The calls and the time of execute, including its
+    // dependencies, are only counted when the plan is profiled.
+    int64_t rows_ = 0;
+    int64_t calls_ = 0;
+    int64_t latencyInUs_ = 0;
+    bool profiled_ = false;
+
+private:
+    kvstore::ResultCode profiledExecute(PartitionID partId, const T& input) {
+        time::Duration duration;
+        auto ret = execute(partId, input);
+        calls_++;
+        latencyInUs_ += duration.elapsedInUSec();
+        return ret;
+    }
 };
 
 // QueryNode is the node which would read data from kvstore, it usually generate a row in response
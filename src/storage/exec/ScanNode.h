@@ -0,0 +1,455 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_SCANNODE_H_
+#define STORAGE_EXEC_SCANNODE_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/RelNode.h"
+
+namespace nebula {
+namespace storage {
+
+// Where the scan of a part begins, and the snapshot it reads in
+struct ScanInput {
+    // The first key to read, the scan begins from the first key of the part if it is empty
+    std::string                 start;
+    // Read in the snapshot of the engine if it is set, otherwise read the latest data
+    kvstore::KVEngine          *engine{nullptr};
+    const void                 *snapshot{nullptr};
+};
+
+/*
+ScanNode iterates over the keys of a part from the start of the input. It stops only at the
+rows which are valid: of the tags or edges in the context, not dropped, not expired and the
+latest version of the vertex tag or edge. The reader of the row is ready when it stops.
+*/
+class ScanNode : public IterateNode<ScanInput> {
+public:
+    kvstore::ResultCode execute(PartitionID partId, const ScanInput& input) override {
+        auto ret = RelNode::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+
+        iter_.reset();
+        reader_.reset();
+        lastRow_.clear();
+        readBytes_ = 0;
+        prefix_ = rowPrefix(partId);
+        ret = openPrefix(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            iter_.reset();
+            return ret;
+        }
+        if (!input.start.empty()) {
+            // The page may begin with an edge of the other key type, if the edge keys of the
+            // part have been converted since the last page
+            auto start = input.start;
+            start[0] = prefix_[0];
+            iter_->seek(start);
+        }
+        while (iter_->valid() && !countAndCheck()) {
+            iter_->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+    bool valid() const override {
+        return iter_ && iter_->valid();
+    }
+
+    void next() override {
+        do {
+            iter_->next();
+        } while (iter_->valid() && !countAndCheck());
+    }
+
+    folly::StringPiece key() const override {
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+    RowReader* reader() const override {
+        return reader_.get();
+    }
+
+    // The bytes of the keys and values read since the execute, including the skipped ones
+    int64_t readBytes() const {
+        return readBytes_;
+    }
+
+protected:
+    explicit ScanNode(PlanContext* planCtx) : planContext_(planCtx) {}
+
+    virtual std::string rowPrefix(PartitionID partId) = 0;
+
+    virtual kvstore::ResultCode openPrefix(PartitionID partId, const ScanInput& input) {
+        if (input.engine != nullptr) {
+            return input.engine->prefix(prefix_, &iter_, input.snapshot);
+        }
+        return planContext_->env_->kvstore_->prefix(planContext_->spaceId_, partId,
+                                                    prefix_, &iter_);
+    }
+
+    bool countAndCheck() {
+        readBytes_ += iter_->key().size() + iter_->val().size();
+        return check();
+    }
+
+    // return true if the key is not an old version of the last row, the versions of an edge
+    // may be of both key types during the conversion of the edge keys
+    bool checkVersion(folly::StringPiece key) {
+        auto row = NebulaKeyUtils::keyWithNoVersion(key).subpiece(1);
+        if (row == lastRow_) {
+            return false;
+        }
+        lastRow_ = row.str();
+        return true;
+    }
+
+    // return true when the value is read and not expired
+    bool checkValue(
+            const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>* schemas,
+            const folly::Optional<std::pair<std::string, int64_t>>& ttl) {
+        auto val = iter_->val();
+        if (!reader_) {
+            reader_ = RowReader::getRowReader(*schemas, val);
+        } else if (!reader_->reset(*schemas, val)) {
+            reader_.reset();
+        }
+        if (!reader_) {
+            // skip the bad row instead of failing the whole part
+            VLOG(1) << "Bad row of key " << folly::hexlify(iter_->key());
+            return false;
+        }
+        if (ttl.hasValue() &&
+            CommonUtils::checkDataExpiredForTTL(schemas->back().get(), reader_.get(),
+                                                ttl.value().first, ttl.value().second)) {
+            return false;
+        }
+        return true;
+    }
+
+    PlanContext                                *planContext_;
+    std::unique_ptr<kvstore::KVIterator>        iter_;
+    std::unique_ptr<RowReader>                  reader_;
+    std::string                                 prefix_;
+    // the key without version of the last row checked
+    std::string                                 lastRow_;
+    int64_t                                     readBytes_ = 0;
+};
+
+class ScanVertexNode final : public ScanNode {
+public:
+    ScanVertexNode(PlanContext* planCtx, TagContext* ctx)
+        : ScanNode(planCtx)
+        , tagContext_(ctx) {}
+
+    TagID tagId() const {
+        return tagId_;
+    }
+
+protected:
+    std::string rowPrefix(PartitionID partId) override {
+        return NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kData);
+    }
+
+    bool check() override {
+        auto key = iter_->key();
+        auto vIdLen = planContext_->vIdLen_;
+        if (!NebulaKeyUtils::isVertex(vIdLen, key)) {
+            return false;
+        }
+        auto tagId = NebulaKeyUtils::getTagId(vIdLen, key);
+        if (!tagContext_->indexMap_.count(tagId) ||
+            DroppedSchemas::instance()->isTagDropped(planContext_->spaceId_, tagId) ||
+            !checkVersion(key)) {
+            return false;
+        }
+        if (tagId != tagId_ || schemas_ == nullptr) {
+            auto iter = tagContext_->schemas_.find(tagId);
+            CHECK(iter != tagContext_->schemas_.end());
+            schemas_ = &(iter->second);
+            ttl_ = QueryUtils::getTagTTLInfo(tagContext_, tagId);
+            tagId_ = tagId;
+        }
+        return checkValue(schemas_, ttl_);
+    }
+
+private:
+    TagContext                                                           *tagContext_;
+    TagID                                                                 tagId_ = 0;
+    const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> *schemas_ = nullptr;
+    folly::Optional<std::pair<std::string, int64_t>>                      ttl_;
+};
+
+class ScanEdgeNode final : public ScanNode {
+public:
+    ScanEdgeNode(PlanContext* planCtx,
+                 EdgeContext* ctx,
+                 StorageExpressionContext* expCtx = nullptr)
+        : ScanNode(planCtx)
+        , edgeContext_(ctx)
+        , expCtx_(expCtx) {}
+
+    EdgeType edgeType() const {
+        return edgeType_;
+    }
+
+protected:
+    std::string rowPrefix(PartitionID partId) override {
+        return NebulaKeyUtils::edgePartPrefix(planContext_->spaceId_, partId);
+    }
+
+    kvstore::ResultCode openPrefix(PartitionID partId, const ScanInput& input) override {
+        if (input.engine != nullptr) {
+            return CommonUtils::edgePrefix(input.engine, input.snapshot, planContext_->spaceId_,
+                                           partId, prefix_, &iter_);
+        }
+        return CommonUtils::edgePrefix(planContext_->env_->kvstore_, planContext_->spaceId_,
+                                       partId, prefix_, &iter_);
+    }
+
+    bool check() override {
+        auto key = iter_->key();
+        auto vIdLen = planContext_->vIdLen_;
+        if (!NebulaKeyUtils::isEdge(vIdLen, key)) {
+            return false;
+        }
+        auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen, key);
+        if (!edgeContext_->indexMap_.count(edgeType) ||
+            DroppedSchemas::instance()->isEdgeDropped(planContext_->spaceId_, edgeType) ||
+            !checkVersion(key)) {
+            return false;
+        }
+        if (edgeType != edgeType_ || schemas_ == nullptr) {
+            auto iter = edgeContext_->schemas_.find(std::abs(edgeType));
+            CHECK(iter != edgeContext_->schemas_.end());
+            schemas_ = &(iter->second);
+            ttl_ = QueryUtils::getEdgeTTLInfo(edgeContext_, edgeType);
+            edgeType_ = edgeType;
+            if (expCtx_ != nullptr) {
+                // the filter reads the props of the edge from the reader
+                expCtx_->resetSchema(edgeContext_->edgeNames_.at(edgeType),
+                                     schemas_->back().get(),
+                                     true);
+            }
+        }
+        return checkValue(schemas_, ttl_);
+    }
+
+private:
+    EdgeContext                                                          *edgeContext_;
+    StorageExpressionContext                                             *expCtx_;
+    EdgeType                                                              edgeType_ = 0;
+    const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> *schemas_ = nullptr;
+    folly::Optional<std::pair<std::string, int64_t>>                      ttl_;
+};
+
+/*
+The output nodes of the scan plans. They pull the rows from the upstream until the limit of
+rows or bytes is reached, and remember the key of the next row, where the next page begins.
+The bytes are all read by the scan node, so a page filtering out most rows still stops in time.
+*/
+class ScanOutputNode : public QueryNode<ScanInput> {
+public:
+    // The key of the next row, empty if the part is scanned to the end
+    const std::string& nextKey() const {
+        return nextKey_;
+    }
+
+protected:
+    ScanOutputNode(ScanNode* scan,
+                   size_t vIdLen,
+                   int64_t limit,
+                   int64_t maxBytes,
+                   nebula::DataSet* resultDataSet)
+        : scan_(scan)
+        , vIdLen_(vIdLen)
+        , limit_(limit)
+        , maxBytes_(maxBytes)
+        , resultDataSet_(resultDataSet) {}
+
+    // A page has at least one row, so the scan always goes on
+    bool isFull(int64_t rows) const {
+        return rows > 0 && (rows >= limit_ || scan_->readBytes() >= maxBytes_);
+    }
+
+    ScanNode           *scan_;
+    size_t              vIdLen_;
+    int64_t             limit_;
+    int64_t             maxBytes_;
+    nebula::DataSet    *resultDataSet_;
+
+    std::string         nextKey_;
+};
+
+// Each row is a vertex, the vertex id followed by the props of the tags in the context.
+// The props of the tags the vertex doesn't have are NULL.
+class ScanVertexPropNode final : public ScanOutputNode {
+public:
+    ScanVertexPropNode(ScanVertexNode* scan,
+                       TagContext* ctx,
+                       StorageExpressionContext* expCtx,
+                       Expression* filter,
+                       size_t vIdLen,
+                       int64_t limit,
+                       int64_t maxBytes,
+                       nebula::DataSet* resultDataSet)
+        : ScanOutputNode(scan, vIdLen, limit, maxBytes, resultDataSet)
+        , vertexScan_(scan)
+        , tagContext_(ctx)
+        , expCtx_(expCtx)
+        , filter_(filter) {}
+
+    kvstore::ResultCode execute(PartitionID partId, const ScanInput& input) override {
+        auto ret = RelNode::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+
+        nextKey_.clear();
+        const auto& propContexts = tagContext_->propContexts_;
+        int64_t rows = 0;
+        while (scan_->valid()) {
+            if (isFull(rows)) {
+                nextKey_ = scan_->key().str();
+                break;
+            }
+            // the tags of a vertex are next to each other
+            auto vId = NebulaKeyUtils::getVertexId(vIdLen_, scan_->key()).str();
+            std::vector<nebula::List> tagProps(propContexts.size());
+            std::vector<bool> found(propContexts.size(), false);
+            if (filter_ != nullptr) {
+                expCtx_->clear();
+            }
+            do {
+                auto tagId = vertexScan_->tagId();
+                auto idx = tagContext_->indexMap_.at(tagId);
+                ret = collectTagProps(tagId,
+                                      tagContext_->tagNames_.at(tagId),
+                                      scan_->reader(),
+                                      &propContexts[idx].second,
+                                      tagProps[idx],
+                                      filter_ != nullptr ? expCtx_ : nullptr);
+                if (ret != kvstore::ResultCode::SUCCEEDED) {
+                    return ret;
+                }
+                found[idx] = true;
+                scan_->next();
+            } while (scan_->valid() &&
+                     NebulaKeyUtils::getVertexId(vIdLen_, scan_->key()) == vId);
+
+            if (filter_ != nullptr) {
+                auto result = filter_->eval(*expCtx_).toBool();
+                if (!result.ok() || !result.value()) {
+                    continue;
+                }
+            }
+            std::vector<Value> row;
+            row.emplace_back(vId.substr(0, vId.find_first_of('\0')));
+            for (size_t i = 0; i < propContexts.size(); i++) {
+                if (found[i]) {
+                    for (auto& col : tagProps[i].values) {
+                        row.emplace_back(std::move(col));
+                    }
+                    continue;
+                }
+                for (const auto& prop : propContexts[i].second) {
+                    if (prop.returned_) {
+                        row.emplace_back(NullType::__NULL__);
+                    }
+                }
+            }
+            resultDataSet_->rows.emplace_back(std::move(row));
+            rows++;
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+private:
+    ScanVertexNode               *vertexScan_;
+    TagContext                   *tagContext_;
+    StorageExpressionContext     *expCtx_;
+    Expression                   *filter_;
+};
+
+// Each row is an edge, with the props of the edge types in the context. The props of the
+// other edge types are NULL.
+class ScanEdgePropNode final : public ScanOutputNode {
+public:
+    ScanEdgePropNode(ScanEdgeNode* scan,
+                     IterateNode<ScanInput>* upstream,
+                     EdgeContext* ctx,
+                     size_t vIdLen,
+                     int64_t limit,
+                     int64_t maxBytes,
+                     nebula::DataSet* resultDataSet)
+        : ScanOutputNode(scan, vIdLen, limit, maxBytes, resultDataSet)
+        , upstream_(upstream)
+        , edgeContext_(ctx) {}
+
+    kvstore::ResultCode execute(PartitionID partId, const ScanInput& input) override {
+        auto ret = RelNode::execute(partId, input);
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+
+        nextKey_.clear();
+        const auto& propContexts = edgeContext_->propContexts_;
+        int64_t rows = 0;
+        while (upstream_->valid()) {
+            if (isFull(rows)) {
+                nextKey_ = upstream_->key().str();
+                break;
+            }
+            auto key = upstream_->key();
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+            auto idx = edgeContext_->indexMap_.at(edgeType);
+            std::vector<Value> row;
+            for (size_t i = 0; i < propContexts.size(); i++) {
+                if (i != idx) {
+                    for (const auto& prop : propContexts[i].second) {
+                        if (prop.returned_) {
+                            row.emplace_back(NullType::__NULL__);
+                        }
+                    }
+                    continue;
+                }
+                nebula::List list;
+                ret = collectEdgeProps(edgeType,
+                                       upstream_->reader(),
+                                       key,
+                                       vIdLen_,
+                                       &propContexts[i].second,
+                                       list);
+                if (ret != kvstore::ResultCode::SUCCEEDED) {
+                    return ret;
+                }
+                for (auto& col : list.values) {
+                    row.emplace_back(std::move(col));
+                }
+            }
+            resultDataSet_->rows.emplace_back(std::move(row));
+            rows++;
+            upstream_->next();
+        }
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+
+private:
+    IterateNode<ScanInput>       *upstream_;
+    EdgeContext                  *edgeContext_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_SCANNODE_H_
@@ -10,6 +10,8 @@
 #include "common/base/Base.h"
 #include "kvstore/KVIterator.h"
 #include "storage/CommonUtils.h"
+#include "storage/StorageFlags.h"
+#include "storage/context/QueryProfile.h"
 
 namespace nebula {
 namespace storage {
@@ -117,21 +119,25 @@ public:
             EdgeType edgeType,
             const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>* schemas,
             const folly::Optional<std::pair<std::string, int64_t>>* ttl,
-            bool moveToValidRecord = true)
+            bool moveToValidRecord = true,
+            bool keyOnly = false)
         : planContext_(planCtx)
         , iter_(std::move(iter))
         , edgeType_(edgeType)
         , schemas_(schemas)
         , ttl_(ttl)
-        , moveToValidRecord_(moveToValidRecord) {
+        , moveToValidRecord_(moveToValidRecord)
+        , keyOnly_(keyOnly) {
         CHECK(!!iter_);
         lookupOne_ = true;
         // If moveToValidRecord is true, iterator will try to move to first valid record,
         // which is used in GetNeighbors. If it is false, it will only check the latest record,
         // which is used in GetProps and UpdateEdge.
+        // If keyOnly is true, the values are not decoded and the reader is always null, it is
+        // used when nothing but the keys of the edges is needed, and there is no ttl.
         if (moveToValidRecord_) {
             while (iter_->valid() && !check()) {
-                iter_->next();
+                moveNext();
             }
         } else {
             check();
@@ -139,7 +145,7 @@ public:
     }
 
     bool valid() const override {
-        return lookupOne_ && reader_ != nullptr;
+        return lookupOne_ && (keyOnly_ ? iter_->valid() : reader_ != nullptr);
     }
 
     void next() override {
@@ -148,7 +154,7 @@ public:
             return;
         }
         do {
-            iter_->next();
+            moveNext();
             if (!iter_->valid()) {
                 reader_.reset();
                 break;
@@ -173,6 +179,29 @@ public:
     }
 
 protected:
+    // Move to the next key. If a lot of old versions of the current edge have been skipped,
+    // jump over the rest of them with one seek, which is cheaper than stepping through them.
+    void moveNext() {
+        if (FLAGS_edge_versions_to_seek <= 0 || oldVersions_ < FLAGS_edge_versions_to_seek) {
+            iter_->next();
+            return;
+        }
+        oldVersions_ = 0;
+        // All versions of an edge share the key without the version, so the next edge
+        // is the first key after all keys with it as a prefix
+        auto key = iter_->key();
+        std::string target = key.subpiece(0, key.size() - sizeof(EdgeVersion)).str();
+        while (!target.empty() && static_cast<uint8_t>(target.back()) == 0xFF) {
+            target.pop_back();
+        }
+        if (target.empty()) {
+            iter_->next();
+            return;
+        }
+        target.back() = static_cast<char>(static_cast<uint8_t>(target.back()) + 1);
+        iter_->seek(target);
+    }
+
     // return true when the value iter to a valid edge value
     bool check() {
         reader_.reset();
@@ -181,8 +210,19 @@ protected:
         auto dstId = NebulaKeyUtils::getDstId(planContext_->vIdLen_, key);
         if (!firstLoop_ && rank == lastRank_ && lastDstId_ == dstId) {
             // pass old version data of same edge
+            oldVersions_++;
+            if (planContext_->profile_ != nullptr) {
+                planContext_->profile_->addVersionsSkipped();
+            }
             return false;
         }
+        oldVersions_ = 0;
+        if (keyOnly_) {
+            firstLoop_ = false;
+            lastRank_ = rank;
+            lastDstId_ = dstId.str();
+            return true;
+        }
 
         auto val = iter_->val();
         if (!reader_) {
@@ -218,48 +258,57 @@ protected:
     const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> *schemas_ = nullptr;
     const folly::Optional<std::pair<std::string, int64_t>>               *ttl_ = nullptr;
     bool                                                                  moveToValidRecord_{true};
+    bool                                                                  keyOnly_{false};
     bool                                                                  lookupOne_ = true;
 
     std::unique_ptr<RowReader>                                            reader_;
     EdgeRanking                                                           lastRank_ = 0;
     VertexID                                                              lastDstId_ = "";
     bool                                                                  firstLoop_ = true;
+    // number of old versions of the current edge skipped one by one
+    int32_t                                                               oldVersions_ = 0;
 };
 
-// Iterator of multiple SingleEdgeIterator, it will iterate over edges of different types
+// Iterator of multiple SingleEdgeIterator, it will iterate over edges of different types.
+// The iterator of a type is opened when the types before it are exhausted, so nothing is
+// read for the types after the edge where the iteration stops, e.g. because of a limit.
 class MultiEdgeIterator : public StorageIterator {
 public:
+    // Open the iterator of an edge type, return nullptr if there is no edge of it
+    using Opener = std::function<SingleEdgeIterator*()>;
+
     // will move to a valid SingleEdgeIterator if there is one
-    explicit MultiEdgeIterator(std::vector<SingleEdgeIterator*> iters)
-        : iters_(std::move(iters)) {
+    explicit MultiEdgeIterator(std::vector<Opener> openers)
+        : openers_(std::move(openers)) {
         moveToNextValidIterator();
     }
 
     bool valid() const override {
-        return curIter_ < iters_.size();
+        return curIter_ < openers_.size();
     }
 
     void next() override {
-        iters_[curIter_]->next();
-        if (!iters_[curIter_]->valid()) {
+        iter_->next();
+        if (!iter_->valid()) {
+            ++curIter_;
             moveToNextValidIterator();
         }
     }
 
     folly::StringPiece key() const override {
-        return iters_[curIter_]->key();
+        return iter_->key();
     }
 
     folly::StringPiece val() const override {
-        return iters_[curIter_]->val();
+        return iter_->val();
     }
 
     RowReader* reader() const override {
-        return iters_[curIter_]->reader();
+        return iter_->reader();
     }
 
     EdgeType edgeType() const {
-        return iters_[curIter_]->edgeType();
+        return iter_->edgeType();
     }
 
     // return the index of multiple iterators
@@ -269,17 +318,20 @@ public:
 
 private:
     void moveToNextValidIterator() {
-        while (curIter_ < iters_.size()) {
-            if (iters_[curIter_] && iters_[curIter_]->valid()) {
+        while (curIter_ < openers_.size()) {
+            iter_ = openers_[curIter_]();
+            if (iter_ != nullptr && iter_->valid()) {
                 return;
             }
             ++curIter_;
         }
+        iter_ = nullptr;
     }
 
 private:
-    std::vector<SingleEdgeIterator*> iters_;
+    std::vector<Opener> openers_;
     size_t curIter_ = 0;
+    SingleEdgeIterator* iter_ = nullptr;
 };
 
 }  // namespace storage
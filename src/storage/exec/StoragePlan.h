@@ -8,8 +8,10 @@
 #define STORAGE_EXEC_STORAGEPLAN_H_
 
 #include "common/base/Base.h"
+#include <folly/Demangle.h>
 #include "storage/exec/RelNode.h"
 #include "storage/CommonUtils.h"
+#include "storage/context/QueryProfile.h"
 
 namespace nebula {
 namespace storage {
@@ -46,6 +48,11 @@ public:
             }
             outputIdx_ = addNode(std::move(output));
             firstLoop_ = false;
+            if (profile_ != nullptr) {
+                for (auto& node : nodes_) {
+                    node->profiled_ = true;
+                }
+            }
         }
         CHECK_GE(outputIdx_, 0);
         CHECK_LT(outputIdx_, nodes_.size());
@@ -62,7 +69,44 @@ public:
         return nodes_[idx].get();
     }
 
+    // Count the calls, time and rows of each node, must be set before the first go
+    void setProfile(QueryProfile* profile) {
+        profile_ = profile;
+    }
+
+    // Add the counts of the nodes into the profile once the plan is done
+    void collectProfile() {
+        if (profile_ == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            if (static_cast<int32_t>(i) != outputIdx_) {
+                const auto& node = nodes_[i];
+                profile_->addNode(nodeName(node.get()), node->calls_, node->latencyInUs_,
+                                  node->rows_);
+            }
+        }
+    }
+
 private:
+    // The name of the node, or its class name without the namespace and template arguments
+    static std::string nodeName(RelNode<T>* node) {
+        if (!node->name_.empty()) {
+            return node->name_;
+        }
+        std::string name = folly::demangle(typeid(*node)).toStdString();
+        auto end = name.find('<');
+        if (end != std::string::npos) {
+            name.resize(end);
+        }
+        auto begin = name.rfind("::");
+        if (begin != std::string::npos) {
+            name = name.substr(begin + 2);
+        }
+        return name;
+    }
+
+    QueryProfile* profile_ = nullptr;
     bool firstLoop_ = true;
     int32_t outputIdx_ = -1;
     std::vector<std::unique_ptr<RelNode<T>>> nodes_;
@@ -0,0 +1,154 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_STREAMINGSAMPLER_H_
+#define STORAGE_EXEC_STREAMINGSAMPLER_H_
+
+#include "common/base/Base.h"
+#include <random>
+
+namespace nebula {
+namespace storage {
+
+/**
+ * StreamingSampler keeps a reservoir of at most k samples of a stream, and
+ * decides whether an item is accepted before the caller copies anything. The
+ * caller offers every item, and only writes the item into slot(idx) when
+ * offer() returns a valid slot index. The slots are reused among streams, so
+ * the buffers they hold (e.g. strings) are allocated only once.
+ *
+ * The uniform offer() uses Algorithm L, which draws random numbers only when
+ * an item is accepted, so the cost of a rejected item is a counter increment.
+ * The weighted offer(weight) uses Algorithm A-Res, the probability of an item
+ * being sampled is proportional to its weight, and an item whose weight is not
+ * positive is never sampled.
+ *
+ * The same seed always produces the same samples of the same stream.
+ * */
+template <typename T>
+class StreamingSampler final {
+public:
+    explicit StreamingSampler(size_t k)
+        : k_(k) {
+        reset(0);
+    }
+
+    // Start a new stream
+    void reset(uint64_t seed) {
+        rng_.seed(seed);
+        count_ = 0;
+        size_ = 0;
+        heap_.clear();
+        if (k_ > 0) {
+            w_ = std::exp(std::log(random()) / k_);
+            skip();
+        }
+    }
+
+    // Uniform sampling, return the slot to write the current item into, or -1 if
+    // the item is rejected
+    int64_t offer() {
+        if (k_ == 0) {
+            return -1;
+        }
+        auto idx = count_++;
+        if (idx < k_) {
+            return fill();
+        }
+        if (idx < next_) {
+            return -1;
+        }
+        w_ *= std::exp(std::log(random()) / k_);
+        skip();
+        return std::uniform_int_distribution<size_t>(0, k_ - 1)(rng_);
+    }
+
+    // Weighted sampling, a stream must not mix it with the uniform offer()
+    int64_t offer(double weight) {
+        if (k_ == 0 || !(weight > 0)) {
+            return -1;
+        }
+        count_++;
+        // log(u ^ (1 / w)), the items with the largest keys are sampled
+        auto key = std::log(random()) / weight;
+        if (size_ < k_) {
+            heap_.emplace_back(key, size_);
+            std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+            return fill();
+        }
+        if (key <= heap_.front().first) {
+            return -1;
+        }
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        auto idx = heap_.back().second;
+        heap_.back().first = key;
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        return idx;
+    }
+
+    T& slot(size_t idx) {
+        return slots_[idx];
+    }
+
+    // Number of samples of current stream, they are in slot [0, size())
+    size_t size() const {
+        return size_;
+    }
+
+    // Number of items offered in current stream
+    size_t count() const {
+        return count_;
+    }
+
+private:
+    using Entry = std::pair<double, size_t>;
+
+    // uniform in (0, 1)
+    double random() {
+        double u;
+        do {
+            u = std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+        } while (u == 0.0);
+        return u;
+    }
+
+    // Number of items to skip until next accepted one
+    void skip() {
+        if (w_ >= 1.0) {
+            next_ = std::numeric_limits<size_t>::max();
+            return;
+        }
+        auto gap = std::floor(std::log(random()) / std::log1p(-w_));
+        auto base = std::max(count_, k_);
+        next_ = gap >= static_cast<double>(std::numeric_limits<size_t>::max() - base)
+                ? std::numeric_limits<size_t>::max()
+                : base + static_cast<size_t>(gap);
+    }
+
+    int64_t fill() {
+        if (slots_.size() <= size_) {
+            slots_.emplace_back();
+        }
+        return size_++;
+    }
+
+    size_t                  k_;
+    std::vector<T>          slots_;
+    size_t                  size_{0};
+    size_t                  count_{0};
+    std::mt19937_64         rng_;
+
+    // Algorithm L
+    double                  w_{0};
+    size_t                  next_{0};
+
+    // A-Res, min heap of (key, slot)
+    std::vector<Entry>      heap_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_EXEC_STREAMINGSAMPLER_H_
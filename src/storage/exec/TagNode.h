@@ -45,23 +45,39 @@ public:
         }
         VLOG(1) << "partId " << partId << ", vId " << vId << ", tagId " << tagId_
                 << ", prop size " << props_->size();
+        if (DroppedSchemas::instance()->isTagDropped(planContext_->spaceId_, tagId_)) {
+            iter_.reset();
+            return kvstore::ResultCode::SUCCEEDED;
+        }
 
-        // when update, has already evicted
-        if (FLAGS_enable_vertex_cache && tagContext_->vertexCache_ != nullptr) {
-            auto result = tagContext_->vertexCache_->get(std::make_pair(vId, tagId_), partId);
-            if (result.ok()) {
-                cacheResult_ = std::move(result).value();
+        // update doesn't pass the cache, because it needs the key of the row
+        auto* cache = FLAGS_enable_vertex_cache ? tagContext_->vertexCache_ : nullptr;
+        VertexCache::Key cacheKey(planContext_->spaceId_, partId, vId, tagId_);
+        uint64_t epoch = 0;
+        if (cache != nullptr) {
+            if (cache->get(cacheKey, &cacheResult_)) {
+                // The cache is only served by the leader, a former leader misses the writes
+                ret = planContext_->env_->kvstore_->checkLeader(planContext_->spaceId_, partId);
+                if (ret != kvstore::ResultCode::SUCCEEDED) {
+                    return ret;
+                }
                 iter_.reset(new SingleTagIterator(planContext_, cacheResult_, schemas_, &ttl_));
+                rows_ += iter_->valid();
                 return kvstore::ResultCode::SUCCEEDED;
             }
+            epoch = cache->epoch(cacheKey);
         }
 
         std::unique_ptr<kvstore::KVIterator> iter;
         prefix_ = NebulaKeyUtils::vertexPrefix(planContext_->vIdLen_, partId, vId, tagId_);
         ret = planContext_->env_->kvstore_->prefix(planContext_->spaceId_, partId, prefix_, &iter);
         if (ret == kvstore::ResultCode::SUCCEEDED && iter && iter->valid()) {
+            if (cache != nullptr) {
+                cache->insert(cacheKey, iter->val().str(), epoch);
+            }
             iter_.reset(new SingleTagIterator(planContext_, std::move(iter), tagId_,
                                               schemas_, &ttl_));
+            rows_ += iter_->valid();
         } else {
             iter_.reset();
         }
@@ -27,6 +27,7 @@ public:
                   std::vector<storage::cpp2::UpdatedProp>& updatedProps,
                   FilterNode<VertexID>* filterNode,
                   bool insertable,
+                  VertexCache* cache,
                   StorageExpressionContext* expCtx = nullptr)
         : planContext_(planCtx)
         , tagContext_(tagContext)
@@ -34,6 +35,7 @@ public:
         , updatedProps_(updatedProps)
         , filterNode_(filterNode)
         , insertable_(insertable)
+        , cache_(FLAGS_enable_vertex_cache ? cache : nullptr)
         , expCtx_(expCtx) {
             tagId_ = planContext_->tagId_;
         }
@@ -79,13 +81,22 @@ public:
                     return folly::none;
                 }
             },
-            [&ret, &baton, this] (kvstore::ResultCode code) {
+            [&ret, &baton, &partId, &vId, this] (kvstore::ResultCode code) {
                 if (code == kvstore::ResultCode::ERR_ATOMIC_OP_FAILED &&
                     this->exeResult_ != kvstore::ResultCode::SUCCEEDED) {
                     ret = this->exeResult_;
                 } else {
                     ret = code;
                 }
+                if (this->cache_ != nullptr) {
+                    // Write through the cache in the commit order
+                    VertexCache::Key cacheKey(planContext_->spaceId_, partId, vId, tagId_);
+                    if (code == kvstore::ResultCode::SUCCEEDED) {
+                        this->cache_->put(cacheKey, std::move(this->cacheVal_));
+                    } else if (code != kvstore::ResultCode::ERR_ATOMIC_OP_FAILED) {
+                        this->cache_->evict(cacheKey);
+                    }
+                }
                 baton.post();
             });
         baton.wait();
@@ -186,10 +197,16 @@ public:
         }
 
         // After alter tag, the schema get from meta and the schema in RowReader
-        // may be inconsistent, so the following method cannot be used
-        // this->rowWriter_ = std::make_unique<RowWriterV2>(schema.get(), reader->getData());
-        rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        // may be inconsistent. Only when the row is encoded by the latest schema,
+        // we patch the updated props in place. Otherwise the row is upgraded to
+        // the latest schema by encoding it again.
         val_ = reader_->getData();
+        if (reader_->readerVer() == 2 && reader_->schemaVer() == schema_->getVersion()) {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_, val_);
+            inPlace_ = true;
+        } else {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        }
         return kvstore::ResultCode::SUCCEEDED;
     }
 
@@ -209,11 +226,23 @@ public:
             expCtx_->setTagProp(tagName_, propName, std::move(updateVal));
         }
 
-        for (auto& e : props_) {
-            auto wRet = rowWriter_->setValue(e.first, e.second);
-            if (wRet != WriteResult::SUCCEEDED) {
-                LOG(ERROR) << "Add field faild ";
-                return folly::none;
+        if (inPlace_) {
+            // Only the updated props need to be written into the old row
+            for (auto& updateProp : updatedProps_) {
+                const auto& propName = updateProp.get_name();
+                auto wRet = rowWriter_->setValue(propName, props_[propName]);
+                if (wRet != WriteResult::SUCCEEDED) {
+                    LOG(ERROR) << "Add field faild ";
+                    return folly::none;
+                }
+            }
+        } else {
+            for (auto& e : props_) {
+                auto wRet = rowWriter_->setValue(e.first, e.second);
+                if (wRet != WriteResult::SUCCEEDED) {
+                    LOG(ERROR) << "Add field faild ";
+                    return folly::none;
+                }
             }
         }
 
@@ -227,6 +256,9 @@ public:
         }
 
         auto nVal = rowWriter_->moveEncodedStr();
+        if (cache_ != nullptr) {
+            cacheVal_ = nVal;
+        }
 
         // update index if exists
         // Note: when insert_ is true, either there is no origin data or TTL expired
@@ -295,6 +327,9 @@ private:
     FilterNode<VertexID>                                                   *filterNode_;
     // Whether to allow insert
     bool                                                                    insertable_{false};
+    // Written through after the new row is committed
+    VertexCache                                                            *cache_{nullptr};
+    std::string                                                             cacheVal_;
     TagID                                                                   tagId_;
 
     std::string                                                             key_;
@@ -306,6 +341,8 @@ private:
     // use to save old row value
     std::string                                                             val_;
     std::unique_ptr<RowWriterV2>                                            rowWriter_;
+    // Whether rowWriter_ patches the old row instead of encoding a new one
+    bool                                                                    inPlace_{false};
     // tagId_ prop -> value
     std::unordered_map<std::string, Value>                                  props_;
     std::atomic<kvstore::ResultCode>                                        exeResult_;
@@ -456,7 +493,8 @@ public:
             std::numeric_limits<int64_t>::max() - time::WallClock::fastNowInMicroSec();
         // Switch version to big-endian, make sure the key is in ordered.
         version = folly::Endian::big(version);
-        key_ = NebulaKeyUtils::edgeKey(planContext_->vIdLen_,
+        key_ = NebulaKeyUtils::edgeKey(planContext_->spaceId_,
+                                       planContext_->vIdLen_,
                                        partId,
                                        edgeKey.src,
                                        edgeKey.edge_type,
@@ -503,10 +541,16 @@ public:
         }
 
         // After alter edge, the schema get from meta and the schema in RowReader
-        // may be inconsistent, so the following method cannot be used
-        // this->rowWriter_ = std::make_unique<RowWriterV2>(schema.get(), reader->getData());
-        rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        // may be inconsistent. Only when the row is encoded by the latest schema,
+        // we patch the updated props in place. Otherwise the row is upgraded to
+        // the latest schema by encoding it again.
         val_ = reader_->getData();
+        if (reader_->readerVer() == 2 && reader_->schemaVer() == schema_->getVersion()) {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_, val_);
+            inPlace_ = true;
+        } else {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        }
         return kvstore::ResultCode::SUCCEEDED;
     }
 
@@ -525,11 +569,23 @@ public:
             expCtx_->setEdgeProp(edgeName_, propName, std::move(updateVal));
         }
 
-        for (auto& e : props_) {
-            auto wRet = rowWriter_->setValue(e.first, e.second);
-            if (wRet != WriteResult::SUCCEEDED) {
-                VLOG(1) << "Add field faild ";
-                return folly::none;
+        if (inPlace_) {
+            // Only the updated props need to be written into the old row
+            for (auto& updateProp : updatedProps_) {
+                const auto& propName = updateProp.get_name();
+                auto wRet = rowWriter_->setValue(propName, props_[propName]);
+                if (wRet != WriteResult::SUCCEEDED) {
+                    VLOG(1) << "Add field faild ";
+                    return folly::none;
+                }
+            }
+        } else {
+            for (auto& e : props_) {
+                auto wRet = rowWriter_->setValue(e.first, e.second);
+                if (wRet != WriteResult::SUCCEEDED) {
+                    VLOG(1) << "Add field faild ";
+                    return folly::none;
+                }
             }
         }
 
@@ -627,6 +683,8 @@ private:
     // use to save old row value
     std::string                                                             val_;
     std::unique_ptr<RowWriterV2>                                            rowWriter_;
+    // Whether rowWriter_ patches the old row instead of encoding a new one
+    bool                                                                    inPlace_{false};
 
     // edgeType_ prop -> value
     std::unordered_map<std::string, Value>                                  props_;
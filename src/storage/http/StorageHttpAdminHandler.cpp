@@ -7,6 +7,8 @@
 #include "storage/http/StorageHttpAdminHandler.h"
 #include "common/webservice/Common.h"
 #include "common/process/ProcessUtils.h"
+#include "storage/context/QueryProfile.h"
+#include "utils/Metrics.h"
 #include <proxygen/httpserver/RequestHandler.h>
 #include <proxygen/lib/http/ProxygenErrorEnum.h>
 #include <proxygen/httpserver/ResponseBuilder.h>
@@ -31,13 +33,39 @@ void StorageHttpAdminHandler::onRequest(std::unique_ptr<HTTPMessage> headers) no
         resp_ = folly::stringPrintf("Error inside");
         return;
     }
+    auto* op = headers->getQueryParamPtr("op");
+    if (op != nullptr && *op == "balance_data_path") {
+        // Not bound to a space, the data paths are shared by all spaces
+        LOG(INFO) << "do balance data path";
+        auto status = kv_->balanceDataPaths();
+        if (status != kvstore::ResultCode::SUCCEEDED) {
+            resp_ = folly::stringPrintf("Balance data path failed! error=%d",
+                                        static_cast<int32_t>(status));
+            err_ = HttpCode::SUCCEEDED;
+            return;
+        }
+        resp_ = folly::stringPrintf("ok");
+        err_ = HttpCode::SUCCEEDED;
+        return;
+    }
+    if (op != nullptr && *op == "profiles") {
+        // The latest profiles of query requests of all spaces
+        resp_ = QueryProfile::latest();
+        err_ = HttpCode::SUCCEEDED;
+        return;
+    }
+    if (op != nullptr && *op == "metrics") {
+        // The metrics of the process in the text format of prometheus
+        resp_ = metrics::Metrics::instance()->toPrometheus();
+        err_ = HttpCode::SUCCEEDED;
+        return;
+    }
     auto* space = headers->getQueryParamPtr("space");
     if (space == nullptr) {
         err_ = HttpCode::SUCCEEDED;
         resp_ = "Space should not be empty. Usage: http:://ip:port/admin?space=xx&op=yy";
         return;
     }
-    auto* op = headers->getQueryParamPtr("op");
     if (op == nullptr) {
         err_ = HttpCode::SUCCEEDED;
         resp_ = "Op should not be empty. Usage: http:://ip:port/admin?space=xx&op=yy";
@@ -66,6 +94,31 @@ void StorageHttpAdminHandler::onRequest(std::unique_ptr<HTTPMessage> headers) no
             err_ = HttpCode::SUCCEEDED;
             return;
         }
+    } else if (*op == "move_part") {
+        auto usage = "Part and path should be numbers. "
+                     "Usage: http:://ip:port/admin?space=xx&op=move_part&part=yy&path=zz";
+        auto* part = headers->getQueryParamPtr("part");
+        auto* path = headers->getQueryParamPtr("path");
+        if (part == nullptr || path == nullptr) {
+            resp_ = usage;
+            err_ = HttpCode::SUCCEEDED;
+            return;
+        }
+        auto partId = folly::tryTo<PartitionID>(*part);
+        auto pathIndex = folly::tryTo<int32_t>(*path);
+        if (!partId.hasValue() || !pathIndex.hasValue()) {
+            resp_ = usage;
+            err_ = HttpCode::SUCCEEDED;
+            return;
+        }
+        LOG(INFO) << "do move part " << partId.value() << " to data path " << pathIndex.value()
+                  << " at space=" << *space;
+        auto status = kv_->movePart(spaceId, partId.value(), pathIndex.value());
+        if (status != kvstore::ResultCode::SUCCEEDED) {
+            resp_ = folly::stringPrintf("Move part failed! error=%d", static_cast<int32_t>(status));
+            err_ = HttpCode::SUCCEEDED;
+            return;
+        }
     } else {
         resp_ = folly::stringPrintf("Unknown operation %s", op->c_str());
         err_ = HttpCode::SUCCEEDED;
@@ -1,40 +0,0 @@
-/* Copyright (c) 2019 vesoft inc. All rights reserved.
- *
- * This source code is licensed under Apache 2.0 License,
- * attached with Common Clause Condition 1.0, found in the LICENSES directory.
- */
-
-#ifndef STORAGE_LOOKUPEDGEINDEXPROCESSOR_H
-#define STORAGE_LOOKUPEDGEINDEXPROCESSOR_H
-
-#include "common/base/Base.h"
-#include "kvstore/NebulaStore.h"
-#include "storage/index/IndexExecutor.h"
-
-namespace nebula {
-namespace storage {
-class LookUpEdgeIndexProcessor
-    : public IndexExecutor<cpp2::LookUpEdgeIndexResp> {
-public:
-    static LookUpEdgeIndexProcessor* instance(kvstore::KVStore* kvstore,
-                                              meta::SchemaManager* schemaMan,
-                                              meta::IndexManager* indexMan,
-                                              stats::Stats* stats) {
-        return new LookUpEdgeIndexProcessor(kvstore, schemaMan, indexMan, stats);
-    }
-
-    void process(const cpp2::LookUpIndexRequest& req);
-
-private:
-    explicit LookUpEdgeIndexProcessor(kvstore::KVStore* kvstore,
-                                      meta::SchemaManager* schemaMan,
-                                      meta::IndexManager* indexMan,
-                                      stats::Stats* stats)
-        : IndexExecutor<cpp2::LookUpEdgeIndexResp>
-            (kvstore, schemaMan, indexMan, stats, nullptr, true) {}
-};
-}  // namespace storage
-}  // namespace nebula
-
-#endif  // STORAGE_LOOKUPEDGEINDEXPROCESSOR_H
-
@@ -0,0 +1,392 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/index/LookupProcessor.h"
+#include "storage/exec/IndexScanNode.h"
+#include "storage/exec/IndexVertexNode.h"
+#include "storage/exec/IndexEdgeNode.h"
+#include "storage/exec/IndexFilterNode.h"
+#include "storage/exec/IndexOutputNode.h"
+
+namespace nebula {
+namespace storage {
+
+void LookupProcessor::process(const cpp2::LookupIndexRequest& req) {
+    spaceId_ = req.get_space_id();
+    parts_ = req.get_parts();
+    auto retCode = getSpaceVidLen(spaceId_);
+    if (retCode != cpp2::ErrorCode::SUCCEEDED) {
+        for (auto partId : parts_) {
+            pushResultCode(retCode, partId);
+        }
+        onFinished();
+        return;
+    }
+
+    retCode = checkAndBuildContexts(req);
+    if (retCode != cpp2::ErrorCode::SUCCEEDED) {
+        for (auto partId : parts_) {
+            pushResultCode(retCode, partId);
+        }
+        onFinished();
+        return;
+    }
+
+    partResults_.resize(parts_.size());
+    if (executor_ == nullptr || parts_.size() <= 1) {
+        for (size_t i = 0; i < parts_.size(); i++) {
+            auto ret = runPart(parts_[i], &partResults_[i]);
+            if (ret != kvstore::ResultCode::SUCCEEDED) {
+                partResults_[i].rows.clear();
+                handleErrorCode(ret, spaceId_, parts_[i]);
+            }
+        }
+        onProcessFinished();
+        onFinished();
+        return;
+    }
+
+    std::vector<folly::Future<kvstore::ResultCode>> futures;
+    futures.reserve(parts_.size());
+    for (size_t i = 0; i < parts_.size(); i++) {
+        futures.emplace_back(folly::via(executor_, [this, i] {
+            return runPart(parts_[i], &partResults_[i]);
+        }));
+    }
+    folly::collectAll(futures).via(executor_).thenValue(
+        [this] (std::vector<folly::Try<kvstore::ResultCode>>&& tries) {
+            for (size_t i = 0; i < tries.size(); i++) {
+                if (tries[i].hasException()) {
+                    LOG(ERROR) << "Lookup part " << parts_[i] << " failed: "
+                               << tries[i].exception().what();
+                    partResults_[i].rows.clear();
+                    pushResultCode(cpp2::ErrorCode::E_UNKNOWN, parts_[i]);
+                } else if (tries[i].value() != kvstore::ResultCode::SUCCEEDED) {
+                    partResults_[i].rows.clear();
+                    handleErrorCode(tries[i].value(), spaceId_, parts_[i]);
+                }
+            }
+            onProcessFinished();
+            onFinished();
+        });
+}
+
+kvstore::ResultCode LookupProcessor::runPart(PartitionID partId, nebula::DataSet* result) {
+    // The plan context and the expressions are not thread-safe, each part has its own,
+    // the filter expression keeps the result of eval inside.
+    // The index keys of a dropped schema are removed along with its rows, skip them before
+    auto* dropped = DroppedSchemas::instance();
+    if (isEdge_ ? dropped->isEdgeDropped(spaceId_, schemaId_)
+                : dropped->isTagDropped(spaceId_, schemaId_)) {
+        return kvstore::ResultCode::SUCCEEDED;
+    }
+    PlanContext planCtx(env_, spaceId_, spaceVidLen_);
+    for (size_t i = 0; i < contexts_.size(); i++) {
+        int64_t limit = -1;
+        if (limit_ >= 0) {
+            limit = limit_ - static_cast<int64_t>(result->rows.size());
+            if (limit <= 0) {
+                break;
+            }
+        }
+        StorageExpressionContext expCtx(spaceVidLen_);
+        std::unique_ptr<Expression> filter;
+        const auto& filterStr = contexts_[i].get_filter();
+        if (!filterStr.empty()) {
+            filter = Expression::decode(filterStr);
+        }
+        auto plan = buildPlan(&planCtx, i, &expCtx, filter.get(), limit, result);
+        auto ret = plan.go(partId, indexes_[i]->get_index_id());
+        if (ret != kvstore::ResultCode::SUCCEEDED) {
+            return ret;
+        }
+    }
+    return kvstore::ResultCode::SUCCEEDED;
+}
+
+StoragePlan<IndexID> LookupProcessor::buildPlan(PlanContext* planCtx,
+                                                size_t contextIdx,
+                                                StorageExpressionContext* expCtx,
+                                                Expression* filter,
+                                                int64_t limit,
+                                                nebula::DataSet* result) {
+    /*
+    The StoragePlan looks like this, the data node is only in the plan when some props
+    are not in the index, and the filter node is only in the plan when there is a filter.
+                 +--------+---------+
+                 |  IndexOutputNode |
+                 +--------+---------+
+                          |
+                 +--------+---------+
+                 |  IndexFilterNode |
+                 +--------+---------+
+                          |
+             +------------+------------+
+             | IndexVertex/EdgeNode    |
+             +------------+------------+
+                          |
+                 +--------+---------+
+                 |   IndexScanNode  |
+                 +------------------+
+    */
+    StoragePlan<IndexID> plan;
+    auto scan = std::make_unique<IndexScanNode<IndexID>>(planCtx,
+                                                         indexes_[contextIdx],
+                                                         contexts_[contextIdx].get_column_hints(),
+                                                         isEdge_);
+    auto* scanNode = scan.get();
+    IterateNode<IndexID>* upstream = scanNode;
+    plan.addNode(std::move(scan));
+
+    if (needData(contextIdx)) {
+        std::unique_ptr<IterateNode<IndexID>> data;
+        if (isEdge_) {
+            data = std::make_unique<IndexEdgeNode<IndexID>>(
+                planCtx, &edgeContext_, schemaId_, scanNode);
+        } else {
+            data = std::make_unique<IndexVertexNode<IndexID>>(
+                planCtx, &tagContext_, schemaId_, scanNode);
+        }
+        data->addDependency(upstream);
+        upstream = data.get();
+        plan.addNode(std::move(data));
+    }
+
+    if (filter != nullptr) {
+        auto filterNode = std::make_unique<IndexFilterNode<IndexID>>(
+            upstream, scanNode, expCtx, filter, props(), schemaName_, isEdge_);
+        filterNode->addDependency(upstream);
+        upstream = filterNode.get();
+        plan.addNode(std::move(filterNode));
+    }
+
+    auto output = std::make_unique<IndexOutputNode<IndexID>>(
+        upstream, scanNode, props(), isEdge_, limit, result);
+    output->addDependency(upstream);
+    plan.addNode(std::move(output));
+    return plan;
+}
+
+bool LookupProcessor::needData(size_t contextIdx) const {
+    // The index keys of expired rows are not removed, so the rows must be checked
+    if (isEdge_ ? edgeContext_.ttlInfo_.count(schemaId_) : tagContext_.ttlInfo_.count(schemaId_)) {
+        return true;
+    }
+    const auto& index = indexes_[contextIdx];
+    bool hasFilter = !contexts_[contextIdx].get_filter().empty();
+    for (const auto& prop : *props()) {
+        if (!prop.returned_ && !(prop.filtered_ && hasFilter)) {
+            continue;
+        }
+        if (isEdge_ && prop.propInKeyType_ != PropContext::PropInKeyType::NONE) {
+            continue;
+        }
+        const auto& fields = index->get_fields();
+        auto found = std::any_of(fields.begin(), fields.end(),
+                                 [&prop] (const auto& col) {
+                                     return col.get_name() == prop.name_;
+                                 });
+        if (!found) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<PropContext>* LookupProcessor::props() const {
+    if (isEdge_) {
+        return &edgeContext_.propContexts_[edgeContext_.indexMap_.at(schemaId_)].second;
+    }
+    return &tagContext_.propContexts_[tagContext_.indexMap_.at(schemaId_)].second;
+}
+
+cpp2::ErrorCode LookupProcessor::checkAndBuildContexts(const cpp2::LookupIndexRequest& req) {
+    const auto& indices = req.get_indices();
+    isEdge_ = indices.get_is_edge();
+    schemaId_ = indices.get_tag_or_edge_id();
+    if (req.__isset.limit) {
+        limit_ = req.limit;
+    }
+    if (indices.get_contexts().empty()) {
+        return cpp2::ErrorCode::E_INVALID_OPERATION;
+    }
+
+    auto code = isEdge_ ? getSpaceEdgeSchema() : getSpaceVertexSchema();
+    if (code != cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    code = buildReturnProps(req);
+    if (code != cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+
+    for (const auto& ctx : indices.get_contexts()) {
+        auto indexRet = isEdge_
+                      ? env_->indexMan_->getEdgeIndex(spaceId_, ctx.get_index_id())
+                      : env_->indexMan_->getTagIndex(spaceId_, ctx.get_index_id());
+        if (!indexRet.ok()) {
+            VLOG(1) << "Can't find index " << ctx.get_index_id() << " in space " << spaceId_;
+            return cpp2::ErrorCode::E_INDEX_NOT_FOUND;
+        }
+        auto index = std::move(indexRet).value();
+        auto indexSchemaId = isEdge_ ? index->get_schema_id().get_edge_type()
+                                     : index->get_schema_id().get_tag_id();
+        if (indexSchemaId != schemaId_) {
+            VLOG(1) << "Index " << ctx.get_index_id() << " is not on " << schemaName_;
+            return cpp2::ErrorCode::E_INVALID_OPERATION;
+        }
+        code = checkColumnHints(*index, ctx.get_column_hints());
+        if (code != cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+
+        // The filter is decoded again for each part when running, here it is only to
+        // collect the props in it
+        const auto& filterStr = ctx.get_filter();
+        if (!filterStr.empty()) {
+            auto filter = Expression::decode(filterStr);
+            if (filter == nullptr) {
+                return cpp2::ErrorCode::E_INVALID_FILTER;
+            }
+            code = checkExp(filter.get(), false, true);
+            if (code != cpp2::ErrorCode::SUCCEEDED) {
+                return code;
+            }
+        }
+        contexts_.emplace_back(ctx);
+        indexes_.emplace_back(std::move(index));
+    }
+
+    // The filter could only be on the props of the tag or edge being looked up
+    auto propsCount = isEdge_ ? edgeContext_.propContexts_.size()
+                              : tagContext_.propContexts_.size();
+    if (propsCount != 1) {
+        return cpp2::ErrorCode::E_INVALID_FILTER;
+    }
+    if (isEdge_) {
+        buildEdgeTTLInfo();
+    } else {
+        buildTagTTLInfo();
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode LookupProcessor::checkColumnHints(
+        const meta::cpp2::IndexItem& index,
+        const std::vector<cpp2::IndexColumnHint>& hints) {
+    // The hints must be on the leading columns of the index, in the same order, and only
+    // the last one could be a range
+    const auto& fields = index.get_fields();
+    if (hints.size() > fields.size()) {
+        return cpp2::ErrorCode::E_INVALID_OPERATION;
+    }
+    for (size_t i = 0; i < hints.size(); i++) {
+        const auto& hint = hints[i];
+        if (hint.get_column_name() != fields[i].get_name()) {
+            VLOG(1) << "Column hint " << hint.get_column_name() << " is not column " << i
+                    << " of index " << index.get_index_id();
+            return cpp2::ErrorCode::E_INVALID_OPERATION;
+        }
+        auto type = IndexKeyUtils::toValueType(fields[i].get_type());
+        const auto& begin = hint.get_begin_value();
+        const auto& end = hint.get_end_value();
+        if (hint.get_scan_type() == cpp2::ScanType::PREFIX) {
+            if (begin.type() != type) {
+                return cpp2::ErrorCode::E_INVALID_OPERATION;
+            }
+        } else {
+            if (i != hints.size() - 1) {
+                return cpp2::ErrorCode::E_INVALID_OPERATION;
+            }
+            if ((!begin.empty() && begin.type() != type) || (!end.empty() && end.type() != type)) {
+                return cpp2::ErrorCode::E_INVALID_OPERATION;
+            }
+        }
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+cpp2::ErrorCode LookupProcessor::buildReturnProps(const cpp2::LookupIndexRequest& req) {
+    std::vector<std::string> returnCols;
+    if (req.__isset.return_columns) {
+        returnCols = *req.get_return_columns();
+    }
+
+    std::shared_ptr<const meta::NebulaSchemaProvider> schema;
+    if (isEdge_) {
+        auto iter = edgeContext_.schemas_.find(schemaId_);
+        if (iter == edgeContext_.schemas_.end()) {
+            VLOG(1) << "Can't find spaceId " << spaceId_ << " edgeType " << schemaId_;
+            return cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+        }
+        schema = iter->second.back();
+        auto edgeName = env_->schemaMan_->toEdgeName(spaceId_, schemaId_);
+        if (!edgeName.ok()) {
+            return cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+        }
+        schemaName_ = std::move(edgeName).value();
+        resultDataSet_.colNames.emplace_back(kSrc);
+        resultDataSet_.colNames.emplace_back(kRank);
+        resultDataSet_.colNames.emplace_back(kDst);
+    } else {
+        auto iter = tagContext_.schemas_.find(schemaId_);
+        if (iter == tagContext_.schemas_.end()) {
+            VLOG(1) << "Can't find spaceId " << spaceId_ << " tagId " << schemaId_;
+            return cpp2::ErrorCode::E_TAG_NOT_FOUND;
+        }
+        schema = iter->second.back();
+        auto tagName = env_->schemaMan_->toTagName(spaceId_, schemaId_);
+        if (!tagName.ok()) {
+            return cpp2::ErrorCode::E_TAG_NOT_FOUND;
+        }
+        schemaName_ = std::move(tagName).value();
+        resultDataSet_.colNames.emplace_back(kVid);
+    }
+
+    std::vector<PropContext> ctxs;
+    for (const auto& col : returnCols) {
+        const meta::SchemaProviderIf::Field* field = nullptr;
+        bool inKey = isEdge_ && (col == kSrc || col == kType || col == kRank || col == kDst);
+        if (!inKey) {
+            field = schema->field(col);
+            if (field == nullptr) {
+                VLOG(1) << "Can't find prop " << col << " of " << schemaName_;
+                return isEdge_ ? cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND
+                               : cpp2::ErrorCode::E_TAG_PROP_NOT_FOUND;
+            }
+        }
+        addReturnPropContext(ctxs, col.c_str(), field);
+        resultDataSet_.colNames.emplace_back(schemaName_ + ":" + col);
+    }
+
+    // The entry is added even if no prop is returned, the props in filter are added
+    // into it by checkExp
+    if (isEdge_) {
+        edgeContext_.propContexts_.emplace_back(schemaId_, std::move(ctxs));
+        edgeContext_.indexMap_.emplace(schemaId_, edgeContext_.propContexts_.size() - 1);
+        edgeContext_.edgeNames_.emplace(schemaId_, schemaName_);
+    } else {
+        tagContext_.propContexts_.emplace_back(schemaId_, std::move(ctxs));
+        tagContext_.indexMap_.emplace(schemaId_, tagContext_.propContexts_.size() - 1);
+        tagContext_.tagNames_.emplace(schemaId_, schemaName_);
+    }
+    return cpp2::ErrorCode::SUCCEEDED;
+}
+
+void LookupProcessor::onProcessFinished() {
+    for (auto& partResult : partResults_) {
+        for (auto& row : partResult.rows) {
+            if (limit_ >= 0 && static_cast<int64_t>(resultDataSet_.rows.size()) >= limit_) {
+                break;
+            }
+            resultDataSet_.rows.emplace_back(std::move(row));
+        }
+    }
+    resp_.set_data(std::move(resultDataSet_));
+}
+
+}  // namespace storage
+}  // namespace nebula
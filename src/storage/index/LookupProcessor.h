@@ -0,0 +1,86 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_INDEX_LOOKUPPROCESSOR_H_
+#define STORAGE_INDEX_LOOKUPPROCESSOR_H_
+
+#include "common/base/Base.h"
+#include "storage/query/QueryBaseProcessor.h"
+#include "storage/exec/StoragePlan.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * LookupProcessor scans the indexes of a tag or an edge type. Each IndexQueryContext of the
+ * request is a scan on one index, with the column hints as the bounds of the scan and an
+ * optional filter on the rows.
+ *
+ * When all returned props and props in filter are in the index, the data rows are not read
+ * at all. The parts are run in parallel on the executor if it is given, each part has its
+ * own plans, and the limit is pushed down to each of them.
+ * */
+class LookupProcessor
+    : public QueryBaseProcessor<cpp2::LookupIndexRequest, cpp2::LookupIndexResp> {
+public:
+    static LookupProcessor* instance(StorageEnv* env,
+                                     stats::Stats* stats,
+                                     VertexCache* cache,
+                                     folly::Executor* executor = nullptr) {
+        return new LookupProcessor(env, stats, cache, executor);
+    }
+
+    void process(const cpp2::LookupIndexRequest& req) override;
+
+protected:
+    LookupProcessor(StorageEnv* env,
+                    stats::Stats* stats,
+                    VertexCache* cache,
+                    folly::Executor* executor)
+        : QueryBaseProcessor<cpp2::LookupIndexRequest,
+                             cpp2::LookupIndexResp>(env, stats, cache)
+        , executor_(executor) {}
+
+    void onProcessFinished() override;
+
+    cpp2::ErrorCode checkAndBuildContexts(const cpp2::LookupIndexRequest& req) override;
+
+    cpp2::ErrorCode checkColumnHints(const meta::cpp2::IndexItem& index,
+                                     const std::vector<cpp2::IndexColumnHint>& hints);
+
+    cpp2::ErrorCode buildReturnProps(const cpp2::LookupIndexRequest& req);
+
+    // Run all index scans of a part, the rows are appended into result
+    kvstore::ResultCode runPart(PartitionID partId, nebula::DataSet* result);
+
+    StoragePlan<IndexID> buildPlan(PlanContext* planCtx,
+                                   size_t contextIdx,
+                                   StorageExpressionContext* expCtx,
+                                   Expression* filter,
+                                   int64_t limit,
+                                   nebula::DataSet* result);
+
+    // Whether the data row should be read for the index scan
+    bool needData(size_t contextIdx) const;
+
+    const std::vector<PropContext>* props() const;
+
+private:
+    folly::Executor*                                        executor_{nullptr};
+    bool                                                    isEdge_ = false;
+    int32_t                                                 schemaId_ = 0;
+    std::string                                             schemaName_;
+    // negative means no limit
+    int64_t                                                 limit_ = -1;
+    std::vector<cpp2::IndexQueryContext>                    contexts_;
+    std::vector<std::shared_ptr<meta::cpp2::IndexItem>>     indexes_;
+    std::vector<PartitionID>                                parts_;
+    std::vector<nebula::DataSet>                            partResults_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_INDEX_LOOKUPPROCESSOR_H_
@@ -0,0 +1,69 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/kv/CasProcessor.h"
+#include "storage/kv/KVValueUtils.h"
+#include "kvstore/LogEncoder.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+void CasProcessor::process(const KVCasRequest& req) {
+    CHECK_NOTNULL(env_->kvstore_);
+    auto spaceId = req.space_id;
+    auto partId = req.part_id;
+    req_ = req;
+    callingNum_ = 1;
+    env_->kvstore_->asyncAtomicOp(spaceId, partId,
+        [this] () -> folly::Optional<std::string> {
+            return compareAndSet(req_);
+        },
+        [spaceId, partId, this] (kvstore::ResultCode code) {
+            if (code != kvstore::ResultCode::SUCCEEDED) {
+                if (code_ == kvstore::ResultCode::ERR_RESULT_FILTERED) {
+                    // Not swapped, the current value is in the response
+                    code = kvstore::ResultCode::SUCCEEDED;
+                } else if (code_ != kvstore::ResultCode::SUCCEEDED) {
+                    code = code_;
+                }
+            }
+            if (code != kvstore::ResultCode::SUCCEEDED) {
+                resp_.swapped = false;
+            }
+            handleAsync(spaceId, partId, code);
+        });
+}
+
+folly::Optional<std::string> CasProcessor::compareAndSet(const KVCasRequest& req) {
+    resp_.swapped = false;
+    resp_.current = folly::none;
+    auto key = NebulaKeyUtils::kvKey(req.part_id, req.key);
+    std::string raw;
+    auto ret = env_->kvstore_->get(req.space_id, req.part_id, key, &raw);
+    if (ret == kvstore::ResultCode::SUCCEEDED && !KVValueUtils::isExpired(raw)) {
+        resp_.current = KVValueUtils::getValue(raw).str();
+    } else if (ret != kvstore::ResultCode::SUCCEEDED &&
+               ret != kvstore::ResultCode::ERR_KEY_NOT_FOUND) {
+        code_ = ret;
+        return folly::none;
+    }
+
+    if (resp_.current != req.expected) {
+        code_ = kvstore::ResultCode::ERR_RESULT_FILTERED;
+        return folly::none;
+    }
+    resp_.swapped = true;
+    resp_.current = folly::none;
+    code_ = kvstore::ResultCode::SUCCEEDED;
+    kvstore::BatchHolder batchHolder;
+    batchHolder.put(std::move(key),
+                    KVValueUtils::encode(req.value, KVValueUtils::expireAt(req.ttl_in_secs)));
+    return kvstore::encodeBatchValue(batchHolder.getBatch());
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,43 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_KV_CASPROCESSOR_H_
+#define STORAGE_KV_CASPROCESSOR_H_
+
+#include "common/base/Base.h"
+#include "storage/BaseProcessor.h"
+#include "storage/kv/KVRequests.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Compare the value of a key with the expected one and set it if they are equal, in one
+ * atomic op of the part. A mismatch is not an error, the response carries the current value.
+ * */
+class CasProcessor : public BaseProcessor<KVCasResponse> {
+public:
+    static CasProcessor* instance(StorageEnv* env, stats::Stats* stats) {
+        return new CasProcessor(env, stats);
+    }
+
+    void process(const KVCasRequest& req);
+
+private:
+    explicit CasProcessor(StorageEnv* env, stats::Stats* stats)
+            : BaseProcessor<KVCasResponse>(env, stats) {}
+
+    folly::Optional<std::string> compareAndSet(const KVCasRequest& req);
+
+private:
+    KVCasRequest            req_;
+    kvstore::ResultCode     code_{kvstore::ResultCode::SUCCEEDED};
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_KV_CASPROCESSOR_H_
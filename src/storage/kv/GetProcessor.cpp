@@ -5,6 +5,8 @@
  */
 
 #include "storage/kv/GetProcessor.h"
+#include "storage/kv/KVValueUtils.h"
+#include "storage/StorageFlags.h"
 #include "utils/NebulaKeyUtils.h"
 
 namespace nebula {
@@ -12,40 +14,97 @@ namespace storage {
 
 void GetProcessor::process(const cpp2::KVGetRequest& req) {
     CHECK_NOTNULL(env_->kvstore_);
-    GraphSpaceID spaceId = req.get_space_id();
-    bool returnPartly = req.get_return_partly();
+    spaceId_ = req.get_space_id();
+    returnPartly_ = req.get_return_partly();
 
-    std::unordered_map<std::string, std::string> pairs;
     size_t size = 0;
+    partResults_.reserve(req.get_parts().size());
     for (auto& part : req.get_parts()) {
-        size += part.second.size();
+        auto partId = part.first;
+        PartResult result;
+        result.partId = partId;
+        result.keys.reserve(part.second.size());
+        for (const auto& key : part.second) {
+            result.keys.emplace_back(NebulaKeyUtils::kvKey(partId, key));
+        }
+        size += result.keys.size();
+        partResults_.emplace_back(std::move(result));
+    }
+
+    // Split the parts into tasks by the number of keys, so a small request is not scattered
+    size_t tasks = std::min(partResults_.size(),
+                            (size + FLAGS_kv_get_keys_per_task - 1)
+                                / std::max<uint32_t>(FLAGS_kv_get_keys_per_task, 1));
+    if (executor_ == nullptr || tasks <= 1) {
+        for (auto& result : partResults_) {
+            getPart(&result);
+        }
+        onProcessFinished();
+        onFinished();
+        return;
+    }
+
+    std::vector<folly::Future<folly::Unit>> futures;
+    futures.reserve(tasks);
+    for (size_t i = 0; i < tasks; i++) {
+        futures.emplace_back(folly::via(executor_, [this, i, tasks] {
+            for (size_t j = i; j < partResults_.size(); j += tasks) {
+                getPart(&partResults_[j]);
+            }
+        }));
+    }
+    folly::collectAll(futures).via(executor_).thenValue(
+        [this] (std::vector<folly::Try<folly::Unit>>&& tries) {
+            for (auto& t : tries) {
+                if (t.hasException()) {
+                    LOG(ERROR) << "Get kv failed: " << t.exception().what();
+                }
+            }
+            onProcessFinished();
+            onFinished();
+        });
+}
+
+void GetProcessor::getPart(PartResult* result) {
+    auto ret = env_->kvstore_->multiGet(spaceId_, result->partId, result->keys, &result->values);
+    result->code = ret.first;
+    result->status = std::move(ret.second);
+}
+
+void GetProcessor::onProcessFinished() {
+    std::unordered_map<std::string, std::string> pairs;
+    size_t size = 0;
+    for (auto& result : partResults_) {
+        size += result.keys.size();
     }
     pairs.reserve(size);
 
-    for (auto& part : req.get_parts()) {
-        auto partId = part.first;
-        auto& keys = part.second;
-        std::vector<std::string> kvKeys;
-        kvKeys.reserve(part.second.size());
-        std::transform(keys.begin(), keys.end(), std::back_inserter(kvKeys),
-                       [partId] (const auto& key) { return NebulaKeyUtils::kvKey(partId, key); });
-        std::vector<std::string> values;
-        auto ret = env_->kvstore_->multiGet(spaceId, partId, kvKeys, &values);
-        if ((ret.first == kvstore::ResultCode::SUCCEEDED) ||
-            (ret.first == kvstore::ResultCode::ERR_PARTIAL_RESULT && returnPartly)) {
-            auto& status = ret.second;
-            for (size_t i = 0; i < kvKeys.size(); i++) {
-                if (status[i].ok()) {
-                    pairs.emplace(keys[i], values[i]);
+    auto now = time::WallClock::fastNowInSec();
+    for (auto& result : partResults_) {
+        // The expired keys are taken as missing
+        if (result.code == kvstore::ResultCode::SUCCEEDED ||
+            result.code == kvstore::ResultCode::ERR_PARTIAL_RESULT) {
+            for (size_t i = 0; i < result.keys.size(); i++) {
+                if (result.status[i].ok() && KVValueUtils::isExpired(result.values[i], now)) {
+                    result.status[i] = Status::KeyNotFound();
+                    result.code = kvstore::ResultCode::ERR_PARTIAL_RESULT;
+                }
+            }
+        }
+        if ((result.code == kvstore::ResultCode::SUCCEEDED) ||
+            (result.code == kvstore::ResultCode::ERR_PARTIAL_RESULT && returnPartly_)) {
+            for (size_t i = 0; i < result.keys.size(); i++) {
+                if (result.status[i].ok()) {
+                    // Strip the prefix of the part from the key
+                    pairs.emplace(result.keys[i].substr(sizeof(PartitionID)),
+                                  KVValueUtils::getValue(result.values[i]).str());
                 }
             }
         } else {
-            handleErrorCode(ret.first, spaceId, partId);
+            handleErrorCode(result.code, spaceId_, result.partId);
         }
     }
-
     resp_.set_key_values(std::move(pairs));
-    this->onFinished();
 }
 
 }  // namespace storage
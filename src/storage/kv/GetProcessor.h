@@ -13,17 +13,46 @@
 namespace nebula {
 namespace storage {
 
+/**
+ * Get the values of the keys in each part by one batched multiGet of the engine.
+ *
+ * When an executor is given and there are enough keys, the parts are split into a few
+ * tasks by the number of keys, and the tasks are run in parallel on the executor.
+ * */
 class GetProcessor : public BaseProcessor<cpp2::KVGetResponse> {
 public:
-    static GetProcessor* instance(StorageEnv* env, stats::Stats* stats) {
-        return new GetProcessor(env, stats);
+    static GetProcessor* instance(StorageEnv* env,
+                                  stats::Stats* stats,
+                                  folly::Executor* executor = nullptr) {
+        return new GetProcessor(env, stats, executor);
     }
 
     void process(const cpp2::KVGetRequest& req);
 
 protected:
-    explicit GetProcessor(StorageEnv* env, stats::Stats* stats):
-        BaseProcessor<cpp2::KVGetResponse>(env, stats) {}
+    GetProcessor(StorageEnv* env, stats::Stats* stats, folly::Executor* executor)
+        : BaseProcessor<cpp2::KVGetResponse>(env, stats)
+        , executor_(executor) {}
+
+private:
+    struct PartResult {
+        PartitionID                 partId;
+        // The keys with the prefix of the part, as they are in the engine
+        std::vector<std::string>    keys;
+        std::vector<std::string>    values;
+        std::vector<Status>         status;
+        kvstore::ResultCode         code{kvstore::ResultCode::ERR_UNKNOWN};
+    };
+
+    void getPart(PartResult* result);
+
+    void onProcessFinished();
+
+private:
+    folly::Executor*            executor_{nullptr};
+    GraphSpaceID                spaceId_;
+    bool                        returnPartly_{false};
+    std::vector<PartResult>     partResults_;
 };
 
 }  // namespace storage
@@ -0,0 +1,95 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/kv/IncrProcessor.h"
+#include "storage/kv/KVValueUtils.h"
+#include "kvstore/LogEncoder.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+void IncrProcessor::process(const KVIncrRequest& req) {
+    CHECK_NOTNULL(env_->kvstore_);
+    spaceId_ = req.space_id;
+    ttl_ = req.ttl_in_secs;
+    for (const auto& part : req.parts) {
+        parts_[part.first].deltas = part.second;
+    }
+    callingNum_ = parts_.size();
+    if (callingNum_ == 0) {
+        onFinished();
+        return;
+    }
+
+    for (auto& part : parts_) {
+        auto partId = part.first;
+        auto* partIncr = &part.second;
+        env_->kvstore_->asyncAtomicOp(spaceId_, partId,
+            [partId, partIncr, this] () -> folly::Optional<std::string> {
+                return incr(partId, partIncr);
+            },
+            [partId, partIncr, this] (kvstore::ResultCode code) {
+                if (code == kvstore::ResultCode::SUCCEEDED) {
+                    std::lock_guard<std::mutex> lg(this->lock_);
+                    for (size_t i = 0; i < partIncr->deltas.size(); i++) {
+                        resp_.values[partIncr->deltas[i].first] = partIncr->values[i];
+                    }
+                } else if (partIncr->code != kvstore::ResultCode::SUCCEEDED) {
+                    // The reason why the op failed
+                    code = partIncr->code;
+                }
+                handleAsync(spaceId_, partId, code);
+            });
+    }
+}
+
+folly::Optional<std::string> IncrProcessor::incr(PartitionID partId, PartIncr* part) {
+    part->values.clear();
+    auto now = time::WallClock::fastNowInSec();
+    // The keys written by the former deltas, a key may appear more than once
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>> written;
+    kvstore::BatchHolder batchHolder;
+    for (const auto& delta : part->deltas) {
+        auto key = NebulaKeyUtils::kvKey(partId, delta.first);
+        int64_t value = 0;
+        int64_t expireAt = KVValueUtils::expireAt(ttl_);
+        auto it = written.find(key);
+        if (it != written.end()) {
+            std::tie(value, expireAt) = it->second;
+        } else {
+            std::string raw;
+            auto ret = env_->kvstore_->get(spaceId_, partId, key, &raw);
+            if (ret == kvstore::ResultCode::SUCCEEDED && !KVValueUtils::isExpired(raw, now)) {
+                auto current = folly::tryTo<int64_t>(KVValueUtils::getValue(raw));
+                if (!current.hasValue()) {
+                    LOG(ERROR) << "The value of " << delta.first << " is not an integer";
+                    part->code = kvstore::ResultCode::ERR_INVALID_DATA;
+                    return folly::none;
+                }
+                value = current.value();
+                // Keep the ttl of the existing key
+                expireAt = KVValueUtils::getExpireAt(raw);
+            } else if (ret != kvstore::ResultCode::SUCCEEDED &&
+                       ret != kvstore::ResultCode::ERR_KEY_NOT_FOUND) {
+                part->code = ret;
+                return folly::none;
+            }
+        }
+        value += delta.second;
+        written[key] = std::make_pair(value, expireAt);
+        part->values.emplace_back(value);
+    }
+    for (auto& kv : written) {
+        batchHolder.put(std::string(kv.first),
+                        KVValueUtils::encode(folly::to<std::string>(kv.second.first),
+                                             kv.second.second));
+    }
+    return kvstore::encodeBatchValue(batchHolder.getBatch());
+}
+
+}  // namespace storage
+}  // namespace nebula
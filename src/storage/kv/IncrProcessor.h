@@ -0,0 +1,53 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_KV_INCRPROCESSOR_H_
+#define STORAGE_KV_INCRPROCESSOR_H_
+
+#include "common/base/Base.h"
+#include "storage/BaseProcessor.h"
+#include "storage/kv/KVRequests.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Increase the integer values of the keys. The keys of a part are read and written in one
+ * atomic op of the part, so the concurrent increments never lose an update. The values are
+ * kept as decimal strings, so they could be read by get as well.
+ * */
+class IncrProcessor : public BaseProcessor<KVIncrResponse> {
+public:
+    static IncrProcessor* instance(StorageEnv* env, stats::Stats* stats) {
+        return new IncrProcessor(env, stats);
+    }
+
+    void process(const KVIncrRequest& req);
+
+private:
+    explicit IncrProcessor(StorageEnv* env, stats::Stats* stats)
+            : BaseProcessor<KVIncrResponse>(env, stats) {}
+
+    struct PartIncr {
+        std::vector<std::pair<std::string, int64_t>>    deltas;
+        // The values after increment, in the order of the deltas
+        std::vector<int64_t>                            values;
+        kvstore::ResultCode                             code{kvstore::ResultCode::SUCCEEDED};
+    };
+
+    // Evaluate the increments of the part, return the batch to write
+    folly::Optional<std::string> incr(PartitionID partId, PartIncr* part);
+
+private:
+    GraphSpaceID                                    spaceId_;
+    int64_t                                         ttl_{0};
+    std::unordered_map<PartitionID, PartIncr>       parts_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_KV_INCRPROCESSOR_H_
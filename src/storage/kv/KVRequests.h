@@ -0,0 +1,100 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_KV_KVREQUESTS_H_
+#define STORAGE_KV_KVREQUESTS_H_
+
+#include "common/base/Base.h"
+#include "common/interface/gen-cpp2/storage_types.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * The requests of the kv service beyond put/get/remove. They are not in the common
+ * interface yet, so they are defined here in the same shape as the generated types,
+ * the processors could be served once the service methods are added.
+ * */
+
+struct KVTtlPair {
+    std::string     key;
+    std::string     value;
+    // Seconds the key lives, not positive means forever
+    int64_t         ttl_in_secs{0};
+};
+
+struct KVTtlPutRequest {
+    GraphSpaceID                                                space_id;
+    std::unordered_map<PartitionID, std::vector<KVTtlPair>>     parts;
+};
+
+// Scan the keys in [start, end) of a part, or the keys with the prefix if it is not empty.
+// The scan begins from the cursor if it is set, which is returned by the previous page.
+struct KVScanRequest {
+    GraphSpaceID                    space_id;
+    PartitionID                     part_id;
+    std::string                     start;
+    std::string                     end;
+    std::string                     prefix;
+    folly::Optional<std::string>    cursor;
+    // The max number of keys in a page
+    int32_t                         limit{1000};
+};
+
+struct KVScanResponse {
+    cpp2::ResponseCommon            result;
+    std::vector<nebula::KeyValue>   key_values;
+    // The cursor of the next page, none if all keys have been returned
+    folly::Optional<std::string>    next_cursor;
+
+    void set_result(cpp2::ResponseCommon res) {
+        result = std::move(res);
+    }
+};
+
+// Add the delta to the integer value of each key, a missing key is taken as 0
+struct KVIncrRequest {
+    GraphSpaceID                                                                space_id;
+    std::unordered_map<PartitionID, std::vector<std::pair<std::string, int64_t>>> parts;
+    // The ttl of the keys created by the request, not positive means forever
+    int64_t                                                                     ttl_in_secs{0};
+};
+
+struct KVIncrResponse {
+    cpp2::ResponseCommon                            result;
+    // The values after increment of the keys in the succeeded parts
+    std::unordered_map<std::string, int64_t>        values;
+
+    void set_result(cpp2::ResponseCommon res) {
+        result = std::move(res);
+    }
+};
+
+// Set the key to the value if its current value equals the expected one, the key must
+// not exist if expected is none
+struct KVCasRequest {
+    GraphSpaceID                    space_id;
+    PartitionID                     part_id;
+    std::string                     key;
+    folly::Optional<std::string>    expected;
+    std::string                     value;
+    int64_t                         ttl_in_secs{0};
+};
+
+struct KVCasResponse {
+    cpp2::ResponseCommon            result;
+    bool                            swapped{false};
+    // The current value of the key when it is not swapped, none if the key doesn't exist
+    folly::Optional<std::string>    current;
+
+    void set_result(cpp2::ResponseCommon res) {
+        result = std::move(res);
+    }
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_KV_KVREQUESTS_H_
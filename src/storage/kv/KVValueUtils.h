@@ -0,0 +1,87 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_KV_KVVALUEUTILS_H_
+#define STORAGE_KV_KVVALUEUTILS_H_
+
+#include "common/base/Base.h"
+#include "common/time/WallClock.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * The value of the kv service in the engine:
+ *
+ * | magic (uint32_t) | expire time (int64_t) | user value |
+ *
+ * The expire time is in seconds since epoch, 0 means the key never expires. An expired
+ * key is invisible to the reads at once, and dropped by the compaction filter in kv mode.
+ *
+ * The kv keys share the data key type with the vertices and edges, so the magic tells
+ * a value written by the kv service. Its first byte 0xFF never starts an encoded row. A
+ * value without the header, e.g. one written before the ttl is supported, is read as a
+ * whole and never expires.
+ * */
+class KVValueUtils final {
+public:
+    static constexpr uint32_t kMagic = 0x564B4EFF;
+    static constexpr size_t kHeaderLen = sizeof(uint32_t) + sizeof(int64_t);
+
+    // The expire time of a key put now with the ttl, 0 if the ttl is not positive
+    static int64_t expireAt(int64_t ttlInSecs) {
+        return ttlInSecs > 0 ? time::WallClock::fastNowInSec() + ttlInSecs : 0;
+    }
+
+    static std::string encode(folly::StringPiece val, int64_t expireAt = 0) {
+        uint32_t magic = kMagic;
+        std::string raw;
+        raw.reserve(kHeaderLen + val.size());
+        raw.append(reinterpret_cast<const char*>(&magic), sizeof(uint32_t))
+           .append(reinterpret_cast<const char*>(&expireAt), sizeof(int64_t))
+           .append(val.data(), val.size());
+        return raw;
+    }
+
+    static bool hasHeader(folly::StringPiece raw) {
+        if (raw.size() < kHeaderLen) {
+            return false;
+        }
+        uint32_t magic;
+        memcpy(&magic, raw.data(), sizeof(uint32_t));
+        return magic == kMagic;
+    }
+
+    // 0 if the value has no header
+    static int64_t getExpireAt(folly::StringPiece raw) {
+        if (!hasHeader(raw)) {
+            return 0;
+        }
+        int64_t expireAt;
+        memcpy(&expireAt, raw.data() + sizeof(uint32_t), sizeof(int64_t));
+        return expireAt;
+    }
+
+    static bool isExpired(folly::StringPiece raw, int64_t now) {
+        auto expireAt = getExpireAt(raw);
+        return expireAt > 0 && expireAt <= now;
+    }
+
+    static bool isExpired(folly::StringPiece raw) {
+        return isExpired(raw, time::WallClock::fastNowInSec());
+    }
+
+    static folly::StringPiece getValue(folly::StringPiece raw) {
+        return hasHeader(raw) ? raw.subpiece(kHeaderLen) : raw;
+    }
+
+private:
+    KVValueUtils() = delete;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_KV_KVVALUEUTILS_H_
@@ -5,6 +5,7 @@
  */
 
 #include "storage/kv/PutProcessor.h"
+#include "storage/kv/KVValueUtils.h"
 #include "utils/NebulaKeyUtils.h"
 
 namespace nebula {
@@ -21,7 +22,25 @@ void PutProcessor::process(const cpp2::KVPutRequest& req) {
         std::vector<kvstore::KV> data;
         for (auto& pair : value.second) {
             data.emplace_back(std::move(NebulaKeyUtils::kvKey(part, pair.key)),
-                              std::move(pair.value));
+                              KVValueUtils::encode(pair.value));
+        }
+        doPut(space, part, std::move(data));
+    });
+}
+
+void PutProcessor::process(const KVTtlPutRequest& req) {
+    CHECK_NOTNULL(env_->kvstore_);
+    const auto& pairs = req.parts;
+    auto space = req.space_id;
+    callingNum_ = pairs.size();
+
+    std::for_each(pairs.begin(), pairs.end(), [&](auto& value) {
+        auto part = value.first;
+        std::vector<kvstore::KV> data;
+        for (auto& pair : value.second) {
+            data.emplace_back(NebulaKeyUtils::kvKey(part, pair.key),
+                              KVValueUtils::encode(pair.value,
+                                                   KVValueUtils::expireAt(pair.ttl_in_secs)));
         }
         doPut(space, part, std::move(data));
     });
@@ -9,6 +9,7 @@
 
 #include "common/base/Base.h"
 #include "storage/BaseProcessor.h"
+#include "storage/kv/KVRequests.h"
 
 namespace nebula {
 namespace storage {
@@ -21,6 +22,9 @@ public:
 
     void process(const cpp2::KVPutRequest& req);
 
+    // Put the keys with their own ttl
+    void process(const KVTtlPutRequest& req);
+
 private:
     explicit PutProcessor(StorageEnv* env, stats::Stats* stats)
             : BaseProcessor<cpp2::ExecResponse>(env, stats) {}
@@ -0,0 +1,74 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/kv/ScanProcessor.h"
+#include "storage/kv/KVValueUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+void ScanProcessor::process(const KVScanRequest& req) {
+    CHECK_NOTNULL(env_->kvstore_);
+    auto spaceId = req.space_id;
+    auto partId = req.part_id;
+    if (req.limit <= 0) {
+        pushResultCode(cpp2::ErrorCode::E_INVALID_OPERATION, partId);
+        onFinished();
+        return;
+    }
+
+    std::string start = req.prefix.empty() ? req.start : req.prefix;
+    if (req.cursor.hasValue() && req.cursor.value() > start) {
+        start = req.cursor.value();
+    }
+    auto startKey = NebulaKeyUtils::kvKey(partId, start);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    kvstore::ResultCode ret;
+    if (!req.prefix.empty() || req.end.empty()) {
+        // All kv keys of the part share the prefix of the empty key
+        ret = env_->kvstore_->rangeWithPrefix(spaceId,
+                                              partId,
+                                              startKey,
+                                              NebulaKeyUtils::kvKey(partId, req.prefix),
+                                              &iter);
+    } else {
+        ret = env_->kvstore_->range(spaceId,
+                                    partId,
+                                    startKey,
+                                    NebulaKeyUtils::kvKey(partId, req.end),
+                                    &iter);
+    }
+    if (ret != kvstore::ResultCode::SUCCEEDED) {
+        handleErrorCode(ret, spaceId, partId);
+        onFinished();
+        return;
+    }
+
+    auto now = time::WallClock::fastNowInSec();
+    std::vector<nebula::KeyValue> kvs;
+    for (; iter->valid(); iter->next()) {
+        auto val = iter->val();
+        if (KVValueUtils::isExpired(val, now)) {
+            continue;
+        }
+        // Strip the prefix of the part from the key
+        auto key = iter->key().subpiece(sizeof(PartitionID));
+        if (kvs.size() >= static_cast<size_t>(req.limit)) {
+            resp_.next_cursor = key.str();
+            break;
+        }
+        nebula::KeyValue kv;
+        kv.key = key.str();
+        kv.value = KVValueUtils::getValue(val).str();
+        kvs.emplace_back(std::move(kv));
+    }
+    resp_.key_values = std::move(kvs);
+    onFinished();
+}
+
+}  // namespace storage
+}  // namespace nebula
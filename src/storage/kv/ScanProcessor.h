@@ -0,0 +1,37 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_KV_SCANPROCESSOR_H_
+#define STORAGE_KV_SCANPROCESSOR_H_
+
+#include "common/base/Base.h"
+#include "storage/BaseProcessor.h"
+#include "storage/kv/KVRequests.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * Scan a page of the keys by range or prefix in a part, the expired keys are skipped.
+ * The cursor returned is the next key to scan, so the client could go on from it.
+ * */
+class ScanProcessor : public BaseProcessor<KVScanResponse> {
+public:
+    static ScanProcessor* instance(StorageEnv* env, stats::Stats* stats) {
+        return new ScanProcessor(env, stats);
+    }
+
+    void process(const KVScanRequest& req);
+
+private:
+    explicit ScanProcessor(StorageEnv* env, stats::Stats* stats)
+            : BaseProcessor<KVScanResponse>(env, stats) {}
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_KV_SCANPROCESSOR_H_
@@ -51,6 +51,7 @@ void AddEdgesProcessor::process(const cpp2::AddEdgesRequest& req) {
 
         std::vector<kvstore::KV> data;
         data.reserve(32);
+        std::vector<std::string> cacheKeys;
         for (auto& newEdge : newEdges) {
             auto edgeKey = newEdge.key;
             VLOG(3) << "PartitionID: " << partId << ", VertexID: " << edgeKey.src
@@ -67,7 +68,8 @@ void AddEdgesProcessor::process(const cpp2::AddEdgesRequest& req) {
                 return;
             }
 
-            auto key = NebulaKeyUtils::edgeKey(spaceVidLen_,
+            auto key = NebulaKeyUtils::edgeKey(spaceId_,
+                                                spaceVidLen_,
                                                 partId,
                                                 edgeKey.src,
                                                 edgeKey.edge_type,
@@ -94,17 +96,26 @@ void AddEdgesProcessor::process(const cpp2::AddEdgesRequest& req) {
             }
 
             data.emplace_back(std::move(key), std::move(retEnc.value()));
+            if (FLAGS_enable_adjacency_cache && adjacencyCache_ != nullptr) {
+                cacheKeys.emplace_back(AdjacencyCache::cacheKey(spaceId_, spaceVidLen_, partId,
+                                                                edgeKey.src, edgeKey.edge_type));
+            }
         }
+        // Evict the cached edge lists after the edges have been written
+        auto callback = [partId, cacheKeys = std::move(cacheKeys), this]
+                        (kvstore::ResultCode code) {
+            for (auto& cacheKey : cacheKeys) {
+                adjacencyCache_->evict(cacheKey);
+            }
+            handleAsync(spaceId_, partId, code);
+        };
         if (indexes_.empty()) {
-            doPut(spaceId_, partId, std::move(data));
+            this->env_->kvstore_->asyncMultiPut(spaceId_, partId, std::move(data), callback);
         } else {
              auto atomic = [partId, edges = std::move(data), this]()
                           -> folly::Optional<std::string> {
                 return addEdges(partId, edges);
             };
-            auto callback = [partId, this](kvstore::ResultCode code) {
-                handleAsync(spaceId_, partId, code);
-            };
             this->env_->kvstore_->asyncAtomicOp(spaceId_, partId, atomic, callback);
         }
     }
@@ -195,14 +206,16 @@ AddEdgesProcessor::addEdges(PartitionID partId,
 
 folly::Optional<std::string>
 AddEdgesProcessor::findObsoleteIndex(PartitionID partId, const folly::StringPiece& rawKey) {
-    auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_,
+    auto prefix = NebulaKeyUtils::edgePrefix(spaceId_,
+                                             spaceVidLen_,
                                              partId,
                                              NebulaKeyUtils::getSrcId(spaceVidLen_, rawKey).str(),
                                              NebulaKeyUtils::getEdgeType(spaceVidLen_, rawKey),
                                              NebulaKeyUtils::getRank(spaceVidLen_, rawKey),
                                              NebulaKeyUtils::getDstId(spaceVidLen_, rawKey).str());
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto ret = this->env_->kvstore_->prefix(this->spaceId_, partId, prefix, &iter);
+    auto ret = CommonUtils::edgePrefix(this->env_->kvstore_, this->spaceId_, partId,
+                                       prefix, &iter);
     if (ret != kvstore::ResultCode::SUCCEEDED) {
         LOG(ERROR) << "Error! ret = " << static_cast<int32_t>(ret)
                    << ", spaceId " << this->spaceId_;
@@ -10,6 +10,7 @@
 #include "common/base/Base.h"
 #include "storage/BaseProcessor.h"
 #include "storage/StorageFlags.h"
+#include "storage/cache/AdjacencyCache.h"
 #include "kvstore/LogEncoder.h"
 
 namespace nebula {
@@ -18,15 +19,17 @@ namespace storage {
 class AddEdgesProcessor : public BaseProcessor<cpp2::ExecResponse> {
 public:
     static AddEdgesProcessor* instance(StorageEnv* env,
-                                       stats::Stats* stats) {
-        return new AddEdgesProcessor(env, stats);
+                                       stats::Stats* stats,
+                                       AdjacencyCache* adjCache = nullptr) {
+        return new AddEdgesProcessor(env, stats, adjCache);
     }
 
     void process(const cpp2::AddEdgesRequest& req);
 
 private:
-    AddEdgesProcessor(StorageEnv* env, stats::Stats* stats)
-        : BaseProcessor<cpp2::ExecResponse>(env, stats) {}
+    AddEdgesProcessor(StorageEnv* env, stats::Stats* stats, AdjacencyCache* adjCache)
+        : BaseProcessor<cpp2::ExecResponse>(env, stats)
+        , adjacencyCache_(adjCache) {}
 
     folly::Optional<std::string> addEdges(PartitionID partId,
                                           const std::vector<kvstore::KV>& edges);
@@ -41,6 +44,7 @@ private:
 
 private:
     GraphSpaceID                                                spaceId_;
+    AdjacencyCache*                                             adjacencyCache_{nullptr};
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
 };
 
@@ -53,6 +53,7 @@ void AddVerticesProcessor::process(const cpp2::AddVerticesRequest& req) {
 
         std::vector<kvstore::KV> data;
         data.reserve(32);
+        std::vector<std::pair<VertexCache::Key, std::string>> cacheRows;
         for (auto& vertex : vertices) {
             auto vid = vertex.get_id();
             const auto& newTags = vertex.get_tags();
@@ -94,25 +95,32 @@ void AddVerticesProcessor::process(const cpp2::AddVerticesRequest& req) {
                     onFinished();
                     return;
                 }
-                data.emplace_back(std::move(key), std::move(retEnc.value()));
-
                 if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
-                    vertexCache_->evict(std::make_pair(vid, tagId), partId);
-                    VLOG(3) << "Evict cache for vId " << vid
-                            << ", tagId " << tagId;
+                    cacheRows.emplace_back(VertexCache::Key(spaceId_, partId, vid, tagId),
+                                           retEnc.value());
                 }
+                data.emplace_back(std::move(key), std::move(retEnc.value()));
             }
         }
+        // Write through the cache once the vertices are committed
+        auto callback = [partId, rows = std::move(cacheRows), this]
+                        (kvstore::ResultCode code) mutable {
+            for (auto& row : rows) {
+                if (code == kvstore::ResultCode::SUCCEEDED) {
+                    vertexCache_->put(row.first, std::move(row.second));
+                } else {
+                    vertexCache_->evict(row.first);
+                }
+            }
+            handleAsync(spaceId_, partId, code);
+        };
         if (indexes_.empty()) {
-            doPut(spaceId_, partId, std::move(data));
+            this->env_->kvstore_->asyncMultiPut(spaceId_, partId, std::move(data), callback);
         } else {
             auto atomic = [partId, vertices = std::move(data), this]()
                           -> folly::Optional<std::string> {
                 return addVertices(partId, vertices);
             };
-            auto callback = [partId, this](kvstore::ResultCode code) {
-                handleAsync(spaceId_, partId, code);
-            };
             this->env_->kvstore_->asyncAtomicOp(spaceId_, partId, atomic, callback);
         }
     }
@@ -8,7 +8,6 @@
 #define STORAGE_MUTATE_ADDVERTICESPROCESSOR_H_
 
 #include "common/base/Base.h"
-#include "common/base/ConcurrentLRUCache.h"
 #include "storage/BaseProcessor.h"
 #include "storage/CommonUtils.h"
 #include "kvstore/LogEncoder.h"
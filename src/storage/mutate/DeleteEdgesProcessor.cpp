@@ -8,6 +8,7 @@
 #include <algorithm>
 #include "utils/NebulaKeyUtils.h"
 #include "utils/IndexKeyUtils.h"
+#include "storage/StorageFlags.h"
 
 namespace nebula {
 namespace storage {
@@ -66,38 +67,82 @@ void DeleteEdgesProcessor::process(const cpp2::DeleteEdgesRequest& req) {
                                                    edgeKey.ranking,
                                                    edgeKey.dst,
                                                    std::numeric_limits<int64_t>::max());
-                std::unique_ptr<kvstore::KVIterator> iter;
-                auto retRes = env_->kvstore_->range(spaceId_, partId, start, end, &iter);
-                if (retRes != kvstore::ResultCode::SUCCEEDED) {
-                    VLOG(3) << "Error! ret = " << static_cast<int32_t>(retRes)
-                            << ", spaceID " << spaceId_;
-                    this->handleErrorCode(retRes, spaceId_, partId);
-                    this->onFinished();
-                    return;
-                }
-                while (iter && iter->valid()) {
-                    auto key = iter->key();
-                    keys.emplace_back(key.data(), key.size());
-                    iter->next();
+                // Until the edge keys of the part are converted, the edge may be of both
+                // key types. An edge could be moved to the other type before the removal
+                // is committed, so the keys of both types are removed.
+                auto keyTypes = NebulaKeyUtils::edgeKeyTypes(spaceId_, partId);
+                for (auto keyType : keyTypes) {
+                    auto typedStart = NebulaKeyUtils::toEdgeKeyType(start, keyType);
+                    auto typedEnd = NebulaKeyUtils::toEdgeKeyType(end, keyType);
+                    std::unique_ptr<kvstore::KVIterator> iter;
+                    auto retRes = env_->kvstore_->range(spaceId_, partId,
+                                                        typedStart, typedEnd, &iter);
+                    if (retRes != kvstore::ResultCode::SUCCEEDED) {
+                        VLOG(3) << "Error! ret = " << static_cast<int32_t>(retRes)
+                                << ", spaceID " << spaceId_;
+                        this->handleErrorCode(retRes, spaceId_, partId);
+                        this->onFinished();
+                        return;
+                    }
+                    while (iter && iter->valid()) {
+                        auto key = iter->key();
+                        if (keyTypes.size() > 1) {
+                            for (auto otherType : keyTypes) {
+                                keys.emplace_back(NebulaKeyUtils::toEdgeKeyType(key, otherType));
+                            }
+                        } else {
+                            keys.emplace_back(key.data(), key.size());
+                        }
+                        iter->next();
+                    }
                 }
             }
-            doRemove(spaceId_, partId, keys);
+            auto callback = [partId, cacheKeys = adjacencyKeys(partId, part.second), this]
+                            (kvstore::ResultCode code) {
+                handleRemove(partId, cacheKeys, code);
+            };
+            env_->kvstore_->asyncMultiRemove(spaceId_, partId, keys, std::move(callback));
         }
     } else {
         std::for_each(partEdges.begin(), partEdges.end(), [this](auto &part) {
             auto partId = part.first;
+            auto callback = [partId, cacheKeys = adjacencyKeys(partId, part.second), this]
+                            (kvstore::ResultCode code) {
+                handleRemove(partId, cacheKeys, code);
+            };
             auto atomic = [partId, edges = std::move(part.second), this]()
                           -> folly::Optional<std::string> {
                 return deleteEdges(partId, edges);
             };
-            auto callback = [partId, this](kvstore::ResultCode code) {
-                handleAsync(spaceId_, partId, code);
-            };
             this->env_->kvstore_->asyncAtomicOp(spaceId_, partId, atomic, callback);
         });
     }
 }
 
+std::vector<std::string>
+DeleteEdgesProcessor::adjacencyKeys(PartitionID partId,
+                                    const std::vector<cpp2::EdgeKey>& edges) {
+    std::vector<std::string> cacheKeys;
+    if (!FLAGS_enable_adjacency_cache || adjacencyCache_ == nullptr) {
+        return cacheKeys;
+    }
+    for (auto& edge : edges) {
+        cacheKeys.emplace_back(AdjacencyCache::cacheKey(spaceId_, spaceVidLen_, partId,
+                                                        edge.src, edge.edge_type));
+    }
+    return cacheKeys;
+}
+
+void DeleteEdgesProcessor::handleRemove(PartitionID partId,
+                                        const std::vector<std::string>& cacheKeys,
+                                        kvstore::ResultCode code) {
+    // Evict after the edges have been removed, see AdjacencyCache
+    for (auto& cacheKey : cacheKeys) {
+        adjacencyCache_->evict(cacheKey);
+    }
+    handleAsync(spaceId_, partId, code);
+}
+
 
 folly::Optional<std::string>
 DeleteEdgesProcessor::deleteEdges(PartitionID partId,
@@ -108,9 +153,10 @@ DeleteEdgesProcessor::deleteEdges(PartitionID partId,
         auto srcId = edge.src;
         auto rank = edge.ranking;
         auto dstId = edge.dst;
-        auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, srcId, type, rank, dstId);
+        auto prefix = NebulaKeyUtils::edgePrefix(spaceId_, spaceVidLen_, partId,
+                                                 srcId, type, rank, dstId);
         std::unique_ptr<kvstore::KVIterator> iter;
-        auto ret = this->env_->kvstore_->prefix(spaceId_, partId, prefix, &iter);
+        auto ret = CommonUtils::edgePrefix(this->env_->kvstore_, spaceId_, partId, prefix, &iter);
         if (ret != kvstore::ResultCode::SUCCEEDED) {
             VLOG(3) << "Error! ret = " << static_cast<int32_t>(ret)
                     << ", spaceId " << spaceId_;
@@ -10,6 +10,7 @@
 #include "common/base/Base.h"
 #include "storage/BaseProcessor.h"
 #include "kvstore/LogEncoder.h"
+#include "storage/cache/AdjacencyCache.h"
 
 namespace nebula {
 namespace storage {
@@ -17,20 +18,31 @@ namespace storage {
 class DeleteEdgesProcessor : public BaseProcessor<cpp2::ExecResponse> {
 public:
     static DeleteEdgesProcessor* instance(StorageEnv* env,
-                                          stats::Stats* stats) {
-        return new DeleteEdgesProcessor(env, stats);
+                                          stats::Stats* stats,
+                                          AdjacencyCache* adjCache = nullptr) {
+        return new DeleteEdgesProcessor(env, stats, adjCache);
     }
 
     void process(const cpp2::DeleteEdgesRequest& req);
 
 private:
-    explicit DeleteEdgesProcessor(StorageEnv* env, stats::Stats* stats)
-            : BaseProcessor<cpp2::ExecResponse>(env, stats) {}
+    DeleteEdgesProcessor(StorageEnv* env, stats::Stats* stats, AdjacencyCache* adjCache)
+            : BaseProcessor<cpp2::ExecResponse>(env, stats)
+            , adjacencyCache_(adjCache) {}
+
+    // Keys of the cached edge lists which should be evicted after deleting the edges
+    std::vector<std::string> adjacencyKeys(PartitionID partId,
+                                           const std::vector<cpp2::EdgeKey>& edges);
+
+    void handleRemove(PartitionID partId,
+                      const std::vector<std::string>& cacheKeys,
+                      kvstore::ResultCode code);
 
     folly::Optional<std::string> deleteEdges(PartitionID partId,
                                              const std::vector<cpp2::EdgeKey>& edges);
 private:
     GraphSpaceID                                                spaceId_;
+    AdjacencyCache*                                             adjacencyCache_{nullptr};
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
 };
 
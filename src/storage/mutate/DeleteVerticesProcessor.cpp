@@ -44,6 +44,7 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
             auto partId = part.first;
             const auto& vertexIds = part.second;
             keys.clear();
+            std::vector<VertexCache::Key> cacheKeys;
 
             for (auto& vid : vertexIds) {
                 if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid)) {
@@ -68,20 +69,30 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
                     auto key = iter->key();
                     if (NebulaKeyUtils::isVertex(spaceVidLen_, key)) {
                         auto tagId = NebulaKeyUtils::getTagId(spaceVidLen_, key);
-                        // Evict vertices from cache
                         if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
-                            VLOG(3) << "Evict vertex cache for VID " << vid
-                                    << ", TagID " << tagId;
-                            vertexCache_->evict(std::make_pair(vid, tagId), partId);
+                            cacheKeys.emplace_back(spaceId_, partId, vid, tagId);
                         }
                         keys.emplace_back(key.str());
                     }
                     iter->next();
                 }
             }
-            doRemove(spaceId_, partId, keys);
+            // Evict vertices from cache after they have been removed
+            auto callback = [partId, cacheKeys = std::move(cacheKeys), this]
+                            (kvstore::ResultCode code) {
+                for (auto& cacheKey : cacheKeys) {
+                    vertexCache_->evict(cacheKey);
+                }
+                handleAsync(spaceId_, partId, code);
+            };
+            env_->kvstore_->asyncMultiRemove(spaceId_, partId, keys, std::move(callback));
         }
     } else {
+        // Create all entries first, so that each part only touches its own one
+        for (auto& pv : req.parts) {
+            cacheKeys_[pv.first];
+            adjacencyKeys_[pv.first];
+        }
         std::for_each(req.parts.begin(), req.parts.end(), [this](auto &pv) {
             auto partId = pv.first;
             auto atomic = [partId, v = std::move(pv.second),
@@ -91,6 +102,13 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
 
             auto callback = [partId, this](kvstore::ResultCode code) {
                 VLOG(3) << "partId:" << partId << ", code:" << static_cast<int32_t>(code);
+                // The keys are collected by the atomic op of the part
+                for (auto& cacheKey : cacheKeys_.at(partId)) {
+                    vertexCache_->evict(cacheKey);
+                }
+                for (auto& cacheKey : adjacencyKeys_.at(partId)) {
+                    adjacencyCache_->evict(cacheKey);
+                }
                 handleAsync(spaceId_, partId, code);
             };
             this->env_->kvstore_->asyncAtomicOp(spaceId_, partId, atomic, callback);
@@ -115,11 +133,29 @@ DeleteVerticesProcessor::deleteVertices(PartitionID partId,
         TagID latestVVId = -1;
         while (iter->valid()) {
             auto key = iter->key();
+            if (NebulaKeyUtils::isEdge(spaceVidLen_, key)) {
+                if (FLAGS_enable_adjacency_cache && adjacencyCache_ != nullptr) {
+                    auto edgeType = NebulaKeyUtils::getEdgeType(spaceVidLen_, key);
+                    auto& adjacencyKeys = adjacencyKeys_.at(partId);
+                    auto cacheKey = AdjacencyCache::cacheKey(spaceId_, spaceVidLen_, partId,
+                                                             vertex, edgeType);
+                    if (adjacencyKeys.empty() || adjacencyKeys.back() != cacheKey) {
+                        // evict now, and again after the removal is committed
+                        adjacencyCache_->evict(cacheKey);
+                        adjacencyKeys.emplace_back(std::move(cacheKey));
+                    }
+                }
+                batchHolder->remove(key.str());
+                iter->next();
+                continue;
+            }
             auto tagId = NebulaKeyUtils::getTagId(spaceVidLen_, key);
             if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
                 if (NebulaKeyUtils::isVertex(spaceVidLen_, key)) {
                     VLOG(3) << "Evict vertex cache for vertex ID " << vertex << ", tagId " << tagId;
-                    vertexCache_->evict(std::make_pair(vertex, tagId), partId);
+                    // evict now, and again after the removal is committed
+                    vertexCache_->evict(VertexCache::Key(spaceId_, partId, vertex, tagId));
+                    cacheKeys_.at(partId).emplace_back(spaceId_, partId, vertex, tagId);
                 }
             }
 
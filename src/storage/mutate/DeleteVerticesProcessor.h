@@ -11,6 +11,7 @@
 #include "kvstore/LogEncoder.h"
 #include "storage/BaseProcessor.h"
 #include "storage/CommonUtils.h"
+#include "storage/cache/AdjacencyCache.h"
 
 namespace nebula {
 namespace storage {
@@ -19,16 +20,21 @@ class DeleteVerticesProcessor : public BaseProcessor<cpp2::ExecResponse> {
 public:
     static DeleteVerticesProcessor* instance(StorageEnv* env,
                                              stats::Stats* stats,
-                                             VertexCache* cache = nullptr) {
-        return new DeleteVerticesProcessor(env, stats, cache);
+                                             VertexCache* cache = nullptr,
+                                             AdjacencyCache* adjCache = nullptr) {
+        return new DeleteVerticesProcessor(env, stats, cache, adjCache);
     }
 
     void process(const cpp2::DeleteVerticesRequest& req);
 
 private:
-    DeleteVerticesProcessor(StorageEnv* env, stats::Stats* stats, VertexCache* cache)
+    DeleteVerticesProcessor(StorageEnv* env,
+                            stats::Stats* stats,
+                            VertexCache* cache,
+                            AdjacencyCache* adjCache)
         : BaseProcessor<cpp2::ExecResponse>(env, stats)
-        , vertexCache_(cache) {}
+        , vertexCache_(cache)
+        , adjacencyCache_(adjCache) {}
 
     folly::Optional<std::string>
     deleteVertices(PartitionID partId,
@@ -37,6 +43,11 @@ private:
 private:
     GraphSpaceID                                                spaceId_;
     VertexCache*                                                vertexCache_{nullptr};
+    // The cache keys to evict when the removal of each part is committed
+    std::unordered_map<PartitionID, std::vector<VertexCache::Key>> cacheKeys_;
+    AdjacencyCache*                                             adjacencyCache_{nullptr};
+    // The adjacency lists to evict, the edges are removed with the vertices if there is index
+    std::unordered_map<PartitionID, std::vector<std::string>>   adjacencyKeys_;
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
 };
 
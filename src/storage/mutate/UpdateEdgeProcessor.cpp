@@ -63,6 +63,11 @@ void UpdateEdgeProcessor::process(const cpp2::UpdateEdgeRequest& req) {
     auto plan = buildPlan(&resultDataSet_);
 
     auto ret = plan.go(partId, edgeKey_);
+    // The edge has been written back when the plan finished, evict the cached edge list
+    if (FLAGS_enable_adjacency_cache && edgeContext_.adjacencyCache_ != nullptr) {
+        edgeContext_.adjacencyCache_->evict(AdjacencyCache::cacheKey(
+            spaceId_, spaceVidLen_, partId, edgeKey_.src, edgeKey_.edge_type));
+    }
     if (ret != kvstore::ResultCode::SUCCEEDED) {
         handleErrorCode(ret, spaceId_, partId);
         if (ret == kvstore::ResultCode::ERR_RESULT_FILTERED) {
@@ -20,16 +20,19 @@ class UpdateEdgeProcessor
     : public QueryBaseProcessor<cpp2::UpdateEdgeRequest, cpp2::UpdateResponse> {
 public:
     static UpdateEdgeProcessor* instance(StorageEnv* env,
-                                         stats::Stats* stats) {
-        return new UpdateEdgeProcessor(env, stats);
+                                         stats::Stats* stats,
+                                         AdjacencyCache* adjCache = nullptr) {
+        return new UpdateEdgeProcessor(env, stats, adjCache);
     }
 
     void process(const cpp2::UpdateEdgeRequest& req) override;
 
 private:
-    UpdateEdgeProcessor(StorageEnv* env, stats::Stats* stats)
+    UpdateEdgeProcessor(StorageEnv* env, stats::Stats* stats, AdjacencyCache* adjCache)
         : QueryBaseProcessor<cpp2::UpdateEdgeRequest,
-                             cpp2::UpdateResponse>(env, stats) {}
+                             cpp2::UpdateResponse>(env, stats) {
+        edgeContext_.adjacencyCache_ = adjCache;
+    }
 
     cpp2::ErrorCode checkAndBuildContexts(const cpp2::UpdateEdgeRequest& req) override;
 
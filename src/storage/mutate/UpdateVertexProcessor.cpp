@@ -129,6 +129,7 @@ StoragePlan<VertexID> UpdateVertexProcessor::buildPlan(nebula::DataSet* result)
                                                       updatedProps_,
                                                       filterNode.get(),
                                                       insertable_,
+                                                      vertexCache_,
                                                       expCtx_.get());
     updateNode->addDependency(filterNode.get());
 
@@ -162,8 +163,6 @@ cpp2::ErrorCode UpdateVertexProcessor::buildTagSchema() {
 cpp2::ErrorCode
 UpdateVertexProcessor::buildTagContext(const cpp2::UpdateVertexRequest& req) {
     // Build context of the update vertex tag props
-    auto partId = req.get_part_id();
-    auto vId = req.get_vertex_id();
     auto tagNameRet = env_->schemaMan_->toTagName(spaceId_, tagId_);
     if (!tagNameRet.ok()) {
         VLOG(1) << "Can't find spaceId " << spaceId_ << " tagId " << tagId_;
@@ -171,12 +170,6 @@ UpdateVertexProcessor::buildTagContext(const cpp2::UpdateVertexRequest& req) {
     }
     auto tagName = tagNameRet.value();
 
-    // update, evict the old elements
-    if (FLAGS_enable_vertex_cache && tagContext_.vertexCache_ != nullptr) {
-        VLOG(1) << "Evict cache for vId " << vId << ", tagId " << tagId_;
-        tagContext_.vertexCache_->evict(std::make_pair(vId, tagId_), partId);
-    }
-
     for (auto& prop : updatedProps_) {
         SourcePropertyExpression sourcePropExp(new std::string(tagName),
                                                new std::string(prop.get_name()));
@@ -27,9 +27,12 @@ public:
     void process(const cpp2::UpdateVertexRequest& req) override;
 
 private:
+    // The cache is not passed to the TagNode in the plan, the row is read from
+    // kvstore and written through the cache after committed
     UpdateVertexProcessor(StorageEnv* env, stats::Stats* stats, VertexCache* cache)
         : QueryBaseProcessor<cpp2::UpdateVertexRequest,
-                             cpp2::UpdateResponse>(env, stats, cache) {}
+                             cpp2::UpdateResponse>(env, stats)
+        , vertexCache_(cache) {}
 
     cpp2::ErrorCode checkAndBuildContexts(const cpp2::UpdateVertexRequest& req) override;
 
@@ -53,6 +56,8 @@ private:
     }
 
 private:
+    VertexCache                                                    *vertexCache_{nullptr};
+
     bool                                                            insertable_{false};
 
     // update tagId
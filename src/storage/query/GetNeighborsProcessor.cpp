@@ -5,6 +5,7 @@
  */
 
 #include "storage/query/GetNeighborsProcessor.h"
+#include <folly/Random.h>
 #include "storage/StorageFlags.h"
 #include "storage/exec/TagNode.h"
 #include "storage/exec/EdgeNode.h"
@@ -27,6 +28,7 @@ void GetNeighborsProcessor::process(const cpp2::GetNeighborsRequest& req) {
         return;
     }
     planContext_ = std::make_unique<PlanContext>(env_, spaceId_, spaceVidLen_);
+    startProfile("get_neighbors");
     expCtx_ = std::make_unique<StorageExpressionContext>(spaceVidLen_);
 
     retCode = checkAndBuildContexts(req);
@@ -48,6 +50,7 @@ void GetNeighborsProcessor::process(const cpp2::GetNeighborsRequest& req) {
     }
 
     auto plan = buildPlan(&resultDataSet_, limit, random);
+    plan.setProfile(profile_.get());
     std::unordered_set<PartitionID> failedParts;
     for (const auto& partEntry : req.get_parts()) {
         auto partId = partEntry.first;
@@ -65,7 +68,9 @@ void GetNeighborsProcessor::process(const cpp2::GetNeighborsRequest& req) {
             }
         }
     }
+    plan.collectProfile();
     onProcessFinished();
+    finishProfile();
     onFinished();
 }
 
@@ -104,7 +109,8 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(nebula::DataSet* result,
     std::vector<EdgeNode<VertexID>*> edges;
     for (const auto& ec : edgeContext_.propContexts_) {
         auto edge = std::make_unique<SingleEdgeNode>(
-                planContext_.get(), &edgeContext_, ec.first, &ec.second);
+                planContext_.get(), &edgeContext_, ec.first, &ec.second, nullptr, nullptr,
+                isKeyOnly(ec.second, random));
         edges.emplace_back(edge.get());
         plan.addNode(std::move(edge));
     }
@@ -125,8 +131,11 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(nebula::DataSet* result,
     agg->addDependency(filter.get());
     std::unique_ptr<GetNeighborsNode> output;
     if (random) {
+        uint64_t seed = FLAGS_random_sample_seed != 0 ? FLAGS_random_sample_seed
+                                                       : folly::Random::rand64();
         output = std::make_unique<GetNeighborsSampleNode>(
-                planContext_.get(), hashJoin.get(), agg.get(), &edgeContext_, result, limit);
+                planContext_.get(), hashJoin.get(), agg.get(), &edgeContext_, result, limit,
+                seed, FLAGS_random_sample_weight_prop);
     } else {
         output = std::make_unique<GetNeighborsNode>(
                 planContext_.get(), hashJoin.get(), agg.get(), &edgeContext_, result, limit);
@@ -140,6 +149,31 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(nebula::DataSet* result,
     return plan;
 }
 
+bool GetNeighborsProcessor::isKeyOnly(const std::vector<PropContext>& props,
+                                      bool random) const {
+    if (filter_ != nullptr) {
+        return false;
+    }
+    if (random && !FLAGS_random_sample_weight_prop.empty()) {
+        // the weight of an edge is read from its value
+        return false;
+    }
+    for (const auto& prop : props) {
+        if (prop.propInKeyType_ != PropContext::PropInKeyType::NONE) {
+            continue;
+        }
+        if (prop.returned_ || prop.filtered_) {
+            return false;
+        }
+        for (const auto& statType : prop.statType_) {
+            if (statType != cpp2::StatType::COUNT) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 cpp2::ErrorCode GetNeighborsProcessor::checkAndBuildContexts(const cpp2::GetNeighborsRequest& req) {
     resultDataSet_.colNames.emplace_back(kVid);
     // reserve second colname for stat
@@ -22,8 +22,9 @@ class GetNeighborsProcessor
 public:
     static GetNeighborsProcessor* instance(StorageEnv* env,
                                            stats::Stats* stats,
-                                           VertexCache* cache) {
-        return new GetNeighborsProcessor(env, stats, cache);
+                                           VertexCache* cache,
+                                           AdjacencyCache* adjCache = nullptr) {
+        return new GetNeighborsProcessor(env, stats, cache, adjCache);
     }
 
     void process(const cpp2::GetNeighborsRequest& req) override;
@@ -31,14 +32,21 @@ public:
 protected:
     GetNeighborsProcessor(StorageEnv* env,
                           stats::Stats* stats,
-                          VertexCache* cache)
+                          VertexCache* cache,
+                          AdjacencyCache* adjCache)
         : QueryBaseProcessor<cpp2::GetNeighborsRequest,
-                             cpp2::GetNeighborsResponse>(env, stats, cache) {}
+                             cpp2::GetNeighborsResponse>(env, stats, cache) {
+        edgeContext_.adjacencyCache_ = adjCache;
+    }
 
     StoragePlan<VertexID> buildPlan(nebula::DataSet* result,
                                     int64_t limit = 0,
                                     bool random = false);
 
+    // Whether the edges of a type could be scanned without decoding the values, i.e. only
+    // the props in key and COUNT are needed, and there is no filter
+    bool isKeyOnly(const std::vector<PropContext>& props, bool random) const;
+
     void onProcessFinished() override;
 
     cpp2::ErrorCode checkAndBuildContexts(const cpp2::GetNeighborsRequest& req) override;
@@ -21,6 +21,7 @@ void GetPropProcessor::process(const cpp2::GetPropRequest& req) {
         return;
     }
     planContext_ = std::make_unique<PlanContext>(env_, spaceId_, spaceVidLen_);
+    startProfile("get_prop");
 
     retCode = checkAndBuildContexts(req);
     if (retCode != cpp2::ErrorCode::SUCCEEDED) {
@@ -34,6 +35,7 @@ void GetPropProcessor::process(const cpp2::GetPropRequest& req) {
     std::unordered_set<PartitionID> failedParts;
     if (!isEdge_) {
         auto plan = buildTagPlan(&resultDataSet_);
+        plan.setProfile(profile_.get());
         for (const auto& partEntry : req.get_parts()) {
             auto partId = partEntry.first;
             for (const auto& row : partEntry.second) {
@@ -46,8 +48,10 @@ void GetPropProcessor::process(const cpp2::GetPropRequest& req) {
                 }
             }
         }
+        plan.collectProfile();
     } else {
         auto plan = buildEdgePlan(&resultDataSet_);
+        plan.setProfile(profile_.get());
         for (const auto& partEntry : req.get_parts()) {
             auto partId = partEntry.first;
             for (const auto& row : partEntry.second) {
@@ -64,8 +68,10 @@ void GetPropProcessor::process(const cpp2::GetPropRequest& req) {
                 }
             }
         }
+        plan.collectProfile();
     }
     onProcessFinished();
+    finishProfile();
     onFinished();
 }
 
@@ -20,6 +20,8 @@
 #include "common/expression/UUIDExpression.h"
 #include "common/expression/UnaryExpression.h"
 #include "storage/BaseProcessor.h"
+#include "storage/cache/AdjacencyCache.h"
+#include "storage/context/QueryProfile.h"
 
 namespace nebula {
 namespace storage {
@@ -120,6 +122,7 @@ struct EdgeContext {
     // offset is the start index of first edge type in a response row
     size_t                                                              offset_;
     size_t                                                              statCount_ = 0;
+    AdjacencyCache                                                     *adjacencyCache_ = nullptr;
 };
 
 template<typename REQ, typename RESP>
@@ -129,6 +132,11 @@ public:
 
     virtual void process(const REQ& req) = 0;
 
+    // Profile the request even if it is not sampled
+    void enableProfile() {
+        profileEnabled_ = true;
+    }
+
 protected:
     explicit QueryBaseProcessor(StorageEnv* env,
                                 stats::Stats* stats = nullptr,
@@ -160,6 +168,12 @@ protected:
 
     cpp2::ErrorCode checkExp(const Expression* exp, bool returned, bool filtered);
 
+    // Start to profile the request if it is sampled or enabled, after planContext_ is built
+    void startProfile(const std::string& method);
+
+    // Stop the profile and report it, if any
+    void finishProfile();
+
     void addReturnPropContext(std::vector<PropContext>& ctxs,
                               const char* propName,
                               const meta::SchemaProviderIf::Field* field);
@@ -184,6 +198,9 @@ protected:
     std::unique_ptr<Expression>                         filter_;
 
     nebula::DataSet                                     resultDataSet_;
+
+    bool                                                profileEnabled_{false};
+    std::unique_ptr<QueryProfile>                       profile_;
 };
 
 }  // namespace storage
@@ -264,6 +264,25 @@ cpp2::ErrorCode QueryBaseProcessor<REQ, RESP>::getSpaceEdgeSchema() {
     return cpp2::ErrorCode::SUCCEEDED;
 }
 
+template <typename REQ, typename RESP>
+void QueryBaseProcessor<REQ, RESP>::startProfile(const std::string& method) {
+    if (!profileEnabled_ && !QueryProfile::sampled()) {
+        return;
+    }
+    profile_ = std::make_unique<QueryProfile>(method);
+    this->planContext_->profile_ = profile_.get();
+    profile_->start();
+}
+
+template <typename REQ, typename RESP>
+void QueryBaseProcessor<REQ, RESP>::finishProfile() {
+    if (profile_ == nullptr) {
+        return;
+    }
+    profile_->stop();
+    profile_->report();
+}
+
 template <typename REQ, typename RESP>
 cpp2::ErrorCode QueryBaseProcessor<REQ, RESP>::checkExp(const Expression* exp,
                                                         bool returned,
@@ -0,0 +1,88 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_QUERY_SCANBASEPROCESSOR_H_
+#define STORAGE_QUERY_SCANBASEPROCESSOR_H_
+
+#include "common/base/Base.h"
+#include "storage/query/QueryBaseProcessor.h"
+#include "storage/query/ScanRequests.h"
+#include "storage/query/ScanSnapshots.h"
+#include "storage/exec/ScanNode.h"
+#include "storage/exec/StoragePlan.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * The common part of the vertex and edge scans. Each part is scanned by its own plan from
+ * the key in its cursor, until the limit of rows or its share of the bytes of the page is
+ * reached. When an executor is given, the parts are scanned in parallel on it.
+ *
+ * The cursor of a part is:
+ *
+ * | snapshot id (int64_t) | key of the next row |
+ *
+ * The snapshot id is 0 if the scan is not pinned. If the snapshot has expired, or the leader
+ * has moved to another host, the scan goes on from the key in a new snapshot.
+ * */
+template<typename REQ>
+class ScanBaseProcessor : public QueryBaseProcessor<REQ, ScanResponse> {
+protected:
+    ScanBaseProcessor(StorageEnv* env,
+                      stats::Stats* stats,
+                      folly::Executor* executor)
+        : QueryBaseProcessor<REQ, ScanResponse>(env, stats)
+        , executor_(executor) {}
+
+    struct PartScan {
+        PartitionID                         partId;
+        ScanInput                           input;
+        int64_t                             snapshotId{0};
+        std::shared_ptr<PinnedSnapshot>     snapshot;
+        nebula::DataSet                     data;
+        std::string                         nextKey;
+        kvstore::ResultCode                 code{kvstore::ResultCode::SUCCEEDED};
+    };
+
+    // Scan the parts of the request, and finish the processor
+    void scanParts(const REQ& req);
+
+    // Build the plan of the part and run it, the rows and the next key are put into the scan
+    virtual kvstore::ResultCode scanPart(PartScan* scan) = 0;
+
+    // Decode the filter for the contexts
+    cpp2::ErrorCode buildScanFilter(const std::string& filter);
+
+    void onProcessFinished() override;
+
+    static std::string encodeCursor(int64_t snapshotId, folly::StringPiece key);
+
+    static bool decodeCursor(PartitionID partId,
+                             folly::StringPiece cursor,
+                             int64_t* snapshotId,
+                             std::string* key);
+
+private:
+    kvstore::ResultCode pinSnapshot(PartScan* scan);
+
+protected:
+    folly::Executor                    *executor_{nullptr};
+    std::vector<PartScan>               partScans_;
+    // The encoded filter, each part decodes its own one because an expression keeps the
+    // result of eval in it
+    std::string                         filterStr_;
+    int64_t                             limit_;
+    // The bytes each part could read in a page
+    int64_t                             maxBytes_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#include "storage/query/ScanBaseProcessor.inl"
+
+#endif  // STORAGE_QUERY_SCANBASEPROCESSOR_H_
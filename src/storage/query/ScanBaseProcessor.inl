@@ -0,0 +1,174 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+DECLARE_int32(max_scan_block_size);
+
+namespace nebula {
+namespace storage {
+
+template<typename REQ>
+void ScanBaseProcessor<REQ>::scanParts(const REQ& req) {
+    limit_ = req.limit > 0 ? req.limit : std::numeric_limits<int64_t>::max();
+    int64_t maxBytes = req.max_bytes > 0 ? req.max_bytes : FLAGS_max_scan_block_size;
+    // the parts share the bytes of a page
+    maxBytes_ = std::max<int64_t>(maxBytes / std::max<size_t>(req.parts.size(), 1), 1);
+
+    partScans_.reserve(req.parts.size());
+    for (const auto& part : req.parts) {
+        auto partId = part.first;
+        PartScan scan;
+        scan.partId = partId;
+        if (!part.second.empty() &&
+            !decodeCursor(partId, part.second, &scan.snapshotId, &scan.input.start)) {
+            VLOG(1) << "Invalid cursor of part " << partId;
+            this->pushResultCode(cpp2::ErrorCode::E_INVALID_OPERATION, partId);
+            continue;
+        }
+        if (req.pin_snapshot) {
+            auto code = pinSnapshot(&scan);
+            if (code != kvstore::ResultCode::SUCCEEDED) {
+                this->handleErrorCode(code, this->spaceId_, partId);
+                continue;
+            }
+        } else if (scan.snapshotId != 0) {
+            ScanSnapshots::instance()->release(scan.snapshotId);
+            scan.snapshotId = 0;
+        }
+        partScans_.emplace_back(std::move(scan));
+    }
+
+    if (executor_ == nullptr || partScans_.size() <= 1) {
+        for (auto& scan : partScans_) {
+            scan.code = scanPart(&scan);
+        }
+        onProcessFinished();
+        this->onFinished();
+        return;
+    }
+
+    std::vector<folly::Future<folly::Unit>> futures;
+    futures.reserve(partScans_.size());
+    for (auto& scan : partScans_) {
+        auto* s = &scan;
+        futures.emplace_back(folly::via(executor_, [this, s] {
+            s->code = scanPart(s);
+        }));
+    }
+    folly::collectAll(futures).via(executor_).thenValue(
+        [this] (std::vector<folly::Try<folly::Unit>>&& tries) {
+            for (size_t i = 0; i < tries.size(); i++) {
+                if (tries[i].hasException()) {
+                    LOG(ERROR) << "Scan part " << partScans_[i].partId << " failed: "
+                               << tries[i].exception().what();
+                    partScans_[i].code = kvstore::ResultCode::ERR_UNKNOWN;
+                }
+            }
+            onProcessFinished();
+            this->onFinished();
+        });
+}
+
+template<typename REQ>
+kvstore::ResultCode ScanBaseProcessor<REQ>::pinSnapshot(PartScan* scan) {
+    auto* store = this->env_->kvstore_;
+    auto ret = store->part(this->spaceId_, scan->partId);
+    if (!ok(ret)) {
+        return error(ret);
+    }
+    auto part = nebula::value(ret);
+    // The snapshot is read by the engine directly, so the leader is checked here
+    if (!part->isLeader()) {
+        return kvstore::ResultCode::ERR_LEADER_CHANGED;
+    }
+    auto* engine = part->engine();
+    auto* snapshots = ScanSnapshots::instance();
+    if (scan->snapshotId != 0) {
+        scan->snapshot = snapshots->get(scan->snapshotId, this->spaceId_, scan->partId, engine);
+        if (scan->snapshot == nullptr) {
+            LOG(INFO) << "Scan snapshot " << scan->snapshotId << " of part " << this->spaceId_
+                      << ":" << scan->partId << " is gone, go on in a new one";
+        }
+    }
+    if (scan->snapshot == nullptr) {
+        auto pinned = snapshots->pin(store, this->spaceId_, scan->partId, engine,
+                                     &scan->snapshotId);
+        if (!ok(pinned)) {
+            return error(pinned);
+        }
+        scan->snapshot = std::move(nebula::value(pinned));
+    }
+    scan->input.engine = engine;
+    scan->input.snapshot = scan->snapshot->snapshot();
+    return kvstore::ResultCode::SUCCEEDED;
+}
+
+template<typename REQ>
+cpp2::ErrorCode ScanBaseProcessor<REQ>::buildScanFilter(const std::string& filter) {
+    if (filter.empty()) {
+        return cpp2::ErrorCode::SUCCEEDED;
+    }
+    // the filter expression **must** return a bool
+    this->filter_ = Expression::decode(filter);
+    if (this->filter_ == nullptr) {
+        return cpp2::ErrorCode::E_INVALID_FILTER;
+    }
+    filterStr_ = filter;
+    return this->checkExp(this->filter_.get(), false, true);
+}
+
+template<typename REQ>
+void ScanBaseProcessor<REQ>::onProcessFinished() {
+    auto* snapshots = ScanSnapshots::instance();
+    for (auto& scan : partScans_) {
+        if (scan.code != kvstore::ResultCode::SUCCEEDED) {
+            this->handleErrorCode(scan.code, this->spaceId_, scan.partId);
+            continue;
+        }
+        auto& rows = this->resultDataSet_.rows;
+        rows.insert(rows.end(),
+                    std::make_move_iterator(scan.data.rows.begin()),
+                    std::make_move_iterator(scan.data.rows.end()));
+        if (!scan.nextKey.empty()) {
+            this->resp_.next_cursors.emplace(scan.partId,
+                                             encodeCursor(scan.snapshotId, scan.nextKey));
+        } else if (scan.snapshotId != 0) {
+            // the part is scanned to the end
+            snapshots->release(scan.snapshotId);
+        }
+    }
+    this->resp_.data = std::move(this->resultDataSet_);
+}
+
+// static
+template<typename REQ>
+std::string ScanBaseProcessor<REQ>::encodeCursor(int64_t snapshotId, folly::StringPiece key) {
+    std::string cursor;
+    cursor.reserve(sizeof(int64_t) + key.size());
+    cursor.append(reinterpret_cast<const char*>(&snapshotId), sizeof(int64_t))
+          .append(key.data(), key.size());
+    return cursor;
+}
+
+// static
+template<typename REQ>
+bool ScanBaseProcessor<REQ>::decodeCursor(PartitionID partId,
+                                          folly::StringPiece cursor,
+                                          int64_t* snapshotId,
+                                          std::string* key) {
+    if (cursor.size() < sizeof(int64_t) + sizeof(PartitionID)) {
+        return false;
+    }
+    memcpy(snapshotId, cursor.data(), sizeof(int64_t));
+    auto start = cursor.subpiece(sizeof(int64_t));
+    if (NebulaKeyUtils::getPart(start) != partId) {
+        return false;
+    }
+    *key = start.str();
+    return true;
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -1,169 +1,102 @@
-/* Copyright (c) 2019 vesoft inc. All rights reserved.
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
  *
  * This source code is licensed under Apache 2.0 License,
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
-#include "storage/query/ScanEdgeProcessor.h"
-#include "common/time/WallClock.h"
-#include "common/meta/NebulaSchemaProvider.h"
-#include "utils/NebulaKeyUtils.h"
-#include <algorithm>
-#include "kvstore/RocksEngine.h"
 
-DEFINE_int32(max_scan_block_size, 4 * 1024 * 1024, "Max size of a respsonse block");
+#include "storage/query/ScanEdgeProcessor.h"
+#include "storage/exec/FilterNode.h"
 
 namespace nebula {
 namespace storage {
 
-void ScanEdgeProcessor::process(const cpp2::ScanEdgeRequest& req) {
-    spaceId_ = req.get_space_id();
-    partId_ = req.get_part_id();
-    returnAllColumns_ = req.get_all_columns();
-
-    auto retCode = checkAndBuildContexts(req);
+void ScanEdgeProcessor::process(const ScanEdgeRequest& req) {
+    spaceId_ = req.space_id;
+    auto retCode = getSpaceVidLen(spaceId_);
+    if (retCode == cpp2::ErrorCode::SUCCEEDED) {
+        retCode = checkAndBuildContexts(req);
+    }
     if (retCode != cpp2::ErrorCode::SUCCEEDED) {
-        this->pushResultCode(retCode, partId_);
-        this->onFinished();
+        for (auto& p : req.parts) {
+            pushResultCode(retCode, p.first);
+        }
+        onFinished();
         return;
     }
+    scanParts(req);
+}
 
-    std::string start;
-    std::string prefix = NebulaKeyUtils::prefix(partId_);
-    if (req.get_cursor() == nullptr || req.get_cursor()->empty()) {
-        start = prefix;
-    } else {
-        start = *req.get_cursor();
+cpp2::ErrorCode ScanEdgeProcessor::checkAndBuildContexts(const ScanEdgeRequest& req) {
+    auto ret = getSpaceEdgeSchema();
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        return ret;
     }
-
-    std::unique_ptr<kvstore::KVIterator> iter;
-    auto kvRet = doRangeWithPrefix(spaceId_, partId_, start, prefix, &iter);
-    if (kvRet != kvstore::ResultCode::SUCCEEDED) {
-        pushResultCode(to(kvRet), partId_);
-        onFinished();
-        return;
+    // If no props specified, get all property of all out edges in space, each edge is
+    // scanned once by its out edge
+    auto returnProps = req.return_columns.empty()
+                     ? buildAllEdgeProps(cpp2::EdgeDirection::OUT_EDGE)
+                     : req.return_columns;
+    ret = handleEdgeProps(returnProps);
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        return ret;
     }
+    buildEdgeColName(returnProps);
+    ret = buildScanFilter(req.filter);
+    if (ret != cpp2::ErrorCode::SUCCEEDED) {
+        return ret;
+    }
+    buildEdgeTTLInfo();
+    return cpp2::ErrorCode::SUCCEEDED;
+}
 
-    std::vector<cpp2::ScanEdge> edgeData;
-    int32_t rowCount = 0;
-    int32_t rowLimit = req.get_limit();
-    int64_t startTime = req.get_start_time(), endTime = req.get_end_time();
-    int32_t blockSize = 0;
-
-    for (; iter->valid() && rowCount < rowLimit && blockSize < FLAGS_max_scan_block_size;
-         iter->next()) {
-        auto key = iter->key();
-        if (!NebulaKeyUtils::isEdge(key)) {
-            continue;
-        }
-
-        EdgeType edgeType = NebulaKeyUtils::getEdgeType(key);
-        if (edgeType < 0) {
-            continue;
-        }
-
-        // only return data within time range [start, end)
-        EdgeVersion version = folly::Endian::big(NebulaKeyUtils::getVersion(key));
-        int64_t ts = std::numeric_limits<int64_t>::max() - version;
-        if (ts < startTime || ts >= endTime) {
-            continue;
-        }
-
-        auto ctxIter = edgeContexts_.find(edgeType);
-        if (ctxIter == edgeContexts_.end()) {
-            continue;
-        }
-
-        auto srcId = NebulaKeyUtils::getSrcId(key);
-        auto dstId = NebulaKeyUtils::getDstId(key);
-        cpp2::ScanEdge data;
-        data.set_src(srcId);
-        data.set_type(edgeType);
-        data.set_dst(dstId);
-        auto value = iter->val();
-        if (returnAllColumns_) {
-            // return all columns
-            data.set_value(value.str());
-        } else if (!ctxIter->second.empty()) {
-            // only return specified columns
-            auto reader = RowReader::getEdgePropReader(schemaMan_, value, spaceId_, edgeType);
-            RowWriter writer;
-            PropsCollector collector(&writer);
-            auto& props = ctxIter->second;
-            collectProps(reader.get(), props, &collector);
-            data.set_value(writer.encode());
-        }
+kvstore::ResultCode ScanEdgeProcessor::scanPart(PartScan* scan) {
+    PlanContext planCtx(env_, spaceId_, spaceVidLen_);
+    StorageExpressionContext expCtx(spaceVidLen_, "", nullptr, true);
+    std::unique_ptr<Expression> filter;
+    if (!filterStr_.empty()) {
+        filter = Expression::decode(filterStr_);
+    }
 
-        edgeData.emplace_back(std::move(data));
-        rowCount++;
-        blockSize += key.size() + value.size();
+    StoragePlan<ScanInput> plan;
+    auto edges = std::make_unique<ScanEdgeNode>(&planCtx, &edgeContext_,
+                                                filter != nullptr ? &expCtx : nullptr);
+    IterateNode<ScanInput>* upstream = edges.get();
+    std::unique_ptr<FilterNode<ScanInput>> filterNode;
+    if (filter != nullptr) {
+        filterNode = std::make_unique<FilterNode<ScanInput>>(&planCtx, edges.get(),
+                                                             &expCtx, filter.get());
+        filterNode->addDependency(edges.get());
+        upstream = filterNode.get();
+    }
+    auto output = std::make_unique<ScanEdgePropNode>(edges.get(),
+                                                     upstream,
+                                                     &edgeContext_,
+                                                     spaceVidLen_,
+                                                     limit_,
+                                                     maxBytes_,
+                                                     &scan->data);
+    output->addDependency(upstream);
+    auto* out = output.get();
+    plan.addNode(std::move(edges));
+    if (filterNode != nullptr) {
+        plan.addNode(std::move(filterNode));
     }
+    plan.addNode(std::move(output));
 
-    resp_.set_edge_schema(std::move(edgeSchema_));
-    resp_.set_edge_data(std::move(edgeData));
-    if (iter->valid()) {
-        resp_.set_has_next(true);
-        resp_.set_next_cursor(iter->key().str());
-    } else {
-        resp_.set_has_next(false);
+    auto ret = plan.go(scan->partId, scan->input);
+    if (ret == kvstore::ResultCode::SUCCEEDED) {
+        scan->nextKey = out->nextKey();
     }
-    onFinished();
+    return ret;
 }
 
-cpp2::ErrorCode ScanEdgeProcessor::checkAndBuildContexts(const cpp2::ScanEdgeRequest& req) {
-    for (const auto& edgeIter : req.get_return_columns()) {
-        int32_t index = 0;
-        EdgeType edgeType = edgeIter.first;
-        std::vector<PropContext> propContexts;
-        auto schema = this->schemaMan_->getEdgeSchema(spaceId_, edgeType);
-        if (!schema) {
-            return cpp2::ErrorCode::E_EDGE_NOT_FOUND;
-        }
-
-        if (returnAllColumns_) {
-            // return all columns
-            edgeContexts_.emplace(edgeType, std::move(propContexts));
-            edgeSchema_.emplace(edgeType, schema->toSchema());
-            continue;
-        } else if (edgeIter.second.empty()) {
-            // return none columns
-            edgeContexts_.emplace(edgeType, std::move(propContexts));
-            continue;
+void ScanEdgeProcessor::buildEdgeColName(const std::vector<cpp2::EdgeProp>& edgeProps) {
+    for (const auto& edgeProp : edgeProps) {
+        const auto& edgeName = edgeContext_.edgeNames_[edgeProp.type];
+        for (const auto& prop : edgeProp.props) {
+            resultDataSet_.colNames.emplace_back(edgeName + ":" + prop);
         }
-
-        // return specified columns
-        meta::NebulaSchemaProvider retSchema(schema->getVersion());
-        // return specifid columns
-        for (const auto& col : edgeIter.second) {
-            PropContext prop;
-            switch (col.owner) {
-                case cpp2::PropOwner::EDGE: {
-                    if (col.id.get_edge_type() > 0) {
-                        // Only outBound have properties on edge.
-                        auto ftype = schema->getFieldType(col.name);
-                        if (UNLIKELY(ftype == CommonConstants::kInvalidValueType())) {
-                            return cpp2::ErrorCode::E_IMPROPER_DATA_TYPE;
-                        }
-                        prop.type_ = ftype;
-                        retSchema.addField(col.name, std::move(ftype));
-                    } else {
-                        VLOG(3) << "InBound has none props, skip it!";
-                        break;
-                    }
-                    prop.retIndex_ = index++;
-                    prop.prop_ = std::move(col);
-                    prop.returned_ = true;
-                    propContexts.emplace_back(std::move(prop));
-                    break;
-                }
-                default: {
-                    continue;
-                }
-            }
-        }
-        edgeContexts_.emplace(edgeType, std::move(propContexts));
-        edgeSchema_.emplace(edgeType, retSchema.toSchema());
     }
-    return cpp2::ErrorCode::SUCCEEDED;
 }
 
 }  // namespace storage
@@ -1,44 +1,42 @@
-/* Copyright (c) 2019 vesoft inc. All rights reserved.:
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
  *
  * This source code is licensed under Apache 2.0 License,
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
 
-#ifndef STORAGE_SCANEDGEPROCESSOR_H_
-#define STORAGE_SCANEDGEPROCESSOR_H_
+#ifndef STORAGE_QUERY_SCANEDGEPROCESSOR_H_
+#define STORAGE_QUERY_SCANEDGEPROCESSOR_H_
 
 #include "common/base/Base.h"
-#include "storage/BaseProcessor.h"
+#include "storage/query/ScanBaseProcessor.h"
 
 namespace nebula {
 namespace storage {
 
-class ScanEdgeProcessor
-    : public BaseProcessor<cpp2::ScanEdgeResponse> {
+// Scan the edges of the parts page by page, a row for each edge in the response
+class ScanEdgeProcessor : public ScanBaseProcessor<ScanEdgeRequest> {
 public:
-    static ScanEdgeProcessor* instance(kvstore::KVStore* kvstore,
-                                       meta::SchemaManager* schemaMan,
-                                       stats::Stats* stats) {
-        return new ScanEdgeProcessor(kvstore, schemaMan, stats);
+    static ScanEdgeProcessor* instance(StorageEnv* env,
+                                       stats::Stats* stats,
+                                       folly::Executor* executor = nullptr) {
+        return new ScanEdgeProcessor(env, stats, executor);
     }
 
-    void process(const cpp2::ScanEdgeRequest& req);
+    void process(const ScanEdgeRequest& req) override;
 
-private:
-    explicit ScanEdgeProcessor(kvstore::KVStore* kvstore,
-                               meta::SchemaManager* schemaMan,
-                               stats::Stats* stats)
-            : BaseProcessor<cpp2::ScanEdgeResponse>(kvstore, schemaMan, stats) {}
+protected:
+    ScanEdgeProcessor(StorageEnv* env,
+                      stats::Stats* stats,
+                      folly::Executor* executor)
+        : ScanBaseProcessor<ScanEdgeRequest>(env, stats, executor) {}
 
-    cpp2::ErrorCode checkAndBuildContexts(const cpp2::ScanEdgeRequest& req);
+    cpp2::ErrorCode checkAndBuildContexts(const ScanEdgeRequest& req) override;
 
-    std::unordered_map<EdgeType, std::vector<PropContext>> edgeContexts_;
-    std::unordered_map<EdgeType, nebula::cpp2::Schema> edgeSchema_;
-    bool returnAllColumns_{false};
-    GraphSpaceID spaceId_;
-    PartitionID partId_;
+    kvstore::ResultCode scanPart(PartScan* scan) override;
+
+    void buildEdgeColName(const std::vector<cpp2::EdgeProp>& edgeProps);
 };
 
 }  // namespace storage
 }  // namespace nebula
-#endif  // STORAGE_SCANEDGEPROCESSOR_H_
+#endif  // STORAGE_QUERY_SCANEDGEPROCESSOR_H_
@@ -0,0 +1,66 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_QUERY_SCANREQUESTS_H_
+#define STORAGE_QUERY_SCANREQUESTS_H_
+
+#include "common/base/Base.h"
+#include "common/interface/gen-cpp2/storage_types.h"
+
+namespace nebula {
+namespace storage {
+
+/**
+ * The requests to scan all vertices or edges of some parts. They are not in the common
+ * interface yet, so they are defined here in the same shape as the generated types, the
+ * processors could be served once the service methods are added.
+ *
+ * A scan is done page by page. The response carries a cursor for each part not scanned to
+ * the end, and the next page of the part is got by passing the cursor back.
+ * */
+
+struct ScanVertexRequest {
+    GraphSpaceID                                    space_id;
+    // part -> the cursor returned by the previous page, empty to scan from the beginning
+    std::unordered_map<PartitionID, std::string>    parts;
+    // The props to return, all props of all tags if it is empty
+    std::vector<cpp2::VertexProp>                   return_columns;
+    // The encoded filter expression, only the vertices passing it are returned
+    std::string                                     filter;
+    // The max number of rows of each part in a page
+    int64_t                                         limit{1000};
+    // The max bytes read of all parts in a page, not positive means max_scan_block_size
+    int64_t                                         max_bytes{0};
+    // Read each part in a snapshot kept across the pages, so the whole scan sees one view
+    bool                                            pin_snapshot{true};
+};
+
+struct ScanEdgeRequest {
+    GraphSpaceID                                    space_id;
+    std::unordered_map<PartitionID, std::string>    parts;
+    // The props to return, all props of all out edges if it is empty
+    std::vector<cpp2::EdgeProp>                     return_columns;
+    std::string                                     filter;
+    int64_t                                         limit{1000};
+    int64_t                                         max_bytes{0};
+    bool                                            pin_snapshot{true};
+};
+
+struct ScanResponse {
+    cpp2::ResponseCommon                            result;
+    // A vertex or an edge in each row, the columns are the same as the ones of GetProp
+    nebula::DataSet                                 data;
+    // part -> the cursor of the next page, the parts scanned to the end are not in it
+    std::unordered_map<PartitionID, std::string>    next_cursors;
+
+    void set_result(cpp2::ResponseCommon res) {
+        result = std::move(res);
+    }
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_QUERY_SCANREQUESTS_H_
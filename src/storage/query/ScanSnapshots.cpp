@@ -0,0 +1,130 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/query/ScanSnapshots.h"
+#include "common/time/WallClock.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+PinnedSnapshot::~PinnedSnapshot() {
+    engine_->releaseSnapshot(snapshot_);
+}
+
+ScanSnapshots* ScanSnapshots::instance() {
+    static ScanSnapshots sScanSnapshots;
+    return &sScanSnapshots;
+}
+
+bool ScanSnapshots::init() {
+    bgWorker_ = std::make_unique<thread::GenericWorker>();
+    if (!bgWorker_->start("scan-snapshots")) {
+        LOG(ERROR) << "Start the worker of the scan snapshots failed";
+        return false;
+    }
+    auto interval = std::max(1, FLAGS_scan_snapshot_expire_secs / 2);
+    bgWorker_->addRepeatTask(interval * 1000, &ScanSnapshots::expire, this);
+    return true;
+}
+
+void ScanSnapshots::stop() {
+    if (bgWorker_ != nullptr) {
+        bgWorker_->stop();
+        bgWorker_->wait();
+        bgWorker_.reset();
+    }
+    std::unordered_map<int64_t, Entry> snapshots;
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        snapshots.swap(snapshots_);
+    }
+    LOG(INFO) << "Drop " << snapshots.size() << " scan snapshots";
+}
+
+ErrorOr<kvstore::ResultCode, std::shared_ptr<PinnedSnapshot>>
+ScanSnapshots::pin(kvstore::KVStore* store,
+                   GraphSpaceID spaceId,
+                   PartitionID partId,
+                   kvstore::KVEngine* engine,
+                   int64_t* id) {
+    auto* nebulaStore = dynamic_cast<kvstore::NebulaStore*>(store);
+    CHECK_NOTNULL(nebulaStore);
+    auto space = nebulaStore->space(spaceId);
+    if (!ok(space)) {
+        return error(space);
+    }
+    auto snapshot = std::make_shared<PinnedSnapshot>(std::move(nebula::value(space)), engine);
+    expire();
+    std::lock_guard<std::mutex> g(lock_);
+    *id = ++lastId_;
+    snapshots_.emplace(*id, Entry{spaceId, partId, snapshot, time::WallClock::fastNowInSec()});
+    VLOG(1) << "Pin scan snapshot " << *id << " of part " << spaceId << ":" << partId;
+    return snapshot;
+}
+
+std::shared_ptr<PinnedSnapshot> ScanSnapshots::get(int64_t id,
+                                                   GraphSpaceID spaceId,
+                                                   PartitionID partId,
+                                                   kvstore::KVEngine* engine) {
+    std::shared_ptr<PinnedSnapshot> stale;
+    std::lock_guard<std::mutex> g(lock_);
+    auto it = snapshots_.find(id);
+    if (it == snapshots_.end() ||
+        it->second.spaceId != spaceId ||
+        it->second.partId != partId) {
+        return nullptr;
+    }
+    if (it->second.snapshot->engine() != engine) {
+        // The part has been moved to another engine
+        stale = std::move(it->second.snapshot);
+        snapshots_.erase(it);
+        return nullptr;
+    }
+    it->second.lastUsed = time::WallClock::fastNowInSec();
+    return it->second.snapshot;
+}
+
+void ScanSnapshots::release(int64_t id) {
+    std::shared_ptr<PinnedSnapshot> snapshot;
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        auto it = snapshots_.find(id);
+        if (it == snapshots_.end()) {
+            return;
+        }
+        snapshot = std::move(it->second.snapshot);
+        snapshots_.erase(it);
+    }
+    VLOG(1) << "Release scan snapshot " << id;
+}
+
+size_t ScanSnapshots::size() const {
+    std::lock_guard<std::mutex> g(lock_);
+    return snapshots_.size();
+}
+
+void ScanSnapshots::expire() {
+    // Release the snapshots out of the lock, the engine may be closed with the last one
+    std::vector<std::shared_ptr<PinnedSnapshot>> expired;
+    {
+        auto now = time::WallClock::fastNowInSec();
+        std::lock_guard<std::mutex> g(lock_);
+        for (auto it = snapshots_.begin(); it != snapshots_.end();) {
+            if (now - it->second.lastUsed > FLAGS_scan_snapshot_expire_secs) {
+                LOG(INFO) << "Scan snapshot " << it->first << " of part " << it->second.spaceId
+                          << ":" << it->second.partId << " expired";
+                expired.emplace_back(std::move(it->second.snapshot));
+                it = snapshots_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
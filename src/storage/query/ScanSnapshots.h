@@ -0,0 +1,101 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_QUERY_SCANSNAPSHOTS_H_
+#define STORAGE_QUERY_SCANSNAPSHOTS_H_
+
+#include "common/base/Base.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/KVStore.h"
+#include "kvstore/NebulaStore.h"
+
+namespace nebula {
+namespace storage {
+
+// A snapshot of the engine of a part, it is released when the last holder drops it. The
+// space owns its engines, so it is held to keep the engine open even if the space is dropped.
+class PinnedSnapshot final {
+public:
+    PinnedSnapshot(std::shared_ptr<kvstore::SpacePartInfo> space, kvstore::KVEngine* engine)
+        : space_(std::move(space))
+        , engine_(engine)
+        , snapshot_(engine->getSnapshot()) {}
+
+    ~PinnedSnapshot();
+
+    kvstore::KVEngine* engine() const {
+        return engine_;
+    }
+
+    const void* snapshot() const {
+        return snapshot_;
+    }
+
+private:
+    std::shared_ptr<kvstore::SpacePartInfo>     space_;
+    kvstore::KVEngine                          *engine_;
+    const void                                 *snapshot_;
+};
+
+/**
+ * The snapshots pinned by the scans which go on page by page. Each of them is kept by id
+ * until the scan of the part reaches the end, or it is not used for scan_snapshot_expire_secs.
+ * The expired ones are dropped when any snapshot is pinned, and by a background worker
+ * between init() and stop(), so they are reclaimed even if no scan comes any more.
+ *
+ * A snapshot holds back the compaction of the old versions in the engine, so a scan should
+ * not pause too long between its pages.
+ * */
+class ScanSnapshots final {
+public:
+    static ScanSnapshots* instance();
+
+    // Start the worker which drops the expired snapshots
+    bool init();
+
+    // Stop the worker and drop all the snapshots
+    void stop();
+
+    // Pin a snapshot of the engine of the part, its id is never 0
+    ErrorOr<kvstore::ResultCode, std::shared_ptr<PinnedSnapshot>> pin(kvstore::KVStore* store,
+                                                                      GraphSpaceID spaceId,
+                                                                      PartitionID partId,
+                                                                      kvstore::KVEngine* engine,
+                                                                      int64_t* id);
+
+    // The snapshot of the id, nullptr if it is gone or not of the part's engine
+    std::shared_ptr<PinnedSnapshot> get(int64_t id,
+                                        GraphSpaceID spaceId,
+                                        PartitionID partId,
+                                        kvstore::KVEngine* engine);
+
+    void release(int64_t id);
+
+    size_t size() const;
+
+    // Drop the snapshots not used for scan_snapshot_expire_secs
+    void expire();
+
+private:
+    ScanSnapshots() = default;
+
+    struct Entry {
+        GraphSpaceID                        spaceId;
+        PartitionID                         partId;
+        std::shared_ptr<PinnedSnapshot>     snapshot;
+        int64_t                             lastUsed;
+    };
+
+private:
+    mutable std::mutex                      lock_;
+    std::unordered_map<int64_t, Entry>      snapshots_;
+    int64_t                                 lastId_{0};
+    std::unique_ptr<thread::GenericWorker>  bgWorker_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_QUERY_SCANSNAPSHOTS_H_
@@ -1,44 +1,42 @@
-/* Copyright (c) 2019 vesoft inc. All rights reserved.:
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
  *
  * This source code is licensed under Apache 2.0 License,
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
 
-#ifndef STORAGE_SCANVERTEXPROCESSOR_H_
-#define STORAGE_SCANVERTEXPROCESSOR_H_
+#ifndef STORAGE_QUERY_SCANVERTEXPROCESSOR_H_
+#define STORAGE_QUERY_SCANVERTEXPROCESSOR_H_
 
 #include "common/base/Base.h"
-#include "storage/BaseProcessor.h"
+#include "storage/query/ScanBaseProcessor.h"
 
 namespace nebula {
 namespace storage {
 
-class ScanVertexProcessor
-    : public BaseProcessor<cpp2::ScanVertexResponse> {
+// Scan the vertices of the parts page by page, a row for each vertex in the response
+class ScanVertexProcessor : public ScanBaseProcessor<ScanVertexRequest> {
 public:
-    static ScanVertexProcessor* instance(kvstore::KVStore* kvstore,
-                                         meta::SchemaManager* schemaMan,
-                                         stats::Stats* stats) {
-        return new ScanVertexProcessor(kvstore, schemaMan, stats);
+    static ScanVertexProcessor* instance(StorageEnv* env,
+                                         stats::Stats* stats,
+                                         folly::Executor* executor = nullptr) {
+        return new ScanVertexProcessor(env, stats, executor);
     }
 
-    void process(const cpp2::ScanVertexRequest& req);
+    void process(const ScanVertexRequest& req) override;
 
-private:
-    explicit ScanVertexProcessor(kvstore::KVStore* kvstore,
-                                 meta::SchemaManager* schemaMan,
-                                 stats::Stats* stats)
-            : BaseProcessor<cpp2::ScanVertexResponse>(kvstore, schemaMan, stats) {}
+protected:
+    ScanVertexProcessor(StorageEnv* env,
+                        stats::Stats* stats,
+                        folly::Executor* executor)
+        : ScanBaseProcessor<ScanVertexRequest>(env, stats, executor) {}
 
-    cpp2::ErrorCode checkAndBuildContexts(const cpp2::ScanVertexRequest& req);
+    cpp2::ErrorCode checkAndBuildContexts(const ScanVertexRequest& req) override;
 
-    std::unordered_map<TagID, std::vector<PropContext>> tagContexts_;
-    std::unordered_map<TagID, nebula::cpp2::Schema> tagSchema_;
-    bool returnAllColumns_{false};
-    GraphSpaceID spaceId_;
-    PartitionID partId_;
+    kvstore::ResultCode scanPart(PartScan* scan) override;
+
+    void buildTagColName(const std::vector<cpp2::VertexProp>& tagProps);
 };
 
 }  // namespace storage
 }  // namespace nebula
-#endif  // STORAGE_SCANVERTEXPROCESSOR_H_
+#endif  // STORAGE_QUERY_SCANVERTEXPROCESSOR_H_
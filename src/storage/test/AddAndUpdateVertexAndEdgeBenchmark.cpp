@@ -18,6 +18,7 @@
 #include "common/expression/ConstantExpression.h"
 #include "common/interface/gen-cpp2/storage_types.h"
 #include "codec/test/RowWriterV1.h"
+#include "codec/test/SchemaWriter.h"
 #include <folly/Benchmark.h>
 
 namespace nebula {
@@ -451,9 +452,72 @@ cpp2::UpdateEdgeRequest buildUpdateEdgeReq(bool isVersionV2) {
     return req;
 }
 
+// A wide tag with 48 props, half of them are long strings
+SchemaWriter wideSchema;
+std::string wideRow;    // NOLINT
+
+void prepareWideRow() {
+    for (int32_t i = 0; i < 24; i++) {
+        wideSchema.appendCol(folly::stringPrintf("int%02d", i), meta::cpp2::PropertyType::INT64);
+        wideSchema.appendCol(folly::stringPrintf("str%02d", i), meta::cpp2::PropertyType::STRING);
+    }
+    RowWriterV2 writer(&wideSchema);
+    for (int32_t i = 0; i < 24; i++) {
+        writer.set(i * 2, static_cast<int64_t>(i));
+        writer.set(i * 2 + 1, std::string(256, 'a' + i));
+    }
+    CHECK(writer.finish() == WriteResult::SUCCEEDED);
+    wideRow = writer.moveEncodedStr();
+}
+
 }  // namespace storage
 }  // namespace nebula
 
+// Update one INT64 prop of the wide row by encoding the whole row again,
+// which is what UpdateTagNode/UpdateEdgeNode did before
+void updateWideRowFull(int32_t iters) {
+    auto* schema = &nebula::storage::wideSchema;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        auto reader = nebula::RowReader::getRowReader(schema, nebula::storage::wideRow);
+        nebula::RowWriterV2 writer(schema);
+        for (size_t idx = 0; idx < schema->getNumFields(); idx++) {
+            if (idx == 0) {
+                writer.set(idx, static_cast<int64_t>(i));
+            } else {
+                writer.setValue(idx, reader->getValueByIndex(idx));
+            }
+        }
+        writer.finish();
+        auto val = writer.moveEncodedStr();
+        folly::doNotOptimizeAway(val);
+    }
+}
+
+// Update one INT64 prop of the wide row in place
+void updateWideRowInPlace(int32_t iters) {
+    auto* schema = &nebula::storage::wideSchema;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        nebula::RowWriterV2 writer(schema, nebula::storage::wideRow);
+        writer.set(0, static_cast<int64_t>(i));
+        writer.finish();
+        auto val = writer.moveEncodedStr();
+        folly::doNotOptimizeAway(val);
+    }
+}
+
+// Update one STRING prop of the wide row in place, with the same length
+void updateWideRowInPlaceStr(int32_t iters) {
+    auto* schema = &nebula::storage::wideSchema;
+    std::string str(256, 'z');
+    for (decltype(iters) i = 0; i < iters; i++) {
+        nebula::RowWriterV2 writer(schema, nebula::storage::wideRow);
+        writer.set(1, str);
+        writer.finish();
+        auto val = writer.moveEncodedStr();
+        folly::doNotOptimizeAway(val);
+    }
+}
+
 void insertVertex(int32_t iters) {
     nebula::storage::cpp2::AddVerticesRequest req;
     BENCHMARK_SUSPEND {
@@ -553,6 +617,18 @@ BENCHMARK_RELATIVE(update_edgeV2, iters) {
     updateEdge(iters, true);
 }
 
+BENCHMARK(update_wide_row_full, iters) {
+    updateWideRowFull(iters);
+}
+
+BENCHMARK_RELATIVE(update_wide_row_in_place, iters) {
+    updateWideRowInPlace(iters);
+}
+
+BENCHMARK_RELATIVE(update_wide_row_in_place_str, iters) {
+    updateWideRowInPlaceStr(iters);
+}
+
 BENCHMARK(insert_vertexV2, iters) {
     insertVertex(iters);
 }
@@ -569,6 +645,7 @@ int main(int argc, char** argv) {
     nebula::storage::env = cluster.storageEnv_.get();
     nebula::storage::parts = cluster.getTotalParts();
     nebula::storage::setUp(nebula::storage::env);
+    nebula::storage::prepareWideRow();
     folly::runBenchmarks();
     return 0;
 }
@@ -586,6 +663,9 @@ update_vertex   : tag data exist and update
 
 update_edge     : edge data exist and update
 
+update_wide_row : update one prop of a 48-prop row (24 strings of 256 bytes),
+                  either by encoding the whole row again, or patching it in place
+
 insert_vertex   : insert one record of one tag of one vertex
 
 insert_edge     : insert one record of one edge
@@ -0,0 +1,269 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "utils/NebulaKeyUtils.h"
+#include "storage/cache/AdjacencyCache.h"
+#include "storage/query/GetNeighborsProcessor.h"
+#include "storage/mutate/AddEdgesProcessor.h"
+#include "storage/mutate/DeleteEdgesProcessor.h"
+#include "storage/mutate/DeleteVerticesProcessor.h"
+#include "mock/AdHocIndexManager.h"
+#include "storage/test/QueryTestUtils.h"
+
+namespace nebula {
+namespace storage {
+
+std::shared_ptr<AdjacencyList> mockList(size_t vIdLen, size_t edges, size_t versions) {
+    auto list = std::make_shared<AdjacencyList>();
+    for (size_t i = 0; i < edges; i++) {
+        for (size_t ver = 0; ver < versions; ver++) {
+            auto key = NebulaKeyUtils::edgeKey(vIdLen, 1, "src", 101, i, "dst", ver);
+            list->add(key, folly::stringPrintf("val_%lu_%lu", i, ver));
+        }
+    }
+    list->shrink();
+    return list;
+}
+
+TEST(AdjacencyCacheTest, AdjacencyListTest) {
+    size_t vIdLen = 8;
+    auto list = mockList(vIdLen, 10, 3);
+    ASSERT_EQ(10, list->size());
+
+    AdjacencyIterator iter(list);
+    size_t count = 0;
+    while (iter.valid()) {
+        EXPECT_EQ(static_cast<EdgeRanking>(count), NebulaKeyUtils::getRank(vIdLen, iter.key()));
+        // only the first (latest) version is kept
+        EXPECT_EQ(0, NebulaKeyUtils::getVersion(vIdLen, iter.key()));
+        EXPECT_EQ(folly::stringPrintf("val_%lu_0", count), iter.val());
+        iter.next();
+        count++;
+    }
+    EXPECT_EQ(10, count);
+}
+
+TEST(AdjacencyCacheTest, InsertAndEvictTest) {
+    FLAGS_adjacency_cache_expire_secs = 0;
+    size_t vIdLen = 8;
+    AdjacencyCache cache(1 << 20, 0);
+    auto key = AdjacencyCache::cacheKey(1, vIdLen, 1, "src", 101);
+
+    EXPECT_EQ(nullptr, cache.get(key));
+    auto epoch = cache.epoch(key);
+    EXPECT_TRUE(cache.insert(key, mockList(vIdLen, 10, 1), epoch));
+    auto list = cache.get(key);
+    ASSERT_NE(nullptr, list);
+    EXPECT_EQ(10, list->size());
+    EXPECT_EQ(1, cache.hits());
+    EXPECT_EQ(2, cache.total());
+
+    // an edge is written during the scan, the list read before should be rejected
+    epoch = cache.epoch(key);
+    cache.evict(key);
+    EXPECT_EQ(nullptr, cache.get(key));
+    EXPECT_FALSE(cache.insert(key, mockList(vIdLen, 10, 1), epoch));
+    EXPECT_EQ(nullptr, cache.get(key));
+    EXPECT_EQ(0, cache.bytes());
+
+    // the list evicted is still valid for the reader who holds it
+    EXPECT_EQ(10, list->size());
+}
+
+TEST(AdjacencyCacheTest, EvictPartTest) {
+    FLAGS_adjacency_cache_expire_secs = 0;
+    size_t vIdLen = 8;
+    AdjacencyCache cache(1 << 20, 2);
+    for (PartitionID partId = 1; partId <= 2; partId++) {
+        for (int32_t i = 0; i < 10; i++) {
+            auto key = AdjacencyCache::cacheKey(1, vIdLen, partId, folly::to<std::string>(i), 101);
+            EXPECT_TRUE(cache.insert(key, mockList(vIdLen, 10, 1), cache.epoch(key)));
+        }
+    }
+    // the same part of another space
+    auto other = AdjacencyCache::cacheKey(2, vIdLen, 1, "0", 101);
+    EXPECT_TRUE(cache.insert(other, mockList(vIdLen, 10, 1), cache.epoch(other)));
+
+    // the leadership of part 1 changes while the edges of a vertex in it are being scanned
+    auto scanning = AdjacencyCache::cacheKey(1, vIdLen, 1, "scanning", 101);
+    auto epoch = cache.epoch(scanning);
+    cache.evictPart(1, 1);
+    EXPECT_FALSE(cache.insert(scanning, mockList(vIdLen, 10, 1), epoch));
+    for (int32_t i = 0; i < 10; i++) {
+        auto id = folly::to<std::string>(i);
+        EXPECT_EQ(nullptr, cache.get(AdjacencyCache::cacheKey(1, vIdLen, 1, id, 101)));
+        EXPECT_NE(nullptr, cache.get(AdjacencyCache::cacheKey(1, vIdLen, 2, id, 101)));
+    }
+    EXPECT_NE(nullptr, cache.get(other));
+}
+
+TEST(AdjacencyCacheTest, CapacityTest) {
+    FLAGS_adjacency_cache_expire_secs = 0;
+    size_t vIdLen = 8;
+    auto size = mockList(vIdLen, 100, 1)->bytes();
+    AdjacencyCache cache(size * 5, 0);
+    for (int32_t i = 0; i < 10; i++) {
+        auto key = AdjacencyCache::cacheKey(1, vIdLen, 1, folly::to<std::string>(i), 101);
+        EXPECT_TRUE(cache.insert(key, mockList(vIdLen, 100, 1), cache.epoch(key)));
+        EXPECT_LE(cache.bytes(), size * 5);
+    }
+    EXPECT_LT(0, cache.evicts());
+    // the least recently used lists are evicted
+    EXPECT_EQ(nullptr, cache.get(AdjacencyCache::cacheKey(1, vIdLen, 1, "0", 101)));
+    EXPECT_NE(nullptr, cache.get(AdjacencyCache::cacheKey(1, vIdLen, 1, "9", 101)));
+
+    // a list larger than the capacity is never cached
+    auto key = AdjacencyCache::cacheKey(1, vIdLen, 1, "huge", 101);
+    EXPECT_FALSE(cache.insert(key, mockList(vIdLen, 1000, 1), cache.epoch(key)));
+}
+
+TEST(AdjacencyCacheTest, HotThresholdTest) {
+    FLAGS_adjacency_cache_hot_threshold = 3;
+    AdjacencyCache cache(1 << 20, 0);
+    auto key = AdjacencyCache::cacheKey(1, 8, 1, "src", 101);
+    EXPECT_FALSE(cache.touch(key));
+    EXPECT_FALSE(cache.touch(key));
+    EXPECT_TRUE(cache.touch(key));
+    EXPECT_TRUE(cache.touch(key));
+}
+
+TEST(AdjacencyCacheTest, GetNeighborsTest) {
+    fs::TempDir rootPath("/tmp/AdjacencyCacheTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts, 3));
+
+    FLAGS_enable_adjacency_cache = true;
+    FLAGS_adjacency_cache_min_degree = 1;
+    FLAGS_adjacency_cache_hot_threshold = 1;
+    FLAGS_adjacency_cache_expire_secs = 0;
+    AdjacencyCache cache(16 << 20, 2);
+
+    GraphSpaceID spaceId = 1;
+    EdgeType serve = 101;
+    VertexID vId = "Tim Duncan";
+    PartitionID partId = (std::hash<std::string>()(vId) % totalParts) + 1;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+    auto cacheKey = AdjacencyCache::cacheKey(spaceId, vIdLen, partId, vId, serve);
+
+    auto getServes = [&] (AdjacencyCache* adjCache) -> size_t {
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear"});
+        auto req = QueryTestUtils::buildRequest(totalParts, {vId}, {serve}, tags, edges);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr, adjCache);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        // vId, stat, serve, expr
+        EXPECT_EQ(1, resp.vertices.rows.size());
+        return resp.vertices.rows[0].values[2].getList().values.size();
+    };
+
+    auto expected = getServes(nullptr);
+    ASSERT_LT(0, expected);
+
+    LOG(INFO) << "Fill the cache on miss";
+    EXPECT_EQ(expected, getServes(&cache));
+    auto list = cache.get(cacheKey);
+    ASSERT_NE(nullptr, list);
+    EXPECT_EQ(expected, list->size());
+
+    LOG(INFO) << "Serve from the cache";
+    auto hits = cache.hits();
+    EXPECT_EQ(expected, getServes(&cache));
+    EXPECT_EQ(hits + 1, cache.hits());
+
+    cpp2::NewEdge newEdge;
+    cpp2::EdgeKey edgeKey;
+    edgeKey.src = vId;
+    edgeKey.edge_type = serve;
+    edgeKey.ranking = 2077;
+    edgeKey.dst = "Lakers";
+    {
+        LOG(INFO) << "AddEdges evicts the cache";
+        auto serves = mock::MockData::mockEdges();
+        auto iter = std::find_if(serves.begin(), serves.end(), [&] (const auto& edge) {
+            return edge.srcId_ == vId && edge.type_ == serve;
+        });
+        ASSERT_NE(serves.end(), iter);
+        cpp2::AddEdgesRequest req;
+        req.space_id = spaceId;
+        req.overwritable = true;
+        newEdge.set_key(edgeKey);
+        newEdge.set_props(iter->props_);
+        req.parts[partId].emplace_back(newEdge);
+
+        auto* processor = AddEdgesProcessor::instance(env, nullptr, &cache);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        EXPECT_EQ(nullptr, cache.get(cacheKey));
+        EXPECT_EQ(expected + 1, getServes(&cache));
+        EXPECT_EQ(expected + 1, getServes(&cache));
+    }
+    {
+        LOG(INFO) << "DeleteEdges evicts the cache";
+        cpp2::DeleteEdgesRequest req;
+        req.space_id = spaceId;
+        req.parts[partId].emplace_back(edgeKey);
+
+        auto* processor = DeleteEdgesProcessor::instance(env, nullptr, &cache);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        EXPECT_EQ(nullptr, cache.get(cacheKey));
+        EXPECT_EQ(expected, getServes(&cache));
+    }
+    {
+        LOG(INFO) << "DeleteVertices with index evicts the cache";
+        EXPECT_EQ(expected, getServes(&cache));
+        ASSERT_NE(nullptr, cache.get(cacheKey));
+
+        // the edges are removed together with the vertex when there is a tag index
+        auto* indexMan = dynamic_cast<mock::AdHocIndexManager*>(env->indexMan_);
+        ASSERT_NE(nullptr, indexMan);
+        std::vector<nebula::meta::cpp2::ColumnDef> cols;
+        meta::cpp2::ColumnDef col;
+        col.set_name("age");
+        col.set_type(meta::cpp2::PropertyType::INT64);
+        cols.emplace_back(std::move(col));
+        indexMan->addTagIndex(spaceId, 4, 1, std::move(cols));
+
+        cpp2::DeleteVerticesRequest req;
+        req.space_id = spaceId;
+        req.parts[partId].emplace_back(vId);
+        auto* processor = DeleteVerticesProcessor::instance(env, nullptr, nullptr, &cache);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        EXPECT_EQ(nullptr, cache.get(cacheKey));
+    }
+    FLAGS_enable_adjacency_cache = false;
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
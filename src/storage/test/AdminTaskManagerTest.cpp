@@ -549,6 +549,57 @@ TEST(TaskManagerTest, some_subtask_failed) {
     taskMgr->shutdown();
 }
 
+TEST(TaskManagerTest, task_progress) {
+    auto taskMgr = AdminTaskManager::instance();
+    taskMgr->init();
+    int jobId = ++gJobId;
+
+    std::shared_ptr<AdminTask> task = std::make_shared<HookableTask>();
+    HookableTask* mockTask = static_cast<HookableTask*>(task.get());
+    mockTask->setJobId(jobId);
+    mockTask->setTaskId(jobId);
+    mockTask->setConcurrentReq(1);
+
+    folly::Promise<int> pTaskRun;
+    auto fTaskRun = pTaskRun.getFuture();
+
+    folly::Promise<ResultCode> pFinish;
+    folly::Future<ResultCode> fFinish = pFinish.getFuture();
+
+    folly::Promise<int> pContinue;
+    folly::Future<int> fContinue = pContinue.getFuture();
+
+    mockTask->addSubTask([&]() {
+        return suc;
+    });
+    mockTask->addSubTask([&]() {
+        pTaskRun.setValue(0);
+        fContinue.wait();
+        return suc;
+    });
+
+    mockTask->setCallback([&](ResultCode ret) {
+        pFinish.setValue(ret);
+    });
+
+    EXPECT_FALSE(ok(taskMgr->taskProgress(jobId, jobId)));
+    taskMgr->addAsyncTask(task);
+
+    // the first sub task has finished, the second one is running
+    fTaskRun.wait();
+    auto progress = taskMgr->taskProgress(jobId, jobId);
+    ASSERT_TRUE(ok(progress));
+    EXPECT_EQ(1, value(progress).first);
+    EXPECT_EQ(2, value(progress).second);
+
+    pContinue.setValue(0);
+    fFinish.wait();
+    EXPECT_EQ(suc, fFinish.value());
+
+    taskMgr->shutdown();
+    EXPECT_EQ(cpp2::ErrorCode::E_KEY_NOT_FOUND, error(taskMgr->taskProgress(jobId, jobId)));
+}
+
 TEST(TaskManagerTest, cancel_a_running_task_with_only_1_sub_task) {
     auto taskMgr = AdminTaskManager::instance();
     taskMgr->init();
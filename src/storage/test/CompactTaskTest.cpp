@@ -0,0 +1,176 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/time/WallClock.h"
+#include <gtest/gtest.h>
+#include "mock/MockCluster.h"
+#include "storage/StorageFlags.h"
+#include "storage/admin/AdminTask.h"
+#include "storage/admin/CompactTask.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+TaskContext compactContext(kvstore::KVStore* store,
+                           std::vector<PartitionID> parts,
+                           std::vector<std::string> paras) {
+    cpp2::AddAdminTaskRequest req;
+    req.set_cmd(nebula::meta::cpp2::AdminCmd::COMPACT);
+    req.set_job_id(1);
+    req.set_task_id(1);
+    cpp2::TaskPara para;
+    para.set_space_id(1);
+    para.set_parts(std::move(parts));
+    para.set_task_specfic_paras(std::move(paras));
+    req.set_para(std::move(para));
+    return TaskContext(req, store, [] (cpp2::ErrorCode) {});
+}
+
+std::string prefixEnd(const std::string& prefix) {
+    std::string end = prefix;
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+    return end;
+}
+
+TEST(CompactTaskTest, RangePrefixesTest) {
+    auto partPrefix = [] (NebulaKeyType type) {
+        return NebulaKeyUtils::partPrefix(3, type);
+    };
+    {
+        CompactTask task(compactContext(nullptr, {3}, {}));
+        auto prefixes = task.rangePrefixes(3);
+        ASSERT_TRUE(nebula::ok(prefixes));
+        std::vector<std::string> expected = {partPrefix(NebulaKeyType::kData),
+                                             partPrefix(NebulaKeyType::kEdge),
+                                             partPrefix(NebulaKeyType::kIndex),
+                                             partPrefix(NebulaKeyType::kUUID)};
+        EXPECT_EQ(expected, nebula::value(prefixes));
+    }
+    {
+        // the edges are data as well, no matter in which key type they are
+        CompactTask task(compactContext(nullptr, {3}, {"data", "index:5"}));
+        auto prefixes = task.rangePrefixes(3);
+        ASSERT_TRUE(nebula::ok(prefixes));
+        std::vector<std::string> expected = {partPrefix(NebulaKeyType::kData),
+                                             partPrefix(NebulaKeyType::kEdge),
+                                             IndexKeyUtils::indexPrefix(3, 5)};
+        EXPECT_EQ(expected, nebula::value(prefixes));
+    }
+    for (const auto& para : {"index:x", "vertex"}) {
+        CompactTask task(compactContext(nullptr, {3}, {para}));
+        auto prefixes = task.rangePrefixes(3);
+        ASSERT_FALSE(nebula::ok(prefixes));
+        EXPECT_EQ(cpp2::ErrorCode::E_INVALID_TASK_PARA, nebula::error(prefixes));
+    }
+}
+
+TEST(CompactTaskTest, CompactPartsTest) {
+    fs::TempDir rootPath("/tmp/CompactTaskTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto* store = env->kvstore_;
+
+    std::vector<NebulaKeyType> types = {NebulaKeyType::kData,
+                                        NebulaKeyType::kEdge,
+                                        NebulaKeyType::kIndex};
+    for (PartitionID partId : {1, 2}) {
+        std::vector<kvstore::KV> data;
+        for (auto type : types) {
+            auto prefix = NebulaKeyUtils::partPrefix(partId, type);
+            for (int32_t i = 0; i < 2000; i++) {
+                data.emplace_back(prefix + folly::stringPrintf("key_%05d", i),
+                                  std::string(100, 'v'));
+            }
+        }
+        folly::Baton<true, std::atomic> baton;
+        store->asyncMultiPut(1, partId, std::move(data), [&] (kvstore::ResultCode code) {
+            EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    ASSERT_EQ(kvstore::ResultCode::SUCCEEDED, store->flush(1));
+
+    // Remove all keys without compaction, they are still on the disk
+    auto engine = [store] (PartitionID partId) {
+        auto part = store->part(1, partId);
+        CHECK(nebula::ok(part));
+        return nebula::value(part)->engine();
+    };
+    std::map<std::pair<PartitionID, NebulaKeyType>, int64_t> sizes;
+    for (PartitionID partId : {1, 2}) {
+        for (auto type : types) {
+            auto prefix = NebulaKeyUtils::partPrefix(partId, type);
+            ASSERT_EQ(kvstore::ResultCode::SUCCEEDED,
+                      engine(partId)->removeRange(prefix, prefixEnd(prefix)));
+            sizes[{partId, type}] = engine(partId)->approximateSize(prefix, prefixEnd(prefix));
+            ASSERT_LT(0, sizes[{partId, type}]);
+        }
+    }
+    auto compacted = [&] (PartitionID partId, NebulaKeyType type) {
+        auto prefix = NebulaKeyUtils::partPrefix(partId, type);
+        auto size = engine(partId)->approximateSize(prefix, prefixEnd(prefix));
+        return size < sizes[{partId, type}] / 10;
+    };
+    auto runTask = [env] (std::vector<std::string> paras, size_t expectedSubTasks) {
+        auto task = AdminTaskFactory::createAdminTask(
+            env, compactContext(env->kvstore_, {1}, std::move(paras)));
+        ASSERT_NE(nullptr, std::dynamic_pointer_cast<CompactTask>(task));
+        auto subTasks = task->genSubTasks();
+        ASSERT_TRUE(nebula::ok(subTasks));
+        EXPECT_EQ(expectedSubTasks, nebula::value(subTasks).size());
+        for (auto& subTask : nebula::value(subTasks)) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, subTask.invoke());
+        }
+    };
+
+    LOG(INFO) << "Compact the data of part 1, including the separated edges";
+    runTask({"data"}, 2);
+    EXPECT_TRUE(compacted(1, NebulaKeyType::kData));
+    EXPECT_TRUE(compacted(1, NebulaKeyType::kEdge));
+    EXPECT_FALSE(compacted(1, NebulaKeyType::kIndex));
+    for (auto type : types) {
+        EXPECT_FALSE(compacted(2, type));
+    }
+
+    LOG(INFO) << "Compact the index of part 1";
+    runTask({"index"}, 1);
+    EXPECT_TRUE(compacted(1, NebulaKeyType::kIndex));
+    for (auto type : types) {
+        EXPECT_FALSE(compacted(2, type));
+    }
+}
+
+TEST(CompactTaskTest, ThrottleTest) {
+    gflags::FlagSaver flagSaver;
+    FLAGS_compact_range_rate_limit_mb = 10;
+    CompactTask task(compactContext(nullptr, {1}, {}));
+    task.startMs_ = time::WallClock::fastNowInMilliSec();
+    // 2MB at 10MB/s takes at least 200ms
+    task.throttle(1024 * 1024);
+    task.throttle(1024 * 1024);
+    EXPECT_LE(190, time::WallClock::fastNowInMilliSec() - task.startMs_);
+
+    FLAGS_compact_range_rate_limit_mb = 0;
+    auto start = time::WallClock::fastNowInMilliSec();
+    task.throttle(1024 * 1024 * 1024);
+    EXPECT_GT(100, time::WallClock::fastNowInMilliSec() - start);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,255 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+#include "storage/CommonUtils.h"
+#include "storage/admin/AdminTask.h"
+#include "storage/admin/ConvertEdgeKeyTask.h"
+#include "storage/admin/DropSchemaDataTask.h"
+#include "storage/test/QueryTestUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+struct KeyCount {
+    size_t vertices{0};
+    size_t edges{0};
+    // The keys which are not vertices or edges of the expected type
+    size_t others{0};
+};
+
+// Count the keys of the given type in all parts
+KeyCount countKeys(StorageEnv* env, NebulaKeyType type) {
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    KeyCount count;
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::partPrefix(partId, type);
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        for (; iter->valid(); iter->next()) {
+            auto key = iter->key();
+            if (NebulaKeyUtils::isVertex(vIdLen, key)) {
+                count.vertices++;
+            } else if (NebulaKeyUtils::isEdge(vIdLen, key)) {
+                count.edges++;
+            } else {
+                count.others++;
+            }
+        }
+    }
+    return count;
+}
+
+TaskContext compactContext(kvstore::KVStore* store, std::vector<std::string> paras) {
+    cpp2::AddAdminTaskRequest req;
+    req.set_cmd(nebula::meta::cpp2::AdminCmd::COMPACT);
+    req.set_job_id(1);
+    req.set_task_id(1);
+    cpp2::TaskPara para;
+    para.set_space_id(1);
+    para.set_task_specfic_paras(std::move(paras));
+    req.set_para(std::move(para));
+    return TaskContext(req, store, [] (cpp2::ErrorCode) {});
+}
+
+void runTask(StorageEnv* env, std::vector<std::string> paras) {
+    auto task = AdminTaskFactory::createAdminTask(env, compactContext(env->kvstore_, paras));
+    ASSERT_NE(nullptr, task);
+    auto subTasks = task->genSubTasks();
+    ASSERT_TRUE(nebula::ok(subTasks));
+    EXPECT_EQ(6, nebula::value(subTasks).size());
+    for (auto& subTask : nebula::value(subTasks)) {
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, subTask.invoke());
+    }
+    task->finish();
+}
+
+struct EdgeCount {
+    size_t keys{0};
+    size_t edges{0};
+};
+
+// The edges of the source vertex read by the layout of the part, the versions of an edge
+// must be adjacent to be counted once
+EdgeCount countEdgesOf(StorageEnv* env, const VertexID& vId, EdgeType edgeType) {
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    auto partId = std::hash<std::string>()(vId) % 6 + 1;
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto prefix = NebulaKeyUtils::edgePrefix(1, vIdLen, partId, vId, edgeType);
+    EXPECT_EQ(kvstore::ResultCode::SUCCEEDED,
+              CommonUtils::edgePrefix(env->kvstore_, 1, partId, prefix, &iter));
+    EdgeCount count;
+    std::string last;
+    for (; iter->valid(); iter->next()) {
+        count.keys++;
+        auto edge = NebulaKeyUtils::keyWithNoVersion(iter->key()).subpiece(1);
+        if (edge != last) {
+            count.edges++;
+            last = edge.str();
+        }
+    }
+    return count;
+}
+
+void expectLayout(const EdgeKeyLayout& layout) {
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        EXPECT_EQ(layout, NebulaKeyUtils::edgeKeyLayout(1, partId));
+    }
+}
+
+TEST(ConvertEdgeKeyTest, SeparateAndMergeTest) {
+    gflags::FlagSaver flagSaver;
+    fs::TempDir rootPath("/tmp/ConvertEdgeKeyTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    NebulaKeyUtils::removeEdgeKeyLayout(1);
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, 6));
+    ASSERT_TRUE(QueryTestUtils::mockEdgeData(env, 6));
+
+    auto before = countKeys(env, NebulaKeyType::kData);
+    EXPECT_LT(0, before.vertices);
+    EXPECT_LT(0, before.edges);
+    EXPECT_EQ(0, countKeys(env, NebulaKeyType::kEdge).edges);
+    VertexID player = "Tim Duncan";
+    auto teammates = countEdgesOf(env, player, 102).edges;
+    EXPECT_LT(0, teammates);
+
+    auto task = AdminTaskFactory::createAdminTask(env, compactContext(env->kvstore_,
+                                                                      {"edge_key"}));
+    EXPECT_NE(nullptr, std::dynamic_pointer_cast<ConvertEdgeKeyTask>(task));
+
+    EdgeKeyLayout separated;
+    separated.type = NebulaKeyType::kEdge;
+    {
+        // The flag alone changes nothing of the parts
+        FLAGS_separate_edge_key = true;
+        expectLayout(EdgeKeyLayout());
+        EXPECT_EQ(teammates, countEdgesOf(env, player, 102).edges);
+        runTask(env, {"edge_key"});
+        expectLayout(separated);
+
+        auto vertices = countKeys(env, NebulaKeyType::kData);
+        EXPECT_EQ(before.vertices, vertices.vertices);
+        EXPECT_EQ(0, vertices.edges);
+        auto edges = countKeys(env, NebulaKeyType::kEdge);
+        EXPECT_EQ(0, edges.vertices);
+        EXPECT_EQ(before.edges, edges.edges);
+        EXPECT_EQ(0, edges.others);
+        EXPECT_EQ(teammates, countEdgesOf(env, player, 102).edges);
+
+        // Run again, nothing is left to move
+        runTask(env, {"edge_key"});
+        EXPECT_EQ(before.edges, countKeys(env, NebulaKeyType::kEdge).edges);
+        expectLayout(separated);
+    }
+    {
+        // The rows of the dropped schemas are removed in the separated layout as well
+        auto serves = countEdgesOf(env, player, 101).edges;
+        EXPECT_LT(0, serves);
+        runTask(env, {"edge:101"});
+        EXPECT_EQ(0, countEdgesOf(env, player, 101).edges);
+        EXPECT_EQ(0, countEdgesOf(env, player, -101).edges);
+        EXPECT_EQ(teammates, countEdgesOf(env, player, 102).edges);
+        EXPECT_EQ(before.vertices, countKeys(env, NebulaKeyType::kData).vertices);
+    }
+    auto remaining = countKeys(env, NebulaKeyType::kEdge).edges;
+    EXPECT_GT(before.edges, remaining);
+    {
+        // Move the edges back
+        FLAGS_separate_edge_key = false;
+        runTask(env, {"edge_key"});
+        expectLayout(EdgeKeyLayout());
+        auto data = countKeys(env, NebulaKeyType::kData);
+        EXPECT_EQ(before.vertices, data.vertices);
+        EXPECT_EQ(remaining, data.edges);
+        EXPECT_EQ(0, countKeys(env, NebulaKeyType::kEdge).edges);
+        EXPECT_EQ(teammates, countEdgesOf(env, player, 102).edges);
+    }
+    NebulaKeyUtils::removeEdgeKeyLayout(1);
+}
+
+TEST(ConvertEdgeKeyTest, WritesDuringConversionTest) {
+    gflags::FlagSaver flagSaver;
+    fs::TempDir rootPath("/tmp/ConvertEdgeKeyTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    NebulaKeyUtils::removeEdgeKeyLayout(1);
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, 6));
+    ASSERT_TRUE(QueryTestUtils::mockEdgeData(env, 6));
+    auto before = countKeys(env, NebulaKeyType::kData);
+    VertexID player = "Tim Duncan";
+    auto teammates = countEdgesOf(env, player, 102).edges;
+    EXPECT_LT(0, teammates);
+
+    // The parts are being converted, so the new edges are written with the new type
+    EdgeKeyLayout converting;
+    converting.type = NebulaKeyType::kEdge;
+    converting.converted = false;
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        NebulaKeyUtils::setEdgeKeyLayout(1, partId, converting);
+    }
+
+    // Overwrite an edge not moved yet, with the same version
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    PartitionID partId = std::hash<std::string>()(player) % 6 + 1;
+    std::string edgeKey;
+    {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::edgePrefix(vIdLen, partId, player, 102);
+        ASSERT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        ASSERT_TRUE(iter->valid());
+        edgeKey = NebulaKeyUtils::toEdgeKeyType(iter->key(), NebulaKeyType::kEdge);
+    }
+    folly::Baton<true, std::atomic> baton;
+    std::vector<kvstore::KV> data;
+    data.emplace_back(edgeKey, "updated");
+    env->kvstore_->asyncMultiPut(1, partId, std::move(data), [&] (kvstore::ResultCode code) {
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+
+    // The edges of both types are read, and each edge once
+    auto count = countEdgesOf(env, player, 102);
+    EXPECT_EQ(teammates, count.edges);
+    EXPECT_EQ(teammates + 1, count.keys);
+
+    FLAGS_separate_edge_key = true;
+    runTask(env, {"edge_key"});
+    EdgeKeyLayout separated;
+    separated.type = NebulaKeyType::kEdge;
+    expectLayout(separated);
+
+    // The stale edge is removed instead of overwriting the new one
+    EXPECT_EQ(0, countKeys(env, NebulaKeyType::kData).edges);
+    EXPECT_EQ(before.edges, countKeys(env, NebulaKeyType::kEdge).edges);
+    count = countEdgesOf(env, player, 102);
+    EXPECT_EQ(teammates, count.edges);
+    EXPECT_EQ(teammates, count.keys);
+    std::string val;
+    ASSERT_EQ(kvstore::ResultCode::SUCCEEDED, env->kvstore_->get(1, partId, edgeKey, &val));
+    EXPECT_EQ("updated", val);
+    NebulaKeyUtils::removeEdgeKeyLayout(1);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+#include "storage/admin/AdminTask.h"
+#include "storage/admin/DropSchemaDataTask.h"
+#include "storage/test/QueryTestUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+// The number of the rows of a tag, or of an edge type in both directions
+size_t countRows(StorageEnv* env, bool isEdge, SchemaID id) {
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    size_t count = 0;
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::partPrefix(partId);
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        for (; iter->valid(); iter->next()) {
+            auto key = iter->key();
+            if (isEdge) {
+                if (NebulaKeyUtils::isEdge(vIdLen, key) &&
+                    std::abs(NebulaKeyUtils::getEdgeType(vIdLen, key)) == id) {
+                    count++;
+                }
+            } else if (NebulaKeyUtils::isVertex(vIdLen, key) &&
+                       NebulaKeyUtils::getTagId(vIdLen, key) == id) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+TaskContext dropContext(kvstore::KVStore* store, std::vector<std::string> paras) {
+    cpp2::AddAdminTaskRequest req;
+    req.set_cmd(nebula::meta::cpp2::AdminCmd::COMPACT);
+    req.set_job_id(1);
+    req.set_task_id(1);
+    cpp2::TaskPara para;
+    para.set_space_id(1);
+    para.set_task_specfic_paras(std::move(paras));
+    req.set_para(std::move(para));
+    return TaskContext(req, store, [] (cpp2::ErrorCode) {});
+}
+
+TEST(DropSchemaDataTest, DropTagAndEdgeTest) {
+    fs::TempDir rootPath("/tmp/DropSchemaDataTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, 6));
+    ASSERT_TRUE(QueryTestUtils::mockEdgeData(env, 6));
+
+    auto players = countRows(env, false, 1);
+    auto teammates = countRows(env, true, 102);
+    EXPECT_LT(0, countRows(env, false, 2));
+    EXPECT_LT(0, countRows(env, true, 101));
+
+    // A compaction task is created for the other parameters
+    auto compact = AdminTaskFactory::createAdminTask(env, dropContext(env->kvstore_, {"data"}));
+    EXPECT_EQ(nullptr, std::dynamic_pointer_cast<DropSchemaDataTask>(compact));
+    auto invalid = AdminTaskFactory::createAdminTask(env, dropContext(env->kvstore_,
+                                                                      {"tag:team"}));
+    ASSERT_NE(nullptr, std::dynamic_pointer_cast<DropSchemaDataTask>(invalid));
+    auto ret = invalid->genSubTasks();
+    ASSERT_FALSE(nebula::ok(ret));
+    EXPECT_EQ(cpp2::ErrorCode::E_INVALID_TASK_PARA, nebula::error(ret));
+
+    // Drop the tag team and the edge serve
+    auto task = AdminTaskFactory::createAdminTask(env, dropContext(env->kvstore_,
+                                                                   {"tag:2", "edge:101"}));
+    ASSERT_NE(nullptr, std::dynamic_pointer_cast<DropSchemaDataTask>(task));
+    auto subTasks = task->genSubTasks();
+    ASSERT_TRUE(nebula::ok(subTasks));
+    EXPECT_EQ(6, nebula::value(subTasks).size());
+
+    // The schemas are marked as dropped before the rows are removed
+    auto* dropped = DroppedSchemas::instance();
+    EXPECT_TRUE(dropped->isTagDropped(1, 2));
+    EXPECT_TRUE(dropped->isEdgeDropped(1, 101));
+    EXPECT_TRUE(dropped->isEdgeDropped(1, -101));
+    EXPECT_FALSE(dropped->isTagDropped(1, 1));
+    EXPECT_FALSE(dropped->isEdgeDropped(1, 102));
+    EXPECT_FALSE(dropped->isTagDropped(2, 2));
+
+    for (auto& subTask : nebula::value(subTasks)) {
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, subTask.invoke());
+    }
+    EXPECT_EQ(0, countRows(env, false, 2));
+    EXPECT_EQ(0, countRows(env, true, 101));
+    EXPECT_EQ(players, countRows(env, false, 1));
+    EXPECT_EQ(teammates, countRows(env, true, 102));
+
+    // The schemas are unmarked once the task finishes
+    task->finish();
+    EXPECT_FALSE(dropped->isTagDropped(1, 2));
+    EXPECT_FALSE(dropped->isEdgeDropped(1, 101));
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
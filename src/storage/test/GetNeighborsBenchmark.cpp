@@ -6,12 +6,15 @@
 
 #include <gtest/gtest.h>
 #include <folly/Benchmark.h>
+#include "common/algorithm/ReservoirSampling.h"
 #include "common/fs/TempDir.h"
+#include "storage/exec/StreamingSampler.h"
 #include "storage/query/GetNeighborsProcessor.h"
 #include "storage/test/QueryTestUtils.h"
 
 DEFINE_uint64(max_rank, 1000, "max rank of each edge");
 DEFINE_double(filter_ratio, 0.5, "ratio of data would pass filter");
+DEFINE_int64(sample_limit, 100, "number of edges sampled of each vertex");
 
 std::unique_ptr<nebula::mock::MockCluster> gCluster;
 
@@ -92,6 +95,66 @@ void goFilter(int32_t iters,
     }
 }
 
+void goSample(int32_t iters,
+              const std::vector<nebula::VertexID>& vertex,
+              const std::vector<std::string>& playerProps,
+              const std::vector<std::string>& serveProps) {
+    nebula::storage::cpp2::GetNeighborsRequest req;
+    BENCHMARK_SUSPEND {
+        req = nebula::storage::buildRequest(vertex, playerProps, serveProps);
+        req.traverse_spec.set_limit(FLAGS_sample_limit);
+        req.traverse_spec.set_random(true);
+    }
+    auto* env = gCluster->storageEnv_.get();
+    for (decltype(iters) i = 0; i < iters; i++) {
+        auto* processor = nebula::storage::GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+    }
+}
+
+// Sample the serve edges of one vertex straight from the kvstore, to compare copying every
+// edge into the reservoir with deciding before copying
+void sampleEdges(int32_t iters, const nebula::VertexID& vId, bool streaming) {
+    nebula::GraphSpaceID spaceId = 1;
+    nebula::EdgeType serve = 101;
+    auto* env = gCluster->storageEnv_.get();
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+    auto partId = std::hash<std::string>()(vId) % gCluster->getTotalParts() + 1;
+    auto prefix = nebula::NebulaKeyUtils::edgePrefix(vIdLen, partId, vId, serve);
+    using Sample = std::tuple<nebula::EdgeType, std::string, std::string, size_t>;
+    nebula::storage::StreamingSampler<Sample> streamingSampler(FLAGS_sample_limit);
+    size_t sampled = 0;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        std::unique_ptr<nebula::kvstore::KVIterator> iter;
+        CHECK_EQ(nebula::kvstore::ResultCode::SUCCEEDED,
+                 env->kvstore_->prefix(spaceId, partId, prefix, &iter));
+        if (streaming) {
+            streamingSampler.reset(i);
+            for (; iter->valid(); iter->next()) {
+                auto idx = streamingSampler.offer();
+                if (idx < 0) {
+                    continue;
+                }
+                auto& sample = streamingSampler.slot(idx);
+                std::get<0>(sample) = serve;
+                std::get<1>(sample).assign(iter->val().data(), iter->val().size());
+                std::get<2>(sample).assign(iter->key().data(), iter->key().size());
+                std::get<3>(sample) = 0;
+            }
+            sampled += streamingSampler.size();
+        } else {
+            nebula::algorithm::ReservoirSampling<Sample> sampler(FLAGS_sample_limit);
+            for (; iter->valid(); iter->next()) {
+                sampler.sampling(std::make_tuple(serve, iter->val().str(), iter->key().str(), size_t(0)));
+            }
+            sampled += std::move(sampler).samples().size();
+        }
+    }
+    folly::doNotOptimizeAway(sampled);
+}
+
 // Players may serve more than one team, the total edges = teamCount * maxRank, which would effect
 // the final result, so select some player only serve one team
 BENCHMARK(OneVertexOneProperty, iters) {
@@ -143,6 +206,26 @@ BENCHMARK_RELATIVE(TenVertexThreePropertyWithFilter, iters) {
         {nebula::kDst, "startYear", "endYear"});
 }
 
+BENCHMARK(OneVertexSample, iters) {
+    goSample(iters, {"Tim Duncan"}, {"name"}, {"teamName", "startYear"});
+}
+
+BENCHMARK(TenVertexSample, iters) {
+    goSample(iters,
+             {"Tim Duncan", "Kobe Bryant", "Stephen Curry", "Manu Ginobili", "Joel Embiid",
+              "Giannis Antetokounmpo", "Yao Ming", "Damian Lillard", "Dirk Nowitzki",
+              "Klay Thompson"},
+             {"name"},
+             {"teamName", "startYear"});
+}
+
+BENCHMARK(CopyEverySampleEdges, iters) {
+    sampleEdges(iters, "Tim Duncan", false);
+}
+BENCHMARK_RELATIVE(StreamingSampleEdges, iters) {
+    sampleEdges(iters, "Tim Duncan", true);
+}
+
 int main(int argc, char** argv) {
     folly::init(&argc, &argv, true);
     nebula::fs::TempDir rootPath("/tmp/GetNeighborsBenchmark.XXXXXX");
@@ -7,7 +7,9 @@
 #include "common/base/Base.h"
 #include "common/fs/TempDir.h"
 #include <gtest/gtest.h>
+#include <folly/json.h>
 #include "storage/query/GetNeighborsProcessor.h"
+#include "storage/StorageFlags.h"
 #include "storage/test/QueryTestUtils.h"
 
 namespace nebula {
@@ -668,6 +670,252 @@ TEST(GetNeighborsTest, LimitSampleTest) {
     }
 }
 
+// Builds the contexts of a request without running it, to tell which edge types are scanned
+// by the keys only
+class KeyOnlyChecker final : public GetNeighborsProcessor {
+public:
+    explicit KeyOnlyChecker(StorageEnv* env)
+        : GetNeighborsProcessor(env, nullptr, nullptr, nullptr) {}
+
+    std::unordered_map<EdgeType, bool> keyOnly(const cpp2::GetNeighborsRequest& req) {
+        std::unordered_map<EdgeType, bool> result;
+        spaceId_ = req.get_space_id();
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, getSpaceVidLen(spaceId_));
+        planContext_ = std::make_unique<PlanContext>(env_, spaceId_, spaceVidLen_);
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, checkAndBuildContexts(req));
+        bool random = req.traverse_spec.__isset.random && req.traverse_spec.random;
+        for (const auto& ec : edgeContext_.propContexts_) {
+            result[ec.first] = isKeyOnly(ec.second, random);
+        }
+        return result;
+    }
+};
+
+// The calls and rows of the nodes in the latest profile, by the name of the node
+std::unordered_map<std::string, std::pair<int64_t, int64_t>> latestNodes() {
+    std::unordered_map<std::string, std::pair<int64_t, int64_t>> nodes;
+    auto profile = folly::parseJson(QueryProfile::latest())[0];
+    for (const auto& node : profile["nodes"]) {
+        nodes[node["name"].asString()] = {node["calls"].asInt(), node["rows"].asInt()};
+    }
+    return nodes;
+}
+
+TEST(GetNeighborsTest, KeyOnlyTest) {
+    gflags::FlagSaver flagSaver;
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    TagID player = 1;
+    TagID team = 2;
+    EdgeType serve = 101;
+    EdgeType teammate = 102;
+    int64_t serveCount = std::count_if(mock::MockData::serves_.begin(),
+                                       mock::MockData::serves_.end(),
+                                       [] (const auto& s) { return s.teamName_ == "Spurs"; });
+
+    auto degreeRequest = [&] (std::vector<std::string> props,
+                              cpp2::StatType statType = cpp2::StatType::COUNT) {
+        std::vector<VertexID> vertices = {"Spurs"};
+        std::vector<EdgeType> over = {-serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(team, std::vector<std::string>{"name"});
+        edges.emplace_back(-serve, std::move(props));
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        std::vector<cpp2::StatProp> statProps;
+        {
+            cpp2::StatProp statProp;
+            statProp.set_alias("Stat of players");
+            EdgePropertyExpression exp(new std::string(folly::to<std::string>(-serve)),
+                                       new std::string(statType == cpp2::StatType::COUNT
+                                                       ? "playerName" : "startYear"));
+            statProp.set_prop(Expression::encode(exp));
+            statProp.stat = statType;
+            statProps.emplace_back(std::move(statProp));
+        }
+        req.traverse_spec.stat_props = std::move(statProps);
+        return req;
+    };
+    auto limitRequest = [&] (int64_t limit) {
+        std::vector<VertexID> vertices = {"Dwyane Wade"};
+        std::vector<EdgeType> over = {serve, teammate};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(player, std::vector<std::string>{"name"});
+        edges.emplace_back(serve, std::vector<std::string>{kDst});
+        edges.emplace_back(teammate, std::vector<std::string>{kDst});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        req.traverse_spec.set_limit(limit);
+        return req;
+    };
+    auto run = [&] (const cpp2::GetNeighborsRequest& req) {
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        processor->enableProfile();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        return std::move(fut).get();
+    };
+
+    {
+        LOG(INFO) << "CountWithoutProps";
+        auto req = degreeRequest({kDst});
+        EXPECT_TRUE(KeyOnlyChecker(env).keyOnly(req)[-serve]);
+        auto resp = run(req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(1, resp.vertices.rows.size());
+        // vId, stat, team, -serve, expr
+        const auto& row = resp.vertices.rows[0];
+        ASSERT_EQ(5, row.values.size());
+        ASSERT_EQ(serveCount, row.values[1].getList().values[0].getInt());
+        const auto& cell = row.values[3].getList();
+        ASSERT_EQ(serveCount, cell.values.size());
+        std::unordered_set<std::string> players;
+        for (const auto& edge : cell.values) {
+            players.emplace(edge.getList().values[0].getStr());
+        }
+        for (const auto& s : mock::MockData::serves_) {
+            if (s.teamName_ == "Spurs") {
+                ASSERT_EQ(1, players.count(s.playerName_));
+            }
+        }
+    }
+    {
+        LOG(INFO) << "CountWithProps";
+        auto req = degreeRequest({kDst, "playerName"});
+        EXPECT_FALSE(KeyOnlyChecker(env).keyOnly(req)[-serve]);
+        auto resp = run(req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(1, resp.vertices.rows.size());
+        const auto& row = resp.vertices.rows[0];
+        ASSERT_EQ(serveCount, row.values[1].getList().values[0].getInt());
+        const auto& cell = row.values[3].getList();
+        ASSERT_EQ(serveCount, cell.values.size());
+        for (const auto& edge : cell.values) {
+            ASSERT_EQ(edge.getList().values[0], edge.getList().values[1]);
+        }
+    }
+    {
+        LOG(INFO) << "NotKeyOnly";
+        // Any stat other than COUNT reads the value
+        EXPECT_FALSE(KeyOnlyChecker(env).keyOnly(degreeRequest({kDst}, cpp2::StatType::SUM))
+                     [-serve]);
+
+        // So does a filter
+        auto req = limitRequest(0);
+        RelationalExpression exp(
+            Expression::Kind::kRelGT,
+            new EdgePropertyExpression(new std::string(folly::to<std::string>(serve)),
+                                       new std::string("startYear")),
+            new ConstantExpression(Value(2000)));
+        req.traverse_spec.set_filter(Expression::encode(exp));
+        auto keyOnly = KeyOnlyChecker(env).keyOnly(req);
+        EXPECT_FALSE(keyOnly[serve]);
+        EXPECT_FALSE(keyOnly[teammate]);
+
+        // And the sample weighted by a prop
+        req = limitRequest(3);
+        req.traverse_spec.set_random(true);
+        keyOnly = KeyOnlyChecker(env).keyOnly(req);
+        EXPECT_TRUE(keyOnly[serve]);
+        EXPECT_TRUE(keyOnly[teammate]);
+        FLAGS_random_sample_weight_prop = "startYear";
+        EXPECT_FALSE(KeyOnlyChecker(env).keyOnly(req)[serve]);
+    }
+    {
+        LOG(INFO) << "LimitAcrossTypes";
+        auto keyOnly = KeyOnlyChecker(env).keyOnly(limitRequest(5));
+        EXPECT_TRUE(keyOnly[serve]);
+        EXPECT_TRUE(keyOnly[teammate]);
+
+        // vId, stat, player, serve, teammate, expr
+        // Dwyane Wade has 4 serve edge, 2 teammate edge, the limit stops in teammate
+        auto resp = run(limitRequest(5));
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(1, resp.vertices.rows.size());
+        ASSERT_EQ(6, resp.vertices.rows[0].values.size());
+        ASSERT_EQ(4, resp.vertices.rows[0].values[3].getList().values.size());
+        ASSERT_EQ(1, resp.vertices.rows[0].values[4].getList().values.size());
+        // Both types are opened, and no edge is read after the limit
+        auto nodes = latestNodes();
+        ASSERT_EQ(2, nodes["SingleEdgeNode"].first);
+        ASSERT_EQ(2, nodes["SingleEdgeNode"].second);
+        ASSERT_EQ(5, nodes["HashJoinNode"].second);
+        ASSERT_EQ(5, nodes["GetNeighborsNode"].second);
+
+        // The limit is reached in serve, so teammate is executed but never opened
+        resp = run(limitRequest(4));
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(4, resp.vertices.rows[0].values[3].getList().values.size());
+        ASSERT_EQ(Value::Type::NULLVALUE, resp.vertices.rows[0].values[4].type());
+        nodes = latestNodes();
+        ASSERT_EQ(2, nodes["SingleEdgeNode"].first);
+        ASSERT_EQ(1, nodes["SingleEdgeNode"].second);
+        ASSERT_EQ(4, nodes["HashJoinNode"].second);
+        ASSERT_EQ(4, nodes["GetNeighborsNode"].second);
+    }
+}
+
+TEST(GetNeighborsTest, StableSampleTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    TagID team = 2;
+    EdgeType serve = 101;
+    auto sample = [&] () {
+        std::vector<VertexID> vertices = {"Spurs", "Lakers"};
+        std::vector<EdgeType> over = {-serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(team, std::vector<std::string>{"name"});
+        edges.emplace_back(-serve, std::vector<std::string>{"playerName", "startYear"});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        req.traverse_spec.set_limit(3);
+        req.traverse_spec.set_random(true);
+
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(2, resp.vertices.rows.size());
+        std::map<std::string, nebula::List> result;
+        for (const auto& row : resp.vertices.rows) {
+            // vId, stat, team, -serve, expr
+            EXPECT_EQ(3, row.values[3].getList().values.size());
+            result.emplace(row.values[0].getStr(), row.values[3].getList());
+        }
+        return result;
+    };
+
+    {
+        LOG(INFO) << "The same seed samples the same edges";
+        FLAGS_random_sample_seed = 2020;
+        auto first = sample();
+        auto second = sample();
+        EXPECT_EQ(first, second);
+    }
+    {
+        LOG(INFO) << "Weighted sample";
+        FLAGS_random_sample_weight_prop = "startYear";
+        auto first = sample();
+        auto second = sample();
+        EXPECT_EQ(first, second);
+    }
+    FLAGS_random_sample_seed = 0;
+    FLAGS_random_sample_weight_prop = "";
+}
+
 TEST(GetNeighborsTest, VertexCacheTest) {
     fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
     mock::MockCluster cluster;
@@ -676,7 +924,7 @@ TEST(GetNeighborsTest, VertexCacheTest) {
     auto totalParts = cluster.getTotalParts();
     ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
     ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
-    VertexCache vertexCache(1000, 4);
+    VertexCache vertexCache(1 << 20, 4);
 
     TagID player = 1;
     EdgeType serve = 101;
@@ -716,6 +964,8 @@ TEST(GetNeighborsTest, VertexCacheTest) {
         ASSERT_EQ(0, resp.result.failed_parts.size());
         // vId, stat, player, serve, expr
         QueryTestUtils::checkResponse(resp.vertices, vertices, over, tags, edges, 1, 5);
+        // the tag of Tim Duncan is filled by the first request
+        EXPECT_EQ(1, vertexCache.hits());
     }
 }
 
@@ -1134,6 +1384,98 @@ TEST(GetNeighborsTest, MultiVersionTest) {
     }
 }
 
+TEST(GetNeighborsTest, SeekOldVersionTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts, 10));
+
+    // Step over the first old version, then seek to the next edge
+    FLAGS_edge_versions_to_seek = 1;
+    {
+        LOG(INFO) << "GoFromPlayerOverAll";
+        std::vector<VertexID> vertices = {"Tim Duncan"};
+        std::vector<EdgeType> over = {};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        req.traverse_spec.edge_direction = cpp2::EdgeDirection::BOTH;
+
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        // vId, stat, player, team, general tag, - teammate, - serve, + serve, + teammate, expr
+        QueryTestUtils::checkResponse(resp.vertices, vertices, 1, 10);
+    }
+    FLAGS_edge_versions_to_seek = 8;
+}
+
+TEST(GetNeighborsTest, ProfileTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts, 3));
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    std::vector<VertexID> vertices = {"Tim Duncan"};
+    std::vector<EdgeType> over = {serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(player, std::vector<std::string>{"name"});
+    edges.emplace_back(serve, std::vector<std::string>{"teamName"});
+    auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+    int64_t serveCount = std::count_if(mock::MockData::serves_.begin(),
+                                       mock::MockData::serves_.end(),
+                                       [] (const auto& s) { return s.playerName_ == "Tim Duncan"; });
+
+    {
+        LOG(INFO) << "Not sampled";
+        auto before = folly::parseJson(QueryProfile::latest()).size();
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(before, folly::parseJson(QueryProfile::latest()).size());
+    }
+    {
+        LOG(INFO) << "Profiled";
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        processor->enableProfile();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        QueryTestUtils::checkResponse(resp.vertices, vertices, over, tags, edges, 1, 5);
+
+        auto profile = folly::parseJson(QueryProfile::latest())[0];
+        ASSERT_EQ("get_neighbors", profile["method"].asString());
+        // two old versions of each edge
+        ASSERT_EQ(2 * serveCount, profile["versions_skipped"].asInt());
+        std::unordered_map<std::string, int64_t> rows;
+        for (const auto& node : profile["nodes"]) {
+            ASSERT_EQ(1, node["calls"].asInt());
+            rows[node["name"].asString()] = node["rows"].asInt();
+        }
+        ASSERT_EQ(1, rows["TagNode"]);
+        ASSERT_EQ(1, rows["SingleEdgeNode"]);
+        ASSERT_EQ(serveCount, rows["HashJoinNode"]);
+        ASSERT_EQ(serveCount, rows["FilterNode"]);
+        ASSERT_EQ(serveCount, rows["GetNeighborsNode"]);
+        ASSERT_TRUE(profile["rocksdb"].count("block_cache_hits"));
+    }
+}
+
 TEST(GetNeighborsTest, FilterTest) {
     fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
     mock::MockCluster cluster;
@@ -0,0 +1,126 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <folly/Benchmark.h>
+#include <folly/Random.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include "mock/MockCluster.h"
+#include "storage/kv/PutProcessor.h"
+#include "storage/kv/GetProcessor.h"
+
+DEFINE_int32(total_keys, 100000, "The number of keys in the space");
+DEFINE_int32(value_size, 100, "The size of each value");
+DEFINE_int32(get_threads, 8, "The number of threads to run the parts of a get");
+
+std::unique_ptr<nebula::mock::MockCluster> gCluster;
+std::unique_ptr<folly::CPUThreadPoolExecutor> gExecutor;
+
+namespace nebula {
+namespace storage {
+
+const GraphSpaceID kSpace = 1;
+
+std::string keyOf(int32_t i) {
+    return folly::stringPrintf("feature_%08d", i);
+}
+
+PartitionID partOf(const std::string& key) {
+    return std::hash<std::string>()(key) % gCluster->getTotalParts() + 1;
+}
+
+void setUp(const char* path) {
+    gCluster = std::make_unique<nebula::mock::MockCluster>();
+    gCluster->initStorageKV(path);
+    gExecutor = std::make_unique<folly::CPUThreadPoolExecutor>(FLAGS_get_threads);
+    auto* env = gCluster->storageEnv_.get();
+
+    const int32_t batch = 1000;
+    for (int32_t start = 0; start < FLAGS_total_keys; start += batch) {
+        cpp2::KVPutRequest req;
+        req.set_space_id(kSpace);
+        std::unordered_map<PartitionID, std::vector<nebula::KeyValue>> data;
+        for (int32_t i = start; i < std::min(start + batch, FLAGS_total_keys); i++) {
+            nebula::KeyValue pair;
+            pair.key = keyOf(i);
+            pair.value = std::string(FLAGS_value_size, 'v');
+            data[partOf(pair.key)].emplace_back(std::move(pair));
+        }
+        req.set_parts(std::move(data));
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        CHECK(resp.result.failed_parts.empty());
+    }
+}
+
+cpp2::KVGetRequest buildRequest(int32_t num) {
+    cpp2::KVGetRequest req;
+    req.set_space_id(kSpace);
+    req.set_return_partly(true);
+    std::unordered_map<PartitionID, std::vector<std::string>> keys;
+    for (int32_t i = 0; i < num; i++) {
+        auto key = keyOf(folly::Random::rand32(FLAGS_total_keys));
+        auto partId = partOf(key);
+        keys[partId].emplace_back(std::move(key));
+    }
+    req.set_parts(std::move(keys));
+    return req;
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+void get(int32_t iters, int32_t num, bool parallel) {
+    std::vector<nebula::storage::cpp2::KVGetRequest> reqs;
+    BENCHMARK_SUSPEND {
+        for (decltype(iters) i = 0; i < iters; i++) {
+            reqs.emplace_back(nebula::storage::buildRequest(num));
+        }
+    }
+    auto* env = gCluster->storageEnv_.get();
+    auto* executor = parallel ? gExecutor.get() : nullptr;
+    for (const auto& req : reqs) {
+        auto* processor = nebula::storage::GetProcessor::instance(env, nullptr, executor);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        folly::doNotOptimizeAway(resp);
+    }
+}
+
+BENCHMARK(Get50Keys, iters) {
+    get(iters, 50, false);
+}
+BENCHMARK_RELATIVE(Get50KeysInParallel, iters) {
+    get(iters, 50, true);
+}
+
+BENCHMARK(Get500Keys, iters) {
+    get(iters, 500, false);
+}
+BENCHMARK_RELATIVE(Get500KeysInParallel, iters) {
+    get(iters, 500, true);
+}
+
+BENCHMARK(Get5000Keys, iters) {
+    get(iters, 5000, false);
+}
+BENCHMARK_RELATIVE(Get5000KeysInParallel, iters) {
+    get(iters, 5000, true);
+}
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    nebula::fs::TempDir rootPath("/tmp/KVBenchmark.XXXXXX");
+    nebula::storage::setUp(rootPath.path());
+    folly::runBenchmarks();
+    gExecutor.reset();
+    gCluster.reset();
+    return 0;
+}
@@ -16,6 +16,12 @@
 #include "storage/kv/PutProcessor.h"
 #include "storage/kv/GetProcessor.h"
 #include "storage/kv/RemoveProcessor.h"
+#include "storage/kv/ScanProcessor.h"
+#include "storage/kv/IncrProcessor.h"
+#include "storage/kv/CasProcessor.h"
+#include "storage/kv/KVValueUtils.h"
+#include "storage/StorageFlags.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 DECLARE_string(meta_server_addrs);
 DECLARE_int32(heartbeat_interval_secs);
@@ -23,6 +29,13 @@ DECLARE_int32(heartbeat_interval_secs);
 namespace nebula {
 namespace storage {
 
+nebula::KeyValue kvPair(std::string key, std::string value) {
+    nebula::KeyValue pair;
+    pair.key = std::move(key);
+    pair.value = std::move(value);
+    return pair;
+}
+
 TEST(KVTest, SimpleTest) {
     fs::TempDir rootPath("/tmp/KVSimpleTest.XXXXXX");
     mock::MockCluster cluster;
@@ -51,8 +64,8 @@ TEST(KVTest, SimpleTest) {
                                               folly::stringPrintf("key_%ld", part));
             std::string value;
             auto code = cluster.storageKV_->get(space, part, key, &value);
-            EXPECT_EQ(folly::stringPrintf("value_%ld", part), value);
             EXPECT_EQ(nebula::kvstore::SUCCEEDED, code);
+            EXPECT_EQ(folly::stringPrintf("value_%ld", part), KVValueUtils::getValue(value));
         }
     }
     {
@@ -73,6 +86,363 @@ TEST(KVTest, SimpleTest) {
     }
 }
 
+TEST(KVTest, ParallelGetTest) {
+    fs::TempDir rootPath("/tmp/KVParallelGetTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const GraphSpaceID space = 1;
+    const int32_t totalParts = 6;
+    const int32_t keysPerPart = 100;
+    {
+        cpp2::KVPutRequest req;
+        req.set_space_id(space);
+        std::unordered_map<PartitionID, std::vector<nebula::KeyValue>> data;
+        for (PartitionID part = 1; part <= totalParts; part++) {
+            for (int32_t i = 0; i < keysPerPart; i++) {
+                nebula::KeyValue pair;
+                pair.key = folly::stringPrintf("key_%d_%d", part, i);
+                pair.value = folly::stringPrintf("value_%d_%d", part, i);
+                data[part].emplace_back(std::move(pair));
+            }
+        }
+        req.set_parts(std::move(data));
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+
+    // Every part asks for some keys which don't exist, in reverse order
+    cpp2::KVGetRequest req;
+    req.set_space_id(space);
+    req.set_return_partly(true);
+    std::unordered_map<PartitionID, std::vector<std::string>> keys;
+    for (PartitionID part = 1; part <= totalParts; part++) {
+        for (int32_t i = keysPerPart + 10; i >= 0; i--) {
+            keys[part].emplace_back(folly::stringPrintf("key_%d_%d", part, i));
+        }
+    }
+    req.set_parts(std::move(keys));
+
+    gflags::FlagSaver flagSaver;
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(4);
+    for (uint32_t keysPerTask : {1, 64, 10000}) {
+        FLAGS_kv_get_keys_per_task = keysPerTask;
+        for (auto* pool : {static_cast<folly::Executor*>(nullptr),
+                           static_cast<folly::Executor*>(executor.get())}) {
+            auto* processor = GetProcessor::instance(env, nullptr, pool);
+            auto fut = processor->getFuture();
+            processor->process(req);
+            auto resp = std::move(fut).get();
+            EXPECT_EQ(0, resp.result.failed_parts.size());
+            ASSERT_EQ(totalParts * keysPerPart, resp.key_values.size());
+            for (PartitionID part = 1; part <= totalParts; part++) {
+                for (int32_t i = 0; i < keysPerPart; i++) {
+                    auto it = resp.key_values.find(folly::stringPrintf("key_%d_%d", part, i));
+                    ASSERT_NE(resp.key_values.end(), it);
+                    EXPECT_EQ(folly::stringPrintf("value_%d_%d", part, i), it->second);
+                }
+            }
+        }
+    }
+
+    // Without return_partly, all parts fail because some keys are missing
+    req.set_return_partly(false);
+    auto* processor = GetProcessor::instance(env, nullptr, executor.get());
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(totalParts, resp.result.failed_parts.size());
+    EXPECT_EQ(0, resp.key_values.size());
+}
+
+TEST(KVTest, TtlTest) {
+    fs::TempDir rootPath("/tmp/KVTtlTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const GraphSpaceID space = 1;
+    {
+        KVTtlPutRequest req;
+        req.space_id = space;
+        req.parts[1].emplace_back(KVTtlPair{"short", "short_value", 1});
+        req.parts[1].emplace_back(KVTtlPair{"forever", "forever_value", 0});
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    auto get = [&] () {
+        cpp2::KVGetRequest req;
+        req.set_space_id(space);
+        req.set_return_partly(true);
+        std::unordered_map<PartitionID, std::vector<std::string>> keys;
+        keys[1] = {"short", "forever"};
+        req.set_parts(std::move(keys));
+        auto* processor = GetProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        return std::move(fut).get();
+    };
+    {
+        auto resp = get();
+        ASSERT_EQ(2, resp.key_values.size());
+        EXPECT_EQ("short_value", resp.key_values["short"]);
+        EXPECT_EQ("forever_value", resp.key_values["forever"]);
+    }
+    sleep(2);
+    {
+        auto resp = get();
+        ASSERT_EQ(1, resp.key_values.size());
+        EXPECT_EQ("forever_value", resp.key_values["forever"]);
+    }
+    {
+        // The expired key is invisible to scan as well
+        KVScanRequest req;
+        req.space_id = space;
+        req.part_id = 1;
+        auto* processor = ScanProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(1, resp.key_values.size());
+        EXPECT_EQ("forever", resp.key_values[0].key);
+        EXPECT_FALSE(resp.next_cursor.hasValue());
+    }
+}
+
+TEST(KVTest, ScanTest) {
+    fs::TempDir rootPath("/tmp/KVScanTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const GraphSpaceID space = 1;
+    const PartitionID partId = 1;
+    {
+        cpp2::KVPutRequest req;
+        req.set_space_id(space);
+        std::unordered_map<PartitionID, std::vector<nebula::KeyValue>> data;
+        for (int32_t i = 0; i < 50; i++) {
+            for (auto* prefix : {"a_", "b_"}) {
+                nebula::KeyValue pair;
+                pair.key = folly::stringPrintf("%s%02d", prefix, i);
+                pair.value = folly::stringPrintf("value_%s%02d", prefix, i);
+                data[partId].emplace_back(std::move(pair));
+            }
+        }
+        // The keys of another part are never returned
+        data[partId + 1].emplace_back(kvPair("a_other", "value"));
+        req.set_parts(std::move(data));
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    // Scan all the keys with the prefix page by page
+    auto scanAll = [&] (KVScanRequest req) {
+        std::vector<nebula::KeyValue> kvs;
+        while (true) {
+            auto* processor = ScanProcessor::instance(env, nullptr);
+            auto fut = processor->getFuture();
+            processor->process(req);
+            auto resp = std::move(fut).get();
+            EXPECT_EQ(0, resp.result.failed_parts.size());
+            EXPECT_LE(resp.key_values.size(), static_cast<size_t>(req.limit));
+            kvs.insert(kvs.end(), resp.key_values.begin(), resp.key_values.end());
+            if (!resp.next_cursor.hasValue()) {
+                break;
+            }
+            req.cursor = resp.next_cursor;
+        }
+        return kvs;
+    };
+    {
+        KVScanRequest req;
+        req.space_id = space;
+        req.part_id = partId;
+        req.prefix = "b_";
+        req.limit = 7;
+        auto kvs = scanAll(req);
+        ASSERT_EQ(50, kvs.size());
+        for (int32_t i = 0; i < 50; i++) {
+            EXPECT_EQ(folly::stringPrintf("b_%02d", i), kvs[i].key);
+            EXPECT_EQ(folly::stringPrintf("value_b_%02d", i), kvs[i].value);
+        }
+    }
+    {
+        KVScanRequest req;
+        req.space_id = space;
+        req.part_id = partId;
+        req.start = "a_40";
+        req.end = "b_10";
+        req.limit = 3;
+        auto kvs = scanAll(req);
+        ASSERT_EQ(20, kvs.size());
+        EXPECT_EQ("a_40", kvs.front().key);
+        EXPECT_EQ("b_09", kvs.back().key);
+    }
+    {
+        KVScanRequest req;
+        req.space_id = space;
+        req.part_id = partId;
+        req.limit = 0;
+        auto* processor = ScanProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(1, resp.result.failed_parts.size());
+    }
+}
+
+TEST(KVTest, IncrTest) {
+    fs::TempDir rootPath("/tmp/KVIncrTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const GraphSpaceID space = 1;
+    const int32_t totalParts = 6;
+    {
+        cpp2::KVPutRequest req;
+        req.set_space_id(space);
+        std::unordered_map<PartitionID, std::vector<nebula::KeyValue>> data;
+        data[1].emplace_back(kvPair("counter_1", "100"));
+        data[2].emplace_back(kvPair("text", "not a number"));
+        req.set_parts(std::move(data));
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    auto incr = [&] (std::unordered_map<PartitionID,
+                                        std::vector<std::pair<std::string, int64_t>>> parts) {
+        KVIncrRequest req;
+        req.space_id = space;
+        req.parts = std::move(parts);
+        auto* processor = IncrProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        return std::move(fut).get();
+    };
+    {
+        // The same key could be increased more than once in a request
+        auto resp = incr({{1, {{"counter_1", 5}, {"counter_1", -2}}},
+                          {3, {{"counter_3", 7}}}});
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(103, resp.values["counter_1"]);
+        EXPECT_EQ(7, resp.values["counter_3"]);
+    }
+    {
+        // The part with a value which is not an integer fails, the others still succeed
+        auto resp = incr({{1, {{"counter_1", 1}}}, {2, {{"text", 1}}}});
+        ASSERT_EQ(1, resp.result.failed_parts.size());
+        EXPECT_EQ(2, resp.result.failed_parts[0].part_id);
+        ASSERT_EQ(1, resp.values.size());
+        EXPECT_EQ(104, resp.values["counter_1"]);
+    }
+    {
+        // Increase the counters of all parts concurrently, no update is lost
+        auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(8);
+        const int32_t times = 100;
+        for (int32_t i = 0; i < times; i++) {
+            executor->add([&] {
+                std::unordered_map<PartitionID,
+                                   std::vector<std::pair<std::string, int64_t>>> parts;
+                for (PartitionID part = 1; part <= totalParts; part++) {
+                    parts[part].emplace_back(folly::stringPrintf("shared_%d", part), 1);
+                }
+                auto resp = incr(std::move(parts));
+                EXPECT_EQ(0, resp.result.failed_parts.size());
+            });
+        }
+        executor->join();
+        for (PartitionID part = 1; part <= totalParts; part++) {
+            auto key = NebulaKeyUtils::kvKey(part, folly::stringPrintf("shared_%d", part));
+            std::string value;
+            auto code = cluster.storageKV_->get(space, part, key, &value);
+            EXPECT_EQ(nebula::kvstore::SUCCEEDED, code);
+            EXPECT_EQ(folly::to<std::string>(times), KVValueUtils::getValue(value));
+        }
+    }
+}
+
+TEST(KVTest, CasTest) {
+    fs::TempDir rootPath("/tmp/KVCasTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const GraphSpaceID space = 1;
+    auto cas = [&] (folly::Optional<std::string> expected, std::string value) {
+        KVCasRequest req;
+        req.space_id = space;
+        req.part_id = 1;
+        req.key = "key";
+        req.expected = std::move(expected);
+        req.value = std::move(value);
+        auto* processor = CasProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        return std::move(fut).get();
+    };
+    {
+        // Create the key only if it doesn't exist
+        auto resp = cas(folly::none, "v1");
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_TRUE(resp.swapped);
+    }
+    {
+        auto resp = cas(folly::none, "v2");
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_FALSE(resp.swapped);
+        ASSERT_TRUE(resp.current.hasValue());
+        EXPECT_EQ("v1", resp.current.value());
+    }
+    {
+        auto resp = cas(std::string("v0"), "v2");
+        EXPECT_FALSE(resp.swapped);
+        EXPECT_EQ("v1", resp.current.value());
+    }
+    {
+        auto resp = cas(std::string("v1"), "v2");
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_TRUE(resp.swapped);
+    }
+    std::string value;
+    auto code = cluster.storageKV_->get(space, 1, NebulaKeyUtils::kvKey(1, "key"), &value);
+    EXPECT_EQ(nebula::kvstore::SUCCEEDED, code);
+    EXPECT_EQ("v2", KVValueUtils::getValue(value));
+}
+
+TEST(KVTest, ValueHeaderTest) {
+    auto now = time::WallClock::fastNowInSec();
+    {
+        auto raw = KVValueUtils::encode("value", now - 1);
+        EXPECT_TRUE(KVValueUtils::hasHeader(raw));
+        EXPECT_TRUE(KVValueUtils::isExpired(raw, now));
+        EXPECT_EQ("value", KVValueUtils::getValue(raw));
+        EXPECT_FALSE(KVValueUtils::isExpired(KVValueUtils::encode("value"), now));
+        EXPECT_FALSE(KVValueUtils::isExpired(KVValueUtils::encode("value", now + 60), now));
+    }
+    {
+        // The values without the header are never expired, e.g. the rows of the vertices
+        // which start with a small integer, or the short ones
+        int64_t small = 1;
+        std::string row(reinterpret_cast<const char*>(&small), sizeof(int64_t));
+        row.append("props of the row");
+        for (const auto& raw : {row, std::string("short"), std::string()}) {
+            EXPECT_FALSE(KVValueUtils::hasHeader(raw));
+            EXPECT_EQ(0, KVValueUtils::getExpireAt(raw));
+            EXPECT_FALSE(KVValueUtils::isExpired(raw, now));
+            EXPECT_EQ(raw, KVValueUtils::getValue(raw));
+        }
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
 
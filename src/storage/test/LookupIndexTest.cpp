@@ -0,0 +1,357 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include "mock/AdHocIndexManager.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+#include "storage/index/LookupProcessor.h"
+#include "storage/mutate/AddEdgesProcessor.h"
+#include "storage/mutate/AddVerticesProcessor.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+// index_4 on player.age
+static constexpr IndexID kPlayerIndex = 4;
+// index_101 on serve(playerName, teamName, startYear), added by MockCluster
+static constexpr IndexID kServeIndex = 101;
+
+void setUpPlayers(StorageEnv* env) {
+    auto* indexMan = dynamic_cast<mock::AdHocIndexManager*>(env->indexMan_);
+    CHECK_NOTNULL(indexMan);
+    std::vector<nebula::meta::cpp2::ColumnDef> cols;
+    meta::cpp2::ColumnDef col;
+    col.set_name("age");
+    col.set_type(meta::cpp2::PropertyType::INT64);
+    cols.emplace_back(std::move(col));
+    indexMan->addTagIndex(1, kPlayerIndex, 1, std::move(cols));
+
+    auto* processor = AddVerticesProcessor::instance(env, nullptr);
+    auto fut = processor->getFuture();
+    processor->process(mock::MockData::mockAddVerticesReq());
+    auto resp = std::move(fut).get();
+    ASSERT_EQ(0, resp.result.failed_parts.size());
+}
+
+void setUpServes(StorageEnv* env) {
+    auto* processor = AddEdgesProcessor::instance(env, nullptr);
+    auto fut = processor->getFuture();
+    processor->process(mock::MockData::mockAddEdgesReq());
+    auto resp = std::move(fut).get();
+    ASSERT_EQ(0, resp.result.failed_parts.size());
+}
+
+cpp2::IndexColumnHint columnHint(const std::string& col,
+                                 cpp2::ScanType type,
+                                 Value begin,
+                                 Value end = Value()) {
+    cpp2::IndexColumnHint hint;
+    hint.set_column_name(col);
+    hint.set_scan_type(type);
+    hint.set_begin_value(std::move(begin));
+    hint.set_end_value(std::move(end));
+    return hint;
+}
+
+cpp2::LookupIndexRequest buildRequest(bool isEdge,
+                                      IndexID indexId,
+                                      std::vector<cpp2::IndexColumnHint> hints,
+                                      std::vector<std::string> returnCols,
+                                      const std::string& filter = "") {
+    cpp2::LookupIndexRequest req;
+    req.set_space_id(1);
+    req.set_parts({1, 2, 3, 4, 5, 6});
+    cpp2::IndexQueryContext context;
+    context.set_index_id(indexId);
+    context.set_filter(filter);
+    context.set_column_hints(std::move(hints));
+    cpp2::IndexSpec indices;
+    indices.set_contexts({context});
+    indices.set_is_edge(isEdge);
+    indices.set_tag_or_edge_id(isEdge ? 101 : 1);
+    req.set_indices(std::move(indices));
+    req.set_return_columns(std::move(returnCols));
+    return req;
+}
+
+cpp2::LookupIndexResp lookup(StorageEnv* env,
+                             const cpp2::LookupIndexRequest& req,
+                             folly::Executor* executor = nullptr) {
+    auto* processor = LookupProcessor::instance(env, nullptr, nullptr, executor);
+    auto fut = processor->getFuture();
+    processor->process(req);
+    return std::move(fut).get();
+}
+
+// name -> age of players whose age is in [begin, end)
+std::map<std::string, int64_t> expectPlayers(int64_t begin, int64_t end) {
+    std::map<std::string, int64_t> players;
+    for (const auto& vertex : mock::MockData::mockVertices()) {
+        if (vertex.tId_ != 1) {
+            continue;
+        }
+        auto age = vertex.props_[1].getInt();
+        if (age >= begin && age < end) {
+            players.emplace(vertex.vId_, age);
+        }
+    }
+    return players;
+}
+
+std::map<std::string, int64_t> toPlayers(const nebula::DataSet& data) {
+    std::map<std::string, int64_t> players;
+    for (const auto& row : data.rows) {
+        players.emplace(row.values[0].getStr(), row.values[1].getInt());
+    }
+    return players;
+}
+
+TEST(LookupIndexTest, PrefixTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexPrefixTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpPlayers(env);
+
+    auto req = buildRequest(false, kPlayerIndex,
+                            {columnHint("age", cpp2::ScanType::PREFIX, Value(38L))},
+                            {"age"});
+    auto resp = lookup(env, req);
+    ASSERT_EQ(0, resp.result.failed_parts.size());
+    auto expected = expectPlayers(38, 39);
+    ASSERT_FALSE(expected.empty());
+    EXPECT_EQ((std::vector<std::string>{kVid, "1:age"}), resp.get_data()->colNames);
+    EXPECT_EQ(expected, toPlayers(*resp.get_data()));
+}
+
+TEST(LookupIndexTest, RangeTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexRangeTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpPlayers(env);
+    folly::IOThreadPoolExecutor executor(4);
+
+    {
+        // 30 <= age < 35, the parts run in parallel
+        auto req = buildRequest(false, kPlayerIndex,
+                                {columnHint("age", cpp2::ScanType::RANGE, Value(30L), Value(35L))},
+                                {"age"});
+        auto resp = lookup(env, req, &executor);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(expectPlayers(30, 35), toPlayers(*resp.get_data()));
+    }
+    {
+        // age >= 40
+        auto req = buildRequest(false, kPlayerIndex,
+                                {columnHint("age", cpp2::ScanType::RANGE, Value(40L))},
+                                {"age"});
+        auto resp = lookup(env, req, &executor);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(expectPlayers(40, std::numeric_limits<int64_t>::max()),
+                  toPlayers(*resp.get_data()));
+    }
+    {
+        // 30 <= age < 40 and $^.player.age < 35
+        RelationalExpression exp(
+            Expression::Kind::kRelLT,
+            new SourcePropertyExpression(new std::string("1"), new std::string("age")),
+            new ConstantExpression(Value(35L)));
+        auto req = buildRequest(false, kPlayerIndex,
+                                {columnHint("age", cpp2::ScanType::RANGE, Value(30L), Value(40L))},
+                                {"age"},
+                                Expression::encode(exp));
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(expectPlayers(30, 35), toPlayers(*resp.get_data()));
+    }
+}
+
+TEST(LookupIndexTest, IndexOnlyTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexOnlyTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpPlayers(env);
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+
+    // Remove the row of a player, but leave its index key
+    auto expected = expectPlayers(38, 39);
+    ASSERT_FALSE(expected.empty());
+    auto vId = expected.begin()->first;
+    PartitionID partId = std::hash<std::string>()(vId) % 6 + 1;
+    auto prefix = NebulaKeyUtils::vertexPrefix(vIdLen, partId, vId, 1);
+    folly::Baton<true, std::atomic> baton;
+    env->kvstore_->asyncRemovePrefix(1, partId, prefix, [&baton] (kvstore::ResultCode code) {
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+
+    {
+        // Only age is returned, which is read from the index key
+        auto req = buildRequest(false, kPlayerIndex,
+                                {columnHint("age", cpp2::ScanType::PREFIX, Value(38L))},
+                                {"age"});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(expected, toPlayers(*resp.get_data()));
+    }
+    {
+        // The name is not in the index, the row of the removed player is missing
+        auto req = buildRequest(false, kPlayerIndex,
+                                {columnHint("age", cpp2::ScanType::PREFIX, Value(38L))},
+                                {"age", "name"});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        expected.erase(vId);
+        EXPECT_EQ(expected, toPlayers(*resp.get_data()));
+        for (const auto& row : resp.get_data()->rows) {
+            EXPECT_EQ(row.values[0], row.values[2]);
+        }
+    }
+}
+
+TEST(LookupIndexTest, LimitTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexLimitTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpPlayers(env);
+    folly::IOThreadPoolExecutor executor(4);
+
+    auto expected = expectPlayers(0, std::numeric_limits<int64_t>::max());
+    ASSERT_GT(expected.size(), 5);
+    auto req = buildRequest(false, kPlayerIndex, {}, {"age"});
+    req.set_limit(5);
+    for (auto* exec : {static_cast<folly::Executor*>(nullptr),
+                       static_cast<folly::Executor*>(&executor)}) {
+        auto resp = lookup(env, req, exec);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        auto players = toPlayers(*resp.get_data());
+        ASSERT_EQ(5, players.size());
+        for (const auto& player : players) {
+            EXPECT_EQ(expected[player.first], player.second);
+        }
+    }
+}
+
+TEST(LookupIndexTest, EdgeTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexEdgeTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpServes(env);
+
+    std::set<std::tuple<std::string, int64_t, std::string>> expected;
+    for (const auto& edge : mock::MockData::mockEdges()) {
+        if (edge.type_ == 101 && edge.srcId_ == "Tim Duncan") {
+            expected.emplace(edge.srcId_, edge.rank_, edge.dstId_);
+        }
+    }
+    ASSERT_FALSE(expected.empty());
+
+    // playerName is a string column, so the keys are checked after the prefix scan
+    auto req = buildRequest(true, kServeIndex,
+                            {columnHint("playerName", cpp2::ScanType::PREFIX,
+                                        Value("Tim Duncan"))},
+                            {"teamName", "endYear"});
+    auto resp = lookup(env, req);
+    ASSERT_EQ(0, resp.result.failed_parts.size());
+    EXPECT_EQ((std::vector<std::string>{kSrc, kRank, kDst, "101:teamName", "101:endYear"}),
+              resp.get_data()->colNames);
+    std::set<std::tuple<std::string, int64_t, std::string>> actual;
+    for (const auto& row : resp.get_data()->rows) {
+        EXPECT_EQ(row.values[2], row.values[3]);
+        actual.emplace(row.values[0].getStr(), row.values[1].getInt(), row.values[2].getStr());
+    }
+    EXPECT_EQ(expected, actual);
+}
+
+TEST(LookupIndexTest, DroppedSchemaTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexDroppedSchemaTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpPlayers(env);
+    setUpServes(env);
+
+    auto* dropped = DroppedSchemas::instance();
+    dropped->addTag(1, 1);
+    dropped->addEdge(1, 101);
+    {
+        auto req = buildRequest(false, kPlayerIndex, {}, {"age"});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_TRUE(resp.get_data()->rows.empty());
+    }
+    {
+        auto req = buildRequest(true, kServeIndex, {}, {"teamName"});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_TRUE(resp.get_data()->rows.empty());
+    }
+
+    // The rows are back once the drop task has finished
+    dropped->removeTag(1, 1);
+    dropped->removeEdge(1, 101);
+    {
+        auto req = buildRequest(false, kPlayerIndex, {}, {"age"});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        EXPECT_EQ(expectPlayers(0, std::numeric_limits<int64_t>::max()),
+                  toPlayers(*resp.get_data()));
+    }
+}
+
+TEST(LookupIndexTest, InvalidHintTest) {
+    fs::TempDir rootPath("/tmp/LookupIndexInvalidHintTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    setUpServes(env);
+
+    {
+        // teamName is not the first column of the index
+        auto req = buildRequest(true, kServeIndex,
+                                {columnHint("teamName", cpp2::ScanType::PREFIX, Value("Spurs"))},
+                                {});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(6, resp.result.failed_parts.size());
+        EXPECT_EQ(cpp2::ErrorCode::E_INVALID_OPERATION, resp.result.failed_parts[0].code);
+    }
+    {
+        // only the last hint could be a range
+        auto req = buildRequest(true, kServeIndex,
+                                {columnHint("playerName", cpp2::ScanType::RANGE, Value("A")),
+                                 columnHint("teamName", cpp2::ScanType::PREFIX, Value("Spurs"))},
+                                {});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(6, resp.result.failed_parts.size());
+        EXPECT_EQ(cpp2::ErrorCode::E_INVALID_OPERATION, resp.result.failed_parts[0].code);
+    }
+    {
+        auto req = buildRequest(false, 1000, {}, {});
+        auto resp = lookup(env, req);
+        ASSERT_EQ(6, resp.result.failed_parts.size());
+        EXPECT_EQ(cpp2::ErrorCode::E_INDEX_NOT_FOUND, resp.result.failed_parts[0].code);
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,235 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/fs/FileUtils.h"
+#include <gtest/gtest.h>
+#include "mock/AdHocIndexManager.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+#include "storage/admin/RebuildEdgeIndexTask.h"
+#include "storage/admin/RebuildTagIndexTask.h"
+#include "storage/mutate/AddVerticesProcessor.h"
+#include "storage/test/QueryTestUtils.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+// index_4 on player.age
+static constexpr IndexID kPlayerIndex = 4;
+
+void addPlayerIndex(StorageEnv* env) {
+    auto* indexMan = dynamic_cast<mock::AdHocIndexManager*>(env->indexMan_);
+    CHECK_NOTNULL(indexMan);
+    std::vector<nebula::meta::cpp2::ColumnDef> cols;
+    meta::cpp2::ColumnDef col;
+    col.set_name("age");
+    col.set_type(meta::cpp2::PropertyType::INT64);
+    cols.emplace_back(std::move(col));
+    indexMan->addTagIndex(1, kPlayerIndex, 1, std::move(cols));
+}
+
+void addVertices(StorageEnv* env, const cpp2::AddVerticesRequest& req) {
+    auto* processor = AddVerticesProcessor::instance(env, nullptr);
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+}
+
+size_t countIndex(StorageEnv* env, IndexID indexId) {
+    size_t count = 0;
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = IndexKeyUtils::indexPrefix(partId, indexId);
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        for (; iter->valid(); iter->next()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t countPlayers() {
+    std::unordered_set<VertexID> players;
+    for (auto& vertex : mock::MockData::mockVertices()) {
+        if (vertex.tId_ == 1) {
+            players.emplace(vertex.vId_);
+        }
+    }
+    return players.size();
+}
+
+TaskContext rebuildContext(nebula::meta::cpp2::AdminCmd cmd,
+                           kvstore::KVStore* store,
+                           std::vector<std::string> indexes) {
+    cpp2::AddAdminTaskRequest req;
+    req.set_cmd(cmd);
+    req.set_job_id(1);
+    req.set_task_id(1);
+    cpp2::TaskPara para;
+    para.set_space_id(1);
+    para.set_task_specfic_paras(std::move(indexes));
+    req.set_para(std::move(para));
+    return TaskContext(req, store, [] (cpp2::ErrorCode) {});
+}
+
+void runTask(AdminTask* task) {
+    auto subTasks = task->genSubTasks();
+    ASSERT_TRUE(nebula::ok(subTasks));
+    EXPECT_EQ(6, nebula::value(subTasks).size());
+    for (auto& subTask : nebula::value(subTasks)) {
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, subTask.invoke());
+    }
+}
+
+TEST(RebuildIndexTest, RebuildTagIndexTest) {
+    fs::TempDir rootPath("/tmp/RebuildTagIndexTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    addVertices(env, mock::MockData::mockAddVerticesReq());
+
+    // The index is created after the data
+    addPlayerIndex(env);
+    EXPECT_EQ(0, countIndex(env, kPlayerIndex));
+
+    auto ctx = rebuildContext(nebula::meta::cpp2::AdminCmd::REBUILD_TAG_INDEX,
+                              env->kvstore_, {"index_4"});
+    RebuildTagIndexTask task(env, std::move(ctx));
+    runTask(&task);
+    EXPECT_EQ(countPlayers(), countIndex(env, kPlayerIndex));
+
+    // Rebuild again is idempotent
+    auto ctx2 = rebuildContext(nebula::meta::cpp2::AdminCmd::REBUILD_TAG_INDEX,
+                               env->kvstore_, {"index_4"});
+    RebuildTagIndexTask again(env, std::move(ctx2));
+    runTask(&again);
+    EXPECT_EQ(countPlayers(), countIndex(env, kPlayerIndex));
+
+    // The sst files are removed once ingested
+    for (auto& path : {"disk1", "disk2"}) {
+        auto dir = folly::stringPrintf("%s/%s/nebula/1/rebuild_index", rootPath.path(), path);
+        EXPECT_TRUE(fs::FileUtils::listAllFilesInDir(dir.c_str()).empty());
+    }
+}
+
+TEST(RebuildIndexTest, RebuildEdgeIndexTest) {
+    fs::TempDir rootPath("/tmp/RebuildEdgeIndexTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    // The data is written without index
+    ASSERT_TRUE(QueryTestUtils::mockEdgeData(env, 6));
+    EXPECT_EQ(0, countIndex(env, 101));
+
+    std::set<std::tuple<VertexID, EdgeRanking, VertexID>> serves;
+    for (auto& edge : mock::MockData::mockMultiEdges()) {
+        if (edge.type_ == 101) {
+            serves.emplace(edge.srcId_, edge.rank_, edge.dstId_);
+        }
+    }
+
+    // Rebuild all edge indexes
+    auto ctx = rebuildContext(nebula::meta::cpp2::AdminCmd::REBUILD_EDGE_INDEX,
+                              env->kvstore_, {});
+    RebuildEdgeIndexTask task(env, std::move(ctx));
+    runTask(&task);
+    EXPECT_EQ(serves.size(), countIndex(env, 101));
+}
+
+TEST(RebuildIndexTest, IndexNotFoundTest) {
+    fs::TempDir rootPath("/tmp/IndexNotFoundTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+
+    auto ctx = rebuildContext(nebula::meta::cpp2::AdminCmd::REBUILD_TAG_INDEX,
+                              env->kvstore_, {"not_exist"});
+    RebuildTagIndexTask task(env, std::move(ctx));
+    auto subTasks = task.genSubTasks();
+    ASSERT_FALSE(nebula::ok(subTasks));
+    EXPECT_EQ(cpp2::ErrorCode::E_INDEX_NOT_FOUND, nebula::error(subTasks));
+}
+
+TEST(RebuildIndexTest, ReplayLogsTest) {
+    fs::TempDir rootPath("/tmp/ReplayLogsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    addVertices(env, mock::MockData::mockAddVerticesReq());
+    addPlayerIndex(env);
+
+    auto ctx = rebuildContext(nebula::meta::cpp2::AdminCmd::REBUILD_TAG_INDEX,
+                              env->kvstore_, {"index_4"});
+    RebuildTagIndexTask task(env, std::move(ctx));
+    ASSERT_TRUE(nebula::ok(task.genSubTasks()));
+
+    // Pick a player, and find its part
+    auto vertices = mock::MockData::mockVertices();
+    auto player = std::find_if(vertices.begin(), vertices.end(),
+                               [] (const auto& v) { return v.tId_ == 1; });
+    ASSERT_NE(vertices.end(), player);
+    PartitionID partId = std::hash<std::string>()(player->vId_) % 6 + 1;
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(env->kvstore_);
+    auto part = nebula::value(store->part(1, partId));
+    auto* engine = part->engine();
+
+    auto* snapshot = engine->getSnapshot();
+    auto snapshotLogId = task.committedLogId(partId, engine, snapshot);
+    ASSERT_TRUE(nebula::ok(snapshotLogId));
+
+    // The player is updated after the snapshot
+    cpp2::AddVerticesRequest req;
+    req.set_space_id(1);
+    req.set_overwritable(true);
+    cpp2::NewTag newTag;
+    newTag.set_tag_id(1);
+    auto props = player->props_;
+    props[1] = Value(1000L);
+    newTag.set_props(std::move(props));
+    cpp2::NewVertex newVertex;
+    newVertex.set_id(player->vId_);
+    newVertex.set_tags({newTag});
+    req.parts[partId].emplace_back(std::move(newVertex));
+    addVertices(env, req);
+
+    // The index built from the snapshot has the age before update
+    EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED,
+              task.buildIndexFromSnapshot(partId, engine, snapshot));
+    auto indexOf = [&] (int64_t age) {
+        std::vector<Value::Type> colsType{Value::Type::INT};
+        std::vector<Value> values{Value(age)};
+        return IndexKeyUtils::vertexIndexKey(vIdLen, partId, kPlayerIndex,
+                                             player->vId_, values, colsType);
+    };
+    std::string val;
+    auto oldAge = player->props_[1].getInt();
+    EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, engine->get(indexOf(oldAge), &val));
+    EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, engine->get(indexOf(1000L), &val));
+
+    // The replay removes the stale entry
+    EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED,
+              task.replayLogs(partId, part, snapshot, nebula::value(snapshotLogId)));
+    EXPECT_EQ(kvstore::ResultCode::ERR_KEY_NOT_FOUND, engine->get(indexOf(oldAge), &val));
+    EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, engine->get(indexOf(1000L), &val));
+    engine->releaseSnapshot(snapshot);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
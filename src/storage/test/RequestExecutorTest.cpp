@@ -0,0 +1,114 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <folly/synchronization/Baton.h>
+#include "mock/MockCluster.h"
+#include "storage/RequestExecutor.h"
+#include "storage/GraphStorageServiceHandler.h"
+
+namespace nebula {
+namespace storage {
+
+// Occupy the only reader, wait until it is running
+void blockReader(RequestExecutor* executor, folly::Baton<>* running, folly::Baton<>* release) {
+    ASSERT_TRUE(executor->add(RequestExecutor::Kind::READ, [running, release] {
+        running->post();
+        release->wait();
+    }));
+    running->wait();
+}
+
+TEST(RequestExecutorTest, RejectTest) {
+    RequestExecutor executor(1, 1, 2);
+    folly::Baton<> running, release;
+    blockReader(&executor, &running, &release);
+
+    std::atomic<int> done{0};
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+    EXPECT_EQ(2, executor.queued(RequestExecutor::Kind::READ));
+    EXPECT_FALSE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+
+    // The writes have their own pool and limit
+    folly::Baton<> written;
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::WRITE, [&written] { written.post(); }));
+    written.wait();
+
+    release.post();
+    while (executor.queued(RequestExecutor::Kind::READ) > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+    while (done.load() < 3) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(3, done.load());
+}
+
+TEST(RequestExecutorTest, StopTest) {
+    RequestExecutor executor(1, 1, 0);
+    folly::Baton<> running, release;
+    blockReader(&executor, &running, &release);
+
+    std::atomic<int> done{0};
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::WRITE, [&done] { done++; }));
+
+    // The running and queued requests are finished once it returns
+    std::thread stopper([&executor] { executor.stop(); });
+    while (executor.add(RequestExecutor::Kind::WRITE, [&done] { done++; })) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    release.post();
+    stopper.join();
+    auto finished = done.load();
+    EXPECT_LE(2, finished);
+
+    EXPECT_FALSE(executor.add(RequestExecutor::Kind::READ, [&done] { done++; }));
+    EXPECT_FALSE(executor.add(RequestExecutor::Kind::WRITE, [&done] { done++; }));
+    EXPECT_EQ(0, executor.queued(RequestExecutor::Kind::READ));
+    EXPECT_EQ(finished, done.load());
+}
+
+TEST(RequestExecutorTest, HandlerRejectTest) {
+    fs::TempDir rootPath("/tmp/RequestExecutorTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+
+    RequestExecutor executor(1, 1, 1);
+    GraphStorageServiceHandler handler(env, &executor);
+    folly::Baton<> running, release;
+    blockReader(&executor, &running, &release);
+    EXPECT_TRUE(executor.add(RequestExecutor::Kind::READ, [] {}));
+
+    cpp2::GetPropRequest req;
+    req.set_space_id(1);
+    for (PartitionID partId : {1, 2}) {
+        nebula::Row row;
+        row.values.emplace_back("Tim Duncan");
+        req.parts[partId].emplace_back(std::move(row));
+    }
+    auto resp = handler.future_getProps(req).get();
+    ASSERT_EQ(2, resp.result.failed_parts.size());
+    for (const auto& part : resp.result.failed_parts) {
+        EXPECT_EQ(cpp2::ErrorCode::E_RETRY_EXHAUSTED, part.code);
+    }
+    release.post();
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+#include <folly/Benchmark.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include "common/fs/TempDir.h"
+#include "storage/query/ScanEdgeProcessor.h"
+#include "storage/test/QueryTestUtils.h"
+
+DEFINE_uint64(max_rank, 1000, "max rank of each edge");
+DEFINE_int32(scan_threads, 4, "threads to scan the parts in parallel");
+DEFINE_int64(page_limit, 1000, "rows of each part in a page");
+
+std::unique_ptr<nebula::mock::MockCluster> gCluster;
+std::unique_ptr<folly::CPUThreadPoolExecutor> gExecutor;
+
+namespace nebula {
+namespace storage {
+
+ScanEdgeRequest buildRequest(int64_t limit, int64_t maxBytes, bool pin) {
+    ScanEdgeRequest req;
+    req.space_id = 1;
+    for (PartitionID partId = 1; partId <= gCluster->getTotalParts(); partId++) {
+        req.parts.emplace(partId, "");
+    }
+    cpp2::EdgeProp edgeProp;
+    edgeProp.type = 101;
+    edgeProp.props = {kSrc, kRank, kDst, "startYear"};
+    req.return_columns.emplace_back(std::move(edgeProp));
+    req.limit = limit;
+    req.max_bytes = maxBytes;
+    req.pin_snapshot = pin;
+    return req;
+}
+
+void setUp(const char* path, EdgeRanking maxRank) {
+    gCluster = std::make_unique<nebula::mock::MockCluster>();
+    gCluster->initStorageKV(path);
+    auto* env = gCluster->storageEnv_.get();
+    auto totalParts = gCluster->getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockBenchEdgeData(env, totalParts, 1, maxRank));
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+// Scan all serve edges page by page
+void scanAll(int32_t iters, int64_t maxBytes, bool pin, bool parallel) {
+    nebula::storage::ScanEdgeRequest req;
+    BENCHMARK_SUSPEND {
+        req = nebula::storage::buildRequest(FLAGS_page_limit, maxBytes, pin);
+    }
+    auto* env = gCluster->storageEnv_.get();
+    auto* executor = parallel ? gExecutor.get() : nullptr;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        auto page = req;
+        while (!page.parts.empty()) {
+            auto* processor = nebula::storage::ScanEdgeProcessor::instance(env, nullptr, executor);
+            auto fut = processor->getFuture();
+            processor->process(page);
+            auto resp = std::move(fut).get();
+            folly::doNotOptimizeAway(resp.data.rows.size());
+            page.parts = std::move(resp.next_cursors);
+        }
+    }
+}
+
+BENCHMARK(ScanSerially, iters) {
+    scanAll(iters, 0, true, false);
+}
+BENCHMARK_RELATIVE(ScanInParallel, iters) {
+    scanAll(iters, 0, true, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ScanPinned, iters) {
+    scanAll(iters, 0, true, true);
+}
+BENCHMARK_RELATIVE(ScanNotPinned, iters) {
+    scanAll(iters, 0, false, true);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(ScanByRows, iters) {
+    scanAll(iters, 0, true, true);
+}
+BENCHMARK_RELATIVE(ScanBy64KBytes, iters) {
+    scanAll(iters, 64 * 1024, true, true);
+}
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    nebula::fs::TempDir rootPath("/tmp/ScanBenchmark.XXXXXX");
+    nebula::storage::setUp(rootPath.path(), FLAGS_max_rank);
+    gExecutor = std::make_unique<folly::CPUThreadPoolExecutor>(FLAGS_scan_threads);
+    folly::runBenchmarks();
+    gExecutor.reset();
+    gCluster.reset();
+    return 0;
+}
@@ -1,428 +1,292 @@
-/* Copyright (c) 2019 vesoft inc. All rights reserved.
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
  *
  * This source code is licensed under Apache 2.0 License,
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
 
 #include "common/base/Base.h"
-#include "common/fs/TempDir.h"
-#include "utils/NebulaKeyUtils.h"
 #include <gtest/gtest.h>
-#include <rocksdb/db.h>
-#include "storage/test/TestUtils.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include "common/fs/TempDir.h"
+#include "storage/StorageFlags.h"
 #include "storage/query/ScanVertexProcessor.h"
-#include "codec/RowReader.h"
+#include "storage/test/QueryTestUtils.h"
 
 namespace nebula {
 namespace storage {
 
-void mockData(kvstore::KVStore* kv, int32_t partCount = 10) {
-    // we have 10srcId * 10dstId * 10part = 1000 edges of one edgeType,
-    // and 10vId * 9tagId * 10part = 900 tags
-    for (auto partId = 0; partId < partCount; partId++) {
-        std::vector<kvstore::KV> data;
-        for (auto vertexId = partId * 10; vertexId < (partId + 1) * 10; vertexId++) {
-            // Generate 9 tag for each vertex
-            for (auto tagId = 3001; tagId < 3010; tagId++) {
-                int64_t ts = std::numeric_limits<int64_t>::max() -
-                                  time::WallClock::fastNowInMicroSec();
-                int64_t version = folly::Endian::big(ts);
-                auto key = NebulaKeyUtils::vertexKey(partId, vertexId, tagId, version);
-                RowWriter writer;
-                for (uint64_t numInt = 0; numInt < 3; numInt++) {
-                    writer << (vertexId + tagId + numInt);
-                }
-                for (auto numString = 3; numString < 6; numString++) {
-                    writer << folly::stringPrintf("tag_string_col_%d", numString);
-                }
-                auto val = writer.encode();
-                data.emplace_back(std::move(key), std::move(val));
-            }
-            for (EdgeType edgeType = 101; edgeType <= 103; edgeType++) {
-                // Generate 100 edges for each source vertex id
-                for (auto dstId = 10001; dstId <= 10100; dstId++) {
-                    VLOG(3) << "Write part " << partId << ", vertex "
-                        << vertexId << ", dst " << dstId;
-                    int64_t ts = std::numeric_limits<int64_t>::max() -
-                        time::WallClock::fastNowInMicroSec();
-                    int64_t version = folly::Endian::big(ts);
-                    auto key = NebulaKeyUtils::edgeKey(partId, vertexId, edgeType, dstId - 10001,
-                            dstId, version);
-                    RowWriter writer(nullptr);
-                    for (int64_t numInt = 0; numInt < 10; numInt++) {
-                        writer << numInt;
-                    }
-                    for (auto numString = 10; numString < 20; numString++) {
-                        writer << folly::stringPrintf("string_col_%d", numString);
-                    }
-                    auto val = writer.encode();
-                    data.emplace_back(std::move(key), std::move(val));
-                }
-                // Generate 5 in-edges for each edgeType, the edgeType is negative
-                for (auto srcId = 20001; srcId <= 20005; srcId++) {
-                    VLOG(3) << "Write part " << partId << ", vertex "
-                        << vertexId << ", src " << srcId;
-                    auto key = NebulaKeyUtils::edgeKey(partId, vertexId, -edgeType, 0, srcId, 0);
-                    data.emplace_back(std::move(key), "");
-                }
-            }
-        }
-        folly::Baton<true, std::atomic> baton;
-        kv->asyncMultiPut(
-            0, partId, std::move(data),
-            [&](kvstore::ResultCode code) {
-                EXPECT_EQ(code, kvstore::ResultCode::SUCCEEDED);
-                baton.post();
-            });
-        baton.wait();
+ScanVertexRequest buildRequest(int32_t totalParts,
+                               std::vector<cpp2::VertexProp> props = {},
+                               int64_t limit = 1000) {
+    ScanVertexRequest req;
+    req.space_id = 1;
+    for (PartitionID partId = 1; partId <= totalParts; partId++) {
+        req.parts.emplace(partId, "");
     }
+    req.return_columns = std::move(props);
+    req.limit = limit;
+    return req;
 }
 
+ScanResponse scan(StorageEnv* env,
+                  const ScanVertexRequest& req,
+                  folly::Executor* executor = nullptr) {
+    auto* processor = ScanVertexProcessor::instance(env, nullptr, executor);
+    auto fut = processor->getFuture();
+    processor->process(req);
+    return std::move(fut).get();
+}
 
-cpp2::ScanVertexRequest buildRequest(PartitionID partId, const std::string& cursor,
-                                     int32_t rowLimit,
-                                     bool returnAllColumns = false,
-                                     bool returnNoneColumns = false,
-                                     std::unordered_set<TagID> tagIds = {3001},
-                                     int64_t startTime = 0,
-                                     int64_t endTime = std::numeric_limits<int64_t>::max()) {
-    cpp2::ScanVertexRequest req;
-    req.set_space_id(0);
-    req.set_part_id(partId);
-    req.set_cursor(cursor);
-    std::unordered_map<EdgeType, std::vector<cpp2::PropDef>> returnColumns;
-    for (TagID tagId : tagIds) {
-        std::vector<cpp2::PropDef> props;
-        if (returnNoneColumns) {
-            returnColumns.emplace(tagId, std::move(props));
-            continue;
+// Scan page by page until all parts reach the end, returns the vertex ids
+std::vector<std::string> scanAll(StorageEnv* env,
+                                 ScanVertexRequest req,
+                                 folly::Executor* executor = nullptr,
+                                 std::function<void(int32_t)> afterPage = nullptr) {
+    std::vector<std::string> vIds;
+    int32_t pages = 0;
+    while (!req.parts.empty()) {
+        auto resp = scan(env, req, executor);
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        for (const auto& row : resp.data.rows) {
+            vIds.emplace_back(row.values[0].getStr());
         }
-
-        if (!returnAllColumns) {
-            // return col_4 and col_1
-            {
-                cpp2::PropDef prop;
-                prop.owner = cpp2::PropOwner::SOURCE;
-                prop.id.set_tag_id(tagId);
-                prop.name = folly::stringPrintf("tag_%d_col_%d", tagId, 4);
-                props.emplace_back(std::move(prop));
-            }
-            {
-                cpp2::PropDef prop;
-                prop.owner = cpp2::PropOwner::SOURCE;
-                prop.id.set_tag_id(tagId);
-                prop.name = folly::stringPrintf("tag_%d_col_%d", tagId, 1);
-                props.emplace_back(std::move(prop));
-            }
-        } else {
-            // if return all columns we don't need to specify any propery
+        req.parts = std::move(resp.next_cursors);
+        if (afterPage != nullptr) {
+            afterPage(++pages);
         }
-        returnColumns.emplace(tagId, std::move(props));
     }
-    req.set_return_columns(std::move(returnColumns));
-    req.set_all_columns(returnAllColumns);
-    req.set_limit(rowLimit);
-    req.set_start_time(startTime);
-    req.set_end_time(endTime);
-    return req;
+    return vIds;
 }
 
-
-void checkResponse(PartitionID partId, cpp2::ScanVertexResponse& resp, std::string& cursor,
-                   int32_t& totalRowCount, int32_t expectedRowNum, int32_t expectedColumnsNum,
-                   bool returnAllColumns = false,
-                   bool returnNoneColumns = false,
-                   std::unordered_set<TagID> tagIds = {3001}) {
-    EXPECT_EQ(0, resp.result.failed_codes.size());
-    for (const auto& schemaIter : resp.vertex_schema) {
-        EXPECT_EQ(expectedColumnsNum, schemaIter.second.columns.size());
+std::set<std::string> allVertices() {
+    std::set<std::string> vIds;
+    for (const auto& vertex : mock::MockData::mockVertices()) {
+        vIds.emplace(vertex.vId_);
     }
+    return vIds;
+}
 
-    if (!resp.vertex_data.empty()) {
-        int32_t rowNum = 0;
-        for (const auto& scanVertex : resp.vertex_data) {
-            auto vertexId = scanVertex.vertexId;
-            EXPECT_TRUE(partId * 10 <= vertexId && vertexId < (partId + 1) * 10);
-            auto tagId = scanVertex.tagId;
-            EXPECT_TRUE(tagIds.count(tagId));
-
-            if (returnNoneColumns) {
-                EXPECT_TRUE(scanVertex.value.empty());
-            } else {
-                auto schemaIter = resp.vertex_schema.find(tagId);
-                EXPECT_TRUE(schemaIter != resp.vertex_schema.end());
-                auto provider = std::make_shared<ResultSchemaProvider>(schemaIter->second);
-                auto reader = RowReader::getRowReader(scanVertex.value, provider);
-
-                if (!returnAllColumns) {
-                    {
-                        folly::StringPiece value;
-                        reader->getString(0, value);
-                        EXPECT_EQ(folly::stringPrintf("tag_string_col_%d", 4), value);
-                    }
-                    {
-                        int64_t value;
-                        reader->getInt(1, value);
-                        EXPECT_EQ(vertexId + tagId + 1, value);
-                    }
-                } else {
-                    for (uint64_t i = 0; i < 3; i++) {
-                        int64_t value;
-                        reader->getInt(i, value);
-                        EXPECT_EQ(vertexId + tagId + i, value);
-                    }
-                    for (auto i = 3; i < 6; i++) {
-                        folly::StringPiece value;
-                        reader->getString(i, value);
-                        EXPECT_EQ(folly::stringPrintf("tag_string_col_%d", i), value);
-                    }
-                }
-            }
-            rowNum++;
+TEST(ScanVertexTest, PropertyTest) {
+    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    TagID player = 1;
+    {
+        LOG(INFO) << "Scan some props of one tag";
+        cpp2::VertexProp tagProp;
+        tagProp.tag = player;
+        tagProp.props = {"name", "age"};
+        auto resp = scan(env, buildRequest(totalParts, {tagProp}));
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_TRUE(resp.next_cursors.empty());
+
+        std::vector<std::string> expectedCols = {kVid, "1:name", "1:age"};
+        ASSERT_EQ(expectedCols, resp.data.colNames);
+        ASSERT_EQ(mock::MockData::players_.size(), resp.data.rows.size());
+        for (const auto& row : resp.data.rows) {
+            ASSERT_EQ(3, row.values.size());
+            auto vId = row.values[0].getStr();
+            auto iter = std::find_if(mock::MockData::players_.begin(),
+                                     mock::MockData::players_.end(),
+                                     [&] (const auto& p) { return p.name_ == vId; });
+            ASSERT_TRUE(iter != mock::MockData::players_.end());
+            ASSERT_EQ(iter->name_, row.values[1].getStr());
+            ASSERT_EQ(iter->age_, row.values[2].getInt());
         }
-        EXPECT_EQ(expectedRowNum, rowNum);
-        totalRowCount += rowNum;
     }
-
-    if (resp.has_next) {
-        EXPECT_TRUE(!resp.next_cursor.empty());
-        cursor = resp.next_cursor;
-    } else {
-        EXPECT_TRUE(resp.next_cursor.empty());
-        cursor = "";
-        return;
+    {
+        LOG(INFO) << "Scan all tags";
+        auto resp = scan(env, buildRequest(totalParts));
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(allVertices().size(), resp.data.rows.size());
+        for (const auto& row : resp.data.rows) {
+            ASSERT_EQ(resp.data.colNames.size(), row.values.size());
+        }
     }
 }
 
-// Retrieve all tags 3001 with all property
-TEST(ScanVertexTest, RetrieveAllPropertyTest) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-    PartitionID partId = 1;
-    auto req = buildRequest(partId, "", 10, true);
-
-    auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-    auto f = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(f).get();
-
-    LOG(INFO) << "Check the results...";
-    std::string cursor = "";
-    int32_t rowCount = 0, expectRowCount = 10;
-    checkResponse(partId, resp, cursor, rowCount, expectRowCount, 6, true);
-    EXPECT_EQ(rowCount, 10);
-}
-
-// Retrieve all tags 3001 with some property
-TEST(ScanVertexTest, RetrieveSomePropertyTest) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-    PartitionID partId = 1;
-    auto req = buildRequest(partId, "", 10);
-
-    auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-    auto f = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(f).get();
-
-    LOG(INFO) << "Check the results...";
-    std::string cursor = "";
-    int32_t rowCount = 0, expectRowCount = 10;
-    checkResponse(partId, resp, cursor, rowCount, expectRowCount, 2);
-    EXPECT_EQ(rowCount, 10);
-}
-
-// Retrieve all tags 3001 with none property
-TEST(ScanVertexTest, RetrieveNonePropertyTest) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-    PartitionID partId = 1;
-    auto req = buildRequest(partId, "", 10, false, true);
-
-    auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-    auto f = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(f).get();
-
-    LOG(INFO) << "Check the results...";
-    std::string cursor = "";
-    int32_t rowCount = 0, expectRowCount = 10;
-    checkResponse(partId, resp, cursor, rowCount, expectRowCount, 0, false, true);
-    EXPECT_EQ(rowCount, 10);
+TEST(ScanVertexTest, FilterTest) {
+    fs::TempDir rootPath("/tmp/ScanVertexFilterTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+
+    // where $^.player.age >= 30, the age is not returned
+    cpp2::VertexProp tagProp;
+    tagProp.tag = 1;
+    tagProp.props = {"name"};
+    auto req = buildRequest(totalParts, {tagProp});
+    RelationalExpression exp(
+        Expression::Kind::kRelGE,
+        new SourcePropertyExpression(new std::string("1"), new std::string("age")),
+        new ConstantExpression(Value(30)));
+    req.filter = Expression::encode(exp);
+
+    auto resp = scan(env, req);
+    ASSERT_EQ(0, resp.result.failed_parts.size());
+    std::vector<std::string> expectedCols = {kVid, "1:name"};
+    ASSERT_EQ(expectedCols, resp.data.colNames);
+    size_t expected = std::count_if(mock::MockData::players_.begin(),
+                                    mock::MockData::players_.end(),
+                                    [] (const auto& p) { return p.age_ >= 30; });
+    ASSERT_EQ(expected, resp.data.rows.size());
+    for (const auto& row : resp.data.rows) {
+        ASSERT_EQ(2, row.values.size());
+    }
 }
 
-// Retrive vertices of all property in a part
-TEST(ScanVertexTest, RetrieveConsecutiveBlockTest1) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-
-    std::string cursor = "";
-    int32_t rowCount = 0, rowLimit = 10, expectRowCount = 10;
-    PartitionID partId = 1;
-    std::unordered_set<TagID> tagIds;
-    for (TagID tagId = 3001; tagId < 3010; tagId++) {
-        tagIds.emplace(tagId);
+TEST(ScanVertexTest, PagingTest) {
+    fs::TempDir rootPath("/tmp/ScanVertexPagingTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    auto expected = allVertices();
+
+    {
+        LOG(INFO) << "Scan by the limit of rows";
+        auto vIds = scanAll(env, buildRequest(totalParts, {}, 2));
+        ASSERT_EQ(expected.size(), vIds.size());
+        ASSERT_EQ(expected, std::set<std::string>(vIds.begin(), vIds.end()));
     }
-    auto req = buildRequest(partId, "", rowLimit, true, false, tagIds);
-
-    while (true) {
-        auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-        auto f = processor->getFuture();
-        processor->process(req);
-        auto resp = std::move(f).get();
-        checkResponse(partId, resp, cursor, rowCount, expectRowCount, 6, true, false, tagIds);
-        if (cursor.empty()) {
-            break;
-        }
-
-        req = buildRequest(partId, cursor, rowLimit, true, false, tagIds);
+    {
+        LOG(INFO) << "Scan by the limit of bytes, the parts in parallel";
+        folly::CPUThreadPoolExecutor executor(4);
+        auto req = buildRequest(totalParts);
+        req.max_bytes = 1;
+        auto vIds = scanAll(env, req, &executor);
+        ASSERT_EQ(expected.size(), vIds.size());
+        ASSERT_EQ(expected, std::set<std::string>(vIds.begin(), vIds.end()));
     }
-    EXPECT_EQ(rowCount, 90);
-}
-
-// Retrive vertices of some property in a part
-TEST(ScanVertexTest, RetrieveConsecutiveBlockTest2) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-
-    std::string cursor = "";
-    // fetch 90 rows in total within 9 blocks, first 8 blocks will get 8 * 11 = 88 rows,
-    // last block will get 2 row, 11 * 8 + 2 = 90
-    int32_t rowCount = 0, rowLimit = 11, expectRowCount = 11;
-    PartitionID partId = 1;
-    std::unordered_set<TagID> tagIds;
-    for (TagID tagId = 3001; tagId < 3010; tagId++) {
-        tagIds.emplace(tagId);
+    {
+        LOG(INFO) << "Invalid cursor";
+        auto req = buildRequest(totalParts);
+        req.parts[1] = "bad";
+        auto resp = scan(env, req);
+        ASSERT_EQ(1, resp.result.failed_parts.size());
+        ASSERT_EQ(cpp2::ErrorCode::E_INVALID_OPERATION, resp.result.failed_parts[0].code);
     }
-    auto req = buildRequest(partId, "", rowLimit, false, false, tagIds);
-    int32_t batchCount = 0;
+    ASSERT_EQ(0, ScanSnapshots::instance()->size());
+}
 
-    while (true) {
-        auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-        auto f = processor->getFuture();
-        processor->process(req);
-        auto resp = std::move(f).get();
-        ++batchCount;
-        if (batchCount == 9) {
-            expectRowCount = 2;
+TEST(ScanVertexTest, SnapshotTest) {
+    fs::TempDir rootPath("/tmp/ScanVertexSnapshotTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    auto expected = allVertices();
+
+    // Remove all vertices after the first page
+    auto removeAll = [&] (int32_t page) {
+        if (page != 1) {
+            return;
         }
-
-        checkResponse(partId, resp, cursor, rowCount, expectRowCount, 2, false, false, tagIds);
-        if (cursor.empty()) {
-            break;
+        auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+        std::hash<std::string> hash;
+        std::unordered_map<PartitionID, std::vector<std::string>> keys;
+        for (const auto& vertex : mock::MockData::mockVertices()) {
+            PartitionID partId = (hash(vertex.vId_) % totalParts) + 1;
+            keys[partId].emplace_back(
+                NebulaKeyUtils::vertexKey(vIdLen, partId, vertex.vId_, vertex.tId_, 0L));
         }
-        req = buildRequest(partId, cursor, rowLimit, false, false, tagIds);
-    }
-    EXPECT_EQ(rowCount, 90);
-}
-
-// Retrive vertices of none property in a part
-TEST(ScanVertexTest, RetrieveConsecutiveBlockTest3) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-
-    std::string cursor = "";
-    // fetch 900 rows one by one
-    int32_t rowCount = 0, rowLimit = 1, expectRowCount = 1;
-    PartitionID partId = 1;
-    std::unordered_set<TagID> tagIds;
-    for (TagID tagId = 3001; tagId < 3010; tagId++) {
-        tagIds.emplace(tagId);
-    }
-    auto req = buildRequest(partId, "", rowLimit, false, true, tagIds);
-    int32_t batchCount = 0;
-
-    while (true) {
-        auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-        auto f = processor->getFuture();
-        processor->process(req);
-        auto resp = std::move(f).get();
-        ++batchCount;
-
-        checkResponse(partId, resp, cursor, rowCount, expectRowCount, 0, false, true, tagIds);
-        if (cursor.empty()) {
-            break;
+        for (auto& part : keys) {
+            folly::Baton<true, std::atomic> baton;
+            env->kvstore_->asyncMultiRemove(1, part.first, std::move(part.second),
+                                            [&] (kvstore::ResultCode code) {
+                                                EXPECT_EQ(kvstore::ResultCode::SUCCEEDED, code);
+                                                baton.post();
+                                            });
+            baton.wait();
         }
-        req = buildRequest(partId, cursor, rowLimit, false, true, tagIds);
+    };
+
+    {
+        LOG(INFO) << "The pinned scan sees the vertices when it begins";
+        ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+        auto vIds = scanAll(env, buildRequest(totalParts, {}, 1), nullptr, removeAll);
+        ASSERT_EQ(expected.size(), vIds.size());
+        ASSERT_EQ(expected, std::set<std::string>(vIds.begin(), vIds.end()));
+        ASSERT_EQ(0, ScanSnapshots::instance()->size());
     }
-    EXPECT_EQ(rowCount, 90);
-}
-
-TEST(ScanVertexTest, RetrieveManyPartsTest) {
-    fs::TempDir rootPath("/tmp/ScanVertexTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path(), 10);
-
-    LOG(INFO) << "Prepare meta...";
-    auto schemaMan = TestUtils::mockSchemaMan();
-    LOG(INFO) << "Prepare data...";
-    mockData(kv.get());
-    // 10vId * 5tag * 10part = 500 rows
-    std::unordered_set<TagID> tagIds;
-    for (TagID tagId = 3001; tagId < 3010; tagId += 2) {
-        tagIds.emplace(tagId);
+    {
+        LOG(INFO) << "The scan not pinned doesn't see the removed vertices";
+        ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+        auto req = buildRequest(totalParts, {}, 1);
+        req.pin_snapshot = false;
+        auto vIds = scanAll(env, req, nullptr, removeAll);
+        // only the first page of each part is got
+        ASSERT_LE(vIds.size(), static_cast<size_t>(totalParts));
+        ASSERT_LT(vIds.size(), expected.size());
+        ASSERT_EQ(0, ScanSnapshots::instance()->size());
     }
+}
 
-    // scan through all partition
-    int32_t totalRowCount = 0;
-    for (PartitionID partId = 0; partId < 10; partId++) {
-        std::string cursor = "";
-        int32_t rowCount = 0, rowLimit = 10, expectRowCount = 10;
-        auto req = buildRequest(partId, "", rowLimit, false, false, tagIds);
-        int32_t batchCount = 0;
-
-        while (true) {
-            auto* processor = ScanVertexProcessor::instance(kv.get(), schemaMan.get(), nullptr);
-            auto f = processor->getFuture();
-            processor->process(req);
-            auto resp = std::move(f).get();
-            ++batchCount;
-
-            checkResponse(partId, resp, cursor, rowCount, expectRowCount, 2, false, false, tagIds);
-            if (cursor.empty()) {
-                break;
-            }
-            req = buildRequest(partId, cursor, rowLimit, false, false, tagIds);
+TEST(ScanVertexTest, SnapshotLifetimeTest) {
+    gflags::FlagSaver flagSaver;
+    fs::TempDir rootPath("/tmp/ScanVertexSnapshotLifetimeTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto* snapshots = ScanSnapshots::instance();
+    auto pin = [&] (PartitionID partId, int64_t* id) {
+        auto part = env->kvstore_->part(1, partId);
+        EXPECT_TRUE(ok(part));
+        auto* engine = nebula::value(part)->engine();
+        auto pinned = snapshots->pin(env->kvstore_, 1, partId, engine, id);
+        EXPECT_TRUE(ok(pinned));
+    };
+
+    {
+        LOG(INFO) << "The expired snapshots are dropped by the worker without any new scan";
+        FLAGS_scan_snapshot_expire_secs = 1;
+        ASSERT_TRUE(snapshots->init());
+        int64_t id;
+        pin(1, &id);
+        pin(2, &id);
+        ASSERT_EQ(2, snapshots->size());
+        for (int32_t i = 0; i < 50 && snapshots->size() > 0; i++) {
+            usleep(100000);
         }
-        EXPECT_EQ(rowCount, 50);
-        totalRowCount += rowCount;
+        ASSERT_EQ(0, snapshots->size());
+        snapshots->stop();
+    }
+    {
+        LOG(INFO) << "The snapshot held by a scan is released after the space is dropped";
+        int64_t id;
+        pin(1, &id);
+        auto part = env->kvstore_->part(1, 1);
+        ASSERT_TRUE(ok(part));
+        auto* engine = nebula::value(part)->engine();
+        auto snapshot = snapshots->get(id, 1, 1, engine);
+        ASSERT_NE(nullptr, snapshot);
+        snapshots->release(id);
+        auto* store = dynamic_cast<kvstore::NebulaStore*>(env->kvstore_);
+        ASSERT_NE(nullptr, store);
+        store->removeSpace(1);
+        ASSERT_FALSE(ok(env->kvstore_->part(1, 1)));
+        // The engine is still open to read the snapshot
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::partPrefix(1);
+        EXPECT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  snapshot->engine()->prefix(prefix, &iter, snapshot->snapshot()));
+        iter.reset();
+        snapshot.reset();
+        ASSERT_EQ(0, snapshots->size());
     }
-    EXPECT_EQ(totalRowCount, 500);
 }
 
 }  // namespace storage
 }  // namespace nebula
 
-
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     folly::init(&argc, &argv, true);
@@ -103,6 +103,30 @@ TEST(StoragehHttpAdminHandlerTest, AdminTest) {
         ASSERT_TRUE(resp.ok());
         ASSERT_EQ("ok", resp.value());
     }
+    {
+        auto url = "/admin?space=0&op=move_part&part=xx";
+        auto request = folly::stringPrintf("http://%s:%d%s", FLAGS_ws_ip.c_str(),
+                                           FLAGS_ws_http_port, url);
+        auto resp = http::HttpClient::get(request);
+        ASSERT_TRUE(resp.ok());
+        ASSERT_EQ(0, resp.value().find("Part and path should be numbers"));
+    }
+    {
+        auto url = "/admin?space=0&op=move_part&part=1&path=10";
+        auto request = folly::stringPrintf("http://%s:%d%s", FLAGS_ws_ip.c_str(),
+                                           FLAGS_ws_http_port, url);
+        auto resp = http::HttpClient::get(request);
+        ASSERT_TRUE(resp.ok());
+        ASSERT_EQ(0, resp.value().find("Move part failed"));
+    }
+    {
+        auto url = "/admin?op=balance_data_path";
+        auto request = folly::stringPrintf("http://%s:%d%s", FLAGS_ws_ip.c_str(),
+                                           FLAGS_ws_http_port, url);
+        auto resp = http::HttpClient::get(request);
+        ASSERT_TRUE(resp.ok());
+        ASSERT_EQ("ok", resp.value());
+    }
 }
 
 }  // namespace storage
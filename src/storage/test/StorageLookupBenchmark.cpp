@@ -5,289 +5,264 @@
  */
 
 #include "common/base/Base.h"
-#include "common/fs/FileUtils.h"
-#include "common/clients/storage/GraphStorageClient.h"
-#include "common/meta/ServerBasedSchemaManager.h"
-#include "kvstore/KVStore.h"
-#include "kvstore/NebulaStore.h"
-#include "storage/test/AdHocSchemaManager.h"
-#include "storage/test/TestUtils.h"
-#include "storage/StorageFlags.h"
-#include "storage/index/LookUpVertexIndexProcessor.h"
-#include "codec/RowWriter.h"
+#include "common/fs/TempDir.h"
 #include <folly/Benchmark.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include "mock/AdHocIndexManager.h"
+#include "mock/MockCluster.h"
+#include "storage/index/LookupProcessor.h"
+#include "storage/test/QueryTestUtils.h"
+#include "utils/IndexKeyUtils.h"
 
 DEFINE_int64(total_vertices_size, 1000000, "The number of vertices");
-DEFINE_string(root_data_path, "/tmp/LookUpPref", "Engine data path");
+DEFINE_int32(lookup_threads, 8, "Threads to run the parts of lookup in parallel");
+
+std::unique_ptr<nebula::mock::MockCluster> gCluster;
+std::unique_ptr<folly::IOThreadPoolExecutor> gExecutor;
 
 namespace nebula {
 namespace storage {
 
-GraphSpaceID spaceId = 0;
-TagID tagId = 1;
-IndexID indexId = 1;
-PartitionID partId = 0;
-static int64_t modeInt = 100;
+GraphSpaceID spaceId = 1;
+TagID player = 1;
+// index on player.age
+IndexID ageIndex = 4;
+// age of vertex i is i % kAges, so a value of age hits 1% of the vertices
+constexpr int64_t kAges = 100;
 
-using IndexValues = std::vector<std::pair<nebula::cpp2::SupportedType, std::string>>;
+void addAgeIndex(StorageEnv* env) {
+    auto* indexMan = dynamic_cast<mock::AdHocIndexManager*>(env->indexMan_);
+    CHECK_NOTNULL(indexMan);
+    std::vector<nebula::meta::cpp2::ColumnDef> cols;
+    meta::cpp2::ColumnDef col;
+    col.set_name("age");
+    col.set_type(meta::cpp2::PropertyType::INT64);
+    cols.emplace_back(std::move(col));
+    indexMan->addTagIndex(spaceId, ageIndex, player, std::move(cols));
+}
 
-std::string indexStr(RowReader* reader, const std::string& col) {
-    auto res = RowReader::getPropByName(reader, col);
-    if (!ok(res)) {
-        LOG(ERROR) << "Skip bad column prop " << col;
-        return "";
+// Write the player rows and their index keys of age
+void genData(StorageEnv* env, int32_t totalParts) {
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+    auto schema = env->schemaMan_->getTagSchema(spaceId, player);
+    CHECK(!!schema);
+    std::hash<std::string> hash;
+    std::unordered_map<PartitionID, std::vector<kvstore::KV>> data;
+    for (int64_t i = 0; i < FLAGS_total_vertices_size; i++) {
+        auto vId = folly::stringPrintf("player_%ld", i);
+        PartitionID partId = (hash(vId) % totalParts) + 1;
+        int64_t age = i % kAges;
+        std::vector<Value> props = {Value(vId), Value(age), Value(true), Value(10L),
+                                    Value(2000L), Value(2010L), Value(i % 1000), Value(20.0),
+                                    Value(1L), Value("America"), Value(NullType::__NULL__)};
+        auto key = NebulaKeyUtils::vertexKey(vIdLen, partId, vId, player, 0L);
+        CHECK(QueryTestUtils::encode(schema.get(), key, props, data[partId]));
+        auto indexKey = IndexKeyUtils::vertexIndexKey(vIdLen, partId, ageIndex, vId, {Value(age)});
+        data[partId].emplace_back(std::move(indexKey), "");
     }
-    auto&& v = value(std::move(res));
-    return NebulaKeyUtils::encodeInt64(boost::get<int64_t>(v));
+    for (auto& entry : data) {
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncMultiPut(spaceId, entry.first, std::move(entry.second),
+                                     [&baton] (kvstore::ResultCode code) {
+                                         CHECK_EQ(kvstore::ResultCode::SUCCEEDED, code);
+                                         baton.post();
+                                     });
+        baton.wait();
+    }
+    CHECK_EQ(kvstore::ResultCode::SUCCEEDED, env->kvstore_->compact(spaceId));
+}
+
+void setUp(const char* path) {
+    gCluster = std::make_unique<nebula::mock::MockCluster>();
+    gCluster->initStorageKV(path);
+    auto* env = gCluster->storageEnv_.get();
+    addAgeIndex(env);
+    genData(env, gCluster->getTotalParts());
+    gExecutor = std::make_unique<folly::IOThreadPoolExecutor>(FLAGS_lookup_threads);
+}
+
+cpp2::IndexColumnHint prefixHint(int64_t age) {
+    cpp2::IndexColumnHint hint;
+    hint.set_column_name("age");
+    hint.set_scan_type(cpp2::ScanType::PREFIX);
+    hint.set_begin_value(Value(age));
+    return hint;
 }
 
-IndexValues collectIndexValues(RowReader* reader,
-                               const std::vector<nebula::cpp2::ColumnDef>& cols) {
-    IndexValues values;
-    if (reader == nullptr) {
-        return values;
+cpp2::IndexColumnHint rangeHint(int64_t begin, int64_t end) {
+    cpp2::IndexColumnHint hint;
+    hint.set_column_name("age");
+    hint.set_scan_type(cpp2::ScanType::RANGE);
+    hint.set_begin_value(Value(begin));
+    hint.set_end_value(Value(end));
+    return hint;
+}
+
+cpp2::LookupIndexRequest buildRequest(std::vector<cpp2::IndexColumnHint> hints,
+                                      std::vector<std::string> returnCols,
+                                      const std::string& filter = "",
+                                      int64_t limit = -1) {
+    cpp2::LookupIndexRequest req;
+    req.set_space_id(spaceId);
+    std::vector<PartitionID> parts;
+    for (PartitionID partId = 1; partId <= gCluster->getTotalParts(); partId++) {
+        parts.emplace_back(partId);
     }
-    for (auto& col : cols) {
-        auto val = indexStr(reader, col.get_name());
-        values.emplace_back(col.get_type().get_type(), std::move(val));
+    req.set_parts(std::move(parts));
+    cpp2::IndexQueryContext context;
+    context.set_index_id(ageIndex);
+    context.set_filter(filter);
+    context.set_column_hints(std::move(hints));
+    cpp2::IndexSpec indices;
+    indices.set_contexts({context});
+    indices.set_is_edge(false);
+    indices.set_tag_or_edge_id(player);
+    req.set_indices(std::move(indices));
+    req.set_return_columns(std::move(returnCols));
+    if (limit >= 0) {
+        req.set_limit(limit);
     }
-    return values;
+    return req;
 }
 
-std::string genVertexIndexKey(meta::SchemaManager* schemaMan,
-                              const std::string &prop,
-                              std::shared_ptr<nebula::cpp2::IndexItem> &index,
-                              VertexID vId) {
-    auto reader = RowReader::getTagPropReader(schemaMan,
-                                              prop,
-                                              spaceId,
-                                              tagId);
-    auto values = collectIndexValues(reader.get(),
-                                     index->get_fields());
-    auto indexKey = NebulaKeyUtils::vertexIndexKey(partId,
-                                                   index->get_index_id(),
-                                                   vId,
-                                                   values);
-    return indexKey;
+// $^.player.games < 500, on a prop which is not in the index
+std::string gamesFilter() {
+    RelationalExpression exp(
+        Expression::Kind::kRelLT,
+        new SourcePropertyExpression(new std::string(folly::to<std::string>(player)),
+                                     new std::string("games")),
+        new ConstantExpression(Value(500L)));
+    return Expression::encode(exp);
 }
 
-std::unique_ptr<AdHocSchemaManager> mockSchemaMan() {
-    auto schemaMan = std::make_unique<AdHocSchemaManager>();
-    nebula::cpp2::Schema schema;
-    for (int32_t i = 0; i < 3; i++) {
-        nebula::cpp2::ColumnDef column;
-        column.name = folly::stringPrintf("col_%d", i);
-        column.type.type = nebula::cpp2::SupportedType::INT;
-        schema.columns.emplace_back(std::move(column));
-    }
-    schemaMan->addTagSchema(spaceId, tagId,
-                            std::make_shared<ResultSchemaProvider>(std::move(schema)));
-    return schemaMan;
+// $^.player.age < 10, on the index column
+std::string ageFilter() {
+    RelationalExpression exp(
+        Expression::Kind::kRelLT,
+        new SourcePropertyExpression(new std::string(folly::to<std::string>(player)),
+                                     new std::string("age")),
+        new ConstantExpression(Value(10L)));
+    return Expression::encode(exp);
 }
 
-std::unique_ptr<meta::IndexManager> mockIndexMan() {
-    auto* indexMan = new AdHocIndexManager();
-    std::vector<nebula::cpp2::ColumnDef> columns;
-    for (int32_t i = 0; i < 3; i++) {
-        nebula::cpp2::ColumnDef column;
-        column.name = folly::stringPrintf("col_%d", i);
-        column.type.type = nebula::cpp2::SupportedType::INT;
-        columns.emplace_back(std::move(column));
+void lookup(int32_t iters, const cpp2::LookupIndexRequest& req, bool parallel) {
+    auto* env = gCluster->storageEnv_.get();
+    size_t rows = 0;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        auto* processor = LookupProcessor::instance(env,
+                                                    nullptr,
+                                                    nullptr,
+                                                    parallel ? gExecutor.get() : nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        CHECK(resp.result.failed_parts.empty());
+        rows += resp.get_data()->rows.size();
     }
-    indexMan->addTagIndex(spaceId, indexId, tagId, std::move(columns));
-    std::unique_ptr<meta::IndexManager> im(indexMan);
-    return im;
+    folly::doNotOptimizeAway(rows);
 }
 
-std::string genVertexProp(int64_t vId) {
-    RowWriter writer;
-    int64_t colVal = folly::to<int64_t >(vId % modeInt);
-    writer << colVal << colVal << colVal;
-    return writer.encode();
-}
+}  // namespace storage
+}  // namespace nebula
 
-bool genData(kvstore::KVStore* kv,
-             meta::SchemaManager* schemaMan,
-             std::shared_ptr<nebula::cpp2::IndexItem> &index) {
-    std::vector<kvstore::KV> data;
-    for (auto i = 0; i < FLAGS_total_vertices_size; i++) {
-        auto val = genVertexProp(i);
-        auto indexKey = genVertexIndexKey(schemaMan, val, index, i);
-        data.emplace_back(std::move(indexKey), "");
+using nebula::storage::buildRequest;
+using nebula::storage::prefixHint;
+using nebula::storage::rangeHint;
+
+// age == 42, hits 1% of vertices
+BENCHMARK(PrefixIndexOnly, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({prefixHint(42)}, {"age"});
     }
-    folly::Baton<true, std::atomic> baton;
-    bool ret = false;
-    kv->asyncMultiPut(spaceId, partId, std::move(data),
-                      [&ret, &baton] (kvstore::ResultCode code) {
-                          if (kvstore::ResultCode::SUCCEEDED == code) {
-                              ret = true;
-                          }
-                          baton.post();
-                      });
-    baton.wait();
-    if (!ret) {
-        return false;
+    nebula::storage::lookup(iters, req, false);
+}
+BENCHMARK_RELATIVE(PrefixIndexOnlyParallel, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({prefixHint(42)}, {"age"});
     }
-
-    auto code = kv->compact(spaceId);
-    if (code != kvstore::ResultCode::SUCCEEDED) {
-        return false;
+    nebula::storage::lookup(iters, req, true);
+}
+BENCHMARK_RELATIVE(PrefixFetchData, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({prefixHint(42)}, {"age", "games"});
     }
-    return true;
+    nebula::storage::lookup(iters, req, false);
 }
-
-bool processLookup(kvstore::KVStore* kv,
-                   meta::SchemaManager* schemaMan,
-                   meta::IndexManager* indexMan,
-                   const std::string& filter,
-                   size_t expectRowNum) {
-    cpp2::LookUpIndexRequest req;
-    decltype(req.parts) parts;
-    parts.emplace_back(partId);
-    req.set_space_id(spaceId);
-    req.set_parts(std::move(parts));
-    req.set_index_id(indexId);
-    req.set_filter(filter);
-    auto* processor = LookUpVertexIndexProcessor::instance(kv, schemaMan, indexMan, nullptr);
-    auto fut = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(fut).get();
+BENCHMARK_RELATIVE(PrefixFetchDataParallel, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
     BENCHMARK_SUSPEND {
-        if (resp.result.failed_codes.size() > 0) {
-            LOG(ERROR) << "Process error";
-            return false;
-        }
-        if (resp.rows.size() != expectRowNum) {
-            LOG(ERROR) << "Row number error , expected : " << expectRowNum
-                       << " actual ： " << resp.rows.size();
-            return false;
-        }
-    };
-    return true;
+        req = buildRequest({prefixHint(42)}, {"age", "games"});
+    }
+    nebula::storage::lookup(iters, req, true);
 }
 
-/**
- *
- * where col1 = XXXXX
- */
-void lookupExec(int32_t expectRowNum,
-                const std::string& filter) {
-    std::unique_ptr<kvstore::KVStore> kv;
-    std::unique_ptr<meta::SchemaManager> schemaMan;
-    std::unique_ptr<meta::IndexManager> indexMan;
-    std::shared_ptr<nebula::cpp2::IndexItem> index;
+BENCHMARK_DRAW_LINE();
+
+// 40 <= age < 50, hits 10% of vertices
+BENCHMARK(RangeIndexOnly, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
     BENCHMARK_SUSPEND {
-        std::string rootPath;
-        rootPath = folly::stringPrintf("%s/%s_%d",
-                                       FLAGS_root_data_path.c_str(),
-                                       "Precise", expectRowNum);
-        kv = TestUtils::initKV(std::move(rootPath).c_str());
-        schemaMan = mockSchemaMan();
-        indexMan = mockIndexMan();
-        auto iRet = indexMan->getTagIndex(spaceId, indexId);
-        if (!iRet.ok()) {
-            LOG(ERROR) << "Index get error";
-            return;
-        }
-        index = iRet.value();
-        if (!genData(kv.get(), schemaMan.get(), index)) {
-            LOG(ERROR) << "Data load error";
-            return;
-        }
-    };
-    auto ret = processLookup(kv.get(), schemaMan.get(), indexMan.get(), filter, expectRowNum);
-    if (!ret) {
-        LOG(ERROR) << "Processor error";
-        return;
+        req = buildRequest({rangeHint(40, 50)}, {"age"});
     }
+    nebula::storage::lookup(iters, req, false);
 }
-
-void lookupPrecise(int32_t expectRowNum) {
-    auto* col = new std::string("col_0");
-    auto* alias = new std::string("col0");
-    auto* ape = new AliasPropertyExpression(new std::string(""), alias, col);
-    auto* pe = new PrimaryExpression(1L);
-    auto r =  std::make_unique<RelationalExpression>(ape,
-                                                     RelationalExpression::Operator::EQ,
-                                                     pe);
-    lookupExec(expectRowNum, Expression::encode(r.get()));
+BENCHMARK_RELATIVE(RangeIndexOnlyParallel, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({rangeHint(40, 50)}, {"age"});
+    }
+    nebula::storage::lookup(iters, req, true);
 }
-
-void lookupFilter(int32_t expectRowNum) {
-    auto* col = new std::string("col_0");
-    auto* alias = new std::string("col0");
-    auto* ape = new AliasPropertyExpression(new std::string(""), alias, col);
-    auto* pe = new PrimaryExpression(1L);
-    auto r =  std::make_unique<RelationalExpression>(ape,
-                                                     RelationalExpression::Operator::LT,
-                                                     pe);
-    lookupExec(expectRowNum, Expression::encode(r.get()));
+// Also 10% of vertices, but scan the whole index and filter by the age in index key
+BENCHMARK_RELATIVE(FullScanIndexFilter, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({}, {"age"}, nebula::storage::ageFilter());
+    }
+    nebula::storage::lookup(iters, req, false);
 }
-
-BENCHMARK(PreciseScan_10000) {
-    modeInt = 100;
-    lookupPrecise(10000);
+BENCHMARK_RELATIVE(RangeDataFilter, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({rangeHint(40, 50)}, {"age"}, nebula::storage::gamesFilter());
+    }
+    nebula::storage::lookup(iters, req, false);
 }
-
-BENCHMARK(PreciseScan_100) {
-    modeInt = 10000;
-    lookupPrecise(100);
+BENCHMARK_RELATIVE(RangeDataFilterParallel, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({rangeHint(40, 50)}, {"age"}, nebula::storage::gamesFilter());
+    }
+    nebula::storage::lookup(iters, req, true);
 }
 
-BENCHMARK(PreciseScan_10) {
-    modeInt = 100000;
-    lookupPrecise(10);
-}
+BENCHMARK_DRAW_LINE();
 
-BENCHMARK(FilterScan_1) {
-    modeInt = FLAGS_total_vertices_size;
-    lookupFilter(1);
+// 40 <= age < 50 limit 100
+BENCHMARK(RangeLimit, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({rangeHint(40, 50)}, {"age", "games"}, "", 100);
+    }
+    nebula::storage::lookup(iters, req, false);
+}
+BENCHMARK_RELATIVE(RangeLimitParallel, iters) {
+    nebula::storage::cpp2::LookupIndexRequest req;
+    BENCHMARK_SUSPEND {
+        req = buildRequest({rangeHint(40, 50)}, {"age", "games"}, "", 100);
+    }
+    nebula::storage::lookup(iters, req, true);
 }
-
-}  // namespace storage
-}  // namespace nebula
 
 int main(int argc, char** argv) {
     folly::init(&argc, &argv, true);
+    nebula::fs::TempDir rootPath("/tmp/StorageLookupBenchmark.XXXXXX");
+    nebula::storage::setUp(rootPath.path());
     folly::runBenchmarks();
+    gExecutor.reset();
+    gCluster.reset();
     return 0;
 }
-
-
-/**
- * CPU : Intel(R) Core(TM) i7-9750H CPU @ 2.60GHz
- * MemTotal : 8G
- * Total vertices : 1000000
- * Total partition number : 1
- * tag (col_0 int, col_1 int, col_2 int)
- * index on tag (col_0, col_1, col_2)
- *
- * PreciseScan_10000 : Prefix scan and no expression filtering is required.
- *                     Return 10000 vertices.
- *                     Where clause col_1 == 1
- *
- * PreciseScan_100   : Prefix scan and no expression filtering is required.
- *                     Return 100 vertices.
- *                     Where clause col_1 == 1
- *
- * PreciseScan_10    : Prefix scan and no expression filtering is required.
- *                     Return 10 vertices.
- *                     Where clause col_1 == 1
- *
- * FilterScan_10     : Index scan and expression filtering is required.
- *                     Return 1 vertex.
- *                     Where clause col_1 < 1
- *
- **/
-
-/**
- * ============================================================================
- * src/storage/test/StorageLookupBenchmark.cpp relative  time/iter  iters/s
- * ============================================================================
- * PreciseScan_10000                                          9.65ms   103.65
- * PreciseScan_100                                            5.23ms   191.03
- * PreciseScan_10                                             4.14ms   241.64
- * FilterScan_10                                              1.47s  679.35m
- * ============================================================================
- **/
-
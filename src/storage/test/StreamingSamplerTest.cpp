@@ -0,0 +1,107 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/exec/StreamingSampler.h"
+
+namespace nebula {
+namespace storage {
+
+std::vector<size_t> sample(StreamingSampler<size_t>& sampler, size_t n, uint64_t seed) {
+    sampler.reset(seed);
+    for (size_t i = 0; i < n; i++) {
+        auto idx = sampler.offer();
+        if (idx >= 0) {
+            sampler.slot(idx) = i;
+        }
+    }
+    std::vector<size_t> result;
+    for (size_t i = 0; i < sampler.size(); i++) {
+        result.emplace_back(sampler.slot(i));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(StreamingSamplerTest, SimpleTest) {
+    StreamingSampler<size_t> sampler(10);
+    {
+        // less items than k, all of them are sampled
+        auto result = sample(sampler, 5, 0);
+        EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 4}), result);
+    }
+    {
+        auto result = sample(sampler, 1000, 0);
+        EXPECT_EQ(10, result.size());
+        EXPECT_EQ(1000, sampler.count());
+        // no duplicate samples
+        EXPECT_EQ(result.end(), std::unique(result.begin(), result.end()));
+    }
+    {
+        StreamingSampler<size_t> empty(0);
+        EXPECT_EQ(0, sample(empty, 1000, 0).size());
+    }
+}
+
+TEST(StreamingSamplerTest, SeedTest) {
+    StreamingSampler<size_t> sampler(10);
+    auto first = sample(sampler, 100000, 2020);
+    auto second = sample(sampler, 100000, 2020);
+    EXPECT_EQ(first, second);
+    auto third = sample(sampler, 100000, 2021);
+    EXPECT_NE(first, third);
+}
+
+TEST(StreamingSamplerTest, UniformTest) {
+    size_t k = 10, n = 100, rounds = 20000;
+    StreamingSampler<size_t> sampler(k);
+    std::vector<size_t> hits(n, 0);
+    for (size_t round = 0; round < rounds; round++) {
+        for (auto i : sample(sampler, n, round)) {
+            hits[i]++;
+        }
+    }
+    // every item is expected to be sampled k / n * rounds = 2000 times
+    double expected = static_cast<double>(k) / n * rounds;
+    for (size_t i = 0; i < n; i++) {
+        EXPECT_NEAR(expected, hits[i], expected * 0.15) << "item " << i;
+    }
+}
+
+TEST(StreamingSamplerTest, WeightedTest) {
+    size_t n = 4, rounds = 20000;
+    std::vector<double> weights = {1, 2, 4, 0};
+    StreamingSampler<size_t> sampler(1);
+    std::vector<size_t> hits(n, 0);
+    for (size_t round = 0; round < rounds; round++) {
+        sampler.reset(round);
+        for (size_t i = 0; i < n; i++) {
+            auto idx = sampler.offer(weights[i]);
+            if (idx >= 0) {
+                sampler.slot(idx) = i;
+            }
+        }
+        ASSERT_EQ(1, sampler.size());
+        hits[sampler.slot(0)]++;
+    }
+    // with k = 1, the chance of each item is proportional to its weight
+    EXPECT_NEAR(rounds / 7.0, hits[0], rounds * 0.02);
+    EXPECT_NEAR(rounds * 2 / 7.0, hits[1], rounds * 0.02);
+    EXPECT_NEAR(rounds * 4 / 7.0, hits[2], rounds * 0.02);
+    // an item of non-positive weight is never sampled
+    EXPECT_EQ(0, hits[3]);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -5,154 +5,365 @@
  */
 
 #include "common/base/Base.h"
+#include "common/base/ConcurrentLRUCache.h"
 #include "common/fs/TempDir.h"
+#include "common/time/Duration.h"
 #include "utils/NebulaKeyUtils.h"
 #include <gtest/gtest.h>
-#include <rocksdb/db.h>
-#include "storage/test/TestUtils.h"
+#include "storage/cache/VertexCache.h"
 #include "storage/mutate/AddVerticesProcessor.h"
-#include "storage/query/QueryVertexPropsProcessor.h"
-#include "codec/RowReader.h"
+#include "storage/mutate/DeleteVerticesProcessor.h"
+#include "storage/test/TestUtils.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
 
-DECLARE_int32(max_handlers_per_req);
+DECLARE_bool(enable_vertex_cache);
 
 namespace nebula {
 namespace storage {
 
-void addVertices(kvstore::KVStore* kv,  meta::SchemaManager* schemaMan,
-                 meta::IndexManager* indexMan, VertexCache* cache, int nums) {
-    LOG(INFO) << "Build AddVerticesRequest...";
-    auto* processor = AddVerticesProcessor::instance(kv, schemaMan, indexMan, nullptr, cache);
-    cpp2::AddVerticesRequest req;
-    req.space_id = 0;
-    req.overwritable = true;
-    auto vertices = TestUtils::setupVertices(0, 0, nums, 3001, 3002);
-    req.parts.emplace(0, std::move(vertices));
-
-    LOG(INFO) << "Test AddVerticesProcessor...";
-    auto fut = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(fut).get();
-    EXPECT_EQ(0, resp.result.failed_codes.size());
+using LRUCache = ConcurrentLRUCache<std::pair<VertexID, TagID>, std::string>;
+
+// Generate the ranks [0, n) following a zipfian distribution
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(size_t n, double skew, uint32_t seed)
+        : cdf_(n)
+        , rng_(seed) {
+        double sum = 0;
+        for (size_t i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, skew);
+            cdf_[i] = sum;
+        }
+        for (auto& c : cdf_) {
+            c /= sum;
+        }
+    }
+
+    size_t next() {
+        auto p = dist_(rng_);
+        return std::lower_bound(cdf_.begin(), cdf_.end(), p) - cdf_.begin();
+    }
+
+private:
+    std::vector<double>                     cdf_;
+    std::mt19937                            rng_;
+    std::uniform_real_distribution<double>  dist_{0.0, 1.0};
+};
+
+// Each access is a read, the row is filled into the cache on miss
+struct Workload {
+    static constexpr size_t kHotVertices = 100000;
+    static constexpr size_t kScanVertices = 1000000;
+    static constexpr size_t kValSize = 100;
+
+    // Accesses of zipfian reads, with a one-hit-wonder scan mixed in every
+    // 'scanEvery' accesses
+    static std::vector<std::string> build(size_t accesses, size_t scanEvery, uint32_t seed) {
+        ZipfianGenerator zipf(kHotVertices, 0.99, seed);
+        std::vector<std::string> vIds;
+        vIds.reserve(accesses);
+        size_t scanned = 0;
+        for (size_t i = 0; i < accesses; i++) {
+            if (scanEvery > 0 && i % scanEvery == 0) {
+                vIds.emplace_back(folly::stringPrintf("scan_%lu", scanned++ % kScanVertices));
+            } else {
+                vIds.emplace_back(folly::stringPrintf("hot_%lu", zipf.next()));
+            }
+        }
+        return vIds;
+    }
+};
+
+double runLRU(LRUCache& cache, const std::vector<std::string>& vIds, TagID tagId) {
+    std::string val(Workload::kValSize, 'v');
+    size_t hits = 0;
+    for (const auto& vId : vIds) {
+        auto key = std::make_pair(vId, tagId);
+        auto ret = cache.get(key, 1);
+        if (ret.ok()) {
+            hits++;
+        } else {
+            cache.insert(key, val, 1);
+        }
+    }
+    return static_cast<double>(hits) / vIds.size();
+}
+
+double runVertexCache(VertexCache& cache, const std::vector<std::string>& vIds, TagID tagId) {
+    std::string val(Workload::kValSize, 'v');
+    size_t hits = 0;
+    std::string result;
+    for (const auto& vId : vIds) {
+        VertexCache::Key key(1, 1, vId, tagId);
+        if (cache.get(key, &result)) {
+            hits++;
+        } else {
+            cache.insert(key, val, cache.epoch(key));
+        }
+    }
+    return static_cast<double>(hits) / vIds.size();
+}
+
+TEST(VertexCacheTest, SimpleTest) {
+    VertexCache cache(1 << 20, 0);
+    VertexCache::Key key(1, 1, "Tim Duncan", 1);
+    std::string val;
+    EXPECT_FALSE(cache.get(key, &val));
+
+    EXPECT_TRUE(cache.insert(key, "v1", cache.epoch(key)));
+    EXPECT_TRUE(cache.get(key, &val));
+    EXPECT_EQ("v1", val);
+
+    // write through replaces the row
+    EXPECT_TRUE(cache.put(key, "v2"));
+    EXPECT_TRUE(cache.get(key, &val));
+    EXPECT_EQ("v2", val);
+
+    // the same vid of another tag, part or space is another key
+    EXPECT_FALSE(cache.get(VertexCache::Key(1, 1, "Tim Duncan", 2), &val));
+    EXPECT_FALSE(cache.get(VertexCache::Key(1, 2, "Tim Duncan", 1), &val));
+    EXPECT_FALSE(cache.get(VertexCache::Key(2, 1, "Tim Duncan", 1), &val));
+
+    cache.evict(key);
+    EXPECT_FALSE(cache.get(key, &val));
+    EXPECT_EQ(0, cache.bytes());
+    EXPECT_EQ(2, cache.hits());
+    EXPECT_EQ(6, cache.total());
 }
 
-void checkCache(VertexCache* cache, uint64_t evicts, uint64_t hits, uint64_t total) {
-    EXPECT_EQ(evicts, cache->evicts());
-    EXPECT_EQ(hits, cache->hits());
-    EXPECT_EQ(total, cache->total());
+TEST(VertexCacheTest, EpochTest) {
+    VertexCache cache(1 << 20, 0);
+    VertexCache::Key key(1, 1, "Tim Duncan", 1);
+    std::string val;
+
+    // a write is committed while reading, the row read before is stale
+    auto epoch = cache.epoch(key);
+    cache.evict(key);
+    EXPECT_FALSE(cache.insert(key, "stale", epoch));
+    EXPECT_FALSE(cache.get(key, &val));
+
+    epoch = cache.epoch(key);
+    cache.put(key, "new");
+    EXPECT_FALSE(cache.insert(key, "stale", epoch));
+    EXPECT_TRUE(cache.get(key, &val));
+    EXPECT_EQ("new", val);
 }
 
-void prepareData(kvstore::KVStore* kv) {
-    LOG(INFO) << "Prepare data...";
-    std::vector<kvstore::KV> data;
-    TagID tagId = 3001;
-    for (int32_t vertexId = 0; vertexId < 10000; vertexId++) {
-        auto key = NebulaKeyUtils::vertexKey(0, vertexId, tagId, 0);
-        RowWriter writer;
-        for (int64_t numInt = 0; numInt < 3; numInt++) {
-            writer << numInt;
+TEST(VertexCacheTest, EvictPartTest) {
+    VertexCache cache(1 << 20, 2);
+    std::string val;
+    for (PartitionID partId = 1; partId <= 2; partId++) {
+        for (int32_t i = 0; i < 10; i++) {
+            VertexCache::Key key(1, partId, folly::to<std::string>(i), 1);
+            EXPECT_TRUE(cache.insert(key, "v", cache.epoch(key)));
         }
-        for (int32_t numString = 3; numString < 6; numString++) {
-            writer << folly::stringPrintf("tag_string_col_%d", numString);
+    }
+    // the same part of another space
+    EXPECT_TRUE(cache.insert(VertexCache::Key(2, 1, "0", 1), "v",
+                             cache.epoch(VertexCache::Key(2, 1, "0", 1))));
+
+    // the leadership of part 1 changes while a row of it is being read
+    VertexCache::Key reading(1, 1, "reading", 1);
+    auto epoch = cache.epoch(reading);
+    cache.evictPart(1, 1);
+    EXPECT_FALSE(cache.insert(reading, "stale", epoch));
+    for (int32_t i = 0; i < 10; i++) {
+        EXPECT_FALSE(cache.get(VertexCache::Key(1, 1, folly::to<std::string>(i), 1), &val));
+        EXPECT_TRUE(cache.get(VertexCache::Key(1, 2, folly::to<std::string>(i), 1), &val));
+    }
+    EXPECT_TRUE(cache.get(VertexCache::Key(2, 1, "0", 1), &val));
+    EXPECT_EQ(11 * VertexCache::charge(1), cache.bytes());
+}
+
+TEST(VertexCacheTest, LongVidTest) {
+    VertexCache cache(1 << 20, 0);
+    std::string vId(VertexCache::kMaxVidLen + 1, 'a');
+    VertexCache::Key key(1, 1, vId, 1);
+    EXPECT_FALSE(key.cachable());
+    EXPECT_FALSE(cache.insert(key, "val", cache.epoch(key)));
+    EXPECT_FALSE(cache.put(key, "val"));
+    std::string val;
+    EXPECT_FALSE(cache.get(key, &val));
+    // a long vid is not counted as a miss
+    EXPECT_EQ(0, cache.total());
+
+    // truncated vid must not collide with it
+    VertexCache::Key shortKey(1, 1, vId.substr(0, VertexCache::kMaxVidLen), 1);
+    EXPECT_TRUE(shortKey.cachable());
+    EXPECT_FALSE(shortKey == key);
+}
+
+TEST(VertexCacheTest, CapacityTest) {
+    std::string val(100, 'v');
+    auto capacity = 10 * VertexCache::charge(val.size());
+    VertexCache cache(capacity, 0);
+    for (int32_t i = 0; i < 100; i++) {
+        VertexCache::Key key(1, 1, folly::to<std::string>(i), 1);
+        cache.put(key, val);
+        EXPECT_LE(cache.bytes(), capacity);
+    }
+    EXPECT_EQ(capacity, cache.bytes());
+
+    // a row larger than the capacity is never cached
+    VertexCache::Key key(1, 1, "huge", 1);
+    EXPECT_FALSE(cache.put(key, std::string(capacity, 'v')));
+    EXPECT_FALSE(cache.insert(key, std::string(capacity, 'v'), cache.epoch(key)));
+}
+
+TEST(VertexCacheTest, AdmissionTest) {
+    std::string val(100, 'v');
+    VertexCache cache(10 * VertexCache::charge(val.size()), 0);
+    std::string result;
+    // make ten vertices hot
+    for (int32_t round = 0; round < 5; round++) {
+        for (int32_t i = 0; i < 10; i++) {
+            VertexCache::Key key(1, 1, folly::stringPrintf("hot_%d", i), 1);
+            if (!cache.get(key, &result)) {
+                EXPECT_TRUE(cache.insert(key, val, cache.epoch(key)));
+            }
         }
-        auto val = writer.encode();
-        data.emplace_back(std::move(key), std::move(val));
-    }
-    folly::Baton<true, std::atomic> baton;
-    kv->asyncMultiPut(
-        0,
-        0,
-        std::move(data),
-        [&](kvstore::ResultCode code) {
-            EXPECT_EQ(code, kvstore::ResultCode::SUCCEEDED);
-            baton.post();
-        });
-    baton.wait();
+    }
+    // scan over cold vertices, none of them should flush the hot ones out
+    for (int32_t i = 0; i < 100; i++) {
+        VertexCache::Key key(1, 1, folly::stringPrintf("cold_%d", i), 1);
+        EXPECT_FALSE(cache.get(key, &result));
+        EXPECT_FALSE(cache.insert(key, val, cache.epoch(key)));
+    }
+    EXPECT_EQ(100, cache.rejects());
+    for (int32_t i = 0; i < 10; i++) {
+        VertexCache::Key key(1, 1, folly::stringPrintf("hot_%d", i), 1);
+        EXPECT_TRUE(cache.get(key, &result));
+    }
+
+    // once a cold vertex becomes hotter than the victim, it is admitted
+    VertexCache::Key key(1, 1, "cold_0", 1);
+    for (int32_t i = 0; i < 10; i++) {
+        cache.get(key, &result);
+    }
+    EXPECT_TRUE(cache.insert(key, val, cache.epoch(key)));
+    EXPECT_TRUE(cache.get(key, &result));
 }
 
-void fetchVertices(kvstore::KVStore* kv,
-                   meta::SchemaManager* schemaMan,
-                   folly::Executor* executor,
-                   VertexCache* cache,
-                   VertexID start,
-                   VertexID end) {
-    cpp2::VertexPropRequest req;
-    req.set_space_id(0);
-    decltype(req.parts) tmpIds;
-    for (auto vertexId = start; vertexId < end; vertexId++) {
-        tmpIds[0].emplace_back(vertexId);
-    }
-    req.set_parts(std::move(tmpIds));
-    // Return tag props col_0, col_2, col_4
-    decltype(req.return_columns) tmpColumns;
-    TagID tagId = 3001;
-    for (int i = 0; i < 3; i++) {
-        tmpColumns.emplace_back(TestUtils::vertexPropDef(
-            folly::stringPrintf("tag_%d_col_%d", tagId, i * 2), tagId));
-    }
-    req.set_return_columns(std::move(tmpColumns));
-
-    LOG(INFO) << "Test QueryVertexPropsRequest...";
-    auto* processor = QueryVertexPropsProcessor::instance(kv,
-                                                          schemaMan,
-                                                          nullptr,
-                                                          executor,
-                                                          cache);
-    auto f = processor->getFuture();
-    processor->process(req);
-    auto resp = std::move(f).get();
-
-    LOG(INFO) << "Check the results...";
-    EXPECT_EQ(0, resp.result.failed_codes.size());
-    EXPECT_EQ(end - start, resp.vertices.size());
-    auto* vschema = resp.get_vertex_schema();
-    DCHECK(vschema != nullptr);
-    for (auto& vp : resp.vertices) {
-        auto size = std::accumulate(vp.tag_data.cbegin(), vp.tag_data.cend(), 0,
-                                    [vschema](int acc, auto& td) {
-                                        auto it = vschema->find(td.tag_id);
-                                        DCHECK(it != vschema->end());
-                                        return acc + it->second.columns.size();
-                                    });
-        EXPECT_EQ(3, size);
-        checkTagData<int64_t>(vp.tag_data, 3001, "tag_3001_col_0", vschema, 0);
-        checkTagData<int64_t>(vp.tag_data, 3001, "tag_3001_col_2", vschema, 2);
-        checkTagData<std::string>(vp.tag_data, 3001, "tag_3001_col_4", vschema,
-                                  folly::stringPrintf("tag_string_col_4"));
+TEST(VertexCacheTest, HitRatioTest) {
+    TagID tagId = 1;
+    // Both caches could hold 10% of the hot vertices
+    size_t rows = Workload::kHotVertices / 10;
+    auto vIds = Workload::build(2000000, 4, 0);
+    {
+        LOG(INFO) << "Zipfian with scan pollution";
+        LRUCache lru(rows, 4);
+        VertexCache cache(rows * VertexCache::charge(Workload::kValSize), 4);
+        auto lruHitRatio = runLRU(lru, vIds, tagId);
+        auto hitRatio = runVertexCache(cache, vIds, tagId);
+        LOG(INFO) << "LRU hit ratio " << lruHitRatio << ", VertexCache hit ratio " << hitRatio
+                  << ", rejects " << cache.rejects();
+        EXPECT_GT(hitRatio, lruHitRatio);
+    }
+    vIds = Workload::build(2000000, 0, 0);
+    {
+        LOG(INFO) << "Zipfian only";
+        LRUCache lru(rows, 4);
+        VertexCache cache(rows * VertexCache::charge(Workload::kValSize), 4);
+        auto lruHitRatio = runLRU(lru, vIds, tagId);
+        auto hitRatio = runVertexCache(cache, vIds, tagId);
+        LOG(INFO) << "LRU hit ratio " << lruHitRatio << ", VertexCache hit ratio " << hitRatio;
+        EXPECT_GE(hitRatio, lruHitRatio);
     }
 }
 
-TEST(VertexCacheTest, SimpleTest) {
-    FLAGS_max_handlers_per_req = 1;
+TEST(VertexCacheTest, ThroughputTest) {
+    TagID tagId = 1;
+    size_t rows = Workload::kHotVertices / 10;
+    size_t threads = 8;
+    std::vector<std::vector<std::string>> workloads;
+    for (size_t i = 0; i < threads; i++) {
+        workloads.emplace_back(Workload::build(500000, 4, i));
+    }
+
+    auto run = [&] (auto&& func) {
+        time::Duration duration;
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; i++) {
+            workers.emplace_back([&, i] {
+                func(workloads[i]);
+            });
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+        return duration.elapsedInUSec();
+    };
+
+    LRUCache lru(rows, 4);
+    auto lruCost = run([&] (const auto& vIds) {
+        runLRU(lru, vIds, tagId);
+    });
+    VertexCache cache(rows * VertexCache::charge(Workload::kValSize), 4);
+    auto cost = run([&] (const auto& vIds) {
+        runVertexCache(cache, vIds, tagId);
+    });
+    LOG(INFO) << threads << " threads, " << threads * 500000 << " accesses, LRU costs "
+              << lruCost << "us, VertexCache costs " << cost << "us, LRU hit ratio "
+              << static_cast<double>(lru.hits()) / lru.total() << ", VertexCache hit ratio "
+              << static_cast<double>(cache.hits()) / cache.total();
+}
+
+TEST(VertexCacheTest, WriteThroughTest) {
     fs::TempDir rootPath("/tmp/VertexCacheTest.XXXXXX");
-    std::unique_ptr<kvstore::KVStore> kv = TestUtils::initKV(rootPath.path());
-    auto schemaMan = TestUtils::mockSchemaMan();
-    auto indexMan = std::make_unique<AdHocIndexManager>();
-    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(1);
-    prepareData(kv.get());
-    VertexCache cache(1000, 0);
-
-    LOG(INFO) << "Fetch some vertices...";
-    fetchVertices(kv.get(), schemaMan.get(), executor.get(), &cache, 0, 1000);
-    checkCache(&cache, 0, 0, 1000);
-
-    fetchVertices(kv.get(), schemaMan.get(), executor.get(), &cache, 500, 1500);
-    checkCache(&cache, 500, 500, 2000);
-
-    LOG(INFO) << "Insert vertices from 0 to 1000";
-    addVertices(kv.get(), schemaMan.get(), indexMan.get(), &cache, 1000);
-    checkCache(&cache, 1000, 500, 2000);
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto parts = cluster.getTotalParts();
+
+    FLAGS_enable_vertex_cache = true;
+    VertexCache cache(16 << 20, 4);
+    GraphSpaceID spaceId = 1;
+    TagID tagId = 1;
+    VertexID vId = "Tim Duncan";
+    PartitionID partId = std::hash<std::string>()(vId) % parts + 1;
+    VertexCache::Key key(spaceId, partId, vId, tagId);
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+
+    {
+        LOG(INFO) << "AddVertices writes through the cache";
+        auto* processor = AddVerticesProcessor::instance(env, nullptr, &cache);
+        auto req = mock::MockData::mockAddVerticesReq(parts);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        std::string val;
+        ASSERT_TRUE(cache.get(key, &val));
+        auto prefix = NebulaKeyUtils::vertexPrefix(vIdLen, partId, vId, tagId);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ASSERT_EQ(kvstore::ResultCode::SUCCEEDED,
+                  env->kvstore_->prefix(spaceId, partId, prefix, &iter));
+        ASSERT_TRUE(iter->valid());
+        EXPECT_EQ(iter->val(), val);
+    }
+    {
+        LOG(INFO) << "DeleteVertices evicts the cache";
+        auto* processor = DeleteVerticesProcessor::instance(env, nullptr, &cache);
+        auto req = mock::MockData::mockDeleteVerticesReq(parts);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        std::string val;
+        EXPECT_FALSE(cache.get(key, &val));
+    }
+    FLAGS_enable_vertex_cache = false;
 }
 
 }  // namespace storage
 }  // namespace nebula
 
-
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);
     folly::init(&argc, &argv, true);
     google::SetStderrLogging(google::INFO);
     return RUN_ALL_TESTS();
 }
-
-
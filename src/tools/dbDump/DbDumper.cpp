@@ -212,6 +212,10 @@ void DbDumper::run() {
                 auto partId = std::hash<VertexID>()(vid) % partNum_  + 1;
                 auto prefix = NebulaKeyUtils::vertexPrefix(spaceVidLen_, partId, vid);
                 seek(prefix);
+                // The separated edges of the vertex
+                auto edgePrefix = NebulaKeyUtils::toEdgeKeyType(
+                    NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, vid), NebulaKeyType::kEdge);
+                seek(edgePrefix);
             }
             break;
         }
@@ -224,7 +228,7 @@ void DbDumper::run() {
                 auto partId = std::hash<VertexID>()(vid) % partNum_  + 1;
                 for (auto edgeType : edgeTypes_) {
                     auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, vid, edgeType);
-                    seek(prefix);
+                    seekEdges(prefix);
                 }
             }
             break;
@@ -252,7 +256,7 @@ void DbDumper::run() {
                 auto partId = std::hash<VertexID>()(vid) % partNum_  + 1;
                 for (auto edgeType : edgeTypes_) {
                     auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, vid, edgeType);
-                    seek(prefix);
+                    seekEdges(prefix);
                 }
             }
             // specified vids and tags, seek with prefix and print.
@@ -273,6 +277,8 @@ void DbDumper::run() {
             for (auto partId : parts_) {
                 auto prefix = NebulaKeyUtils::partPrefix(partId);
                 seek(prefix);
+                auto edgePrefix = NebulaKeyUtils::partPrefix(partId, NebulaKeyType::kEdge);
+                seek(edgePrefix);
             }
             break;
         }
@@ -282,7 +288,7 @@ void DbDumper::run() {
             beforePrintEdge_.emplace_back(printIfEdgeFound);
             for (auto partId : parts_) {
                 auto prefix = NebulaKeyUtils::partPrefix(partId);
-                seek(prefix);
+                seekEdges(prefix);
             }
             break;
         }
@@ -302,7 +308,7 @@ void DbDumper::run() {
             beforePrintEdge_.emplace_back(printIfEdgeFound);
             for (auto partId : parts_) {
                 auto prefix = NebulaKeyUtils::partPrefix(partId);
-                seek(prefix);
+                seekEdges(prefix);
             }
 
             beforePrintVertex_.clear();
@@ -324,6 +330,11 @@ void DbDumper::run() {
                     }
                     auto prefix = NebulaKeyUtils::vertexPrefix(spaceVidLen_, partId, vid);
                     seek(prefix);
+                    // The separated edges of the vertex
+                    auto edgePrefix = NebulaKeyUtils::toEdgeKeyType(
+                        NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, vid),
+                        NebulaKeyType::kEdge);
+                    seek(edgePrefix);
                 }
             }
             break;
@@ -338,7 +349,7 @@ void DbDumper::run() {
                     for (auto edgeType : edgeTypes_) {
                         auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId,
                                                                  vid, edgeType);
-                        seek(prefix);
+                        seekEdges(prefix);
                     }
                 }
             }
@@ -370,7 +381,7 @@ void DbDumper::run() {
                     for (auto edgeType : edgeTypes_) {
                         auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId,
                                                                  vid, edgeType);
-                        seek(prefix);
+                        seekEdges(prefix);
                     }
                 }
             }
@@ -424,6 +435,13 @@ void DbDumper::seek(std::string& prefix) {
     iterates(prefixIt.get());
 }
 
+void DbDumper::seekEdges(std::string& prefix) {
+    // The edges are of either key type, the dumper doesn't know the layout of the parts
+    seek(prefix);
+    auto edgePrefix = NebulaKeyUtils::toEdgeKeyType(prefix, NebulaKeyType::kEdge);
+    seek(edgePrefix);
+}
+
 void DbDumper::iterates(kvstore::RocksPrefixIter* it) {
     for (; it->valid(); it->next()) {
         if (FLAGS_limit > 0 && count_ >= FLAGS_limit) {
@@ -51,6 +51,9 @@ private:
 
     void seek(std::string& prefix);
 
+    // Seek the edges with the prefix of both key types
+    void seekEdges(std::string& prefix);
+
     void iterates(kvstore::RocksPrefixIter* it);
 
     inline void printTagKey(const folly::StringPiece& key);
@@ -0,0 +1,272 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "utils/Metrics.h"
+
+namespace nebula {
+namespace metrics {
+
+namespace {
+
+// Insert the quantile into the labels text
+std::string withQuantile(const std::string& labels, const char* quantile) {
+    auto label = folly::stringPrintf("quantile=\"%s\"}", quantile);
+    if (labels.empty()) {
+        return "{" + label;
+    }
+    return labels.substr(0, labels.size() - 1) + "," + label;
+}
+
+}  // namespace
+
+Histogram::Shard::Shard(Histogram* o)
+        : owner(o) {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum.store(0, std::memory_order_relaxed);
+}
+
+Histogram::Shard::~Shard() {
+    if (owner == nullptr) {
+        return;
+    }
+    auto& retired = owner->retired_;
+    for (int32_t i = 0; i < kBuckets; i++) {
+        auto num = buckets[i].load(std::memory_order_relaxed);
+        if (num != 0) {
+            retired.buckets[i].fetch_add(num, std::memory_order_relaxed);
+        }
+    }
+    retired.sum.fetch_add(sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+Histogram::Histogram()
+        : shards_([this] { return new Shard(this); }) {
+}
+
+void Histogram::addValue(int64_t value) {
+    value = std::max<int64_t>(value, 0);
+    auto* shard = shards_.get();
+    auto& bucket = shard->buckets[bucketOf(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    shard->sum.store(shard->sum.load(std::memory_order_relaxed) + value,
+                     std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snapshot;
+    snapshot.buckets.resize(kBuckets, 0);
+    auto merge = [&snapshot] (const Shard& shard) {
+        for (int32_t i = 0; i < kBuckets; i++) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    };
+    merge(retired_);
+    for (const auto& shard : shards_.accessAllThreads()) {
+        merge(shard);
+    }
+    // The count is summed from the buckets, so that it agrees with them
+    for (auto num : snapshot.buckets) {
+        snapshot.count += num;
+    }
+    return snapshot;
+}
+
+// static
+int32_t Histogram::bucketOf(int64_t value) {
+    if (value < kSubBuckets) {
+        return std::max<int64_t>(value, 0);
+    }
+    int32_t bits = 63 - __builtin_clzll(value);
+    int32_t shift = bits - kSubBits;
+    return kSubBuckets + shift * kSubBuckets + ((value >> shift) & (kSubBuckets - 1));
+}
+
+// static
+int64_t Histogram::lowerBound(int32_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    int32_t shift = (bucket - kSubBuckets) / kSubBuckets;
+    int64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    if (shift + kSubBits >= 63) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    return (kSubBuckets + sub) << shift;
+}
+
+int64_t Histogram::Snapshot::percentile(double pct) const {
+    if (count <= 0) {
+        return 0;
+    }
+    double rank = std::min(std::max(pct, 0.0), 100.0) / 100 * count;
+    int64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        if (buckets[i] == 0) {
+            continue;
+        }
+        if (seen + buckets[i] >= rank) {
+            auto lower = lowerBound(i);
+            auto upper = lowerBound(i + 1);
+            double fraction = (rank - seen) / buckets[i];
+            return lower + static_cast<int64_t>((upper - lower) * fraction);
+        }
+        seen += buckets[i];
+    }
+    return 0;
+}
+
+
+// static
+Metrics* Metrics::instance() {
+    // Never released, the metrics could be added when the static objects are destroyed
+    static auto* metrics = new Metrics();
+    return metrics;
+}
+
+template <typename T>
+T* Metrics::getOrAdd(MetricMap<T>& metrics,
+                     const std::string& name,
+                     const MetricLabels& labels) {
+    auto text = labelsText(labels);
+    {
+        folly::RWSpinLock::ReadHolder rh(lock_);
+        auto it = metrics.find(name);
+        if (it != metrics.end()) {
+            auto metric = it->second.find(text);
+            if (metric != it->second.end()) {
+                return metric->second.get();
+            }
+        }
+    }
+    folly::RWSpinLock::WriteHolder wh(lock_);
+    auto& metric = metrics[name][text];
+    if (metric == nullptr) {
+        metric = std::make_unique<T>();
+    }
+    return metric.get();
+}
+
+Counter* Metrics::counter(const std::string& name, const MetricLabels& labels) {
+    return getOrAdd(counters_, name, labels);
+}
+
+Histogram* Metrics::histogram(const std::string& name, const MetricLabels& labels) {
+    return getOrAdd(histograms_, name, labels);
+}
+
+int64_t Metrics::addCollector(Collector collector) {
+    std::lock_guard<std::mutex> g(collectorsLock_);
+    auto id = nextCollectorId_++;
+    collectors_.emplace(id, std::move(collector));
+    return id;
+}
+
+void Metrics::removeCollector(int64_t id) {
+    std::lock_guard<std::mutex> g(collectorsLock_);
+    collectors_.erase(id);
+}
+
+std::string Metrics::toPrometheus() const {
+    std::string out;
+    {
+        folly::RWSpinLock::ReadHolder rh(lock_);
+        for (const auto& counter : counters_) {
+            const auto& name = counter.first;
+            folly::stringAppendf(&out, "# TYPE %s counter\n", name.c_str());
+            for (const auto& metric : counter.second) {
+                folly::stringAppendf(&out, "%s%s %ld\n",
+                                     name.c_str(),
+                                     metric.first.c_str(),
+                                     metric.second->value());
+            }
+        }
+        for (const auto& histogram : histograms_) {
+            const auto& name = histogram.first;
+            folly::stringAppendf(&out, "# TYPE %s summary\n", name.c_str());
+            for (const auto& metric : histogram.second) {
+                const auto& labels = metric.first;
+                auto snapshot = metric.second->snapshot();
+                for (auto quantile : {"0.5", "0.99", "0.999"}) {
+                    folly::stringAppendf(&out, "%s%s %ld\n",
+                                         name.c_str(),
+                                         withQuantile(labels, quantile).c_str(),
+                                         snapshot.percentile(folly::to<double>(quantile) * 100));
+                }
+                folly::stringAppendf(&out, "%s_sum%s %ld\n",
+                                     name.c_str(), labels.c_str(), snapshot.sum);
+                folly::stringAppendf(&out, "%s_count%s %ld\n",
+                                     name.c_str(), labels.c_str(), snapshot.count);
+            }
+        }
+    }
+
+    // The gauges of the same name are put together
+    struct Values {
+        bool                                            monotonic{false};
+        std::vector<std::pair<std::string, double>>     values;
+    };
+    std::map<std::string, Values> gauges;
+    {
+        std::lock_guard<std::mutex> g(collectorsLock_);
+        for (const auto& collector : collectors_) {
+            for (auto& gauge : collector.second()) {
+                auto& values = gauges[gauge.name];
+                values.monotonic = gauge.monotonic;
+                values.values.emplace_back(labelsText(gauge.labels), gauge.value);
+            }
+        }
+    }
+    for (const auto& gauge : gauges) {
+        folly::stringAppendf(&out, "# TYPE %s %s\n",
+                             gauge.first.c_str(),
+                             gauge.second.monotonic ? "counter" : "gauge");
+        for (const auto& value : gauge.second.values) {
+            folly::stringAppendf(&out, "%s%s %s\n",
+                                 gauge.first.c_str(),
+                                 value.first.c_str(),
+                                 folly::to<std::string>(value.second).c_str());
+        }
+    }
+    return out;
+}
+
+// static
+std::string Metrics::labelsText(const MetricLabels& labels) {
+    if (labels.empty()) {
+        return "";
+    }
+    std::string text = "{";
+    for (const auto& label : labels) {
+        if (text.size() > 1) {
+            text.append(",");
+        }
+        text.append(label.first).append("=\"");
+        for (auto c : label.second) {
+            switch (c) {
+                case '\\':
+                    text.append("\\\\");
+                    break;
+                case '"':
+                    text.append("\\\"");
+                    break;
+                case '\n':
+                    text.append("\\n");
+                    break;
+                default:
+                    text.push_back(c);
+            }
+        }
+        text.append("\"");
+    }
+    text.append("}");
+    return text;
+}
+
+}  // namespace metrics
+}  // namespace nebula
@@ -0,0 +1,154 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTILS_METRICS_H_
+#define UTILS_METRICS_H_
+
+#include "common/base/Base.h"
+#include <folly/RWSpinLock.h>
+#include <folly/ThreadCachedInt.h>
+#include <folly/ThreadLocal.h>
+
+namespace nebula {
+namespace metrics {
+
+// The labels of a metric, in the order to be shown
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * A monotonic counter. The increments are added into a thread local cache and
+ * flushed from time to time, so it is cheap to be added in the hot path.
+ * */
+class Counter final {
+public:
+    Counter() = default;
+
+    void add(int64_t value = 1) {
+        value_.increment(value);
+    }
+
+    int64_t value() const {
+        return value_.readFull();
+    }
+
+private:
+    folly::ThreadCachedInt<int64_t>     value_{0};
+};
+
+
+/**
+ * A histogram of non-negative values, used for latencies and sizes. The values under 8
+ * have a bucket each, and every power of two above has 8 buckets, so the error of a
+ * percentile is less than 1/8 of the value.
+ *
+ * Each thread adds values into its own shard without contention, the shards are merged
+ * when a snapshot is taken. The shard of an exited thread is merged into retired_.
+ * */
+class Histogram final {
+public:
+    static constexpr int32_t kSubBits = 3;
+    static constexpr int32_t kSubBuckets = 1 << kSubBits;
+    static constexpr int32_t kBuckets = kSubBuckets + (64 - kSubBits) * kSubBuckets;
+
+    struct Snapshot {
+        std::vector<int64_t>    buckets;
+        int64_t                 count{0};
+        int64_t                 sum{0};
+
+        // The value at the percentile in [0, 100], by linear interpolation in the bucket
+        int64_t percentile(double pct) const;
+    };
+
+    Histogram();
+
+    void addValue(int64_t value);
+
+    Snapshot snapshot() const;
+
+    static int32_t bucketOf(int64_t value);
+
+    // The values in bucket i are in [lowerBound(i), lowerBound(i + 1))
+    static int64_t lowerBound(int32_t bucket);
+
+private:
+    struct Shard {
+        explicit Shard(Histogram* owner = nullptr);
+        ~Shard();
+
+        // Only the owner thread writes the buckets and the sum
+        Histogram*                                  owner;
+        std::array<std::atomic<int64_t>, kBuckets>  buckets;
+        std::atomic<int64_t>                        sum;
+    };
+
+    // Declared before shards_, so it is still there when the shards are released
+    Shard                                           retired_;
+    mutable folly::ThreadLocal<Shard, Histogram>    shards_;
+};
+
+
+// A value sampled by a collector when the metrics are exported. A monotonic one, e.g. a
+// ticker counted somewhere else since the process started, is exported as a counter.
+struct GaugeValue {
+    std::string     name;
+    MetricLabels    labels;
+    double          value;
+    bool            monotonic{false};
+};
+
+
+/**
+ * The registry of the metrics of the process, they are exported in the text format of
+ * prometheus by the admin http handler. The metrics are never removed once registered,
+ * and the pointers returned are valid all along.
+ *
+ * The values which are already kept somewhere, e.g. the lag of the raft followers, are
+ * sampled by the collectors only when exported, so there is no cost in the hot path.
+ * */
+class Metrics final {
+public:
+    using Collector = std::function<std::vector<GaugeValue>()>;
+
+    static Metrics* instance();
+
+    Counter* counter(const std::string& name, const MetricLabels& labels = {});
+
+    Histogram* histogram(const std::string& name, const MetricLabels& labels = {});
+
+    // Returns the id to remove the collector
+    int64_t addCollector(Collector collector);
+
+    // The collector is not being called once it returns
+    void removeCollector(int64_t id);
+
+    std::string toPrometheus() const;
+
+    // e.g. {space="1",part="2"}, an empty string if no labels
+    static std::string labelsText(const MetricLabels& labels);
+
+private:
+    Metrics() = default;
+
+    // name => labels text => metric
+    template <typename T>
+    using MetricMap = std::map<std::string, std::map<std::string, std::unique_ptr<T>>>;
+
+    template <typename T>
+    T* getOrAdd(MetricMap<T>& metrics, const std::string& name, const MetricLabels& labels);
+
+    mutable folly::RWSpinLock               lock_;
+    MetricMap<Counter>                      counters_;
+    MetricMap<Histogram>                    histograms_;
+
+    mutable std::mutex                      collectorsLock_;
+    int64_t                                 nextCollectorId_{0};
+    std::map<int64_t, Collector>            collectors_;
+};
+
+}  // namespace metrics
+}  // namespace nebula
+
+#endif  // UTILS_METRICS_H_
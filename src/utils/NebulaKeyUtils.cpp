@@ -5,9 +5,32 @@
  */
 
 #include "utils/NebulaKeyUtils.h"
+#include <folly/RWSpinLock.h>
 
 namespace nebula {
 
+namespace {
+
+// The edge key layouts of the parts which are not the default one
+struct EdgeKeyLayouts {
+    folly::RWSpinLock                               lock;
+    std::unordered_map<uint64_t, EdgeKeyLayout>     layouts;
+    // Skip the lock when all parts have the default layout, which is the common case
+    std::atomic<bool>                               empty{true};
+};
+
+uint64_t layoutKey(GraphSpaceID spaceId, PartitionID partId) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(spaceId)) << 32)
+         | static_cast<uint32_t>(partId);
+}
+
+EdgeKeyLayouts& edgeKeyLayouts() {
+    static EdgeKeyLayouts sLayouts;
+    return sLayouts;
+}
+
+}  // namespace
+
 // static
 bool NebulaKeyUtils::isValidVidLen(size_t vIdLen, VertexID srcVId, VertexID dstVId) {
     if (srcVId.size() > vIdLen || dstVId.size() > vIdLen) {
@@ -62,6 +85,19 @@ std::string NebulaKeyUtils::edgeKey(size_t vIdLen,
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::edgeKey(GraphSpaceID spaceId,
+                                    size_t vIdLen,
+                                    PartitionID partId,
+                                    VertexID srcId,
+                                    EdgeType type,
+                                    EdgeRanking rank,
+                                    VertexID dstId,
+                                    EdgeVersion ev) {
+    return withEdgeKeyType(edgeKey(vIdLen, partId, srcId, type, rank, dstId, ev),
+                           spaceId, partId);
+}
+
 // static
 std::string NebulaKeyUtils::systemCommitKey(PartitionID partId) {
     int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
@@ -84,6 +120,17 @@ std::string NebulaKeyUtils::systemPartKey(PartitionID partId) {
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::systemEdgeKeyLayoutKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemEdgeKeyLayout);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
 // static
 std::string NebulaKeyUtils::uuidKey(PartitionID partId, const folly::StringPiece& name) {
     std::string key;
@@ -183,15 +230,153 @@ std::string NebulaKeyUtils::edgePrefix(size_t vIdLen,
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::edgePrefix(GraphSpaceID spaceId,
+                                       size_t vIdLen,
+                                       PartitionID partId,
+                                       VertexID srcId,
+                                       EdgeType type) {
+    return withEdgeKeyType(edgePrefix(vIdLen, partId, srcId, type), spaceId, partId);
+}
+
+// static
+std::string NebulaKeyUtils::edgePrefix(GraphSpaceID spaceId,
+                                       size_t vIdLen,
+                                       PartitionID partId,
+                                       VertexID srcId) {
+    return withEdgeKeyType(edgePrefix(vIdLen, partId, srcId), spaceId, partId);
+}
+
+// static
+std::string NebulaKeyUtils::edgePrefix(GraphSpaceID spaceId,
+                                       size_t vIdLen,
+                                       PartitionID partId,
+                                       VertexID srcId,
+                                       EdgeType type,
+                                       EdgeRanking rank,
+                                       VertexID dstId) {
+    return withEdgeKeyType(edgePrefix(vIdLen, partId, srcId, type, rank, dstId),
+                           spaceId, partId);
+}
+
 // static
 std::string NebulaKeyUtils::partPrefix(PartitionID partId) {
-    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kData);
+    return partPrefix(partId, NebulaKeyType::kData);
+}
+
+// static
+std::string NebulaKeyUtils::partPrefix(PartitionID partId, NebulaKeyType type) {
+    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(type);
     std::string key;
     key.reserve(sizeof(PartitionID));
     key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID));
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::toEdgeKeyType(const folly::StringPiece& rawKey, NebulaKeyType type) {
+    uint32_t item = readInt<uint32_t>(rawKey.data(), sizeof(PartitionID));
+    item = (item & ~kTypeMask) | static_cast<uint32_t>(type);
+    std::string key;
+    key.reserve(rawKey.size());
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(rawKey.data() + sizeof(PartitionID), rawKey.size() - sizeof(PartitionID));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::withEdgeKeyType(std::string key,
+                                            GraphSpaceID spaceId,
+                                            PartitionID partId) {
+    auto type = edgeKeyType(spaceId, partId);
+    if (type != NebulaKeyType::kData) {
+        // The key type is the lowest byte of the first little-endian int32
+        key[0] = static_cast<char>(static_cast<uint32_t>(type));
+    }
+    return key;
+}
+
+// static
+void NebulaKeyUtils::setEdgeKeyLayout(GraphSpaceID spaceId,
+                                      PartitionID partId,
+                                      const EdgeKeyLayout& layout) {
+    auto& layouts = edgeKeyLayouts();
+    folly::RWSpinLock::WriteHolder wh(&layouts.lock);
+    if (layout == EdgeKeyLayout()) {
+        layouts.layouts.erase(layoutKey(spaceId, partId));
+    } else {
+        layouts.layouts[layoutKey(spaceId, partId)] = layout;
+    }
+    layouts.empty.store(layouts.layouts.empty(), std::memory_order_release);
+}
+
+// static
+void NebulaKeyUtils::removeEdgeKeyLayout(GraphSpaceID spaceId, PartitionID partId) {
+    setEdgeKeyLayout(spaceId, partId, EdgeKeyLayout());
+}
+
+// static
+void NebulaKeyUtils::removeEdgeKeyLayout(GraphSpaceID spaceId) {
+    auto& layouts = edgeKeyLayouts();
+    folly::RWSpinLock::WriteHolder wh(&layouts.lock);
+    for (auto it = layouts.layouts.begin(); it != layouts.layouts.end();) {
+        if (static_cast<GraphSpaceID>(it->first >> 32) == spaceId) {
+            it = layouts.layouts.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    layouts.empty.store(layouts.layouts.empty(), std::memory_order_release);
+}
+
+// static
+EdgeKeyLayout NebulaKeyUtils::edgeKeyLayout(GraphSpaceID spaceId, PartitionID partId) {
+    auto& layouts = edgeKeyLayouts();
+    if (layouts.empty.load(std::memory_order_acquire)) {
+        return EdgeKeyLayout();
+    }
+    folly::RWSpinLock::ReadHolder rh(&layouts.lock);
+    auto it = layouts.layouts.find(layoutKey(spaceId, partId));
+    return it == layouts.layouts.end() ? EdgeKeyLayout() : it->second;
+}
+
+// static
+std::vector<NebulaKeyType> NebulaKeyUtils::edgeKeyTypes(GraphSpaceID spaceId,
+                                                        PartitionID partId) {
+    auto layout = edgeKeyLayout(spaceId, partId);
+    if (layout.converted) {
+        return {layout.type};
+    }
+    return {NebulaKeyType::kData, NebulaKeyType::kEdge};
+}
+
+// static
+std::string NebulaKeyUtils::encodeEdgeKeyLayout(const EdgeKeyLayout& layout) {
+    std::string val;
+    val.reserve(2);
+    val.append(1, static_cast<char>(static_cast<uint32_t>(layout.type)))
+       .append(1, layout.converted ? '\1' : '\0');
+    return val;
+}
+
+// static
+EdgeKeyLayout NebulaKeyUtils::decodeEdgeKeyLayout(folly::StringPiece val) {
+    EdgeKeyLayout layout;
+    if (val.size() != 2) {
+        LOG(ERROR) << "Bad edge key layout " << folly::hexlify(val);
+        return layout;
+    }
+    auto type = static_cast<uint32_t>(static_cast<uint8_t>(val[0]));
+    if (type != static_cast<uint32_t>(NebulaKeyType::kData) &&
+        type != static_cast<uint32_t>(NebulaKeyType::kEdge)) {
+        LOG(ERROR) << "Bad edge key layout " << folly::hexlify(val);
+        return layout;
+    }
+    layout.type = static_cast<NebulaKeyType>(type);
+    layout.converted = val[1] != '\0';
+    return layout;
+}
+
 // static
 std::string NebulaKeyUtils::systemPrefix() {
     int8_t type = static_cast<uint32_t>(NebulaKeyType::kSystem);
@@ -21,7 +21,31 @@ namespace nebula {
  * For data in Nebula 1.0, all vertexId is int64_t, so the size would be 8.
  * For data in Nebula 2.0, all vertexId is fixed length string according to space property.
  *
+ * The type of the edge keys is kData by default, so the edges of a vertex follow its tags.
+ * When it is kEdge, the edges of a part are kept after all vertices, and a scan of the
+ * vertices doesn't go through the edges. The type is kept per part in EdgeKeyLayout, and
+ * the key utils taking the space id follow it.
+ *
+ * */
+
+/**
+ * The key type of the edges of a part. It is kept in the system key of the part, so it is
+ * replicated by raft in the order of the logs, and it is changed by the ConvertEdgeKeyTask
+ * only. While the edges are being moved from the other type, the layout is not converted,
+ * and the edges of both types are read.
  * */
+struct EdgeKeyLayout {
+    NebulaKeyType   type{NebulaKeyType::kData};
+    bool            converted{true};
+
+    bool operator==(const EdgeKeyLayout& rhs) const {
+        return type == rhs.type && converted == rhs.converted;
+    }
+
+    bool operator!=(const EdgeKeyLayout& rhs) const {
+        return !(*this == rhs);
+    }
+};
 
 /**
  * This class supply some utils for transition between Vertex/Edge and key in kvstore.
@@ -42,16 +66,23 @@ public:
                                  TagID tagId, TagVersion tv);
 
     /**
-     * Generate edge key for kv store
+     * Generate edge key for kv store, the type of the key is kData
      * */
     static std::string edgeKey(size_t vIdLen, PartitionID partId, VertexID srcId,
                                EdgeType type, EdgeRanking rank,
                                VertexID dstId, EdgeVersion ev);
 
+    // Generate edge key of the type of the part's layout
+    static std::string edgeKey(GraphSpaceID spaceId, size_t vIdLen, PartitionID partId,
+                               VertexID srcId, EdgeType type, EdgeRanking rank,
+                               VertexID dstId, EdgeVersion ev);
+
     static std::string systemCommitKey(PartitionID partId);
 
     static std::string systemPartKey(PartitionID partId);
 
+    static std::string systemEdgeKeyLayoutKey(PartitionID partId);
+
     static std::string uuidKey(PartitionID partId, const folly::StringPiece& name);
 
     static std::string kvKey(PartitionID partId, const folly::StringPiece& name);
@@ -64,7 +95,7 @@ public:
     static std::string vertexPrefix(size_t vIdLen, PartitionID partId, VertexID vId);
 
     /**
-     * Prefix for edge
+     * Prefix for edge, the type of the prefix is kData
      * */
     static std::string edgePrefix(size_t vIdLen, PartitionID partId, VertexID srcId, EdgeType type);
 
@@ -77,10 +108,78 @@ public:
                                   EdgeRanking rank,
                                   VertexID dstId);
 
+    /**
+     * Prefix for edge of the type of the part's layout. Until the part is converted, the
+     * edges of the other type must be read as well, see CommonUtils::edgePrefix.
+     * */
+    static std::string edgePrefix(GraphSpaceID spaceId,
+                                  size_t vIdLen,
+                                  PartitionID partId,
+                                  VertexID srcId,
+                                  EdgeType type);
+
+    static std::string edgePrefix(GraphSpaceID spaceId,
+                                  size_t vIdLen,
+                                  PartitionID partId,
+                                  VertexID srcId);
+
+    static std::string edgePrefix(GraphSpaceID spaceId,
+                                  size_t vIdLen,
+                                  PartitionID partId,
+                                  VertexID srcId,
+                                  EdgeType type,
+                                  EdgeRanking rank,
+                                  VertexID dstId);
+
     static std::string systemPrefix();
 
     static std::string partPrefix(PartitionID partId);
 
+    // Prefix of the keys of the given type in the part
+    static std::string partPrefix(PartitionID partId, NebulaKeyType type);
+
+    // Prefix of all edges in the part of the type of its layout, the vertices are included
+    // unless the edges are separated
+    static std::string edgePartPrefix(GraphSpaceID spaceId, PartitionID partId) {
+        return partPrefix(partId, edgeKeyType(spaceId, partId));
+    }
+
+    /**
+     * The edge key layout of the parts loaded on this host. The part sets it when it is
+     * loaded from the engine or changed by a committed log, the parts never set have the
+     * default one.
+     * */
+    static void setEdgeKeyLayout(GraphSpaceID spaceId,
+                                 PartitionID partId,
+                                 const EdgeKeyLayout& layout);
+
+    static void removeEdgeKeyLayout(GraphSpaceID spaceId, PartitionID partId);
+
+    static void removeEdgeKeyLayout(GraphSpaceID spaceId);
+
+    static EdgeKeyLayout edgeKeyLayout(GraphSpaceID spaceId, PartitionID partId);
+
+    // The type of the edge keys written
+    static NebulaKeyType edgeKeyType(GraphSpaceID spaceId, PartitionID partId) {
+        return edgeKeyLayout(spaceId, partId).type;
+    }
+
+    // The types of the edge keys to read, both types until the part is converted
+    static std::vector<NebulaKeyType> edgeKeyTypes(GraphSpaceID spaceId, PartitionID partId);
+
+    static std::string encodeEdgeKeyLayout(const EdgeKeyLayout& layout);
+
+    // The default layout is returned if the value is bad
+    static EdgeKeyLayout decodeEdgeKeyLayout(folly::StringPiece val);
+
+    static NebulaKeyType getKeyType(const folly::StringPiece& rawKey) {
+        auto type = readInt<uint32_t>(rawKey.data(), sizeof(PartitionID)) & kTypeMask;
+        return static_cast<NebulaKeyType>(type);
+    }
+
+    // The same edge key of the other type
+    static std::string toEdgeKeyType(const folly::StringPiece& rawKey, NebulaKeyType type);
+
     static PartitionID getPart(const folly::StringPiece& rawKey) {
         return readInt<PartitionID>(rawKey.data(), sizeof(PartitionID)) >> 8;
     }
@@ -121,7 +220,8 @@ public:
         }
         constexpr int32_t len = static_cast<int32_t>(sizeof(NebulaKeyType));
         auto type = readInt<uint32_t>(rawKey.data(), len) & kTypeMask;
-        if (static_cast<uint32_t>(NebulaKeyType::kData) != type) {
+        if (static_cast<uint32_t>(NebulaKeyType::kData) != type &&
+            static_cast<uint32_t>(NebulaKeyType::kEdge) != type) {
             return false;
         }
         auto offset = sizeof(PartitionID) + vIdLen;
@@ -149,6 +249,20 @@ public:
         return static_cast<uint32_t>(NebulaSystemKeyType::kSystemPart) == type;
     }
 
+    static bool isSystemEdgeKeyLayout(const folly::StringPiece& rawKey) {
+        if (rawKey.size() != kSystemLen) {
+            return false;
+        }
+        constexpr int32_t len = static_cast<int32_t>(sizeof(NebulaKeyType));
+        if ((readInt<uint32_t>(rawKey.data(), len) & kTypeMask) !=
+                static_cast<uint32_t>(NebulaKeyType::kSystem)) {
+            return false;
+        }
+        auto position = rawKey.data() + sizeof(PartitionID);
+        auto type = readInt<uint32_t>(position, sizeof(NebulaSystemKeyType));
+        return static_cast<uint32_t>(NebulaSystemKeyType::kSystemEdgeKeyLayout) == type;
+    }
+
     static VertexIDSlice getSrcId(size_t vIdLen, const folly::StringPiece& rawKey) {
         if (rawKey.size() != kEdgeLen + (vIdLen << 1)) {
             dumpBadKey(rawKey, kEdgeLen + (vIdLen << 1), vIdLen);
@@ -189,10 +303,12 @@ public:
         return readInt<int64_t>(rawKey.data() + offset, sizeof(int64_t));
     }
 
+    // The vertices, the edges of both types and the kv keys
     static bool isDataKey(const folly::StringPiece& key) {
         constexpr int32_t len = static_cast<int32_t>(sizeof(NebulaKeyType));
         auto type = readInt<int32_t>(key.data(), len) & kTypeMask;
-        return static_cast<uint32_t>(NebulaKeyType::kData) == type;
+        return static_cast<uint32_t>(NebulaKeyType::kData) == type ||
+               static_cast<uint32_t>(NebulaKeyType::kEdge) == type;
     }
 
     static bool isUUIDKey(const folly::StringPiece& key) {
@@ -218,6 +334,9 @@ public:
 
 private:
     NebulaKeyUtils() = delete;
+
+    // Set the type of the key of the part's edge layout
+    static std::string withEdgeKeyType(std::string key, GraphSpaceID spaceId, PartitionID partId);
 };
 
 }  // namespace nebula
@@ -17,11 +17,14 @@ enum class NebulaKeyType : uint32_t {
     kIndex             = 0x00000002,
     kUUID              = 0x00000003,
     kSystem            = 0x00000004,
+    // The edges when they are kept apart from the vertices, see EdgeKeyLayout
+    kEdge              = 0x00000005,
 };
 
 enum class NebulaSystemKeyType : uint32_t {
     kSystemCommit      = 0x00000001,
     kSystemPart        = 0x00000002,
+    kSystemEdgeKeyLayout = 0x00000003,
 };
 
 using VertexIDSlice = folly::StringPiece;
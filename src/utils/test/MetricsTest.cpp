@@ -0,0 +1,138 @@
+/* Copyright (c) 2020 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "utils/Metrics.h"
+#include <gtest/gtest.h>
+
+namespace nebula {
+namespace metrics {
+
+TEST(MetricsTest, BucketTest) {
+    for (int64_t v = 0; v < 8; v++) {
+        EXPECT_EQ(v, Histogram::bucketOf(v));
+        EXPECT_EQ(v, Histogram::lowerBound(v));
+    }
+    int32_t last = Histogram::bucketOf(7);
+    for (int64_t v : {8L, 9L, 15L, 16L, 17L, 1000L, 123456789L, (1L << 62) + 1}) {
+        auto bucket = Histogram::bucketOf(v);
+        EXPECT_LT(bucket, Histogram::kBuckets);
+        EXPECT_GT(bucket, last);
+        EXPECT_LE(Histogram::lowerBound(bucket), v);
+        EXPECT_GT(Histogram::lowerBound(bucket + 1), v);
+        // the width of a bucket is at most 1/8 of its lower bound
+        EXPECT_LE(Histogram::lowerBound(bucket + 1) - Histogram::lowerBound(bucket),
+                  Histogram::lowerBound(bucket) / Histogram::kSubBuckets);
+        last = bucket;
+    }
+    EXPECT_EQ(0, Histogram::bucketOf(-1));
+}
+
+TEST(MetricsTest, HistogramTest) {
+    Histogram histo;
+    {
+        auto snapshot = histo.snapshot();
+        EXPECT_EQ(0, snapshot.count);
+        EXPECT_EQ(0, snapshot.percentile(99));
+    }
+
+    // 1 ~ 10000 in 4 threads, the shards of the exited threads are kept
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([&histo, t] {
+            for (int64_t v = t + 1; v <= 10000; v += 4) {
+                histo.addValue(v);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto snapshot = histo.snapshot();
+    EXPECT_EQ(10000, snapshot.count);
+    EXPECT_EQ(10000L * 10001 / 2, snapshot.sum);
+    for (double pct : {50.0, 99.0, 99.9}) {
+        auto expected = pct * 100;
+        auto value = snapshot.percentile(pct);
+        EXPECT_LE(std::abs(value - expected), expected / Histogram::kSubBuckets)
+            << "p" << pct << " is " << value;
+    }
+    // the max is in the bucket of 10000
+    auto bucket = Histogram::bucketOf(10000);
+    EXPECT_LE(Histogram::lowerBound(bucket), snapshot.percentile(100));
+    EXPECT_GE(Histogram::lowerBound(bucket + 1), snapshot.percentile(100));
+    EXPECT_LE(snapshot.percentile(0), 1);
+}
+
+TEST(MetricsTest, CounterTest) {
+    auto* metrics = Metrics::instance();
+    auto* counter = metrics->counter("test_counter", {{"space", "1"}, {"part", "2"}});
+    EXPECT_EQ(counter, metrics->counter("test_counter", {{"space", "1"}, {"part", "2"}}));
+    EXPECT_NE(counter, metrics->counter("test_counter", {{"space", "1"}, {"part", "3"}}));
+
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+        threads.emplace_back([counter] {
+            for (int32_t i = 0; i < 10000; i++) {
+                counter->add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    counter->add(10);
+    EXPECT_EQ(40010, counter->value());
+}
+
+TEST(MetricsTest, PrometheusTest) {
+    auto* metrics = Metrics::instance();
+    EXPECT_EQ("", Metrics::labelsText({}));
+    EXPECT_EQ("{a=\"x\\\"y\",b=\"1\"}", Metrics::labelsText({{"a", "x\"y"}, {"b", "1"}}));
+
+    metrics->counter("prom_reads", {{"space", "1"}})->add(3);
+    auto* histo = metrics->histogram("prom_latency_us", {{"method", "get"}});
+    for (int64_t v = 1; v <= 100; v++) {
+        histo->addValue(v);
+    }
+    auto id = metrics->addCollector([] {
+        std::vector<GaugeValue> gauges;
+        gauges.emplace_back(GaugeValue{"prom_lag", {{"follower", "a"}}, 2});
+        gauges.emplace_back(GaugeValue{"prom_lag", {{"follower", "b"}}, 0.5});
+        gauges.emplace_back(GaugeValue{"prom_ticks", {}, 7, true});
+        return gauges;
+    });
+
+    auto text = metrics->toPrometheus();
+    LOG(INFO) << text;
+    EXPECT_NE(std::string::npos, text.find("# TYPE prom_reads counter\n"
+                                           "prom_reads{space=\"1\"} 3\n"));
+    EXPECT_NE(std::string::npos, text.find("# TYPE prom_latency_us summary\n"));
+    EXPECT_NE(std::string::npos, text.find("prom_latency_us{method=\"get\",quantile=\"0.5\"} "));
+    EXPECT_NE(std::string::npos, text.find("prom_latency_us{method=\"get\",quantile=\"0.999\"} "));
+    EXPECT_NE(std::string::npos, text.find("prom_latency_us_sum{method=\"get\"} 5050\n"));
+    EXPECT_NE(std::string::npos, text.find("prom_latency_us_count{method=\"get\"} 100\n"));
+    EXPECT_NE(std::string::npos, text.find("# TYPE prom_lag gauge\n"
+                                           "prom_lag{follower=\"a\"} 2\n"
+                                           "prom_lag{follower=\"b\"} 0.5\n"));
+    EXPECT_NE(std::string::npos, text.find("# TYPE prom_ticks counter\n"
+                                           "prom_ticks 7\n"));
+
+    metrics->removeCollector(id);
+    EXPECT_EQ(std::string::npos, metrics->toPrometheus().find("prom_lag"));
+}
+
+}  // namespace metrics
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
@@ -188,6 +188,69 @@ TEST(KeyUtilsTest, MiscTest) {
     ASSERT_TRUE(NebulaKeyUtils::isUUIDKey(uuidKey));
 }
 
+TEST(KeyUtilsTest, SeparateEdgeKeyTest) {
+    GraphSpaceID spaceId = 1;
+    size_t vIdLen = 8;
+    PartitionID partId = 300;
+    VertexID srcId = "src", dstId = "dst";
+    EdgeType type = 101;
+    auto mixedKey = NebulaKeyUtils::edgeKey(vIdLen, partId, srcId, type, 0, dstId, 0);
+    ASSERT_EQ(NebulaKeyType::kData, NebulaKeyUtils::getKeyType(mixedKey));
+    ASSERT_EQ(mixedKey,
+              NebulaKeyUtils::edgeKey(spaceId, vIdLen, partId, srcId, type, 0, dstId, 0));
+    ASSERT_EQ(EdgeKeyLayout(), NebulaKeyUtils::edgeKeyLayout(spaceId, partId));
+
+    // The layout is per part
+    EdgeKeyLayout layout;
+    layout.type = NebulaKeyType::kEdge;
+    NebulaKeyUtils::setEdgeKeyLayout(spaceId, partId, layout);
+    ASSERT_EQ(layout, NebulaKeyUtils::edgeKeyLayout(spaceId, partId));
+    ASSERT_EQ(EdgeKeyLayout(), NebulaKeyUtils::edgeKeyLayout(spaceId, partId + 1));
+    ASSERT_EQ(EdgeKeyLayout(), NebulaKeyUtils::edgeKeyLayout(spaceId + 1, partId));
+    ASSERT_EQ(mixedKey, NebulaKeyUtils::edgeKey(vIdLen, partId, srcId, type, 0, dstId, 0));
+
+    auto edgeKey = NebulaKeyUtils::edgeKey(spaceId, vIdLen, partId, srcId, type, 0, dstId, 0);
+    auto vertexKey = NebulaKeyUtils::vertexKey(vIdLen, partId, srcId, 1, 0);
+    ASSERT_EQ(NebulaKeyType::kEdge, NebulaKeyUtils::getKeyType(edgeKey));
+    ASSERT_EQ(NebulaKeyType::kData, NebulaKeyUtils::getKeyType(vertexKey));
+    ASSERT_TRUE(NebulaKeyUtils::isEdge(vIdLen, edgeKey));
+    ASSERT_FALSE(NebulaKeyUtils::isVertex(vIdLen, edgeKey));
+    ASSERT_TRUE(NebulaKeyUtils::isDataKey(edgeKey));
+    ASSERT_EQ(partId, NebulaKeyUtils::getPart(edgeKey));
+    ASSERT_EQ(type, NebulaKeyUtils::getEdgeType(vIdLen, edgeKey));
+    ASSERT_EQ(srcId, NebulaKeyUtils::getSrcId(vIdLen, edgeKey).subpiece(0, srcId.size()));
+    ASSERT_EQ(dstId, NebulaKeyUtils::getDstId(vIdLen, edgeKey).subpiece(0, dstId.size()));
+
+    // The prefixes of the edges follow the layout, and a scan of the vertices skips them
+    ASSERT_EQ(0, edgeKey.find(NebulaKeyUtils::edgePrefix(spaceId, vIdLen, partId, srcId, type)));
+    ASSERT_EQ(0, edgeKey.find(NebulaKeyUtils::edgePrefix(spaceId, vIdLen, partId, srcId)));
+    ASSERT_EQ(0, edgeKey.find(NebulaKeyUtils::edgePartPrefix(spaceId, partId)));
+    ASSERT_NE(0, edgeKey.find(NebulaKeyUtils::partPrefix(partId)));
+    ASSERT_NE(0, edgeKey.find(NebulaKeyUtils::vertexPrefix(vIdLen, partId, srcId)));
+    ASSERT_EQ(0, vertexKey.find(NebulaKeyUtils::partPrefix(partId)));
+
+    // Both types are read until the part is converted
+    std::vector<NebulaKeyType> written = {NebulaKeyType::kEdge};
+    ASSERT_EQ(written, NebulaKeyUtils::edgeKeyTypes(spaceId, partId));
+    layout.converted = false;
+    NebulaKeyUtils::setEdgeKeyLayout(spaceId, partId, layout);
+    std::vector<NebulaKeyType> both = {NebulaKeyType::kData, NebulaKeyType::kEdge};
+    ASSERT_EQ(both, NebulaKeyUtils::edgeKeyTypes(spaceId, partId));
+    ASSERT_EQ(layout, NebulaKeyUtils::decodeEdgeKeyLayout(
+        NebulaKeyUtils::encodeEdgeKeyLayout(layout)));
+    ASSERT_EQ(EdgeKeyLayout(), NebulaKeyUtils::decodeEdgeKeyLayout("bad"));
+    auto layoutKey = NebulaKeyUtils::systemEdgeKeyLayoutKey(partId);
+    ASSERT_TRUE(NebulaKeyUtils::isSystemEdgeKeyLayout(layoutKey));
+    ASSERT_FALSE(NebulaKeyUtils::isSystemEdgeKeyLayout(NebulaKeyUtils::systemCommitKey(partId)));
+
+    // Convert between the layouts
+    ASSERT_EQ(edgeKey, NebulaKeyUtils::toEdgeKeyType(mixedKey, NebulaKeyType::kEdge));
+    ASSERT_EQ(mixedKey, NebulaKeyUtils::toEdgeKeyType(edgeKey, NebulaKeyType::kData));
+
+    NebulaKeyUtils::removeEdgeKeyLayout(spaceId);
+    ASSERT_EQ(EdgeKeyLayout(), NebulaKeyUtils::edgeKeyLayout(spaceId, partId));
+}
+
 }  // namespace nebula
 
 